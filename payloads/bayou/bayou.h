@@ -17,6 +17,7 @@
 #define BAYOU_H_
 
 #include <libpayload.h>
+#include <cbfs.h>
 
 #define BAYOU_MAX_ENTRIES 10
 
@@ -53,8 +54,8 @@ enum bayou_params {
 
 struct payload {
 	struct bpt_pentry pentry;
-	struct larstat stat;
-	u8 *fptr;
+	struct cbfs_handle *handle;
+	struct cbfs_payload_segment *fptr;	/* mapped, not copied */
 	char *params[BAYOU_PARAMS_COUNT];
 };
 
@@ -66,8 +67,9 @@ struct bayoucfg {
 
 extern struct bayoucfg bayoucfg;
 
-int verify_self(u8 *ptr);
-int self_get_params(u8 *fptr, u8 **params);
+struct cbfs_payload_segment *self_map(const char *name,
+				      struct cbfs_handle **handle);
+int self_get_params(struct cbfs_payload_segment *fptr, u8 **params);
 int self_load_and_run(struct payload *p, int *ret);
 
 void menu(void);
@@ -78,6 +80,6 @@ struct payload *payload_get_default(void);
 void run_payload_timeout(struct payload *p, int timeout);
 void payload_parse_params(struct payload *pload, u8 *params, int len);
 
-int get_configuration(struct LAR *lar);
+int get_configuration(void);
 
 #endif
@@ -17,101 +17,91 @@
 
 struct bayoucfg bayoucfg;
 
-static int add_payload(struct LAR *lar, struct larent *larent)
+/* Secondary payloads go into img/, like coreinfo and memtest do. */
+#define PAYLOAD_PREFIX "img/"
+
+static int add_payload(void *arg, const char *name, uint32_t type)
 {
 	struct payload *payload;
 	int plen;
 	u8 *params = NULL;
-	u8 *fptr;
 
 	if (bayoucfg.n_entries == BAYOU_MAX_ENTRIES)
-		return -1;
-
-	payload = &bayoucfg.entries[bayoucfg.n_entries];
-
-	if (strncmp((char *)larent->name, "payload/", 8))
-		return -1;
+		return 1;
 
-	if (larstat(lar, (const char *)larent->name, &payload->stat))
-		return -1;
+	if (type != CBFS_TYPE_SELF ||
+	    strncmp(name, PAYLOAD_PREFIX, strlen(PAYLOAD_PREFIX)))
+		return 0;
 
-	/* Make sure the LAR entry is valid. */
-	if (!lfverify(lar, (const char *)larent->name))
-		return -1;
+	payload = &bayoucfg.entries[bayoucfg.n_entries];
 
 	/* Get a pointer to the start of the file. */
-	fptr = larfptr(lar, (const char *)larent->name);
-
-	if (fptr == NULL)
-		return -1;
-
-	if (!verify_self(fptr))
-		return -1;
+	payload->fptr = self_map(name, &payload->handle);
+	if (payload->fptr == NULL)
+		return 0;
 
 	payload->pentry.index = bayoucfg.n_entries;
 	payload->pentry.parent = 0;
 	payload->pentry.type = BPT_TYPE_CHOOSER;
 	payload->pentry.flags = 0;
 
-	plen = self_get_params(fptr, &params);
+	plen = self_get_params(payload->fptr, &params);
 	payload_parse_params(payload, params, plen);
 
-	payload->fptr = fptr;
-
 	bayoucfg.n_entries++;
 
 	return 0;
 }
 
-static int lar_walk_files(struct LAR *lar,
-			  int (*cb) (struct LAR *, struct larent *))
+/**
+ * If reading the bayou_payload_table fails for some reason, then construct
+ * a dummy table. All valid payloads in the CBFS are added as chooser items.
+ */
+static int build_dummy_table(void)
 {
-	struct larent *larent;
-	int ret = 0;
+	int i;
 
-	rewindlar(lar);
+	/* Drop whatever a broken bayou_payload_table got us so far. */
+	for (i = 0; i < BAYOU_MAX_ENTRIES; i++) {
+		struct payload *p = &bayoucfg.entries[i];
 
-	while ((larent = readlar(lar)) != NULL) {
-		if ((ret = cb(lar, larent)))
-			break;
+		if (p->handle == NULL)
+			continue;
+		cbfs_unmap_contents(p->handle, p->fptr);
+		free(p->handle);
 	}
 
-	return ret;
-}
-
-/**
- * If reading the bayou_payload_table fails for some reason, then construct
- * a dummy table. All valid payloads in the lar are added as chooser items.
- */
-static void build_dummy_table(struct LAR *lar)
-{
+	memset(&bayoucfg, 0, sizeof(bayoucfg));
 	bayoucfg.timeout = 0xFF;
-	bayoucfg.n_entries = 0;
 
-	lar_walk_files(lar, add_payload);
+	cbfs_for_each_file(CBFS_DEFAULT_MEDIA, add_payload, NULL);
+
+	return 0;
 }
 
-int get_configuration(struct LAR *lar)
+int get_configuration(void)
 {
-	struct larstat stat;
+	struct cbfs_handle *handle;
 	struct bpt_config *bptcfg;
 	u8 *fptr, *ptr;
 	int i;
 
 	/*
 	 * If bayou_payload_table doesn't exist, then dummy up
-	 * a table from the LAR contents.
+	 * a table from the CBFS contents.
 	 */
-	if (larstat(lar, "bayou_payload_table", &stat) ||
-	    !lfverify(lar, "bayou_payload_table"))
-		build_dummy_table(lar);
+	handle = cbfs_get_handle(CBFS_DEFAULT_MEDIA, "bayou_payload_table");
+	if (handle == NULL)
+		return build_dummy_table();
 
 	/* Open up the BPT and get the creamy goodness within. */
 
-	fptr = larfptr(lar, "bayou_payload_table");
+	fptr = cbfs_map_contents(handle, NULL);
 
-	if (fptr == NULL)
-		build_dummy_table(lar);
+	if (fptr == NULL) {
+		free(handle);
+		return build_dummy_table();
+	}
 
 	bptcfg = (struct bpt_config *)fptr;
 	bayoucfg.timeout = bptcfg->timeout;
@@ -137,25 +127,22 @@ int get_configuration(struct LAR *lar)
 		if (entry->type != BPT_TYPE_CHAIN) {
 			char *lname = (char *)ptr + sizeof(struct bpt_pentry);
 
-			if (larstat(lar, (const char *)lname, &p->stat))
-				build_dummy_table(lar);
-
-			if (!lfverify(lar, (const char *)lname))
-				build_dummy_table(lar);
-
-			fptr = larfptr(lar, (const char *)lname);
+			p->fptr = self_map(lname, &p->handle);
+			if (p->fptr == NULL)
+				break;
 
-			if (verify_self(fptr))
-				p->fptr = fptr;
-			else
-				build_dummy_table(lar);
-
-			plen = self_get_params(fptr, &params);
+			plen = self_get_params(p->fptr, &params);
 			payload_parse_params(p, params, plen);
 		}
 
 		ptr += sizeof(struct bpt_pentry) + entry->nlen;
 	}
 
+	cbfs_unmap_contents(handle, fptr);
+	free(handle);
+
+	if (i < bayoucfg.n_entries)
+		return build_dummy_table();
+
 	return 0;
 }
@@ -22,22 +22,12 @@ static void print_banner(void)
 
 int main(void)
 {
-	extern unsigned long _binary_builtin_lar_start;
-	struct LAR *lar;
-
 	print_banner();
 
-	lar = openlar((void *)&_binary_builtin_lar_start);
-
-	if (lar == NULL) {
-		printf("[CHOOSER]: Unable to scan the attached LAR file\n");
-		return -1;
-	}
-
-	get_configuration(lar);
+	get_configuration();
 
 	if (bayoucfg.n_entries == 0) {
-		printf("[CHOOSER]:  No payloads were found in the LAR\n");
+		printf("[CHOOSER]:  No payloads were found in the CBFS\n");
 		return -1;
 	}
 
@@ -13,51 +13,59 @@
  * GNU General Public License for more details.
  */
 
+#include <lz4.h>
+#include <lzma.h>
 #include "bayou.h"
-#include "self.h"
 
-static int nop_decompress(void *dst, void *src, int len)
-{
-	memcpy(dst, src, len);
-	return len;
-}
-
-#ifdef CONFIG_LZMA
-extern int ulzma(u8 *, u8 *);
-
-static int lzma_decompress(void *dst, void *src, int len)
-{
-	return ulzma((u8 *) src, (u8 *) dst);
-}
-#endif
-
-#ifdef CONFIG_NRV2B
-extern int unrv2b(u8 *, u8 *, unsigned long *);
-
-static int nrv2b_decompress(void *dst, void *src, int len)
+/*
+ * Payloads are CBFS SELF files. The file itself is stored uncompressed, only
+ * its segments are compressed, so it can be mapped instead of copied. On
+ * memory mapped boot media that means every segment is decompressed from
+ * flash straight to its load address, without a buffer in between.
+ */
+struct cbfs_payload_segment *self_map(const char *name,
+				      struct cbfs_handle **handle)
 {
-	unsigned long l = (u32) len;
-	return unrv2b(src, dst, &l);
-}
-#endif
+	struct cbfs_payload_segment *seg;
+
+	*handle = cbfs_get_handle(CBFS_DEFAULT_MEDIA, name);
+	if (*handle == NULL)
+		return NULL;
+
+	if ((*handle)->type != CBFS_TYPE_SELF)
+		goto err;
+
+	seg = cbfs_map_contents(*handle, NULL);
+	if (seg == NULL)
+		goto err;
+
+	switch (ntohl(seg->type)) {
+	case PAYLOAD_SEGMENT_CODE:
+	case PAYLOAD_SEGMENT_DATA:
+	case PAYLOAD_SEGMENT_BSS:
+	case PAYLOAD_SEGMENT_PARAMS:
+	case PAYLOAD_SEGMENT_ENTRY:
+		return seg;
+	}
 
-static int zeros_decompress(void *dst, void *src, int len)
-{
-	memset(dst, 0, len);
-	return len;
+	cbfs_unmap_contents(*handle, seg);
+err:
+	free(*handle);
+	*handle = NULL;
+	return NULL;
 }
 
-int self_get_params(u8 *fptr, u8 **params)
+int self_get_params(struct cbfs_payload_segment *fptr, u8 **params)
 {
-	struct self_segment *seg = (struct self_segment *)fptr;
+	struct cbfs_payload_segment *seg = fptr;
 
-	while (seg->type != SELF_TYPE_ENTRY) {
+	while (ntohl(seg->type) != PAYLOAD_SEGMENT_ENTRY) {
 		if (seg->type == 0)
 			return -1;
 
-		if (seg->type == SELF_TYPE_PARAMS) {
-			*params = (u8 *) (fptr + seg->offset);
-			return seg->len;
+		if (ntohl(seg->type) == PAYLOAD_SEGMENT_PARAMS) {
+			*params = (u8 *)fptr + ntohl(seg->offset);
+			return ntohl(seg->len);
 		}
 
 		seg++;
@@ -68,70 +76,66 @@ int self_get_params(u8 *fptr, u8 **params)
 	return 0;
 }
 
-int verify_self(u8 *ptr)
+static int load_segment(struct cbfs_payload_segment *fptr,
+			struct cbfs_payload_segment *seg, void *dst)
 {
-	struct self_segment *seg = (struct self_segment *)ptr;
-
-	switch (seg->type) {
-	case SELF_TYPE_CODE:
-	case SELF_TYPE_DATA:
-	case SELF_TYPE_BSS:
-	case SELF_TYPE_PARAMS:
-	case SELF_TYPE_ENTRY:
-		return 1;
-	}
-
-	return 0;
-}
-
-int self_load_and_run(struct payload *p, int *ret)
-{
-	struct self_segment *seg = (struct self_segment *)p->fptr;
-	int (*dcmp) (void *, void *, int);
-	int dlen;
-
-	switch (p->stat.compression) {
-#ifdef CONFIG_LZMA
-	case ALGO_LZMA:
-		dcmp = lzma_decompress;
+	u8 *src = (u8 *)fptr + ntohl(seg->offset);
+	u32 len = ntohl(seg->len);
+	u32 mem_len = ntohl(seg->mem_len);
+	u32 dlen;
+
+	switch (ntohl(seg->compression)) {
+	case CBFS_COMPRESS_NONE:
+		if (len > mem_len)
+			return -1;
+		memcpy(dst, src, len);
+		dlen = len;
 		break;
-#endif
-#ifdef CONFIG_NRV2B
-	case ALGO_NRV2B:
-		dcmp = nrv2b_decompress;
+	case CBFS_COMPRESS_LZMA:
+		dlen = ulzman(src, len, dst, mem_len);
 		break;
-#endif
-	case ALGO_ZEROES:
-		dcmp = zeros_decompress;
+	case CBFS_COMPRESS_LZ4:
+		dlen = ulz4fn(src, len, dst, mem_len);
 		break;
-	case ALGO_NONE:
-		dcmp = nop_decompress;
 	default:
 		printf("E: Unsupported decompression type\n");
 		return -1;
 	}
 
-	while (1) {
-		u32 laddr = (u32) (seg->load_addr & 0xFFFFFFFF);
+	if (dlen == 0 && len != 0)
+		return -1;
 
-		switch (seg->type) {
-		case SELF_TYPE_CODE:
-		case SELF_TYPE_DATA:
-			dlen = dcmp((void *)laddr,
-				    (void *)p->fptr + seg->offset, seg->len);
+	if (dlen < mem_len)
+		memset(dst + dlen, 0, mem_len - dlen);
 
-			if (dlen < seg->mem_len) {
-				memset((void *)(laddr + dlen), 0,
-				       seg->mem_len - dlen);
+	return 0;
+}
+
+int self_load_and_run(struct payload *p, int *ret)
+{
+	struct cbfs_payload_segment *seg = p->fptr;
+
+	while (1) {
+		u32 laddr = (u32) (ntohll(seg->load_addr) & 0xFFFFFFFF);
+
+		switch (ntohl(seg->type)) {
+		case PAYLOAD_SEGMENT_CODE:
+		case PAYLOAD_SEGMENT_DATA:
+			if (load_segment(p->fptr, seg, (void *)laddr)) {
+				printf("E: Failed to load segment at 0x%x\n",
+				       laddr);
+				return -1;
 			}
 			break;
 
-		case SELF_TYPE_BSS:
-			memset((void *)laddr, 0, seg->len);
+		case PAYLOAD_SEGMENT_BSS:
+			memset((void *)laddr, 0, ntohl(seg->len));
 			break;
-		case SELF_TYPE_ENTRY:
+		case PAYLOAD_SEGMENT_ENTRY:
 			*ret = exec(laddr, 0, NULL);
 			return 0;
+		case 0:
+			return -1;
 		default:
 			break;
 		}
@@ -81,13 +81,24 @@ void *memset(void *dstpp, int c, size_t len)
 void *memcpy(void *dest, const void *src, size_t n)
 {
 	unsigned long d0, d1, d2;
+	size_t head = 0;
+
+	/*
+	 * For larger copies, move a few bytes first so that the bulk of the
+	 * copy is done with aligned stores.
+	 */
+	if (n >= 64)
+		head = -(uintptr_t)dest & 3;
 
 	asm volatile(
-		"rep ; movsl\n\t"
+		"rep ; movsb\n\t"
 		"movl %4,%%ecx\n\t"
+		"rep ; movsl\n\t"
+		"movl %5,%%ecx\n\t"
 		"rep ; movsb\n\t"
 		: "=&c" (d0), "=&D" (d1), "=&S" (d2)
-		: "0" (n >> 2), "g" (n & 3), "1" (dest), "2" (src)
+		: "0" (head), "g" ((n - head) >> 2), "g" ((n - head) & 3),
+		  "1" (dest), "2" (src)
 		: "memory"
 	);
 
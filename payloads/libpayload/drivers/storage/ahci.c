@@ -156,6 +156,12 @@ static int ahci_dev_init(hba_ctrl_t *const ctrl,
 #if IS_ENABLED(CONFIG_LP_STORAGE_ATA)
 		dev->ata_dev.identify = ahci_identify_device;
 		dev->ata_dev.read_sectors = ahci_ata_read_sectors;
+		if (ctrl->caps & HBA_CAPS_SNCQ) {
+			dev->ata_dev.read_sectors_start =
+				ahci_ata_read_sectors_start;
+			dev->ata_dev.read_sectors_finish =
+				ahci_ata_read_sectors_finish;
+		}
 		return ata_attach_device(&dev->ata_dev, PORT_TYPE_SATA);
 #endif
 		break;
@@ -48,6 +48,12 @@ ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
 	if (count == 0)
 		return 0;
 
+	/* Slot 0 may be in use by a queued read. */
+	if (dev->ncq_pending) {
+		printf("ahci: Queued reads still pending.\n");
+		return -1;
+	}
+
 	if (ata_dev->read_cmd == ATA_READ_DMA) {
 		if (start >= (1 << 28)) {
 		       printf("ahci: Sector is not 28-bit addressable.\n");
@@ -98,3 +104,131 @@ ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
 	else
 		return dev->cmdlist->prd_bytes >> ata_dev->sector_size_shift;
 }
+
+static int ahci_ncq_init(ahci_dev_t *const dev)
+{
+	const int ncs = HBA_CAPS_DECODE_NCS(dev->ctrl->caps);
+	const int slots = MIN(ncs, dev->ata_dev.ncq_depth);
+
+	dev->ncq_tables = memalign(128, slots * sizeof(cmdtable_t));
+	if (!dev->ncq_tables)
+		return -1;
+	dev->ncq_slots = slots;
+	return 0;
+}
+
+/*
+ * Issue a READ FPDMA QUEUED in a free slot and return right away. The
+ * drive may work on all queued reads at once and in any order, we
+ * collect them in the order they were issued. The PRDT points right
+ * into the caller's buffer, odd buffers aren't supported here.
+ */
+int ahci_ata_read_sectors_start(ata_dev_t *const ata_dev,
+				const lba_t start, const size_t count,
+				u8 *const buf)
+{
+	ahci_dev_t *const dev = (ahci_dev_t *)ata_dev;
+	int slot;
+
+	if (!ata_dev->ncq_depth || dev->ncq_failed || count == 0 ||
+			count > (64 * 1024) || ((uintptr_t)buf & 1))
+		return -1;
+
+	const size_t bytes = count << ata_dev->sector_size_shift;
+	if (bytes > ARRAY_SIZE(dev->cmdtable->prdt) << BYTES_PER_PRD_SHIFT)
+		return -1;
+
+	if (!dev->ncq_tables && ahci_ncq_init(dev))
+		return -1;
+	if (dev->ncq_pending == dev->ncq_slots)
+		return -1;
+
+	/* Find a slot that is neither queued by us nor still active. */
+	u32 busy = dev->port->sata_active | dev->port->cmd_issue;
+	int i;
+	for (i = 0; i < dev->ncq_pending; ++i)
+		busy |= 1 << dev->ncq_queue[
+			(dev->ncq_head + i) % ARRAY_SIZE(dev->ncq_queue)];
+	for (slot = 0; slot < dev->ncq_slots; ++slot)
+		if (!(busy & (1 << slot)))
+			break;
+	if (slot == dev->ncq_slots)
+		return -1;
+
+	cmdtable_t *const cmdtable = &dev->ncq_tables[slot];
+	memset((void *)&dev->cmdlist[slot], '\0', sizeof(dev->cmdlist[slot]));
+	memset((void *)cmdtable, '\0', sizeof(*cmdtable));
+	dev->cmdlist[slot].cmd = CMD_CFL(FIS_H2D_FIS_LEN);
+	dev->cmdlist[slot].cmdtable_base = virt_to_phys(cmdtable);
+	dev->cmdlist[slot].prdt_length = ahci_prdt_fill(cmdtable, buf, bytes);
+
+	/* Sector count goes into the features, the tag into the count. */
+	cmdtable->fis[ 0] = FIS_HOST_TO_DEVICE;
+	cmdtable->fis[ 1] = FIS_H2D_CMD;
+	cmdtable->fis[ 2] = ATA_READ_FPDMA_QUEUED;
+	cmdtable->fis[ 3] = (count >> 0) & 0xff;
+	cmdtable->fis[ 4] = (start >>  0) & 0xff;
+	cmdtable->fis[ 5] = (start >>  8) & 0xff;
+	cmdtable->fis[ 6] = (start >> 16) & 0xff;
+	cmdtable->fis[ 7] = FIS_H2D_DEV_LBA;
+	cmdtable->fis[ 8] = (start >> 24) & 0xff;
+#if IS_ENABLED(CONFIG_LP_STORAGE_64BIT_LBA)
+	cmdtable->fis[ 9] = (start >> 32) & 0xff;
+	cmdtable->fis[10] = (start >> 40) & 0xff;
+#endif
+	cmdtable->fis[11] = (count >> 8) & 0xff;
+	cmdtable->fis[12] = slot << 3;
+
+	if (!(dev->port->cmd_stat & HBA_PxCMD_CR))
+		return -1;
+
+	dev->port->sata_active |= 1 << slot;
+	dev->port->cmd_issue |= 1 << slot;
+
+	dev->ncq_sectors[slot] = count;
+	dev->ncq_queue[(dev->ncq_head + dev->ncq_pending) %
+		       ARRAY_SIZE(dev->ncq_queue)] = slot;
+	++dev->ncq_pending;
+
+	return 0;
+}
+
+ssize_t ahci_ata_read_sectors_finish(ata_dev_t *const ata_dev)
+{
+	ahci_dev_t *const dev = (ahci_dev_t *)ata_dev;
+	ssize_t ret = -1;
+
+	if (!dev->ncq_pending)
+		return -1;
+
+	const int slot = dev->ncq_queue[dev->ncq_head];
+	dev->ncq_head = (dev->ncq_head + 1) % ARRAY_SIZE(dev->ncq_queue);
+	--dev->ncq_pending;
+
+	if (!dev->ncq_failed) {
+		/* The drive clears our bit in SActive when it's done. */
+		int timeout = 50000; /* Time out after 50000 * 100us == 5s. */
+		while ((dev->port->sata_active & (1 << slot)) &&
+				!(dev->port->intr_status & HBA_PxIS_FATAL) &&
+				timeout--)
+			udelay(100);
+
+		const u32 intr_status = dev->port->intr_status;
+		if (timeout < 0 || (intr_status &
+				    (HBA_PxIS_FATAL | HBA_PxIS_PCS))) {
+			if (timeout < 0)
+				printf("ahci: Timeout during queued read.\n");
+			/* Restarting the engine drops all queued commands. */
+			ahci_error_recovery(dev, intr_status);
+			dev->port->intr_status = intr_status;
+			dev->ncq_failed = 1;
+		} else {
+			ret = dev->ncq_sectors[slot];
+		}
+	}
+
+	if (!dev->ncq_pending)
+		dev->ncq_failed = 0;
+
+	return ret;
+}
@@ -202,37 +202,41 @@ size_t ahci_cmdslot_prepare(ahci_dev_t *const dev,
 	dev->cmdlist[slotnum].cmdtable_base = virt_to_phys(dev->cmdtable);
 
 	if (buf_len > 0) {
-		size_t prdt_len;
 		u8 *buf;
-		int i;
 
-		prdt_len = ((buf_len - 1) >> BYTES_PER_PRD_SHIFT) + 1;
-		const size_t max_prdt_len = ARRAY_SIZE(dev->cmdtable->prdt);
-		if (prdt_len > max_prdt_len) {
-			prdt_len = max_prdt_len;
-			buf_len = prdt_len << BYTES_PER_PRD_SHIFT;
-		}
-
-		dev->cmdlist[slotnum].prdt_length = prdt_len;
+		const size_t max_len =
+			ARRAY_SIZE(dev->cmdtable->prdt) << BYTES_PER_PRD_SHIFT;
+		if (buf_len > max_len)
+			buf_len = max_len;
 		read_count = buf_len;
 
 		buf = ahci_prdbuf_init(dev, user_buf, buf_len, out);
 		if (!buf)
 			return 0;
-		for (i = 0; i < prdt_len; ++i) {
-			const size_t bytes =
-				(buf_len < BYTES_PER_PRD)
-				? buf_len : BYTES_PER_PRD;
-			dev->cmdtable->prdt[i].data_base = virt_to_phys(buf);
-			dev->cmdtable->prdt[i].flags = PRD_TABLE_BYTES(bytes);
-			buf_len -= bytes;
-			buf += bytes;
-		}
+		dev->cmdlist[slotnum].prdt_length =
+			ahci_prdt_fill(dev->cmdtable, buf, buf_len);
 	}
 
 	return read_count;
 }
 
+/** Describe buf in the PRDT, buf_len has to fit. Returns PRDT length. */
+size_t ahci_prdt_fill(cmdtable_t *const cmdtable, u8 *buf, size_t buf_len)
+{
+	size_t i;
+
+	for (i = 0; buf_len > 0; ++i) {
+		const size_t bytes =
+			(buf_len < BYTES_PER_PRD) ? buf_len : BYTES_PER_PRD;
+		cmdtable->prdt[i].data_base = virt_to_phys(buf);
+		cmdtable->prdt[i].flags = PRD_TABLE_BYTES(bytes);
+		buf_len -= bytes;
+		buf += bytes;
+	}
+
+	return i;
+}
+
 int ahci_identify_device(ata_dev_t *const ata_dev, u8 *const buf)
 {
 	ahci_dev_t *const dev = (ahci_dev_t *)ata_dev;
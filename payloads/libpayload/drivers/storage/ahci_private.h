@@ -109,6 +109,7 @@ typedef volatile struct {
 	hba_port_t ports[32];
 } hba_ctrl_t;
 
+#define HBA_CAPS_SNCQ		(1 << 30) /* SNCQ - Supports Native Command Queuing */
 #define HBA_CAPS_SSS		(1 << 27) /* SSS - Supports Staggered Spin-up */
 #define HBA_CAPS_NCS_SHIFT	8	/* NCS - Number of Command Slots */
 #define HBA_CAPS_NCS_MASK	(0x1f << HBA_CAPS_NCS_SHIFT)
@@ -197,6 +198,15 @@ typedef struct {
 	u8 *buf, *user_buf;
 	int write_back;
 	size_t buflen;
+
+	/* Queued reads. Slot numbers double as NCQ tags. */
+	int ncq_slots;			/* usable slots, set up on first use */
+	cmdtable_t *ncq_tables;		/* one command table per slot */
+	u8 ncq_queue[32];		/* slots in the order they were issued */
+	size_t ncq_sectors[32];		/* sectors requested per slot */
+	int ncq_head;
+	int ncq_pending;
+	int ncq_failed;	/* a read failed, the ones queued after it are lost */
 } ahci_dev_t;
 
 /*
@@ -212,6 +222,9 @@ size_t ahci_cmdslot_prepare(ahci_dev_t *const dev,
 		   u8 *const user_buf, size_t buf_len,
 		   const int out);
 
+size_t ahci_prdt_fill(cmdtable_t *const cmdtable,
+		      u8 *buf, size_t buf_len);
+
 int ahci_identify_device(ata_dev_t *const ata_dev, u8 *const buf);
 
 int ahci_error_recovery(ahci_dev_t *const dev, const u32 intr_status);
@@ -230,5 +243,11 @@ ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
 		     const lba_t start, size_t count,
 		     u8 *const buf);
 
+int ahci_ata_read_sectors_start(ata_dev_t *const ata_dev,
+		     const lba_t start, const size_t count,
+		     u8 *const buf);
+
+ssize_t ahci_ata_read_sectors_finish(ata_dev_t *const ata_dev);
+
 
 #endif /* _AHCI_PRIVATE_H */
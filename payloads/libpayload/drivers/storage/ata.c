@@ -136,6 +136,34 @@ static ssize_t ata_read512(storage_dev_t *_dev,
 	}
 }
 
+static int ata_read512_start(storage_dev_t *_dev,
+			     const lba_t start, const size_t count,
+			     unsigned char *const buf)
+{
+	ata_dev_t *const dev = (ata_dev_t *)_dev;
+
+	/* Only whole sectors can be queued. */
+	if (dev->sector_size < 512)
+		return -1;
+	const size_t shift = dev->sector_size_shift - 9;
+	const size_t mask = (dev->sector_size >> 9) - 1;
+	if ((start & mask) || (count & mask))
+		return -1;
+
+	return dev->read_sectors_start(dev, start >> shift, count >> shift, buf);
+}
+
+static ssize_t ata_read512_finish(storage_dev_t *_dev)
+{
+	ata_dev_t *const dev = (ata_dev_t *)_dev;
+
+	const ssize_t ret = dev->read_sectors_finish(dev);
+	if (ret < 0)
+		return ret;
+	else
+		return ret << (dev->sector_size_shift - 9);
+}
+
 static ssize_t ata_write512(storage_dev_t *const dev,
 			    const lba_t start, const size_t count,
 			    const unsigned char *const buf)
@@ -148,6 +176,10 @@ void ata_initialize_storage_ops(ata_dev_t *const dev)
 {
 	dev->storage_dev.read_blocks512 = ata_read512;
 	dev->storage_dev.write_blocks512 = ata_write512;
+	if (dev->read_sectors_start && dev->read_sectors_finish) {
+		dev->storage_dev.read_blocks512_start = ata_read512_start;
+		dev->storage_dev.read_blocks512_finish = ata_read512_finish;
+	}
 }
 
 int ata_set_sector_size(ata_dev_t *const dev, u32 sector_size)
@@ -226,6 +258,13 @@ int ata_attach_device(ata_dev_t *const dev, const storage_port_t port_type)
 	if (ata_decode_sector_size(dev, id))
 		return -1;
 
+	/* Word 76 is 0 or all ones on drives that aren't SATA. */
+	if (id[ATA_ID_SATA_CAPS] != 0xffff &&
+			(id[ATA_ID_SATA_CAPS] & (1 << 8))) {
+		dev->ncq_depth = (id[ATA_ID_QUEUE_DEPTH] & 0x1f) + 1;
+		printf("ata: NCQ with queue depth %d.\n", dev->ncq_depth);
+	}
+
 	dev->storage_dev.port_type = port_type;
 	ata_initialize_storage_ops(dev);
 
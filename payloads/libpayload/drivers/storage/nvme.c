@@ -0,0 +1,522 @@
+/*
+ * This file is part of the libpayload project.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <libpayload.h>
+#include <pci.h>
+#include <pci/pci.h>
+#include <arch/barrier.h>
+#include <storage/storage.h>
+#include <storage/nvme.h>
+
+/*
+ * A polled NVMe driver: one admin queue and one I/O queue pair, no
+ * interrupts. Reads are split into commands of at most NVME_MAX_XFER
+ * bytes and as many as the I/O queue holds are kept in flight.
+ */
+
+#define NVME_PAGE_SHIFT		12
+#define NVME_PAGE_SIZE		(1 << NVME_PAGE_SHIFT)
+#define NVME_ADMIN_QUEUE_SIZE	8
+#define NVME_IO_QUEUE_SIZE	64
+/* One page of PRP list per command. */
+#define NVME_PRPS_PER_LIST	(NVME_PAGE_SIZE / sizeof(u64))
+#define NVME_MAX_XFER		(NVME_PRPS_PER_LIST << NVME_PAGE_SHIFT)
+
+typedef volatile struct {
+	u32 cap_lo;
+	u32 cap_hi;
+	u32 version;
+	u32 intr_mask_set;
+	u32 intr_mask_clear;
+	u32 config;
+	u32 _reserved0;
+	u32 status;
+	u32 subsys_reset;
+	u32 admin_queue_attrs;
+	u32 admin_sq_lo;
+	u32 admin_sq_hi;
+	u32 admin_cq_lo;
+	u32 admin_cq_hi;
+} nvme_regs_t;
+
+#define NVME_CAP_LO_MQES_MASK	0xffff		/* MQES - Max Queue Entries */
+#define NVME_CAP_LO_TO_SHIFT	24		/* TO - Timeout (500ms units) */
+#define NVME_CAP_HI_DSTRD_MASK	0xf		/* DSTRD - Doorbell Stride */
+
+#define NVME_CC_EN		(1 << 0)
+#define NVME_CC_IOSQES		(6 << 16)	/* 64 byte SQ entries */
+#define NVME_CC_IOCQES		(4 << 20)	/* 16 byte CQ entries */
+
+#define NVME_CSTS_RDY		(1 << 0)
+#define NVME_CSTS_CFS		(1 << 1)	/* CFS - Controller Fatal Status */
+
+#define NVME_DOORBELLS		0x1000
+
+typedef struct {
+	u8 opcode;
+	u8 flags;
+	u16 cid;
+	u32 nsid;
+	u64 _reserved0;
+	u64 metadata;
+	u64 prp1;
+	u64 prp2;
+	u32 cdw10;
+	u32 cdw11;
+	u32 cdw12;
+	u32 cdw13;
+	u32 cdw14;
+	u32 cdw15;
+} __packed nvme_sqe_t;
+
+typedef struct {
+	u32 result;
+	u32 _reserved0;
+	u16 sq_head;
+	u16 sq_id;
+	u16 cid;
+	u16 status;	/* bit 0 is the phase tag */
+} __packed nvme_cqe_t;
+
+enum {
+	NVME_ADMIN_CREATE_IO_SQ	= 0x01,
+	NVME_ADMIN_CREATE_IO_CQ	= 0x05,
+	NVME_ADMIN_IDENTIFY	= 0x06,
+	NVME_IO_READ		= 0x02,
+};
+
+enum {
+	NVME_IDENTIFY_NAMESPACE		= 0x00,
+	NVME_IDENTIFY_CONTROLLER	= 0x01,
+};
+
+/* byte offsets into identify data */
+enum {
+	NVME_ID_CTRL_MDTS	= 77,	/* MDTS - Max Data Transfer Size */
+	NVME_ID_CTRL_NN		= 516,	/* NN - Number of Namespaces */
+	NVME_ID_NS_NSZE		= 0,	/* NSZE - Namespace Size */
+	NVME_ID_NS_FLBAS	= 26,	/* FLBAS - Formatted LBA Size */
+	NVME_ID_NS_LBAF		= 128,	/* LBAF - LBA Formats */
+};
+
+typedef struct {
+	volatile nvme_sqe_t *sq;
+	volatile nvme_cqe_t *cq;
+	volatile u32 *sq_doorbell;
+	volatile u32 *cq_doorbell;
+	u16 size;
+	u16 sq_tail;
+	u16 cq_head;
+	u16 phase;
+} nvme_queue_t;
+
+typedef struct {
+	nvme_regs_t *regs;
+	nvme_queue_t admin;
+	nvme_queue_t io;
+	size_t max_xfer;	/* bytes per I/O command */
+
+	/* I/O command ids double as index into these. */
+	u64 *prp_lists;		/* one page per command */
+	u64 busy;		/* command ids in flight */
+	u8 *identify;		/* one page for identify data */
+} nvme_ctrl_t;
+
+typedef struct {
+	storage_dev_t storage_dev;
+
+	nvme_ctrl_t *ctrl;
+	u32 nsid;
+	size_t lba_shift;
+	u64 lba_count;
+} nvme_ns_t;
+
+static void nvme_queue_init(nvme_ctrl_t *const ctrl, nvme_queue_t *const q,
+			    const int qid, void *const sq, void *const cq,
+			    const u16 size)
+{
+	const u32 stride = 4 << (ctrl->regs->cap_hi & NVME_CAP_HI_DSTRD_MASK);
+	u8 *const doorbells = (u8 *)ctrl->regs + NVME_DOORBELLS;
+
+	memset(sq, '\0', size * sizeof(nvme_sqe_t));
+	memset(cq, '\0', size * sizeof(nvme_cqe_t));
+	q->sq = sq;
+	q->cq = cq;
+	q->sq_doorbell = (u32 *)(doorbells + (2 * qid) * stride);
+	q->cq_doorbell = (u32 *)(doorbells + (2 * qid + 1) * stride);
+	q->size = size;
+	q->sq_tail = 0;
+	q->cq_head = 0;
+	q->phase = 1;
+}
+
+static void nvme_submit(nvme_queue_t *const q, const nvme_sqe_t *const sqe)
+{
+	memcpy((void *)&q->sq[q->sq_tail], sqe, sizeof(*sqe));
+	q->sq_tail = (q->sq_tail + 1) % q->size;
+	/* Make sure the entry is in memory before the controller looks. */
+	wmb();
+	*q->sq_doorbell = q->sq_tail;
+}
+
+/** Returns the cid of the next completion or -1 if there is none yet. */
+static int nvme_reap(nvme_queue_t *const q, u16 *const status)
+{
+	volatile nvme_cqe_t *const cqe = &q->cq[q->cq_head];
+
+	if ((cqe->status & 1) != q->phase)
+		return -1;
+
+	const int cid = cqe->cid;
+	*status = cqe->status >> 1;
+
+	q->cq_head = (q->cq_head + 1) % q->size;
+	if (!q->cq_head)
+		q->phase ^= 1;
+	*q->cq_doorbell = q->cq_head;
+
+	return cid;
+}
+
+static int nvme_admin_cmd(nvme_ctrl_t *const ctrl, nvme_sqe_t *const sqe)
+{
+	u16 status;
+
+	sqe->cid = 0;
+	nvme_submit(&ctrl->admin, sqe);
+
+	int timeout = 50000; /* Time out after 50000 * 100us == 5s. */
+	while (nvme_reap(&ctrl->admin, &status) < 0) {
+		if (!timeout--) {
+			printf("nvme: Timeout during admin command 0x%x.\n",
+			       sqe->opcode);
+			return -1;
+		}
+		udelay(100);
+	}
+	if (status) {
+		printf("nvme: Admin command 0x%x failed (status 0x%x).\n",
+		       sqe->opcode, status);
+		return -1;
+	}
+	return 0;
+}
+
+static int nvme_identify(nvme_ctrl_t *const ctrl, const u32 cns,
+			 const u32 nsid)
+{
+	nvme_sqe_t sqe;
+
+	memset(&sqe, '\0', sizeof(sqe));
+	sqe.opcode = NVME_ADMIN_IDENTIFY;
+	sqe.nsid = nsid;
+	sqe.prp1 = virt_to_phys(ctrl->identify);
+	sqe.cdw10 = cns;
+	return nvme_admin_cmd(ctrl, &sqe);
+}
+
+/** Fill PRP1/PRP2 for len bytes at buf, which has to be dword aligned. */
+static void nvme_set_prps(nvme_ctrl_t *const ctrl, nvme_sqe_t *const sqe,
+			  u8 *const buf, const size_t len)
+{
+	const size_t first = NVME_PAGE_SIZE -
+		(virt_to_phys(buf) & (NVME_PAGE_SIZE - 1));
+
+	sqe->prp1 = virt_to_phys(buf);
+	sqe->prp2 = 0;
+	if (len <= first)
+		return;
+	if (len <= first + NVME_PAGE_SIZE) {
+		sqe->prp2 = virt_to_phys(buf + first);
+		return;
+	}
+
+	u64 *const list = ctrl->prp_lists + sqe->cid * NVME_PRPS_PER_LIST;
+	size_t off, i = 0;
+	for (off = first; off < len; off += NVME_PAGE_SIZE)
+		list[i++] = virt_to_phys(buf + off);
+	sqe->prp2 = virt_to_phys(list);
+}
+
+static ssize_t nvme_read512(storage_dev_t *const _dev,
+			    const lba_t start, const size_t count,
+			    unsigned char *const buf)
+{
+	nvme_ns_t *const ns = (nvme_ns_t *)_dev;
+	nvme_ctrl_t *const ctrl = ns->ctrl;
+	const size_t shift = ns->lba_shift - 9;
+	const size_t mask = (1 << shift) - 1;
+
+	if ((start & mask) || (count & mask)) {
+		printf("nvme: Unaligned read (%zu blocks at %llu).\n",
+		       count, (unsigned long long)start);
+		return -1;
+	}
+	if ((uintptr_t)buf & 3) {
+		printf("nvme: Buffer not dword aligned (%p).\n", buf);
+		return -1;
+	}
+
+	const size_t chunk = ctrl->max_xfer >> ns->lba_shift;
+	u64 lba = start >> shift;
+	size_t remaining = count >> shift;
+	u8 *cur = buf;
+	int failed = 0;
+
+	/* Keep the I/O queue as full as we can until everything is done. */
+	while ((remaining && !failed) || ctrl->busy) {
+		int cid;
+
+		for (cid = 0; remaining && !failed &&
+				cid < ctrl->io.size - 1; ++cid) {
+			if (ctrl->busy & (1ULL << cid))
+				continue;
+
+			const size_t n = MIN(remaining, chunk);
+			nvme_sqe_t sqe;
+			memset(&sqe, '\0', sizeof(sqe));
+			sqe.opcode = NVME_IO_READ;
+			sqe.cid = cid;
+			sqe.nsid = ns->nsid;
+			nvme_set_prps(ctrl, &sqe, cur, n << ns->lba_shift);
+			sqe.cdw10 = lba & 0xffffffff;
+			sqe.cdw11 = (u64)lba >> 32;
+			sqe.cdw12 = n - 1;
+			nvme_submit(&ctrl->io, &sqe);
+
+			ctrl->busy |= 1ULL << cid;
+			lba += n;
+			remaining -= n;
+			cur += n << ns->lba_shift;
+		}
+
+		u16 status;
+		int timeout = 50000; /* Time out after 50000 * 100us == 5s. */
+		while ((cid = nvme_reap(&ctrl->io, &status)) < 0) {
+			if (!timeout--) {
+				printf("nvme: Timeout during read.\n");
+				/* We can't tell what is still in flight. */
+				return -1;
+			}
+			udelay(100);
+		}
+		ctrl->busy &= ~(1ULL << cid);
+		if (status) {
+			printf("nvme: Read failed (status 0x%x).\n", status);
+			failed = 1;
+		}
+	}
+
+	return failed ? -1 : count;
+}
+
+static ssize_t nvme_write512(storage_dev_t *const dev,
+			     const lba_t start, const size_t count,
+			     const unsigned char *const buf)
+{
+	printf("nvme: No write support implemented.\n");
+	return -1;
+}
+
+static storage_poll_t nvme_poll(storage_dev_t *const dev)
+{
+	return POLL_MEDIUM_PRESENT;
+}
+
+static void nvme_attach_namespace(nvme_ctrl_t *const ctrl, const u32 nsid)
+{
+	if (nvme_identify(ctrl, NVME_IDENTIFY_NAMESPACE, nsid))
+		return;
+
+	const u8 *const id = ctrl->identify;
+	u64 lba_count;
+	memcpy(&lba_count, id + NVME_ID_NS_NSZE, sizeof(lba_count));
+	if (!lba_count)
+		return;
+
+	const int format = id[NVME_ID_NS_FLBAS] & 0xf;
+	const size_t lba_shift = id[NVME_ID_NS_LBAF + 4 * format + 2];
+	if (lba_shift < 9 || lba_shift > NVME_PAGE_SHIFT) {
+		printf("nvme: Unsupported block size 2^%zu in namespace %u.\n",
+		       lba_shift, nsid);
+		return;
+	}
+
+	nvme_ns_t *const ns = calloc(1, sizeof(*ns));
+	if (!ns)
+		return;
+	ns->ctrl = ctrl;
+	ns->nsid = nsid;
+	ns->lba_shift = lba_shift;
+	ns->lba_count = lba_count;
+	ns->storage_dev.port_type = PORT_TYPE_NVME;
+	ns->storage_dev.poll = nvme_poll;
+	ns->storage_dev.read_blocks512 = nvme_read512;
+	ns->storage_dev.write_blocks512 = nvme_write512;
+
+	printf("nvme: Namespace %u, %llu %zu-byte blocks.\n", nsid,
+	       (unsigned long long)lba_count, (size_t)1 << lba_shift);
+	if (storage_attach_device(&ns->storage_dev))
+		free(ns);
+}
+
+static int nvme_wait_ready(nvme_regs_t *const regs, const u32 ready)
+{
+	/* CAP.TO is the worst case in 500ms units. */
+	int timeout = ((regs->cap_lo >> NVME_CAP_LO_TO_SHIFT) & 0xff) * 5000;
+	while ((regs->status & NVME_CSTS_RDY) != ready && timeout--) {
+		if (regs->status & NVME_CSTS_CFS)
+			return -1;
+		udelay(100);
+	}
+	return (regs->status & NVME_CSTS_RDY) == ready ? 0 : -1;
+}
+
+static int nvme_create_io_queues(nvme_ctrl_t *const ctrl)
+{
+	const u16 mqes = (ctrl->regs->cap_lo & NVME_CAP_LO_MQES_MASK) + 1;
+	const u16 size = MIN(NVME_IO_QUEUE_SIZE, mqes);
+	void *const sq = dma_memalign(NVME_PAGE_SIZE, size * sizeof(nvme_sqe_t));
+	void *const cq = dma_memalign(NVME_PAGE_SIZE, size * sizeof(nvme_cqe_t));
+	ctrl->prp_lists = dma_memalign(NVME_PAGE_SIZE, size * NVME_PAGE_SIZE);
+	if (!sq || !cq || !ctrl->prp_lists)
+		return -1;
+	nvme_queue_init(ctrl, &ctrl->io, 1, sq, cq, size);
+
+	nvme_sqe_t sqe;
+	memset(&sqe, '\0', sizeof(sqe));
+	sqe.opcode = NVME_ADMIN_CREATE_IO_CQ;
+	sqe.prp1 = virt_to_phys(cq);
+	sqe.cdw10 = (size - 1) << 16 | 1;
+	sqe.cdw11 = 1;			/* physically contiguous, no IRQ */
+	if (nvme_admin_cmd(ctrl, &sqe))
+		return -1;
+
+	memset(&sqe, '\0', sizeof(sqe));
+	sqe.opcode = NVME_ADMIN_CREATE_IO_SQ;
+	sqe.prp1 = virt_to_phys(sq);
+	sqe.cdw10 = (size - 1) << 16 | 1;
+	sqe.cdw11 = 1 << 16 | 1;	/* CQ 1, physically contiguous */
+	return nvme_admin_cmd(ctrl, &sqe);
+}
+
+static void nvme_init_pci(const pcidev_t dev)
+{
+	const u32 class = pci_read_config32(dev, 0x08) >> 8;
+	if (class != 0x010802)
+		return;
+
+	const u32 bar_lo = pci_read_config32(dev, 0x10);
+	const u32 bar_hi = pci_read_config32(dev, 0x14);
+	printf("nvme: Found controller %02x:%02x.%02x (%04x:%04x).\n",
+	       PCI_BUS(dev), PCI_SLOT(dev), PCI_FUNC(dev),
+	       pci_read_config16(dev, 0x00), pci_read_config16(dev, 0x02));
+	if ((bar_lo & 0x6) == 0x4 && bar_hi) {
+		printf("nvme: BAR above 4GiB is not supported.\n");
+		return;
+	}
+
+	nvme_ctrl_t *const ctrl = calloc(1, sizeof(*ctrl));
+	void *const admin_sq = dma_memalign(NVME_PAGE_SIZE,
+			NVME_ADMIN_QUEUE_SIZE * sizeof(nvme_sqe_t));
+	void *const admin_cq = dma_memalign(NVME_PAGE_SIZE,
+			NVME_ADMIN_QUEUE_SIZE * sizeof(nvme_cqe_t));
+	u8 *const identify = dma_memalign(NVME_PAGE_SIZE, NVME_PAGE_SIZE);
+	if (!ctrl || !admin_sq || !admin_cq || !identify) {
+		printf("nvme: Out of memory.\n");
+		return;
+	}
+	ctrl->regs = phys_to_virt(bar_lo & ~0xf);
+	ctrl->identify = identify;
+
+	/* Enable memory decoding and bus mastering. */
+	const u16 command = pci_read_config16(dev, PCI_COMMAND);
+	pci_write_config16(dev, PCI_COMMAND,
+			   command | PCI_COMMAND_MEMORY | PCI_COMMAND_MASTER);
+
+	nvme_regs_t *const regs = ctrl->regs;
+	regs->config &= ~NVME_CC_EN;
+	if (nvme_wait_ready(regs, 0)) {
+		printf("nvme: Controller didn't stop.\n");
+		return;
+	}
+
+	nvme_queue_init(ctrl, &ctrl->admin, 0, admin_sq, admin_cq,
+			NVME_ADMIN_QUEUE_SIZE);
+	regs->admin_queue_attrs = (NVME_ADMIN_QUEUE_SIZE - 1) << 16 |
+				  (NVME_ADMIN_QUEUE_SIZE - 1);
+	regs->admin_sq_lo = virt_to_phys(admin_sq);
+	regs->admin_sq_hi = 0;
+	regs->admin_cq_lo = virt_to_phys(admin_cq);
+	regs->admin_cq_hi = 0;
+	/* 4KiB pages (MPS 0), NVM command set */
+	regs->config = NVME_CC_IOCQES | NVME_CC_IOSQES | NVME_CC_EN;
+	if (nvme_wait_ready(regs, NVME_CSTS_RDY)) {
+		printf("nvme: Controller didn't become ready.\n");
+		return;
+	}
+
+	if (nvme_identify(ctrl, NVME_IDENTIFY_CONTROLLER, 0))
+		return;
+	const u8 mdts = identify[NVME_ID_CTRL_MDTS];
+	u32 namespaces;
+	memcpy(&namespaces, identify + NVME_ID_CTRL_NN, sizeof(namespaces));
+
+	ctrl->max_xfer = NVME_MAX_XFER;
+	if (mdts && mdts < 32 &&
+	    ((size_t)NVME_PAGE_SIZE << mdts) < ctrl->max_xfer)
+		ctrl->max_xfer = (size_t)NVME_PAGE_SIZE << mdts;
+
+	if (nvme_create_io_queues(ctrl)) {
+		printf("nvme: Couldn't set up the I/O queues.\n");
+		return;
+	}
+
+	u32 nsid;
+	for (nsid = 1; nsid <= namespaces; ++nsid)
+		nvme_attach_namespace(ctrl, nsid);
+}
+
+void nvme_initialize(void)
+{
+	int bus, dev, func;
+
+	for (bus = 0; bus < 256; ++bus) {
+		for (dev = 0; dev < 32; ++dev) {
+			const u16 class =
+				pci_read_config16(PCI_DEV(bus, dev, 0), 0xa);
+			if (class != 0xffff) {
+				for (func = 0; func < 8; ++func)
+					nvme_init_pci(PCI_DEV(bus, dev, func));
+			}
+		}
+	}
+}
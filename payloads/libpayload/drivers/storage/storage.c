@@ -31,6 +31,9 @@
 #if IS_ENABLED(CONFIG_LP_STORAGE_AHCI)
 # include <storage/ahci.h>
 #endif
+#if IS_ENABLED(CONFIG_LP_STORAGE_NVME)
+# include <storage/nvme.h>
+#endif
 #include <storage/storage.h>
 
 
@@ -102,6 +105,41 @@ ssize_t storage_read_blocks512(const size_t dev_num,
 		return -1;
 }
 
+/**
+ * Queues a read of 512-byte blocks on devices that support it
+ *
+ * Several reads can be queued, so the device works on them while the
+ * caller goes on. Each has to be collected with
+ * storage_read_blocks512_finish(), in the order they were queued.
+ *
+ * @return 0 if the read was queued, -1 if the caller has to use
+ *         storage_read_blocks512() instead.
+ */
+int storage_read_blocks512_start(const size_t dev_num,
+				 const lba_t start, const size_t count,
+				 unsigned char *const buf)
+{
+	if ((dev_num < dev_count) && devices[dev_num]->read_blocks512_start)
+		return devices[dev_num]->read_blocks512_start(
+				devices[dev_num], start, count, buf);
+	else
+		return -1;
+}
+
+/**
+ * Waits for the oldest read queued by storage_read_blocks512_start()
+ *
+ * @return Number of blocks read or -1 on error.
+ */
+ssize_t storage_read_blocks512_finish(const size_t dev_num)
+{
+	if ((dev_num < dev_count) && devices[dev_num]->read_blocks512_finish)
+		return devices[dev_num]->read_blocks512_finish(
+				devices[dev_num]);
+	else
+		return -1;
+}
+
 /**
  * Initializes storage controllers
  *
@@ -113,4 +151,7 @@ void storage_initialize(void)
 #if IS_ENABLED(CONFIG_LP_STORAGE_AHCI)
 	ahci_initialize();
 #endif
+#if IS_ENABLED(CONFIG_LP_STORAGE_NVME)
+	nvme_initialize();
+#endif
 }
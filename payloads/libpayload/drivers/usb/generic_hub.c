@@ -33,6 +33,36 @@
 #include <usb/usb.h>
 #include "generic_hub.h"
 
+/* hubs powering up and ports in other states than PORT_IDLE */
+static int pending_work;
+
+int
+generic_hub_pending(void)
+{
+	return pending_work > 0;
+}
+
+static void
+generic_hub_set_state(usbdev_t *const dev, const int port,
+		      const generic_hub_port_state_t state)
+{
+	generic_hub_port_t *const p = &GEN_HUB(dev)->port_states[port];
+
+	if (p->state == PORT_IDLE && state != PORT_IDLE)
+		++pending_work;
+	else if (p->state != PORT_IDLE && state == PORT_IDLE)
+		--pending_work;
+
+	/* Only one device may answer the default address at a time. */
+	if (p->state < PORT_RESET && state >= PORT_RESET)
+		dev->controller->port_busy = 1;
+	else if (p->state >= PORT_RESET && state < PORT_RESET)
+		dev->controller->port_busy = 0;
+
+	p->state = state;
+	p->state_us = timer_us(0);
+}
+
 void
 generic_hub_destroy(usbdev_t *const dev)
 {
@@ -43,12 +73,15 @@ generic_hub_destroy(usbdev_t *const dev)
 	/* First, detach all devices behind this hub */
 	int port;
 	for (port = 1; port <= hub->num_ports; ++port) {
+		generic_hub_set_state(dev, port, PORT_IDLE);
 		if (hub->ports[port] >= 0) {
 			usb_debug("generic_hub: Detachment at port %d\n", port);
 			usb_detach_device(dev->controller, hub->ports[port]);
 			hub->ports[port] = NO_DEV;
 		}
 	}
+	if (hub->power_on_pending)
+		--pending_work;
 
 	/* Disable all ports */
 	if (hub->ops->disable_port) {
@@ -56,43 +89,11 @@ generic_hub_destroy(usbdev_t *const dev)
 			hub->ops->disable_port(dev, port);
 	}
 
+	free(hub->port_states);
 	free(hub->ports);
 	free(hub);
 }
 
-static int
-generic_hub_debounce(usbdev_t *const dev, const int port)
-{
-	generic_hub_t *const hub = GEN_HUB(dev);
-
-	const int step_ms	= 1;	/* linux uses 25ms, we're busy anyway */
-	const int at_least_ms	= 100;	/* 100ms as in usb20 spec 9.1.2 */
-	const int timeout_ms	= 1500;	/* linux uses this value */
-
-	int total_ms = 0;
-	int stable_ms = 0;
-	while (stable_ms < at_least_ms && total_ms < timeout_ms) {
-		mdelay(step_ms);
-
-		const int changed = hub->ops->port_status_changed(dev, port);
-		const int connected = hub->ops->port_connected(dev, port);
-		if (changed < 0 || connected < 0)
-			return -1;
-
-		if (!changed && connected) {
-			stable_ms += step_ms;
-		} else {
-			usb_debug("generic_hub: Unstable connection at %d\n",
-				  port);
-			stable_ms = 0;
-		}
-		total_ms += step_ms;
-	}
-	if (total_ms >= timeout_ms)
-		usb_debug("generic_hub: Debouncing timed out at %d\n", port);
-	return 0; /* ignore timeouts, try to always go on */
-}
-
 int
 generic_hub_wait_for_port(usbdev_t *const dev, const int port,
 			  const int wait_for,
@@ -135,58 +136,158 @@ generic_hub_resetport(usbdev_t *const dev, const int port)
 	return 0; /* ignore timeouts, try to always go on */
 }
 
-static int
+static void
 generic_hub_detach_dev(usbdev_t *const dev, const int port)
 {
 	generic_hub_t *const hub = GEN_HUB(dev);
 
 	usb_detach_device(dev->controller, hub->ports[port]);
 	hub->ports[port] = NO_DEV;
-
-	return 0;
 }
 
-static int
+static void
 generic_hub_attach_dev(usbdev_t *const dev, const int port)
 {
 	generic_hub_t *const hub = GEN_HUB(dev);
 
-	if (generic_hub_debounce(dev, port) < 0)
-		return -1;
+	const usb_speed speed = hub->ops->port_speed(dev, port);
+	if (speed >= 0) {
+		usb_debug("generic_hub: Success at port %d\n", port);
+		hub->ports[port] = usb_attach_device(
+				dev->controller, dev->address, port, speed);
+	}
+	generic_hub_set_state(dev, port, PORT_IDLE);
+}
+
+static void
+generic_hub_reset_done(usbdev_t *const dev, const int port)
+{
+	generic_hub_t *const hub = GEN_HUB(dev);
+
+	if (!hub->ops->port_connected(dev, port)) {
+		usb_debug("generic_hub: Port %d disconnected after "
+			  "reset. Possibly upgraded, rescan required.\n", port);
+		generic_hub_set_state(dev, port, PORT_IDLE);
+		return;
+	}
+
+	/* after reset the port will be enabled automatically */
+	generic_hub_set_state(dev, port, PORT_WAIT_ENABLE);
+}
+
+static void
+generic_hub_start_reset(usbdev_t *const dev, const int port)
+{
+	generic_hub_t *const hub = GEN_HUB(dev);
 
-	if (hub->ops->reset_port) {
+	if (dev->controller->port_busy)
+		return;
+
+	if (!hub->ops->reset_port) {
+		generic_hub_set_state(dev, port, PORT_RECOVERY);
+		generic_hub_attach_dev(dev, port);
+		return;
+	}
+
+	generic_hub_set_state(dev, port, PORT_RESET);
+	if (hub->ops->start_port_reset) {
+		/* generic reset, we wait for it from poll() */
+		if (hub->ops->start_port_reset(dev, port) < 0)
+			generic_hub_set_state(dev, port, PORT_IDLE);
+	} else {
+		/* hub specific reset, waits by itself */
 		if (hub->ops->reset_port(dev, port) < 0)
-			return -1;
+			generic_hub_set_state(dev, port, PORT_IDLE);
+		else
+			generic_hub_reset_done(dev, port);
+	}
+}
 
-		if (!hub->ops->port_connected(dev, port)) {
-			usb_debug(
-				"generic_hub: Port %d disconnected after "
-				"reset. Possibly upgraded, rescan required.\n",
-				port);
-			return 0;
-		}
+static void
+generic_hub_debounce(usbdev_t *const dev, const int port)
+{
+	generic_hub_t *const hub = GEN_HUB(dev);
+	generic_hub_port_t *const p = &hub->port_states[port];
 
-		/* after reset the port will be enabled automatically */
-		const int ret = generic_hub_wait_for_port(
-			/* time out after 1,000 * 10us = 10ms */
-			dev, port, 1, hub->ops->port_enabled, 1000, 10);
-		if (ret < 0)
-			return -1;
-		else if (!ret)
-			usb_debug("generic_hub: Port %d still "
-				  "disabled after 10ms\n", port);
+	const int step_us	= 1000;	/* linux uses 25ms, we're busy anyway */
+	const int at_least_ms	= 100;	/* 100ms as in usb20 spec 9.1.2 */
+	const int timeout_ms	= 1500;	/* linux uses this value */
+
+	if (timer_us(p->checked_us) < step_us)
+		return;
+	p->checked_us = timer_us(0);
+
+	const int changed = hub->ops->port_status_changed(dev, port);
+	const int connected = hub->ops->port_connected(dev, port);
+	if (changed < 0 || connected < 0) {
+		generic_hub_set_state(dev, port, PORT_IDLE);
+		return;
 	}
 
-	const usb_speed speed = hub->ops->port_speed(dev, port);
-	if (speed >= 0) {
-		usb_debug("generic_hub: Success at port %d\n", port);
-		if (hub->ops->reset_port)
-			mdelay(10); /* Reset recovery time
-				       (usb20 spec 7.1.7.5) */
-		hub->ports[port] = usb_attach_device(
-				dev->controller, dev->address, port, speed);
+	if (changed || !connected) {
+		usb_debug("generic_hub: Unstable connection at %d\n", port);
+		p->stable_us = p->checked_us;
+	} else if (timer_us(p->stable_us) >= at_least_ms * 1000) {
+		generic_hub_set_state(dev, port, PORT_WAIT_RESET);
+		return;
+	}
+
+	if (timer_us(p->state_us) >= timeout_ms * 1000) {
+		usb_debug("generic_hub: Debouncing timed out at %d\n", port);
+		/* ignore timeouts, try to always go on */
+		generic_hub_set_state(dev, port, PORT_WAIT_RESET);
+	}
+}
+
+static void
+generic_hub_progress_port(usbdev_t *const dev, const int port)
+{
+	generic_hub_t *const hub = GEN_HUB(dev);
+	generic_hub_port_t *const p = &hub->port_states[port];
+	const u64 in_state_us = timer_us(p->state_us);
+	int ret;
+
+	switch (p->state) {
+	case PORT_IDLE:
+		break;
+	case PORT_DEBOUNCE:
+		generic_hub_debounce(dev, port);
+		break;
+	case PORT_WAIT_RESET:
+		generic_hub_start_reset(dev, port);
+		break;
+	case PORT_RESET:
+		/* usb20 spec 11.5.1.5: reset should take 10 to 20ms,
+		   give the hub another 12ms to finish it */
+		if (in_state_us < 10 * 1000)
+			break;
+		ret = hub->ops->port_in_reset(dev, port);
+		if (ret < 0) {
+			generic_hub_set_state(dev, port, PORT_IDLE);
+		} else if (!ret || in_state_us >= 22 * 1000) {
+			if (ret)
+				usb_debug("generic_hub: Reset timed out at "
+					  "port %d\n", port);
+			generic_hub_reset_done(dev, port);
+		}
+		break;
+	case PORT_WAIT_ENABLE:
+		ret = hub->ops->port_enabled(dev, port);
+		if (ret < 0) {
+			generic_hub_set_state(dev, port, PORT_IDLE);
+		} else if (ret || in_state_us >= 10 * 1000) {
+			if (!ret)
+				usb_debug("generic_hub: Port %d still "
+					  "disabled after 10ms\n", port);
+			generic_hub_set_state(dev, port, PORT_RECOVERY);
+		}
+		break;
+	case PORT_RECOVERY:
+		/* Reset recovery time (usb20 spec 7.1.7.5) */
+		if (in_state_us >= 10 * 1000)
+			generic_hub_attach_dev(dev, port);
+		break;
 	}
-	return 0;
 }
 
 int
@@ -194,23 +295,47 @@ generic_hub_scanport(usbdev_t *const dev, const int port)
 {
 	generic_hub_t *const hub = GEN_HUB(dev);
 
+	generic_hub_set_state(dev, port, PORT_IDLE);
+
 	if (hub->ports[port] >= 0) {
 		usb_debug("generic_hub: Detachment at port %d\n", port);
-
-		const int ret = generic_hub_detach_dev(dev, port);
-		if (ret < 0)
-			return ret;
+		generic_hub_detach_dev(dev, port);
 	}
 
-	if (hub->ops->port_connected(dev, port)) {
+	const int connected = hub->ops->port_connected(dev, port);
+	if (connected < 0)
+		return connected;
+	if (connected) {
 		usb_debug("generic_hub: Attachment at port %d\n", port);
-
-		return generic_hub_attach_dev(dev, port);
+		generic_hub_set_state(dev, port, PORT_DEBOUNCE);
+		hub->port_states[port].stable_us =
+			hub->port_states[port].state_us;
 	}
 
 	return 0;
 }
 
+/*
+ * Clear change bits and enumerate every connected port regardless of
+ * them. Some broken hubs don't set CSC if already connected during reset.
+ */
+static void
+generic_hub_initial_scan(usbdev_t *const dev)
+{
+	generic_hub_t *const hub = GEN_HUB(dev);
+	int port;
+
+	hub->power_on_pending = 0;
+	--pending_work;
+
+	for (port = 1; port <= hub->num_ports; ++port) {
+		if (hub->ops->port_status_changed(dev, port) < 0)
+			return;
+		if (generic_hub_scanport(dev, port) < 0)
+			return;
+	}
+}
+
 static void
 generic_hub_poll(usbdev_t *const dev)
 {
@@ -218,12 +343,27 @@ generic_hub_poll(usbdev_t *const dev)
 	if (!hub)
 		return;
 
+	if (hub->power_on_pending) {
+		/* wait once for all ports */
+		if (hub->ops->enable_port &&
+				timer_us(hub->power_on_us) < 20 * 1000)
+			return;
+		generic_hub_initial_scan(dev);
+		return;
+	}
+
+	int port;
+	for (port = 1; port <= hub->num_ports; ++port)
+		generic_hub_progress_port(dev, port);
+
 	if (hub->ops->hub_status_changed &&
 			hub->ops->hub_status_changed(dev) != 1)
 		return;
 
-	int port;
 	for (port = 1; port <= hub->num_ports; ++port) {
+		/* ports coming up watch for changes themselves */
+		if (hub->port_states[port].state != PORT_IDLE)
+			continue;
 		const int ret = hub->ops->port_status_changed(dev, port);
 		if (ret < 0) {
 			return;
@@ -252,9 +392,12 @@ generic_hub_init(usbdev_t *const dev, const int num_ports,
 	generic_hub_t *const hub = GEN_HUB(dev);
 	hub->num_ports = num_ports;
 	hub->ports = malloc(sizeof(*hub->ports) * (num_ports + 1));
+	hub->port_states = calloc(num_ports + 1, sizeof(*hub->port_states));
 	hub->ops = ops;
-	if (!hub->ports) {
+	if (!hub->ports || !hub->port_states) {
 		usb_debug("generic_hub: ERROR: Out of memory\n");
+		free(hub->port_states);
+		free(hub->ports);
 		free(dev->data);
 		dev->data = NULL;
 		return -1;
@@ -262,13 +405,15 @@ generic_hub_init(usbdev_t *const dev, const int num_ports,
 	for (port = 1; port <= num_ports; ++port)
 		hub->ports[port] = NO_DEV;
 
-	/* Enable all ports */
+	/* Enable all ports, the first poll() after they are powered
+	   scans them. */
 	if (ops->enable_port) {
 		for (port = 1; port <= num_ports; ++port)
 			ops->enable_port(dev, port);
-		/* wait once for all ports */
-		mdelay(20);
 	}
+	hub->power_on_pending = 1;
+	hub->power_on_us = timer_us(0);
+	++pending_work;
 
 	return 0;
 }
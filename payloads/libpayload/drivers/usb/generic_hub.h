@@ -59,12 +59,39 @@ typedef struct generic_hub_ops {
 	int (*reset_port)(usbdev_t *, int port);
 } generic_hub_ops_t;
 
+/*
+ * Ports are brought up in parallel: every attachment goes through these
+ * states, which are progressed from the hub's poll() instead of waiting
+ * in place.
+ */
+typedef enum {
+	PORT_IDLE = 0,
+	PORT_DEBOUNCE,		/* waiting for a stable connection */
+	PORT_WAIT_RESET,	/* waiting for the controller to be free */
+	/* from here on the port holds the controller, see port_busy */
+	PORT_RESET,		/* reset started, waiting for it to finish */
+	PORT_WAIT_ENABLE,	/* reset done, waiting for the port enable */
+	PORT_RECOVERY,		/* reset recovery before addressing */
+} generic_hub_port_state_t;
+
+typedef struct generic_hub_port {
+	generic_hub_port_state_t state;
+	u64 state_us;		/* when the current state was entered */
+	u64 stable_us;		/* start of the stable connection */
+	u64 checked_us;		/* last debounce sample */
+} generic_hub_port_t;
+
 typedef struct generic_hub {
 	int num_ports;
 	/* port numbers are always 1 based,
 	   so we waste one int for convenience */
 	int *ports; /* allocated to sizeof(*ports)*(num_ports+1) */
 #define NO_DEV -1
+	generic_hub_port_t *port_states; /* indexed like ports */
+
+	/* ports are powered, but not scanned yet */
+	int power_on_pending;
+	u64 power_on_us;
 
 	const generic_hub_ops_t *ops;
 
@@ -77,9 +104,12 @@ int generic_hub_wait_for_port(usbdev_t *const dev, const int port,
 			      int (*const port_op)(usbdev_t *, int),
 			      int timeout_steps, const int step_us);
 int  generic_hub_resetport(usbdev_t *, int port);
+/* starts (re-)enumeration of a port, finished from later polls */
 int  generic_hub_scanport(usbdev_t *, int port);
 /* the provided generic_hub_ops struct has to be static */
 int generic_hub_init(usbdev_t *, int num_ports, const generic_hub_ops_t *);
+/* returns 1 while any hub still has ports coming up */
+int generic_hub_pending(void);
 
 #define GEN_HUB(usbdev) ((generic_hub_t *)(usbdev)->data)
 
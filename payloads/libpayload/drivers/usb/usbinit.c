@@ -35,6 +35,7 @@
 #include "ehci.h"
 #include "xhci.h"
 #include "dwc2.h"
+#include "generic_hub.h"
 #include <usb/usbdisk.h>
 
 #if IS_ENABLED(CONFIG_LP_USB_PCI)
@@ -168,6 +169,11 @@ int usb_initialize(void)
 {
 #if IS_ENABLED(CONFIG_LP_USB_PCI)
 	usb_scan_pci_bus(0);
+#endif
+#if IS_ENABLED(CONFIG_LP_USB_GEN_HUB)
+	/* Bring up the ports of all controllers together. */
+	while (generic_hub_pending())
+		usb_poll();
 #endif
 	return 0;
 }
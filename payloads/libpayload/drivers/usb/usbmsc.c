@@ -88,6 +88,7 @@ usb_msc_destroy (usbdev_t *dev)
 {
 	if (dev->data) {
 		usb_msc_remove_disk (dev);
+		free (MSC_INST (dev)->csw);
 		free (dev->data);
 	}
 	dev->data = 0;
@@ -96,8 +97,11 @@ usb_msc_destroy (usbdev_t *dev)
 const int DEV_RESET = 0xff;
 const int GET_MAX_LUN = 0xfe;
 /* Many USB3 devices do not work with large transfer requests.
- * Limit the request size to 64KB chunks to ensure maximum compatibility. */
-const int MAX_CHUNK_BYTES = 1024 * 64;
+ * The default limits the request size to 64KB chunks to ensure maximum
+ * compatibility. */
+const int MAX_CHUNK_BYTES = CONFIG_LP_USB_MSC_MAX_TRANSFER_KB * 1024;
+/* What host controllers can bounce for buffers they can't DMA to. */
+#define BOUNCE_CHUNK_BYTES (1024 * 64)
 
 const unsigned int cbw_signature = 0x43425355;
 const unsigned int csw_signature = 0x53425355;
@@ -231,12 +235,48 @@ get_csw (endpoint_t *ep, csw_t *csw)
 	return MSC_COMMAND_OK;
 }
 
+/*
+ * Queue the data and the status stage of a read together, so the
+ * controller goes on to the CSW without waiting for us.
+ * Returns 1 if the CSW was received, 0 if the data stage is done but the
+ * CSW still has to be fetched and -1 if nothing could be queued.
+ */
+static int
+read_queued (usbdev_t *dev, u8 *buf, int buflen, csw_t *csw)
+{
+	hci_t *const hc = dev->controller;
+	endpoint_t *const ep = MSC_INST (dev)->bulk_in;
+	csw_t *const queued_csw = MSC_INST (dev)->csw;
+
+	if (!queued_csw || hc->bulk_start (ep, buflen, buf) < 0)
+		return -1;
+
+	if (hc->bulk_start (ep, sizeof (csw_t), (u8 *) queued_csw) < 0) {
+		if (hc->bulk_finish (ep) < 0)
+			clear_stall (ep);
+		return 0;
+	}
+
+	if (hc->bulk_finish (ep) < 0) {
+		/* the CSW won't come after a failed data stage */
+		hc->bulk_finish (ep);
+		clear_stall (ep);
+		return 0;
+	}
+	if (hc->bulk_finish (ep) < 0)
+		return 0;
+
+	memcpy (csw, queued_csw, sizeof (csw_t));
+	return 1;
+}
+
 static int
 execute_command (usbdev_t *dev, cbw_direction dir, const u8 *cb, int cblen,
 		 u8 *buf, int buflen, int residue_ok)
 {
 	cbw_t cbw;
 	csw_t csw;
+	int have_csw = 0;
 
 	int always_succeed = 0;
 	if ((cb[0] == 0x1b) && (cb[4] == 1)) {	//start command, always succeed
@@ -249,7 +289,8 @@ execute_command (usbdev_t *dev, cbw_direction dir, const u8 *cb, int cblen,
 	}
 	if (buflen > 0) {
 		if (dir == cbw_direction_data_in) {
-			if (dev->controller->
+			have_csw = read_queued (dev, buf, buflen, &csw);
+			if (have_csw < 0 && dev->controller->
 			    bulk (MSC_INST (dev)->bulk_in, buflen, buf, 0) < 0)
 				clear_stall (MSC_INST (dev)->bulk_in);
 		} else {
@@ -258,7 +299,12 @@ execute_command (usbdev_t *dev, cbw_direction dir, const u8 *cb, int cblen,
 				clear_stall (MSC_INST (dev)->bulk_out);
 		}
 	}
-	int ret = get_csw (MSC_INST (dev)->bulk_in, &csw);
+	int ret;
+	if (have_csw > 0)
+		ret = csw.dCSWTag != tag ? reset_transport (dev)
+					 : MSC_COMMAND_OK;
+	else
+		ret = get_csw (MSC_INST (dev)->bulk_in, &csw);
 	if (ret) {
 		return ret;
 	} else if (always_succeed == 1) {
@@ -387,14 +433,25 @@ readwrite_chunk (usbdev_t *dev, int start, int n, cbw_direction dir, u8 *buf)
 int
 readwrite_blocks (usbdev_t *dev, int start, int n, cbw_direction dir, u8 *buf)
 {
-	int chunk_size = MAX_CHUNK_BYTES / MSC_INST(dev)->blocksize;
+	unsigned int chunk_bytes = MSC_INST(dev)->max_transfer;
+	if (chunk_bytes > BOUNCE_CHUNK_BYTES && !dma_coherent(buf))
+		chunk_bytes = BOUNCE_CHUNK_BYTES;
+	int chunk_size = chunk_bytes / MSC_INST(dev)->blocksize;
 	int chunk;
 
+	/* Blocks larger than a chunk still go one at a time. */
+	if (!chunk_size)
+		chunk_size = 1;
+	/* READ(10) transfers at most 0xffff blocks */
+	if (chunk_size > 0xffff)
+		chunk_size = 0xffff;
+	chunk_bytes = chunk_size * MSC_INST(dev)->blocksize;
+
 	/* Read as many full chunks as needed. */
 	for (chunk = 0; chunk < (n / chunk_size); chunk++) {
 		if (readwrite_chunk (dev, start + (chunk * chunk_size),
 				     chunk_size, dir,
-				     buf + (chunk * MAX_CHUNK_BYTES))
+				     buf + (chunk * chunk_bytes))
 		    != MSC_COMMAND_OK)
 			return 1;
 	}
@@ -403,7 +460,7 @@ readwrite_blocks (usbdev_t *dev, int start, int n, cbw_direction dir, u8 *buf)
 	if (n % chunk_size) {
 		if (readwrite_chunk (dev, start + (chunk * chunk_size),
 				     n % chunk_size, dir,
-				     buf + (chunk * MAX_CHUNK_BYTES))
+				     buf + (chunk * chunk_bytes))
 		    != MSC_COMMAND_OK)
 			return 1;
 	}
@@ -518,6 +575,52 @@ read_capacity (usbdev_t *dev)
 	return MSC_COMMAND_OK;
 }
 
+/*
+ * Commands larger than the default are only used within the limit the
+ * device reports. Many sticks choke on VPD pages, so like other hosts
+ * only ask those that claim SPC-3 or later.
+ */
+static void
+read_block_limits (usbdev_t *dev)
+{
+	usbmsc_inst_t *const msc = MSC_INST (dev);
+	u8 buf[36];
+	cmdblock6_t cb;
+
+	msc->max_transfer = MAX_CHUNK_BYTES;
+	if (msc->max_transfer <= BOUNCE_CHUNK_BYTES || !msc->blocksize)
+		return;
+
+	/* Standard INQUIRY, byte 2 is the SPC version. */
+	memset (&cb, 0, sizeof (cb));
+	cb.command = 0x12;
+	cb.length = sizeof (buf);
+	if (execute_command (dev, cbw_direction_data_in, (u8 *) &cb,
+			     sizeof (cb), buf, sizeof (buf), 1)
+	    != MSC_COMMAND_OK || buf[2] < 5) {
+		msc->max_transfer = BOUNCE_CHUNK_BYTES;
+		return;
+	}
+
+	/* Block Limits VPD page */
+	memset (&cb, 0, sizeof (cb));
+	cb.command = 0x12;
+	cb.res1 = 1;	/* EVPD */
+	cb.res2 = 0xb0;
+	cb.length = 16;
+	if (execute_command (dev, cbw_direction_data_in, (u8 *) &cb,
+			     sizeof (cb), buf, 16, 1) != MSC_COMMAND_OK ||
+	    buf[1] != 0xb0) {
+		msc->max_transfer = BOUNCE_CHUNK_BYTES;
+		return;
+	}
+
+	const u32 limit = ntohl (*(u32 *) &buf[8]);
+	if (limit && limit < msc->max_transfer / msc->blocksize)
+		msc->max_transfer = limit * msc->blocksize;
+	usb_debug ("  transfers of up to %u bytes\n", msc->max_transfer);
+}
+
 static int
 usb_msc_test_unit_ready (usbdev_t *dev)
 {
@@ -585,6 +688,10 @@ usb_msc_test_unit_ready (usbdev_t *dev)
 	if (read_capacity (dev) == MSC_COMMAND_DETACHED)
 		return USB_MSC_DETACHED;
 
+	/* Only once, this runs on every poll. */
+	if (!MSC_INST (dev)->max_transfer)
+		read_block_limits (dev);
+
 	return MSC_INST (dev)->ready;
 }
 
@@ -632,6 +739,10 @@ usb_msc_init (usbdev_t *dev)
 	MSC_INST (dev)->bulk_in = 0;
 	MSC_INST (dev)->bulk_out = 0;
 	MSC_INST (dev)->usbdisk_created = 0;
+	MSC_INST (dev)->max_transfer = 0;
+	MSC_INST (dev)->csw = NULL;
+	if (dev->controller->bulk_start)
+		MSC_INST (dev)->csw = dma_malloc (sizeof (csw_t));
 
 	for (i = 1; i <= dev->num_endp; i++) {
 		if (dev->endpoints[i].endpoint == 0)
@@ -41,6 +41,8 @@ static void xhci_reset (hci_t *controller);
 static void xhci_reinit (hci_t *controller);
 static void xhci_shutdown (hci_t *controller);
 static int xhci_bulk (endpoint_t *ep, int size, u8 *data, int finalize);
+static int xhci_bulk_start (endpoint_t *ep, int size, u8 *data);
+static int xhci_bulk_finish (endpoint_t *ep);
 static int xhci_control (usbdev_t *dev, direction_t dir, int drlen, void *devreq,
 			 int dalen, u8 *data);
 static void* xhci_create_intr_queue (endpoint_t *ep, int reqsize, int reqcount, int reqtiming);
@@ -85,6 +87,9 @@ xhci_init_cycle_ring(transfer_ring_t *const tr, const size_t ring_size)
 
 	tr->pcs = 1;
 	tr->cur = tr->ring;
+	tr->tds = 0;
+	tr->trbs = 0;
+	tr->td_failed = 0;
 }
 
 /* On Panther Point: switch ports shared with EHCI to xHCI */
@@ -161,6 +166,8 @@ xhci_init (unsigned long physical_bar)
 	controller->init		= xhci_reinit;
 	controller->shutdown		= xhci_shutdown;
 	controller->bulk		= xhci_bulk;
+	controller->bulk_start		= xhci_bulk_start;
+	controller->bulk_finish		= xhci_bulk_finish;
 	controller->control		= xhci_control;
 	controller->set_address		= xhci_set_address;
 	controller->finish_device_config= xhci_finish_device_config;
@@ -545,7 +552,8 @@ xhci_ring_doorbell(endpoint_t *const ep)
 		xhci_ep_id(ep);
 }
 
-static void
+/* returns the number of TRBs used */
+static size_t
 xhci_enqueue_td(transfer_ring_t *const tr, const int ep, const size_t mps,
 		const int dalen, void *const data, const int dir)
 {
@@ -617,6 +625,8 @@ xhci_enqueue_td(transfer_ring_t *const tr, const int ep, const size_t mps,
 	TRB_SET(IOC, trb, 1);
 
 	xhci_enqueue_trb(tr);
+
+	return trb_count + 1;
 }
 
 static int
@@ -736,6 +746,11 @@ xhci_bulk(endpoint_t *const ep, const int size, u8 *const src,
 		return -1;
 	}
 
+	if (tr->tds) {
+		xhci_debug("Bulk transfers still queued on EP %d\n", ep_id);
+		return -1;
+	}
+
 	if (!dma_coherent(src)) {
 		data = xhci->dma_buffer;
 		if (size > DMA_SIZE) {
@@ -781,6 +796,87 @@ xhci_bulk(endpoint_t *const ep, const int size, u8 *const src,
 	return ret;
 }
 
+/*
+ * Queue a bulk TD and return right away. Up to TRANSFER_RING_MAX_TDS can
+ * be in flight per endpoint, so the controller goes on with the next one
+ * without waiting for us. xhci_bulk_finish() collects them in order.
+ */
+static int
+xhci_bulk_start(endpoint_t *const ep, const int size, u8 *const data)
+{
+	xhci_t *const xhci = XHCI_INST(ep->dev->controller);
+	const int slot_id = ep->dev->address;
+	const int ep_id = xhci_ep_id(ep);
+	epctx_t *const epctx = xhci->dev[slot_id].ctx.ep[ep_id];
+	transfer_ring_t *const tr = xhci->dev[slot_id].transfer_rings[ep_id];
+
+	/* We can't bounce through the DMA buffer, it only holds one. */
+	if (!dma_coherent(data))
+		return -1;
+
+	/* data TRBs for every 64KiB boundary crossed, plus the event data */
+	const size_t off = (size_t)data & 0xffff;
+	const size_t max_trbs = ((off + size) >> 16) + 2;
+	if (tr->td_failed || tr->tds == TRANSFER_RING_MAX_TDS ||
+			tr->trbs + max_trbs > TRANSFER_RING_SIZE - 2)
+		return -1;
+
+	/* Reset endpoint if it's not running */
+	if (!tr->tds && EC_GET(STATE, epctx) > 1) {
+		if (xhci_reset_endpoint(ep->dev, ep))
+			return -1;
+	}
+
+	const unsigned mps = EC_GET(MPS, epctx);
+	const unsigned dir = (ep->direction == OUT) ? TRB_DIR_OUT : TRB_DIR_IN;
+	const size_t trbs = xhci_enqueue_td(tr, ep_id, mps, size, data, dir);
+	tr->td_trbs[tr->tds++] = trbs;
+	tr->trbs += trbs;
+	xhci_ring_doorbell(ep);
+
+	return 0;
+}
+
+static int
+xhci_bulk_finish(endpoint_t *const ep)
+{
+	xhci_t *const xhci = XHCI_INST(ep->dev->controller);
+	const int slot_id = ep->dev->address;
+	const int ep_id = xhci_ep_id(ep);
+	epctx_t *const epctx = xhci->dev[slot_id].ctx.ep[ep_id];
+	transfer_ring_t *const tr = xhci->dev[slot_id].transfer_rings[ep_id];
+	int ret = -1;
+
+	if (!tr->tds)
+		return -1;
+
+	if (!tr->td_failed) {
+		ret = xhci_wait_for_transfer(xhci, slot_id, ep_id);
+		if (ret < 0) {
+			/* Make sure nothing queued behind it runs later. */
+			if (ret == TIMEOUT || (tr->tds > 1 &&
+					EC_GET(STATE, epctx) == 1)) {
+				xhci_debug("Stopping ID %d EP %d\n",
+					   slot_id, ep_id);
+				xhci_cmd_stop_endpoint(xhci, slot_id, ep_id);
+			}
+			xhci_debug("Queued bulk transfer failed: %d\n"
+				   "  ep state: %d\n"
+				   "  usbsts:   0x%08"PRIx32"\n",
+				   ret, EC_GET(STATE, epctx),
+				   xhci->opreg->usbsts);
+			tr->td_failed = 1;
+		}
+	}
+
+	tr->trbs -= tr->td_trbs[0];
+	memmove(tr->td_trbs, tr->td_trbs + 1, --tr->tds);
+	if (!tr->tds)
+		tr->td_failed = 0;
+
+	return ret;
+}
+
 static trb_t *
 xhci_next_trb(trb_t *cur, int *const pcs)
 {
@@ -161,10 +161,16 @@ typedef struct {
 
 /* Never raise this above 256 to prevent transfer event length overflow! */
 #define TRANSFER_RING_SIZE 32
+#define TRANSFER_RING_MAX_TDS 4
 typedef struct {
 	trb_t *ring;
 	trb_t *cur;
 	u8 pcs;
+	/* TDs queued by xhci_bulk_start(), oldest first */
+	u8 tds;
+	u8 td_trbs[TRANSFER_RING_MAX_TDS];	/* TRBs used by each TD */
+	u8 trbs;				/* TRBs used by all of them */
+	u8 td_failed;	/* a TD failed, the ones queued behind it are lost */
 } __packed transfer_ring_t;
 
 #define COMMAND_RING_SIZE 4
@@ -70,38 +70,45 @@ static unsigned long chars;
 #define FB ((unsigned char *) phys_to_virt(fbaddr))
 #define CHARS ((unsigned short *) phys_to_virt(chars))
 
+static void corebootfb_putchar(u8 row, u8 col, unsigned int ch);
+static void corebootfb_enable_cursor(int state);
+
+/*
+ * Reading back the framebuffer is very slow, so scrolling re-renders the
+ * screen from the char buffer instead of moving pixels around. Cells which
+ * already show the character scrolling into them are left alone.
+ */
 static void corebootfb_scroll_up(void)
 {
-	unsigned char *dst = FB;
-	unsigned char *src = FB + (FI->bytes_per_line * font_height);
-	int y;
+	const int columns = coreboot_video_console.columns;
+	const int rows = coreboot_video_console.rows;
+	const int cursor_remember = cursor_en;
+	unsigned short ch;
+	int row, column;
 
-	/* Scroll all lines up */
-	for(y = 0; y < FI->y_resolution - font_height; y++) {
-		memcpy(dst, src, FI->x_resolution * (FI->bits_per_pixel >> 3));
+	/* The cursor cell doesn't show what the char buffer says. */
+	if (cursor_remember)
+		corebootfb_enable_cursor(0);
 
-		dst += FI->bytes_per_line;
-		src += FI->bytes_per_line;
-	}
+	for (row = 0; row < rows; row++) {
+		for (column = 0; column < columns; column++) {
+			if (row < rows - 1)
+				ch = CHARS[(row + 1) * columns + column];
+			else
+				ch = VGA_COLOR_DEFAULT << 8;
 
-	/* Erase last line */
-	dst = FB + (FI->y_resolution - font_height) * FI->bytes_per_line;
+			if (CHARS[row * columns + column] == ch)
+				continue;
 
-	for(; y < FI->y_resolution; y++) {
-		memset(dst, 0, FI->x_resolution * (FI->bits_per_pixel >> 3));
-		dst += FI->bytes_per_line;
+			CHARS[row * columns + column] = ch;
+			corebootfb_putchar(row, column, ch);
+		}
 	}
 
-	/* And update the char buffer */
-	dst = (unsigned char *) CHARS;
-	src = (unsigned char *) (CHARS + coreboot_video_console.columns);
-	memcpy(dst, src, coreboot_video_console.columns *
-			(coreboot_video_console.rows - 1) * 2);
-	int column;
-	for (column = 0; column < coreboot_video_console.columns; column++)
-		CHARS[(coreboot_video_console.rows - 1) * coreboot_video_console.columns + column] = (VGA_COLOR_DEFAULT << 8);
-
 	cursor_y--;
+
+	if (cursor_remember)
+		corebootfb_enable_cursor(1);
 }
 
 static void corebootfb_clear(void)
@@ -121,60 +128,122 @@ static void corebootfb_clear(void)
 			CHARS[row * coreboot_video_console.columns + column] = (VGA_COLOR_DEFAULT << 8);
 }
 
-static void corebootfb_putchar(u8 row, u8 col, unsigned int ch)
+/*
+ * Glyph rows pre-rendered in a given pair of colors, one for every possible
+ * row bitmap of the font. Drawing a character then only copies font_height
+ * rows of pixels. There are two sets so the cursor, which shows the colors
+ * inverted, doesn't evict the colors of the text around it.
+ */
+#define GLYPH_ROW_SETS 2
+static struct {
+	unsigned char *rows;
+	unsigned int colors;
+} glyph_rows[GLYPH_ROW_SETS];
+static unsigned int glyph_rows_next;
+static int glyph_row_bytes;
+
+static u32 corebootfb_color(unsigned char color)
 {
-	unsigned char *dst;
+	/* Indexed */
+	if (FI->bits_per_pixel <= 8)
+		return color;
 
-	unsigned char bg = (ch >> 12) & 0xF;
-	unsigned char fg = (ch >> 8) & 0xF;
-	u32 fgval = 0, bgval = 0;
-	u16 *dst16;
-	u32 *dst32;
+	return ((((vga_colors[color] >> 0) & 0xff) >> (8 - FI->blue_mask_size)) << FI->blue_mask_pos) |
+		((((vga_colors[color] >> 8) & 0xff) >> (8 - FI->green_mask_size)) << FI->green_mask_pos) |
+		((((vga_colors[color] >> 16) & 0xff) >> (8 - FI->red_mask_size)) << FI->red_mask_pos);
+}
 
-	int x, y;
+static void corebootfb_put_pixel(unsigned char *dst, u32 val)
+{
+	switch (FI->bits_per_pixel) {
+	case 8: /* Indexed */
+		*dst = val;
+		break;
+	case 16: /* 16 bpp */
+		*(u16 *)dst = val;
+		break;
+	case 24: /* 24 bpp */
+		dst[0] = val & 0xff;
+		dst[1] = (val >> 8) & 0xff;
+		dst[2] = (val >> 16) & 0xff;
+		break;
+	case 32: /* 32 bpp */
+		*(u32 *)dst = val;
+		break;
+	}
+}
+
+static void corebootfb_render_glyph_rows(unsigned char *rows, unsigned int ch)
+{
+	const int bpp = FI->bits_per_pixel >> 3;
+	u32 fgval = corebootfb_color((ch >> 8) & 0xF);
+	u32 bgval = corebootfb_color((ch >> 12) & 0xF);
+	int bits, x;
+
+	for (bits = 0; bits < 256; bits++) {
+		for (x = font_width - 1; x >= 0; x--) {
+			corebootfb_put_pixel(rows, (bits & (1 << x/font_scale)) ?
+					     fgval : bgval);
+			rows += bpp;
+		}
+	}
+}
+
+static const unsigned char *corebootfb_glyph_rows(unsigned int ch)
+{
+	unsigned int colors = ch & 0xff00;
+	int i;
+
+	for (i = 0; i < GLYPH_ROW_SETS; i++) {
+		if (glyph_rows[i].rows && glyph_rows[i].colors == colors)
+			return glyph_rows[i].rows;
+	}
 
-	if (FI->bits_per_pixel > 8) {
-		bgval = ((((vga_colors[bg] >> 0) & 0xff) >> (8 - FI->blue_mask_size)) << FI->blue_mask_pos) |
-			((((vga_colors[bg] >> 8) & 0xff) >> (8 - FI->green_mask_size)) << FI->green_mask_pos) |
-			((((vga_colors[bg] >> 16) & 0xff) >> (8 - FI->red_mask_size)) << FI->red_mask_pos);
-		fgval = ((((vga_colors[fg] >> 0) & 0xff) >> (8 - FI->blue_mask_size)) << FI->blue_mask_pos) |
-			((((vga_colors[fg] >> 8) & 0xff) >> (8 - FI->green_mask_size)) << FI->green_mask_pos) |
-			((((vga_colors[fg] >> 16) & 0xff) >> (8 - FI->red_mask_size)) << FI->red_mask_pos);
+	i = glyph_rows_next;
+	glyph_rows_next = (glyph_rows_next + 1) % GLYPH_ROW_SETS;
+	if (!glyph_rows[i].rows) {
+		glyph_rows[i].rows = malloc(256 * glyph_row_bytes);
+		if (!glyph_rows[i].rows)
+			return NULL;
 	}
+	corebootfb_render_glyph_rows(glyph_rows[i].rows, ch);
+	glyph_rows[i].colors = colors;
 
+	return glyph_rows[i].rows;
+}
+
+static void corebootfb_putchar(u8 row, u8 col, unsigned int ch)
+{
+	const int bpp = FI->bits_per_pixel >> 3;
+	const unsigned char *glyph = font8x16 + ((ch & 0xFF) * FONT_HEIGHT);
+	const unsigned char *rows = corebootfb_glyph_rows(ch);
+	unsigned char *dst;
+	u32 fgval, bgval;
+	int x, y;
 
 	dst = FB + ((row * font_height) * FI->bytes_per_line);
-	dst += (col * font_width * (FI->bits_per_pixel >> 3));
-
-	for(y = 0; y < font_height; y++) {
-		for(x = font_width - 1; x >= 0; x--) {
-
-			switch (FI->bits_per_pixel) {
-			case 8: /* Indexed */
-				dst[(font_width - x) * (FI->bits_per_pixel >> 3)] = font_glyph_filled(ch, x, y) ?  fg : bg;
-				break;
-			case 16: /* 16 bpp */
-				dst16 = (u16 *)(dst + (font_width - x) * (FI->bits_per_pixel >> 3));
-				*dst16 = font_glyph_filled(ch, x, y) ? fgval : bgval;
-				break;
-			case 24: /* 24 bpp */
-				if (font_glyph_filled(ch, x, y)) {
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 0] = fgval & 0xff;
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 1] = (fgval >> 8) & 0xff;
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 2] = (fgval >> 16) & 0xff;
-				} else {
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 0] = bgval & 0xff;
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 1] = (bgval >> 8) & 0xff;
-					dst[(font_width - x) * (FI->bits_per_pixel >> 3) + 2] = (bgval >> 16) & 0xff;
-				}
-				break;
-			case 32: /* 32 bpp */
-				dst32 = (u32 *)(dst + (font_width - x) * (FI->bits_per_pixel >> 3));
-				*dst32 = font_glyph_filled(ch, x, y) ? fgval : bgval;
-				break;
-			}
+	dst += (col * font_width * bpp);
+
+	/* Pixels of a glyph start one pixel into its cell. */
+	dst += bpp;
+
+	if (rows) {
+		for (y = 0; y < font_height; y++) {
+			memcpy(dst, rows + glyph[y/font_scale] * glyph_row_bytes,
+			       glyph_row_bytes);
+			dst += FI->bytes_per_line;
 		}
+		return;
+	}
 
+	fgval = corebootfb_color((ch >> 8) & 0xF);
+	bgval = corebootfb_color((ch >> 12) & 0xF);
+
+	for (y = 0; y < font_height; y++) {
+		for (x = font_width - 1; x >= 0; x--)
+			corebootfb_put_pixel(dst + (font_width - 1 - x) * bpp,
+					     font_glyph_filled(ch, x, y) ?
+					     fgval : bgval);
 		dst += FI->bytes_per_line;
 	}
 }
@@ -243,6 +312,8 @@ static int corebootfb_init(void)
 	coreboot_video_console.columns = FI->x_resolution / font_width;
 	coreboot_video_console.rows = FI->y_resolution / font_height;
 
+	glyph_row_bytes = font_width * (FI->bits_per_pixel >> 3);
+
 	/* See setting of fbinfo above. */
 	chars = virt_to_phys(malloc(coreboot_video_console.rows *
 				    coreboot_video_console.columns * 2));
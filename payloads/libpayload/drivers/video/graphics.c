@@ -48,6 +48,17 @@ static struct rect screen;
 static struct cb_framebuffer *fbinfo;
 static uint8_t *fbaddr;
 
+/*
+ * Everything is drawn to 'drawaddr', which either is the framebuffer itself or
+ * a back buffer of the same layout. 'dirty' covers the area of the back buffer
+ * not yet copied to the framebuffer. 'row_buf' holds one line of pixels, which
+ * is built in RAM and then copied out in one go.
+ */
+static uint8_t *drawaddr;
+static uint8_t *back_buffer;
+static struct rect dirty;
+static uint8_t *row_buf;
+
 #define LOG(x...)	printf("CBGFX: " x)
 #define PIVOT_H_MASK	(PIVOT_H_LEFT|PIVOT_H_CENTER|PIVOT_H_RIGHT)
 #define PIVOT_V_MASK	(PIVOT_V_TOP|PIVOT_V_CENTER|PIVOT_V_BOTTOM)
@@ -121,6 +132,14 @@ static inline uint32_t calculate_color(const struct rgb_color *rgb,
 	return color;
 }
 
+static inline void put_pixel(uint8_t *pixel, uint32_t color)
+{
+	const int bpp = fbinfo->bits_per_pixel;
+	int i;
+	for (i = 0; i < bpp / 8; i++)
+		pixel[i] = (color >> (i * 8));
+}
+
 /*
  * Plot a pixel in a framebuffer. This is called from tight loops. Keep it slim
  * and do the validation at callers' site.
@@ -129,10 +148,62 @@ static inline void set_pixel(struct vector *coord, uint32_t color)
 {
 	const int bpp = fbinfo->bits_per_pixel;
 	const int bpl = fbinfo->bytes_per_line;
-	int i;
-	uint8_t * const pixel = fbaddr + coord->y * bpl + coord->x * bpp / 8;
-	for (i = 0; i < bpp / 8; i++)
-		pixel[i] = (color >> (i * 8));
+	put_pixel(drawaddr + coord->y * bpl + coord->x * bpp / 8, color);
+}
+
+/*
+ * Record that the area between top_left and bottom_right (exclusive) is about
+ * to be drawn, so flush_graphics_buffer() knows what to copy.
+ */
+static void mark_dirty(const struct vector *top_left,
+		       const struct vector *bottom_right)
+{
+	struct vector t;
+
+	if (!back_buffer)
+		return;
+
+	if (!dirty.size.width || !dirty.size.height) {
+		dirty.offset = *top_left;
+		dirty.size.width = bottom_right->x - top_left->x;
+		dirty.size.height = bottom_right->y - top_left->y;
+		return;
+	}
+
+	add_vectors(&t, &dirty.offset, &dirty.size);
+	dirty.offset.x = MIN(dirty.offset.x, top_left->x);
+	dirty.offset.y = MIN(dirty.offset.y, top_left->y);
+	dirty.size.width = MAX(t.x, bottom_right->x) - dirty.offset.x;
+	dirty.size.height = MAX(t.y, bottom_right->y) - dirty.offset.y;
+}
+
+/*
+ * Fill the area between top_left and bottom_right (exclusive) with a color.
+ * Only one line is composed pixel by pixel, the rest are copies of it.
+ */
+static void fill_rect(const struct vector *top_left,
+		      const struct vector *bottom_right, uint32_t color)
+{
+	const int bpp = fbinfo->bits_per_pixel;
+	const int bpl = fbinfo->bytes_per_line;
+	const size_t len = (bottom_right->x - top_left->x) * bpp / 8;
+	struct vector p;
+
+	mark_dirty(top_left, bottom_right);
+
+	if (!row_buf) {
+		for (p.y = top_left->y; p.y < bottom_right->y; p.y++)
+			for (p.x = top_left->x; p.x < bottom_right->x; p.x++)
+				set_pixel(&p, color);
+		return;
+	}
+
+	for (p.x = 0; p.x < bottom_right->x - top_left->x; p.x++)
+		put_pixel(row_buf + p.x * bpp / 8, color);
+
+	for (p.y = top_left->y; p.y < bottom_right->y; p.y++)
+		memcpy(drawaddr + p.y * bpl + top_left->x * bpp / 8,
+		       row_buf, len);
 }
 
 /*
@@ -151,6 +222,10 @@ static int cbgfx_init(void)
 	fbaddr = phys_to_virt((uint8_t *)(uintptr_t)(fbinfo->physical_address));
 	if (!fbaddr)
 		return CBGFX_ERROR_FRAMEBUFFER_ADDR;
+	drawaddr = fbaddr;
+
+	/* Without it, drawing falls back to pixel by pixel. */
+	row_buf = malloc(fbinfo->bytes_per_line);
 
 	screen.size.width = fbinfo->x_resolution;
 	screen.size.height = fbinfo->y_resolution;
@@ -182,7 +257,7 @@ int draw_box(const struct rect *box, const struct rgb_color *rgb)
 {
 	struct vector top_left;
 	struct vector size;
-	struct vector p, t;
+	struct vector t;
 	const uint32_t color = calculate_color(rgb, 0);
 	const struct scale top_left_s = {
 		.x = { .n = box->offset.x, .d = CANVAS_SCALE, },
@@ -204,9 +279,7 @@ int draw_box(const struct rect *box, const struct rgb_color *rgb)
 		return CBGFX_ERROR_BOUNDARY;
 	}
 
-	for (p.y = top_left.y; p.y < t.y; p.y++)
-		for (p.x = top_left.x; p.x < t.x; p.x++)
-			set_pixel(&p, color);
+	fill_rect(&top_left, &t, color);
 
 	return CBGFX_SUCCESS;
 }
@@ -232,7 +305,6 @@ int clear_screen(const struct rgb_color *rgb)
 	if (cbgfx_init())
 		return CBGFX_ERROR_INIT;
 
-	struct vector p;
 	uint32_t color = calculate_color(rgb, 0);
 	const int bpp = fbinfo->bits_per_pixel;
 	const int bpl = fbinfo->bytes_per_line;
@@ -241,11 +313,10 @@ int clear_screen(const struct rgb_color *rgb)
 	 * We assume that for 32bpp the high byte gets ignored anyway. */
 	if ((((color >> 8) & 0xff) == (color & 0xff)) && (bpp == 16 ||
 	    (((color >> 16) & 0xff) == (color & 0xff)))) {
-		memset(fbaddr, color & 0xff, screen.size.height * bpl);
+		mark_dirty(&screen.offset, &screen.size);
+		memset(drawaddr, color & 0xff, screen.size.height * bpl);
 	} else {
-		for (p.y = 0; p.y < screen.size.height; p.y++)
-			for (p.x = 0; p.x < screen.size.width; p.x++)
-				set_pixel(&p, color);
+		fill_rect(&screen.offset, &screen.size, color);
 	}
 
 	return CBGFX_SUCCESS;
@@ -324,25 +395,41 @@ static int draw_bitmap_v3(const struct vector *top_left,
 	 * parse_bitmap_header_v3, s0 is guranteed not to exceed pixel array
 	 * boundary.
 	 */
-	struct vector s0, s1, d;
+	struct vector s0, s1, d, t;
 	struct fraction tx, ty;
+	const int fb_bpp = fbinfo->bits_per_pixel;
+	const int bpl = fbinfo->bytes_per_line;
+	const size_t len = dim->width * fb_bpp / 8;
+	int32_t last_s0y = -1, last_tyn = -1;
+
+	add_vectors(&t, top_left, dim);
+	mark_dirty(top_left, &t);
+
 	for (d.y = 0; d.y < dim->height; d.y++, p.y += dir) {
+		uint8_t * const row = drawaddr + p.y * bpl +
+				      top_left->x * fb_bpp / 8;
 		s0.y = d.y * scale->y.d / scale->y.n;
 		s1.y = s0.y;
 		if (s1.y + 1 < dim_org->height)
 			s1.y++;
 		ty.d = scale->y.n;
 		ty.n = (d.y * scale->y.d) % scale->y.n;
+		/* Enlarged images repeat rows, copy the one built last time. */
+		if (row_buf && s0.y == last_s0y && ty.n == last_tyn) {
+			memcpy(row, row_buf, len);
+			continue;
+		}
 		const uint8_t *data0 = pixel_array + s0.y * y_stride;
 		const uint8_t *data1 = pixel_array + s1.y * y_stride;
 		p.x = top_left->x;
+		/* Step through the source without dividing for every pixel. */
+		s0.x = 0;
+		tx.d = scale->x.n;
+		tx.n = 0;
 		for (d.x = 0; d.x < dim->width; d.x++, p.x++) {
-			s0.x = d.x * scale->x.d / scale->x.n;
 			s1.x = s0.x;
 			if (s1.x + 1 < dim_org->width)
 				s1.x++;
-			tx.d = scale->x.n;
-			tx.n = (d.x * scale->x.d) % scale->x.n;
 			uint8_t c00 = data0[s0.x];
 			uint8_t c10 = data0[s1.x];
 			uint8_t c01 = data1[s0.x];
@@ -365,7 +452,21 @@ static int draw_bitmap_v3(const struct vector *top_left,
 					    pal[c01].blue, pal[c11].blue,
 					    &tx, &ty),
 			};
-			set_pixel(&p, calculate_color(&rgb, invert));
+			const uint32_t color = calculate_color(&rgb, invert);
+			if (row_buf)
+				put_pixel(row_buf + d.x * fb_bpp / 8, color);
+			else
+				set_pixel(&p, color);
+			tx.n += scale->x.d;
+			while (tx.n >= tx.d) {
+				tx.n -= tx.d;
+				s0.x++;
+			}
+		}
+		if (row_buf) {
+			memcpy(row, row_buf, len);
+			last_s0y = s0.y;
+			last_tyn = ty.n;
 		}
 	}
 
@@ -668,3 +769,54 @@ int get_bitmap_dimension(const void *bitmap, size_t sz, struct scale *dim_rel)
 
 	return CBGFX_SUCCESS;
 }
+
+int enable_graphics_buffer(void)
+{
+	if (cbgfx_init())
+		return CBGFX_ERROR_INIT;
+
+	if (back_buffer)
+		return CBGFX_SUCCESS;
+
+	back_buffer = malloc(fbinfo->bytes_per_line * screen.size.height);
+	if (!back_buffer)
+		return CBGFX_ERROR_GRAPHICS_BUFFER;
+
+	/* Areas within the dirty rectangle may not all get drawn. */
+	memcpy(back_buffer, fbaddr,
+	       fbinfo->bytes_per_line * screen.size.height);
+	memset(&dirty, 0, sizeof(dirty));
+	drawaddr = back_buffer;
+
+	return CBGFX_SUCCESS;
+}
+
+int flush_graphics_buffer(void)
+{
+	const int bpp = fbinfo ? fbinfo->bits_per_pixel : 0;
+	const int bpl = fbinfo ? fbinfo->bytes_per_line : 0;
+	int32_t y;
+
+	if (!back_buffer)
+		return CBGFX_SUCCESS;
+
+	for (y = dirty.offset.y; y < dirty.offset.y + dirty.size.height; y++) {
+		const size_t offset = y * bpl + dirty.offset.x * bpp / 8;
+		memcpy(fbaddr + offset, back_buffer + offset,
+		       dirty.size.width * bpp / 8);
+	}
+	memset(&dirty, 0, sizeof(dirty));
+
+	return CBGFX_SUCCESS;
+}
+
+void disable_graphics_buffer(void)
+{
+	if (!back_buffer)
+		return;
+
+	flush_graphics_buffer();
+	free(back_buffer);
+	back_buffer = NULL;
+	drawaddr = fbaddr;
+}
@@ -63,6 +63,34 @@ static void gdb_write_memory(struct gdb_message *command,
 	gdb_message_add_string(reply, "OK");
 }
 
+static void gdb_write_memory_binary(struct gdb_message *command,
+				    int offset, struct gdb_message *reply)
+{
+	int tok = gdb_message_tokenize(command, &offset);
+	uintptr_t addr = gdb_message_decode_int(command, tok, offset - 1 - tok);
+	tok = gdb_message_tokenize(command, &offset);
+	size_t length = gdb_message_decode_int(command, tok, offset - 1 - tok);
+
+	/* GDB probes for 'X' support with an empty write. */
+	if (length) {
+		offset = gdb_message_decode_binary(command, offset,
+						   (void *)addr, length);
+		cache_sync_instructions();
+	}
+
+	die_if(offset != command->used, "Invalid length field in GDB "
+	       "command: %.*s", command->used, command->buf);
+	gdb_message_add_string(reply, "OK");
+}
+
+static void gdb_query_supported(struct gdb_message *command,
+				int offset, struct gdb_message *reply)
+{
+	/* Lets GDB send (and so ask for) as much as fits in one packet. */
+	gdb_message_add_string(reply, "PacketSize=");
+	gdb_message_encode_int(reply, command->size);
+}
+
 static void gdb_continue(struct gdb_message *command,
 			 int offset, struct gdb_message *reply)
 {
@@ -91,6 +119,8 @@ struct gdb_command gdb_commands[] = {
 	{ "G", &gdb_write_general_registers },
 	{ "m", &gdb_read_memory },
 	{ "M", &gdb_write_memory },
+	{ "X", &gdb_write_memory_binary },
+	{ "qSupported", &gdb_query_supported },
 	{ "c", &gdb_continue },
 	{ "s", &gdb_single_step }
 };
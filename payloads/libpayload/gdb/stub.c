@@ -17,8 +17,9 @@
 
 struct gdb_state gdb_state;
 
-static u8 reply_buf[2048];
-static u8 command_buf[2048];
+/* Big enough that dumping a few MiB over serial doesn't take ages. */
+static u8 reply_buf[16 * KiB];
+static u8 command_buf[16 * KiB];
 
 static struct gdb_message command = {
 	.buf = command_buf,
@@ -112,6 +112,42 @@ void gdb_message_decode_bytes(const struct gdb_message *message, int offset,
 	}
 }
 
+static u8 decode_binary_byte(const struct gdb_message *message, int *offset)
+{
+	u8 c;
+
+	die_if(*offset >= message->used, "Decode overrun in GDB message: "
+	       "%.*s", message->used, message->buf);
+	c = message->buf[(*offset)++];
+	if (c != '}')
+		return c;
+
+	die_if(*offset >= message->used, "Decode overrun in GDB message: "
+	       "%.*s", message->used, message->buf);
+	return message->buf[(*offset)++] ^ 0x20;
+}
+
+/* Binary data as in 'X' packets, '}' escapes the next byte (xored w/ 0x20). */
+int gdb_message_decode_binary(const struct gdb_message *message, int offset,
+			      void *data, int length)
+{
+	mmio_word_t *aligned =
+		(mmio_word_t *)ALIGN_DOWN((uintptr_t)data, sizeof(*aligned));
+	int shift = ((void *)(aligned + 1) - data) * 8;
+	mmio_word_t word = be32toh(readl(aligned)) >> shift;
+	while (length--) {
+		word <<= 8;
+		word |= decode_binary_byte(message, &offset);
+		if (++data - (void *)aligned == sizeof(*aligned))
+			writel(htobe32(word), aligned++);
+	}
+	if (data != (void *)aligned) {
+		shift = ((void *)(aligned + 1) - data) * 8;
+		clrsetbits_be32(aligned, ~((1 << shift) - 1), word << shift);
+	}
+	return offset;
+}
+
 void gdb_message_encode_zero_bytes(struct gdb_message *message, int length)
 {
 	die_if(message->used + length * 2 > message->size, output_overrun);
@@ -226,19 +262,54 @@ void gdb_get_command(struct gdb_message *command)
 	}
 }
 
-void gdb_send_reply(const struct gdb_message *reply)
+/*
+ * Run-length encode the reply on the fly ("c*n" repeats c another n - 29
+ * times) and return the checksum over what was (or would have been) sent.
+ * Memory dumps are mostly runs of '0' and 'f', which this cuts down a lot.
+ */
+static u8 gdb_put_reply_data(const struct gdb_message *reply, int send)
 {
-	int i;
-	int retries = 1 * 1000 * 1000 / timeout_us;
 	u8 checksum = 0;
+	int i, run;
+
+	for (i = 0; i < reply->used; i += run) {
+		u8 c = reply->buf[i];
+		u8 out[3] = { c, '*' };
+		int j, count = 1;
+
+		for (run = 1; run < 98 && i + run < reply->used; run++)
+			if (reply->buf[i + run] != c)
+				break;
+
+		/* Repeat counts of 6 and 7 would be sent as '#' and '$'. */
+		if (run == 7 || run == 8)
+			run = 6;
 
-	for (i = 0; i < reply->used; i++)
-		checksum += reply->buf[i];
+		if (run > 3 && c != '#' && c != '$' && c != '*' && c != '}') {
+			out[2] = 29 + run - 1;
+			count = 3;
+		} else {
+			run = 1;
+		}
+
+		for (j = 0; j < count; j++) {
+			checksum += out[j];
+			if (send)
+				gdb_raw_putchar(out[j]);
+		}
+	}
+
+	return checksum;
+}
+
+void gdb_send_reply(const struct gdb_message *reply)
+{
+	int retries = 1 * 1000 * 1000 / timeout_us;
+	u8 checksum = gdb_put_reply_data(reply, 0);
 
 	do {
 		gdb_raw_putchar('$');
-		for (i = 0; i < reply->used; i++)
-			gdb_raw_putchar(reply->buf[i]);
+		gdb_put_reply_data(reply, 1);
 		gdb_raw_putchar('#');
 		gdb_raw_putchar(to_hex(checksum >> 4));
 		gdb_raw_putchar(to_hex(checksum & 0xf));
@@ -80,4 +80,8 @@ int run_address(void *f);
 /* Defined in individual arch / board implementation. */
 int init_default_cbfs_media(struct cbfs_media *media);
 
+/* Drops the cached directory of the default media, e.g. after switching to
+ * a different CBFS. */
+void cbfs_cache_invalidate(void);
+
 #endif
@@ -274,6 +274,13 @@ struct cbfs_handle {
  * Caller is responsible to free() returned handle after use. */
 struct cbfs_handle *cbfs_get_handle(struct cbfs_media *media, const char *name);
 
+/* Calls fn() with the name and type of every file in the CBFS, in order,
+ * until it returns non-zero. Returns 1 if fn() stopped the walk, 0 if the
+ * end was reached and -1 on error. */
+int cbfs_for_each_file(struct cbfs_media *media,
+		       int (*fn)(void *arg, const char *name, uint32_t type),
+		       void *arg);
+
 /* Given a cbfs_handle and an attribute tag, return a mapping for the first
  * instance of the attribute or NULL if none found. */
 void *cbfs_get_attr(struct cbfs_handle *handle, uint32_t tag);
@@ -283,4 +290,18 @@ void *cbfs_get_attr(struct cbfs_handle *handle, uint32_t tag);
  * If |limit| is not 0, will only return up to that many bytes. */
 void *cbfs_get_contents(struct cbfs_handle *handle, size_t *size, size_t limit);
 
+/* Given a cbfs_handle, decompresses (or copies) the file contents straight
+ * into |buf| without an intermediate buffer. Uncompressed files are cut off
+ * at |buf_size|, compressed ones must fit entirely. Returns the number of
+ * bytes written, or 0 on error. */
+size_t cbfs_load_contents(struct cbfs_handle *handle, void *buf,
+			  size_t buf_size);
+
+/* Given a cbfs_handle to an uncompressed file, returns a mapping of its
+ * contents, or NULL on error or if the file is compressed. On memory mapped
+ * media this points straight into the CBFS, without a copy. If |size| is
+ * passed, the file size is stored there. Release with cbfs_unmap_contents(). */
+void *cbfs_map_contents(struct cbfs_handle *handle, size_t *size);
+void cbfs_unmap_contents(struct cbfs_handle *handle, void *data);
+
 #endif
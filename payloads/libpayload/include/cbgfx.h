@@ -57,6 +57,8 @@
 #define CBGFX_ERROR_FRAMEBUFFER_ADDR	0x15
 /* portrait screen not supported */
 #define CBGFX_ERROR_PORTRAIT_SCREEN	0x16
+/* failed to allocate the back buffer */
+#define CBGFX_ERROR_GRAPHICS_BUFFER	0x17
 
 struct fraction {
 	int32_t n;
@@ -192,3 +194,27 @@ int draw_bitmap_direct(const void *bitmap, size_t size,
  * in the original size are returned.
  */
 int get_bitmap_dimension(const void *bitmap, size_t sz, struct scale *dim_rel);
+
+/**
+ * Draw into a back buffer in RAM instead of the framebuffer
+ *
+ * @return CBGFX_* error codes
+ *
+ * Reading and writing the framebuffer is slow. Once this is called, all
+ * drawing functions only update a copy of the screen in RAM, and the changed
+ * area is copied to the framebuffer by flush_graphics_buffer().
+ */
+int enable_graphics_buffer(void);
+
+/**
+ * Copy everything drawn since the last flush from the back buffer to the
+ * framebuffer. Does nothing if the back buffer isn't enabled.
+ *
+ * @return CBGFX_* error codes
+ */
+int flush_graphics_buffer(void);
+
+/**
+ * Flush and free the back buffer, drawing directly to the framebuffer again.
+ */
+void disable_graphics_buffer(void);
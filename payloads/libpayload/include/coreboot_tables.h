@@ -287,6 +287,29 @@ struct cb_macs {
 	struct mac_address mac_addrs[0];
 };
 
+#define CB_TAG_MMC_INFO		0x0035
+struct cb_mmc_info {
+	uint32_t tag;
+	uint32_t size;
+	/*
+	 * 1 if CMD1 was sent to the eMMC device before the payload and it may
+	 * still be powering up, so the payload must not reset it with CMD0.
+	 */
+	int32_t early_cmd1_status;
+};
+
+#define CB_TAG_DIRECTORY	0x0036
+struct cb_directory_entry {
+	uint32_t tag;
+	uint32_t offset;	/* from the start of the cb_header */
+};
+
+struct cb_directory {
+	uint32_t tag;
+	uint32_t size;
+	struct cb_directory_entry entries[0];
+};
+
 #define CB_TAG_SERIALNO		0x002a
 #define CB_MAX_SERIALNO_LENGTH	32
 
@@ -0,0 +1,86 @@
+/*
+ * This file is part of the libpayload project.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _EVENT_LOOP_H
+#define _EVENT_LOOP_H
+
+#include <stdint.h>
+
+/*
+ * A small cooperative event loop for polling drivers. Nothing runs behind
+ * the caller's back: timers fire and pollers run only from event_poll(),
+ * which event_wait() and event_udelay() call while they wait, and which
+ * the console calls while waiting for input.
+ */
+
+struct event_timer;
+typedef void (*event_timer_func)(struct event_timer *timer, void *arg);
+
+/* Deadline, owned by the caller. Keep it alive while it is armed. */
+struct event_timer {
+	struct event_timer *next;
+	uint64_t deadline;		/* in timer_us(0) time */
+	event_timer_func func;
+	void *arg;
+	int armed;
+};
+
+/* Called on every pass of the event loop. */
+struct event_poller {
+	struct event_poller *next;
+	void (*poll)(void *arg);
+	void *arg;
+};
+
+void event_timer_init(struct event_timer *timer, event_timer_func func,
+		      void *arg);
+/* (Re)arms the timer to fire once, us microseconds from now. The callback
+ * may re-arm its own timer. */
+void event_timer_arm(struct event_timer *timer, uint64_t us);
+void event_timer_cancel(struct event_timer *timer);
+static inline int event_timer_armed(const struct event_timer *timer)
+{
+	return timer->armed;
+}
+
+void event_add_poller(struct event_poller *poller);
+void event_remove_poller(struct event_poller *poller);
+
+/* Runs every poller once and fires all expired timers. */
+void event_poll(void);
+
+/* Runs the event loop until done(arg) returns non-zero or timeout_us
+ * microseconds have passed. Returns 0 if done, -1 on timeout. */
+int event_wait(int (*done)(void *arg), void *arg, uint64_t timeout_us);
+
+/* udelay()/mdelay() that keep running the event loop. The event loop
+ * doesn't nest, so from pollers and timer callbacks these are plain
+ * busy waits. */
+void event_udelay(unsigned int us);
+void event_mdelay(unsigned int ms);
+
+#endif
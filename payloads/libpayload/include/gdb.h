@@ -61,6 +61,8 @@ void gdb_message_encode_bytes(struct gdb_message *message, const void *data,
 			      int length);
 void gdb_message_decode_bytes(const struct gdb_message *message, int offset,
 			      void *data, int length);
+int gdb_message_decode_binary(const struct gdb_message *message, int offset,
+			      void *data, int length);
 void gdb_message_encode_zero_bytes(struct gdb_message *message, int length);
 
 void gdb_message_add_string(struct gdb_message *message, const char *string);
@@ -45,6 +45,7 @@ typedef enum {
 	PORT_TYPE_IDE	= (1 << 0),
 	PORT_TYPE_SATA	= (1 << 1),
 	PORT_TYPE_USB	= (1 << 2),
+	PORT_TYPE_NVME	= (1 << 3),
 } storage_port_t;
 
 typedef enum {
@@ -65,6 +66,12 @@ typedef struct storage_dev {
 	ssize_t (*read_blocks512)(struct storage_dev *, lba_t start, size_t count, unsigned char *buf);
 	ssize_t (*write_blocks512)(struct storage_dev *, lba_t start, size_t count, const unsigned char *buf);
 
+	/* Queued reads (optional): read_blocks512_start() returns 0 if the
+	   read was queued, read_blocks512_finish() waits for the oldest
+	   queued read and returns like read_blocks512(). */
+	int (*read_blocks512_start)(struct storage_dev *, lba_t start, size_t count, unsigned char *buf);
+	ssize_t (*read_blocks512_finish)(struct storage_dev *);
+
 	void (*detach_device)(struct storage_dev *);
 } storage_dev_t;
 
@@ -74,5 +81,7 @@ int storage_attach_device(storage_dev_t *dev);
 
 storage_poll_t storage_probe(size_t dev_num);
 ssize_t storage_read_blocks512(size_t dev_num, lba_t start, size_t count, unsigned char *buf);
+int storage_read_blocks512_start(size_t dev_num, lba_t start, size_t count, unsigned char *buf);
+ssize_t storage_read_blocks512_finish(size_t dev_num);
 
 #endif
@@ -129,6 +129,7 @@ struct sysinfo_t {
 	uint64_t mtc_start;
 	uint32_t mtc_size;
 	void	*chromeos_vpd;
+	int	mmc_early_wake_status;
 };
 
 extern struct sysinfo_t lib_sysinfo;
@@ -147,4 +148,12 @@ int cb_parse_arch_specific(struct cb_record *rec, struct sysinfo_t *info);
  */
 int cb_parse_header(void *addr, int len, struct sysinfo_t *info);
 
+/*
+ * Return the first record with the given tag in the coreboot table that was
+ * parsed into info, or NULL if there is none. Records that cb_parse_header()
+ * doesn't know about can be picked up this way, and coreboot's table
+ * directory makes the lookup cheap.
+ */
+struct cb_record *cb_find_record(const struct sysinfo_t *info, u32 tag);
+
 #endif
@@ -220,6 +220,7 @@ struct usbdev_hc {
 	hc_type type;
 	int latest_address;
 	usbdev_t *devices[128];	// dev 0 is root hub, 127 is last addressable
+	int port_busy;		// a port is being reset and addressed
 
 	/* start():     Resume operation. */
 	void (*start) (hci_t *controller);
@@ -237,6 +238,13 @@ struct usbdev_hc {
 	void (*shutdown) (hci_t *controller);
 
 	int (*bulk) (endpoint_t *ep, int size, u8 *data, int finalize);
+	/* bulk_start():	Queue a bulk transfer without waiting for it
+				(optional). The buffer has to be DMA coherent.
+				Returns 0 if the transfer was queued.
+	   bulk_finish():	Wait for the oldest transfer queued on ep
+				and return like bulk(). */
+	int (*bulk_start) (endpoint_t *ep, int size, u8 *data);
+	int (*bulk_finish) (endpoint_t *ep);
 	int (*control) (usbdev_t *dev, direction_t pid, int dr_length,
 			void *devreq, int data_length, u8 *data);
 	void* (*create_intr_queue) (endpoint_t *ep, int reqsize, int reqcount, int reqtiming);
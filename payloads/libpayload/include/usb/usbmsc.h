@@ -38,6 +38,8 @@ typedef struct {
 	s8 ready;
 	u8 lun;
 	u8 num_luns;
+	unsigned int max_transfer; /* bytes per READ/WRITE command */
+	void *csw; /* DMA-able CSW buffer for queued reads, may be NULL */
 	void *data; /* For use by consumers of libpayload. */
 } usbmsc_inst_t;
 
@@ -30,6 +30,7 @@
 #include <libpayload-config.h>
 #include <libpayload.h>
 #include <usb/usb.h>
+#include <event_loop.h>
 
 struct console_output_driver *console_out;
 struct console_input_driver *console_in;
@@ -150,6 +151,7 @@ int havekey(void)
 #if IS_ENABLED(CONFIG_LP_USB)
 	usb_poll();
 #endif
+	event_poll();
 	struct console_input_driver *in;
 	for (in = console_in; in != 0; in = in->next)
 		if (in->havekey())
@@ -167,6 +169,7 @@ int getchar(void)
 #if IS_ENABLED(CONFIG_LP_USB)
 		usb_poll();
 #endif
+		event_poll();
 		struct console_input_driver *in;
 		for (in = console_in; in != 0; in = in->next)
 			if (in->havechar()) {
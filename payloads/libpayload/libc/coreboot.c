@@ -240,6 +240,13 @@ static void cb_parse_vpd(void *ptr, struct sysinfo_t *info)
 	info->chromeos_vpd = phys_to_virt(cbmem->cbmem_tab);
 }
 
+static void cb_parse_mmc_info(unsigned char *ptr, struct sysinfo_t *info)
+{
+	struct cb_mmc_info *mmc_info = (struct cb_mmc_info *)ptr;
+
+	info->mmc_early_wake_status = mmc_info->early_cmd1_status;
+}
+
 #if IS_ENABLED(CONFIG_LP_TIMER_RDTSC)
 static void cb_parse_tsc_info(void *ptr, struct sysinfo_t *info)
 {
@@ -277,7 +284,8 @@ int cb_parse_header(void *addr, int len, struct sysinfo_t *info)
 	if (!header->table_bytes)
 		return 0;
 
-	if (ipchksum((u16 *) (ptr + sizeof(*header)),
+	if (IS_ENABLED(CONFIG_LP_CB_TABLE_CHECKSUM) &&
+	    ipchksum((u16 *) (ptr + sizeof(*header)),
 		     header->table_bytes) != header->table_checksum)
 		return -1;
 
@@ -413,6 +421,9 @@ int cb_parse_header(void *addr, int len, struct sysinfo_t *info)
 		case CB_TAG_VPD:
 			cb_parse_vpd(ptr, info);
 			break;
+		case CB_TAG_MMC_INFO:
+			cb_parse_mmc_info(ptr, info);
+			break;
 		default:
 			cb_parse_arch_specific(rec, info);
 			break;
@@ -423,3 +434,39 @@ int cb_parse_header(void *addr, int len, struct sysinfo_t *info)
 
 	return 0;
 }
+
+struct cb_record *cb_find_record(const struct sysinfo_t *info, u32 tag)
+{
+	unsigned char *ptr = (unsigned char *)info->header;
+	struct cb_record *rec;
+	int i;
+
+	if (!ptr)
+		return NULL;
+
+	ptr += info->header->header_bytes;
+	rec = (struct cb_record *)ptr;
+
+	if (info->header->table_entries && rec->tag == CB_TAG_DIRECTORY) {
+		struct cb_directory *dir = (struct cb_directory *)rec;
+		int entries = (dir->size - sizeof(*dir)) /
+			sizeof(dir->entries[0]);
+
+		for (i = 0; i < entries; i++) {
+			if (dir->entries[i].tag == tag)
+				return (struct cb_record *)
+					((unsigned char *)info->header +
+					 dir->entries[i].offset);
+		}
+		return NULL;
+	}
+
+	for (i = 0; i < info->header->table_entries; i++) {
+		rec = (struct cb_record *)ptr;
+		if (rec->tag == tag)
+			return rec;
+		ptr += rec->size;
+	}
+
+	return NULL;
+}
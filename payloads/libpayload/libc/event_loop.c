@@ -0,0 +1,204 @@
+/*
+ * This file is part of the libpayload project.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <libpayload.h>
+#include <event_loop.h>
+
+/*
+ * Timers hash into a wheel of WHEEL_SLOTS slots by their deadline in
+ * units of 2^WHEEL_SHIFT us (about a millisecond). Timers further away
+ * than one turn of the wheel simply stay in their slot until it comes
+ * around with their deadline passed.
+ */
+#define WHEEL_SHIFT	10
+#define WHEEL_SLOTS	64
+
+static struct event_timer *wheel[WHEEL_SLOTS];
+static int timers_armed;
+static uint64_t wheel_tick;	/* oldest tick that may hold expired timers */
+
+static struct event_poller *pollers;
+static int in_event_poll;
+
+static struct event_timer **wheel_slot(uint64_t deadline)
+{
+	return &wheel[(deadline >> WHEEL_SHIFT) % WHEEL_SLOTS];
+}
+
+static void timer_unlink(struct event_timer *timer)
+{
+	struct event_timer **link = wheel_slot(timer->deadline);
+
+	for (; *link; link = &(*link)->next) {
+		if (*link == timer) {
+			*link = timer->next;
+			break;
+		}
+	}
+	timer->armed = 0;
+	timers_armed--;
+}
+
+void event_timer_init(struct event_timer *timer, event_timer_func func,
+		      void *arg)
+{
+	memset(timer, 0, sizeof(*timer));
+	timer->func = func;
+	timer->arg = arg;
+}
+
+void event_timer_arm(struct event_timer *timer, uint64_t us)
+{
+	struct event_timer **slot;
+	uint64_t now = timer_us(0);
+
+	if (timer->armed)
+		timer_unlink(timer);
+
+	/* Nothing is pending, so there are no old slots to look at. */
+	if (!timers_armed)
+		wheel_tick = now >> WHEEL_SHIFT;
+
+	timer->deadline = now + us;
+	slot = wheel_slot(timer->deadline);
+	timer->next = *slot;
+	*slot = timer;
+	timer->armed = 1;
+	timers_armed++;
+}
+
+void event_timer_cancel(struct event_timer *timer)
+{
+	if (timer->armed)
+		timer_unlink(timer);
+}
+
+/* Fires the expired timers of one slot. */
+static void run_slot(struct event_timer **slot, uint64_t now)
+{
+	struct event_timer *timer;
+
+again:
+	for (timer = *slot; timer; timer = timer->next) {
+		if (timer->deadline > now)
+			continue;
+		timer_unlink(timer);
+		timer->func(timer, timer->arg);
+		/* The callback may have changed the list, start over. */
+		goto again;
+	}
+}
+
+static void run_timers(void)
+{
+	uint64_t now = timer_us(0);
+	uint64_t tick, now_tick = now >> WHEEL_SHIFT;
+
+	if (now_tick - wheel_tick >= WHEEL_SLOTS)
+		wheel_tick = now_tick - WHEEL_SLOTS + 1;
+
+	/* The current tick stays in range, its timers may not be due yet. */
+	for (tick = wheel_tick; tick <= now_tick && timers_armed; tick++)
+		run_slot(&wheel[tick % WHEEL_SLOTS], now);
+
+	wheel_tick = now_tick;
+}
+
+void event_add_poller(struct event_poller *poller)
+{
+	struct event_poller *p;
+
+	for (p = pollers; p; p = p->next)
+		if (p == poller)
+			return;
+
+	poller->next = pollers;
+	pollers = poller;
+}
+
+void event_remove_poller(struct event_poller *poller)
+{
+	struct event_poller **link;
+
+	for (link = &pollers; *link; link = &(*link)->next) {
+		if (*link == poller) {
+			*link = poller->next;
+			return;
+		}
+	}
+}
+
+void event_poll(void)
+{
+	struct event_poller *p, *next;
+
+	if (in_event_poll)
+		return;
+	in_event_poll = 1;
+
+	for (p = pollers; p; p = next) {
+		/* Pollers may remove themselves. */
+		next = p->next;
+		p->poll(p->arg);
+	}
+
+	if (timers_armed)
+		run_timers();
+
+	in_event_poll = 0;
+}
+
+int event_wait(int (*done)(void *arg), void *arg, uint64_t timeout_us)
+{
+	uint64_t start = timer_us(0);
+
+	while (!done(arg)) {
+		if (timer_us(start) >= timeout_us)
+			return done(arg) ? 0 : -1;
+		event_poll();
+	}
+
+	return 0;
+}
+
+static void event_delay(uint64_t us)
+{
+	uint64_t start = timer_us(0);
+
+	while (timer_us(start) < us)
+		event_poll();
+}
+
+void event_udelay(unsigned int us)
+{
+	event_delay(us);
+}
+
+void event_mdelay(unsigned int ms)
+{
+	event_delay((uint64_t)ms * 1000);
+}
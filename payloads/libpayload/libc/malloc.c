@@ -34,6 +34,11 @@
  * through the tree for every malloc() and free(). Obviously, this doesn't
  * scale past a few hundred KB (if that).
  *
+ * Small blocks are the exception: once freed they are kept on a per size
+ * class freelist (still marked as used in the heap) and handed out again
+ * without walking the heap. The freelists are only given back to the heap
+ * when an allocation could not be satisfied otherwise.
+ *
  * We're also susceptible to the usual buffer overrun poisoning, though the
  * risk is within acceptable ranges for this implementation (don't overrun
  * your buffers, kids!).
@@ -43,6 +48,12 @@
 #include <libpayload.h>
 #include <stdint.h>
 
+/* Requests up to SMALL_MAX bytes are rounded up to a multiple of
+ * SMALL_GRANULE and recycled through per-size freelists. */
+#define SMALL_GRANULE	16
+#define SMALL_MAX	512
+#define SMALL_CLASSES	(SMALL_MAX / SMALL_GRANULE)
+
 struct memory_type {
 	void *start;
 	void *end;
@@ -52,6 +63,8 @@ struct memory_type {
 	size_t minimal_free;
 	const char *name;
 #endif
+	/* Heads of the small block freelists, linked through the payload. */
+	void *small_free[SMALL_CLASSES];
 };
 
 extern char _heap, _eheap;	/* Defined in the ldscript. */
@@ -103,6 +116,7 @@ void init_dma_memory(void *start, u32 size)
 	dma->start = start;
 	dma->end = start + size;
 	dma->align_regions = NULL;
+	memset(dma->small_free, 0, sizeof(dma->small_free));
 
 #if IS_ENABLED(CONFIG_LP_DEBUG_MALLOC)
 	dma->minimal_free = 0;
@@ -225,10 +239,77 @@ static void _consolidate(struct memory_type *type)
 	}
 }
 
+/* Hand all cached small blocks back to the heap. */
+static void small_flush(struct memory_type *type)
+{
+	int i;
+
+	for (i = 0; i < SMALL_CLASSES; i++) {
+		void *ptr = type->small_free[i];
+
+		while (ptr != NULL) {
+			void *next = *(void **)ptr;
+			hdrtype_t *hdr = (hdrtype_t *)(ptr - HDRSIZE);
+
+			*hdr = FREE_BLOCK(SIZE(*hdr));
+			ptr = next;
+		}
+		type->small_free[i] = NULL;
+	}
+	_consolidate(type);
+}
+
+static void *small_alloc(int len, struct memory_type *type)
+{
+	int class = (len - 1) / SMALL_GRANULE;
+	void *ptr = type->small_free[class];
+	hdrtype_t hdr;
+
+	if (ptr != NULL) {
+		hdr = *(hdrtype_t *)(ptr - HDRSIZE);
+		/* Someone wrote past the end of the previous block. */
+		if (!HAS_MAGIC(hdr) || (hdr & FLAG_FREE)) {
+			printf("memory allocator panic. (bad small block)\n");
+			halt();
+		}
+		type->small_free[class] = *(void **)ptr;
+		return ptr;
+	}
+
+	len = (class + 1) * SMALL_GRANULE;
+	ptr = alloc(len, type);
+	if (ptr == NULL) {
+		small_flush(type);
+		ptr = alloc(len, type);
+	}
+	return ptr;
+}
+
+/* Small requests are served from the freelists, everything else from
+ * the heap proper. */
+static void *alloc_any(size_t len, struct memory_type *type)
+{
+	void *ptr;
+
+	if (len == 0)
+		return NULL;
+
+	if (len <= SMALL_MAX)
+		return small_alloc(len, type);
+
+	ptr = alloc(len, type);
+	if (ptr == NULL) {
+		small_flush(type);
+		ptr = alloc(len, type);
+	}
+	return ptr;
+}
+
 void free(void *ptr)
 {
 	hdrtype_t hdr;
 	struct memory_type *type = heap;
+	size_t size;
 
 	/* Sanity check. */
 	if (ptr < type->start || ptr >= type->end) {
@@ -239,8 +320,7 @@ void free(void *ptr)
 
 	if (free_aligned(ptr, type)) return;
 
-	ptr -= HDRSIZE;
-	hdr = *((hdrtype_t *) ptr);
+	hdr = *((hdrtype_t *) (ptr - HDRSIZE));
 
 	/* Not our header (we're probably poisoned). */
 	if (!HAS_MAGIC(hdr))
@@ -250,24 +330,48 @@ void free(void *ptr)
 	if (hdr & FLAG_FREE)
 		return;
 
-	*((hdrtype_t *) ptr) = FREE_BLOCK(SIZE(hdr));
+	/*
+	 * Keep small blocks for reuse. A block may be slightly larger than
+	 * its size class if alloc() handed out a whole free block, so file
+	 * it under the largest class it can hold.
+	 */
+	size = SIZE(hdr);
+	if (size >= SMALL_GRANULE && size <= SMALL_MAX) {
+		int class = size / SMALL_GRANULE - 1;
+
+#if IS_ENABLED(CONFIG_LP_DEBUG_MALLOC)
+		void *p;
+		for (p = type->small_free[class]; p; p = *(void **)p) {
+			if (p == ptr) {
+				printf("%s: double free of %p\n", type->name,
+				       ptr);
+				return;
+			}
+		}
+#endif
+		*(void **)ptr = type->small_free[class];
+		type->small_free[class] = ptr;
+		return;
+	}
+
+	*((hdrtype_t *) (ptr - HDRSIZE)) = FREE_BLOCK(size);
 	_consolidate(type);
 }
 
 void *malloc(size_t size)
 {
-	return alloc(size, heap);
+	return alloc_any(size, heap);
 }
 
 void *dma_malloc(size_t size)
 {
-	return alloc(size, dma);
+	return alloc_any(size, dma);
 }
 
 void *calloc(size_t nmemb, size_t size)
 {
 	size_t total = nmemb * size;
-	void *ptr = alloc(total, heap);
+	void *ptr = alloc_any(total, heap);
 
 	if (ptr)
 		memset(ptr, 0, total);
@@ -282,7 +386,7 @@ void *realloc(void *ptr, size_t size)
 	struct memory_type *type = heap;
 
 	if (ptr == NULL)
-		return alloc(size, type);
+		return alloc_any(size, type);
 
 	pptr = ptr - HDRSIZE;
 
@@ -295,23 +399,40 @@ void *realloc(void *ptr, size_t size)
 	/* Get the original size of the block. */
 	osize = SIZE(*((hdrtype_t *) pptr));
 
+	if (size == 0) {
+		free(ptr);
+		return NULL;
+	}
+
 	/*
-	 * Free the memory to update the tables - this won't touch the actual
-	 * memory, so we can still use it for the copy after we have
-	 * reallocated the new space.
+	 * Shrink in place. Large blocks give their tail back to the heap,
+	 * small ones just keep it.
 	 */
-	free(ptr);
-	ret = alloc(size, type);
+	if (size <= osize) {
+		size_t len = ALIGN_UP(size, HDRSIZE);
+
+		if (osize > SMALL_MAX && osize - len > HDRSIZE) {
+			*((hdrtype_t *) pptr) = USED_BLOCK(len);
+			*((hdrtype_t *) (ptr + len)) =
+				FREE_BLOCK(osize - len - HDRSIZE);
+			_consolidate(type);
+		}
+		return ptr;
+	}
 
 	/*
-	 * if ret == NULL, then doh - failure.
-	 * if ret == ptr then woo-hoo! no copy needed.
+	 * Get the new block before letting go of the old one: freeing first
+	 * may merge the old block into a free block in front of it, and
+	 * the new block could then overlap the data we still have to copy.
+	 * Small blocks also have their first bytes reused for the freelist
+	 * as soon as they are freed.
 	 */
-	if (ret == NULL || ret == ptr)
-		return ret;
+	ret = alloc_any(size, type);
+	if (ret == NULL)
+		return NULL;
 
-	/* Copy the memory to the new location. */
-	memcpy(ret, ptr, osize > size ? size : osize);
+	memcpy(ret, ptr, osize);
+	free(ptr);
 
 	return ret;
 }
@@ -382,7 +503,7 @@ static struct align_region_t *allocate_region(int alignment, int num_elements,
 		extra_space = 0;
 	}
 
-	r->start = alloc(r->size + alignment + extra_space, type);
+	r->start = alloc_any(r->size + alignment + extra_space, type);
 
 	if (r->start == NULL) {
 		free(r);
@@ -33,6 +33,9 @@
 
 #include <libpayload.h>
 
+/* Word accesses to the caller's buffers must not break strict aliasing. */
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
 static void *default_memset(void *const s, const int c, size_t n)
 {
 	size_t i;
@@ -48,7 +51,7 @@ static void *default_memset(void *const s, const int c, size_t n)
 		w = (w << (i * 8)) | w;
 
 	for (i = 0; i < n / sizeof(unsigned long); i++)
-		((unsigned long *)dst)[i] = w;
+		((word_t *)dst)[i] = w;
 
 	dst += i * sizeof(unsigned long);
 
@@ -65,15 +68,32 @@ static void *default_memcpy(void *dst, const void *src, size_t n)
 {
 	size_t i;
 	void *ret = dst;
-
-	if (IS_ALIGNED((uintptr_t)dst, sizeof(unsigned long)) &&
-	    IS_ALIGNED((uintptr_t)src, sizeof(unsigned long))) {
-		for (i = 0; i < n / sizeof(unsigned long); i++)
-			((unsigned long *)dst)[i] = ((unsigned long *)src)[i];
-
-		src += i * sizeof(unsigned long);
-		dst += i * sizeof(unsigned long);
-		n -= i * sizeof(unsigned long);
+	const size_t w = sizeof(unsigned long);
+
+	/*
+	 * If both pointers can be aligned at the same time, copy bytes up to
+	 * the alignment and then four words per iteration.
+	 */
+	if (IS_ALIGNED((uintptr_t)dst ^ (uintptr_t)src, w)) {
+		for (; n > 0 && !IS_ALIGNED((uintptr_t)dst, w); n--)
+			*(u8 *)dst++ = *(const u8 *)src++;
+
+		for (; n >= 4 * w; n -= 4 * w, dst += 4 * w, src += 4 * w) {
+			word_t *d = dst;
+			const word_t *s = src;
+
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			d[3] = s[3];
+		}
+
+		for (i = 0; i < n / w; i++)
+			((word_t *)dst)[i] = ((const word_t *)src)[i];
+
+		src += i * w;
+		dst += i * w;
+		n -= i * w;
 	}
 
 	for (i = 0; i < n; i++)
@@ -106,7 +126,7 @@ static void *default_memmove(void *dst, const void *src, size_t n)
 		((u8 *)dst)[i + offs] = ((u8 *)src)[i + offs];
 
 	for (i = n / sizeof(unsigned long) - 1; i >= 0; i--)
-		((unsigned long *)dst)[i] = ((unsigned long *)src)[i];
+		((word_t *)dst)[i] = ((const word_t *)src)[i];
 
 	return dst;
 }
@@ -128,15 +148,21 @@ void *memmove(void *dst, const void *src, size_t n)
 static int default_memcmp(const void *s1, const void *s2, size_t n)
 {
 	size_t i = 0;
-	const unsigned long *w1 = s1, *w2 = s2;
+	const size_t w = sizeof(unsigned long);
 
-	if (IS_ALIGNED((uintptr_t)s1, sizeof(unsigned long)) &&
-	    IS_ALIGNED((uintptr_t)s2, sizeof(unsigned long)))
-		for (; i < n / sizeof(unsigned long); i++)
-			if (w1[i] != w2[i])
+	if (IS_ALIGNED((uintptr_t)s1 ^ (uintptr_t)s2, w)) {
+		/* Compare bytes up to the alignment, then whole words. */
+		for (; i < n && !IS_ALIGNED((uintptr_t)s1 + i, w); i++)
+			if (((u8 *)s1)[i] != ((u8 *)s2)[i])
+				return ((u8 *)s1)[i] - ((u8 *)s2)[i];
+
+		for (; i + w <= n; i += w)
+			if (*(const word_t *)(s1 + i) !=
+			    *(const word_t *)(s2 + i))
 				break; /* fall through to find differing byte */
+	}
 
-	for (i *= sizeof(unsigned long); i < n; i++)
+	for (; i < n; i++)
 		if (((u8 *)s1)[i] != ((u8 *)s2)[i])
 			return ((u8 *)s1)[i] - ((u8 *)s2)[i];
 
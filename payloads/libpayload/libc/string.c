@@ -35,6 +35,21 @@
 #include <inttypes.h>
 #include <errno.h>
 
+/*
+ * The string functions below work a word at a time where they can. A word
+ * w contains a NUL byte iff HAS_ZERO(w) is non-zero. Aligned word loads
+ * never cross a page boundary, so reading a few bytes past the end of a
+ * string this way is harmless. The loads go through word_t, which may
+ * alias the chars they cover.
+ */
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+
+#define WORD		sizeof(word_t)
+#define ONES		((unsigned long)-1 / 0xff)
+#define HIGHS		(ONES << 7)
+#define HAS_ZERO(w)	(((w) - ONES) & ~(w) & HIGHS)
+#define WORD_ALIGNED(p)	IS_ALIGNED((uintptr_t)(p), WORD)
+
 /**
  * Calculate the length of a fixed-size string.
  *
@@ -45,17 +60,25 @@
  */
 size_t strnlen(const char *str, size_t maxlen)
 {
-	size_t len = 0;
+	const char *p = str;
 
 	/* NULL and empty strings have length 0. */
 	if (!str)
 		return 0;
 
+	for (; maxlen && !WORD_ALIGNED(p); p++, maxlen--)
+		if (*p == '\0')
+			return p - str;
+
+	for (; maxlen >= WORD; p += WORD, maxlen -= WORD)
+		if (HAS_ZERO(*(const word_t *)p))
+			break;
+
 	/* Loop until we find a NUL character, or maxlen is reached. */
-	while ((*str++ != '\0') && (len < maxlen))
-		len++;
+	for (; maxlen && *p != '\0'; p++, maxlen--)
+		;
 
-	return len;
+	return p - str;
 }
 
 /**
@@ -66,17 +89,24 @@ size_t strnlen(const char *str, size_t maxlen)
  */
 size_t strlen(const char *str)
 {
-	size_t len = 0;
+	const char *p = str;
 
 	/* NULL and empty strings have length 0. */
 	if (!str)
 		return 0;
 
+	for (; !WORD_ALIGNED(p); p++)
+		if (*p == '\0')
+			return p - str;
+
+	while (!HAS_ZERO(*(const word_t *)p))
+		p += WORD;
+
 	/* Loop until we find a NUL character. */
-	while (*str++ != '\0')
-		len++;
+	while (*p != '\0')
+		p++;
 
-	return len;
+	return p - str;
 }
 
 /**
@@ -134,15 +164,24 @@ int strncasecmp(const char *s1, const char *s2, size_t maxlen)
  */
 int strcmp(const char *s1, const char *s2)
 {
-	int i, res;
+	/* Compare words if both strings can be aligned at the same time. */
+	if (WORD_ALIGNED((uintptr_t)s1 ^ (uintptr_t)s2)) {
+		for (; !WORD_ALIGNED(s1); s1++, s2++)
+			if (*s1 != *s2 || *s1 == '\0')
+				return *s1 - *s2;
 
-	for (i = 0; 1; i++) {
-		res = s1[i] - s2[i];
-		if (res || (s1[i] == '\0'))
-			break;
+		for (; ; s1 += WORD, s2 += WORD) {
+			unsigned long w = *(const word_t *)s1;
+
+			if (w != *(const word_t *)s2 || HAS_ZERO(w))
+				break;
+		}
 	}
 
-	return res;
+	for (; *s1 == *s2 && *s1 != '\0'; s1++, s2++)
+		;
+
+	return *s1 - *s2;
 }
 
 /**
@@ -155,16 +194,25 @@ int strcmp(const char *s1, const char *s2)
  */
 int strncmp(const char *s1, const char *s2, size_t maxlen)
 {
-	int i, res;
+	/* Compare words if both strings can be aligned at the same time. */
+	if (WORD_ALIGNED((uintptr_t)s1 ^ (uintptr_t)s2)) {
+		for (; maxlen && !WORD_ALIGNED(s1); s1++, s2++, maxlen--)
+			if (*s1 != *s2 || *s1 == '\0')
+				return *s1 - *s2;
 
-	res = 0;
-	for (i = 0; i < maxlen; i++) {
-		res = s1[i] - s2[i];
-		if (res || (s1[i] == '\0'))
-			break;
+		for (; maxlen >= WORD; s1 += WORD, s2 += WORD, maxlen -= WORD) {
+			unsigned long w = *(const word_t *)s1;
+
+			if (w != *(const word_t *)s2 || HAS_ZERO(w))
+				break;
+		}
 	}
 
-	return res;
+	for (; maxlen; s1++, s2++, maxlen--)
+		if (*s1 != *s2 || *s1 == '\0')
+			return *s1 - *s2;
+
+	return 0;
 }
 
 /**
@@ -178,11 +226,9 @@ int strncmp(const char *s1, const char *s2, size_t maxlen)
 char *strncpy(char *d, const char *s, size_t n)
 {
 	/* Use +1 to get the NUL terminator. */
-	int max = n > strlen(s) + 1 ? strlen(s) + 1 : n;
-	int i;
+	size_t max = strnlen(s, n);
 
-	for (i = 0; i < max; i++)
-		d[i] = (char)s[i];
+	memcpy(d, s, max < n ? max + 1 : n);
 
 	return d;
 }
@@ -209,13 +255,8 @@ char *strcpy(char *d, const char *s)
 char *strcat(char *d, const char *s)
 {
 	char *p = d + strlen(d);
-	int sl = strlen(s);
-	int i;
 
-	for (i = 0; i < sl; i++)
-		p[i] = s[i];
-
-	p[i] = '\0';
+	memcpy(p, s, strlen(s) + 1);
 	return d;
 }
 
@@ -232,13 +273,9 @@ char *strncat(char *d, const char *s, size_t n)
 	char *p = d + strlen(d);
 	int sl = strlen(s);
 	int max = n > sl ? sl : n;
-	// int max = n > strlen(s) ? strlen(s) : n;
-	int i;
 
-	for (i = 0; i < max; i++)
-		p[i] = s[i];
-
-	p[i] = '\0';
+	memcpy(p, s, max);
+	p[max] = '\0';
 	return d;
 }
 
@@ -257,12 +294,9 @@ size_t strlcat(char *d, const char *s, size_t n)
 
 	char *p = d + dl;
 	int max = n > (sl + dl) ? sl : (n - dl - 1);
-	int i;
-
-	for (i = 0; i < max; i++)
-		p[i] = s[i];
 
-	p[i] = '\0';
+	memcpy(p, s, max);
+	p[max] = '\0';
 	return max;
 }
 
@@ -276,14 +310,31 @@ size_t strlcat(char *d, const char *s, size_t n)
  */
 char *strchr(const char *s, int c)
 {
-	char *p = (char *)s;
+	const unsigned char ch = c;
+	const unsigned long mask = ch * ONES;
+	const unsigned char *p = (const unsigned char *)s;
+
+	for (; !WORD_ALIGNED(p); p++) {
+		if (*p == ch)
+			return (char *)p;
+		if (*p == '\0')
+			return NULL;
+	}
 
-	for (; *p != 0; p++) {
-		if (*p == c)
-			return p;
+	/* Skip words that contain neither the character nor a NUL. */
+	for (; ; p += WORD) {
+		unsigned long w = *(const word_t *)p;
+
+		if (HAS_ZERO(w) || HAS_ZERO(w ^ mask))
+			break;
 	}
 
-	return NULL;
+	for (; *p != ch; p++) {
+		if (*p == '\0')
+			return NULL;
+	}
+
+	return (char *)p;
 }
 
 /**
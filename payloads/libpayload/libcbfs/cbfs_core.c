@@ -135,36 +135,18 @@ static int get_cbfs_range(uint32_t *offset, uint32_t *cbfs_end,
 	return 0;
 }
 
-/* public API starts here*/
-struct cbfs_handle *cbfs_get_handle(struct cbfs_media *media, const char *name)
+/* Walks the files from offset to cbfs_end and calls fn() for each of them
+ * with its offset, header and name. Stops and returns 1 as soon as fn()
+ * returns non-zero, returns 0 once the end is reached. */
+static int cbfs_walk(struct cbfs_media *media, uint32_t offset,
+		     uint32_t cbfs_end,
+		     int (*fn)(void *arg, uint32_t offset,
+			       const struct cbfs_file *file, const char *name),
+		     void *arg)
 {
 	const char *vardata;
-	uint32_t offset, cbfs_end, vardata_len;
+	uint32_t vardata_len;
 	struct cbfs_file file;
-	struct cbfs_handle *handle = malloc(sizeof(*handle));
-
-	if (!handle)
-		return NULL;
-
-	if (get_cbfs_range(&offset, &cbfs_end, media)) {
-		ERROR("Failed to find cbfs range\n");
-		free(handle);
-		return NULL;
-	}
-
-	if (media == CBFS_DEFAULT_MEDIA) {
-		media = &handle->media;
-		if (init_default_cbfs_media(media) != 0) {
-			ERROR("Failed to initialize default media.\n");
-			free(handle);
-			return NULL;
-		}
-	} else {
-		memcpy(&handle->media, media, sizeof(*media));
-	}
-
-	DEBUG("CBFS location: 0x%x~0x%x\n", offset, cbfs_end);
-	DEBUG("Looking for '%s' starting from 0x%x.\n", name, offset);
 
 	media->open(media);
 	while (offset < cbfs_end &&
@@ -190,23 +172,11 @@ struct cbfs_handle *cbfs_get_handle(struct cbfs_media *media, const char *name)
 				media, offset + sizeof(file), vardata_len);
 		if (vardata == CBFS_MEDIA_INVALID_MAP_ADDRESS) {
 			ERROR("ERROR: Failed to get filename: 0x%x.\n", offset);
-		} else if (strcmp(vardata, name) == 0) {
-			int file_offset = ntohl(file.offset),
-			    file_len = ntohl(file.len);
-			DEBUG("Found file (offset=0x%x, len=%d).\n",
-			    offset + file_offset, file_len);
+		} else if (fn(arg, offset, &file, vardata)) {
 			media->unmap(media, vardata);
 			media->close(media);
-			handle->type = ntohl(file.type);
-			handle->media_offset = offset;
-			handle->content_offset = file_offset;
-			handle->content_size = file_len;
-			handle->attribute_offset =
-				ntohl(file.attributes_offset);
-			return handle;
+			return 1;
 		} else {
-			DEBUG(" (unmatched file @0x%x: %s)\n", offset,
-			      vardata);
 			media->unmap(media, vardata);
 		}
 
@@ -216,52 +186,347 @@ struct cbfs_handle *cbfs_get_handle(struct cbfs_media *media, const char *name)
 			offset += CBFS_ALIGNMENT - (offset % CBFS_ALIGNMENT);
 	}
 	media->close(media);
+	return 0;
+}
+
+static void fill_handle(struct cbfs_handle *handle, uint32_t offset,
+			const struct cbfs_file *file)
+{
+	handle->type = ntohl(file->type);
+	handle->media_offset = offset;
+	handle->content_offset = ntohl(file->offset);
+	handle->content_size = ntohl(file->len);
+	handle->attribute_offset = ntohl(file->attributes_offset);
+}
+
+struct find_arg {
+	const char *name;
+	struct cbfs_handle *handle;
+};
+
+static int find_file(void *arg, uint32_t offset, const struct cbfs_file *file,
+		     const char *name)
+{
+	struct find_arg *find = arg;
+
+	if (strcmp(name, find->name) != 0) {
+		DEBUG(" (unmatched file @0x%x: %s)\n", offset, name);
+		return 0;
+	}
+
+	DEBUG("Found file (offset=0x%x, len=%d).\n",
+	      offset + ntohl(file->offset), ntohl(file->len));
+	fill_handle(find->handle, offset, file);
+	return 1;
+}
+
+#if IS_ENABLED(CONFIG_LP_CBFS_CACHE)
+/*
+ * Directory of the default CBFS media, read once on the first lookup so
+ * that later lookups don't have to walk the whole CBFS again.
+ */
+struct cbfs_cache_entry {
+	uint32_t hash;
+	char *name;
+	struct cbfs_handle handle;	/* without media */
+};
+
+static struct {
+	int valid;
+	int count;
+	int allocated;
+	struct cbfs_cache_entry *entries;
+} cbfs_cache;
+
+static uint32_t cbfs_name_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;	/* FNV-1a */
+
+	while (*name)
+		hash = (hash ^ (uint8_t)*name++) * 16777619u;
+
+	return hash;
+}
+
+static int cache_file(void *arg, uint32_t offset, const struct cbfs_file *file,
+		      const char *name)
+{
+	struct cbfs_cache_entry *e;
+
+	if (cbfs_cache.count == cbfs_cache.allocated) {
+		int allocated = cbfs_cache.allocated ? cbfs_cache.allocated * 2
+						     : 32;
+		e = realloc(cbfs_cache.entries, allocated * sizeof(*e));
+		if (!e)
+			return 1;
+		cbfs_cache.entries = e;
+		cbfs_cache.allocated = allocated;
+	}
+
+	e = &cbfs_cache.entries[cbfs_cache.count];
+	e->name = strdup(name);
+	if (!e->name)
+		return 1;
+	e->hash = cbfs_name_hash(name);
+	fill_handle(&e->handle, offset, file);
+	cbfs_cache.count++;
+	return 0;
+}
+
+void cbfs_cache_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < cbfs_cache.count; i++)
+		free(cbfs_cache.entries[i].name);
+	free(cbfs_cache.entries);
+	memset(&cbfs_cache, 0, sizeof(cbfs_cache));
+}
+
+static int cbfs_cache_fill(struct cbfs_media *media)
+{
+	uint32_t offset, cbfs_end;
+
+	if (get_cbfs_range(&offset, &cbfs_end, CBFS_DEFAULT_MEDIA))
+		return -1;
+
+	/* cache_file() only stops the walk when it runs out of memory. */
+	if (cbfs_walk(media, offset, cbfs_end, cache_file, NULL)) {
+		ERROR("Out of memory while caching the CBFS directory.\n");
+		cbfs_cache_invalidate();
+		return -1;
+	}
+
+	cbfs_cache.valid = 1;
+	return 0;
+}
+
+/* Returns 1 if the file was found, 0 if it doesn't exist and -1 if the
+ * cache isn't available. */
+static int cbfs_cache_lookup(struct cbfs_handle *handle, const char *name)
+{
+	uint32_t hash = cbfs_name_hash(name);
+	struct cbfs_media media = handle->media;
+	int i;
+
+	if (!cbfs_cache.valid && cbfs_cache_fill(&handle->media))
+		return -1;
+
+	for (i = 0; i < cbfs_cache.count; i++) {
+		struct cbfs_cache_entry *e = &cbfs_cache.entries[i];
+
+		if (e->hash != hash || strcmp(e->name, name) != 0)
+			continue;
+		*handle = e->handle;
+		handle->media = media;
+		return 1;
+	}
+
+	return 0;
+}
+#else
+void cbfs_cache_invalidate(void)
+{
+}
+#endif
+
+/* public API starts here*/
+struct cbfs_handle *cbfs_get_handle(struct cbfs_media *media, const char *name)
+{
+	uint32_t offset, cbfs_end;
+	struct find_arg find;
+	struct cbfs_handle *handle = malloc(sizeof(*handle));
+
+	if (!handle)
+		return NULL;
+
+	if (media == CBFS_DEFAULT_MEDIA) {
+		if (init_default_cbfs_media(&handle->media) != 0) {
+			ERROR("Failed to initialize default media.\n");
+			free(handle);
+			return NULL;
+		}
+
+#if IS_ENABLED(CONFIG_LP_CBFS_CACHE)
+		switch (cbfs_cache_lookup(handle, name)) {
+		case 1:
+			return handle;
+		case 0:
+			LOG("WARNING: '%s' not found.\n", name);
+			free(handle);
+			return NULL;
+		}
+		/* No cache, fall back to walking the CBFS. */
+#endif
+	} else {
+		memcpy(&handle->media, media, sizeof(*media));
+	}
+
+	if (get_cbfs_range(&offset, &cbfs_end, media)) {
+		ERROR("Failed to find cbfs range\n");
+		free(handle);
+		return NULL;
+	}
+
+	DEBUG("CBFS location: 0x%x~0x%x\n", offset, cbfs_end);
+	DEBUG("Looking for '%s' starting from 0x%x.\n", name, offset);
+
+	find.name = name;
+	find.handle = handle;
+	if (cbfs_walk(&handle->media, offset, cbfs_end, find_file, &find))
+		return handle;
+
 	LOG("WARNING: '%s' not found.\n", name);
 	free(handle);
 	return NULL;
 }
 
-void *cbfs_get_contents(struct cbfs_handle *handle, size_t *size, size_t limit)
+struct for_each_arg {
+	int (*fn)(void *arg, const char *name, uint32_t type);
+	void *arg;
+};
+
+static int for_each_file(void *arg, uint32_t offset,
+			 const struct cbfs_file *file, const char *name)
+{
+	struct for_each_arg *each = arg;
+
+	return each->fn(each->arg, name, ntohl(file->type));
+}
+
+int cbfs_for_each_file(struct cbfs_media *media,
+		       int (*fn)(void *arg, const char *name, uint32_t type),
+		       void *arg)
+{
+	uint32_t offset, cbfs_end;
+	struct cbfs_media m;
+	struct for_each_arg each = { .fn = fn, .arg = arg };
+
+	if (media == CBFS_DEFAULT_MEDIA) {
+		if (init_default_cbfs_media(&m) != 0) {
+			ERROR("Failed to initialize default media.\n");
+			return -1;
+		}
+	} else {
+		memcpy(&m, media, sizeof(*media));
+	}
+
+	if (get_cbfs_range(&offset, &cbfs_end, media)) {
+		ERROR("Failed to find cbfs range\n");
+		return -1;
+	}
+
+	return cbfs_walk(&m, offset, cbfs_end, for_each_file, &each);
+}
+
+static int cbfs_get_compression(struct cbfs_handle *handle, size_t *size)
+{
+	struct cbfs_file_attr_compression *comp =
+		cbfs_get_attr(handle, CBFS_FILE_ATTR_TAG_COMPRESSION);
+
+	if (!comp) {
+		*size = handle->content_size;
+		return CBFS_COMPRESS_NONE;
+	}
+
+	*size = ntohl(comp->decompressed_size);
+	return ntohl(comp->compression);
+}
+
+void *cbfs_map_contents(struct cbfs_handle *handle, size_t *size)
 {
 	struct cbfs_media *m = &handle->media;
-	size_t on_media_size = handle->content_size;
-	int algo = CBFS_COMPRESS_NONE;
-	void *ret = NULL;
 	size_t dummy_size;
+	void *data;
 
 	if (!size)
 		size = &dummy_size;
 
-	struct cbfs_file_attr_compression *comp =
-		cbfs_get_attr(handle, CBFS_FILE_ATTR_TAG_COMPRESSION);
-	if (comp) {
-		algo = ntohl(comp->compression);
-		DEBUG("File '%s' is compressed (alg=%d)\n", name, algo);
-		*size = ntohl(comp->decompressed_size);
-		/* TODO: Implement partial decompression with |limit| */
-	}
+	if (cbfs_get_compression(handle, size) != CBFS_COMPRESS_NONE)
+		return NULL;
+
+	data = m->map(m, handle->media_offset + handle->content_offset,
+		      handle->content_size);
+	if (data == CBFS_MEDIA_INVALID_MAP_ADDRESS)
+		return NULL;
+
+	return data;
+}
+
+void cbfs_unmap_contents(struct cbfs_handle *handle, void *data)
+{
+	handle->media.unmap(&handle->media, data);
+}
+
+size_t cbfs_load_contents(struct cbfs_handle *handle, void *buf,
+			  size_t buf_size)
+{
+	struct cbfs_media *m = &handle->media;
+	size_t offset = handle->media_offset + handle->content_offset;
+	size_t size, ret = 0;
+	int algo;
+	void *data;
+
+	algo = cbfs_get_compression(handle, &size);
 
+	/* Uncompressed data goes straight from the media into buf. */
 	if (algo == CBFS_COMPRESS_NONE) {
-		if (limit != 0 && limit < on_media_size) {
-			*size = limit;
-			on_media_size = limit;
-		} else {
-			*size = on_media_size;
-		}
+		if (size > buf_size)
+			size = buf_size;
+		if (m->read(m, buf, offset, size) != size)
+			return 0;
+		return size;
+	}
+
+	if (size > buf_size) {
+		ERROR("File needs %zu bytes, buffer has %zu.\n", size,
+		      buf_size);
+		return 0;
 	}
 
-	void *data = m->map(m, handle->media_offset + handle->content_offset,
-			    on_media_size);
+	data = m->map(m, offset, handle->content_size);
 	if (data == CBFS_MEDIA_INVALID_MAP_ADDRESS)
-		return NULL;
+		return 0;
+
+	switch (algo) {
+#ifdef CBFS_CORE_WITH_LZMA
+	case CBFS_COMPRESS_LZMA:
+		ret = ulzman(data, handle->content_size, buf, buf_size);
+		break;
+#endif
+#ifdef CBFS_CORE_WITH_LZ4
+	case CBFS_COMPRESS_LZ4:
+		ret = ulz4fn(data, handle->content_size, buf, buf_size);
+		break;
+#endif
+	default:
+		ERROR("Unsupported compression algorithm #%x.\n", algo);
+		break;
+	}
+
+	m->unmap(m, data);
+	return ret;
+}
+
+void *cbfs_get_contents(struct cbfs_handle *handle, size_t *size, size_t limit)
+{
+	void *ret;
+	size_t dummy_size;
+
+	if (!size)
+		size = &dummy_size;
+
+	/* TODO: Implement partial decompression with |limit| */
+	if (cbfs_get_compression(handle, size) == CBFS_COMPRESS_NONE &&
+	    limit != 0 && limit < *size)
+		*size = limit;
 
 	ret = malloc(*size);
-	if (ret != NULL && !cbfs_decompress(algo, data, ret, *size)) {
+	if (ret != NULL && !cbfs_load_contents(handle, ret, *size)) {
 		free(ret);
 		ret = NULL;
 	}
 
-	m->unmap(m, data);
 	return ret;
 }
 
@@ -94,16 +94,20 @@ static struct cbfs_media default_cbfs_media;
 
 int setup_cbfs_from_ram(void *start, uint32_t size) {
 	int result = init_cbfs_ram_media(&default_cbfs_media, start, size);
-	if (result == 0)
+	if (result == 0) {
 		is_default_cbfs_media_initialized = 1;
+		cbfs_cache_invalidate();
+	}
 	return result;
 }
 
 extern int libpayload_init_default_cbfs_media(struct cbfs_media *media);
 int setup_cbfs_from_flash(void) {
 	int result = libpayload_init_default_cbfs_media(&default_cbfs_media);
-	if (result == 0)
+	if (result == 0) {
 	    is_default_cbfs_media_initialized = 1;
+	    cbfs_cache_invalidate();
+	}
 	return result;
 }
 
@@ -45,6 +45,7 @@ unsigned long ulzman(const unsigned char *src, unsigned long srcn,
 		return 0;
 	}
 	state.Probs = (CProb *)scratchpad;
+	state.InCallback = NULL;
 	res = LzmaDecode(&state, src + data_offset, srcn - data_offset,
 			 &inProcessed, dst, outSize, &outProcessed);
 	free(scratchpad);
@@ -12,6 +12,7 @@
 #define CONFIG_LP_SERIAL_CONSOLE 1
 #define CONFIG_LP_PC_KEYBOARD 1
 #define CONFIG_LP_ARCH_X86 1
+#define CONFIG_LP_LITTLE_ENDIAN 1
 #define CONFIG_LP_STORAGE_ATA 1
 #define CONFIG_LP_ARCH_SPECIFIC_OPTIONS 1
 #define CONFIG_LP_STORAGE_AHCI_ONLY_TESTED 1
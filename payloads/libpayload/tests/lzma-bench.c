@@ -0,0 +1,111 @@
+/*
+ * Decompression benchmark for the LZMA decoder. Pass it LZMA (".lzma",
+ * as produced by cbfstool or "xz --format=lzma") compressed files, for
+ * example stages pulled out of a coreboot image:
+ *
+ *   cbfstool coreboot.rom extract -n fallback/ramstage -f ramstage -U
+ *   xz --format=lzma -k ramstage
+ *   ./lzma-bench ramstage.lzma
+ *
+ * Each file is decoded repeatedly and the throughput is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "../liblzma/lzmadecode.c"
+
+#define MIN_USECS	(1000 * 1000)
+
+static unsigned long decode(const unsigned char *src, unsigned long srcn,
+			    unsigned char *dst, unsigned long dstn,
+			    CProb *probs)
+{
+	CLzmaDecoderState state;
+	SizeT in_processed, out_processed;
+
+	if (LzmaDecodeProperties(&state.Properties, src,
+				 LZMA_PROPERTIES_SIZE) != LZMA_RESULT_OK)
+		return 0;
+	state.Probs = probs;
+	state.InCallback = NULL;
+	if (LzmaDecode(&state, src + LZMA_PROPERTIES_SIZE + 8,
+		       srcn - LZMA_PROPERTIES_SIZE - 8, &in_processed,
+		       dst, dstn, &out_processed) != LZMA_RESULT_OK)
+		return 0;
+	return out_processed;
+}
+
+static void *read_file(const char *name, size_t *size)
+{
+	FILE *f = fopen(name, "rb");
+	void *data;
+	long len;
+
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(len);
+	if (data && fread(data, len, 1, f) != 1) {
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	*size = len;
+	return data;
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		struct timeval start, end;
+		unsigned long out_size, out, runs = 0;
+		unsigned char *in, *dst;
+		CProb *probs;
+		size_t in_size;
+		long usecs;
+
+		in = read_file(argv[i], &in_size);
+		if (!in || in_size < LZMA_PROPERTIES_SIZE + 8) {
+			printf("%s: could not read\n", argv[i]);
+			return 1;
+		}
+		out_size = in[LZMA_PROPERTIES_SIZE] |
+			   in[LZMA_PROPERTIES_SIZE + 1] << 8 |
+			   in[LZMA_PROPERTIES_SIZE + 2] << 16 |
+			   (unsigned long)in[LZMA_PROPERTIES_SIZE + 3] << 24;
+		dst = malloc(out_size);
+		/* Enough for any lc + lp <= 12. */
+		probs = malloc(LZMA_BASE_SIZE * sizeof(CProb) +
+			       (LZMA_LIT_SIZE << 12) * sizeof(CProb));
+
+		gettimeofday(&start, NULL);
+		do {
+			out = decode(in, in_size, dst, out_size, probs);
+			if (out != out_size) {
+				printf("%s: decoding failed\n", argv[i]);
+				return 1;
+			}
+			runs++;
+			gettimeofday(&end, NULL);
+			usecs = (end.tv_sec - start.tv_sec) * 1000000 +
+				(end.tv_usec - start.tv_usec);
+		} while (usecs < MIN_USECS);
+
+		printf("%s: %lu -> %lu bytes, %lu MB/s\n", argv[i],
+		       (unsigned long)in_size, out_size,
+		       (unsigned long)((unsigned long long)out_size * runs /
+				       usecs));
+		free(probs);
+		free(dst);
+		free(in);
+	}
+
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Stress test and micro benchmark for the libpayload allocator. The
+ * allocator is built into this program under different names so it
+ * doesn't clash with the host C library.
+ */
+
+#define malloc lp_malloc
+#define free lp_free
+#define calloc lp_calloc
+#define realloc lp_realloc
+#define memalign lp_memalign
+#include "../libc/malloc.c"
+#undef malloc
+#undef free
+#undef calloc
+#undef realloc
+#undef memalign
+
+#define HEAP_SIZE	(4 * 1024 * 1024)
+#define SLOTS		4096
+#define ROUNDS		20000
+
+#define _STR(x)		#x
+#define STR(x)		_STR(x)
+
+/* The ldscript normally provides these. */
+asm(".bss\n"
+    ".balign 16\n"
+    ".globl _heap\n"
+    "_heap: .skip " STR(HEAP_SIZE) "\n"
+    ".globl _eheap\n"
+    "_eheap:\n"
+    ".text\n");
+
+static struct {
+	unsigned char *ptr;
+	size_t size;
+	unsigned char pattern;
+} slots[SLOTS];
+
+void halt(void)
+{
+	exit(1);
+}
+
+int fail(const char *str)
+{
+	printf("%s", str);
+	exit(1);
+}
+
+static unsigned int seed = 1;
+
+static size_t random_size(void)
+{
+	unsigned int r = rand_r(&seed);
+
+	/* Mostly small objects, like USB descriptors and FS metadata. */
+	if (r % 16)
+		return 1 + (r >> 4) % 256;
+	return 1 + (r >> 4) % 16384;
+}
+
+static void check_slot(int i)
+{
+	size_t j;
+
+	for (j = 0; j < slots[i].size; j++)
+		if (slots[i].ptr[j] != slots[i].pattern)
+			fail("heap corruption detected\n");
+}
+
+static void fill_slot(int i, size_t size)
+{
+	slots[i].size = size;
+	slots[i].pattern = rand_r(&seed);
+	memset(slots[i].ptr, slots[i].pattern, size);
+}
+
+static void stress(void)
+{
+	int n, i;
+
+	for (n = 0; n < ROUNDS; n++) {
+		i = rand_r(&seed) % SLOTS;
+
+		if (slots[i].ptr) {
+			check_slot(i);
+			if (rand_r(&seed) % 4 == 0) {
+				size_t size = random_size();
+				size_t keep = MIN(size, slots[i].size);
+				unsigned char *p = lp_realloc(slots[i].ptr,
+							      size);
+				if (!p)
+					fail("realloc failed\n");
+				slots[i].ptr = p;
+				slots[i].size = keep;
+				check_slot(i);
+				fill_slot(i, size);
+			} else {
+				lp_free(slots[i].ptr);
+				slots[i].ptr = NULL;
+			}
+			continue;
+		}
+
+		size_t size = random_size();
+		slots[i].ptr = lp_malloc(size);
+		if (!slots[i].ptr)
+			fail("malloc failed\n");
+		fill_slot(i, size);
+	}
+
+	for (i = 0; i < SLOTS; i++) {
+		if (!slots[i].ptr)
+			continue;
+		check_slot(i);
+		lp_free(slots[i].ptr);
+		slots[i].ptr = NULL;
+	}
+}
+
+/* Cached small blocks must not keep a large request from succeeding. */
+static void exhaust(void)
+{
+	void *head = NULL, *p;
+
+	while ((p = lp_malloc(512)) != NULL) {
+		*(void **)p = head;
+		head = p;
+	}
+	while (head) {
+		p = *(void **)head;
+		lp_free(head);
+		head = p;
+	}
+	p = lp_malloc(HEAP_SIZE / 2);
+	if (!p)
+		fail("freed small blocks were not returned to the heap\n");
+	lp_free(p);
+}
+
+static void benchmark(void)
+{
+	struct timeval start, end;
+	void *ptrs[64];
+	int n, i;
+
+	gettimeofday(&start, NULL);
+	for (n = 0; n < ROUNDS; n++) {
+		for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+			ptrs[i] = lp_malloc(8 + (i * 8) % 248);
+		for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+			lp_free(ptrs[i]);
+	}
+	gettimeofday(&end, NULL);
+
+	printf("%d small malloc/free pairs took %ld ms\n",
+	       ROUNDS * (int)ARRAY_SIZE(ptrs),
+	       (end.tv_sec - start.tv_sec) * 1000 +
+	       (end.tv_usec - start.tv_usec) / 1000);
+}
+
+int main(int argc, char **argv)
+{
+	stress();
+	exhaust();
+	stress();
+	benchmark();
+	exit(0);
+}
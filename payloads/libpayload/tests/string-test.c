@@ -0,0 +1,147 @@
+/*
+ * Checks the word-at-a-time string and memory functions against simple
+ * byte loops, for every combination of alignments and lengths around a
+ * word boundary.
+ */
+
+/* libpayload's errno would clash with the host's thread-local one. */
+#define errno lp_errno
+#include "../libc/string.c"
+#include "../libc/memory.c"
+
+int errno;
+
+#define MAX_OFFSET	16
+#define MAX_LEN		80
+#define BUF_SIZE	(MAX_OFFSET + MAX_LEN + 32)
+
+static unsigned long abuf[BUF_SIZE / sizeof(unsigned long)];
+static unsigned long bbuf[BUF_SIZE / sizeof(unsigned long)];
+
+void die_work(const char *file, const char *func, const int line,
+	      const char *fmt, ...)
+{
+	exit(1);
+}
+
+int fail(const char *str)
+{
+	printf("%s", str);
+	exit(1);
+}
+
+static int sign(int x)
+{
+	return x < 0 ? -1 : x > 0;
+}
+
+/* Fill buf with non-zero junk and put len 'x's at offset off. */
+static char *make_string(unsigned long *buf, int off, int len)
+{
+	char *b = (char *)buf;
+	int i;
+
+	for (i = 0; i < BUF_SIZE; i++)
+		b[i] = 0x80 | (i * 7);
+	for (i = 0; i < len; i++)
+		b[off + i] = 'x';
+	b[off + len] = '\0';
+
+	return b + off;
+}
+
+static void test_strings(void)
+{
+	int off1, off2, len, diff;
+
+	for (off1 = 0; off1 < MAX_OFFSET; off1++)
+	for (len = 0; len < MAX_LEN; len++) {
+		char *s = make_string(abuf, off1, len);
+
+		if (strlen(s) != len)
+			fail("strlen\n");
+		if (strnlen(s, len / 2) != len / 2)
+			fail("strnlen (limit)\n");
+		if (strnlen(s, len + 5) != len)
+			fail("strnlen\n");
+		if (strchr(s, 'y') != NULL)
+			fail("strchr (missing)\n");
+		if (strchr(s, '\0') != s + len)
+			fail("strchr (terminator)\n");
+		if (len) {
+			s[len - 1] = 'y';
+			if (strchr(s, 'y') != s + len - 1)
+				fail("strchr\n");
+			s[len - 1] = 'x';
+		}
+
+		for (off2 = 0; off2 < MAX_OFFSET; off2++)
+		for (diff = -1; diff < len; diff++) {
+			char *t = make_string(bbuf, off2, len);
+
+			if (diff >= 0)
+				t[diff] = 'z';
+			if (sign(strcmp(s, t)) != (diff >= 0 ? -1 : 0))
+				fail("strcmp\n");
+			if (sign(strcmp(t, s)) != (diff >= 0 ? 1 : 0))
+				fail("strcmp (swapped)\n");
+			if (sign(strncmp(s, t, diff + 1)) != (diff >= 0 ? -1 : 0))
+				fail("strncmp\n");
+			if (diff >= 0 && strncmp(s, t, diff) != 0)
+				fail("strncmp (limit)\n");
+			if (diff >= 0 && sign(memcmp(s, t, len)) != -1)
+				fail("memcmp\n");
+			if (diff < 0 && memcmp(s, t, len) != 0)
+				fail("memcmp (equal)\n");
+		}
+
+		/* Shorter string compares less. */
+		if (len && sign(strcmp(s + 1, s)) != -1)
+			fail("strcmp (prefix)\n");
+	}
+}
+
+static void test_memory(void)
+{
+	int off1, off2, len, i;
+	u8 *a = (u8 *)abuf, *b = (u8 *)bbuf;
+	u8 c[BUF_SIZE];
+
+	for (off1 = 0; off1 < MAX_OFFSET; off1++)
+	for (off2 = 0; off2 < MAX_OFFSET; off2++)
+	for (len = 0; len < MAX_LEN; len++) {
+		for (i = 0; i < BUF_SIZE; i++) {
+			a[i] = i;
+			b[i] = 0xff;
+		}
+
+		memcpy(b + off2, a + off1, len);
+		for (i = 0; i < BUF_SIZE; i++) {
+			int in = i >= off2 && i < off2 + len;
+			if (b[i] != (in ? a[i - off2 + off1] : 0xff))
+				fail("memcpy\n");
+		}
+
+		memcpy(c, b, BUF_SIZE);
+		memset(b + off1, off2, len);
+		for (i = 0; i < BUF_SIZE; i++) {
+			int in = i >= off1 && i < off1 + len;
+			if (b[i] != (in ? off2 : c[i]))
+				fail("memset\n");
+		}
+
+		for (i = 0; i < BUF_SIZE; i++)
+			a[i] = i;
+		memmove(a + off2, a + off1, len);
+		for (i = 0; i < len; i++)
+			if (a[off2 + i] != off1 + i)
+				fail("memmove\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	test_strings();
+	test_memory();
+	exit(0);
+}
@@ -19,6 +19,8 @@
 #include <arch/transition.h>
 #include <arm_tf.h>
 #include <assert.h>
+#include <boot_device.h>
+#include <bootstate.h>
 #include <cbfs.h>
 #include <cbmem.h>
 #include <compiler.h>
@@ -43,6 +45,34 @@ void __weak *soc_get_bl31_plat_params(bl31_params_t *params)
 	return NULL;
 }
 
+/*
+ * Start reading BL31 in the background before the payload is loaded. Its
+ * flash reads then overlap the decompression of the payload, and it is
+ * served from the CBFS cache when its turn comes.
+ */
+static void prefetch_bl31(void *unused)
+{
+	struct prog bl31 = PROG_INIT(PROG_BL31, CONFIG_CBFS_PREFIX"/bl31");
+	const struct region_device *rdev;
+	ssize_t offset;
+
+	if (!IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_PREFETCH))
+		return;
+
+	if (prog_locate(&bl31))
+		return;
+
+	rdev = prog_rdev(&bl31);
+	offset = rdev_relative_offset(boot_device_ro(), rdev);
+	if (offset < 0)
+		return;
+
+	if (boot_device_prefetch(offset, region_device_sz(rdev)) == 0)
+		printk(BIOS_DEBUG, "Prefetching BL31\n");
+}
+
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_LOAD, BS_ON_ENTRY, prefetch_bl31, NULL);
+
 void arm_tf_run_bl31(u64 payload_entry, u64 payload_arg0, u64 payload_spsr)
 {
 	struct prog bl31 = PROG_INIT(PROG_BL31, CONFIG_CBFS_PREFIX"/bl31");
@@ -53,6 +83,8 @@ void arm_tf_run_bl31(u64 payload_entry, u64 payload_arg0, u64 payload_spsr)
 
 	if (!selfload(&bl31, false))
 		die("BL31 load failed");
+	if (IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_PREFETCH))
+		boot_device_prefetch_end();
 	bl31_entry = prog_entry(&bl31);
 
 	SET_PARAM_HEAD(&bl31_params, PARAM_BL31, VERSION_1, 0);
@@ -32,6 +32,7 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 
 #include <arch/cache.h>
 #include <arch/lib_helpers.h>
@@ -69,6 +70,7 @@ enum dcache_op {
 	OP_DCCIVAC,
 	OP_DCCVAC,
 	OP_DCIVAC,
+	OP_DCCVAU,
 };
 
 /*
@@ -78,27 +80,33 @@ enum dcache_op {
  */
 static void dcache_op_va(void const *addr, size_t len, enum dcache_op op)
 {
-	uint64_t line, linesize;
+	uint64_t line, linesize, end;
 
 	linesize = dcache_line_bytes();
 	line = (uint64_t)addr & ~(linesize - 1);
+	end = (uint64_t)addr + len;
 
 	dsb();
-	while ((void *)line < addr + len) {
-		switch (op) {
-		case OP_DCCIVAC:
+	/* Pick the operation once rather than for every line. */
+	switch (op) {
+	case OP_DCCIVAC:
+		for (; line < end; line += linesize)
 			dccivac(line);
-			break;
-		case OP_DCCVAC:
+		break;
+	case OP_DCCVAC:
+		for (; line < end; line += linesize)
 			dccvac(line);
-			break;
-		case OP_DCIVAC:
+		break;
+	case OP_DCIVAC:
+		for (; line < end; line += linesize)
 			dcivac(line);
-			break;
-		default:
-			break;
-		}
-		line += linesize;
+		break;
+	case OP_DCCVAU:
+		for (; line < end; line += linesize)
+			dccvau(line);
+		break;
+	default:
+		break;
 	}
 	isb();
 }
@@ -128,16 +136,77 @@ void cache_sync_instructions(void)
 	icache_invalidate_all(); /* includdes leading DSB and trailing ISB. */
 }
 
+/*
+ * Loaded segments whose cache maintenance is still outstanding. Overlapping
+ * and adjacent segments are merged, so there are usually only a few.
+ */
+#define MAX_PENDING_SEGMENTS	8
+
+static struct {
+	uintptr_t start;
+	uintptr_t end;
+} pending[MAX_PENDING_SEGMENTS];
+static size_t num_pending;
+/* Cleared as soon as one pending segment needs to reach memory (PoC). */
+static int pending_cpu_local = 1;
+
+void cache_sync_segments(void)
+{
+	uint32_t sctlr;
+	size_t i;
+
+	if (!num_pending)
+		return;
+
+	sctlr = raw_read_sctlr_current();
+	for (i = 0; i < num_pending; i++) {
+		void *start = (void *)pending[i].start;
+		size_t size = pending[i].end - pending[i].start;
+
+		if ((sctlr & SCTLR_C) && pending_cpu_local)
+			dcache_op_va(start, size, OP_DCCVAU);
+		else if (sctlr & SCTLR_C)
+			dcache_clean_by_mva(start, size);
+		else if (sctlr & SCTLR_I)
+			dcache_clean_invalidate_by_mva(start, size);
+	}
+	icache_invalidate_all();
+
+	num_pending = 0;
+	pending_cpu_local = 1;
+}
+
 /*
  * For each segment of a program loaded this function is called
- * to invalidate caches for the addresses of the loaded segment
+ * to invalidate caches for the addresses of the loaded segment. The work
+ * is deferred until the final segment and done in one pass over the merged
+ * ranges. Data only needs to reach the point of unification if every
+ * segment is SEG_CPU_LOCAL.
  */
 void arch_segment_loaded(uintptr_t start, size_t size, int flags)
 {
-	uint32_t sctlr = raw_read_sctlr_current();
-	if (sctlr & SCTLR_C)
-		dcache_clean_by_mva((void *)start, size);
-	else if (sctlr & SCTLR_I)
-		dcache_clean_invalidate_by_mva((void *)start, size);
-	icache_invalidate_all();
+	uintptr_t end = start + size;
+	size_t i;
+
+	if (!(flags & SEG_CPU_LOCAL))
+		pending_cpu_local = 0;
+
+	for (i = 0; size && i < num_pending; i++) {
+		if (start > pending[i].end || end < pending[i].start)
+			continue;
+		pending[i].start = MIN(pending[i].start, start);
+		pending[i].end = MAX(pending[i].end, end);
+		break;
+	}
+
+	if (size && i == num_pending) {
+		if (num_pending == MAX_PENDING_SEGMENTS)
+			cache_sync_segments();
+		pending[num_pending].start = start;
+		pending[num_pending].end = end;
+		num_pending++;
+	}
+
+	if (flags & SEG_FINAL)
+		cache_sync_segments();
 }
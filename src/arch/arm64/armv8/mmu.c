@@ -43,6 +43,11 @@
  * value on stage transition, so we still need to check it for UNUSED_DESC. */
 static uint64_t *next_free_table = (void *)_ttb;
 
+/* Nesting depth of mmu_batch_begin(). TLB maintenance is deferred while > 0. */
+static int tlb_batch_depth;
+
+#define XLAT_TABLE_ENTRIES	(GRANULE_SIZE / sizeof(uint64_t))
+
 static void print_tag(int level, uint64_t tag)
 {
 	printk(level, tag & MA_MEM_NC ? "non-cacheable | " :
@@ -81,6 +86,56 @@ static uint64_t get_block_attr(unsigned long tag)
 	return attr;
 }
 
+/* Func : contiguous_run
+ * Desc : Returns the first entry of the run of CONTIGUOUS_ENTRIES entries that
+ * share a contiguous hint with the given entry. Tables are granule aligned.
+ */
+static uint64_t *contiguous_run(uint64_t *entry)
+{
+	return (uint64_t *)ALIGN_DOWN((uintptr_t)entry,
+				      CONTIGUOUS_ENTRIES * sizeof(*entry));
+}
+
+/* Func : clear_contiguous
+ * Desc : Drop the contiguous hint from the run containing an entry that is
+ * about to change. The hint must never cover entries that disagree.
+ */
+static void clear_contiguous(uint64_t *entry)
+{
+	uint64_t *run = contiguous_run(entry);
+	int i;
+
+	if (!(*entry & BLOCK_CONTIGUOUS))
+		return;
+
+	for (i = 0; i < CONTIGUOUS_ENTRIES; i++)
+		run[i] &= ~BLOCK_CONTIGUOUS;
+}
+
+/* Func : update_contiguous
+ * Desc : Set the contiguous hint on the run containing entry if all of its
+ * block/page descriptors map one naturally aligned range with the same
+ * attributes, so the TLB can cache the whole run in a single entry.
+ */
+static void update_contiguous(uint64_t *entry, size_t xlat_size)
+{
+	uint64_t *run = contiguous_run(entry);
+	uint64_t type = xlat_size == L3_XLAT_SIZE ? PAGE_DESC : BLOCK_DESC;
+	uint64_t first = run[0] & ~BLOCK_CONTIGUOUS;
+	int i;
+
+	if ((first & DESC_MASK) != type ||
+	    !IS_ALIGNED(first & XLAT_ADDR_MASK, CONTIGUOUS_ENTRIES * xlat_size))
+		return;
+
+	for (i = 1; i < CONTIGUOUS_ENTRIES; i++)
+		if ((run[i] & ~BLOCK_CONTIGUOUS) != first + i * xlat_size)
+			return;
+
+	for (i = 0; i < CONTIGUOUS_ENTRIES; i++)
+		run[i] |= BLOCK_CONTIGUOUS;
+}
+
 /* Func : setup_new_table
  * Desc : Get next free table from TTB and set it up to match old parent entry.
  */
@@ -103,12 +158,16 @@ static uint64_t *setup_new_table(uint64_t desc, size_t xlat_size)
 		/* Can reuse old parent entry, but may need to adjust type. */
 		if (xlat_size == L3_XLAT_SIZE)
 			desc |= PAGE_DESC;
+		desc &= ~BLOCK_CONTIGUOUS;
 
 		int i = 0;
 		for (; i < GRANULE_SIZE/sizeof(*next_free_table); i++) {
 			next_free_table[i] = desc;
 			desc += xlat_size;
 		}
+
+		for (i = 0; i < XLAT_TABLE_ENTRIES; i += CONTIGUOUS_ENTRIES)
+			update_contiguous(&next_free_table[i], xlat_size);
 	}
 
 	return next_free_table;
@@ -124,18 +183,45 @@ static uint64_t *get_next_level_table(uint64_t *ptr, size_t xlat_size)
 
 	if ((desc & DESC_MASK) != TABLE_DESC) {
 		uint64_t *new_table = setup_new_table(desc, xlat_size);
+		clear_contiguous(ptr);
 		desc = ((uint64_t)new_table) | TABLE_DESC;
 		*ptr = desc;
 	}
 	return (uint64_t *)(desc & XLAT_ADDR_MASK);
 }
 
+/* Func : fill_xlat_entries
+ * Desc : Map as much of the range starting at base_addr as fits into table
+ * from index onwards, using entries of xlat_size each, and refresh the
+ * contiguous hints of the runs touched. Returns the size mapped.
+ */
+static uint64_t fill_xlat_entries(uint64_t *table, uint64_t index,
+				  uint64_t base_addr, uint64_t size,
+				  size_t xlat_size, uint64_t attr)
+{
+	uint64_t mapped = 0;
+	uint64_t i = index;
+
+	do {
+		clear_contiguous(&table[i]);
+		table[i] = (base_addr + mapped) | attr;
+		mapped += xlat_size;
+		i++;
+	} while (i < XLAT_TABLE_ENTRIES && size - mapped >= xlat_size);
+
+	for (index = ALIGN_DOWN(index, CONTIGUOUS_ENTRIES); index < i;
+	     index += CONTIGUOUS_ENTRIES)
+		update_contiguous(&table[index], xlat_size);
+
+	return mapped;
+}
+
 /* Func : init_xlat_table
  * Desc : Given a base address and size, it identifies the indices within
  * different level XLAT tables which map the given base addr. Similar to table
  * walk, except that all invalid entries during the walk are updated
- * accordingly. On success, it returns the size of the block/page addressed by
- * the final table.
+ * accordingly. The final table is then filled for as long as the range
+ * continues in it. On success, it returns the size mapped.
  */
 static uint64_t init_xlat_table(uint64_t base_addr,
 				uint64_t size,
@@ -146,7 +232,6 @@ static uint64_t init_xlat_table(uint64_t base_addr,
 	uint64_t l2_index = (base_addr & L2_ADDR_MASK) >> L2_ADDR_SHIFT;
 	uint64_t l3_index = (base_addr & L3_ADDR_MASK) >> L3_ADDR_SHIFT;
 	uint64_t *table = (uint64_t *)_ttb;
-	uint64_t desc;
 	uint64_t attr = get_block_attr(tag);
 
 	/* L0 entry stores a table descriptor (doesn't support blocks) */
@@ -157,11 +242,11 @@ static uint64_t init_xlat_table(uint64_t base_addr,
 	    IS_ALIGNED(base_addr, (1UL << L1_ADDR_SHIFT))) {
 			/* If block address is aligned and size is greater than
 			 * or equal to size addressed by each L1 entry, we can
-			 * directly store a block desc */
-			desc = base_addr | BLOCK_DESC | attr;
-			table[l1_index] = desc;
+			 * directly store block descs */
 			/* L2 lookup is not required */
-			return L1_XLAT_SIZE;
+			return fill_xlat_entries(table, l1_index, base_addr,
+						 size, L1_XLAT_SIZE,
+						 BLOCK_DESC | attr);
 	}
 
 	/* L1 entry stores a table descriptor */
@@ -172,20 +257,18 @@ static uint64_t init_xlat_table(uint64_t base_addr,
 	    IS_ALIGNED(base_addr, (1UL << L2_ADDR_SHIFT))) {
 		/* If block address is aligned and size is greater than
 		 * or equal to size addressed by each L2 entry, we can
-		 * directly store a block desc */
-		desc = base_addr | BLOCK_DESC | attr;
-		table[l2_index] = desc;
+		 * directly store block descs */
 		/* L3 lookup is not required */
-		return L2_XLAT_SIZE;
+		return fill_xlat_entries(table, l2_index, base_addr, size,
+					 L2_XLAT_SIZE, BLOCK_DESC | attr);
 	}
 
 	/* L2 entry stores a table descriptor */
 	table = get_next_level_table(&table[l2_index], L3_XLAT_SIZE);
 
 	/* L3 table lookup */
-	desc = base_addr | PAGE_DESC | attr;
-	table[l3_index] = desc;
-	return L3_XLAT_SIZE;
+	return fill_xlat_entries(table, l3_index, base_addr, size,
+				 L3_XLAT_SIZE, PAGE_DESC | attr);
 }
 
 /* Func : sanity_check
@@ -219,6 +302,18 @@ static uint64_t get_pte(void *addr)
 	}
 }
 
+/* Func : tlb_sync
+ * Desc : Make page table updates visible to the MMU.
+ */
+static void tlb_sync(void)
+{
+	/* ARMv8 MMUs snoop L1 data cache, no need to flush it. */
+	dsb();
+	tlbiall_current();
+	dsb();
+	isb();
+}
+
 /* Func : mmu_config_range
  * Desc : This function repeatedly calls init_xlat_table with the base
  * address. Based on size returned from init_xlat_table, base_addr is updated
@@ -240,11 +335,29 @@ void mmu_config_range(void *start, size_t size, uint64_t tag)
 		temp_size -= init_xlat_table(base_addr + (size - temp_size),
 					     temp_size, tag);
 
-	/* ARMv8 MMUs snoop L1 data cache, no need to flush it. */
-	dsb();
-	tlbiall_current();
-	dsb();
-	isb();
+	if (!tlb_batch_depth)
+		tlb_sync();
+}
+
+/* Func : mmu_batch_begin
+ * Desc : Start a series of mmu_config_range() calls that only invalidate the
+ * TLB once, in the matching mmu_batch_end().
+ */
+void mmu_batch_begin(void)
+{
+	tlb_batch_depth++;
+}
+
+/* Func : mmu_batch_end
+ * Desc : Finish a series of mmu_config_range() calls and make all of their
+ * changes visible.
+ */
+void mmu_batch_end(void)
+{
+	assert(tlb_batch_depth > 0);
+
+	if (--tlb_batch_depth == 0)
+		tlb_sync();
 }
 
 /* Func : mmu_init
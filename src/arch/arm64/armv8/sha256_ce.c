@@ -0,0 +1,45 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright 2018 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * SHA-256 through the ARMv8 Cryptography Extensions. The block transform
+ * lives in sha256_ce.S; cores without the extension have
+ * ID_AA64ISAR0_EL1.SHA2 == 0.
+ */
+
+#include <arch/barrier.h>
+#include <arch/lib_helpers.h>
+#include <security/vboot/sha256_blocks.h>
+#include <types.h>
+
+#define ID_AA64ISAR0_SHA2_SHIFT	12
+#define ID_AA64ISAR0_SHA2_MASK	0xf
+
+int sha256_blocks_init(void)
+{
+	uint64_t isar0;
+
+	__asm__ __volatile__("mrs %0, ID_AA64ISAR0_EL1" : "=r" (isar0));
+	if (!((isar0 >> ID_AA64ISAR0_SHA2_SHIFT) & ID_AA64ISAR0_SHA2_MASK))
+		return 0;
+
+	/* The FP/SIMD trap is UNKNOWN out of reset. */
+	if (get_current_el() == EL3) {
+		raw_write_cptr_el3(raw_read_cptr_el3() & ~CPTR_EL3_TFP_ENABLE);
+		isb();
+	}
+
+	return 1;
+}
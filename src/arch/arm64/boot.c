@@ -62,6 +62,9 @@ void arch_prog_run(struct prog *prog)
 	void (*doit)(void *);
 	void *arg;
 
+	/* In case the loader never passed SEG_FINAL. */
+	cache_sync_segments();
+
 	if (ENV_RAMSTAGE && prog_type(prog) == PROG_PAYLOAD) {
 		run_payload(prog);
 		return;
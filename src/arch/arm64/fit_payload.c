@@ -56,15 +56,9 @@ static bool decompress_kernel_header(const struct fit_image_node *node)
 	scratch.canary = SCRATCH_CANARY_VALUE;
 	switch (node->compression) {
 	case CBFS_COMPRESS_NONE:
-		memcpy(scratch.raw, node->data, sizeof(scratch.raw));
-		break;
 	case CBFS_COMPRESS_LZMA:
-		ulzman(node->data, node->size,
-		       scratch.raw, sizeof(scratch.raw));
-		break;
 	case CBFS_COMPRESS_LZ4:
-		ulz4fn(node->data, node->size,
-		       scratch.raw, sizeof(scratch.raw));
+		fit_image_head(node, scratch.raw, sizeof(scratch.raw));
 		break;
 	default:
 		printk(BIOS_ERR, "ERROR: Unsupported compression algorithm!\n");
@@ -79,6 +79,9 @@ unsigned int dcache_line_bytes(void);
 /* perform all icache/dcache maintenance needed after loading new code */
 void cache_sync_instructions(void);
 
+/* finish the maintenance arch_segment_loaded() deferred, before running code */
+void cache_sync_segments(void);
+
 /* tlb invalidate all */
 void tlb_invalidate_all(void);
 
@@ -53,8 +53,12 @@
 
 #define BLOCK_ACCESS               (1 << 10)
 
+#define BLOCK_CONTIGUOUS           (1UL << 52)
 #define BLOCK_XN                   (1UL << 54)
 
+/* Number of adjacent entries covered by one contiguous hint (4KB granule) */
+#define CONTIGUOUS_ENTRIES         16
+
 #define BLOCK_SH_SHIFT                 (8)
 #define BLOCK_SH_NON_SHAREABLE         (0 << BLOCK_SH_SHIFT)
 #define BLOCK_SH_UNPREDICTABLE         (1 << BLOCK_SH_SHIFT)
@@ -161,6 +165,10 @@ void mmu_save_context(struct mmu_context *mmu_context);
 void mmu_restore_context(const struct mmu_context *mmu_context);
 /* Change a memory type for a range of bytes at runtime. */
 void mmu_config_range(void *start, size_t size, uint64_t tag);
+/* Defer the TLB invalidation of mmu_config_range() calls until the matching
+ * mmu_batch_end(). Use around a series of calls. Batches may nest. */
+void mmu_batch_begin(void);
+void mmu_batch_end(void);
 /* Enable the MMU (need previous mmu_init() and configured ranges!). */
 void mmu_enable(void);
 /* Disable the MMU (which also disables dcache but not icache). */
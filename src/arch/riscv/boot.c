@@ -17,6 +17,7 @@
 #include <vm.h>
 #include <arch/boot.h>
 #include <arch/encoding.h>
+#include <arch/smp/smp.h>
 #include <rules.h>
 #include <console/console.h>
 
@@ -28,25 +29,30 @@
  */
 const void *rom_fdt;
 
+void riscvpayload(const void *fdt, void *payload);
+
+static void run_payload(void *payload)
+{
+	/*
+	 * FIXME: This is wrong and will crash. Linux can't (in early
+	 * boot) access memory that's before its own loading address.
+	 * We need to copy the FDT to a place where Linux can access it.
+	 */
+	riscvpayload(rom_fdt, payload);
+}
+
+/* All harts move on to the next program, parked ones included. */
 void arch_prog_run(struct prog *prog)
 {
 	void (*doit)(void *) = prog_entry(prog);
-	void riscvpayload(const void *fdt, void *payload);
 
 	if (ENV_RAMSTAGE && prog_type(prog) == PROG_PAYLOAD) {
-		/*
-		 * FIXME: This is wrong and will crash. Linux can't (in early
-		 * boot) access memory that's before its own loading address.
-		 * We need to copy the FDT to a place where Linux can access it.
-		 */
-		const void *fdt = rom_fdt;
-
-		printk(BIOS_SPEW, "FDT is at %p\n", fdt);
+		printk(BIOS_SPEW, "FDT is at %p\n", rom_fdt);
 		printk(BIOS_SPEW, "OK, let's go\n");
-		riscvpayload(fdt, doit);
+		smp_resume(run_payload, doit);
 	}
 
-	doit(prog_entry_arg(prog));
+	smp_resume(doit, prog_entry_arg(prog));
 }
 
 int arch_supports_bounce_buffer(void)
@@ -0,0 +1,38 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef _RISCV_SMP_H
+#define _RISCV_SMP_H
+
+/*
+ * Every hart enters every stage. smp_pause() lets the working hart through
+ * and parks the others, which then wait for work from smp_run_on_harts()
+ * until smp_resume() sends all harts on to fn(arg), usually the entry of the
+ * next program. smp_resume() doesn't return.
+ */
+void smp_pause(int working_hartid);
+void smp_resume(void (*fn)(void *), void *arg) __attribute__((noreturn));
+
+/*
+ * Run func(arg) on all parked harts, and on the working hart as well if
+ * include_self is set, then wait for them. Like mp_run_on_aps() on x86, only
+ * the working hart may call this and func must not call it itself. The time
+ * each hart spent in func is logged. Returns the number of harts func ran
+ * on, or < 0 if any of them didn't finish within expire_us. expire_us <= 0
+ * waits forever. A hart that timed out takes work again once it finished,
+ * and smp_resume() gives it another second before leaving it behind.
+ */
+int smp_run_on_harts(void (*func)(void *), void *arg, int include_self,
+		     long expire_us);
+
+#endif /* _RISCV_SMP_H */
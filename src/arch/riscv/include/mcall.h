@@ -18,7 +18,7 @@
 
 // NOTE: this is the size of hls_t below. A static_assert would be
 // nice to have.
-#define HLS_SIZE 64
+#define HLS_SIZE 128
 
 /* We save 37 registers, currently. */
 #define MENTRY_FRAME_SIZE (HLS_SIZE + 37 * 8)
@@ -26,6 +26,7 @@
 #ifndef __ASSEMBLER__
 
 #include <arch/encoding.h>
+#include <arch/smp/atomic.h>
 #include <stdint.h>
 
 typedef struct {
@@ -36,6 +37,15 @@ typedef struct {
 } sbi_device_message;
 
 
+/* Work handed to a parked hart, see arch/smp/smp.h. */
+struct hart_work {
+	atomic_t state;
+	void (*volatile func)(void *arg);
+	void *volatile arg;
+	volatile uint64_t start;
+	volatile uint64_t end;
+};
+
 typedef struct {
 	sbi_device_message *device_request_queue_head;
 	unsigned long device_request_queue_size;
@@ -46,8 +56,11 @@ typedef struct {
 	int ipi_pending;
 	uint64_t *timecmp;
 	uint64_t *time;
+	struct hart_work work;
 } hls_t;
 
+_Static_assert(sizeof(hls_t) <= HLS_SIZE, "hls_t doesn't fit HLS_SIZE");
+
 #define MACHINE_STACK_TOP() ({ \
 	/* coverity[uninit_use] : FALSE */ \
 	register uintptr_t sp asm ("sp"); \
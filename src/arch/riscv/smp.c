@@ -0,0 +1,190 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/barrier.h>
+#include <arch/encoding.h>
+#include <arch/smp/atomic.h>
+#include <arch/smp/smp.h>
+#include <arch/hlt.h>
+#include <console/console.h>
+#include <mcall.h>
+
+/* The state of struct hart_work. HLS is cleared by hls_init(). */
+enum {
+	HART_ABSENT,	/* Not parked (yet). */
+	HART_PARKED,	/* Waiting for work. */
+	HART_QUEUED,	/* Work handed over. */
+	HART_RUNNING,
+	HART_DONE,
+	HART_RESUMED,	/* Sent on to the next program. */
+};
+
+static int working_hart = -1;
+
+static hls_t *hart_hls(int hartid)
+{
+	return OTHER_HLS(hartid);
+}
+
+static unsigned long long ticks_to_usecs(uint64_t ticks)
+{
+	return ticks * 1000 / CONFIG_RISCV_TIMEBASE_KHZ;
+}
+
+/*
+ * Not every core implements the time CSR (the FU540's don't, rdtime traps),
+ * so read mtime from the CLINT like the trap handler does.
+ */
+static uint64_t hart_time(void)
+{
+	return *(volatile uint64_t *)(CLINT_BASE + 0xbff8);
+}
+
+/*
+ * A hart that timed out in smp_run_on_harts() finishes its work later on
+ * and is then as good as parked.
+ */
+static int hart_idle(struct hart_work *work)
+{
+	int state = atomic_read(&work->state);
+
+	return state == HART_PARKED || state == HART_DONE;
+}
+
+void smp_pause(int working_hartid)
+{
+	struct hart_work *work = &HLS()->work;
+	void (*func)(void *);
+	void *arg;
+
+	if (read_csr(mhartid) == working_hartid) {
+		working_hart = working_hartid;
+		return;
+	}
+
+	atomic_set(&work->state, HART_PARKED);
+	mb();
+
+	for (;;) {
+		while (atomic_read(&work->state) != HART_QUEUED &&
+		       atomic_read(&work->state) != HART_RESUMED)
+			;
+		rmb();
+		func = work->func;
+		arg = work->arg;
+
+		if (atomic_read(&work->state) == HART_RESUMED)
+			break;
+
+		atomic_set(&work->state, HART_RUNNING);
+		work->start = hart_time();
+		func(arg);
+		work->end = hart_time();
+		wmb();
+		atomic_set(&work->state, HART_DONE);
+	}
+
+	func(arg);
+	hlt();
+}
+
+void smp_resume(void (*fn)(void *), void *arg)
+{
+	struct hart_work *work;
+	uint64_t timeout;
+	int i;
+
+	for (i = 0; i < CONFIG_RISCV_HART_NUM; i++) {
+		if (i == working_hart)
+			continue;
+		work = &hart_hls(i)->work;
+		if (atomic_read(&work->state) == HART_ABSENT)
+			continue;
+
+		/* Give late work another second before leaving it behind. */
+		timeout = hart_time() + 1000ULL * CONFIG_RISCV_TIMEBASE_KHZ;
+		while (!hart_idle(work) && hart_time() < timeout)
+			;
+		if (!hart_idle(work)) {
+			printk(BIOS_ERR, "hart %d: still busy, not resumed\n",
+			       i);
+			continue;
+		}
+		work->func = fn;
+		work->arg = arg;
+		wmb();
+		atomic_set(&work->state, HART_RESUMED);
+	}
+
+	fn(arg);
+	die("Resumed program returned!\n");
+}
+
+int smp_run_on_harts(void (*func)(void *), void *arg, int include_self,
+		     long expire_us)
+{
+	struct hart_work *work;
+	uint64_t start, timeout;
+	uint32_t queued = 0;
+	int i, num = 0, ret = 0;
+
+	for (i = 0; i < CONFIG_RISCV_HART_NUM; i++) {
+		if (i == working_hart)
+			continue;
+		work = &hart_hls(i)->work;
+		if (!hart_idle(work))
+			continue;
+		work->func = func;
+		work->arg = arg;
+		wmb();
+		atomic_set(&work->state, HART_QUEUED);
+		queued |= 1 << i;
+		num++;
+	}
+
+	if (include_self) {
+		start = hart_time();
+		func(arg);
+		printk(BIOS_DEBUG, "hart %d: %p took %llu us\n", working_hart,
+		       func, ticks_to_usecs(hart_time() - start));
+		num++;
+	}
+
+	timeout = hart_time() + (uint64_t)expire_us * CONFIG_RISCV_TIMEBASE_KHZ /
+		  1000;
+
+	for (i = 0; i < CONFIG_RISCV_HART_NUM; i++) {
+		if (!(queued & (1 << i)))
+			continue;
+		work = &hart_hls(i)->work;
+
+		while (atomic_read(&work->state) != HART_DONE) {
+			if (expire_us > 0 && hart_time() > timeout)
+				break;
+		}
+
+		/* Left as it is, hart_idle() picks it up once it is done. */
+		if (atomic_read(&work->state) != HART_DONE) {
+			printk(BIOS_ERR, "hart %d: %p timed out\n", i, func);
+			ret = -1;
+			continue;
+		}
+
+		rmb();
+		printk(BIOS_DEBUG, "hart %d: %p took %llu us\n", i, func,
+		       ticks_to_usecs(work->end - work->start));
+		atomic_set(&work->state, HART_PARKED);
+	}
+
+	return ret < 0 ? ret : num;
+}
@@ -26,6 +26,7 @@
 
 #include <arch/boot.h>
 #include <arch/encoding.h>
+#include <arch/smp/smp.h>
 #include <arch/stages.h>
 #include <rules.h>
 
@@ -39,5 +40,6 @@ void stage_entry(void)
 	if (ENV_RAMSTAGE)
 		rom_fdt = (const void *)read_csr(mscratch);
 
+	smp_pause(CONFIG_RISCV_WORKING_HARTID);
 	main();
 }
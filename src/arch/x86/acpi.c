@@ -59,6 +59,29 @@ u8 acpi_checksum(u8 *table, u32 length)
 	return -ret;
 }
 
+static u8 acpi_byte_sum(const void *data, size_t size)
+{
+	const u8 *p = data;
+	u8 sum = 0;
+
+	while (size--)
+		sum += *p++;
+	return sum;
+}
+
+/*
+ * Keep a valid checksum valid when size bytes of the table change from old
+ * to new, without summing up the rest of the table again. old may be NULL
+ * for bytes that are appended to the table.
+ */
+void acpi_checksum_update(u8 *checksum, const void *old, const void *new,
+			  size_t size)
+{
+	if (old)
+		*checksum += acpi_byte_sum(old, size);
+	*checksum -= acpi_byte_sum(new, size);
+}
+
 /**
  * Add an ACPI table to the RSDT (and XSDT) structure, recalculate length
  * and checksum.
@@ -66,6 +89,7 @@ u8 acpi_checksum(u8 *table, u32 length)
 void acpi_add_table(acpi_rsdp_t *rsdp, void *table)
 {
 	int i, entries_num;
+	u32 length;
 	acpi_rsdt_t *rsdt;
 	acpi_xsdt_t *xsdt = NULL;
 
@@ -92,13 +116,14 @@ void acpi_add_table(acpi_rsdp_t *rsdp, void *table)
 
 	/* Add table to the RSDT. */
 	rsdt->entry[i] = (uintptr_t)table;
+	acpi_checksum_update(&rsdt->header.checksum, NULL, &rsdt->entry[i],
+			     sizeof(rsdt->entry[i]));
 
 	/* Fix RSDT length or the kernel will assume invalid entries. */
-	rsdt->header.length = sizeof(acpi_header_t) + (sizeof(u32) * (i + 1));
-
-	/* Re-calculate checksum. */
-	rsdt->header.checksum = 0; /* Hope this won't get optimized away */
-	rsdt->header.checksum = acpi_checksum((u8 *)rsdt, rsdt->header.length);
+	length = sizeof(acpi_header_t) + (sizeof(u32) * (i + 1));
+	acpi_checksum_update(&rsdt->header.checksum, &rsdt->header.length,
+			     &length, sizeof(length));
+	rsdt->header.length = length;
 
 	/*
 	 * And now the same thing for the XSDT. We use the same index as for
@@ -107,15 +132,15 @@ void acpi_add_table(acpi_rsdp_t *rsdp, void *table)
 	if (xsdt) {
 		/* Add table to the XSDT. */
 		xsdt->entry[i] = (u64)(uintptr_t)table;
+		acpi_checksum_update(&xsdt->header.checksum, NULL,
+				     &xsdt->entry[i], sizeof(xsdt->entry[i]));
 
 		/* Fix XSDT length. */
-		xsdt->header.length = sizeof(acpi_header_t) +
-					(sizeof(u64) * (i + 1));
-
-		/* Re-calculate checksum. */
-		xsdt->header.checksum = 0;
-		xsdt->header.checksum = acpi_checksum((u8 *)xsdt,
-							xsdt->header.length);
+		length = sizeof(acpi_header_t) + (sizeof(u64) * (i + 1));
+		acpi_checksum_update(&xsdt->header.checksum,
+				     &xsdt->header.length, &length,
+				     sizeof(length));
+		xsdt->header.length = length;
 	}
 
 	printk(BIOS_DEBUG, "ACPI: added table %d/%d, length now %d\n",
@@ -1088,22 +1113,32 @@ unsigned long write_acpi_tables(unsigned long start)
 	dsdt = (acpi_header_t *) current;
 	memcpy(dsdt, dsdt_file, sizeof(acpi_header_t));
 	if (dsdt->length >= sizeof(acpi_header_t)) {
+		unsigned long injected;
+		u32 length;
+
 		current += sizeof(acpi_header_t);
 
 		acpigen_set_current((char *) current);
 		for (dev = all_devices; dev; dev = dev->next)
 			if (dev->ops && dev->ops->acpi_inject_dsdt_generator)
 				dev->ops->acpi_inject_dsdt_generator(dev);
+		injected = current;
 		current = (unsigned long) acpigen_get_current();
 		memcpy((char *)current,
 		       (char *)dsdt_file + sizeof(acpi_header_t),
 		       dsdt->length - sizeof(acpi_header_t));
-		current += dsdt->length - sizeof(acpi_header_t);
 
-		/* (Re)calculate length and checksum. */
-		dsdt->length = current - (unsigned long)dsdt;
-		dsdt->checksum = 0;
-		dsdt->checksum = acpi_checksum((void *)dsdt, dsdt->length);
+		/*
+		 * The DSDT from iasl comes with a valid checksum, so only
+		 * the injected AML and the new length need to be added.
+		 */
+		acpi_checksum_update(&dsdt->checksum, NULL, (void *)injected,
+				     current - injected);
+		current += dsdt->length - sizeof(acpi_header_t);
+		length = current - (unsigned long)dsdt;
+		acpi_checksum_update(&dsdt->checksum, &dsdt->length, &length,
+				     sizeof(length));
+		dsdt->length = length;
 	}
 
 	current = acpi_align_current(current);
@@ -1127,7 +1162,12 @@ unsigned long write_acpi_tables(unsigned long start)
 
 	printk(BIOS_DEBUG, "ACPI:     * SSDT\n");
 	ssdt = (acpi_header_t *)current;
-	acpi_create_ssdt_generator(ssdt, ACPI_TABLE_CREATOR);
+	if (!IS_ENABLED(CONFIG_ACPI_SSDT_CACHE) ||
+	    acpi_ssdt_cache_restore(ssdt) < 0) {
+		acpi_create_ssdt_generator(ssdt, ACPI_TABLE_CREATOR);
+		if (IS_ENABLED(CONFIG_ACPI_SSDT_CACHE))
+			acpi_ssdt_cache_save(ssdt);
+	}
 	if (ssdt->length > sizeof(acpi_header_t)) {
 		current += ssdt->length;
 		acpi_add_table(rsdp, ssdt);
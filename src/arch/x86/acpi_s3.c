@@ -118,7 +118,12 @@ static int backup_create_or_update(struct resume_backup *backup_mem,
 
 void *acpi_backup_container(uintptr_t base, size_t size)
 {
-	struct resume_backup *backup_mem = cbmem_find(CBMEM_ID_RESUME);
+	struct resume_backup *backup_mem;
+
+	if (!acpi_s3_lowmem_backup())
+		return NULL;
+
+	backup_mem = cbmem_find(CBMEM_ID_RESUME);
 	if (!backup_mem)
 		return NULL;
 
@@ -135,7 +140,12 @@ void *acpi_backup_container(uintptr_t base, size_t size)
 
 void backup_ramstage_section(uintptr_t base, size_t size)
 {
-	struct resume_backup *backup_mem = cbmem_find(CBMEM_ID_RESUME);
+	struct resume_backup *backup_mem;
+
+	if (!acpi_s3_lowmem_backup())
+		return;
+
+	backup_mem = cbmem_find(CBMEM_ID_RESUME);
 
 	/* For first boot we exit here as CBMEM_ID_RESUME is only
 	 * created late in ramstage with acpi_prepare_resume_backup().
@@ -171,7 +181,7 @@ void acpi_prepare_resume_backup(void)
 	if (!acpi_s3_resume_allowed())
 		return;
 
-	if (IS_ENABLED(CONFIG_RELOCATABLE_RAMSTAGE))
+	if (!acpi_s3_lowmem_backup())
 		return;
 
 	backup_create_or_update(NULL, (uintptr_t)_program, _program_size);
@@ -195,7 +205,7 @@ static void acpi_jump_to_wakeup(void *vector)
 		return;
 	}
 
-	if (!IS_ENABLED(CONFIG_RELOCATABLE_RAMSTAGE)) {
+	if (acpi_s3_lowmem_backup()) {
 		struct resume_backup *backup_mem = cbmem_find(CBMEM_ID_RESUME);
 		if (backup_mem && backup_mem->valid) {
 			backup_mem->valid = 0;
@@ -240,5 +250,6 @@ void acpi_resume(void *wake_vec)
 	mainboard_suspend_resume();
 
 	post_code(POST_OS_RESUME);
+	console_tx_sync();
 	acpi_jump_to_wakeup(wake_vec);
 }
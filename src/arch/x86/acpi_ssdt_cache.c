@@ -0,0 +1,200 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/acpi.h>
+#include <arch/cpu.h>
+#include <cbmem.h>
+#include <compiler.h>
+#include <console/console.h>
+#include <device/device.h>
+#include <fmap.h>
+#include <region_file.h>
+#include <string.h>
+#include <version.h>
+
+/*
+ * The SSDT of the previous boot is kept in flash together with a
+ * fingerprint of what went into it: the coreboot build, the CPU, every
+ * device with its IDs and resources, and the location of the coreboot
+ * tables. If the fingerprint matches, the SSDT is copied back instead of
+ * running all acpi_fill_ssdt_generator() callbacks again.
+ *
+ * The CPU signature alone doesn't tell SKUs apart, so the brand string and
+ * the power management leaf go in as well. P-state and turbo MSRs, CMOS
+ * options and straps are board or CPU specific and are added through
+ * acpi_ssdt_cache_fingerprint_extra().
+ */
+#define SSDT_CACHE_REGION	"RW_ACPI_CACHE"
+#define SSDT_CACHE_SIGNATURE	0x54445353	/* 'SSDT' */
+
+/* Stored right behind the SSDT. */
+struct ssdt_cache_trailer {
+	uint32_t signature;
+	uint32_t length;
+	uint64_t fingerprint;
+};
+
+#define FNV64_OFFSET	0xcbf29ce484222325ULL
+#define FNV64_PRIME	0x100000001b3ULL
+
+static uint64_t fnv64(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *p = data;
+
+	while (size--) {
+		hash ^= *p++;
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t fnv64_u64(uint64_t hash, uint64_t value)
+{
+	return fnv64(hash, &value, sizeof(value));
+}
+
+uint64_t acpi_ssdt_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+	return fnv64(hash, data, size);
+}
+
+uint64_t __weak acpi_ssdt_cache_fingerprint_extra(uint64_t hash)
+{
+	return hash;
+}
+
+static uint64_t fnv64_cpuid(uint64_t hash, unsigned int op)
+{
+	struct cpuid_result res = cpuid(op);
+
+	return fnv64(hash, &res, sizeof(res));
+}
+
+static uint64_t ssdt_cache_fingerprint(const acpi_header_t *ssdt)
+{
+	const struct cbmem_entry *cbtable;
+	struct device *dev;
+	struct resource *res;
+	const char *path;
+	uint64_t hash = FNV64_OFFSET;
+
+	hash = fnv64(hash, coreboot_version, strlen(coreboot_version));
+	hash = fnv64(hash, coreboot_compile_time,
+		     strlen(coreboot_compile_time));
+	hash = fnv64_u64(hash, cpuid_eax(1));
+	if (cpuid_eax(0) >= 6)
+		hash = fnv64_cpuid(hash, 6);
+	if (cpuid_eax(0x80000000) >= 0x80000004) {
+		hash = fnv64_cpuid(hash, 0x80000002);
+		hash = fnv64_cpuid(hash, 0x80000003);
+		hash = fnv64_cpuid(hash, 0x80000004);
+	}
+	hash = fnv64_u64(hash, (uintptr_t)ssdt);
+
+	cbtable = cbmem_entry_find(CBMEM_ID_CBTABLE);
+	if (cbtable) {
+		hash = fnv64_u64(hash, (uintptr_t)cbmem_entry_start(cbtable));
+		hash = fnv64_u64(hash, cbmem_entry_size(cbtable));
+	}
+
+	for (dev = all_devices; dev; dev = dev->next) {
+		path = dev_path(dev);
+		hash = fnv64(hash, path, strlen(path));
+		hash = fnv64_u64(hash, dev->enabled);
+		hash = fnv64_u64(hash, ((uint64_t)dev->vendor << 48) |
+				 ((uint64_t)dev->device << 32) | dev->class);
+		hash = fnv64_u64(hash, (dev->subsystem_vendor << 16) |
+				 dev->subsystem_device);
+		for (res = dev->resource_list; res; res = res->next) {
+			hash = fnv64_u64(hash, res->base);
+			hash = fnv64_u64(hash, res->size);
+			hash = fnv64_u64(hash, ((uint64_t)res->index << 32) |
+					 res->flags);
+		}
+	}
+
+	return acpi_ssdt_cache_fingerprint_extra(hash);
+}
+
+static int ssdt_cache_open(struct region_file *file, int rw)
+{
+	struct region_device rdev;
+	int ret;
+
+	if (rw)
+		ret = fmap_locate_area_as_rdev_rw(SSDT_CACHE_REGION, &rdev);
+	else
+		ret = fmap_locate_area_as_rdev(SSDT_CACHE_REGION, &rdev);
+	if (ret < 0)
+		return -1;
+
+	return region_file_init(file, &rdev);
+}
+
+int acpi_ssdt_cache_restore(acpi_header_t *ssdt)
+{
+	struct ssdt_cache_trailer trailer;
+	struct region_file file;
+	struct region_device rdev;
+	size_t size;
+
+	if (ssdt_cache_open(&file, 0) < 0 ||
+	    region_file_data(&file, &rdev) < 0)
+		return -1;
+
+	size = region_device_sz(&rdev);
+	if (size <= sizeof(trailer) ||
+	    rdev_readat(&rdev, &trailer, size - sizeof(trailer),
+			sizeof(trailer)) != sizeof(trailer))
+		return -1;
+
+	if (trailer.signature != SSDT_CACHE_SIGNATURE ||
+	    trailer.length != size - sizeof(trailer) ||
+	    trailer.fingerprint != ssdt_cache_fingerprint(ssdt))
+		return -1;
+
+	if (rdev_readat(&rdev, ssdt, 0, trailer.length) != trailer.length)
+		return -1;
+
+	/* A damaged copy is regenerated, not handed to the OS. */
+	if (ssdt->length != trailer.length ||
+	    acpi_checksum((void *)ssdt, ssdt->length) != 0) {
+		memset(ssdt, 0, sizeof(*ssdt));
+		return -1;
+	}
+
+	printk(BIOS_DEBUG, "ACPI: Reusing SSDT of the previous boot\n");
+	return 0;
+}
+
+void acpi_ssdt_cache_save(acpi_header_t *ssdt)
+{
+	struct ssdt_cache_trailer *trailer;
+	struct region_file file;
+
+	/*
+	 * The space behind the SSDT is free until the next table is written,
+	 * so the trailer is put there to write the record in one go.
+	 */
+	trailer = (void *)((uintptr_t)ssdt + ssdt->length);
+	trailer->signature = SSDT_CACHE_SIGNATURE;
+	trailer->length = ssdt->length;
+	trailer->fingerprint = ssdt_cache_fingerprint(ssdt);
+
+	if (ssdt_cache_open(&file, 1) < 0 ||
+	    region_file_update_data(&file, ssdt,
+				    ssdt->length + sizeof(*trailer)) < 0)
+		printk(BIOS_ERR, "ACPI: Failed to update the SSDT cache\n");
+
+	memset(trailer, 0, sizeof(*trailer));
+}
@@ -81,18 +81,19 @@ void acpigen_emit_ext_op(uint8_t op)
 	acpigen_emit_byte(op);
 }
 
+/* AML is little endian, like x86, so integers are stored as they are. */
 void acpigen_emit_word(unsigned int data)
 {
-	acpigen_emit_byte(data & 0xff);
-	acpigen_emit_byte((data >> 8) & 0xff);
+	uint16_t word = data;
+
+	acpigen_emit_stream((const char *)&word, sizeof(word));
 }
 
 void acpigen_emit_dword(unsigned int data)
 {
-	acpigen_emit_byte(data & 0xff);
-	acpigen_emit_byte((data >> 8) & 0xff);
-	acpigen_emit_byte((data >> 16) & 0xff);
-	acpigen_emit_byte((data >> 24) & 0xff);
+	uint32_t dword = data;
+
+	acpigen_emit_stream((const char *)&dword, sizeof(dword));
 }
 
 char *acpigen_write_package(int nr_el)
@@ -205,9 +206,30 @@ void acpigen_write_name_string(const char *name, const char *string)
 
 void acpigen_emit_stream(const char *data, int size)
 {
-	int i;
-	for (i = 0; i < size; i++)
-		acpigen_emit_byte(data[i]);
+	if (size <= 0)
+		return;
+	memcpy(gencurrent, data, size);
+	gencurrent += size;
+}
+
+void acpigen_template_begin(struct acpigen_template *tpl)
+{
+	tpl->start = gencurrent;
+	tpl->size = 0;
+}
+
+void acpigen_template_end(struct acpigen_template *tpl)
+{
+	tpl->size = gencurrent - tpl->start;
+}
+
+char *acpigen_template_emit(const struct acpigen_template *tpl)
+{
+	char *copy = gencurrent;
+
+	/* The template lies behind gencurrent, the copy cannot overlap it. */
+	acpigen_emit_stream(tpl->start, tpl->size);
+	return copy;
 }
 
 void acpigen_emit_string(const char *string)
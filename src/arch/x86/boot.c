@@ -14,6 +14,8 @@
 #include <commonlib/helpers.h>
 #include <console/console.h>
 #include <arch/stages.h>
+#include <bzimage_payload.h>
+#include <cbfs.h>
 #include <program_loading.h>
 #include <ip_checksum.h>
 #include <string.h>
@@ -220,7 +222,10 @@ int payload_arch_usable_ram_quirk(uint64_t start, uint64_t size)
 static void try_payload(struct prog *prog)
 {
 	if (prog_type(prog) == PROG_PAYLOAD) {
-		if (IS_ENABLED(CONFIG_RELOCATABLE_RAMSTAGE))
+		if (IS_ENABLED(CONFIG_PAYLOAD_BZIMAGE_SUPPORT) &&
+		    prog_cbfs_type(prog) == CBFS_TYPE_BZIMAGE)
+			bzimage_run(prog);
+		else if (IS_ENABLED(CONFIG_RELOCATABLE_RAMSTAGE))
 			jmp_payload_no_bounce_buffer(prog_entry(prog));
 		else
 			jmp_payload(prog_entry(prog),
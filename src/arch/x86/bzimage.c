@@ -0,0 +1,330 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootmem.h>
+#include <bzimage_payload.h>
+#include <cbfs.h>
+#include <commonlib/helpers.h>
+#include <console/console.h>
+#include <program_loading.h>
+#include <string.h>
+#include <timestamp.h>
+
+/* See Documentation/x86/boot.txt in the Linux tree. */
+#define SETUP_HDR_OFFSET	0x1f1
+#define SETUP_BOOT_FLAG		0xaa55
+#define SETUP_HDRS		0x53726448	/* "HdrS" */
+/* pref_address and init_size are there from 2.10 on. */
+#define SETUP_MIN_VERSION	0x020a
+#define SETUP_LOADED_HIGH	(1 << 0)
+#define SETUP_LOADER_UNKNOWN	0xff
+
+#define E820_MAX_ENTRIES	128
+#define E820_RAM		1
+#define E820_RESERVED		2
+#define E820_ACPI		3
+#define E820_NVS		4
+#define E820_UNUSABLE		5
+
+/* Linux can't go below this with memory it decompresses into. */
+#define KERNEL_MIN_ALIGN	(2 * MiB)
+
+struct setup_header {
+	uint8_t setup_sects;		/* 0x1f1 */
+	uint16_t root_flags;
+	uint32_t syssize;
+	uint16_t ram_size;
+	uint16_t vid_mode;
+	uint16_t root_dev;
+	uint16_t boot_flag;		/* 0x1fe */
+	uint16_t jump;
+	uint32_t header;		/* 0x202 */
+	uint16_t version;
+	uint32_t realmode_swtch;
+	uint16_t start_sys_seg;
+	uint16_t kernel_version;
+	uint8_t type_of_loader;		/* 0x210 */
+	uint8_t loadflags;
+	uint16_t setup_move_size;
+	uint32_t code32_start;		/* 0x214 */
+	uint32_t ramdisk_image;
+	uint32_t ramdisk_size;
+	uint32_t bootsect_kludge;
+	uint16_t heap_end_ptr;		/* 0x224 */
+	uint8_t ext_loader_ver;
+	uint8_t ext_loader_type;
+	uint32_t cmd_line_ptr;		/* 0x228 */
+	uint32_t initrd_addr_max;
+	uint32_t kernel_alignment;
+	uint8_t relocatable_kernel;	/* 0x234 */
+	uint8_t min_alignment;
+	uint16_t xloadflags;
+	uint32_t cmdline_size;		/* 0x238 */
+	uint32_t hardware_subarch;
+	uint64_t hardware_subarch_data;
+	uint32_t payload_offset;	/* 0x248 */
+	uint32_t payload_length;
+	uint64_t setup_data;		/* 0x250 */
+	uint64_t pref_address;		/* 0x258 */
+	uint32_t init_size;		/* 0x260 */
+	uint32_t handover_offset;
+} __packed;
+
+struct e820_entry {
+	uint64_t addr;
+	uint64_t size;
+	uint32_t type;
+} __packed;
+
+/* The "zero page" the kernel gets passed in %esi. */
+struct boot_params {
+	uint8_t screen_info[0x40];
+	uint8_t pad0[0x1e8 - 0x40];
+	uint8_t e820_entries;		/* 0x1e8 */
+	uint8_t pad1[SETUP_HDR_OFFSET - 0x1e9];
+	struct setup_header hdr;	/* 0x1f1 */
+	uint8_t pad2[0x2d0 - SETUP_HDR_OFFSET - sizeof(struct setup_header)];
+	struct e820_entry e820_table[E820_MAX_ENTRIES];	/* 0x2d0 */
+	uint8_t pad3[0x1000 - 0x2d0 -
+		     E820_MAX_ENTRIES * sizeof(struct e820_entry)];
+} __packed;
+
+_Static_assert(sizeof(struct boot_params) == 4 * KiB,
+	       "boot_params has to be a page");
+
+struct ram_search {
+	uint64_t limit;
+	uint64_t size;
+	uint64_t align;
+	uint64_t found;
+};
+
+static bool find_ram(const struct range_entry *r, void *arg)
+{
+	struct ram_search *search = arg;
+	uint64_t end = MIN(range_entry_end(r), search->limit);
+	uint64_t begin;
+
+	if (range_entry_tag(r) != BM_MEM_RAM || end < search->size)
+		return true;
+
+	begin = ALIGN_DOWN(end - search->size, search->align);
+	if (begin >= range_entry_base(r))
+		search->found = begin;
+
+	return true;
+}
+
+/* Takes the highest size bytes of free RAM below limit. Returns 0 if there
+ * is no room. */
+static uintptr_t reserve_ram(uint64_t size, uint64_t align, uint64_t limit)
+{
+	struct ram_search search = {
+		.limit = MIN(limit, 4ULL * GiB),
+		.size = ALIGN_UP(size, 4 * KiB),
+		.align = MAX(align, 4 * KiB),
+	};
+
+	bootmem_walk(find_ram, &search);
+	if (search.found)
+		bootmem_add_range(search.found, search.size, BM_MEM_PAYLOAD);
+
+	return search.found;
+}
+
+static uint32_t e820_type(enum bootmem_type tag)
+{
+	switch (tag) {
+	case BM_MEM_RAM:
+		return E820_RAM;
+	case BM_MEM_ACPI:
+		return E820_ACPI;
+	case BM_MEM_NVS:
+		return E820_NVS;
+	case BM_MEM_UNUSABLE:
+		return E820_UNUSABLE;
+	default:
+		return E820_RESERVED;
+	}
+}
+
+static bool fill_e820(const struct range_entry *r, void *arg)
+{
+	struct boot_params *params = arg;
+	struct e820_entry *e;
+
+	if (params->e820_entries == E820_MAX_ENTRIES) {
+		printk(BIOS_WARNING, "bzImage: memory map is cut short\n");
+		return false;
+	}
+
+	e = &params->e820_table[params->e820_entries++];
+	e->addr = range_entry_base(r);
+	e->size = range_entry_size(r);
+	e->type = e820_type(range_entry_tag(r));
+
+	return true;
+}
+
+static int load_initrd(struct boot_params *params)
+{
+	const struct setup_header *hdr = &params->hdr;
+	struct cbfsf fh;
+	uint32_t compression;
+	size_t size, room;
+	uintptr_t addr;
+
+	if (cbfs_boot_locate(&fh, CONFIG_CBFS_PREFIX "/initrd", NULL))
+		return 0;
+
+	if (cbfsf_decompression_info(&fh, &compression, &size) < 0 || !size)
+		return -1;
+
+	/* LZ4 is decompressed in place and needs a little room behind. */
+	room = size;
+	if (compression == CBFS_COMPRESS_LZ4)
+		room += 8 + size / 255;
+
+	addr = reserve_ram(room, 4 * KiB, (uint64_t)hdr->initrd_addr_max + 1);
+	if (!addr) {
+		printk(BIOS_ERR, "bzImage: no room for the %zu byte initrd\n",
+		       size);
+		return -1;
+	}
+
+	printk(BIOS_INFO, "bzImage: loading initrd to 0x%lx, %zu bytes\n",
+	       (unsigned long)addr, size);
+	if (cbfs_load_and_decompress(&fh.data, 0, region_device_sz(&fh.data),
+				     (void *)addr, room, compression) != size)
+		return -1;
+	prog_segment_loaded(addr, size, 0);
+
+	params->hdr.ramdisk_image = addr;
+	params->hdr.ramdisk_size = size;
+
+	return 0;
+}
+
+static void load_cmdline(struct boot_params *params, char *cmdline,
+			 size_t cmdline_size)
+{
+	const char *file;
+	size_t size;
+
+	file = cbfs_boot_map_with_leak(CONFIG_CBFS_PREFIX "/cmdline",
+				       CBFS_TYPE_RAW, &size);
+	if (file == NULL)
+		return;
+
+	size = MIN(size, cmdline_size - 1);
+	memcpy(cmdline, file, size);
+	cmdline[size] = '\0';
+
+	printk(BIOS_DEBUG, "bzImage: command line \"%s\"\n", cmdline);
+	params->hdr.cmd_line_ptr = (uintptr_t)cmdline;
+}
+
+void bzimage_payload(struct prog *payload)
+{
+	const struct region_device *rdev = prog_rdev(payload);
+	struct boot_params *params;
+	struct setup_header hdr;
+	size_t hdr_size, kernel_offset, kernel_size, cmdline_size, mem_size;
+	uintptr_t kernel;
+
+	if (rdev_readat(rdev, &hdr, SETUP_HDR_OFFSET, sizeof(hdr)) !=
+	    sizeof(hdr))
+		return;
+
+	if (hdr.boot_flag != SETUP_BOOT_FLAG || hdr.header != SETUP_HDRS ||
+	    hdr.version < SETUP_MIN_VERSION ||
+	    !(hdr.loadflags & SETUP_LOADED_HIGH)) {
+		printk(BIOS_ERR, "bzImage: not a kernel with boot protocol "
+		       "2.10 or newer\n");
+		return;
+	}
+
+	/* The header ends where the jump at its start goes to. */
+	hdr_size = MIN(offsetof(struct setup_header, header) +
+		       (hdr.jump >> 8), sizeof(hdr));
+
+	kernel_offset = ((hdr.setup_sects ? hdr.setup_sects : 4) + 1) * 512;
+	if (kernel_offset >= region_device_sz(rdev))
+		return;
+	kernel_size = region_device_sz(rdev) - kernel_offset;
+	cmdline_size = MIN(hdr.cmdline_size + 1, 4 * KiB);
+
+	/* The boot parameters and the command line share a buffer. */
+	params = bootmem_allocate_buffer(sizeof(*params) + cmdline_size);
+	if (params == NULL)
+		return;
+	memset(params, 0, sizeof(*params));
+	memcpy(&params->hdr, &hdr, hdr_size);
+	params->hdr.type_of_loader = SETUP_LOADER_UNKNOWN;
+
+	/* The kernel decompresses itself within init_size bytes. */
+	mem_size = MAX(kernel_size, hdr.init_size);
+	kernel = hdr.pref_address;
+	if (hdr.pref_address < 4ULL * GiB &&
+	    bootmem_region_targets_usable_ram(kernel, mem_size)) {
+		bootmem_add_range(kernel, mem_size, BM_MEM_PAYLOAD);
+	} else if (hdr.relocatable_kernel) {
+		size_t align = MAX(hdr.kernel_alignment, KERNEL_MIN_ALIGN);
+
+		kernel = reserve_ram(mem_size, align, 4ULL * GiB);
+	} else {
+		kernel = 0;
+	}
+	if (!kernel) {
+		printk(BIOS_ERR, "bzImage: no room for the kernel\n");
+		bootmem_dump_ranges();
+		return;
+	}
+
+	load_cmdline(params, (char *)(params + 1), cmdline_size);
+
+	if (load_initrd(params) < 0) {
+		printk(BIOS_ERR, "bzImage: could not load the initrd\n");
+		return;
+	}
+
+	printk(BIOS_INFO, "bzImage: loading kernel to 0x%lx, %zu bytes\n",
+	       (unsigned long)kernel, kernel_size);
+	if (rdev_readat(rdev, (void *)kernel, kernel_offset, kernel_size) !=
+	    kernel_size)
+		return;
+	prog_segment_loaded(kernel, kernel_size, SEG_FINAL);
+	params->hdr.code32_start = kernel;
+
+	/* Last, so that it covers what was put aside for the kernel. */
+	bootmem_walk_os_mem(fill_e820, params);
+
+	timestamp_add_now(TS_START_KERNEL);
+
+	prog_set_entry(payload, (void *)kernel, params);
+}
+
+void bzimage_run(struct prog *payload)
+{
+	/* The 32-bit boot protocol wants flat segments at 0x10 and 0x18 like
+	 * ours and %esi pointing to the boot parameters. */
+	__asm__ __volatile__(
+		"	cli\n\t"
+		"	cld\n\t"
+		"	xorl	%%ebp, %%ebp\n\t"
+		"	xorl	%%edi, %%edi\n\t"
+		"	xorl	%%ebx, %%ebx\n\t"
+		"	jmp	*%0\n\t"
+		:: "a" (prog_entry(payload)), "S" (prog_entry_arg(payload))
+	);
+}
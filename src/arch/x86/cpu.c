@@ -284,12 +284,17 @@ void lb_arch_add_records(struct lb_header *header)
 	uint32_t freq_khz;
 	struct lb_tsc_info *tsc_info;
 
-	/* Don't advertise a TSC rate unless it's constant. */
-	if (!IS_ENABLED(CONFIG_TSC_CONSTANT_RATE))
+	/*
+	 * Don't advertise a TSC rate unless it's constant or udelay()
+	 * already measured it; the payload would only calibrate it again.
+	 */
+	if (IS_ENABLED(CONFIG_TSC_CONSTANT_RATE))
+		freq_khz = tsc_freq_mhz() * 1000;
+	else if (IS_ENABLED(CONFIG_UDELAY_TSC))
+		freq_khz = tsc_calibrated_freq_mhz() * 1000;
+	else
 		return;
 
-	freq_khz = tsc_freq_mhz() * 1000;
-
 	/* No use exposing a TSC frequency that is zero. */
 	if (freq_khz == 0)
 		return;
@@ -20,6 +20,7 @@
 #include <console/streams.h>
 #include <cpu/x86/cr.h>
 #include <cpu/x86/lapic.h>
+#include <cpu/x86/profiler.h>
 #include <rules.h>
 #include <stdint.h>
 #include <string.h>
@@ -396,6 +397,12 @@ void x86_exception(struct eregs *info);
 
 void x86_exception(struct eregs *info)
 {
+#if HAVE_SAMPLING_PROFILER
+	if (info->vector == PROFILER_VECTOR) {
+		profiler_sample(info->eip);
+		return;
+	}
+#endif
 #if IS_ENABLED(CONFIG_GDB_STUB)
 	int signo;
 	memcpy(gdb_stub_registers, info, 8*sizeof(uint32_t));
@@ -562,13 +569,18 @@ struct intr_gate {
 extern u8 vec0[], vec1[], vec2[], vec3[], vec4[], vec5[], vec6[], vec7[];
 extern u8 vec8[], vec9[], vec10[], vec11[], vec12[], vec13[], vec14[], vec15[];
 extern u8 vec16[], vec17[], vec18[], vec19[];
+extern u8 vec_profiler[];
 
+/* Vectors without an entry are left not present. */
 static const uintptr_t intr_entries[] = {
 	(uintptr_t)vec0, (uintptr_t)vec1, (uintptr_t)vec2, (uintptr_t)vec3,
 	(uintptr_t)vec4, (uintptr_t)vec5, (uintptr_t)vec6, (uintptr_t)vec7,
 	(uintptr_t)vec8, (uintptr_t)vec9, (uintptr_t)vec10, (uintptr_t)vec11,
 	(uintptr_t)vec12, (uintptr_t)vec13, (uintptr_t)vec14, (uintptr_t)vec15,
 	(uintptr_t)vec16, (uintptr_t)vec17, (uintptr_t)vec18, (uintptr_t)vec19,
+#if HAVE_SAMPLING_PROFILER
+	[PROFILER_VECTOR] = (uintptr_t)vec_profiler,
+#endif
 };
 
 static struct intr_gate idt[ARRAY_SIZE(intr_entries)] __aligned(8) CAR_GLOBAL;
@@ -629,6 +641,10 @@ asmlinkage void exception_init(void)
 
 	/* Initialize IDT. */
 	for (i = 0; i < ARRAY_SIZE(idt); i++) {
+		if (!intr_entries[i]) {
+			memset(&gates[i], 0, sizeof(gates[i]));
+			continue;
+		}
 		gates[i].offset_0 = intr_entries[i];
 		gates[i].segsel = segment;
 		gates[i].flags = IGATE_FLAGS;
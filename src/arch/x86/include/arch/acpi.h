@@ -677,6 +677,19 @@ unsigned long acpi_fill_madt(unsigned long current);
 unsigned long acpi_fill_mcfg(unsigned long current);
 unsigned long acpi_fill_ivrs_ioapic(acpi_ivrs_t *ivrs, unsigned long current);
 void acpi_create_ssdt_generator(acpi_header_t *ssdt, const char *oem_table_id);
+/*
+ * SSDT kept across boots, see ACPI_SSDT_CACHE. Restoring returns 0 if the
+ * SSDT of the previous boot matched and was copied to ssdt.
+ */
+int acpi_ssdt_cache_restore(acpi_header_t *ssdt);
+void acpi_ssdt_cache_save(acpi_header_t *ssdt);
+/*
+ * Mix board or CPU specific inputs of the SSDT into the cache fingerprint
+ * with acpi_ssdt_cache_hash() and return the result. The default adds
+ * nothing.
+ */
+uint64_t acpi_ssdt_cache_fingerprint_extra(uint64_t hash);
+uint64_t acpi_ssdt_cache_hash(uint64_t hash, const void *data, size_t size);
 void acpi_create_fadt(acpi_fadt_t *fadt, acpi_facs_t *facs, void *dsdt);
 #if IS_ENABLED(CONFIG_COMMON_FADT)
 void acpi_fill_fadt(acpi_fadt_t *fadt);
@@ -687,6 +700,8 @@ void update_ssdtx(void *ssdtx, int i);
 
 /* These can be used by the target port. */
 u8 acpi_checksum(u8 *table, u32 length);
+void acpi_checksum_update(u8 *checksum, const void *old, const void *new,
+			  size_t size);
 
 void acpi_add_table(acpi_rsdp_t *rsdp, void *table);
 
@@ -816,6 +831,13 @@ static inline int acpi_s3_resume_allowed(void)
 	return IS_ENABLED(CONFIG_HAVE_ACPI_RESUME);
 }
 
+/* Whether OS memory gets overwritten by the resume path and needs a backup. */
+static inline int acpi_s3_lowmem_backup(void)
+{
+	return !IS_ENABLED(CONFIG_RELOCATABLE_RAMSTAGE) &&
+		!IS_ENABLED(CONFIG_ACPI_LOWMEM_RESERVED);
+}
+
 /* Return address in reserved memory where to backup low memory
  * while platform resumes from S3 suspend. Caller is responsible of
  * making a complete copy of the region base..base+size, with
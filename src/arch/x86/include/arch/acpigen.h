@@ -167,6 +167,16 @@ struct dsm_uuid {
 	void *arg;
 };
 
+/*
+ * AML that was generated once and can be emitted again by copying it.
+ * Package lengths are relative, so the copy is valid anywhere in the table
+ * as long as the template did not leave any scope open.
+ */
+struct acpigen_template {
+	const char *start;
+	size_t size;
+};
+
 void acpigen_write_return_integer(uint64_t arg);
 void acpigen_write_return_string(const char *arg);
 void acpigen_write_len_f(void);
@@ -183,6 +193,10 @@ void acpigen_emit_ext_op(uint8_t op);
 void acpigen_emit_word(unsigned int data);
 void acpigen_emit_dword(unsigned int data);
 void acpigen_emit_stream(const char *data, int size);
+void acpigen_template_begin(struct acpigen_template *tpl);
+void acpigen_template_end(struct acpigen_template *tpl);
+/* Returns the start of the copy, so the caller can patch it. */
+char *acpigen_template_emit(const struct acpigen_template *tpl);
 void acpigen_emit_string(const char *string);
 void acpigen_emit_namestring(const char *namepath);
 void acpigen_emit_eisaid(const char *eisaid);
@@ -73,6 +73,9 @@ static inline size_t car_data_size(void)
 	return ALIGN(car_size, 64);
 }
 
+/* Report the CAR stack high-water mark with CAR_STACK_WATERMARK. */
+void car_report_usage(void);
+
 static inline size_t car_object_offset(void *ptr)
 {
 	return (char *)ptr - &_car_relocatable_data_start[0];
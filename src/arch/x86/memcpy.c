@@ -17,19 +17,26 @@ void *memcpy(void *dest, const void *src, size_t n)
 {
 	unsigned long d0, d1, d2;
 
-	asm volatile(
 #ifdef __x86_64__
-		"rep ; movsd\n\t"
+	/* Quadwords first, then what's left byte by byte. */
+	asm volatile(
+		"rep ; movsq\n\t"
 		"mov %4,%%rcx\n\t"
+		"rep ; movsb\n\t"
+		: "=&c" (d0), "=&D" (d1), "=&S" (d2)
+		: "0" (n >> 3), "g" (n & 7), "1" (dest), "2" (src)
+		: "memory"
+	);
 #else
+	asm volatile(
 		"rep ; movsl\n\t"
 		"movl %4,%%ecx\n\t"
-#endif
 		"rep ; movsb\n\t"
 		: "=&c" (d0), "=&D" (d1), "=&S" (d2)
 		: "0" (n >> 2), "g" (n & 3), "1" (dest), "2" (src)
 		: "memory"
 	);
+#endif
 
 	return dest;
 }
@@ -14,6 +14,7 @@
  */
 
 #include <arch/cpu.h>
+#include <arch/early_variables.h>
 #include <cbmem.h>
 #include <console/console.h>
 #include <cpu/cpu.h>
@@ -171,6 +172,9 @@ void run_postcar_phase(struct postcar_frame *pcf)
 
 	postcar_commit_mtrrs(pcf);
 
+	if (IS_ENABLED(CONFIG_CAR_STACK_WATERMARK))
+		car_report_usage();
+
 	if (!IS_ENABLED(CONFIG_NO_STAGE_CACHE) &&
 				romstage_handoff_is_resume()) {
 		stage_cache_load_stage(STAGE_POSTCAR, &prog);
@@ -0,0 +1,132 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright 2018 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * SHA-256 through the Intel SHA extensions (SHA-NI), found on Goldmont and
+ * later Atoms, Cannon Lake and later cores, and Zen. The rest of coreboot is
+ * built without SSE, so only the transform is compiled for it and the CPU is
+ * checked before it runs.
+ */
+
+#include <arch/cpu.h>
+#include <cpu/x86/cr.h>
+#include <security/vboot/sha256_blocks.h>
+#include <types.h>
+
+#define CPUID_FEATURE_SSSE3	(1 << 9)	/* leaf 1, ECX */
+#define CPUID_FEATURE_SHA	(1 << 29)	/* leaf 7, EBX */
+
+#define SHA256_NI_TARGET __attribute__((target("sha,ssse3")))
+
+typedef int v4si __attribute__((vector_size(16)));
+typedef int v4si_u __attribute__((vector_size(16), aligned(1)));
+typedef char v16qi __attribute__((vector_size(16)));
+
+/* The round constants, four to a vector in the order the rounds use them. */
+static const v4si sha256_k[16] = {
+	{ 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5 },
+	{ 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5 },
+	{ 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3 },
+	{ 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174 },
+	{ 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc },
+	{ 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da },
+	{ 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7 },
+	{ 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967 },
+	{ 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13 },
+	{ 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85 },
+	{ 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3 },
+	{ 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070 },
+	{ 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5 },
+	{ 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3 },
+	{ 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208 },
+	{ 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 },
+};
+
+/* pshufb mask turning each big-endian message word into a native one. */
+static const v16qi sha256_bswap = {
+	3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+};
+
+int sha256_blocks_init(void)
+{
+	if (cpuid_eax(0) < 7)
+		return 0;
+	if (!(cpuid_ecx(1) & CPUID_FEATURE_SSSE3))
+		return 0;
+	if (!(cpuid_ext(7, 0).ebx & CPUID_FEATURE_SHA))
+		return 0;
+
+	/* SSE instructions fault until the OS (that is us) claims them. */
+	write_cr4(read_cr4() | CR4_OSFXSR);
+
+	return 1;
+}
+
+/*
+ * sha256rnds2 keeps the state as { F, E, B, A } and { H, G, D, C } (lowest
+ * lane first) and runs two rounds at a time with W + K in the low lanes.
+ */
+SHA256_NI_TARGET
+void sha256_blocks_transform(uint32_t state[8], const uint8_t *data,
+			     size_t blocks)
+{
+	v4si abef = { state[5], state[4], state[1], state[0] };
+	v4si cdgh = { state[7], state[6], state[3], state[2] };
+
+	do {
+		v4si abef_save = abef;
+		v4si cdgh_save = cdgh;
+		v4si w[4];
+		int i;
+
+		for (i = 0; i < 16; i++) {
+			v4si m, wk;
+
+			if (i < 4) {
+				m = *(const v4si_u *)(data + i * sizeof(v4si));
+				m = (v4si)__builtin_ia32_pshufb128((v16qi)m,
+								   sha256_bswap);
+			} else {
+				v4si prev = w[(i - 1) % 4];
+				v4si prev2 = w[(i - 2) % 4];
+				v4si w7 = { prev2[1], prev2[2], prev2[3],
+					    prev[0] };
+
+				m = __builtin_ia32_sha256msg1(w[i % 4],
+							      w[(i - 3) % 4]);
+				m = __builtin_ia32_sha256msg2(m + w7, prev);
+			}
+			w[i % 4] = m;
+
+			wk = m + sha256_k[i];
+			cdgh = __builtin_ia32_sha256rnds2(cdgh, abef, wk);
+			wk = (v4si){ wk[2], wk[3], 0, 0 };
+			abef = __builtin_ia32_sha256rnds2(abef, cdgh, wk);
+		}
+
+		abef += abef_save;
+		cdgh += cdgh_save;
+		data += 64;
+	} while (--blocks);
+
+	state[0] = abef[3];
+	state[1] = abef[2];
+	state[2] = cdgh[3];
+	state[3] = cdgh[2];
+	state[4] = abef[1];
+	state[5] = abef[0];
+	state[6] = cdgh[1];
+	state[7] = cdgh[0];
+}
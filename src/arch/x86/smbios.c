@@ -48,6 +48,7 @@ int smbios_add_string(u8 *start, const char *str)
 {
 	int i = 1;
 	char *p = (char *)start;
+	size_t len, plen;
 
 	/*
 	 * Return 0 as required for empty strings.
@@ -56,19 +57,21 @@ int smbios_add_string(u8 *start, const char *str)
 	if (*str == '\0')
 		return 0;
 
+	len = strlen(str) + 1;
+
 	for (;;) {
 		if (!*p) {
-			strcpy(p, str);
-			p += strlen(str);
-			*p++ = '\0';
-			*p++ = '\0';
+			/* Copies the terminator, the second one ends the set. */
+			memcpy(p, str, len);
+			p[len] = '\0';
 			return i;
 		}
 
-		if (!strcmp(p, str))
+		plen = strlen(p) + 1;
+		if (plen == len && !memcmp(p, str, len))
 			return i;
 
-		p += strlen(p)+1;
+		p += plen;
 		i++;
 	}
 }
@@ -736,6 +739,13 @@ unsigned long smbios_write_tables(unsigned long current)
 	current = ALIGN(current, 16);
 
 	tables = current;
+	if (IS_ENABLED(CONFIG_SMBIOS_CACHE) &&
+	    smbios_cache_restore((void *)tables, &len, &max_struct_size,
+				 &handle) == 0) {
+		current += len;
+		goto entry_point;
+	}
+
 	update_max(len, max_struct_size, smbios_write_type0(&current,
 		handle++));
 	update_max(len, max_struct_size, smbios_write_type1(&current,
@@ -763,6 +773,10 @@ unsigned long smbios_write_tables(unsigned long current)
 	update_max(len, max_struct_size, smbios_write_type127(&current,
 		handle++));
 
+	if (IS_ENABLED(CONFIG_SMBIOS_CACHE))
+		smbios_cache_save((void *)tables, len, max_struct_size, handle);
+
+entry_point:
 	memset(se, 0, sizeof(struct smbios_entry));
 	memcpy(se->anchor, "_SM_", 4);
 	se->length = sizeof(struct smbios_entry);
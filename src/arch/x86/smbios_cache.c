@@ -0,0 +1,181 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/cpu.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <device/device.h>
+#include <fmap.h>
+#include <memory_info.h>
+#include <region_file.h>
+#include <smbios.h>
+#include <string.h>
+#include <version.h>
+
+/*
+ * The SMBIOS structures of the previous boot are kept in flash, keyed by a
+ * fingerprint of everything they are built from: the coreboot build, the
+ * CPU, the DIMMs found by raminit, the mainboard strings and the devices.
+ */
+#define SMBIOS_CACHE_REGION	"RW_SMBIOS_CACHE"
+#define SMBIOS_CACHE_SIGNATURE	0x534d4253	/* 'SBMS' */
+
+/* Stored right in front of the structures. */
+struct smbios_cache_header {
+	uint32_t signature;
+	uint32_t length;
+	uint64_t fingerprint;
+	uint16_t max_struct_size;
+	uint16_t struct_count;
+} __packed;
+
+#define FNV64_OFFSET	0xcbf29ce484222325ULL
+#define FNV64_PRIME	0x100000001b3ULL
+
+static uint64_t fnv64(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *p = data;
+
+	while (size--) {
+		hash ^= *p++;
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t fnv64_str(uint64_t hash, const char *str)
+{
+	/* Include the NUL so that "ab" "c" differs from "a" "bc". */
+	return fnv64(hash, str, strlen(str) + 1);
+}
+
+static uint64_t fnv64_u32(uint64_t hash, uint32_t value)
+{
+	return fnv64(hash, &value, sizeof(value));
+}
+
+static uint64_t smbios_cache_fingerprint(const void *tables)
+{
+	const struct memory_info *meminfo;
+	struct cpuid_result res;
+	struct device *dev;
+	uint64_t hash = FNV64_OFFSET;
+	uint8_t uuid[16];
+	int i;
+
+	hash = fnv64_str(hash, coreboot_version);
+	hash = fnv64_str(hash, coreboot_compile_time);
+	hash = fnv64_u32(hash, (uintptr_t)tables);
+
+	if (cpu_have_cpuid()) {
+		hash = fnv64_u32(hash, cpuid_eax(1));
+		for (i = 0; i < 3; i++) {
+			res = cpuid(0x80000002 + i);
+			hash = fnv64(hash, &res, sizeof(res));
+		}
+	}
+
+	meminfo = cbmem_find(CBMEM_ID_MEMINFO);
+	if (meminfo)
+		hash = fnv64(hash, meminfo, sizeof(*meminfo));
+
+	hash = fnv64_str(hash, smbios_mainboard_manufacturer());
+	hash = fnv64_str(hash, smbios_mainboard_product_name());
+	hash = fnv64_str(hash, smbios_mainboard_serial_number());
+	hash = fnv64_str(hash, smbios_mainboard_version());
+	hash = fnv64_str(hash, smbios_mainboard_sku());
+	hash = fnv64_str(hash, smbios_mainboard_asset_tag());
+	memset(uuid, 0, sizeof(uuid));
+	smbios_mainboard_set_uuid(uuid);
+	hash = fnv64(hash, uuid, sizeof(uuid));
+
+	for (dev = all_devices; dev; dev = dev->next) {
+		hash = fnv64_str(hash, dev_path(dev));
+		hash = fnv64_u32(hash, dev->enabled);
+		hash = fnv64_u32(hash, (dev->vendor << 16) | dev->device);
+		hash = fnv64_u32(hash, (dev->subsystem_vendor << 16) |
+				 dev->subsystem_device);
+	}
+
+	return hash;
+}
+
+static int smbios_cache_open(struct region_file *file, int rw)
+{
+	struct region_device rdev;
+	int ret;
+
+	if (rw)
+		ret = fmap_locate_area_as_rdev_rw(SMBIOS_CACHE_REGION, &rdev);
+	else
+		ret = fmap_locate_area_as_rdev(SMBIOS_CACHE_REGION, &rdev);
+	if (ret < 0)
+		return -1;
+
+	return region_file_init(file, &rdev);
+}
+
+int smbios_cache_restore(void *tables, int *len, int *max_struct_size,
+			 int *struct_count)
+{
+	struct smbios_cache_header header;
+	struct region_file file;
+	struct region_device rdev;
+
+	if (smbios_cache_open(&file, 0) < 0 ||
+	    region_file_data(&file, &rdev) < 0)
+		return -1;
+
+	if (rdev_readat(&rdev, &header, 0, sizeof(header)) != sizeof(header))
+		return -1;
+
+	if (header.signature != SMBIOS_CACHE_SIGNATURE ||
+	    header.length != region_device_sz(&rdev) - sizeof(header) ||
+	    header.fingerprint != smbios_cache_fingerprint(tables))
+		return -1;
+
+	if (rdev_readat(&rdev, tables, sizeof(header), header.length) !=
+	    header.length)
+		return -1;
+
+	*len = header.length;
+	*max_struct_size = header.max_struct_size;
+	*struct_count = header.struct_count;
+
+	printk(BIOS_DEBUG, "SMBIOS: Reusing tables of the previous boot\n");
+	return 0;
+}
+
+void smbios_cache_save(void *tables, int len, int max_struct_size,
+		       int struct_count)
+{
+	struct smbios_cache_header *header;
+	struct region_file file;
+
+	/*
+	 * The entry point in front of the structures is written last, so the
+	 * header can be put there to write the record in one go.
+	 */
+	_Static_assert(sizeof(*header) <= sizeof(struct smbios_entry),
+		       "SMBIOS cache header must fit in front of the tables");
+	header = (void *)((uintptr_t)tables - sizeof(*header));
+	header->signature = SMBIOS_CACHE_SIGNATURE;
+	header->length = len;
+	header->fingerprint = smbios_cache_fingerprint(tables);
+	header->max_struct_size = max_struct_size;
+	header->struct_count = struct_count;
+
+	if (smbios_cache_open(&file, 1) < 0 ||
+	    region_file_update_data(&file, header, sizeof(*header) + len) < 0)
+		printk(BIOS_ERR, "SMBIOS: Failed to update the cache\n");
+}
@@ -267,4 +267,9 @@ void bootmem_arch_add_ranges(void)
 	const uintptr_t base = 0;
 
 	bootmem_add_range(base, forwarding_table - base, BM_MEM_TABLE);
+
+	/* The resume path runs here, keep the OS out instead of backing up. */
+	if (IS_ENABLED(CONFIG_ACPI_LOWMEM_RESERVED))
+		bootmem_add_range(CONFIG_RAMBASE, HIGH_MEMORY_SAVE,
+				  BM_MEM_RESERVED);
 }
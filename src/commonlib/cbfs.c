@@ -37,6 +37,12 @@
 #define DEBUG(x...)
 #endif
 
+#if defined(IS_ENABLED)
+#define CBFS_HASH_INSTRUCTIONS IS_ENABLED(CONFIG_HAVE_SHA256_INSTRUCTIONS)
+#else
+#define CBFS_HASH_INSTRUCTIONS 0
+#endif
+
 static size_t cbfs_next_offset(const struct region_device *cbfs,
 				const struct cbfsf *f)
 {
@@ -169,6 +175,56 @@ int cbfsf_file_type(struct cbfsf *fh, uint32_t *ftype)
 	return 0;
 }
 
+/* Returns 0 if fh is named name and has the requested type, 1 if not and
+ * < 0 on error. Same type semantics as cbfs_locate(). */
+static int cbfsf_match(struct cbfsf *fh, const struct region_device *cbfs,
+		const char *name, uint32_t *type)
+{
+	char *fname;
+	int name_match;
+	const size_t fsz = sizeof(struct cbfs_file);
+
+	fname = rdev_mmap(&fh->metadata, fsz,
+			region_device_sz(&fh->metadata) - fsz);
+
+	if (fname == NULL)
+		return -1;
+
+	name_match = !strcmp(fname, name);
+	rdev_munmap(&fh->metadata, fname);
+
+	if (!name_match) {
+		DEBUG(" Unmatched '%s' at %zx\n", fname,
+			rdev_relative_offset(cbfs, &fh->metadata));
+		return 1;
+	}
+
+	if (type != NULL) {
+		uint32_t ftype;
+
+		if (cbfsf_file_type(fh, &ftype))
+			return -1;
+
+		if (*type != 0 && *type != ftype) {
+			DEBUG(" Unmatched type %x at %zx\n", ftype,
+				rdev_relative_offset(cbfs, &fh->metadata));
+			return 1;
+		}
+		// *type being 0 means we want to know ftype.
+		// We could just do a blind assignment but
+		// if type is pointing to read-only memory
+		// that might be bad.
+		if (*type == 0)
+			*type = ftype;
+	}
+
+	LOG("Found @ offset %zx size %zx\n",
+		rdev_relative_offset(cbfs, &fh->metadata),
+		region_device_sz(&fh->data));
+
+	return 0;
+}
+
 int cbfs_locate(struct cbfsf *fh, const struct region_device *cbfs,
 		const char *name, uint32_t *type)
 {
@@ -180,9 +236,6 @@ int cbfs_locate(struct cbfsf *fh, const struct region_device *cbfs,
 
 	while (1) {
 		int ret;
-		char *fname;
-		int name_match;
-		const size_t fsz = sizeof(struct cbfs_file);
 
 		ret = cbfs_for_each_file(cbfs, prev, fh);
 		prev = fh;
@@ -191,44 +244,186 @@ int cbfs_locate(struct cbfsf *fh, const struct region_device *cbfs,
 		if (ret < 0 || ret > 0)
 			break;
 
-		fname = rdev_mmap(&fh->metadata, fsz,
-				region_device_sz(&fh->metadata) - fsz);
+		ret = cbfsf_match(fh, cbfs, name, type);
 
-		if (fname == NULL)
+		if (ret < 0)
 			break;
 
-		name_match = !strcmp(fname, name);
-		rdev_munmap(&fh->metadata, fname);
-
-		if (!name_match) {
-			DEBUG(" Unmatched '%s' at %zx\n", fname,
-				rdev_relative_offset(cbfs, &fh->metadata));
+		if (ret > 0)
 			continue;
+
+		/* Success. */
+		return 0;
+	}
+
+	LOG("'%s' not found.\n", name);
+	return -1;
+}
+
+int cbfs_locate_at(struct cbfsf *fh, const struct region_device *cbfs,
+		size_t offset, const char *name, uint32_t *type)
+{
+	struct cbfs_file file;
+	const size_t fsz = sizeof(file);
+
+	if (rdev_readat(cbfs, &file, offset, fsz) != fsz)
+		return -1;
+
+	if (memcmp(file.magic, CBFS_FILE_MAGIC, sizeof(file.magic)))
+		return -1;
+
+	file.len = read_be32(&file.len);
+	file.offset = read_be32(&file.offset);
+
+	if (file.offset <= fsz)
+		return -1;
+
+	if (rdev_chain(&fh->metadata, cbfs, offset, file.offset))
+		return -1;
+
+	if (rdev_chain(&fh->data, cbfs, offset + file.offset, file.len))
+		return -1;
+
+	return cbfsf_match(fh, cbfs, name, type) ? -1 : 0;
+}
+
+/* 32-bit FNV-1a over the NUL-terminated name, bounded by max_len bytes. */
+static uint32_t cbfs_name_hash(const char *name, size_t max_len)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	while (max_len-- && *name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+int cbfs_index_build(struct cbfs_index *idx, const struct region_device *cbfs)
+{
+	struct cbfsf f;
+	struct cbfsf *prev;
+	const size_t fsz = sizeof(struct cbfs_file);
+
+	idx->num_entries = 0;
+	prev = NULL;
+
+	while (1) {
+		struct cbfs_index_entry entry;
+		struct cbfs_file *file;
+		size_t metadata_size;
+		size_t i;
+		int ret;
+
+		ret = cbfs_for_each_file(cbfs, prev, &f);
+		prev = &f;
+
+		if (ret < 0)
+			return -1;
+
+		/* End of CBFS. */
+		if (ret > 0)
+			break;
+
+		if (idx->num_entries >= idx->max_entries) {
+			ERROR("Index full after %u files.\n", idx->num_entries);
+			return -1;
 		}
 
-		if (type != NULL) {
-			uint32_t ftype;
+		metadata_size = region_device_sz(&f.metadata);
+		if (metadata_size < fsz)
+			return -1;
 
-			if (cbfsf_file_type(fh, &ftype))
-				break;
+		file = rdev_mmap_full(&f.metadata);
+		if (file == NULL)
+			return -1;
+
+		entry.name_hash = cbfs_name_hash((char *)file + fsz,
+						metadata_size - fsz);
+		entry.type = read_be32(&file->type);
+		rdev_munmap(&f.metadata, file);
 
-			if (*type != 0 && *type != ftype) {
-				DEBUG(" Unmatched type %x at %zx\n", ftype,
-					rdev_relative_offset(cbfs,
-							&fh->metadata));
-				continue;
-			}
-			// *type being 0 means we want to know ftype.
-			// We could just do a blind assignment but
-			// if type is pointing to read-only memory
-			// that might be bad.
-			if (*type == 0)
-				*type = ftype;
+		entry.offset = rdev_relative_offset(cbfs, &f.metadata);
+		entry.metadata_size = metadata_size;
+		entry.data_size = region_device_sz(&f.data);
+
+		/* Insertion sort keeping CBFS order among equal hashes. */
+		for (i = idx->num_entries; i > 0; i--) {
+			if (idx->entries[i - 1].name_hash <= entry.name_hash)
+				break;
+			idx->entries[i] = idx->entries[i - 1];
 		}
+		idx->entries[i] = entry;
+		idx->num_entries++;
+	}
+
+	DEBUG("Indexed %u files.\n", idx->num_entries);
+
+	return 0;
+}
+
+int cbfs_index_locate(const struct cbfs_index *idx, struct cbfsf *fh,
+		const struct region_device *cbfs, const char *name,
+		uint32_t *type)
+{
+	const size_t fsz = sizeof(struct cbfs_file);
+	uint32_t hash;
+	size_t lo;
+	size_t hi;
+
+	LOG("Locating '%s'\n", name);
+
+	hash = cbfs_name_hash(name, strlen(name));
+
+	/* Find the first entry with a matching hash. */
+	lo = 0;
+	hi = idx->num_entries;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (idx->entries[mid].name_hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < idx->num_entries; lo++) {
+		const struct cbfs_index_entry *e = &idx->entries[lo];
+		char *fname;
+		int name_match;
+
+		if (e->name_hash != hash)
+			break;
 
-		LOG("Found @ offset %zx size %zx\n",
-			rdev_relative_offset(cbfs, &fh->metadata),
-			region_device_sz(&fh->data));
+		if (type != NULL && *type != 0 && *type != e->type)
+			continue;
+
+		if (rdev_chain(&fh->metadata, cbfs, e->offset,
+				e->metadata_size))
+			break;
+
+		if (rdev_chain(&fh->data, cbfs, e->offset + e->metadata_size,
+				e->data_size))
+			break;
+
+		fname = rdev_mmap(&fh->metadata, fsz, e->metadata_size - fsz);
+
+		if (fname == NULL)
+			break;
+
+		name_match = !strcmp(fname, name);
+		rdev_munmap(&fh->metadata, fname);
+
+		/* Hash collision. */
+		if (!name_match)
+			continue;
+
+		// *type being 0 means we want to know ftype.
+		if (type != NULL && *type == 0)
+			*type = e->type;
+
+		LOG("Found @ offset %x size %x\n", e->offset, e->data_size);
 
 		/* Success. */
 		return 0;
@@ -376,3 +571,87 @@ int cbfs_vb2_hash_contents(const struct region_device *cbfs,
 
 	return vb2_digest_finalize(&ctx, digest, digest_sz);
 }
+
+/*
+ * Hash a whole file through the vb2ex_hwcrypto hooks when the CPU has hash
+ * instructions. Returns non-zero if the caller should hash in software.
+ */
+static int cbfs_hash_instructions(const struct region_device *rdev,
+				  enum vb2_hash_algorithm hash_alg,
+				  uint8_t *digest, size_t digest_size)
+{
+	size_t size = region_device_sz(rdev);
+	void *data;
+	int rv;
+
+	if (!CBFS_HASH_INSTRUCTIONS)
+		return -1;
+
+	if (vb2ex_hwcrypto_digest_init(hash_alg, size))
+		return -1;
+
+	data = rdev_mmap_full(rdev);
+	if (!data)
+		return -1;
+
+	rv = vb2ex_hwcrypto_digest_extend(data, size);
+	rdev_munmap(rdev, data);
+
+	if (rv)
+		return rv;
+
+	return vb2ex_hwcrypto_digest_finalize(digest, digest_size);
+}
+
+int cbfsf_verify_hash(struct cbfsf *fh)
+{
+	size_t metadata_size = region_device_sz(&fh->metadata);
+	void *metadata = rdev_mmap_full(&fh->metadata);
+	size_t offs = 0;
+	int ret = 1;
+
+	if (!metadata)
+		return -1;
+
+	while ((offs = cbfs_for_each_attr(metadata, metadata_size, offs))) {
+		struct cbfs_file_attr_hash *attr = metadata + offs;
+		struct vb2_digest_context ctx;
+		uint8_t digest[VB2_SHA512_DIGEST_SIZE];
+		size_t digest_size;
+		enum vb2_hash_algorithm hash_alg;
+
+		if (read_be32(&attr->tag) != CBFS_FILE_ATTR_TAG_HASH)
+			continue;
+
+		hash_alg = read_be32(&attr->hash_type);
+		digest_size = vb2_digest_size(hash_alg);
+
+		if (digest_size == 0 || digest_size > sizeof(digest) ||
+		    offs + read_be32(&attr->len) > metadata_size ||
+		    read_be32(&attr->len) < sizeof(*attr) + digest_size) {
+			ERROR("Invalid hash attribute.\n");
+			ret = -1;
+			break;
+		}
+
+		if (cbfs_hash_instructions(&fh->data, hash_alg, digest,
+					   digest_size) &&
+		    (vb2_digest_init(&ctx, hash_alg) ||
+		     cbfs_extend_hash(&ctx, &fh->data) ||
+		     vb2_digest_finalize(&ctx, digest, digest_size))) {
+			ret = -1;
+			break;
+		}
+
+		if (memcmp(digest, attr->hash_data, digest_size)) {
+			ERROR("File hash mismatch.\n");
+			ret = -1;
+			break;
+		}
+
+		ret = 0;
+	}
+
+	rdev_munmap(&fh->metadata, metadata);
+	return ret;
+}
@@ -0,0 +1,35 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __BOOT_MEDIA_TRACE_SERIALIZED_H__
+#define __BOOT_MEDIA_TRACE_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/* One read of the boot media, offset and size in bytes. */
+struct boot_media_trace_entry {
+	uint32_t offset;
+	uint32_t size;
+} __packed;
+
+/* The reads in the order they were issued. */
+struct boot_media_trace {
+	uint32_t max_entries;
+	uint32_t num_entries;
+	uint32_t dropped;	/* reads that did not fit any more */
+	uint32_t reserved;
+	struct boot_media_trace_entry entries[0];
+} __packed;
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __BS_TIMES_SERIALIZED_H__
+#define __BS_TIMES_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+#define BS_TIMES_NAME_LENGTH 32
+
+/* What an entry timed. */
+enum bs_times_kind {
+	BS_TIMES_ON_ENTRY = 0,		/* boot state entry callback */
+	BS_TIMES_ON_EXIT = 1,		/* boot state exit callback */
+	BS_TIMES_READ_RESOURCES = 2,	/* device read_resources() */
+	BS_TIMES_ENABLE_RESOURCES = 3,	/* device enable_resources() */
+	BS_TIMES_INIT = 4,		/* device init() */
+	BS_TIMES_FSP_NOTIFY = 5,	/* FspNotify() phase */
+};
+
+struct bs_times_entry {
+	uint64_t func;		/* address of the function timed */
+	uint32_t start;		/* monotonic timer usecs at start */
+	uint32_t usecs;		/* how long it ran */
+	uint8_t kind;		/* enum bs_times_kind */
+	uint8_t state;		/* boot state it ran in */
+	uint16_t reserved;
+	char name[BS_TIMES_NAME_LENGTH]; /* callback or device path */
+} __packed;
+
+struct bs_times_table {
+	uint32_t max_entries;
+	uint32_t num_entries;
+	struct bs_times_entry entries[0]; /* Variable number of entries */
+} __packed;
+
+#endif
@@ -31,6 +31,11 @@ struct cbfsf {
 int cbfs_locate(struct cbfsf *fh, const struct region_device *cbfs,
 		const char *name, uint32_t *type);
 
+/* Check that the file at offset within cbfs has the given name and optional
+ * type and fill out fh for it. Same semantics as cbfs_locate() otherwise. */
+int cbfs_locate_at(struct cbfsf *fh, const struct region_device *cbfs,
+		size_t offset, const char *name, uint32_t *type);
+
 static inline void cbfs_file_data(struct region_device *data,
 					const struct cbfsf *file)
 {
@@ -76,6 +81,55 @@ int cbfsf_decompression_info(struct cbfsf *fh, uint32_t *algo, size_t *size);
  */
 int cbfsf_file_type(struct cbfsf *fh, uint32_t *ftype);
 
+/*
+ * A CBFS lookup index maps a hash of every file name to the location of its
+ * metadata. Looking up a file through the index costs one probe of the
+ * (sorted) entry table plus a single metadata read instead of one header read
+ * per file in the CBFS. Entries with equal hashes are kept in CBFS order so
+ * lookups return the same file cbfs_locate() would.
+ */
+struct cbfs_index_entry {
+	uint32_t name_hash;
+	uint32_t type;
+	/* Offset of the file metadata relative to the start of the CBFS. */
+	uint32_t offset;
+	uint32_t metadata_size;
+	uint32_t data_size;
+};
+
+struct cbfs_index {
+	uint32_t num_entries;
+	uint32_t max_entries;
+	struct cbfs_index_entry entries[0];
+};
+
+/* Return the number of bytes required for an index of max_entries files. */
+static inline size_t cbfs_index_size(size_t max_entries)
+{
+	return sizeof(struct cbfs_index) +
+		max_entries * sizeof(struct cbfs_index_entry);
+}
+
+/*
+ * Fill out the index by walking all files in cbfs. The caller must set
+ * max_entries according to the storage backing idx. Returns 0 on success
+ * and < 0 on error, including the CBFS holding more than max_entries files.
+ */
+int cbfs_index_build(struct cbfs_index *idx, const struct region_device *cbfs);
+
+/* Locate file by name and optional type using an index built from cbfs by
+ * cbfs_index_build(). Same semantics as cbfs_locate(). */
+int cbfs_index_locate(const struct cbfs_index *idx, struct cbfsf *fh,
+		const struct region_device *cbfs, const char *name,
+		uint32_t *type);
+
+/*
+ * Check the file contents against the hash attributes in its metadata.
+ * Return 0 if all hashes match, 1 if the file has no hash attribute and < 0
+ * on a mismatch or error.
+ */
+int cbfsf_verify_hash(struct cbfsf *fh);
+
 /*
  * Perform the vb2 hash over the CBFS region skipping empty file contents.
  * Caller is responsible for providing the hash algorithm as well as storage
@@ -69,6 +69,7 @@
 #define CBFS_TYPE_STAGE      0x10
 #define CBFS_TYPE_SELF       0x20
 #define CBFS_TYPE_FIT        0x21
+#define CBFS_TYPE_BZIMAGE    0x22
 #define CBFS_TYPE_OPTIONROM  0x30
 #define CBFS_TYPE_BOOTSPLASH 0x40
 #define CBFS_TYPE_RAW        0x50
@@ -92,7 +93,10 @@
 
 /* this is the master cbfs header - it must be located somewhere available
  * to bootblock (to load romstage). The last 4 bytes in the image contain its
- * relative offset from the end of the image (as a 32-bit signed integer). */
+ * relative offset from the end of the image (as a 32-bit signed integer).
+ * stage_offset is the offset of the file header of the first stage loaded by
+ * the bootblock on the boot media, as recorded by cbfstool. It is only a hint
+ * since older cbfstool versions left it uninitialized. */
 
 struct cbfs_header {
 	uint32_t magic;
@@ -102,7 +106,7 @@ struct cbfs_header {
 	uint32_t align; /* fixed to 64 bytes */
 	uint32_t offset;
 	uint32_t architecture;
-	uint32_t pad[1];
+	uint32_t stage_offset;
 } __packed;
 
 /* this used to be flexible, but wasn't ever set to something different. */
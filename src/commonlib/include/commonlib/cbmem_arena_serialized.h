@@ -0,0 +1,42 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __CBMEM_ARENA_SERIALIZED_H__
+#define __CBMEM_ARENA_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/* Every record starts at a multiple of this from the start of data[]. */
+#define CBMEM_ARENA_ALIGN	8
+
+struct cbmem_arena_record {
+	uint32_t tag;		/* what the payload is, chosen by its owner */
+	uint32_t size;		/* payload bytes, without header or padding */
+	uint8_t data[0];
+} __packed;
+
+/*
+ * Records are allocated back to back in data[], each taking
+ * ALIGN_UP(sizeof(struct cbmem_arena_record) + size, CBMEM_ARENA_ALIGN)
+ * bytes. Nothing is ever freed.
+ */
+struct cbmem_arena {
+	uint32_t size;		/* bytes available in data[] */
+	uint32_t used;		/* bytes taken by records */
+	uint32_t num_records;
+	uint32_t reserved;
+	uint8_t data[0];
+} __packed;
+
+#endif
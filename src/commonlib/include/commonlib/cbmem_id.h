@@ -23,10 +23,15 @@
 #define CBMEM_ID_AFTER_CAR	0xc4787a93
 #define CBMEM_ID_AGESA_RUNTIME	0x41474553
 #define CBMEM_ID_AMDMCT_MEMINFO 0x494D454E
+#define CBMEM_ID_ARENA		0x4152454e
+#define CBMEM_ID_BOOT_MEDIA_TRACE 0x424d5452
+#define CBMEM_ID_BS_TIMES	0x42535449
 #define CBMEM_ID_CAR_GLOBALS	0xcac4e6a3
 #define CBMEM_ID_CBTABLE	0x43425442
 #define CBMEM_ID_CBTABLE_FWD	0x43425443
+#define CBMEM_ID_CBFS_INDEX	0x43424958
 #define CBMEM_ID_CONSOLE	0x434f4e53
+#define CBMEM_ID_CONSOLE_BINLOG	0x434f4e42
 #define CBMEM_ID_COVERAGE	0x47434f56
 #define CBMEM_ID_EHCI_DEBUG	0xe4c1deb9
 #define CBMEM_ID_ELOG		0x454c4f47
@@ -38,27 +43,35 @@
 #define CBMEM_ID_IGD_OPREGION	0x4f444749
 #define CBMEM_ID_IMD_ROOT	0xff4017ff
 #define CBMEM_ID_IMD_SMALL	0x53a11439
+#define CBMEM_ID_IPMI_FRU	0x46525520
 #define CBMEM_ID_MEMINFO	0x494D454D
+#define CBMEM_ID_MEM_USAGE	0x4d454d55
 #define CBMEM_ID_MMA_DATA	0x4D4D4144
 #define CBMEM_ID_MPTABLE	0x534d5054
 #define CBMEM_ID_MRCDATA	0x4d524344
 #define CBMEM_ID_VAR_MRCDATA	0x4d524345
 #define CBMEM_ID_MTC		0xcb31d31c
+#define CBMEM_ID_MTRR		0x4d545252
 #define CBMEM_ID_NONE		0x00000000
 #define CBMEM_ID_PIRQ		0x49525154
 #define CBMEM_ID_POWER_STATE	0x50535454
+#define CBMEM_ID_PROFILE	0x50524f46
 #define CBMEM_ID_RAM_OOPS	0x05430095
 #define CBMEM_ID_RAMSTAGE	0x9a357a9e
 #define CBMEM_ID_RAMSTAGE_CACHE	0x9a3ca54e
 #define CBMEM_ID_REFCODE	0x04efc0de
 #define CBMEM_ID_REFCODE_CACHE	0x4efc0de5
+#define CBMEM_ID_REGF_CACHE	0x52454746
 #define CBMEM_ID_RESUME		0x5245534d
 #define CBMEM_ID_RESUME_SCRATCH	0x52455343
+#define CBMEM_ID_RESUME_SCRIPT	0x52455350
 #define CBMEM_ID_ROMSTAGE_INFO	0x47545352
 #define CBMEM_ID_ROMSTAGE_RAM_STACK 0x90357ac4
 #define CBMEM_ID_ROOT		0xff4007ff
+#define CBMEM_ID_SDHCI_HANDOFF	0x53444843
 #define CBMEM_ID_SMBIOS         0x534d4254
 #define CBMEM_ID_SMM_SAVE_SPACE	0x07e9acee
+#define CBMEM_ID_SPD		0x53504420
 #define CBMEM_ID_STAGEx_META	0x57a9e000
 #define CBMEM_ID_STAGEx_CACHE	0x57a9e100
 #define CBMEM_ID_STAGEx_RAW	0x57a9e200
@@ -70,8 +83,10 @@
 #define CBMEM_ID_VBOOT_SEL_REG	0x780074f1
 #define CBMEM_ID_VBOOT_WORKBUF	0x78007343
 #define CBMEM_ID_VPD		0x56504420
+#define CBMEM_ID_VPD_INDEX	0x56504449
 #define CBMEM_ID_WIFI_CALIBRATION 0x57494649
 #define CBMEM_ID_EC_HOSTEVENT	0x63ccbbc3
+#define CBMEM_ID_EC_INFO	0x45434946
 #define CBMEM_ID_EXT_VBT	0x69866684
 #define CBMEM_ID_ROM0		0x524f4d30
 #define CBMEM_ID_ROM1		0x524f4d31
@@ -85,10 +100,15 @@
 	{ CBMEM_ID_AGESA_RUNTIME,	"AGESA RSVD " }, \
 	{ CBMEM_ID_AFTER_CAR,		"AFTER CAR  " }, \
 	{ CBMEM_ID_AMDMCT_MEMINFO,	"AMDMEM INFO" }, \
+	{ CBMEM_ID_ARENA,		"CBMEM ARENA" }, \
+	{ CBMEM_ID_BOOT_MEDIA_TRACE,	"MEDIA TRACE" }, \
+	{ CBMEM_ID_BS_TIMES,		"BS TIMES   " }, \
 	{ CBMEM_ID_CAR_GLOBALS,		"CAR GLOBALS" }, \
 	{ CBMEM_ID_CBTABLE,		"COREBOOT   " }, \
 	{ CBMEM_ID_CBTABLE_FWD,		"COREBOOTFWD" }, \
+	{ CBMEM_ID_CBFS_INDEX,		"CBFS INDEX " }, \
 	{ CBMEM_ID_CONSOLE,		"CONSOLE    " }, \
+	{ CBMEM_ID_CONSOLE_BINLOG,	"CONSOLE BIN" }, \
 	{ CBMEM_ID_COVERAGE,		"COVERAGE   " }, \
 	{ CBMEM_ID_EHCI_DEBUG,		"USBDEBUG   " }, \
 	{ CBMEM_ID_ELOG,		"ELOG       " }, \
@@ -99,26 +119,34 @@
 	{ CBMEM_ID_HOB_POINTER,		"HOB        " }, \
 	{ CBMEM_ID_IMD_ROOT,		"IMD ROOT   " }, \
 	{ CBMEM_ID_IMD_SMALL,		"IMD SMALL  " }, \
+	{ CBMEM_ID_IPMI_FRU,		"IPMI FRU   " }, \
 	{ CBMEM_ID_MEMINFO,		"MEM INFO   " }, \
+	{ CBMEM_ID_MEM_USAGE,		"MEM USAGE  " }, \
 	{ CBMEM_ID_MMA_DATA,		"MMA DATA   " }, \
 	{ CBMEM_ID_MPTABLE,		"SMP TABLE  " }, \
 	{ CBMEM_ID_MRCDATA,		"MRC DATA   " }, \
 	{ CBMEM_ID_VAR_MRCDATA,		"VARMRC DATA" }, \
 	{ CBMEM_ID_MTC,			"MTC        " }, \
+	{ CBMEM_ID_MTRR,		"MTRR       " }, \
 	{ CBMEM_ID_PIRQ,		"IRQ TABLE  " }, \
 	{ CBMEM_ID_POWER_STATE,		"POWER STATE" }, \
+	{ CBMEM_ID_PROFILE,		"PROFILE    " }, \
 	{ CBMEM_ID_RAM_OOPS,		"RAMOOPS    " }, \
 	{ CBMEM_ID_RAMSTAGE_CACHE,	"RAMSTAGE $ " }, \
 	{ CBMEM_ID_RAMSTAGE,		"RAMSTAGE   " }, \
 	{ CBMEM_ID_REFCODE_CACHE,	"REFCODE $  " }, \
 	{ CBMEM_ID_REFCODE,		"REFCODE    " }, \
 	{ CBMEM_ID_RESUME,		"ACPI RESUME" }, \
+	{ CBMEM_ID_REGF_CACHE,		"REGION FILE" }, \
 	{ CBMEM_ID_RESUME_SCRATCH,	"ACPISCRATCH" }, \
+	{ CBMEM_ID_RESUME_SCRIPT,	"RESUMESCRPT" }, \
 	{ CBMEM_ID_ROMSTAGE_INFO,	"ROMSTAGE   " }, \
 	{ CBMEM_ID_ROMSTAGE_RAM_STACK,	"ROMSTG STCK" }, \
 	{ CBMEM_ID_ROOT,		"CBMEM ROOT " }, \
+	{ CBMEM_ID_SDHCI_HANDOFF,	"SDHCI HNDOF" }, \
 	{ CBMEM_ID_SMBIOS,		"SMBIOS     " }, \
 	{ CBMEM_ID_SMM_SAVE_SPACE,	"SMM BACKUP " }, \
+	{ CBMEM_ID_SPD,			"SPD DATA   " }, \
 	{ CBMEM_ID_STORAGE_DATA,	"SD/MMC/eMMC" }, \
 	{ CBMEM_ID_TCPA_LOG,		"TCPA LOG   " }, \
 	{ CBMEM_ID_TCPA_TCG_LOG,	"TCPA TCGLOG" }, \
@@ -127,8 +155,10 @@
 	{ CBMEM_ID_VBOOT_SEL_REG,	"VBOOT SEL  " }, \
 	{ CBMEM_ID_VBOOT_WORKBUF,	"VBOOT WORK " }, \
 	{ CBMEM_ID_VPD,			"VPD        " }, \
+	{ CBMEM_ID_VPD_INDEX,		"VPD INDEX  " }, \
 	{ CBMEM_ID_WIFI_CALIBRATION,	"WIFI CLBR  " }, \
 	{ CBMEM_ID_EC_HOSTEVENT,	"EC HOSTEVENT"}, \
+	{ CBMEM_ID_EC_INFO,		"EC INFO    " }, \
 	{ CBMEM_ID_EXT_VBT,		"EXT VBT"}, \
 	{ CBMEM_ID_ROM0,		"VGA ROM #0 "}, \
 	{ CBMEM_ID_ROM1,		"VGA ROM #1 "}, \
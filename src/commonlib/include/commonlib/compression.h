@@ -28,7 +28,24 @@
  */
 size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn);
 
+/* Called by ulz4fn_fetch() before it consumes size bytes of input at offset
+ * from the start of src. Returns 0 once the data is in place, < 0 on error. */
+typedef int (*ulz4fn_fetch_t)(void *arg, size_t offset, size_t size);
+
+/* Same as ulz4fn() but lets the caller fill in the input one LZ4 block at a
+ * time right before it is decompressed, instead of all of it up front. */
+size_t ulz4fn_fetch(const void *src, size_t srcn, void *dst, size_t dstn,
+		    ulz4fn_fetch_t fetch, void *arg);
+
 /* Same as ulz4fn() but does not perform any bounds checks. */
 size_t ulz4f(const void *src, void *dst);
 
+/* Compresses srcn bytes at src into an LZ4F image for ulz4fn() at dst, not
+ * writing more than dstn bytes. With dst NULL only the size is determined.
+ * The contents of dst are undefined when it is too small.
+ * Incompressible data costs 4 bytes per 4MiB block and 11 bytes of framing.
+ * Returns the size of the image, or 0 when it doesn't fit.
+ */
+size_t lz4f_compress(const void *src, size_t srcn, void *dst, size_t dstn);
+
 #endif	/* _COMMONLIB_COMPRESSION_H_ */
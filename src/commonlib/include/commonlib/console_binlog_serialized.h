@@ -0,0 +1,51 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __CONSOLE_BINLOG_SERIALIZED_H__
+#define __CONSOLE_BINLOG_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/*
+ * The binary console log keeps printk() messages unformatted: the offset of
+ * the format string within the stage and the raw arguments. Formatting it
+ * again needs the stage ELF. Arguments follow the entry header in the
+ * order the format string consumes them:
+ *
+ * - '*' widths and precisions and every integer, character and pointer
+ *   conversion take 8 bytes, little endian, sign extended for signed
+ *   conversions
+ * - %s takes the string itself including its NUL terminator, cut to the
+ *   precision if one was given
+ * - %n and %% take nothing
+ */
+struct console_binlog_entry {
+	uint16_t size;		/* entry header plus arguments */
+	uint8_t level;		/* BIOS_* log level */
+	uint8_t reserved;
+	uint32_t fmt;		/* format string offset from _program */
+	uint8_t args[0];
+} __packed;
+
+struct console_binlog {
+	uint32_t size;		/* room for entries */
+	uint32_t cursor;	/* bytes of entries written */
+	uint64_t program;	/* where _program was at runtime */
+	uint32_t dropped;	/* messages that did not fit */
+	uint8_t ptr_size;	/* sizeof(void *) in the stage */
+	uint8_t reserved[3];
+	uint8_t data[0];
+} __packed;
+
+#endif
@@ -392,6 +392,34 @@ struct lb_macs {
 	struct mac_address mac_addrs[0];
 };
 
+#define LB_TAG_MMC_INFO		0x0035
+struct lb_mmc_info {
+	uint32_t tag;
+	uint32_t size;
+	/*
+	 * 1 if CMD1 was sent to the eMMC device before the payload and it may
+	 * still be powering up, so the payload must not reset it with CMD0.
+	 */
+	int32_t early_cmd1_status;
+};
+
+/*
+ * Tag and offset (from the start of the lb_header) of every other record in
+ * the table, in table order. If present, this is the first record, so that a
+ * payload can find the records it needs without walking the whole table.
+ */
+#define LB_TAG_DIRECTORY	0x0036
+struct lb_directory_entry {
+	uint32_t tag;
+	uint32_t offset;
+};
+
+struct lb_directory {
+	uint32_t tag;
+	uint32_t size;
+	struct lb_directory_entry entries[0];
+};
+
 #define LB_TAG_SERIALNO		0x002a
 #define MAX_SERIALNO_LENGTH	32
 
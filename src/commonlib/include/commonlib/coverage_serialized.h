@@ -0,0 +1,57 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __COVERAGE_SERIALIZED_H__
+#define __COVERAGE_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/*
+ * Compact coverage data: just the arc counters gcc's -fprofile-arcs keeps,
+ * cut to 32 bits, plus what is needed to write the .gcda files again.
+ * The CBMEM area starts with struct coverage_compact, followed by one
+ * struct coverage_object per object file. Each is followed by its .gcda
+ * file name, NUL terminated and padded to 4 bytes, and then its functions.
+ * A function is a struct coverage_function followed by num_counters
+ * 32 bit counters, unless a flag says otherwise.
+ */
+#define COVERAGE_COMPACT_MAGIC	0x56434f43	/* "COCV" */
+
+struct coverage_compact {
+	uint32_t magic;
+	uint32_t size;		/* everything, this header included */
+	uint32_t version;	/* gcov version of the counters */
+	uint32_t num_objects;
+} __packed;
+
+struct coverage_object {
+	uint32_t stamp;		/* gcov time stamp of the object */
+	uint32_t name_size;	/* file name with NUL and padding */
+	uint32_t num_functions;
+} __packed;
+
+/* The function belongs to another object (a COMDAT copy), no data. */
+#define COVERAGE_FN_NO_DATA	(1 << 0)
+/* The function never ran, the all zero counters are left out. */
+#define COVERAGE_FN_NOT_RUN	(1 << 1)
+
+struct coverage_function {
+	uint32_t ident;
+	uint32_t lineno_checksum;
+	uint32_t cfg_checksum;
+	uint32_t num_counters;
+	uint32_t flags;
+} __packed;
+
+#endif
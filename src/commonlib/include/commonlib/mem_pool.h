@@ -66,4 +66,24 @@ void *mem_pool_alloc(struct mem_pool *mp, size_t sz);
 /* Free allocation from memory pool. */
 void mem_pool_free(struct mem_pool *mp, void *alloc);
 
+/*
+ * Everything allocated after mem_pool_mark() is freed at once by passing
+ * its return value to mem_pool_release(). Marks nest, releasing one also
+ * releases the marks taken after it.
+ */
+static inline size_t mem_pool_mark(const struct mem_pool *mp)
+{
+	return mp->free_offset;
+}
+
+static inline void mem_pool_release(struct mem_pool *mp, size_t mark)
+{
+	if (mark > mp->free_offset)
+		return;
+
+	mp->free_offset = mark;
+	/* The last allocation may be gone. */
+	mp->last_alloc = NULL;
+}
+
 #endif /* _MEM_POOL_H_ */
@@ -0,0 +1,49 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __MEM_USAGE_SERIALIZED_H__
+#define __MEM_USAGE_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/* Stage an entry was recorded in. */
+enum mem_usage_stage {
+	MEM_USAGE_ROMSTAGE = 0,
+	MEM_USAGE_RAMSTAGE = 1,
+};
+
+/* What an entry measured. */
+enum mem_usage_kind {
+	MEM_USAGE_STACK = 0,		/* painted stack of one CPU */
+	MEM_USAGE_HEAP = 1,		/* most the heap ever had in use */
+	MEM_USAGE_CAR_STACK = 2,	/* cache-as-ram stack */
+	MEM_USAGE_CAR_DATA = 3,		/* cache-as-ram globals */
+	MEM_USAGE_CBMEM = 4,		/* CBMEM, size 0 as it has no limit */
+};
+
+struct mem_usage_entry {
+	uint8_t stage;		/* enum mem_usage_stage */
+	uint8_t kind;		/* enum mem_usage_kind */
+	uint16_t cpu;		/* CPU index for stacks, 0 otherwise */
+	uint32_t used;		/* high-water mark in bytes */
+	uint32_t size;		/* size of the region in bytes */
+} __packed;
+
+struct mem_usage_table {
+	uint32_t max_entries;
+	uint32_t num_entries;
+	struct mem_usage_entry entries[0]; /* Variable number of entries */
+} __packed;
+
+#endif
@@ -0,0 +1,36 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __PROFILE_SERIALIZED_H__
+#define __PROFILE_SERIALIZED_H__
+
+#include <compiler.h>
+#include <stdint.h>
+
+/*
+ * Histogram of the instruction pointers the sampling profiler found. Bucket
+ * n counts the samples in [text_start + (n << shift),
+ * text_start + ((n + 1) << shift)).
+ */
+struct profile_histogram {
+	uint64_t text_start;	/* address the first bucket starts at */
+	uint32_t shift;		/* log2 of the bucket size in bytes */
+	uint32_t num_buckets;
+	uint32_t hz;		/* samples per second */
+	uint32_t samples;	/* all samples taken */
+	uint32_t outside;	/* samples not in any of the buckets */
+	uint32_t reserved;
+	uint32_t buckets[0];
+} __packed;
+
+#endif
@@ -271,4 +271,67 @@ const struct region_device *incoherent_rdev_init(struct incoherent_rdev *irdev,
 				const struct region_device *read,
 				const struct region_device *write);
 
+/*
+ * A region device stream walks a window of a region device sequentially in
+ * chunks of at most chunk_size bytes. Each chunk is mapped through
+ * rdev_mmap() and unmapped again once the next one is requested, so that
+ * consumers such as decompressors can pull their input as they go instead of
+ * mapping all of it at once.
+ */
+struct rdev_stream {
+	const struct region_device *rdev;
+	size_t offset;
+	size_t end;
+	size_t chunk_size;
+	void *mapping;
+};
+
+void rdev_stream_init(struct rdev_stream *stream,
+			const struct region_device *rdev, size_t offset,
+			size_t size, size_t chunk_size);
+
+/* Unmap the current chunk and map the next one, returning it in *chunk.
+ * Returns the chunk size, 0 at the end of the stream or < 0 on error. */
+ssize_t rdev_stream_next(struct rdev_stream *stream, const void **chunk);
+
+/* Release the current chunk. Must be called once the stream isn't needed
+ * anymore. */
+void rdev_stream_finish(struct rdev_stream *stream);
+
+/*
+ * A read-ahead region device sits in front of a slow access device and keeps a
+ * small number of aligned blocks of it. Small reads that miss the cache fetch
+ * whole blocks. When misses are sequential, several blocks are fetched in one
+ * go so that the access device sees large bursts instead of many short
+ * transfers. Reads at least as large as the whole cache bypass it. Writes and
+ * erases are passed through and drop all cached blocks. mmap() operations are
+ * provided through the embedded mmap helper, which needs to be initialized
+ * separately with mmap_helper_device_init().
+ */
+#define READAHEAD_MAX_BLOCKS 16
+
+struct readahead_region_device {
+	const struct region_device *access_dev;
+	uint8_t *cache;
+	size_t block_size;
+	size_t num_blocks;
+	/* Block number + 1 held by each cache slot, 0 for an empty slot. */
+	size_t tags[READAHEAD_MAX_BLOCKS];
+	/* Slot to fill on the next cache miss. */
+	size_t next_slot;
+	/* Block following the last fill, used to detect sequential access. */
+	size_t next_block;
+	struct mmap_helper_region_device mdev;
+};
+
+/* Initialize a read-ahead region device covering the whole access device.
+ * The block_size needs to be a power of 2 and the cache needs to hold at
+ * least one block. Returns NULL on error, otherwise the region_device to be
+ * used for region operations. */
+const struct region_device *readahead_rdev_init(
+				struct readahead_region_device *radev,
+				const struct region_device *access_dev,
+				void *cache, size_t cache_size,
+				size_t block_size);
+
 #endif /* _REGION_H_ */
@@ -21,6 +21,21 @@
 
 #define RMODULE_MAGIC 0xf8fe
 #define RMODULE_VERSION_1 1
+#define RMODULE_VERSION_2 2
+
+/*
+ * Version 1 relocations are an array of the link addresses to adjust, 32 or
+ * 64 bit wide like the pointers of the module. Version 2 packs them into a
+ * stream of records, each of which covers one relocation plus a run of
+ * relocations at the pointers right after it:
+ *   varint (delta << 1 | has_run)
+ *   varint run_length, only if has_run is set
+ * delta is the distance from the previous relocation, or from
+ * module_link_start_address for the first one. A varint is stored 7 bits per
+ * byte, least significant first, with bit 7 set on all but the last byte.
+ */
+#define RMODULE_VARINT_BITS	7
+#define RMODULE_VARINT_MORE	0x80
 
 /* All fields with '_offset' in the name are byte offsets into the flat blob.
  * The linker and the linker script takes are of assigning the values.  */
@@ -52,6 +52,7 @@ struct mmc_command {
 #define MMC_CMD_SWITCH			6
 #define MMC_CMD_SEND_EXT_CSD		8
 #define MMC_CMD_AUTO_TUNING_SEQUENCE	21
+#define MMC_CMD_SET_BLOCK_COUNT		23
 #define MMC_CMD_ERASE_GROUP_START	35
 #define MMC_CMD_ERASE_GROUP_END		36
 #define MMC_CMD_ERASE			38
@@ -118,11 +119,18 @@ struct mmc_data {
 
 #define DATA_FLAG_READ		1
 #define DATA_FLAG_WRITE		2
+#define DATA_FLAG_BLOCK_COUNT_SET	4	/* CMD23 preceded the transfer */
 
 	uint32_t blocks;
 	uint32_t blocksize;
 };
 
+/* Result of the bus tuning, in a controller specific format */
+struct sd_mmc_tuning {
+	uint32_t id;		/* Identifies the controller model */
+	uint32_t value[2];	/* Sampling tap and delay settings */
+};
+
 struct sd_mmc_ctrlr {
 	int (*send_cmd)(struct sd_mmc_ctrlr *ctrlr,
 		struct mmc_command *cmd, struct mmc_data *data);
@@ -130,6 +138,15 @@ struct sd_mmc_ctrlr {
 	void (*tuning_start)(struct sd_mmc_ctrlr *ctrlr, int retune);
 	int (*is_tuning_complete)(struct sd_mmc_ctrlr *ctrlr, int *successful);
 
+	/*
+	 * Optional, read back and apply the bus tuning result so it can be
+	 * cached across boots. Return 0 on success.
+	 */
+	int (*get_tuning)(struct sd_mmc_ctrlr *ctrlr,
+		struct sd_mmc_tuning *tuning);
+	int (*set_tuning)(struct sd_mmc_ctrlr *ctrlr,
+		const struct sd_mmc_tuning *tuning);
+
 	int initialized;
 	unsigned int version;
 	uint32_t voltages;
@@ -20,6 +20,7 @@
 #define __COMMONLIB_SDHCI_H__
 
 #include <commonlib/sd_mmc_ctrlr.h>
+#include <commonlib/storage.h>
 
 /* Driver specific capabilities */
 #define DRVR_CAP_1V8_VDD			0x00010000
@@ -67,6 +68,22 @@ int sdhci_controller_init(struct sdhci_ctrlr *sdhci_ctrlr, void *ioaddr);
 void sdhci_update_pointers(struct sdhci_ctrlr *sdhci_ctrlr);
 void sdhci_display_setup(struct sdhci_ctrlr *sdhci_ctrlr);
 
+/*
+ * Controller and media state passed on in CBMEM, so that later stages can
+ * continue with a device set up by an earlier one without resetting it. The
+ * controller keeps its clock, bus width and tuning settings in between.
+ */
+struct sdhci_handoff {
+	int32_t early_cmd1_status;	/* 1 if CMD1 was sent early, else 0 */
+	struct storage_media media;
+	struct sdhci_ctrlr sdhci_ctrlr;
+};
+
+int sdhci_handoff_save(const struct storage_media *media,
+	const struct sdhci_ctrlr *sdhci_ctrlr);
+int sdhci_handoff_restore(struct storage_media *media,
+	struct sdhci_ctrlr *sdhci_ctrlr, void *ioaddr);
+
 /* Add SDHCI controller from PCI */
 struct sd_mmc_ctrlr *new_pci_sdhci_controller(uint32_t dev);
 
@@ -126,6 +126,7 @@ struct storage_media {
 	uint16_t rca;
 
 	uint8_t partition_config;	/* Duplicate of EXT_CSD_PART_CONF */
+	uint8_t early_cmd1;		/* CMD1 sent by storage_start_setup() */
 };
 
 uint64_t storage_block_erase(struct storage_media *media, uint64_t start,
@@ -142,6 +143,9 @@ const char *storage_partition_name(struct storage_media *media,
 	unsigned int partition_number);
 int storage_setup_media(struct storage_media *media,
 	struct sd_mmc_ctrlr *ctrlr);
+int storage_start_setup(struct storage_media *media,
+	struct sd_mmc_ctrlr *ctrlr);
+int storage_complete_setup(struct storage_media *media);
 
 int storage_set_partition(struct storage_media *media,
 	unsigned int partition_number);
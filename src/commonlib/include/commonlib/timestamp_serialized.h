@@ -24,6 +24,19 @@ struct timestamp_entry {
 	uint64_t	entry_stamp;
 } __packed;
 
+/*
+ * Besides the IDs below an entry can mark the begin or the end of a span.
+ * Spans nest like calls, so each end closes the innermost open span of the
+ * same ID. Drivers may use IDs of their own from the custom range instead
+ * of adding to the list.
+ */
+#define TIMESTAMP_SPAN_BEGIN	(1U << 31)
+#define TIMESTAMP_SPAN_END	(1U << 30)
+#define TIMESTAMP_SPAN_MASK	(TIMESTAMP_SPAN_BEGIN | TIMESTAMP_SPAN_END)
+#define TIMESTAMP_CUSTOM	(1U << 29)
+#define TIMESTAMP_CUSTOM_ID(n)	\
+	(TIMESTAMP_CUSTOM | ((n) & (TIMESTAMP_CUSTOM - 1)))
+
 struct timestamp_table {
 	uint64_t	base_time;
 	uint16_t	max_entries;
@@ -50,7 +63,17 @@ enum timestamp_id {
 	TS_END_ULZMA = 16,
 	TS_START_ULZ4F = 17,
 	TS_END_ULZ4F = 18,
+	TS_MP_START_APS = 20,
+	TS_MP_APS_CHECKED_IN = 21,
+	TS_MP_SMM_HANDLERS_INSTALLED = 22,
+	TS_MP_SMM_RELOCATED = 23,
+	TS_START_MEM_CLEAR = 25,
+	TS_END_MEM_CLEAR = 26,
+	TS_START_RMODULE_RELOC = 27,
+	TS_END_RMODULE_RELOC = 28,
 	TS_DEVICE_ENUMERATE = 30,
+	TS_START_MEM_TEST = 31,
+	TS_END_MEM_TEST = 32,
 	TS_DEVICE_CONFIGURE = 40,
 	TS_DEVICE_ENABLE = 50,
 	TS_DEVICE_INITIALIZE = 60,
@@ -84,6 +107,16 @@ enum timestamp_id {
 	TS_END_COPYVPD_RO = 551,
 	TS_END_COPYVPD_RW = 552,
 
+	/* 600+ native raminit, each marks the end of a training step */
+	TS_RAMINIT_JEDEC_DONE = 600,
+	TS_RAMINIT_READ_TRAINING_DONE = 601,
+	TS_RAMINIT_WRITE_TRAINING_DONE = 602,
+	TS_RAMINIT_READ_EDGES_DONE = 603,
+	TS_RAMINIT_CMD_TRAINING_DONE = 604,
+	TS_RAMINIT_WRITE_EDGES_DONE = 605,
+	TS_RAMINIT_WRITE_TIMC_DONE = 606,
+	TS_RAMINIT_CHANNEL_TEST_DONE = 607,
+
 	/* 900-920 reserved for vendorcode extensions (900-940: AMD AGESA) */
 	TS_AGESA_INIT_RESET_START = 900,
 	TS_AGESA_INIT_RESET_DONE = 901,
@@ -123,6 +156,10 @@ enum timestamp_id {
 	TS_FSP_AFTER_FINALIZE = 959,
 	TS_FSP_BEFORE_END_OF_FIRMWARE = 960,
 	TS_FSP_AFTER_END_OF_FIRMWARE = 961,
+	TS_FSPM_LOAD_START = 962,
+	TS_FSPM_LOAD_END = 963,
+	TS_FSPS_LOAD_START = 964,
+	TS_FSPS_LOAD_END = 965,
 
 	/* 1000+ reserved for payloads (1000-1200: ChromeOS depthcharge) */
 
@@ -169,7 +206,17 @@ static const struct timestamp_id_to_name {
 	{ TS_END_ULZMA,		"finished LZMA decompress (ignore for x86)" },
 	{ TS_START_ULZ4F,	"starting LZ4 decompress (ignore for x86)" },
 	{ TS_END_ULZ4F,		"finished LZ4 decompress (ignore for x86)" },
+	{ TS_MP_START_APS,	"starting AP bring-up" },
+	{ TS_MP_APS_CHECKED_IN,	"all APs checked in" },
+	{ TS_MP_SMM_HANDLERS_INSTALLED, "SMM handlers installed" },
+	{ TS_MP_SMM_RELOCATED,	"SMM relocation done" },
+	{ TS_START_MEM_CLEAR,	"starting to clear memory" },
+	{ TS_END_MEM_CLEAR,	"finished clearing memory" },
+	{ TS_START_RMODULE_RELOC, "starting rmodule relocation" },
+	{ TS_END_RMODULE_RELOC,	"finished rmodule relocation" },
 	{ TS_DEVICE_ENUMERATE,	"device enumeration" },
+	{ TS_START_MEM_TEST,	"starting to test memory" },
+	{ TS_END_MEM_TEST,	"finished testing memory" },
 	{ TS_DEVICE_CONFIGURE,	"device configuration" },
 	{ TS_DEVICE_ENABLE,	"device enable" },
 	{ TS_DEVICE_INITIALIZE,	"device initialization" },
@@ -217,6 +264,15 @@ static const struct timestamp_id_to_name {
 	{ TS_KERNEL_DECOMPRESSION, "starting kernel decompression/relocation" },
 	{ TS_START_KERNEL,	"jumping to kernel" },
 
+	{ TS_RAMINIT_JEDEC_DONE,	"raminit: DRAM reset and MRS done" },
+	{ TS_RAMINIT_READ_TRAINING_DONE,	"raminit: read training done" },
+	{ TS_RAMINIT_WRITE_TRAINING_DONE,	"raminit: write training done" },
+	{ TS_RAMINIT_READ_EDGES_DONE,	"raminit: read edges done" },
+	{ TS_RAMINIT_CMD_TRAINING_DONE,	"raminit: command training done" },
+	{ TS_RAMINIT_WRITE_EDGES_DONE,	"raminit: write edges done" },
+	{ TS_RAMINIT_WRITE_TIMC_DONE,	"raminit: write timC done" },
+	{ TS_RAMINIT_CHANNEL_TEST_DONE,	"raminit: channel test done" },
+
 	/* AMD AGESA related timestamps */
 	{ TS_AGESA_INIT_RESET_START,	"calling AmdInitReset" },
 	{ TS_AGESA_INIT_RESET_DONE,	"back from AmdInitReset" },
@@ -258,6 +314,10 @@ static const struct timestamp_id_to_name {
 	{ TS_FSP_BEFORE_END_OF_FIRMWARE, "calling FspNotify(EndOfFirmware)" },
 	{ TS_FSP_AFTER_END_OF_FIRMWARE,
 		"returning from FspNotify(EndOfFirmware)" },
+	{ TS_FSPM_LOAD_START, "loading FSP-M" },
+	{ TS_FSPM_LOAD_END, "finished loading FSP-M" },
+	{ TS_FSPS_LOAD_START, "loading FSP-S" },
+	{ TS_FSPS_LOAD_END, "finished loading FSP-S" },
 };
 
 #endif
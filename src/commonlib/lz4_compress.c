@@ -0,0 +1,199 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <commonlib/compression.h>
+#include <commonlib/endian.h>
+#include <commonlib/helpers.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * A greedy compressor for the LZ4 block format, with a single hash table
+ * small enough for the stack of early stages. It doesn't compress nearly as
+ * well as the real thing, but it takes neither memory nor dependencies and
+ * the output decompresses at the same speed.
+ */
+
+#define LZ4F_MAGICNUMBER	0x184D2204
+#define LZ4F_FLG		0x60	/* version 1, independent blocks */
+#define LZ4F_BD			0x70	/* 4MiB maximum block size */
+#define LZ4F_BLOCK_SIZE		(4 * MiB)
+#define LZ4F_NOT_COMPRESSED	(1U << 31)
+
+#define MINMATCH		4
+#define LASTLITERALS		5	/* the last bytes are always literals */
+#define MFLIMIT			12	/* no match starts later than this */
+#define MAX_DISTANCE		0xffff
+#define RUN_MASK		0xf
+
+#define HASH_BITS		9
+
+/* Output that only counts while there is no buffer. */
+struct lz4_out {
+	uint8_t *buf;
+	size_t pos;
+	size_t size;
+};
+
+static int put(struct lz4_out *out, const void *data, size_t len)
+{
+	if (len > out->size - out->pos)
+		return -1;
+	if (out->buf)
+		memcpy(&out->buf[out->pos], data, len);
+	out->pos += len;
+	return 0;
+}
+
+static int put_byte(struct lz4_out *out, uint8_t b)
+{
+	return put(out, &b, sizeof(b));
+}
+
+static int put_le32(struct lz4_out *out, uint32_t val)
+{
+	uint8_t le[sizeof(val)];
+
+	write_le32(le, val);
+	return put(out, le, sizeof(le));
+}
+
+/* Lengths of 15 and more continue in bytes of 255 and a final smaller one. */
+static int put_length(struct lz4_out *out, size_t len)
+{
+	for (len -= RUN_MASK; len >= 0xff; len -= 0xff) {
+		if (put_byte(out, 0xff))
+			return -1;
+	}
+	return put_byte(out, len);
+}
+
+static int put_sequence(struct lz4_out *out, const uint8_t *lit,
+			size_t lit_len, size_t distance, size_t match_len)
+{
+	uint8_t token = MIN(lit_len, RUN_MASK) << 4;
+
+	if (distance)
+		token |= MIN(match_len - MINMATCH, RUN_MASK);
+
+	if (put_byte(out, token))
+		return -1;
+	if (lit_len >= RUN_MASK && put_length(out, lit_len))
+		return -1;
+	if (put(out, lit, lit_len))
+		return -1;
+
+	/* The last sequence is just literals. */
+	if (!distance)
+		return 0;
+
+	if (put_byte(out, distance & 0xff) || put_byte(out, distance >> 8))
+		return -1;
+	if (match_len - MINMATCH >= RUN_MASK &&
+	    put_length(out, match_len - MINMATCH))
+		return -1;
+
+	return 0;
+}
+
+static uint32_t hash(uint32_t seq)
+{
+	return (seq * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static int compress_block(struct lz4_out *out, const uint8_t *src,
+			  size_t srcn)
+{
+	uint32_t table[1 << HASH_BITS];
+	const uint8_t *ip = src;
+	const uint8_t *anchor = src;
+	const uint8_t *end = src + srcn;
+
+	memset(table, 0, sizeof(table));
+
+	while (srcn > MFLIMIT && ip < end - MFLIMIT) {
+		uint32_t seq = read_le32(ip);
+		uint32_t h = hash(seq);
+		const uint8_t *ref = src + table[h];
+		const uint8_t *match_end;
+
+		table[h] = ip - src;
+
+		if (ref >= ip || ip - ref > MAX_DISTANCE ||
+		    read_le32(ref) != seq) {
+			ip++;
+			continue;
+		}
+
+		while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+			ip--;
+			ref--;
+		}
+
+		match_end = ip + MINMATCH;
+		while (match_end < end - LASTLITERALS &&
+		       *match_end == ref[match_end - ip])
+			match_end++;
+
+		if (put_sequence(out, anchor, ip - anchor, ip - ref,
+				 match_end - ip))
+			return -1;
+
+		ip = match_end;
+		anchor = ip;
+	}
+
+	return put_sequence(out, anchor, end - anchor, 0, 0);
+}
+
+size_t lz4f_compress(const void *src, size_t srcn, void *dst, size_t dstn)
+{
+	struct lz4_out out = { .buf = dst, .size = dst ? dstn : ~(size_t)0 };
+	size_t offset;
+
+	/* No content size, no checksums. ulz4fn() skips the header checksum,
+	 * which is why it is left zero. */
+	if (put_le32(&out, LZ4F_MAGICNUMBER) || put_byte(&out, LZ4F_FLG) ||
+	    put_byte(&out, LZ4F_BD) || put_byte(&out, 0))
+		return 0;
+
+	for (offset = 0; offset < srcn; offset += LZ4F_BLOCK_SIZE) {
+		size_t len = MIN(srcn - offset, LZ4F_BLOCK_SIZE);
+		size_t start = out.pos;
+		size_t size;
+
+		/* The block size goes in front once it is known. */
+		if (put_le32(&out, 0))
+			return 0;
+
+		if (compress_block(&out, (const uint8_t *)src + offset, len) ||
+		    out.pos - start - sizeof(uint32_t) >= len) {
+			/* Stored as is when it doesn't get any smaller. */
+			out.pos = start;
+			if (put_le32(&out, len | LZ4F_NOT_COMPRESSED) ||
+			    put(&out, (const uint8_t *)src + offset, len))
+				return 0;
+			continue;
+		}
+
+		size = out.pos - start - sizeof(uint32_t);
+		if (out.buf)
+			write_le32(&out.buf[start], size);
+	}
+
+	/* The end mark is an empty block. */
+	if (put_le32(&out, 0))
+		return 0;
+
+	return out.pos;
+}
@@ -78,6 +78,36 @@ static void LZ4_copy8(void *dst, const void *src)
 #endif
 }
 
+/* Ramstage may copy 16 bytes at a time in LZ4_wildCopy(). Earlier stages
+ * don't, since SSE isn't guaranteed to be usable there on x86. Loads always
+ * happen before stores so that in-place decompression (source ahead of the
+ * destination by less than 16 bytes) stays correct. */
+#if defined(IS_ENABLED) && defined(__RAMSTAGE__)
+#if IS_ENABLED(CONFIG_LZ4_WIDE_COPY)
+#define LZ4_WIDECOPYLENGTH 16
+static void LZ4_copy16(void *dst, const void *src)
+{
+#if defined(__x86_64__)
+	__asm__ ("movdqu %[src], %%xmm0\n\t"
+		 "movdqu %%xmm0, %[dst]"
+		 : [dst]"=m"(*(uint8_t (*)[16])dst)
+		 : [src]"m"(*(const uint8_t (*)[16])src)
+		 : "xmm0");
+#elif defined(__aarch64__)
+	uint64_t x0, x1;
+	__asm__ ("ldp %[x0], %[x1], [%[src]]"
+		: [x0]"=r"(x0), [x1]"=r"(x1)
+		: [src]"r"(src), "m"(*(const uint8_t (*)[16])src));
+	__asm__ ("stp %[x0], %[x1], [%[dst]]"
+		: "=m"(*(uint8_t (*)[16])dst)
+		: [x0]"r"(x0), [x1]"r"(x1), [dst]"r"(dst));
+#else
+#error LZ4_WIDE_COPY is not supported on this architecture
+#endif
+}
+#endif
+#endif
+
 typedef  uint8_t BYTE;
 typedef uint16_t U16;
 typedef uint32_t U32;
@@ -130,7 +160,23 @@ struct lz4_block_header {
 	/* + uint32_t block_checksum iff has_block_checksum is set */
 } __packed;
 
-size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn)
+/* Ask the caller to provide size bytes of input at in, if requested. */
+static inline int lz4_fetch(ulz4fn_fetch_t fetch, void *arg, const void *src,
+			    const void *in, size_t size, size_t srcn)
+{
+	size_t offset = in - src;
+
+	if (offset + size > srcn)
+		return -1;	/* input overrun */
+
+	if (fetch == NULL)
+		return 0;
+
+	return fetch(arg, offset, size);
+}
+
+size_t ulz4fn_fetch(const void *src, size_t srcn, void *dst, size_t dstn,
+		    ulz4fn_fetch_t fetch, void *arg)
 {
 	const void *in = src;
 	void *out = dst;
@@ -140,7 +186,8 @@ size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn)
 	{ /* With in-place decompression the header may become invalid later. */
 		const struct lz4_frame_header *h = in;
 
-		if (srcn < sizeof(*h) + sizeof(uint64_t) + sizeof(uint8_t))
+		if (lz4_fetch(fetch, arg, src, in, sizeof(*h) +
+			      sizeof(uint64_t) + sizeof(uint8_t), srcn))
 			return 0;	/* input overrun */
 
 		/* We assume there's always only a single, standard frame. */
@@ -159,10 +206,16 @@ size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn)
 	}
 
 	while (1) {
+		if (lz4_fetch(fetch, arg, src, in,
+			      sizeof(struct lz4_block_header), srcn))
+			break;			/* input overrun */
+
 		struct lz4_block_header b = { { .raw = read_le32(in) } };
 		in += sizeof(struct lz4_block_header);
 
-		if ((size_t)(in - src) + b.size > srcn)
+		if (lz4_fetch(fetch, arg, src, in, b.size +
+			      (has_block_checksum && b.size ? sizeof(uint32_t)
+			       : 0), srcn))
 			break;			/* input overrun */
 
 		if (!b.size) {
@@ -195,6 +248,11 @@ size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn)
 	return out_size;
 }
 
+size_t ulz4fn(const void *src, size_t srcn, void *dst, size_t dstn)
+{
+	return ulz4fn_fetch(src, srcn, dst, dstn, NULL, NULL);
+}
+
 size_t ulz4f(const void *src, void *dst)
 {
 	/* LZ4 uses signed size parameters, so can't just use ((u32)-1) here. */
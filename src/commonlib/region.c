@@ -516,3 +516,205 @@ const struct region_device *incoherent_rdev_init(struct incoherent_rdev *irdev,
 
 	return &irdev->rdev;
 }
+
+void rdev_stream_init(struct rdev_stream *stream,
+			const struct region_device *rdev, size_t offset,
+			size_t size, size_t chunk_size)
+{
+	stream->rdev = rdev;
+	stream->offset = offset;
+	stream->end = offset + size;
+	stream->chunk_size = chunk_size;
+	stream->mapping = NULL;
+}
+
+ssize_t rdev_stream_next(struct rdev_stream *stream, const void **chunk)
+{
+	size_t size;
+
+	rdev_stream_finish(stream);
+
+	if (stream->offset >= stream->end)
+		return 0;
+
+	size = MIN(stream->chunk_size, stream->end - stream->offset);
+
+	stream->mapping = rdev_mmap(stream->rdev, stream->offset, size);
+
+	if (stream->mapping == NULL)
+		return -1;
+
+	stream->offset += size;
+	*chunk = stream->mapping;
+
+	return size;
+}
+
+void rdev_stream_finish(struct rdev_stream *stream)
+{
+	if (stream->mapping == NULL)
+		return;
+
+	rdev_munmap(stream->rdev, stream->mapping);
+	stream->mapping = NULL;
+}
+
+static void readahead_invalidate(struct readahead_region_device *radev)
+{
+	memset(radev->tags, 0, sizeof(radev->tags));
+	radev->next_slot = 0;
+	radev->next_block = 0;
+}
+
+static ssize_t readahead_lookup(const struct readahead_region_device *radev,
+				size_t block)
+{
+	size_t i;
+
+	for (i = 0; i < radev->num_blocks; i++) {
+		if (radev->tags[i] == block + 1)
+			return i;
+	}
+
+	return -1;
+}
+
+static ssize_t readahead_fill(struct readahead_region_device *radev,
+				size_t block)
+{
+	const size_t bs = radev->block_size;
+	const size_t dev_size = region_device_sz(radev->access_dev);
+	size_t count = 1;
+	size_t slot;
+	size_t size;
+	size_t i;
+
+	/* Sequential access: prefetch half of the cache in a single burst. */
+	if (block == radev->next_block)
+		count = MAX(radev->num_blocks / 2, 1);
+
+	/* Slots are filled in ring order so a burst is always contiguous. */
+	if (radev->next_slot + count > radev->num_blocks)
+		radev->next_slot = 0;
+
+	slot = radev->next_slot;
+	size = MIN(count * bs, dev_size - block * bs);
+	count = DIV_ROUND_UP(size, bs);
+
+	/* Drop the slots being refilled as well as other copies of the blocks
+	 * about to be fetched. */
+	for (i = 0; i < radev->num_blocks; i++) {
+		size_t tag = radev->tags[i];
+
+		if ((i >= slot && i < slot + count) ||
+		    (tag > block && tag <= block + count))
+			radev->tags[i] = 0;
+	}
+
+	if (rdev_readat(radev->access_dev, &radev->cache[slot * bs],
+			block * bs, size) != size)
+		return -1;
+
+	for (i = 0; i < count; i++)
+		radev->tags[slot + i] = block + i + 1;
+
+	radev->next_slot = slot + count;
+	radev->next_block = block + count;
+
+	return slot;
+}
+
+static ssize_t readahead_readat(const struct region_device *rd, void *b,
+				size_t offset, size_t size)
+{
+	struct readahead_region_device *radev;
+	uint8_t *dest = b;
+	size_t left = size;
+	size_t bs;
+
+	radev = container_of((void *)rd, __typeof__(*radev), mdev.rdev);
+	bs = radev->block_size;
+
+	/* Large reads are efficient on their own. Don't thrash the cache. */
+	if (size >= radev->num_blocks * bs)
+		return rdev_readat(radev->access_dev, b, offset, size);
+
+	while (left) {
+		const size_t block = offset / bs;
+		const size_t block_offset = offset % bs;
+		const size_t copy = MIN(bs - block_offset, left);
+		ssize_t slot;
+
+		slot = readahead_lookup(radev, block);
+
+		if (slot < 0)
+			slot = readahead_fill(radev, block);
+
+		if (slot < 0)
+			return -1;
+
+		memcpy(dest, &radev->cache[slot * bs + block_offset], copy);
+
+		dest += copy;
+		offset += copy;
+		left -= copy;
+	}
+
+	return size;
+}
+
+static ssize_t readahead_writeat(const struct region_device *rd, const void *b,
+				size_t offset, size_t size)
+{
+	struct readahead_region_device *radev;
+
+	radev = container_of((void *)rd, __typeof__(*radev), mdev.rdev);
+
+	readahead_invalidate(radev);
+
+	return rdev_writeat(radev->access_dev, b, offset, size);
+}
+
+static ssize_t readahead_eraseat(const struct region_device *rd,
+				size_t offset, size_t size)
+{
+	struct readahead_region_device *radev;
+
+	radev = container_of((void *)rd, __typeof__(*radev), mdev.rdev);
+
+	readahead_invalidate(radev);
+
+	return rdev_eraseat(radev->access_dev, offset, size);
+}
+
+static const struct region_device_ops readahead_rdev_ops = {
+	.mmap = mmap_helper_rdev_mmap,
+	.munmap = mmap_helper_rdev_munmap,
+	.readat = readahead_readat,
+	.writeat = readahead_writeat,
+	.eraseat = readahead_eraseat,
+};
+
+const struct region_device *readahead_rdev_init(
+				struct readahead_region_device *radev,
+				const struct region_device *access_dev,
+				void *cache, size_t cache_size,
+				size_t block_size)
+{
+	if (block_size == 0 || !IS_POWER_OF_2(block_size))
+		return NULL;
+
+	if (cache_size < block_size)
+		return NULL;
+
+	radev->access_dev = access_dev;
+	radev->cache = cache;
+	radev->block_size = block_size;
+	radev->num_blocks = MIN(cache_size / block_size, READAHEAD_MAX_BLOCKS);
+	readahead_invalidate(radev);
+
+	region_device_init(&radev->mdev.rdev, &readahead_rdev_ops, 0,
+			region_device_sz(access_dev));
+
+	return &radev->mdev.rdev;
+}
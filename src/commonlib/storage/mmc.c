@@ -28,6 +28,30 @@
 #include <string.h>
 #include <timer.h>
 
+#define TUNING_CACHE_AVAILABLE	(IS_ENABLED(CONFIG_MMC_TUNING_CACHE) \
+				&& (ENV_ROMSTAGE || ENV_POSTCAR \
+				|| ENV_RAMSTAGE))
+
+/* Tuning block the device returns for CMD21 on an 8-bit bus */
+static const uint8_t mmc_tuning_pattern_8bit[128] = {
+	0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00, 0x00,
+	0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc, 0xcc,
+	0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff, 0xff,
+	0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee, 0xff,
+	0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd, 0xdd,
+	0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff, 0xbb,
+	0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff, 0xff,
+	0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee, 0xff,
+	0xff, 0xff, 0xff, 0x00, 0xff, 0xff, 0xff, 0x00,
+	0x00, 0xff, 0xff, 0xcc, 0xcc, 0xcc, 0x33, 0xcc,
+	0xcc, 0xcc, 0x33, 0x33, 0xcc, 0xcc, 0xcc, 0xff,
+	0xff, 0xff, 0xee, 0xff, 0xff, 0xff, 0xee, 0xee,
+	0xff, 0xff, 0xff, 0xdd, 0xff, 0xff, 0xff, 0xdd,
+	0xdd, 0xff, 0xff, 0xff, 0xbb, 0xff, 0xff, 0xff,
+	0xbb, 0xbb, 0xff, 0xff, 0xff, 0x77, 0xff, 0xff,
+	0xff, 0x77, 0x77, 0xff, 0x77, 0xbb, 0xdd, 0xee,
+};
+
 /* We pass in the cmd since otherwise the init seems to fail */
 static int mmc_send_op_cond_iter(struct storage_media *media,
 	struct mmc_command *cmd, int use_arg)
@@ -222,14 +246,29 @@ static int mmc_bus_tuning(struct storage_media *media)
 	int index;
 	int successful;
 
+	/*
+	 * Try the result of an earlier boot first. One tuning block read
+	 * tells if it still samples the bus correctly.
+	 */
+	if (TUNING_CACHE_AVAILABLE && (ctrlr->bus_width == 8)
+		&& !mmc_tuning_cache_restore(media)) {
+		if (!mmc_send_tunning_seq(ctrlr, buffer)
+			&& !memcmp(buffer, mmc_tuning_pattern_8bit,
+				sizeof(mmc_tuning_pattern_8bit)))
+			return 0;
+		sd_mmc_debug("Cached bus tuning failed, tuning again\n");
+	}
+
 	/* Request the device send the tuning sequence up to 40 times */
 	ctrlr->tuning_start(ctrlr, 0);
 	for (index = 0; index < 40; index++) {
 		mmc_send_tunning_seq(ctrlr, buffer);
 		if (ctrlr->is_tuning_complete(ctrlr, &successful)) {
-			if (successful)
-				return 0;
-			break;
+			if (!successful)
+				break;
+			if (TUNING_CACHE_AVAILABLE)
+				mmc_tuning_cache_save(media);
+			return 0;
 		}
 	}
 	sd_mmc_error("Bus tuning failed!\n");
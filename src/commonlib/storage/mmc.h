@@ -51,4 +51,11 @@
 int storage_block_setup_media(struct storage_media *media,
 	struct sd_mmc_ctrlr *ctrlr);
 
+/*
+ * Bus tuning results cached in flash, keyed by the device CID. Restoring
+ * returns 0 if a matching result was applied to the controller.
+ */
+int mmc_tuning_cache_restore(struct storage_media *media);
+void mmc_tuning_cache_save(struct storage_media *media);
+
 #endif /* __COMMONLIB_STORAGE_MMC_H__ */
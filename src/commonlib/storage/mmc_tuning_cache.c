@@ -0,0 +1,139 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * MultiMediaCard (MMC) bus tuning result cache
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <commonlib/storage.h>
+#include <fmap.h>
+#include <ip_checksum.h>
+#include "mmc.h"
+#include <region_file.h>
+#include "sd_mmc.h"
+#include <string.h>
+
+#define MMC_TUNING_REGION	"RW_MMC_TUNING"
+#define MMC_TUNING_SIGNATURE	0x4e55544d	/* 'MTUN' */
+
+struct mmc_tuning_record {
+	uint32_t signature;
+	uint32_t cid[4];
+	uint32_t timing;
+	struct sd_mmc_tuning tuning;
+	uint32_t checksum;
+};
+
+static void mmc_tuning_record_fill(struct storage_media *media,
+	const struct sd_mmc_tuning *tuning, struct mmc_tuning_record *rec)
+{
+	memset(rec, 0, sizeof(*rec));
+	rec->signature = MMC_TUNING_SIGNATURE;
+	memcpy(rec->cid, media->cid, sizeof(rec->cid));
+	rec->timing = media->ctrlr->timing;
+	rec->tuning = *tuning;
+	rec->checksum = compute_ip_checksum(rec,
+		offsetof(struct mmc_tuning_record, checksum));
+}
+
+static int mmc_tuning_cache_open(struct region_file *file, int rw)
+{
+	struct region_device rdev;
+	int ret;
+
+	if (rw)
+		ret = fmap_locate_area_as_rdev_rw(MMC_TUNING_REGION, &rdev);
+	else
+		ret = fmap_locate_area_as_rdev(MMC_TUNING_REGION, &rdev);
+	if (ret < 0)
+		return -1;
+
+	return region_file_init(file, &rdev);
+}
+
+static int mmc_tuning_cache_read(const struct region_file *file,
+	struct mmc_tuning_record *rec)
+{
+	struct region_device rdev;
+
+	if (region_file_data(file, &rdev) < 0)
+		return -1;
+
+	if (region_device_sz(&rdev) != sizeof(*rec))
+		return -1;
+
+	if (rdev_readat(&rdev, rec, 0, sizeof(*rec)) != sizeof(*rec))
+		return -1;
+
+	return 0;
+}
+
+int mmc_tuning_cache_restore(struct storage_media *media)
+{
+	struct sd_mmc_ctrlr *ctrlr = media->ctrlr;
+	struct mmc_tuning_record rec;
+	struct mmc_tuning_record expected;
+	struct region_file file;
+	struct sd_mmc_tuning current;
+
+	if (!ctrlr->get_tuning || !ctrlr->set_tuning)
+		return -1;
+
+	if (mmc_tuning_cache_open(&file, 0) < 0)
+		return -1;
+
+	if (mmc_tuning_cache_read(&file, &rec) < 0)
+		return -1;
+
+	/* The current settings identify the controller. */
+	if (ctrlr->get_tuning(ctrlr, &current))
+		return -1;
+	current.value[0] = rec.tuning.value[0];
+	current.value[1] = rec.tuning.value[1];
+
+	/* A different device, controller or bus timing needs a retune. */
+	mmc_tuning_record_fill(media, &current, &expected);
+	if (memcmp(&rec, &expected, sizeof(rec)))
+		return -1;
+
+	sd_mmc_debug("Using cached bus tuning 0x%08x 0x%08x\n",
+		rec.tuning.value[0], rec.tuning.value[1]);
+	return ctrlr->set_tuning(ctrlr, &rec.tuning);
+}
+
+void mmc_tuning_cache_save(struct storage_media *media)
+{
+	struct sd_mmc_ctrlr *ctrlr = media->ctrlr;
+	struct mmc_tuning_record rec;
+	struct mmc_tuning_record old;
+	struct region_file file;
+	struct sd_mmc_tuning tuning;
+
+	if (!ctrlr->get_tuning || !ctrlr->set_tuning)
+		return;
+
+	if (ctrlr->get_tuning(ctrlr, &tuning))
+		return;
+
+	mmc_tuning_record_fill(media, &tuning, &rec);
+
+	if (mmc_tuning_cache_open(&file, 1) < 0)
+		return;
+
+	/* Keep flash writes to boots where the result changed. */
+	if (mmc_tuning_cache_read(&file, &old) == 0
+		&& !memcmp(&old, &rec, sizeof(rec)))
+		return;
+
+	if (region_file_update_data(&file, &rec, sizeof(rec)) < 0)
+		sd_mmc_error("Failed to update bus tuning cache\n");
+}
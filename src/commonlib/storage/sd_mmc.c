@@ -158,6 +158,17 @@ int sd_mmc_enter_standby(struct storage_media *media)
 	struct sd_mmc_ctrlr *ctrlr = media->ctrlr;
 	int err;
 
+	/* Finish the power up started by storage_start_setup() */
+	if (IS_ENABLED(CONFIG_COMMONLIB_STORAGE_MMC) && media->early_cmd1) {
+		media->early_cmd1 = 0;
+		err = mmc_complete_op_cond(media);
+		if (err) {
+			sd_mmc_error("Device did not complete power up!\n");
+			return CARD_UNUSABLE_ERR;
+		}
+		goto identify;
+	}
+
 	SET_BUS_WIDTH(ctrlr, 1);
 	SET_CLOCK(ctrlr, 1);
 
@@ -192,6 +203,7 @@ int sd_mmc_enter_standby(struct storage_media *media)
 		return CARD_UNUSABLE_ERR;
 	}
 
+identify:
 	/* Put the Card in Identify Mode */
 	cmd.cmdidx = MMC_CMD_ALL_SEND_CID;
 	cmd.resp_type = CARD_RSP_R2;
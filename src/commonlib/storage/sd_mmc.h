@@ -24,6 +24,9 @@
 
 #define IS_SD(x)		(x->version & SD_VERSION_SD)
 
+/* SCR bit 33, CMD23 SET_BLOCK_COUNT support */
+#define SD_SCR_CMD23_SUPPORT	(1 << 1)
+
 #define SET_BUS_WIDTH(ctrlr, width)		\
 	do {					\
 		ctrlr->bus_width = width;	\
@@ -121,7 +121,7 @@ static int sdhci_transfer_data(struct sdhci_ctrlr *sdhci_ctrlr,
 
 		/* Transfer a block of data */
 		buffer_end = &buffer[data->blocksize >> 2];
-		if (data->flags == DATA_FLAG_READ)
+		if (data->flags & DATA_FLAG_READ)
 			while (buffer_end > buffer)
 				*buffer++ = sdhci_readl(sdhci_ctrlr,
 					SDHCI_BUFFER);
@@ -195,12 +195,15 @@ static int sdhci_send_command_bounced(struct sd_mmc_ctrlr *ctrlr,
 			SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 			data->blocksize), SDHCI_BLOCK_SIZE);
 
-		if (data->flags == DATA_FLAG_READ)
+		if (data->flags & DATA_FLAG_READ)
 			mode |= SDHCI_TRNS_READ;
 
-		if (data->blocks > 1)
-			mode |= SDHCI_TRNS_BLK_CNT_EN |
-				SDHCI_TRNS_MULTI | SDHCI_TRNS_ACMD12;
+		/* The card stops on its own after a CMD23 bounded transfer. */
+		if (data->blocks > 1) {
+			mode |= SDHCI_TRNS_BLK_CNT_EN | SDHCI_TRNS_MULTI;
+			if (!(data->flags & DATA_FLAG_BLOCK_COUNT_SET))
+				mode |= SDHCI_TRNS_ACMD12;
+		}
 
 		sdhci_writew(sdhci_ctrlr, data->blocks, SDHCI_BLOCK_COUNT);
 
@@ -118,7 +118,8 @@ int sdhci_setup_adma(struct sdhci_ctrlr *sdhci_ctrlr, struct mmc_data *data)
 		if (dma64) {
 			sdhci_ctrlr->adma64_descs[i].addr =
 				(uintptr_t)buffer_data;
-			sdhci_ctrlr->adma64_descs[i].addr_hi = 0;
+			sdhci_ctrlr->adma64_descs[i].addr_hi =
+				(uint64_t)(uintptr_t)buffer_data >> 32;
 			sdhci_ctrlr->adma64_descs[i].length = desc_length;
 			sdhci_ctrlr->adma64_descs[i].attributes = attributes;
 
@@ -132,10 +133,13 @@ int sdhci_setup_adma(struct sdhci_ctrlr *sdhci_ctrlr, struct mmc_data *data)
 		buffer_data += desc_length;
 	}
 
-	if (dma64)
+	if (dma64) {
 		sdhci_writel(sdhci_ctrlr, (uintptr_t) sdhci_ctrlr->adma64_descs,
 			     SDHCI_ADMA_ADDRESS);
-	else
+		sdhci_writel(sdhci_ctrlr,
+			(uint64_t)(uintptr_t) sdhci_ctrlr->adma64_descs >> 32,
+			SDHCI_ADMA_ADDRESS_HI);
+	} else
 		sdhci_writel(sdhci_ctrlr, (uintptr_t) sdhci_ctrlr->adma_descs,
 			     SDHCI_ADMA_ADDRESS);
 
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Hand SD/MMC controller and media state from one stage to the next
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <cbmem.h>
+#include <commonlib/sdhci.h>
+#include <commonlib/storage.h>
+#include "sd_mmc.h"
+#include <string.h>
+
+int sdhci_handoff_save(const struct storage_media *media,
+	const struct sdhci_ctrlr *sdhci_ctrlr)
+{
+	struct sdhci_handoff *handoff;
+
+	handoff = cbmem_add(CBMEM_ID_SDHCI_HANDOFF, sizeof(*handoff));
+	if (handoff == NULL) {
+		sdhc_error("Failed to add SDHCI handoff to CBMEM\n");
+		return -1;
+	}
+
+	handoff->early_cmd1_status = media->early_cmd1;
+	memcpy(&handoff->media, media, sizeof(*media));
+	memcpy(&handoff->sdhci_ctrlr, sdhci_ctrlr, sizeof(*sdhci_ctrlr));
+
+	/* Pointers into this stage are meaningless to the next one. */
+	handoff->media.ctrlr = NULL;
+	handoff->sdhci_ctrlr.sd_mmc_ctrlr.get_tuning = NULL;
+	handoff->sdhci_ctrlr.sd_mmc_ctrlr.set_tuning = NULL;
+	handoff->sdhci_ctrlr.adma_descs = NULL;
+	handoff->sdhci_ctrlr.adma64_descs = NULL;
+	handoff->sdhci_ctrlr.adma_desc_count = 0;
+	return 0;
+}
+
+/*
+ * Restore the state saved by an earlier stage. The controller may have been
+ * moved by resource allocation, so the caller passes its current address.
+ */
+int sdhci_handoff_restore(struct storage_media *media,
+	struct sdhci_ctrlr *sdhci_ctrlr, void *ioaddr)
+{
+	const struct sdhci_handoff *handoff;
+
+	handoff = cbmem_find(CBMEM_ID_SDHCI_HANDOFF);
+	if (handoff == NULL)
+		return -1;
+
+	memcpy(media, &handoff->media, sizeof(*media));
+	memcpy(sdhci_ctrlr, &handoff->sdhci_ctrlr, sizeof(*sdhci_ctrlr));
+
+	sdhci_ctrlr->ioaddr = ioaddr;
+	sdhci_update_pointers(sdhci_ctrlr);
+	media->ctrlr = &sdhci_ctrlr->sd_mmc_ctrlr;
+	return 0;
+}
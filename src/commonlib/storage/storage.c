@@ -202,23 +202,85 @@ int storage_startup(struct storage_media *media)
 }
 
 int storage_setup_media(struct storage_media *media, struct sd_mmc_ctrlr *ctrlr)
+{
+	memset(media, 0, sizeof(*media));
+	media->ctrlr = ctrlr;
+
+	return storage_complete_setup(media);
+}
+
+/*
+ * eMMC devices may take hundreds of milliseconds to power up after the first
+ * CMD1. Send it and return right away, so that the device powers up while
+ * the platform does other work. storage_complete_setup() finishes the
+ * initialization later, possibly in another stage.
+ */
+int storage_start_setup(struct storage_media *media, struct sd_mmc_ctrlr *ctrlr)
 {
 	int err;
 
 	memset(media, 0, sizeof(*media));
 	media->ctrlr = ctrlr;
 
+	if (!IS_ENABLED(CONFIG_COMMONLIB_STORAGE_MMC))
+		return CARD_UNUSABLE_ERR;
+
+	SET_BUS_WIDTH(ctrlr, 1);
+	SET_CLOCK(ctrlr, 1);
+
+	err = sd_mmc_go_idle(media);
+	if (err)
+		return err;
+
+	err = mmc_send_op_cond(media);
+	if (err && (err != CARD_IN_PROGRESS))
+		return err;
+
+	media->early_cmd1 = 1;
+	return 0;
+}
+
+int storage_complete_setup(struct storage_media *media)
+{
+	int err;
+
 	err = sd_mmc_enter_standby(media);
 	if (err)
 		return err;
 	return storage_startup(media);
 }
 
+/*
+ * SD cards advertise CMD23 in the SCR, MMC devices support it starting with
+ * the version 3 command set.
+ */
+static int storage_supports_cmd23(struct storage_media *media)
+{
+	if (IS_SD(media))
+		return !!(media->scr[0] & SD_SCR_CMD23_SUPPORT);
+	return media->version >= MMC_VERSION_3;
+}
+
 static int storage_read(struct storage_media *media, void *dest, uint32_t start,
 	uint32_t block_count)
 {
 	struct mmc_command cmd;
 	struct sd_mmc_ctrlr *ctrlr = media->ctrlr;
+	uint32_t data_flags = DATA_FLAG_READ;
+
+	/*
+	 * Announce the length of multiple block reads up front. The card can
+	 * then read ahead internally and no STOP_TRANSMISSION is needed.
+	 */
+	if ((block_count > 1) && storage_supports_cmd23(media)) {
+		cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+		cmd.cmdarg = block_count & 0xffff;
+		cmd.resp_type = CARD_RSP_R1;
+		cmd.flags = 0;
+		if (ctrlr->send_cmd(ctrlr, &cmd, NULL))
+			return 0;
+		data_flags |= DATA_FLAG_BLOCK_COUNT_SET;
+	}
 
 	cmd.resp_type = CARD_RSP_R1;
 	cmd.flags = 0;
@@ -237,13 +299,13 @@ static int storage_read(struct storage_media *media, void *dest, uint32_t start,
 	data.dest = dest;
 	data.blocks = block_count;
 	data.blocksize = media->read_bl_len;
-	data.flags = DATA_FLAG_READ;
+	data.flags = data_flags;
 
 	if (ctrlr->send_cmd(ctrlr, &cmd, &data))
 		return 0;
 
-	if ((block_count > 1) && !(ctrlr->caps
-		& DRVR_CAP_AUTO_CMD12)) {
+	if ((block_count > 1) && !(data_flags & DATA_FLAG_BLOCK_COUNT_SET)
+		&& !(ctrlr->caps & DRVR_CAP_AUTO_CMD12)) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = CARD_RSP_R1b;
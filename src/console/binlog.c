@@ -0,0 +1,229 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <cbmem.h>
+#include <commonlib/console_binlog_serialized.h>
+#include <console/binlog.h>
+#include <console/console.h>
+#include <string.h>
+#include <symbols.h>
+
+static struct console_binlog *binlog;
+
+struct binlog_writer {
+	uint8_t *pos;
+	uint8_t *end;
+};
+
+static int put_bytes(struct binlog_writer *w, const void *data, size_t size)
+{
+	if (size > (size_t)(w->end - w->pos))
+		return -1;
+	memcpy(w->pos, data, size);
+	w->pos += size;
+	return 0;
+}
+
+static int put_u64(struct binlog_writer *w, uint64_t val)
+{
+	uint8_t bytes[8];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		bytes[i] = val >> (i * 8);
+	return put_bytes(w, bytes, sizeof(bytes));
+}
+
+static int put_string(struct binlog_writer *w, const char *s, int precision)
+{
+	size_t len;
+
+	if (s == NULL)
+		s = "<NULL>";
+	len = strnlen(s, (size_t)precision);
+	if (put_bytes(w, s, len))
+		return -1;
+	return put_bytes(w, "", 1);
+}
+
+/* Walk fmt the way vtxprintf() does, storing the arguments instead of
+ * formatting them. */
+static int put_args(struct binlog_writer *w, const char *fmt, va_list args)
+{
+	unsigned long long num;
+	int precision;
+	int qualifier;
+	int is_signed;
+
+	for (; *fmt; ++fmt) {
+		if (*fmt != '%')
+			continue;
+
+		do {
+			++fmt;
+		} while (*fmt == '-' || *fmt == '+' || *fmt == ' ' ||
+			 *fmt == '#' || *fmt == '0');
+
+		if (*fmt == '*') {
+			++fmt;
+			if (put_u64(w, va_arg(args, int)))
+				return -1;
+		}
+		while (*fmt >= '0' && *fmt <= '9')
+			++fmt;
+
+		precision = -1;
+		if (*fmt == '.') {
+			++fmt;
+			if (*fmt == '*') {
+				++fmt;
+				precision = va_arg(args, int);
+				if (put_u64(w, precision))
+					return -1;
+			} else {
+				precision = 0;
+				while (*fmt >= '0' && *fmt <= '9')
+					precision = precision * 10 +
+						*fmt++ - '0';
+			}
+			if (precision < 0)
+				precision = 0;
+		}
+
+		qualifier = -1;
+		if (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'z') {
+			qualifier = *fmt;
+			++fmt;
+			if (*fmt == 'l') {
+				qualifier = 'L';
+				++fmt;
+			}
+			if (*fmt == 'h') {
+				qualifier = 'H';
+				++fmt;
+			}
+		}
+
+		is_signed = 0;
+		switch (*fmt) {
+		case 'c':
+			if (put_u64(w, (unsigned char)va_arg(args, int)))
+				return -1;
+			continue;
+		case 's':
+			if (put_string(w, va_arg(args, char *), precision))
+				return -1;
+			continue;
+		case 'p':
+			if (put_u64(w, (uintptr_t)va_arg(args, void *)))
+				return -1;
+			continue;
+		case 'n':
+			/* Nothing is counted here. */
+			va_arg(args, void *);
+			continue;
+		case 'd':
+		case 'i':
+			is_signed = 1;
+			break;
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			break;
+		default:
+			if (*fmt == '\0')
+				return 0;
+			continue;
+		}
+
+		if (qualifier == 'L') {
+			num = va_arg(args, unsigned long long);
+		} else if (qualifier == 'l') {
+			num = va_arg(args, unsigned long);
+			if (is_signed)
+				num = (long)num;
+		} else if (qualifier == 'z') {
+			num = va_arg(args, size_t);
+		} else if (qualifier == 'h') {
+			num = (unsigned short)va_arg(args, int);
+			if (is_signed)
+				num = (short)num;
+		} else if (qualifier == 'H') {
+			num = (unsigned char)va_arg(args, int);
+			if (is_signed)
+				num = (signed char)num;
+		} else if (is_signed) {
+			num = va_arg(args, int);
+		} else {
+			num = va_arg(args, unsigned int);
+		}
+		if (put_u64(w, num))
+			return -1;
+	}
+
+	return 0;
+}
+
+int console_binlog_printk(int msg_level, const char *fmt, va_list args)
+{
+	struct console_binlog_entry *entry;
+	struct binlog_writer w;
+	size_t room;
+
+	if (binlog == NULL)
+		return -1;
+
+	/* Only strings of the stage itself can be looked up later on. */
+	if ((const u8 *)fmt < _program || (const u8 *)fmt >= _eprogram)
+		return -1;
+
+	room = binlog->size - binlog->cursor;
+	/* entry->size is only 16 bits wide. */
+	if (room > 0xffff)
+		room = 0xffff;
+
+	entry = (void *)&binlog->data[binlog->cursor];
+	w.pos = entry->args;
+	w.end = (uint8_t *)entry + room;
+
+	if (room < sizeof(*entry) || put_args(&w, fmt, args)) {
+		binlog->dropped++;
+		return -1;
+	}
+
+	entry->size = w.pos - (uint8_t *)entry;
+	entry->level = msg_level;
+	entry->reserved = 0;
+	entry->fmt = (const u8 *)fmt - _program;
+	binlog->cursor += entry->size;
+
+	return 0;
+}
+
+static void console_binlog_init(int is_recovery)
+{
+	struct console_binlog *log;
+	size_t size = CONFIG_CONSOLE_BINARY_LOG_SIZE;
+
+	log = cbmem_add(CBMEM_ID_CONSOLE_BINLOG, size);
+	if (log == NULL)
+		return;
+
+	memset(log, 0, sizeof(*log));
+	log->size = size - sizeof(*log);
+	log->program = (uintptr_t)_program;
+	log->ptr_size = sizeof(void *);
+	binlog = log;
+}
+RAMSTAGE_CBMEM_INIT_HOOK(console_binlog_init)
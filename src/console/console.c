@@ -14,6 +14,7 @@
  */
 
 #include <console/cbmem_console.h>
+#include <console/console.h>
 #include <console/ne2k.h>
 #include <console/qemu_debugcon.h>
 #include <console/spkmodem.h>
@@ -37,25 +38,49 @@ void console_hw_init(void)
 	__flashconsole_init();
 }
 
-void console_tx_byte(unsigned char byte)
+/* Every console but CBMEM, which takes whole strings at once. */
+static void console_tx_byte_streams(unsigned char byte, int sinks)
 {
-	__cbmemc_tx_byte(byte);
-	__spkmodem_tx_byte(byte);
-	__qemu_debugcon_tx_byte(byte);
+	if (sinks & CONSOLE_SINK_OTHERS) {
+		__spkmodem_tx_byte(byte);
+		__qemu_debugcon_tx_byte(byte);
+	}
 
 	/* Some consoles want newline conversion
 	 * to keep terminals happy.
 	 */
 	if (byte == '\n') {
-		__uart_tx_byte('\r');
-		__usb_tx_byte('\r');
+		if (sinks & CONSOLE_SINK_SERIAL)
+			__uart_tx_byte('\r');
+		if (sinks & CONSOLE_SINK_OTHERS)
+			__usb_tx_byte('\r');
 	}
 
-	__uart_tx_byte(byte);
-	__ne2k_tx_byte(byte);
-	__usb_tx_byte(byte);
-	__spiconsole_tx_byte(byte);
-	__flashconsole_tx_byte(byte);
+	if (sinks & CONSOLE_SINK_SERIAL)
+		__uart_tx_byte(byte);
+
+	if (sinks & CONSOLE_SINK_OTHERS) {
+		__ne2k_tx_byte(byte);
+		__usb_tx_byte(byte);
+		__spiconsole_tx_byte(byte);
+		__flashconsole_tx_byte(byte);
+	}
+}
+
+void console_tx_byte(unsigned char byte)
+{
+	__cbmemc_tx_byte(byte);
+	console_tx_byte_streams(byte, CONSOLE_SINK_ALL);
+}
+
+void console_tx_buffer(const void *data, size_t len, int sinks)
+{
+	const unsigned char *bytes = data;
+
+	if (sinks & CONSOLE_SINK_CBMEM)
+		__cbmemc_write(data, len);
+	while (len--)
+		console_tx_byte_streams(*bytes++, sinks);
 }
 
 void console_tx_flush(void)
@@ -66,11 +91,19 @@ void console_tx_flush(void)
 	__flashconsole_tx_flush();
 }
 
+void console_tx_sync(void)
+{
+	__uart_tx_sync();
+	__usb_tx_sync();
+	__flashconsole_tx_sync();
+	console_tx_flush();
+}
+
 void console_write_line(uint8_t *buffer, size_t number_of_bytes)
 {
 	/* Finish displaying all of the console data if requested */
 	if (number_of_bytes == 0) {
-		console_tx_flush();
+		console_tx_sync();
 		return;
 	}
 
@@ -17,7 +17,9 @@
 #include <arch/io.h>
 #include <compiler.h>
 #include <console/console.h>
+#include <elog.h>
 #include <halt.h>
+#include <rules.h>
 
 #ifndef __ROMCC__
 #define NORETURN __attribute__((noreturn))
@@ -36,6 +38,10 @@ __weak void die_notify(void)
 void NORETURN die(const char *msg)
 {
 	printk(BIOS_EMERG, "%s", msg);
+	console_tx_sync();
+	/* Keep the events leading up to this. */
+	if (IS_ENABLED(CONFIG_ELOG_DEFER_NV_WRITES) && ENV_RAMSTAGE)
+		elog_flush();
 	die_notify();
 	halt();
 }
@@ -30,8 +30,22 @@
 #define CONSOLE_LEVEL_CONST 0
 #endif
 
+#if IS_ENABLED(CONFIG_CONSOLE_SERIAL)
+#define SERIAL_LOGLEVEL CONFIG_CONSOLE_SERIAL_LOGLEVEL
+#else
+#define SERIAL_LOGLEVEL BIOS_SPEW
+#endif
+
+#if IS_ENABLED(CONFIG_CONSOLE_CBMEM)
+#define CBMEM_LOGLEVEL CONFIG_CONSOLE_CBMEM_LOGLEVEL
+#else
+#define CBMEM_LOGLEVEL BIOS_SPEW
+#endif
+
 static int console_inited CAR_GLOBAL;
 static int console_loglevel = CONFIG_DEFAULT_CONSOLE_LOGLEVEL;
+static int serial_loglevel = SERIAL_LOGLEVEL;
+static int cbmem_loglevel = CBMEM_LOGLEVEL;
 
 static inline int get_log_level(void)
 {
@@ -52,6 +66,14 @@ static inline void set_log_level(int new_level)
 	console_loglevel = new_level;
 }
 
+static inline int get_sink_log_level(const int *level, int default_level)
+{
+	if (CONSOLE_LEVEL_CONST)
+		return default_level;
+
+	return *level;
+}
+
 static void init_log_level(void)
 {
 	int debug_level = get_console_loglevel();
@@ -60,10 +82,27 @@ static void init_log_level(void)
 		return;
 
 	get_option(&debug_level, "debug_level");
+	get_option(&serial_loglevel, "serial_debug_level");
+	get_option(&cbmem_loglevel, "cbmem_debug_level");
 
 	set_log_level(debug_level);
 }
 
+int console_log_sinks(int msg_level)
+{
+	int sinks = CONSOLE_SINK_OTHERS;
+
+	if (get_log_level() < msg_level)
+		return 0;
+
+	if (get_sink_log_level(&serial_loglevel, SERIAL_LOGLEVEL) >= msg_level)
+		sinks |= CONSOLE_SINK_SERIAL;
+	if (get_sink_log_level(&cbmem_loglevel, CBMEM_LOGLEVEL) >= msg_level)
+		sinks |= CONSOLE_SINK_CBMEM;
+
+	return sinks;
+}
+
 int console_log_level(int msg_level)
 {
 	return (get_log_level() >= msg_level);
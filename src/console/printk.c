@@ -17,6 +17,7 @@
  * blatantly copied from linux/kernel/printk.c
  */
 
+#include <console/binlog.h>
 #include <console/console.h>
 #include <console/streams.h>
 #include <console/vtxprintf.h>
@@ -34,13 +35,33 @@ void do_putchar(unsigned char byte)
 	console_tx_byte(byte);
 }
 
-static void wrap_putchar(unsigned char byte, void *data)
+/* vtxprintf() output goes to the consoles in chunks of this size. */
+#define PRINTK_CHUNK_SIZE 64
+
+struct printk_chunk {
+	int sinks;
+	size_t len;
+	unsigned char buf[PRINTK_CHUNK_SIZE];
+};
+
+static void chunk_flush(struct printk_chunk *chunk)
+{
+	console_tx_buffer(chunk->buf, chunk->len, chunk->sinks);
+	chunk->len = 0;
+}
+
+static void chunk_putchar(unsigned char byte, void *data)
 {
-	do_putchar(byte);
+	struct printk_chunk *chunk = data;
+
+	chunk->buf[chunk->len++] = byte;
+	if (chunk->len == sizeof(chunk->buf))
+		chunk_flush(chunk);
 }
 
 int do_printk(int msg_level, const char *fmt, ...)
 {
+	struct printk_chunk chunk = { .len = 0 };
 	va_list args;
 	int i;
 
@@ -48,7 +69,9 @@ int do_printk(int msg_level, const char *fmt, ...)
 		!boot_cpu())
 		return 0;
 
-	if (!console_log_level(msg_level))
+	/* Nobody wants it, so don't bother formatting it. */
+	chunk.sinks = console_log_sinks(msg_level);
+	if (!chunk.sinks)
 		return 0;
 
 	DISABLE_TRACE;
@@ -60,11 +83,27 @@ int do_printk(int msg_level, const char *fmt, ...)
 	spin_lock(&console_lock);
 #endif
 
+	i = 0;
 	va_start(args, fmt);
-	i = vtxprintf(wrap_putchar, fmt, args, NULL);
-	va_end(args);
+	if (IS_ENABLED(CONFIG_CONSOLE_BINARY_LOG) && ENV_RAMSTAGE) {
+		va_list binlog_args;
+		int recorded;
+
+		va_copy(binlog_args, args);
+		recorded = !console_binlog_printk(msg_level, fmt, binlog_args);
+		va_end(binlog_args);
+
+		/* Only the important messages still pay for formatting. */
+		if (recorded &&
+		    msg_level > CONSOLE_BINLOG_TEXT_LEVEL)
+			goto out;
+	}
 
+	i = vtxprintf(chunk_putchar, fmt, args, &chunk);
+	chunk_flush(&chunk);
 	console_tx_flush();
+out:
+	va_end(args);
 
 #ifdef __PRE_RAM__
 #if IS_ENABLED(CONFIG_HAVE_ROMSTAGE_CONSOLE_SPINLOCK)
@@ -81,9 +120,13 @@ int do_printk(int msg_level, const char *fmt, ...)
 #if IS_ENABLED(CONFIG_VBOOT)
 void do_printk_va_list(int msg_level, const char *fmt, va_list args)
 {
-	if (!console_log_level(msg_level))
+	struct printk_chunk chunk = { .len = 0 };
+
+	chunk.sinks = console_log_sinks(msg_level);
+	if (!chunk.sinks)
 		return;
-	vtxprintf(wrap_putchar, fmt, args, NULL);
+	vtxprintf(chunk_putchar, fmt, args, &chunk);
+	chunk_flush(&chunk);
 	console_tx_flush();
 }
 #endif /* CONFIG_VBOOT */
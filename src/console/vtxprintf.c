@@ -15,7 +15,9 @@
  * vtxprintf.c, originally from linux/lib/vsprintf.c
  */
 
+#include <commonlib/helpers.h>
 #include <console/vtxprintf.h>
+#include <rules.h>
 #include <string.h>
 
 #define call_tx(x) tx_byte(x, data)
@@ -24,6 +26,10 @@
 #define SUPPORT_64BIT_INTS
 #endif
 
+/* Where every byte of code counts, leave out %n and the two_digits table. */
+#define VTXPRINTF_SMALL (IS_ENABLED(CONFIG_CONSOLE_VTXPRINTF_SMALL_EARLY) && \
+			 (ENV_BOOTBLOCK || ENV_VERSTAGE))
+
 /* haha, don't need ctype.c */
 #define isdigit(c)	((c) >= '0' && (c) <= '9')
 #define is_digit isdigit
@@ -46,6 +52,94 @@ static int skip_atoi(const char **s)
 #define SPECIAL	32		/* 0x */
 #define LARGE	64		/* use 'ABCDEF' instead of 'abcdef' */
 
+static const char two_digits[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/* The decimal digits of 64 bit numbers above 10^9. */
+static const unsigned long long high_powers_of_ten[] = {
+	10000000000000000000ULL, 1000000000000000000ULL,
+	100000000000000000ULL, 10000000000000000ULL, 1000000000000000ULL,
+	100000000000000ULL, 10000000000000ULL, 1000000000000ULL,
+	100000000000ULL, 10000000000ULL, 1000000000ULL,
+};
+
+/*
+ * Write the decimal digits of num into tmp, least significant first, and
+ * return how many there are. 64 bit divisions are a libgcc call on 32 bit
+ * stages, so the digits above 10^9 are found by subtraction and the rest
+ * with 32 bit divisions by 100, which compilers turn into multiplications.
+ */
+static int decimal_digits(char *tmp, unsigned long long num)
+{
+	char high[ARRAY_SIZE(high_powers_of_ten)];
+	int num_high = 0;
+	unsigned int low, r;
+	int i = 0;
+	int j;
+
+	if (num > 0xffffffffULL) {
+		for (j = 0; j < ARRAY_SIZE(high_powers_of_ten); j++) {
+			char digit = '0';
+
+			while (num >= high_powers_of_ten[j]) {
+				num -= high_powers_of_ten[j];
+				digit++;
+			}
+			/* Drop leading zeros, num > 2^32 leaves some digits. */
+			if (num_high || digit != '0')
+				high[num_high++] = digit;
+		}
+	}
+
+	low = num;
+	if (!VTXPRINTF_SMALL) {
+		while (low >= 100) {
+			r = low % 100;
+			low /= 100;
+			tmp[i++] = two_digits[2 * r + 1];
+			tmp[i++] = two_digits[2 * r];
+		}
+	}
+	do {
+		tmp[i++] = '0' + low % 10;
+		low /= 10;
+	} while (low != 0);
+
+	if (num_high) {
+		/* What is left below 10^9 takes all nine places. */
+		while (i < 9)
+			tmp[i++] = '0';
+		while (num_high)
+			tmp[i++] = high[--num_high];
+	}
+
+	return i;
+}
+
+/* Same for bases that are a power of two, which only needs shifts. */
+static int pow2_digits(char *tmp, unsigned long long num, int shift,
+		       const char *digits)
+{
+	const unsigned int mask = (1 << shift) - 1;
+	int i = 0;
+
+	do {
+		tmp[i++] = digits[num & mask];
+		num >>= shift;
+	} while (num != 0);
+
+	return i;
+}
+
 static int number(void (*tx_byte)(unsigned char byte, void *data),
 	unsigned long long inum, int base, int size, int precision, int type,
 	void *data)
@@ -94,15 +188,13 @@ static int number(void (*tx_byte)(unsigned char byte, void *data),
 		else if (base == 8)
 			size--;
 	}
-	i = 0;
-	if (num == 0) {
-		tmp[i++] = '0';
-	} else {
-		while (num != 0) {
-			tmp[i++] = digits[num % base];
-			num /= base;
-		}
-	}
+	/* vtxprintf() only ever asks for these three. */
+	if (base == 16)
+		i = pow2_digits(tmp, num, 4, digits);
+	else if (base == 8)
+		i = pow2_digits(tmp, num, 3, digits);
+	else
+		i = decimal_digits(tmp, num);
 	if (i > precision) {
 		precision = i;
 	}
@@ -257,7 +349,10 @@ repeat:
 			continue;
 
 		case 'n':
-			if (qualifier == 'L') {
+			if (VTXPRINTF_SMALL) {
+				/* Nothing is counted, but the argument goes. */
+				va_arg(args, void *);
+			} else if (qualifier == 'L') {
 				long long *ip = va_arg(args, long long *);
 				*ip = count;
 			} else if (qualifier == 'l') {
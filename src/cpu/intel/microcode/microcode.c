@@ -34,6 +34,9 @@
 #include <smp/spinlock.h>
 DECLARE_SPIN_LOCK(microcode_lock)
 #endif
+#if ENV_RAMSTAGE
+#include <timer.h>
+#endif
 
 struct microcode {
 	u32 hdrver;	/* Header Version */
@@ -101,11 +104,23 @@ void intel_microcode_load_unlocked(const void *microcode_patch)
 	}
 #endif
 
+#if ENV_RAMSTAGE
+	struct stopwatch sw;
+
+	stopwatch_init(&sw);
+#endif
+
 	msr.lo = (unsigned long)m + sizeof(struct microcode);
 	msr.hi = 0;
 	wrmsr(0x79, msr);
 
-#if !defined(__ROMCC__)
+#if ENV_RAMSTAGE
+	printk(BIOS_DEBUG, "microcode: updated to revision "
+		    "0x%x date=%04x-%02x-%02x in %ld usecs\n",
+		    read_microcode_rev(), m->date & 0xffff,
+		    (m->date >> 24) & 0xff, (m->date >> 16) & 0xff,
+		    stopwatch_duration_usecs(&sw));
+#elif !defined(__ROMCC__)
 	printk(BIOS_DEBUG, "microcode: updated to revision "
 		    "0x%x date=%04x-%02x-%02x\n", read_microcode_rev(),
 		    m->date & 0xffff, (m->date >> 24) & 0xff,
@@ -133,6 +148,21 @@ uint32_t get_microcode_checksum(const void *microcode)
 	return ((struct microcode *)microcode)->cksum;
 }
 
+#if ENV_RAMSTAGE
+/*
+ * All cpus in ramstage look up the patch matching their signature. As they
+ * are almost always of the same kind, the last match is kept so that CBFS is
+ * only searched again for a cpu with another signature or platform id. The
+ * APs do this in parallel, so the cache is only used under its lock.
+ */
+static struct {
+	u32 sig;
+	u32 pf;
+	const void *patch;
+} microcode_cache;
+DECLARE_SPIN_LOCK(microcode_cache_lock)
+#endif
+
 const void *intel_microcode_find(void)
 {
 	const struct microcode *ucode_updates;
@@ -141,22 +171,11 @@ const void *intel_microcode_find(void)
 	u32 pf, rev, sig, update_size;
 	unsigned int x86_model, x86_family;
 	msr_t msr;
-
+#if ENV_RAMSTAGE
+	const void *patch = NULL;
+#endif
 #ifdef __ROMCC__
 	struct cbfs_file *microcode_file;
-
-	microcode_file = walkcbfs_head((char *) MICROCODE_CBFS_FILE);
-	if (!microcode_file)
-		return NULL;
-
-	ucode_updates = CBFS_SUBHEADER(microcode_file);
-	microcode_len = ntohl(microcode_file->len);
-#else
-	ucode_updates = cbfs_boot_map_with_leak(MICROCODE_CBFS_FILE,
-						CBFS_TYPE_MICROCODE,
-						&microcode_len);
-	if (ucode_updates == NULL)
-		return NULL;
 #endif
 
 	/* CPUID sets MSR 0x8B iff a microcode update has been loaded. */
@@ -175,6 +194,16 @@ const void *intel_microcode_find(void)
 		msr = rdmsr(0x17);
 		pf = 1 << ((msr.hi >> 18) & 7);
 	}
+
+#if ENV_RAMSTAGE
+	spin_lock(&microcode_cache_lock);
+	if (microcode_cache.sig == sig && microcode_cache.pf == pf)
+		patch = microcode_cache.patch;
+	spin_unlock(&microcode_cache_lock);
+	if (patch != NULL)
+		return patch;
+#endif
+
 #if !defined(__ROMCC__)
 	/* If this code is compiled with ROMCC we're probably in
 	 * the bootblock and don't have console output yet.
@@ -183,6 +212,21 @@ const void *intel_microcode_find(void)
 			sig, pf, rev);
 #endif
 
+#ifdef __ROMCC__
+	microcode_file = walkcbfs_head((char *) MICROCODE_CBFS_FILE);
+	if (!microcode_file)
+		return NULL;
+
+	ucode_updates = CBFS_SUBHEADER(microcode_file);
+	microcode_len = ntohl(microcode_file->len);
+#else
+	ucode_updates = cbfs_boot_map_with_leak(MICROCODE_CBFS_FILE,
+						CBFS_TYPE_MICROCODE,
+						&microcode_len);
+	if (ucode_updates == NULL)
+		return NULL;
+#endif
+
 	while (microcode_len >= sizeof(*ucode_updates)) {
 		/* Newer microcode updates include a size field, whereas older
 		 * containers set it at 0 and are exactly 2048 bytes long */
@@ -203,8 +247,16 @@ const void *intel_microcode_find(void)
 			break;
 		}
 
-		if ((ucode_updates->sig == sig) && (ucode_updates->pf & pf))
+		if ((ucode_updates->sig == sig) && (ucode_updates->pf & pf)) {
+#if ENV_RAMSTAGE
+			spin_lock(&microcode_cache_lock);
+			microcode_cache.sig = sig;
+			microcode_cache.pf = pf;
+			microcode_cache.patch = ucode_updates;
+			spin_unlock(&microcode_cache_lock);
+#endif
 			return ucode_updates;
+		}
 
 		ucode_updates = (void *)((char *)ucode_updates + update_size);
 		microcode_len -= update_size;
@@ -218,6 +270,14 @@ void intel_update_microcode_from_cbfs(void)
 {
 	const void *patch = intel_microcode_find();
 
+	/*
+	 * Hyper-threads share the microcode of their core. Once a sibling
+	 * has loaded the patch there is nothing left to do, so don't queue
+	 * up on the lock for it.
+	 */
+	if (patch && read_microcode_rev() == get_microcode_rev(patch))
+		return;
+
 #if !defined(__ROMCC__) && !defined(__PRE_RAM__)
 	spin_lock(&microcode_lock);
 #endif
@@ -17,6 +17,7 @@
 #include <stddef.h>
 #include <console/console.h>
 #include <cbmem.h>
+#include <mem_usage.h>
 #include <arch/early_variables.h>
 #include <symbols.h>
 
@@ -140,6 +141,36 @@ static void do_car_migrate_variables(void)
 	car_migrated = ~0;
 }
 
+#if IS_ENABLED(CONFIG_CAR_STACK_WATERMARK)
+void car_report_usage(void)
+{
+	const uint32_t *stack = (const uint32_t *)_car_stack_start;
+	size_t words = _car_stack_size / sizeof(*stack);
+	size_t data_size = _car_relocatable_data_end - _car_region_start -
+				_car_stack_size;
+	size_t i, used;
+
+	for (i = 0; i < words && stack[i] == 0xdeadbeef; i++)
+		;
+
+	used = (words - i) * sizeof(*stack);
+
+	printk(BIOS_DEBUG, "CAR: stack used %zu/%zu bytes, data %zu/%zu bytes\n",
+	       used, (size_t)_car_stack_size, data_size,
+	       (size_t)_car_region_size);
+
+	mem_usage_add(MEM_USAGE_CAR_STACK, 0, used, _car_stack_size);
+	mem_usage_add(MEM_USAGE_CAR_DATA, 0, data_size, _car_region_size);
+
+	if (i == 0)
+		printk(BIOS_ERR, "CAR: stack overflow at %p\n", stack);
+	else if (used * 100 >= _car_stack_size * CONFIG_CAR_STACK_WARN_PERCENT)
+		printk(BIOS_WARNING, "CAR: stack usage above %d%%. "
+		       "Increase DCACHE_BSP_STACK_SIZE.\n",
+		       CONFIG_CAR_STACK_WARN_PERCENT);
+}
+#endif
+
 static void car_migrate_variables(int is_recovery)
 {
 	if (!IS_ENABLED(PLATFORM_USES_FSP1_0))
@@ -0,0 +1,285 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/acpi.h>
+#include <bootstate.h>
+#include <cbmem.h>
+#include <commonlib/helpers.h>
+#include <compiler.h>
+#include <console/console.h>
+#include <cpu/cpu.h>
+#include <cpu/x86/cr.h>
+#include <cpu/x86/mp.h>
+#include <cpu/x86/pae.h>
+#include <device/resource.h>
+#include <memrange.h>
+#include <rules.h>
+#include <string.h>
+#include <symbols.h>
+#include <timer.h>
+#include <timestamp.h>
+
+/*
+ * RAM is cut into chunks which the CPUs pull off the MP job queue. The chunk
+ * size starts at CLEAR_CHUNK_SIZE and doubles until the whole of RAM fits
+ * into MAX_CLEAR_CHUNKS chunks.
+ */
+#define CLEAR_CHUNK_SIZE	(64 * MiB)
+#define MAX_CLEAR_CHUNKS	256
+
+/* Everything below 1MiB is left alone, it is tiny and full of legacy. */
+#define CLEAR_BASE		(1 * MiB)
+
+/* Page tables for 1GiB pages covering 4TiB: one PML4 and eight PDPTs. */
+#define CLEAR_PGTBL_SIZE	(9 * 4 * KiB)
+
+struct clear_chunk {
+	uint64_t base;
+	uint64_t size;
+};
+
+static struct clear_chunk chunks[MAX_CLEAR_CHUNKS];
+static struct mp_job jobs[MAX_CLEAR_CHUNKS];
+
+/* Each CPU only updates its own entry. */
+static struct {
+	uint64_t bytes;
+	long usecs;
+} clear_stats[CONFIG_MAX_CPUS];
+
+/* cr3 of the long mode page tables mapping all of RAM, 0 if not in use. */
+static uintptr_t clear_cr3;
+static uint8_t clear_pgtbl[CLEAR_PGTBL_SIZE] __aligned(4 * KiB);
+
+int __weak platform_requires_memory_clear(void)
+{
+	return 0;
+}
+
+/* Clear 'size' bytes at 'ptr' bypassing the caches. Both are 16 byte
+ * aligned since everything is cleared in 4KiB units. */
+static void clear_nt(void *ptr, size_t size)
+{
+	unsigned long *p = ptr;
+	unsigned long *end = (void *)((uintptr_t)ptr + size);
+	const unsigned long zero = 0;
+
+	if (!IS_ENABLED(CONFIG_SSE2)) {
+		memset(ptr, 0, size);
+		return;
+	}
+
+	while (p < end) {
+		asm volatile (
+			"movnti %4, %0\n"
+			"movnti %4, %1\n"
+			"movnti %4, %2\n"
+			"movnti %4, %3\n"
+			: "=m" (p[0]), "=m" (p[1]), "=m" (p[2]), "=m" (p[3])
+			: "r" (zero)
+		);
+		p += 4;
+	}
+	asm volatile ("sfence" ::: "memory");
+}
+
+static void clear_above_4g(uint64_t base, uint64_t size)
+{
+	while (size) {
+		uint64_t offset = base & (2 * MiB - 1);
+		size_t len = MIN(size, 2 * MiB - offset);
+		void *window = map_2M_page(base >> 21);
+
+		if (window == MAPPING_ERROR)
+			break;
+
+		clear_nt((uint8_t *)window + offset, len);
+		base += len;
+		size -= len;
+	}
+
+	/* Back to the flat, unpaged view of the world. */
+	map_2M_page(0);
+}
+
+static void clear_chunk(void *arg)
+{
+	const struct clear_chunk *chunk = arg;
+	struct stopwatch sw;
+	uint64_t base = chunk->base;
+	uint64_t size = chunk->size;
+	uintptr_t old_cr3 = 0;
+	unsigned long cpu = cpu_index();
+
+	stopwatch_init(&sw);
+
+	if (ENV_X86_64 && clear_cr3) {
+		old_cr3 = read_cr3();
+		write_cr3(clear_cr3);
+	}
+
+	if (ENV_X86_64 || base + size <= 4ULL * GiB) {
+		clear_nt((void *)(uintptr_t)base, size);
+	} else {
+		if (base < 4ULL * GiB) {
+			clear_nt((void *)(uintptr_t)base, 4ULL * GiB - base);
+			size -= 4ULL * GiB - base;
+			base = 4ULL * GiB;
+		}
+		clear_above_4g(base, size);
+	}
+
+	if (old_cr3)
+		write_cr3(old_cr3);
+
+	if (cpu < CONFIG_MAX_CPUS) {
+		clear_stats[cpu].bytes += chunk->size;
+		clear_stats[cpu].usecs += stopwatch_duration_usecs(&sw);
+	}
+}
+
+/* Returns the address RAM can be cleared up to with the mappings at hand. */
+static uint64_t setup_clear_mappings(uint64_t top)
+{
+	if (ENV_X86_64) {
+		/* Without 1GiB pages the tables for all of RAM do not fit,
+		 * make do with whatever the loader mapped. */
+		if (paging_has_1g_pages() &&
+		    !paging_identity_map_long(clear_pgtbl, sizeof(clear_pgtbl),
+					      ALIGN_UP(top, 1ULL * GiB),
+					      &clear_cr3))
+			return top;
+		return 4ULL * GiB;
+	}
+
+	/* The windows of map_2M_page() live in [2GiB, 4GiB) and hide
+	 * whatever is there, so the stage itself has to sit below. */
+	if ((uintptr_t)_eprogram <= 2UL * GiB)
+		return top;
+
+	return 4ULL * GiB;
+}
+
+static size_t count_chunks(struct memranges *ranges, uint64_t chunk_size)
+{
+	const struct range_entry *r;
+	size_t num = 0;
+
+	memranges_each_entry(r, ranges) {
+		if (range_entry_tag(r))
+			num += DIV_ROUND_UP(range_entry_size(r), chunk_size);
+	}
+
+	return num;
+}
+
+int mp_clear_memory(void)
+{
+	struct memranges ranges;
+	const struct range_entry *r;
+	uint64_t chunk_size = CLEAR_CHUNK_SIZE;
+	uint64_t top = 0, limit, total = 0;
+	void *cbmem_base;
+	size_t cbmem_size;
+	struct stopwatch sw;
+	size_t num = 0;
+	long usecs;
+	int cpu, ret;
+
+	timestamp_add_now(TS_START_MEM_CLEAR);
+	stopwatch_init(&sw);
+
+	/* RAM minus whatever is reserved, then minus coreboot itself. */
+	memranges_init(&ranges, IORESOURCE_CACHEABLE, IORESOURCE_CACHEABLE, 1);
+	memranges_add_resources(&ranges, IORESOURCE_RESERVE,
+				IORESOURCE_RESERVE, 0);
+	memranges_create_hole(&ranges, 0, CLEAR_BASE);
+	memranges_create_hole(&ranges, (uintptr_t)_program, _program_size);
+	cbmem_get_region(&cbmem_base, &cbmem_size);
+	memranges_create_hole(&ranges, (uintptr_t)cbmem_base, cbmem_size);
+
+	memranges_each_entry(r, &ranges) {
+		if (range_entry_tag(r))
+			top = MAX(top, range_entry_end(r));
+	}
+
+	limit = setup_clear_mappings(top);
+	if (limit < top) {
+		printk(BIOS_WARNING, "Memory clear: can't reach RAM above "
+		       "0x%llx from here, leaving it\n", limit);
+		memranges_create_hole(&ranges, limit, top - limit);
+	}
+
+	while (count_chunks(&ranges, chunk_size) > MAX_CLEAR_CHUNKS)
+		chunk_size *= 2;
+
+	memranges_each_entry(r, &ranges) {
+		uint64_t base = range_entry_base(r);
+		uint64_t end = range_entry_end(r);
+
+		if (!range_entry_tag(r))
+			continue;
+
+		while (base < end) {
+			chunks[num].base = base;
+			chunks[num].size = MIN(chunk_size, end - base);
+			jobs[num].func = clear_chunk;
+			jobs[num].arg = &chunks[num];
+			total += chunks[num].size;
+			base += chunks[num].size;
+			num++;
+		}
+	}
+	memranges_teardown(&ranges);
+
+	printk(BIOS_INFO, "Memory clear: %llu MiB in %zu chunks\n",
+	       total / MiB, num);
+
+	memset(clear_stats, 0, sizeof(clear_stats));
+	ret = mp_run_jobs(jobs, num, 0);
+	usecs = stopwatch_duration_usecs(&sw);
+
+	for (cpu = 0; cpu < CONFIG_MAX_CPUS; cpu++) {
+		if (!clear_stats[cpu].usecs)
+			continue;
+		/* Bytes per microsecond are MB/s. */
+		printk(BIOS_DEBUG, "Memory clear: CPU%d %llu MiB at %llu MB/s\n",
+		       cpu, clear_stats[cpu].bytes / MiB,
+		       clear_stats[cpu].bytes / clear_stats[cpu].usecs);
+	}
+
+	if (usecs)
+		printk(BIOS_INFO, "Memory clear: done in %ld ms, %llu MB/s\n",
+		       usecs / USECS_PER_MSEC, total / usecs);
+
+	timestamp_add_now(TS_END_MEM_CLEAR);
+
+	return ret;
+}
+
+static void clear_memory(void *unused)
+{
+	/* The OS is still in there, whatever the platform asks for. */
+	if (acpi_is_wakeup_s3())
+		return;
+
+	if (!platform_requires_memory_clear())
+		return;
+
+	if (mp_clear_memory() < 0)
+		printk(BIOS_ERR, "Memory clear: not all of RAM was cleared\n");
+}
+
+/* After device init all APs are up and waiting for work, and nothing has
+ * been written to RAM outside of coreboot and CBMEM yet. */
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, clear_memory, NULL);
@@ -0,0 +1,479 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/acpi.h>
+#include <bootstate.h>
+#include <cbmem.h>
+#include <commonlib/helpers.h>
+#include <compiler.h>
+#include <console/console.h>
+#include <cpu/cpu.h>
+#include <cpu/x86/cr.h>
+#include <cpu/x86/mp.h>
+#include <cpu/x86/pae.h>
+#include <device/resource.h>
+#include <elog.h>
+#include <memory_info.h>
+#include <memrange.h>
+#include <rules.h>
+#include <string.h>
+#include <symbols.h>
+#include <timer.h>
+#include <timestamp.h>
+
+/*
+ * RAM is cut into chunks the same way mp_clear_memory() does it. Every chunk
+ * goes through all the patterns before the next one is picked up, so the
+ * data stays in one CPU's hands and no CPU waits for another.
+ */
+#define TEST_CHUNK_SIZE		(64 * MiB)
+#define MAX_TEST_CHUNKS		256
+
+/* Everything below 1MiB is left alone, it is tiny and full of legacy. */
+#define TEST_BASE		(1 * MiB)
+
+/* Page tables for 1GiB pages covering 4TiB: one PML4 and eight PDPTs. */
+#define TEST_PGTBL_SIZE		(9 * 4 * KiB)
+
+/* Bad addresses each CPU remembers for the event log. */
+#define MAX_ERRORS_PER_CPU	8
+
+/*
+ * The rest of coreboot is built without SSE. Only the test loops are
+ * compiled for it, and only where the CPU is known to have SSE2.
+ */
+#if IS_ENABLED(CONFIG_SSE2)
+#define MEMTEST_TARGET __attribute__((target("sse2")))
+#else
+#define MEMTEST_TARGET
+#endif
+
+typedef long long v2di __attribute__((vector_size(16)));
+
+enum test_pattern {
+	PATTERN_ADDRESS,	/* the address and its complement */
+	PATTERN_WALKING,	/* a one and a zero walking across the bits */
+	PATTERN_CONSTANT,	/* the same value everywhere */
+};
+
+struct test_chunk {
+	uint64_t base;
+	uint64_t size;
+};
+
+struct test_error {
+	uint64_t addr;
+	uint64_t expected;
+	uint64_t actual;
+};
+
+static struct test_chunk test_chunks[MAX_TEST_CHUNKS];
+static struct mp_job test_jobs[MAX_TEST_CHUNKS];
+
+/* Each CPU only updates its own entry. */
+static struct {
+	uint64_t bytes;
+	long usecs;
+	uint32_t num_errors;
+	struct test_error errors[MAX_ERRORS_PER_CPU];
+} test_stats[CONFIG_MAX_CPUS];
+
+/* cr3 of the long mode page tables mapping all of RAM, 0 if not in use. */
+static uintptr_t test_cr3;
+static uint8_t test_pgtbl[TEST_PGTBL_SIZE] __aligned(4 * KiB);
+
+/* The moving inversions run once with each of these. */
+static const uint64_t inversion_patterns[] = {
+	0x5555555555555555ULL,
+	0x3333333333333333ULL,
+};
+
+int __weak platform_memtest_dimm(uint64_t addr)
+{
+	return -1;
+}
+
+/* Vectors go by reference, passing them by value needs SSE in the ABI. */
+static inline MEMTEST_TARGET void pattern_value(v2di *value,
+						enum test_pattern pattern,
+						uint64_t addr, uint64_t seed)
+{
+	uint64_t one;
+
+	switch (pattern) {
+	case PATTERN_ADDRESS:
+		*value = (v2di){ addr, ~addr };
+		break;
+	case PATTERN_WALKING:
+		one = 1ULL << ((addr / sizeof(v2di) + seed) % 64);
+		*value = (v2di){ one, ~one };
+		break;
+	default:
+		*value = (v2di){ seed, seed };
+		break;
+	}
+}
+
+static inline MEMTEST_TARGET void store(v2di *p, const v2di *value)
+{
+#if IS_ENABLED(CONFIG_SSE2)
+	__builtin_ia32_movntdq(p, *value);
+#else
+	*(volatile v2di *)p = *value;
+#endif
+}
+
+static inline void store_fence(void)
+{
+	if (IS_ENABLED(CONFIG_SSE2))
+		asm volatile ("sfence" ::: "memory");
+	else
+		asm volatile ("" ::: "memory");
+}
+
+static void record_error(uint64_t addr, uint64_t expected, uint64_t actual)
+{
+	unsigned long cpu = cpu_index();
+	uint32_t n;
+
+	if (cpu >= CONFIG_MAX_CPUS)
+		return;
+
+	n = test_stats[cpu].num_errors++;
+	if (n < MAX_ERRORS_PER_CPU) {
+		test_stats[cpu].errors[n].addr = addr;
+		test_stats[cpu].errors[n].expected = expected;
+		test_stats[cpu].errors[n].actual = actual;
+	}
+}
+
+static inline MEMTEST_TARGET void check(const v2di *p, uint64_t addr,
+					const v2di *expected)
+{
+	v2di actual = *(const volatile v2di *)p;
+	v2di diff = actual ^ *expected;
+
+	if (diff[0])
+		record_error(addr, (*expected)[0], actual[0]);
+	if (diff[1])
+		record_error(addr + 8, (*expected)[1], actual[1]);
+}
+
+static MEMTEST_TARGET void fill(v2di *p, size_t n, uint64_t addr,
+				enum test_pattern pattern, uint64_t seed)
+{
+	v2di value;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		pattern_value(&value, pattern, addr + i * sizeof(*p), seed);
+		store(&p[i], &value);
+	}
+	store_fence();
+}
+
+static MEMTEST_TARGET void verify(const v2di *p, size_t n, uint64_t addr,
+				  enum test_pattern pattern, uint64_t seed)
+{
+	v2di value;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		pattern_value(&value, pattern, addr + i * sizeof(*p), seed);
+		check(&p[i], addr + i * sizeof(*p), &value);
+	}
+}
+
+/*
+ * Moving inversions: going up, check the value and write its complement,
+ * then going down, check the complement and write the value back. This
+ * catches cells that flip their neighbours.
+ */
+static MEMTEST_TARGET void moving_inversions(v2di *p, size_t n,
+					     uint64_t addr, uint64_t seed)
+{
+	const v2di value = { seed, seed };
+	const v2di inverse = ~value;
+	size_t i;
+
+	fill(p, n, addr, PATTERN_CONSTANT, seed);
+
+	for (i = 0; i < n; i++) {
+		check(&p[i], addr + i * sizeof(*p), &value);
+		store(&p[i], &inverse);
+	}
+	store_fence();
+
+	for (i = n; i-- > 0;) {
+		check(&p[i], addr + i * sizeof(*p), &inverse);
+		store(&p[i], &value);
+	}
+	store_fence();
+
+	verify(p, n, addr, PATTERN_CONSTANT, seed);
+}
+
+/* Run all patterns over 'size' bytes of RAM at 'addr' mapped at 'ptr'. */
+static void test_range(void *ptr, size_t size, uint64_t addr)
+{
+	v2di *p = ptr;
+	size_t n = size / sizeof(*p);
+	size_t i;
+
+	fill(p, n, addr, PATTERN_ADDRESS, 0);
+	verify(p, n, addr, PATTERN_ADDRESS, 0);
+
+	fill(p, n, addr, PATTERN_WALKING, 0);
+	verify(p, n, addr, PATTERN_WALKING, 0);
+
+	for (i = 0; i < ARRAY_SIZE(inversion_patterns); i++)
+		moving_inversions(p, n, addr, inversion_patterns[i]);
+
+	fill(p, n, addr, PATTERN_CONSTANT, 0);
+}
+
+static void test_above_4g(uint64_t base, uint64_t size)
+{
+	while (size) {
+		uint64_t offset = base & (2 * MiB - 1);
+		size_t len = MIN(size, 2 * MiB - offset);
+		void *window = map_2M_page(base >> 21);
+
+		if (window == MAPPING_ERROR)
+			break;
+
+		test_range((uint8_t *)window + offset, len, base);
+		base += len;
+		size -= len;
+	}
+
+	/* Back to the flat, unpaged view of the world. */
+	map_2M_page(0);
+}
+
+static void test_chunk(void *arg)
+{
+	const struct test_chunk *chunk = arg;
+	struct stopwatch sw;
+	uint64_t base = chunk->base;
+	uint64_t size = chunk->size;
+	uintptr_t old_cr3 = 0;
+	unsigned long cpu = cpu_index();
+
+	stopwatch_init(&sw);
+
+	/* APs come up without CR4.OSFXSR, movntdq would #UD. */
+	if (IS_ENABLED(CONFIG_SSE2))
+		write_cr4(read_cr4() | CR4_OSFXSR);
+
+	if (ENV_X86_64 && test_cr3) {
+		old_cr3 = read_cr3();
+		write_cr3(test_cr3);
+	}
+
+	if (ENV_X86_64 || base + size <= 4ULL * GiB) {
+		test_range((void *)(uintptr_t)base, size, base);
+	} else {
+		if (base < 4ULL * GiB) {
+			test_range((void *)(uintptr_t)base, 4ULL * GiB - base,
+				   base);
+			size -= 4ULL * GiB - base;
+			base = 4ULL * GiB;
+		}
+		test_above_4g(base, size);
+	}
+
+	if (old_cr3)
+		write_cr3(old_cr3);
+
+	if (cpu < CONFIG_MAX_CPUS) {
+		test_stats[cpu].bytes += chunk->size;
+		test_stats[cpu].usecs += stopwatch_duration_usecs(&sw);
+	}
+}
+
+/* Returns the address RAM can be tested up to with the mappings at hand. */
+static uint64_t setup_test_mappings(uint64_t top)
+{
+	if (ENV_X86_64) {
+		if (paging_has_1g_pages() &&
+		    !paging_identity_map_long(test_pgtbl, sizeof(test_pgtbl),
+					      ALIGN_UP(top, 1ULL * GiB),
+					      &test_cr3))
+			return top;
+		return 4ULL * GiB;
+	}
+
+	/* The windows of map_2M_page() live in [2GiB, 4GiB) and hide
+	 * whatever is there, so the stage itself has to sit below. */
+	if ((uintptr_t)_eprogram <= 2UL * GiB)
+		return top;
+
+	return 4ULL * GiB;
+}
+
+static size_t count_chunks(struct memranges *ranges, uint64_t chunk_size)
+{
+	const struct range_entry *r;
+	size_t num = 0;
+
+	memranges_each_entry(r, ranges) {
+		if (range_entry_tag(r))
+			num += DIV_ROUND_UP(range_entry_size(r), chunk_size);
+	}
+
+	return num;
+}
+
+static void report_error(const struct test_error *e,
+			 const struct memory_info *mem_info)
+{
+	struct elog_event_data_mem_test event = {
+		.address = e->addr,
+		.expected = e->expected,
+		.actual = e->actual,
+		.channel = 0xff,
+		.dimm = 0xff,
+	};
+	int dimm = platform_memtest_dimm(e->addr);
+
+	if (mem_info && dimm >= 0 && dimm < mem_info->dimm_cnt &&
+	    dimm < DIMM_INFO_TOTAL) {
+		event.channel = mem_info->dimm[dimm].channel_num;
+		event.dimm = mem_info->dimm[dimm].dimm_num;
+		printk(BIOS_ERR, "Memory test: 0x%llx reads 0x%016llx instead "
+		       "of 0x%016llx, channel %u DIMM %u\n", e->addr,
+		       e->actual, e->expected, event.channel, event.dimm);
+	} else {
+		printk(BIOS_ERR, "Memory test: 0x%llx reads 0x%016llx instead "
+		       "of 0x%016llx\n", e->addr, e->actual, e->expected);
+	}
+
+	elog_add_event_raw(ELOG_TYPE_MEM_TEST_FAIL, &event, sizeof(event));
+}
+
+int mp_test_memory(void)
+{
+	struct memranges ranges;
+	const struct range_entry *r;
+	const struct memory_info *mem_info;
+	uint64_t chunk_size = TEST_CHUNK_SIZE;
+	uint64_t top = 0, limit, total = 0;
+	void *cbmem_base;
+	size_t cbmem_size;
+	struct stopwatch sw;
+	size_t num = 0;
+	uint32_t bad = 0;
+	long usecs;
+	int cpu, i, ret;
+
+	timestamp_add_now(TS_START_MEM_TEST);
+	stopwatch_init(&sw);
+
+	/* RAM minus whatever is reserved, then minus coreboot itself. */
+	memranges_init(&ranges, IORESOURCE_CACHEABLE, IORESOURCE_CACHEABLE, 1);
+	memranges_add_resources(&ranges, IORESOURCE_RESERVE,
+				IORESOURCE_RESERVE, 0);
+	memranges_create_hole(&ranges, 0, TEST_BASE);
+	memranges_create_hole(&ranges, (uintptr_t)_program, _program_size);
+	cbmem_get_region(&cbmem_base, &cbmem_size);
+	memranges_create_hole(&ranges, (uintptr_t)cbmem_base, cbmem_size);
+
+	memranges_each_entry(r, &ranges) {
+		if (range_entry_tag(r))
+			top = MAX(top, range_entry_end(r));
+	}
+
+	limit = setup_test_mappings(top);
+	if (limit < top) {
+		printk(BIOS_WARNING, "Memory test: can't reach RAM above "
+		       "0x%llx from here, leaving it\n", limit);
+		memranges_create_hole(&ranges, limit, top - limit);
+	}
+
+	while (count_chunks(&ranges, chunk_size) > MAX_TEST_CHUNKS)
+		chunk_size *= 2;
+
+	memranges_each_entry(r, &ranges) {
+		uint64_t base = range_entry_base(r);
+		uint64_t end = range_entry_end(r);
+
+		if (!range_entry_tag(r))
+			continue;
+
+		while (base < end) {
+			test_chunks[num].base = base;
+			test_chunks[num].size = MIN(chunk_size, end - base);
+			test_jobs[num].func = test_chunk;
+			test_jobs[num].arg = &test_chunks[num];
+			total += test_chunks[num].size;
+			base += test_chunks[num].size;
+			num++;
+		}
+	}
+	memranges_teardown(&ranges);
+
+	printk(BIOS_INFO, "Memory test: %llu MiB in %zu chunks\n",
+	       total / MiB, num);
+
+	memset(test_stats, 0, sizeof(test_stats));
+	ret = mp_run_jobs(test_jobs, num, 0);
+	usecs = stopwatch_duration_usecs(&sw);
+
+	/* The event log is only written from the BSP. */
+	mem_info = cbmem_find(CBMEM_ID_MEMINFO);
+
+	for (cpu = 0; cpu < CONFIG_MAX_CPUS; cpu++) {
+		uint32_t logged = MIN(test_stats[cpu].num_errors,
+				      MAX_ERRORS_PER_CPU);
+
+		for (i = 0; i < logged; i++)
+			report_error(&test_stats[cpu].errors[i], mem_info);
+		if (test_stats[cpu].num_errors > logged)
+			printk(BIOS_ERR, "Memory test: %u more bad words "
+			       "on CPU%d\n", test_stats[cpu].num_errors -
+			       logged, cpu);
+		bad += test_stats[cpu].num_errors;
+
+		if (!test_stats[cpu].usecs)
+			continue;
+		/* Bytes per microsecond are MB/s. */
+		printk(BIOS_DEBUG, "Memory test: CPU%d %llu MiB at %llu MB/s\n",
+		       cpu, test_stats[cpu].bytes / MiB,
+		       test_stats[cpu].bytes / test_stats[cpu].usecs);
+	}
+
+	printk(bad ? BIOS_ERR : BIOS_INFO, "Memory test: %u bad words, "
+	       "done in %ld ms\n", bad, usecs / USECS_PER_MSEC);
+
+	timestamp_add_now(TS_END_MEM_TEST);
+
+	if (ret < 0 || limit < top)
+		return -1;
+
+	return bad;
+}
+
+static void test_memory(void *unused)
+{
+	/* The OS is still in there. */
+	if (acpi_is_wakeup_s3())
+		return;
+
+	if (mp_test_memory() < 0)
+		printk(BIOS_ERR, "Memory test: not all of RAM was tested\n");
+}
+
+/* After device init all APs are up and waiting for work, and nothing has
+ * been written to RAM outside of coreboot and CBMEM yet. */
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, test_memory, NULL);
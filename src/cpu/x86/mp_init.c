@@ -34,9 +34,11 @@
 #include <device/path.h>
 #include <lib.h>
 #include <smp/atomic.h>
+#include <smp/node.h>
 #include <smp/spinlock.h>
 #include <symbols.h>
 #include <thread.h>
+#include <timestamp.h>
 
 #define MAX_APIC_IDS 256
 
@@ -162,22 +164,32 @@ static inline void release_barrier(atomic_t *b)
 	atomic_set(b, 1);
 }
 
-/* Returns 1 if timeout waiting for APs. 0 if target aps found. */
-static int wait_for_aps(atomic_t *val, int target, int total_delay,
-			int delay_step)
+/*
+ * Returns 1 if timeout waiting for APs. 0 if target aps found. The count is
+ * polled continuously so that this returns as soon as the last AP shows up.
+ * The timeout is kept by a stopwatch. Without a monotonic timer a stopwatch
+ * never expires, so there the delays are counted instead.
+ */
+static int wait_for_aps(atomic_t *val, int target, int total_delay)
 {
-	int timeout = 0;
+	struct stopwatch sw;
 	int delayed = 0;
+
+	stopwatch_init_usecs_expire(&sw, total_delay);
+
 	while (atomic_read(val) != target) {
-		udelay(delay_step);
-		delayed += delay_step;
-		if (delayed >= total_delay) {
-			timeout = 1;
-			break;
+		if (!IS_ENABLED(CONFIG_HAVE_MONOTONIC_TIMER)) {
+			if (delayed++ >= total_delay)
+				return 1;
+			udelay(1);
+		} else if (stopwatch_expired(&sw)) {
+			return atomic_read(val) != target;
+		} else {
+			asm ("pause");
 		}
 	}
 
-	return timeout;
+	return 0;
 }
 
 static void ap_do_flight_plan(void)
@@ -433,6 +445,8 @@ static int apic_wait_timeout(int total_delay, int delay_step)
 static int start_aps(struct bus *cpu_bus, int ap_count, atomic_t *num_aps)
 {
 	int sipi_vector;
+	/* Only the time for all of them is known, not per AP. */
+	struct stopwatch sw;
 	/* Max location is 4KiB below 1MiB */
 	const int max_vector_loc = ((1 << 20) - (1 << 12)) >> 12;
 
@@ -460,11 +474,14 @@ static int start_aps(struct bus *cpu_bus, int ap_count, atomic_t *num_aps)
 	}
 
 	/* Send INIT IPI to all but self. */
+	stopwatch_init(&sw);
 	lapic_write_around(LAPIC_ICR2, SET_LAPIC_DEST_FIELD(0));
 	lapic_write_around(LAPIC_ICR, LAPIC_DEST_ALLBUT | LAPIC_INT_ASSERT |
 			   LAPIC_DM_INIT);
-	printk(BIOS_DEBUG, "Waiting for 10ms after sending INIT.\n");
-	mdelay(10);
+	if (!IS_ENABLED(CONFIG_PARALLEL_MP_FAST_START)) {
+		printk(BIOS_DEBUG, "Waiting for 10ms after sending INIT.\n");
+		mdelay(10);
+	}
 
 	/* Send 1st SIPI */
 	if ((lapic_read(LAPIC_ICR) & LAPIC_ICR_BUSY)) {
@@ -487,7 +504,12 @@ static int start_aps(struct bus *cpu_bus, int ap_count, atomic_t *num_aps)
 	printk(BIOS_DEBUG, "done.\n");
 
 	/* Wait for CPUs to check in up to 200 us. */
-	wait_for_aps(num_aps, ap_count, 200 /* us */, 15 /* us */);
+	if (!wait_for_aps(num_aps, ap_count, 200 /* us */) &&
+	    IS_ENABLED(CONFIG_PARALLEL_MP_FAST_START)) {
+		printk(BIOS_DEBUG, "All APs checked in after 1st SIPI, "
+		       "%ld usecs after INIT.\n", stopwatch_duration_usecs(&sw));
+		return 0;
+	}
 
 	/* Send 2nd SIPI */
 	if ((lapic_read(LAPIC_ICR) & LAPIC_ICR_BUSY)) {
@@ -510,12 +532,14 @@ static int start_aps(struct bus *cpu_bus, int ap_count, atomic_t *num_aps)
 	printk(BIOS_DEBUG, "done.\n");
 
 	/* Wait for CPUs to check in. */
-	if (wait_for_aps(num_aps, ap_count, 10000 /* 10 ms */, 50 /* us */)) {
+	if (wait_for_aps(num_aps, ap_count, 10000 /* 10 ms */)) {
 		printk(BIOS_DEBUG, "Not all APs checked in: %d/%d.\n",
 		       atomic_read(num_aps), ap_count);
 		return -1;
 	}
 
+	printk(BIOS_DEBUG, "All APs checked in %ld usecs after INIT.\n",
+	       stopwatch_duration_usecs(&sw));
 	return 0;
 }
 
@@ -529,7 +553,6 @@ static int bsp_do_flight_plan(struct mp_params *mp_params)
 	 * increases (contention for resources like UART also increases).
 	 */
 	const int timeout_us = 1000000;
-	const int step_us = 100;
 	int num_aps = mp_params->num_cpus - 1;
 	struct stopwatch sw;
 
@@ -542,7 +565,7 @@ static int bsp_do_flight_plan(struct mp_params *mp_params)
 		if (atomic_read(&rec->barrier) == 0) {
 			/* Wait for the APs to check in. */
 			if (wait_for_aps(&rec->cpus_entered, num_aps,
-					 timeout_us, step_us)) {
+					 timeout_us)) {
 				printk(BIOS_ERR, "MP record %d timeout.\n", i);
 				ret = -1;
 			}
@@ -643,22 +666,99 @@ static int mp_init(struct bus *cpu_bus, struct mp_params *p)
 
 	/* Start the APs providing number of APs and the cpus_entered field. */
 	global_num_aps = p->num_cpus - 1;
+	timestamp_add_now(TS_MP_START_APS);
 	if (start_aps(cpu_bus, global_num_aps, ap_count) < 0) {
 		mdelay(1000);
 		printk(BIOS_DEBUG, "%d/%d eventually checked in?\n",
 		       atomic_read(ap_count), global_num_aps);
 		return -1;
 	}
+	timestamp_add_now(TS_MP_APS_CHECKED_IN);
 
 	/* Walk the flight plan for the BSP. */
 	return bsp_do_flight_plan(p);
 }
 
 /* Calls cpu_initialize(info->index) which calls the coreboot CPU drivers. */
+/* The MSR settings from mp_ops, see struct mp_msr_setting. */
+static struct {
+	const struct mp_msr_setting *settings;
+	size_t count;
+	unsigned int thread_shift;	/* APIC ID bits of the threads */
+	unsigned int package_shift;	/* and of all cpus in a package */
+	atomic_t failures;
+} msr_table;
+
+/*
+ * Find which APIC ID bits number the threads of a core and the cores of a
+ * package. Without CPUID leaf 0xb every cpu writes every setting.
+ */
+static void fill_msr_table_topology(void)
+{
+	struct cpuid_result res;
+	int level;
+
+	msr_table.thread_shift = 0;
+	msr_table.package_shift = 0;
+
+	if (cpuid_eax(0) < 0xb)
+		return;
+
+	for (level = 0; level < 8; level++) {
+		unsigned int type, shift;
+
+		res = cpuid_ext(0xb, level);
+		type = (res.ecx >> 8) & 0xff;
+		shift = res.eax & 0x1f;
+		if (type == 0)
+			break;
+		if (type == 1)
+			msr_table.thread_shift = shift;
+		msr_table.package_shift = shift;
+	}
+}
+
+static void apply_msr_settings(void)
+{
+	const unsigned int apic_id = lapicid();
+	const unsigned int thread_mask = (1 << msr_table.thread_shift) - 1;
+	const unsigned int package_mask = (1 << msr_table.package_shift) - 1;
+	size_t i;
+
+	for (i = 0; i < msr_table.count; i++) {
+		const struct mp_msr_setting *s = &msr_table.settings[i];
+		msr_t msr, new;
+
+		if (s->scope == MP_MSR_SCOPE_CORE && (apic_id & thread_mask))
+			continue;
+		if (s->scope == MP_MSR_SCOPE_PACKAGE &&
+		    (apic_id & package_mask))
+			continue;
+
+		msr = rdmsr(s->index);
+		new.lo = (msr.lo & ~s->mask.lo) | (s->value.lo & s->mask.lo);
+		new.hi = (msr.hi & ~s->mask.hi) | (s->value.hi & s->mask.hi);
+		if (new.lo == msr.lo && new.hi == msr.hi)
+			continue;
+
+		wrmsr(s->index, new);
+		msr = rdmsr(s->index);
+		if (((msr.lo ^ new.lo) & s->mask.lo) ||
+		    ((msr.hi ^ new.hi) & s->mask.hi)) {
+			printk(BIOS_ERR, "CPU %lu: MSR 0x%x reads 0x%08x%08x, "
+			       "wrote 0x%08x%08x\n", cpu_index(), s->index,
+			       msr.hi, msr.lo, new.hi, new.lo);
+			atomic_inc(&msr_table.failures);
+		}
+	}
+}
+
 static void mp_initialize_cpu(void)
 {
 	/* Call back into driver infrastructure for the AP initialization.   */
 	struct cpu_info *info = cpu_info();
+
+	apply_msr_settings();
 	cpu_initialize(info->index);
 }
 
@@ -700,6 +800,24 @@ void smm_initiate_relocation(void)
 	spin_unlock(&smm_relocation_lock);
 }
 
+static int smm_relocation_in_parallel;
+
+void smm_relocate_cpu(int parallel)
+{
+	/*
+	 * With the save state in MSRs all cpus can relocate at the same time
+	 * and the BSP relocates a second time to do the final move. Otherwise
+	 * the BSP has already relocated and the APs take turns as they all
+	 * share the save state at the default SMBASE.
+	 */
+	if (parallel) {
+		smm_relocation_in_parallel = 1;
+		smm_initiate_relocation_parallel();
+	} else if (!boot_cpu()) {
+		smm_initiate_relocation();
+	}
+}
+
 struct mp_state {
 	struct mp_ops ops;
 	int cpu_count;
@@ -840,6 +958,8 @@ static void load_smm_handlers(void)
 	/* Ensure the SMM handlers hit DRAM before performing first SMI. */
 	wbinvd();
 
+	timestamp_add_now(TS_MP_SMM_HANDLERS_INSTALLED);
+
 	/*
 	 * Indicate that the SMM handlers have been loaded and MP
 	 * initialization is about to start.
@@ -858,6 +978,21 @@ static void trigger_smm_relocation(void)
 	mp_state.ops.per_cpu_smm_trigger();
 }
 
+/*
+ * The BSP reaches the next blocking record only after all APs have left
+ * their relocation handler, so this marks the end of SMM relocation.
+ */
+static void bsp_initialize_cpu(void)
+{
+	if (is_smm_enabled()) {
+		timestamp_add_now(TS_MP_SMM_RELOCATED);
+		printk(BIOS_DEBUG, "SMM relocation done %s.\n",
+		       smm_relocation_in_parallel ? "in parallel" : "serially");
+	}
+
+	mp_initialize_cpu();
+}
+
 static struct mp_callback *ap_callbacks[CONFIG_MAX_CPUS];
 
 static struct mp_callback *read_callback(struct mp_callback **slot)
@@ -995,13 +1130,181 @@ int mp_park_aps(void)
 	return ret;
 }
 
+/*
+ * Job queue spread over per-cpu deques. Each cpu pops jobs from the head of
+ * its own deque and, once that runs dry, steals from the tail of the other
+ * cpus' deques. The job array pointer is kept inside each deque so that a
+ * late AP which only enters the worker after the batch has completed can
+ * never pick up a stale job.
+ */
+struct mp_job_deque {
+	spinlock_t lock;
+	struct mp_job *jobs;
+	size_t head;
+	size_t tail;
+};
+
+static struct mp_job_deque job_deques[CONFIG_MAX_CPUS] = {
+	[0 ... CONFIG_MAX_CPUS - 1] = { .lock = SPIN_LOCK_UNLOCKED },
+};
+static atomic_t jobs_started;
+static atomic_t jobs_completed;
+static size_t jobs_queued;
+static int job_num_cpus;
+
+static struct mp_job *pop_job(struct mp_job_deque *dq, int steal)
+{
+	struct mp_job *job = NULL;
+
+	spin_lock(&dq->lock);
+	if (dq->head < dq->tail) {
+		if (steal)
+			job = &dq->jobs[--dq->tail];
+		else
+			job = &dq->jobs[dq->head++];
+		/* Counted under the lock, see withdraw_jobs(). */
+		atomic_inc(&jobs_started);
+	}
+	spin_unlock(&dq->lock);
+
+	return job;
+}
+
+static struct mp_job *find_job(int cur_cpu)
+{
+	struct mp_job *job;
+	int i;
+
+	job = pop_job(&job_deques[cur_cpu], 0);
+
+	for (i = 1; job == NULL && i < job_num_cpus; i++)
+		job = pop_job(&job_deques[(cur_cpu + i) % job_num_cpus], 1);
+
+	return job;
+}
+
+static void run_jobs(void *unused)
+{
+	struct mp_job *job;
+	int cur_cpu = cpu_index();
+
+	if (cur_cpu >= job_num_cpus)
+		return;
+
+	while ((job = find_job(cur_cpu)) != NULL) {
+		job->func(job->arg);
+		atomic_inc(&jobs_completed);
+	}
+}
+
+/*
+ * Drop the jobs no cpu has started yet. Once this returns, every job that
+ * was popped before is counted in jobs_started.
+ */
+static void withdraw_jobs(void)
+{
+	int i;
+
+	for (i = 0; i < job_num_cpus; i++) {
+		spin_lock(&job_deques[i].lock);
+		job_deques[i].head = job_deques[i].tail;
+		spin_unlock(&job_deques[i].lock);
+	}
+}
+
+static int jobs_parallel(void)
+{
+	return IS_ENABLED(CONFIG_PARALLEL_MP_AP_WORK) && global_num_aps > 0;
+}
+
+int mp_queue_jobs(struct mp_job *jobs, size_t num_jobs, long expire_us)
+{
+	size_t per_cpu, start;
+	int i;
+
+	if (!jobs_parallel()) {
+		for (start = 0; start < num_jobs; start++)
+			jobs[start].func(jobs[start].arg);
+		return 0;
+	}
+
+	job_num_cpus = MIN(global_num_aps + 1, ARRAY_SIZE(job_deques));
+	jobs_queued = num_jobs;
+	atomic_set(&jobs_started, 0);
+	atomic_set(&jobs_completed, 0);
+
+	/* Distribute the jobs evenly. The first cpus take the remainder. */
+	per_cpu = num_jobs / job_num_cpus;
+	start = 0;
+	for (i = 0; i < job_num_cpus; i++) {
+		struct mp_job_deque *dq = &job_deques[i];
+		size_t count = per_cpu + (i < num_jobs % job_num_cpus);
+
+		spin_lock(&dq->lock);
+		dq->jobs = jobs;
+		dq->head = start;
+		dq->tail = start + count;
+		spin_unlock(&dq->lock);
+
+		start += count;
+	}
+
+	if (mp_run_on_aps(run_jobs, NULL, MP_RUN_ON_ALL_CPUS, expire_us) < 0) {
+		printk(BIOS_ERR, "Not all APs picked up the job queue.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int mp_wait_jobs(long expire_us)
+{
+	struct stopwatch sw;
+
+	if (!jobs_parallel())
+		return 0;
+
+	if (expire_us > 0)
+		stopwatch_init_usecs_expire(&sw, expire_us);
+
+	/* The BSP works through the remaining jobs as well. */
+	run_jobs(NULL);
+
+	while (atomic_read(&jobs_completed) != jobs_queued) {
+		if (expire_us > 0 && stopwatch_expired(&sw)) {
+			printk(BIOS_ERR, "AP jobs expired. %d/%zu jobs done.\n",
+			       atomic_read(&jobs_completed), jobs_queued);
+			/*
+			 * The running jobs still use the caller's jobs array
+			 * and whatever their args point to, let them finish.
+			 */
+			withdraw_jobs();
+			while (atomic_read(&jobs_completed) !=
+			       atomic_read(&jobs_started))
+				asm ("pause");
+			return -1;
+		}
+		asm ("pause");
+	}
+
+	return 0;
+}
+
+int mp_run_jobs(struct mp_job *jobs, size_t num_jobs, long expire_us)
+{
+	/* Even if not all APs joined in, the ones that did finish the jobs. */
+	mp_queue_jobs(jobs, num_jobs, expire_us);
+
+	return mp_wait_jobs(expire_us);
+}
+
 static struct mp_flight_record mp_steps[] = {
 	/* Once the APs are up load the SMM handlers. */
 	MP_FR_BLOCK_APS(NULL, load_smm_handlers),
 	/* Perform SMM relocation. */
 	MP_FR_NOBLOCK_APS(trigger_smm_relocation, trigger_smm_relocation),
 	/* Initialize each CPU through the driver framework. */
-	MP_FR_BLOCK_APS(mp_initialize_cpu, mp_initialize_cpu),
+	MP_FR_BLOCK_APS(mp_initialize_cpu, bsp_initialize_cpu),
 	/* Wait for APs to finish then optionally start looking for work. */
 	MP_FR_BLOCK_APS(ap_wait_for_instruction, NULL),
 };
@@ -1021,6 +1324,11 @@ static void fill_mp_state(struct mp_state *state, const struct mp_ops *ops)
 		ops->get_smm_info(&state->perm_smbase, &state->perm_smsize,
 					&state->smm_save_state_size);
 
+	if (ops->get_msr_settings != NULL) {
+		ops->get_msr_settings(&msr_table.settings, &msr_table.count);
+		fill_msr_table_topology();
+	}
+
 	/*
 	 * Default to smm_initiate_relocation() if trigger callback isn't
 	 * provided.
@@ -1071,6 +1379,10 @@ int mp_init_with_smm(struct bus *cpu_bus, const struct mp_ops *mp_ops)
 
 	restore_default_smm_area(default_smm_area);
 
+	if (atomic_read(&msr_table.failures))
+		printk(BIOS_ERR, "%d MSR settings didn't stick.\n",
+		       atomic_read(&msr_table.failures));
+
 	/* Signal callback on success if it's provided. */
 	if (ret == 0 && mp_state.ops.post_mp_init != NULL)
 		mp_state.ops.post_mp_init();
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <bootstate.h>
+#include <cbmem.h>
 #include <console/console.h>
 #include <device/device.h>
 #include <device/pci_ids.h>
@@ -157,8 +158,12 @@ static int filter_vga_wrcomb(struct device *dev, struct resource *res)
 	if (dev->path.type != DEVICE_PATH_PCI)
 		return 0;
 
-	/* Only handle VGA class devices. */
-	if (((dev->class >> 8) != PCI_CLASS_DISPLAY_VGA))
+	/*
+	 * Handle all display class devices. Not every framebuffer sits behind
+	 * a VGA compatible controller, and an uncached framebuffer makes the
+	 * console painfully slow.
+	 */
+	if ((dev->class >> 16) != PCI_BASE_CLASS_DISPLAY)
 		return 0;
 
 	/* Add resource as write-combining in the address space. */
@@ -540,10 +545,87 @@ static uint32_t optimize_var_mtrr_hole(const uint32_t base,
 	return best_end;
 }
 
+static int count_var_mtrr_range(uint32_t base, uint32_t size)
+{
+	const int dont_care = 0;
+	struct var_mtrr_state var_state = { 0, };
+
+	calc_var_mtrr_range(&var_state, base, size, dont_care);
+
+	return var_state.mtrr_index;
+}
+
+static struct range_entry *prev_range_entry(struct memranges *addr_space,
+					    struct range_entry *r)
+{
+	struct range_entry *cur, *prev = NULL;
+
+	memranges_each_entry(cur, addr_space) {
+		if (cur == r)
+			break;
+		prev = cur;
+	}
+
+	return prev;
+}
+
+static uint32_t optimize_var_mtrr_low_hole(const uint32_t base,
+					   const uint32_t hole,
+					   const uint32_t limit,
+					   uint32_t *end,
+					   const uint64_t end_limit,
+					   const int carve_end)
+{
+	/*
+	 * The mirror image of optimize_var_mtrr_hole(): a WB range with an
+	 * unaligned lower end may also be cheaper to describe by aligning
+	 * `base` down and carving the added hole below it out with UC. The
+	 * lower end may move down to `limit`, which is chosen by the caller
+	 * so that only UC memory is carved out. The upper end is optimized
+	 * again for each lower end since the best alignment depends on both.
+	 * Returns the lower end to use and updates `end` to match it.
+	 */
+	unsigned int align;
+	uint32_t best_base = base;
+	uint32_t best_end = *end;
+	int best_count;
+
+	best_count = count_var_mtrr_range(base, best_end - base);
+	if (carve_end && best_end != hole)
+		best_count += count_var_mtrr_range(hole, best_end - hole);
+
+	for (align = fls(base) + 1; base != 0 && align < 32; ++align) {
+		const uint32_t low = ALIGN_DOWN(base, 1U << align);
+		uint32_t high;
+		int count;
+
+		if (low < limit)
+			break;
+
+		high = optimize_var_mtrr_hole(low, hole, end_limit, carve_end);
+		count = count_var_mtrr_range(low, high - low) +
+			count_var_mtrr_range(low, base - low);
+		if (carve_end && high != hole)
+			count += count_var_mtrr_range(hole, high - hole);
+
+		if (count < best_count) {
+			best_count = count;
+			best_base = low;
+			best_end = high;
+		}
+
+		if (low == 0)
+			break;
+	}
+
+	*end = best_end;
+	return best_base;
+}
+
 static void calc_var_mtrrs_with_hole(struct var_mtrr_state *var_state,
 				     struct range_entry *r)
 {
-	uint32_t a1, a2, b1, b2;
+	uint32_t a0, a1, a2, b1, b2;
 	int mtrr_type, carve_hole;
 
 	/*
@@ -553,8 +635,10 @@ static void calc_var_mtrrs_with_hole(struct var_mtrr_state *var_state,
 	 * +------------------+ a2 = b1 = original end
 	 * |                  |
 	 * +------------------+ a1 = begin
+	 * |  0 or more bytes | <-- hole is carved out between a0 and a1
+	 * +------------------+ a0 = ALIGN_DOWN(begin)
 	 *
-	 * Thus, there are up to 2 sub-ranges to configure variable MTRRs for.
+	 * Thus, there are up to 3 sub-ranges to configure variable MTRRs for.
 	 */
 	mtrr_type = range_entry_mtrr_type(r);
 
@@ -581,6 +665,7 @@ static void calc_var_mtrrs_with_hole(struct var_mtrr_state *var_state,
 	if (!var_state->above4gb && a2 > RANGE_4GB)
 		a2 = RANGE_4GB;
 
+	a0 = a1;
 	b1 = a2;
 	b2 = a2;
 	carve_hole = 0;
@@ -589,6 +674,7 @@ static void calc_var_mtrrs_with_hole(struct var_mtrr_state *var_state,
 	if (mtrr_type == MTRR_TYPE_WRBACK) {
 		struct range_entry *next;
 		uint64_t b2_limit;
+		uint32_t a0_limit;
 		/*
 		 * Depending on the type of the next range, there are three
 		 * different situations to handle:
@@ -625,9 +711,28 @@ static void calc_var_mtrrs_with_hole(struct var_mtrr_state *var_state,
 			carve_hole = 1;
 		}
 		b2 = optimize_var_mtrr_hole(a1, b1, b2_limit, carve_hole);
+
+		/*
+		 * The lower end may only be aligned down over UC memory: the
+		 * gap to the previous range, which is UC by default, and the
+		 * previous range itself if it is UC.
+		 */
+		next = prev_range_entry(var_state->addr_space, r);
+		if (next == NULL)
+			a0_limit = 0;
+		else if (range_entry_mtrr_type(next) == MTRR_TYPE_UNCACHEABLE)
+			a0_limit = range_entry_base_mtrr_addr(next);
+		else
+			a0_limit = range_entry_end_mtrr_addr(next);
+		a0 = optimize_var_mtrr_low_hole(a1, b1, a0_limit, &b2,
+						b2_limit, carve_hole);
 	}
 
-	calc_var_mtrr_range(var_state, a1, b2 - a1, mtrr_type);
+	calc_var_mtrr_range(var_state, a0, b2 - a0, mtrr_type);
+	if (a0 != a1) {
+		calc_var_mtrr_range(var_state, a0, a1 - a0,
+				    MTRR_TYPE_UNCACHEABLE);
+	}
 	if (carve_hole && b2 != b1) {
 		calc_var_mtrr_range(var_state, b1, b2 - b1,
 				    MTRR_TYPE_UNCACHEABLE);
@@ -768,19 +873,76 @@ static int commit_var_mtrrs(const struct var_mtrr_solution *sol)
 	return 0;
 }
 
+/*
+ * The solution of the normal boot path is kept in cbmem so that the S3
+ * resume path can reapply it without recalculating it. The address space
+ * parameters are stored along with it to only reuse a matching solution.
+ */
+struct var_mtrr_cache {
+	unsigned int address_bits;
+	unsigned int above4gb;
+	struct var_mtrr_solution sol;
+};
+
+static int load_cached_solution(struct var_mtrr_solution *sol,
+				unsigned int address_bits,
+				unsigned int above4gb)
+{
+	const struct var_mtrr_cache *cache;
+
+	if (!acpi_is_wakeup_s3())
+		return -1;
+
+	cache = cbmem_find(CBMEM_ID_MTRR);
+	if (cache == NULL || cache->address_bits != address_bits ||
+	    cache->above4gb != above4gb)
+		return -1;
+
+	memcpy(sol, &cache->sol, sizeof(*sol));
+	printk(BIOS_DEBUG, "MTRR: Using solution cached in cbmem.\n");
+
+	return 0;
+}
+
+static void save_cached_solution(const struct var_mtrr_solution *sol,
+				 unsigned int address_bits,
+				 unsigned int above4gb)
+{
+	struct var_mtrr_cache *cache;
+
+	if (acpi_is_wakeup_s3())
+		return;
+
+	cache = cbmem_add(CBMEM_ID_MTRR, sizeof(*cache));
+	if (cache == NULL)
+		return;
+
+	cache->address_bits = address_bits;
+	cache->above4gb = above4gb;
+	memcpy(&cache->sol, sol, sizeof(*sol));
+}
+
 void x86_setup_var_mtrrs(unsigned int address_bits, unsigned int above4gb)
 {
 	static struct var_mtrr_solution *sol = NULL;
 	struct memranges *addr_space;
 
-	addr_space = get_physical_address_space();
-
 	if (sol == NULL) {
 		sol = &mtrr_global_solution;
-		sol->mtrr_default_type =
-			calc_var_mtrrs(addr_space, !!above4gb, address_bits);
-		prepare_var_mtrrs(addr_space, sol->mtrr_default_type,
-				  !!above4gb, address_bits, sol);
+		above4gb = !!above4gb;
+
+		if (load_cached_solution(sol, address_bits, above4gb) < 0) {
+			addr_space = get_physical_address_space();
+			sol->mtrr_default_type = calc_var_mtrrs(addr_space,
+						above4gb, address_bits);
+			prepare_var_mtrrs(addr_space, sol->mtrr_default_type,
+					  above4gb, address_bits, sol);
+			save_cached_solution(sol, address_bits, above4gb);
+		}
+
+		printk(BIOS_DEBUG, "MTRR: %d of %d variable MTRRs used, "
+		       "%d left for the OS.\n", sol->num_used, total_mtrrs,
+		       MAX(total_mtrrs - sol->num_used, 0));
 	}
 
 	commit_var_mtrrs(sol);
@@ -430,3 +430,84 @@ int paging_identity_map_addr(uintptr_t base, size_t size, int pat)
 
 	return _paging_identity_map_addr(base, size, pat, 1);
 }
+
+#define PML4E_IDX_SHIFT 39
+#define LONG_ENTRIES 512
+#define LONG_MAX_LIMIT (1ULL << (PML4E_IDX_SHIFT + 9))
+
+int paging_has_1g_pages(void)
+{
+	if (cpuid_eax(0x80000000) < 0x80000001)
+		return 0;
+
+	/* CPUID.80000001H:EDX.Page1GB[bit 26] */
+	return !!(cpuid_edx(0x80000001) & (1 << 26));
+}
+
+size_t paging_long_tables_size(uint64_t limit)
+{
+	size_t num_pdpt = DIV_ROUND_UP(limit, 1ULL << PML4E_IDX_SHIFT);
+	size_t num_pd = 0;
+
+	if (!paging_has_1g_pages())
+		num_pd = DIV_ROUND_UP(limit, 1ULL << PDPTE_IDX_SHIFT);
+
+	return (1 + num_pdpt + num_pd) * s4KiB;
+}
+
+int paging_identity_map_long(void *pgtbl, size_t size, uint64_t limit,
+			     uintptr_t *cr3)
+{
+	const uint64_t table_flags = PDPTE_PRES | PDE_RW;
+	const uint64_t page_flags = pde_page_flags(PAT_WB);
+	uint64_t (*pml4)[LONG_ENTRIES] = pgtbl;
+	uint64_t (*pdpt)[LONG_ENTRIES];
+	uint64_t (*pd)[LONG_ENTRIES];
+	uint64_t addr;
+	int use_1g = paging_has_1g_pages();
+
+	if (!IS_ALIGNED((uintptr_t)pgtbl, s4KiB) || limit == 0 ||
+	    limit > LONG_MAX_LIMIT) {
+		printk(BIOS_ERR, "Invalid long mode page table parameters.\n");
+		return -1;
+	}
+
+	if (size < paging_long_tables_size(limit)) {
+		printk(BIOS_ERR, "Long mode page tables need %zx bytes: %zx\n",
+		       paging_long_tables_size(limit), size);
+		return -1;
+	}
+
+	memset(pgtbl, 0, paging_long_tables_size(limit));
+
+	/* The PDPTs follow the PML4 and the PDs, if any, follow the PDPTs. */
+	pdpt = (void *)&pml4[1];
+	pd = (void *)&pdpt[DIV_ROUND_UP(limit, 1ULL << PML4E_IDX_SHIFT)];
+
+	for (addr = 0; addr < limit; addr += 1ULL << PDPTE_IDX_SHIFT) {
+		size_t pml4e = addr >> PML4E_IDX_SHIFT;
+		size_t pdpte = (addr >> PDPTE_IDX_SHIFT) % LONG_ENTRIES;
+		uint64_t (*cur_pdpt)[LONG_ENTRIES] = &pdpt[pml4e];
+		size_t i;
+
+		(*pml4)[pml4e] = (uintptr_t)cur_pdpt | table_flags;
+
+		if (use_1g) {
+			(*cur_pdpt)[pdpte] = addr | page_flags;
+			continue;
+		}
+
+		/* Without 1GiB pages each 1GiB is mapped by a PD of 2MiB
+		 * pages. */
+		(*cur_pdpt)[pdpte] = (uintptr_t)pd | table_flags;
+		for (i = 0; i < LONG_ENTRIES; i++)
+			(*pd)[i] = (addr + i * s2MiB) | page_flags;
+		pd++;
+	}
+
+	printk(BIOS_DEBUG, "Identity mapped 0x%llx bytes with %s pages.\n",
+	       (unsigned long long)limit, use_1g ? "1GiB" : "2MiB");
+
+	*cr3 = (uintptr_t)pgtbl;
+	return 0;
+}
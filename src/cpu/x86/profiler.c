@@ -0,0 +1,168 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <cbmem.h>
+#include <commonlib/helpers.h>
+#include <commonlib/profile_serialized.h>
+#include <console/console.h>
+#include <cpu/x86/lapic.h>
+#include <cpu/x86/profiler.h>
+#include <delay.h>
+#include <string.h>
+#include <symbols.h>
+#include <timer.h>
+
+/* Buckets are at least four bytes, about an instruction. */
+#define MIN_BUCKET_SHIFT	2
+
+/* NULL while not sampling. */
+static struct profile_histogram *histogram;
+static uint32_t timer_ticks;
+
+void profiler_sample(uintptr_t ip)
+{
+	struct profile_histogram *hist = histogram;
+
+	if (hist) {
+		uintptr_t offset = ip - (uintptr_t)hist->text_start;
+
+		if (ip >= hist->text_start &&
+		    (offset >> hist->shift) < hist->num_buckets)
+			hist->buckets[offset >> hist->shift]++;
+		else
+			hist->outside++;
+		hist->samples++;
+	}
+
+	lapic_write(LAPIC_EOI, 0);
+}
+
+static void timer_arm(void)
+{
+	enable_lapic();
+	lapic_write(LAPIC_TASKPRI,
+		    lapic_read(LAPIC_TASKPRI) & ~LAPIC_TPRI_MASK);
+	lapic_write(LAPIC_SPIV, (lapic_read(LAPIC_SPIV) & ~LAPIC_VECTOR_MASK) |
+		    LAPIC_SPIV_ENABLE | PROFILER_VECTOR);
+
+	lapic_write(LAPIC_TDCR, LAPIC_TDR_DIV_1);
+	lapic_write(LAPIC_LVTT, LAPIC_LVT_TIMER_PERIODIC | PROFILER_VECTOR);
+	lapic_write(LAPIC_TMICT, timer_ticks);
+}
+
+static void timer_disarm(void)
+{
+	lapic_write(LAPIC_LVTT, LAPIC_LVT_MASKED);
+	lapic_write(LAPIC_TMICT, 0);
+}
+
+/* Returns the LAPIC timer ticks between two samples. */
+static uint32_t timer_calibrate(void)
+{
+	uint32_t start, ticks;
+
+	enable_lapic();
+	lapic_write(LAPIC_SPIV, lapic_read(LAPIC_SPIV) | LAPIC_SPIV_ENABLE);
+	lapic_write(LAPIC_LVTT, LAPIC_LVT_MASKED);
+	lapic_write(LAPIC_TDCR, LAPIC_TDR_DIV_1);
+	lapic_write(LAPIC_TMICT, 0xffffffff);
+
+	/* The timer counts down. */
+	start = lapic_read(LAPIC_TMCCT);
+	udelay(1000);
+	ticks = start - lapic_read(LAPIC_TMCCT);
+
+	lapic_write(LAPIC_TMICT, 0);
+
+	return (uint64_t)ticks * MSECS_PER_SEC / CONFIG_SAMPLING_PROFILER_HZ;
+}
+
+void profiler_pause(void)
+{
+	if (histogram)
+		timer_disarm();
+}
+
+void profiler_resume(void)
+{
+	if (histogram)
+		timer_arm();
+}
+
+static void profiler_start(void *unused)
+{
+	struct profile_histogram *hist;
+	size_t size = _program_size;
+	unsigned int shift = MIN_BUCKET_SHIFT;
+	size_t num;
+
+	while (DIV_ROUND_UP(size, 1 << shift) >
+	       CONFIG_SAMPLING_PROFILER_BUCKETS)
+		shift++;
+	num = DIV_ROUND_UP(size, 1 << shift);
+
+	hist = cbmem_add(CBMEM_ID_PROFILE,
+			 sizeof(*hist) + num * sizeof(hist->buckets[0]));
+	if (!hist) {
+		printk(BIOS_ERR, "Profiler: no room for the histogram\n");
+		return;
+	}
+
+	memset(hist, 0, sizeof(*hist) + num * sizeof(hist->buckets[0]));
+	hist->text_start = (uintptr_t)_program;
+	hist->shift = shift;
+	hist->num_buckets = num;
+	hist->hz = CONFIG_SAMPLING_PROFILER_HZ;
+
+	timer_ticks = timer_calibrate();
+	if (!timer_ticks) {
+		printk(BIOS_ERR, "Profiler: LAPIC timer is not running\n");
+		return;
+	}
+
+	printk(BIOS_INFO, "Profiler: %d samples per second into %zu "
+	       "buckets of %d bytes\n", CONFIG_SAMPLING_PROFILER_HZ, num,
+	       1 << shift);
+
+	histogram = hist;
+	timer_arm();
+	asm volatile ("sti" ::: "memory");
+}
+
+/* CPU init may have reprogrammed the LAPIC of the BSP. */
+static void profiler_rearm(void *unused)
+{
+	profiler_resume();
+}
+
+static void profiler_stop(void *unused)
+{
+	struct profile_histogram *hist = histogram;
+
+	if (!hist)
+		return;
+
+	asm volatile ("cli" ::: "memory");
+	timer_disarm();
+	histogram = NULL;
+
+	printk(BIOS_INFO, "Profiler: %u samples, %u outside of ramstage\n",
+	       hist->samples, hist->outside);
+}
+
+/* exception_init() has set up the IDT by the first boot state. */
+BOOT_STATE_INIT_ENTRY(BS_PRE_DEVICE, BS_ON_ENTRY, profiler_start, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, profiler_rearm, NULL);
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, profiler_stop, NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, profiler_stop, NULL);
@@ -17,7 +17,10 @@
 #include <compiler.h>
 #include <console/console.h>
 #include <cpu/x86/smm.h>
+#include <cpu/x86/tsc.h>
+#include <lib.h>
 #include <rmodule.h>
+#include <string.h>
 
 #if IS_ENABLED(CONFIG_SPI_FLASH_SMM)
 #include <spi-generic.h>
@@ -104,6 +107,60 @@ static void smi_restore_pci_address(void)
 
 static const struct smm_runtime *smm_runtime;
 
+/* Each CPU only ever updates its own histogram, so no locking is needed. */
+static struct smm_latency_hist latency_hist[CONFIG_MAX_CPUS];
+
+static inline uint64_t smm_latency_start(void)
+{
+	if (!IS_ENABLED(CONFIG_SMM_LATENCY_HISTOGRAM))
+		return 0;
+
+	return tsc_to_uint64(rdtsc());
+}
+
+static inline void smm_latency_stop(int cpu, uint64_t start)
+{
+	struct smm_latency_hist *hist;
+	uint64_t delta;
+	int bucket;
+
+	if (!IS_ENABLED(CONFIG_SMM_LATENCY_HISTOGRAM))
+		return;
+
+	delta = tsc_to_uint64(rdtsc()) - start;
+	hist = &latency_hist[cpu];
+
+	if (delta >> 32)
+		bucket = SMM_LATENCY_BUCKETS - 1;
+	else
+		bucket = MAX(log2(delta), 0);
+
+	hist->bucket[bucket]++;
+	hist->count++;
+	if (delta > hist->max)
+		hist->max = delta;
+}
+
+size_t smm_latency_export(void *buf, size_t size)
+{
+	int cpu;
+
+	if (!IS_ENABLED(CONFIG_SMM_LATENCY_HISTOGRAM))
+		return 0;
+
+	for (cpu = 0; cpu < CONFIG_MAX_CPUS; cpu++) {
+		if (!latency_hist[cpu].count)
+			continue;
+		printk(BIOS_DEBUG, "SMI latency CPU%d: %u SMIs, max %llu ticks\n",
+		       cpu, latency_hist[cpu].count, latency_hist[cpu].max);
+	}
+
+	size = MIN(size, sizeof(latency_hist));
+	memcpy(buf, latency_hist, size);
+
+	return size;
+}
+
 void *smm_get_save_state(int cpu)
 {
 	char *base;
@@ -124,6 +181,9 @@ asmlinkage void smm_handler_start(void *arg)
 	int cpu;
 	uintptr_t actual_canary;
 	uintptr_t expected_canary;
+	uint64_t start;
+
+	start = smm_latency_start();
 
 	p = arg;
 	runtime = p->runtime;
@@ -151,6 +211,7 @@ asmlinkage void smm_handler_start(void *arg)
 				".byte 0xf3, 0x90\n" /* PAUSE */
 			);
 		}
+		smm_latency_stop(cpu, start);
 		return;
 	}
 
@@ -189,6 +250,8 @@ asmlinkage void smm_handler_start(void *arg)
 
 	/* De-assert SMI# signal to allow another SMI */
 	smi_set_eos();
+
+	smm_latency_stop(cpu, start);
 }
 
 RMODULE_ENTRY(smm_handler_start);
@@ -11,6 +11,7 @@
  * GNU General Public License for more details.
  */
 
+#include <arch/cpu.h>
 #include <arch/early_variables.h>
 #include <console/console.h>
 #include <arch/io.h>
@@ -96,12 +97,42 @@ bad_ctc:
 	return 0;
 }
 
+/*
+ * Newer Intel CPUs report the TSC frequency in CPUID leaf 0x15 as a ratio to
+ * the crystal clock, or at least their base frequency (which the TSC runs
+ * at) in leaf 0x16. Returns 0 if neither is available.
+ */
+static unsigned long tsc_freq_from_cpuid(void)
+{
+	struct cpuid_result res;
+	unsigned int max_leaf = cpuid_eax(0);
+
+	if (max_leaf >= 0x15) {
+		res = cpuid(0x15);
+		/* eax: denominator, ebx: numerator, ecx: crystal in Hz */
+		if (res.eax && res.ebx && res.ecx)
+			return (unsigned long)((uint64_t)res.ecx * res.ebx /
+					       res.eax / 1000000);
+	}
+
+	if (max_leaf >= 0x16)
+		return cpuid_eax(0x16) & 0xffff;
+
+	return 0;
+}
+
 static unsigned long calibrate_tsc(void)
 {
+	unsigned long mhz;
+
 	if (IS_ENABLED(CONFIG_TSC_CONSTANT_RATE))
 		return tsc_freq_mhz();
-	else
-		return calibrate_tsc_with_pit();
+
+	mhz = tsc_freq_from_cpuid();
+	if (mhz)
+		return mhz;
+
+	return calibrate_tsc_with_pit();
 }
 
 void init_timer(void)
@@ -116,6 +147,11 @@ static inline unsigned long get_clocks_per_usec(void)
 	return car_get_var(clocks_per_usec);
 }
 
+unsigned long tsc_calibrated_freq_mhz(void)
+{
+	return get_clocks_per_usec();
+}
+
 void udelay(unsigned int us)
 {
 	unsigned long long start;
@@ -21,11 +21,36 @@
 #include <device/azalia_device.h>
 #include <arch/io.h>
 #include <delay.h>
+#include <stdlib.h>
+#include <string.h>
+#include <timer.h>
 
 #define HDA_ICII_REG 0x68
 #define HDA_ICII_BUSY (1 << 0)
 #define HDA_ICII_VALID (1 << 1)
 
+#define HDA_CORBLBASE_REG	0x40
+#define HDA_CORBUBASE_REG	0x44
+#define HDA_CORBWP_REG		0x48
+#define HDA_CORBRP_REG		0x4a
+#define  HDA_CORBRP_RST		(1 << 15)
+#define HDA_CORBCTL_REG		0x4c
+#define HDA_CORBSIZE_REG	0x4e
+#define HDA_RIRBLBASE_REG	0x50
+#define HDA_RIRBUBASE_REG	0x54
+#define HDA_RIRBWP_REG		0x58
+#define  HDA_RIRBWP_RST		(1 << 15)
+#define HDA_RINTCNT_REG		0x5a
+#define HDA_RIRBCTL_REG		0x5c
+#define HDA_RIRBSTS_REG		0x5d
+#define  HDA_RIRBSTS_CLEAR	0x05
+#define HDA_RIRBSIZE_REG	0x5e
+/* Same bits in CORBCTL/RIRBCTL and CORBSIZE/RIRBSIZE */
+#define  HDA_RING_DMA_RUN	(1 << 1)
+#define  HDA_RING_SIZE_256	0x02
+#define  HDA_RING_SIZE_CAP_256	(1 << 6)
+#define HDA_RING_ENTRIES	256
+
 static int set_bits(void *port, u32 mask, u32 val)
 {
 	u32 reg32;
@@ -223,10 +248,230 @@ static void codec_init(struct device *dev, u8 *base, int addr)
 	printk(BIOS_DEBUG, "azalia_audio: verb loaded.\n");
 }
 
+#if IS_ENABLED(CONFIG_AZALIA_CORB_RIRB)
+/*
+ * Instead of waiting for each verb on the immediate command interface, put
+ * all of them in the command output ring buffer (CORB) and let the controller
+ * DMA them out to the codecs, one per link frame. Every verb gets a response
+ * in the response input ring buffer (RIRB), so the RIRB write pointer tells
+ * when the whole batch is done.
+ */
+struct hda_rings {
+	u8 *base;
+	u32 *corb;
+	u32 *rirb;		/* response, extended response (codec address) */
+	u16 corb_wp;		/* last CORB entry written */
+	u16 rirb_wp;		/* RIRB entry the pending responses follow */
+	u32 pending;		/* verbs sent since rirb_wp */
+};
+
+static int wait_for_reg16(u8 *base, int reg, u16 mask, u16 val)
+{
+	struct stopwatch sw;
+
+	stopwatch_init_msecs_expire(&sw, 1);
+	while ((read16(base + reg) & mask) != val) {
+		if (stopwatch_expired(&sw))
+			return -1;
+		udelay(1);
+	}
+	return 0;
+}
+
+static void rings_stop(struct hda_rings *r)
+{
+	write8(r->base + HDA_CORBCTL_REG, 0);
+	write8(r->base + HDA_RIRBCTL_REG, 0);
+	/* The DMA engines may still touch the buffers until they report idle. */
+	if (wait_for_reg16(r->base, HDA_CORBCTL_REG, HDA_RING_DMA_RUN, 0) ||
+	    wait_for_reg16(r->base, HDA_RIRBCTL_REG, HDA_RING_DMA_RUN, 0)) {
+		printk(BIOS_ERR, "azalia_audio: CORB/RIRB DMA didn't stop\n");
+		return;
+	}
+	free(r->corb);
+}
+
+static int rings_start(u8 *base, struct hda_rings *r)
+{
+	const size_t corb_size = HDA_RING_ENTRIES * sizeof(u32);
+	const size_t rirb_size = HDA_RING_ENTRIES * 2 * sizeof(u32);
+
+	if (!(read8(base + HDA_CORBSIZE_REG) & HDA_RING_SIZE_CAP_256) ||
+	    !(read8(base + HDA_RIRBSIZE_REG) & HDA_RING_SIZE_CAP_256))
+		return -1;
+
+	write8(base + HDA_CORBCTL_REG, 0);
+	write8(base + HDA_RIRBCTL_REG, 0);
+	if (wait_for_reg16(base, HDA_CORBCTL_REG, HDA_RING_DMA_RUN, 0) ||
+	    wait_for_reg16(base, HDA_RIRBCTL_REG, HDA_RING_DMA_RUN, 0))
+		return -1;
+
+	/* Both rings need 128-byte alignment. */
+	r->base = base;
+	r->corb = memalign(128, corb_size + rirb_size);
+	r->rirb = r->corb + HDA_RING_ENTRIES;
+	memset(r->corb, 0, corb_size + rirb_size);
+
+	write8(base + HDA_CORBSIZE_REG, HDA_RING_SIZE_256);
+	write32(base + HDA_CORBLBASE_REG, (uintptr_t)r->corb);
+	write32(base + HDA_CORBUBASE_REG, 0);
+	write8(base + HDA_RIRBSIZE_REG, HDA_RING_SIZE_256);
+	write32(base + HDA_RIRBLBASE_REG, (uintptr_t)r->rirb);
+	write32(base + HDA_RIRBUBASE_REG, 0);
+
+	/* Not every controller reads back the reset bit, don't insist. */
+	write16(base + HDA_CORBRP_REG, HDA_CORBRP_RST);
+	wait_for_reg16(base, HDA_CORBRP_REG, HDA_CORBRP_RST, HDA_CORBRP_RST);
+	write16(base + HDA_CORBRP_REG, 0);
+	if (wait_for_reg16(base, HDA_CORBRP_REG, HDA_CORBRP_RST, 0)) {
+		free(r->corb);
+		return -1;
+	}
+	write16(base + HDA_CORBWP_REG, 0);
+	write16(base + HDA_RIRBWP_REG, HDA_RIRBWP_RST);
+	write16(base + HDA_RINTCNT_REG, 0xff);
+	write8(base + HDA_RIRBSTS_REG, HDA_RIRBSTS_CLEAR);
+
+	r->corb_wp = 0;
+	r->rirb_wp = 0;
+	r->pending = 0;
+
+	write8(base + HDA_RIRBCTL_REG, HDA_RING_DMA_RUN);
+	write8(base + HDA_CORBCTL_REG, HDA_RING_DMA_RUN);
+	return 0;
+}
+
+/* Wait for the controller to fetch the CORB entry after the next free one. */
+static int rings_wait_room(struct hda_rings *r, u16 next)
+{
+	struct stopwatch sw;
+
+	write16(r->base + HDA_CORBWP_REG, r->corb_wp);
+
+	stopwatch_init_msecs_expire(&sw, 1);
+	while ((read16(r->base + HDA_CORBRP_REG) & 0xff) == next) {
+		if (stopwatch_expired(&sw)) {
+			printk(BIOS_ERR, "azalia_audio: CORB stalled\n");
+			return -1;
+		}
+		udelay(1);
+	}
+	return 0;
+}
+
+static int rings_send(struct hda_rings *r, const u32 *verbs, u32 count)
+{
+	while (count--) {
+		const u16 next = (r->corb_wp + 1) % HDA_RING_ENTRIES;
+
+		/* Only wait for the controller when the ring is full. */
+		if (next == (read16(r->base + HDA_CORBRP_REG) & 0xff) &&
+		    rings_wait_room(r, next))
+			return -1;
+
+		write32(&r->corb[next], *verbs++);
+		r->corb_wp = next;
+		r->pending++;
+	}
+	write16(r->base + HDA_CORBWP_REG, r->corb_wp);
+	return 0;
+}
+
+/* Wait until every verb sent got its response. */
+static int rings_wait(struct hda_rings *r)
+{
+	const u16 rirb_wp = (r->rirb_wp + r->pending) % HDA_RING_ENTRIES;
+	struct stopwatch sw;
+
+	/* A verb takes one 20.8us link frame, give each one 50us. */
+	stopwatch_init_usecs_expire(&sw, 1000 + 50 * r->pending);
+	while ((read16(r->base + HDA_RIRBWP_REG) & 0xff) != rirb_wp) {
+		write8(r->base + HDA_RIRBSTS_REG, HDA_RIRBSTS_CLEAR);
+		if (stopwatch_expired(&sw)) {
+			printk(BIOS_ERR, "azalia_audio: %u verbs timed out\n",
+			       r->pending);
+			return -1;
+		}
+		udelay(1);
+	}
+
+	r->rirb_wp = rirb_wp;
+	r->pending = 0;
+	return 0;
+}
+
+static int codecs_init_rings(struct device *dev, u8 *base, u32 codec_mask)
+{
+	struct hda_rings r;
+	u32 viddid[3] = { 0 };
+	const u32 *verb;
+	u32 verb_size;
+	u16 command;
+	int i, ret = -1;
+
+	command = pci_read_config16(dev, PCI_COMMAND);
+	pci_write_config16(dev, PCI_COMMAND, command | PCI_COMMAND_MASTER);
+
+	if (rings_start(base, &r)) {
+		pci_write_config16(dev, PCI_COMMAND, command);
+		return -1;
+	}
+
+	/* Ask all codecs for their vendor/device ID at once. */
+	for (i = 2; i >= 0; i--) {
+		const u32 get_viddid = (i << 28) | 0x000f0000;
+
+		if ((codec_mask & (1 << i)) && rings_send(&r, &get_viddid, 1))
+			goto out;
+	}
+	if (rings_wait(&r))
+		goto out;
+	for (i = 1; i < HDA_RING_ENTRIES && i <= r.rirb_wp; i++) {
+		const u32 addr = read32(&r.rirb[2 * i + 1]) & 0xf;
+
+		if (addr < ARRAY_SIZE(viddid))
+			viddid[addr] = read32(&r.rirb[2 * i]);
+	}
+
+	/* Then send all verb tables in one batch. */
+	for (i = 2; i >= 0; i--) {
+		if (!(codec_mask & (1 << i)))
+			continue;
+
+		printk(BIOS_DEBUG, "azalia_audio: Initializing codec #%d\n", i);
+		printk(BIOS_DEBUG, "azalia_audio: codec viddid: %08x\n",
+		       viddid[i]);
+		verb_size = find_verb(dev, viddid[i], &verb);
+		if (!verb_size) {
+			printk(BIOS_DEBUG, "azalia_audio: No verb!\n");
+			continue;
+		}
+		printk(BIOS_DEBUG, "azalia_audio: verb_size: %d\n", verb_size);
+		if (rings_send(&r, verb, verb_size))
+			goto out;
+	}
+	if (rings_wait(&r))
+		goto out;
+
+	printk(BIOS_DEBUG, "azalia_audio: verbs loaded through the CORB.\n");
+	ret = 0;
+out:
+	rings_stop(&r);
+	pci_write_config16(dev, PCI_COMMAND, command);
+	return ret;
+}
+#endif
+
 static void codecs_init(struct device *dev, u8 *base, u32 codec_mask)
 {
 	int i;
 
+#if IS_ENABLED(CONFIG_AZALIA_CORB_RIRB)
+	if (!codecs_init_rings(dev, base, codec_mask))
+		return;
+	printk(BIOS_DEBUG, "azalia_audio: Using the immediate interface.\n");
+#endif
+
 	for (i = 2; i >= 0; i--) {
 		if (codec_mask & (1 << i))
 			codec_init(dev, base, i);
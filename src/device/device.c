@@ -40,6 +40,7 @@
 
 #include <console/console.h>
 #include <arch/io.h>
+#include <bs_times.h>
 #include <device/device.h>
 #include <device/pci_def.h>
 #include <device/pci_ids.h>
@@ -49,6 +50,9 @@
 #if IS_ENABLED(CONFIG_ARCH_X86)
 #include <arch/ebda.h>
 #endif
+#if IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT)
+#include <cpu/x86/mp.h>
+#endif
 #include <timer.h>
 
 /** Pointer to the last device */
@@ -220,6 +224,7 @@ static void read_resources(struct bus *bus)
 
 	/* Walk through all devices and find which resources they need. */
 	for (curdev = bus->children; curdev; curdev = curdev->sibling) {
+		struct mono_time start;
 		struct bus *link;
 
 		if (!curdev->enabled)
@@ -232,7 +237,11 @@ static void read_resources(struct bus *bus)
 			continue;
 		}
 		post_log_path(curdev);
+		bs_times_start(&start);
 		curdev->ops->read_resources(curdev);
+		bs_times_stop(&start, BS_TIMES_READ_RESOURCES, BS_DEV_RESOURCES,
+			      (uintptr_t)curdev->ops->read_resources,
+			      dev_path(curdev));
 
 		/* Read in the resources behind the current device's links. */
 		for (link = curdev->link_list; link; link = link->next)
@@ -300,6 +309,127 @@ static const struct device *largest_resource(struct bus *bus,
 	return state.result_dev;
 }
 
+/*
+ * Picking the resources one by one with largest_resource() walks the whole
+ * bus for every pick. Instead collect the resources of a bus once and sort
+ * them into the same order: largest alignment first, then largest size, and
+ * in the order search_bus_resources() finds them otherwise. The tables are
+ * shared, which works because compute_resources() and allocate_resources()
+ * never recurse while walking them.
+ */
+#define MAX_SORTED_RESOURCES 256
+
+struct resource_ref {
+	const struct device *dev;
+	struct resource *res;
+};
+
+static struct resource_ref sorted_resources[MAX_SORTED_RESOURCES];
+static struct resource_ref merge_resources[MAX_SORTED_RESOURCES];
+
+struct resource_iter {
+	struct bus *bus;
+	unsigned long type_mask;
+	unsigned long type;
+	size_t num;
+	size_t next;
+	int overflow;
+};
+
+static void collect_resource(void *gp, struct device *dev,
+			     struct resource *resource)
+{
+	struct resource_iter *iter = gp;
+
+	if (resource->flags & IORESOURCE_FIXED)
+		return;	/* Skip it. */
+
+	if (iter->num == ARRAY_SIZE(sorted_resources)) {
+		iter->overflow = 1;
+		return;
+	}
+
+	sorted_resources[iter->num].dev = dev;
+	sorted_resources[iter->num].res = resource;
+	iter->num++;
+}
+
+static int resource_before(const struct resource *a, const struct resource *b)
+{
+	return (a->align > b->align) ||
+		((a->align == b->align) && (a->size > b->size));
+}
+
+/* Stable bottom-up merge sort of sorted_resources[0, num). */
+static void sort_resources(size_t num)
+{
+	struct resource_ref *src = sorted_resources;
+	struct resource_ref *dst = merge_resources;
+	struct resource_ref *tmp;
+	size_t width, lo, mid, hi, i, j, k;
+
+	for (width = 1; width < num; width *= 2) {
+		for (lo = 0; lo < num; lo += 2 * width) {
+			mid = MIN(lo + width, num);
+			hi = MIN(lo + 2 * width, num);
+			i = lo;
+			j = mid;
+			for (k = lo; k < hi; k++) {
+				if (i < mid && (j >= hi ||
+				    !resource_before(src[j].res, src[i].res)))
+					dst[k] = src[i++];
+				else
+					dst[k] = src[j++];
+			}
+		}
+		tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if (src != sorted_resources)
+		memcpy(sorted_resources, src, num * sizeof(*src));
+}
+
+static void resource_iter_init(struct resource_iter *iter, struct bus *bus,
+			       unsigned long type_mask, unsigned long type)
+{
+	iter->bus = bus;
+	iter->type_mask = type_mask;
+	iter->type = type;
+	iter->num = 0;
+	iter->next = 0;
+	iter->overflow = 0;
+
+	search_bus_resources(bus, type_mask, type, collect_resource, iter);
+
+	if (iter->overflow)
+		printk(BIOS_DEBUG, "%s: more than %d resources, not sorting\n",
+		       dev_path(bus->dev), MAX_SORTED_RESOURCES);
+	else
+		sort_resources(iter->num);
+}
+
+/*
+ * Return the next resource in allocation order in *result_res, which must
+ * hold the previous one. NULL is returned when there are no more.
+ */
+static const struct device *resource_iter_next(struct resource_iter *iter,
+					       struct resource **result_res)
+{
+	if (iter->overflow)
+		return largest_resource(iter->bus, result_res,
+					iter->type_mask, iter->type);
+
+	if (iter->next == iter->num) {
+		*result_res = NULL;
+		return NULL;
+	}
+
+	*result_res = sorted_resources[iter->next].res;
+	return sorted_resources[iter->next++].dev;
+}
+
 /**
  * This function is the guts of the resource allocator.
  *
@@ -338,6 +468,7 @@ static void compute_resources(struct bus *bus, struct resource *bridge,
 {
 	const struct device *dev;
 	struct resource *resource;
+	struct resource_iter iter;
 	resource_t base;
 	base = round(bridge->base, bridge->align);
 
@@ -389,13 +520,14 @@ static void compute_resources(struct bus *bus, struct resource *bridge,
 
 	/* Remember we haven't found anything yet. */
 	resource = NULL;
+	resource_iter_init(&iter, bus, type_mask, type);
 
 	/*
 	 * Walk through all the resources on the current bus and compute the
 	 * amount of address space taken by them. Take granularity and
 	 * alignment into account.
 	 */
-	while ((dev = largest_resource(bus, &resource, type_mask, type))) {
+	while ((dev = resource_iter_next(&iter, &resource))) {
 
 		/* Size 0 resources can be skipped. */
 		if (!resource->size)
@@ -482,6 +614,7 @@ static void allocate_resources(struct bus *bus, struct resource *bridge,
 {
 	const struct device *dev;
 	struct resource *resource;
+	struct resource_iter iter;
 	resource_t base;
 	base = bridge->base;
 
@@ -492,12 +625,13 @@ static void allocate_resources(struct bus *bus, struct resource *bridge,
 
 	/* Remember we haven't found anything yet. */
 	resource = NULL;
+	resource_iter_init(&iter, bus, type_mask, type);
 
 	/*
 	 * Walk through all the resources on the current bus and allocate them
 	 * address space.
 	 */
-	while ((dev = largest_resource(bus, &resource, type_mask, type))) {
+	while ((dev = resource_iter_next(&iter, &resource))) {
 
 		/* Propagate the bridge limit to the resource register. */
 		if (resource->limit > bridge->limit)
@@ -876,8 +1010,15 @@ static void enable_resources(struct bus *link)
 
 	for (dev = link->children; dev; dev = dev->sibling) {
 		if (dev->enabled && dev->ops && dev->ops->enable_resources) {
+			struct mono_time start;
+
 			post_log_path(dev);
+			bs_times_start(&start);
 			dev->ops->enable_resources(dev);
+			bs_times_stop(&start, BS_TIMES_ENABLE_RESOURCES,
+				      BS_DEV_ENABLE,
+				      (uintptr_t)dev->ops->enable_resources,
+				      dev_path(dev));
 		}
 	}
 
@@ -1130,41 +1271,140 @@ static void init_dev(struct device *dev)
 		return;
 
 	if (!dev->initialized && dev->ops && dev->ops->init) {
+		struct mono_time start;
+		/* This may run on an AP, dev_path() isn't safe there. */
+		char path[DEVICE_PATH_MAX];
 #if IS_ENABLED(CONFIG_HAVE_MONOTONIC_TIMER)
 		struct stopwatch sw;
 		stopwatch_init(&sw);
 #endif
 		if (dev->path.type == DEVICE_PATH_I2C) {
 			printk(BIOS_DEBUG, "smbus: %s[%d]->",
-			       dev_path(dev->bus->dev), dev->bus->link_num);
+			       dev_path_buf(dev->bus->dev, path, sizeof(path)),
+			       dev->bus->link_num);
 		}
 
-		printk(BIOS_DEBUG, "%s init ...\n", dev_path(dev));
+		dev_path_buf(dev, path, sizeof(path));
+		printk(BIOS_DEBUG, "%s init ...\n", path);
 		dev->initialized = 1;
+		bs_times_start(&start);
 		dev->ops->init(dev);
+		bs_times_stop(&start, BS_TIMES_INIT, BS_DEV_INIT,
+			      (uintptr_t)dev->ops->init, path);
 #if IS_ENABLED(CONFIG_HAVE_MONOTONIC_TIMER)
-		printk(BIOS_DEBUG, "%s init finished in %ld usecs\n", dev_path(dev),
+		printk(BIOS_DEBUG, "%s init finished in %ld usecs\n", path,
 			stopwatch_duration_usecs(&sw));
 #endif
 	}
 }
 
-static void init_link(struct bus *link)
+/* Set while the deferred inits are queued, clear if they run on the BSP. */
+static int defer_init;
+
+/*
+ * Devices that have their init deferred to an AP. The whole subtree below
+ * such a device is initialized by the same AP to keep the usual parent
+ * before children ordering.
+ */
+static int init_deferred(struct device *dev)
+{
+	return IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT) && defer_init &&
+		dev->enabled && dev->ops && dev->ops->init_on_ap;
+}
+
+static void init_link(struct bus *link, int on_ap)
 {
 	struct device *dev;
 	struct bus *c_link;
 
 	for (dev = link->children; dev; dev = dev->sibling) {
-		post_code(POST_BS_DEV_INIT);
-		post_log_path(dev);
+		if (!on_ap && init_deferred(dev))
+			continue;
+		if (!on_ap) {
+			post_code(POST_BS_DEV_INIT);
+			post_log_path(dev);
+		}
 		init_dev(dev);
 	}
 
 	for (dev = link->children; dev; dev = dev->sibling) {
+		if (!on_ap && init_deferred(dev))
+			continue;
+		for (c_link = dev->link_list; c_link; c_link = c_link->next)
+			init_link(c_link, on_ap);
+	}
+}
+
+#if IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT)
+static void init_dev_on_ap(void *arg)
+{
+	struct device *dev = arg;
+	struct bus *link;
+
+	init_dev(dev);
+	for (link = dev->link_list; link; link = link->next)
+		init_link(link, 1);
+}
+
+static size_t collect_deferred(struct bus *link, struct mp_job *jobs)
+{
+	struct device *dev;
+	struct bus *c_link;
+	size_t count = 0;
+
+	for (dev = link->children; dev; dev = dev->sibling) {
+		if (init_deferred(dev)) {
+			if (jobs) {
+				jobs[count].func = init_dev_on_ap;
+				jobs[count].arg = dev;
+			}
+			count++;
+			continue;
+		}
 		for (c_link = dev->link_list; c_link; c_link = c_link->next)
-			init_link(c_link);
+			count += collect_deferred(c_link, jobs ? &jobs[count] :
+						  NULL);
+	}
+
+	return count;
+}
+
+static struct mp_job *deferred_jobs;
+
+static size_t queue_deferred_init(void)
+{
+	struct mp_job *jobs;
+	struct bus *link;
+	size_t count = 0;
+
+	defer_init = 1;
+	for (link = dev_root.link_list; link; link = link->next)
+		count += collect_deferred(link, NULL);
+
+	if (count == 0) {
+		defer_init = 0;
+		return 0;
+	}
+
+	jobs = malloc(count * sizeof(*jobs));
+	if (jobs == NULL) {
+		printk(BIOS_ERR, "No memory for the AP init jobs, "
+		       "initializing all devices on the BSP\n");
+		defer_init = 0;
+		return 0;
 	}
+
+	deferred_jobs = jobs;
+	count = 0;
+	for (link = dev_root.link_list; link; link = link->next)
+		count += collect_deferred(link, &jobs[count]);
+
+	printk(BIOS_DEBUG, "Running %zu device inits on APs\n", count);
+	mp_queue_jobs(jobs, count, 0);
+
+	return count;
 }
+#endif
 
 /**
  * Initialize all devices in the global device tree.
@@ -1175,6 +1415,9 @@ static void init_link(struct bus *link)
 void dev_initialize(void)
 {
 	struct bus *link;
+#if IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT)
+	size_t num_jobs;
+#endif
 
 	printk(BIOS_INFO, "Initializing devices...\n");
 
@@ -1191,11 +1434,26 @@ void dev_initialize(void)
 	/* First call the mainboard init. */
 	init_dev(&dev_root);
 
+#if IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT)
+	/* Hand the opted-in devices to the APs before doing the rest. */
+	num_jobs = queue_deferred_init();
+#endif
+
 	/* Now initialize everything. */
 	for (link = dev_root.link_list; link; link = link->next)
-		init_link(link);
+		init_link(link, 0);
 	post_log_clear();
 
+#if IS_ENABLED(CONFIG_PARALLEL_DEVICE_INIT)
+	/* Join the inits done on APs. */
+	if (num_jobs) {
+		mp_wait_jobs(0);
+		free(deferred_jobs);
+		deferred_jobs = NULL;
+		defer_init = 0;
+	}
+#endif
+
 	printk(BIOS_INFO, "Devices initialized\n");
 	show_all_devs(BIOS_SPEW, "After init.");
 }
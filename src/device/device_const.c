@@ -37,18 +37,31 @@ DEVTREE_CONST struct device * DEVTREE_CONST all_devices = &dev_root;
 DEVTREE_CONST struct device *dev_find_slot(unsigned int bus,
 						unsigned int devfn)
 {
-	DEVTREE_CONST struct device *dev, *result;
+	DEVTREE_CONST struct device *dev;
+	unsigned int slot = PCI_SLOT(devfn);
+	unsigned int i;
+
+	/*
+	 * Most lookups hit a static device, look in the table sconfig made
+	 * first. It is bucketed by the devfn from devicetree.cb though, and
+	 * HT enumeration moves static devices to other devfns at runtime.
+	 */
+	for (i = static_pci_slot_index[slot];
+	     i < static_pci_slot_index[slot + 1]; i++) {
+		dev = static_pci_devs[i];
+		if ((dev->bus->secondary == bus) &&
+		    (dev->path.pci.devfn == devfn))
+			return dev;
+	}
 
-	result = 0;
+	/* So on a miss, walk the whole list like before. */
 	for (dev = all_devices; dev; dev = dev->next) {
 		if ((dev->path.type == DEVICE_PATH_PCI) &&
 		    (dev->bus->secondary == bus) &&
-		    (dev->path.pci.devfn == devfn)) {
-			result = dev;
-			break;
-		}
+		    (dev->path.pci.devfn == devfn))
+			return dev;
 	}
-	return result;
+	return 0;
 }
 
 /**
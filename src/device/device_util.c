@@ -157,79 +157,77 @@ u32 dev_path_encode(const struct device *dev)
 }
 
 /*
- * Warning: This function uses a static buffer. Don't call it more than once
- * from the same print statement!
+ * Format the path of dev into buffer, which holds size bytes. Unlike
+ * dev_path(), this is safe on several CPUs at once.
  */
-const char *dev_path(const struct device *dev)
+const char *dev_path_buf(const struct device *dev, char *buffer, size_t size)
 {
-	static char buffer[DEVICE_PATH_MAX];
-
 	buffer[0] = '\0';
 	if (!dev) {
-		memcpy(buffer, "<null>", 7);
+		snprintf(buffer, size, "<null>");
 	} else {
 		switch(dev->path.type) {
 		case DEVICE_PATH_NONE:
-			memcpy(buffer, "NONE", 5);
+			snprintf(buffer, size, "NONE");
 			break;
 		case DEVICE_PATH_ROOT:
-			memcpy(buffer, "Root Device", 12);
+			snprintf(buffer, size, "Root Device");
 			break;
 		case DEVICE_PATH_PCI:
-			snprintf(buffer, sizeof(buffer),
+			snprintf(buffer, size,
 				 "PCI: %02x:%02x.%01x",
 				 dev->bus->secondary,
 				 PCI_SLOT(dev->path.pci.devfn),
 				 PCI_FUNC(dev->path.pci.devfn));
 			break;
 		case DEVICE_PATH_PNP:
-			snprintf(buffer, sizeof(buffer), "PNP: %04x.%01x",
+			snprintf(buffer, size, "PNP: %04x.%01x",
 				 dev->path.pnp.port, dev->path.pnp.device);
 			break;
 		case DEVICE_PATH_I2C:
-			snprintf(buffer, sizeof(buffer), "I2C: %02x:%02x",
+			snprintf(buffer, size, "I2C: %02x:%02x",
 				 dev->bus->secondary,
 				 dev->path.i2c.device);
 			break;
 		case DEVICE_PATH_APIC:
-			snprintf(buffer, sizeof(buffer), "APIC: %02x",
+			snprintf(buffer, size, "APIC: %02x",
 				 dev->path.apic.apic_id);
 			break;
 		case DEVICE_PATH_IOAPIC:
-			snprintf(buffer, sizeof(buffer), "IOAPIC: %02x",
+			snprintf(buffer, size, "IOAPIC: %02x",
 				 dev->path.ioapic.ioapic_id);
 			break;
 		case DEVICE_PATH_DOMAIN:
-			snprintf(buffer, sizeof(buffer), "DOMAIN: %04x",
+			snprintf(buffer, size, "DOMAIN: %04x",
 				dev->path.domain.domain);
 			break;
 		case DEVICE_PATH_CPU_CLUSTER:
-			snprintf(buffer, sizeof(buffer), "CPU_CLUSTER: %01x",
+			snprintf(buffer, size, "CPU_CLUSTER: %01x",
 				dev->path.cpu_cluster.cluster);
 			break;
 		case DEVICE_PATH_CPU:
-			snprintf(buffer, sizeof(buffer),
+			snprintf(buffer, size,
 				 "CPU: %02x", dev->path.cpu.id);
 			break;
 		case DEVICE_PATH_CPU_BUS:
-			snprintf(buffer, sizeof(buffer),
+			snprintf(buffer, size,
 				 "CPU_BUS: %02x", dev->path.cpu_bus.id);
 			break;
 		case DEVICE_PATH_GENERIC:
-			snprintf(buffer, sizeof(buffer),
+			snprintf(buffer, size,
 				 "GENERIC: %d.%d", dev->path.generic.id,
 				 dev->path.generic.subid);
 			break;
 		case DEVICE_PATH_SPI:
-			snprintf(buffer, sizeof(buffer), "SPI: %02x",
+			snprintf(buffer, size, "SPI: %02x",
 				 dev->path.spi.cs);
 			break;
 		case DEVICE_PATH_USB:
-			snprintf(buffer, sizeof(buffer), "USB%u port %u",
+			snprintf(buffer, size, "USB%u port %u",
 				 dev->path.usb.port_type, dev->path.usb.port_id);
 			break;
 		case DEVICE_PATH_MMIO:
-			snprintf(buffer, sizeof(buffer), "MMIO: %08x",
+			snprintf(buffer, size, "MMIO: %08x",
 				 dev->path.mmio.addr);
 			break;
 		default:
@@ -241,6 +239,17 @@ const char *dev_path(const struct device *dev)
 	return buffer;
 }
 
+/*
+ * Warning: This function uses a static buffer. Don't call it more than once
+ * from the same print statement!
+ */
+const char *dev_path(const struct device *dev)
+{
+	static char buffer[DEVICE_PATH_MAX];
+
+	return dev_path_buf(dev, buffer, sizeof(buffer));
+}
+
 const char *dev_name(struct device *dev)
 {
 	if (dev->name)
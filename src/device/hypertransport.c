@@ -78,11 +78,15 @@ static int ht_setup_link(struct ht_link *prev, struct device *dev, unsigned pos)
 	struct ht_link cur[1];
 	int linkb_to_host;
 
-	/* Set the hypertransport link width and frequency. */
+	/*
+	 * Link width and frequency are left as the romstage HT init set them
+	 * up, so no reset is ever needed here.
+	 */
 
 	/*
 	 * See which side of the device our previous write to set the unitid
-	 * came from.
+	 * came from. The device latches that on the write, so the flags read
+	 * before it are of no use here.
 	 */
 	cur->dev = dev;
 	cur->pos = pos;
@@ -122,7 +126,8 @@ static int ht_setup_link(struct ht_link *prev, struct device *dev, unsigned pos)
 	return 0;
 }
 
-static unsigned ht_lookup_slave_capability(struct device *dev)
+/* Also hands back the capability flags, so callers need not read them again. */
+static unsigned ht_lookup_slave_capability(struct device *dev, u16 *flags)
 {
 	unsigned pos;
 
@@ -130,10 +135,9 @@ static unsigned ht_lookup_slave_capability(struct device *dev)
 	do {
 		pos = pci_find_next_capability(dev, PCI_CAP_ID_HT, pos);
 		if (pos) {
-			u16 flags;
-			flags = pci_read_config16(dev, pos + PCI_CAP_FLAGS);
-			printk(BIOS_SPEW, "flags: 0x%04x\n", flags);
-			if ((flags >> 13) == 0) {
+			*flags = pci_read_config16(dev, pos + PCI_CAP_FLAGS);
+			printk(BIOS_SPEW, "flags: 0x%04x\n", *flags);
+			if ((*flags >> 13) == 0) {
 				/* Entry is a slave secondary, success... */
 				break;
 			}
@@ -216,7 +220,8 @@ static void ht_collapse_early_enumeration(struct bus *bus,
 	for (devfn = PCI_DEVFN(1, 0); devfn <= 0xff; devfn += 8) {
 		struct device dummy;
 		u32 id;
-		unsigned pos, flags;
+		unsigned pos;
+		u16 flags;
 
 		dummy.bus = bus;
 		dummy.path.type = DEVICE_PATH_PCI;
@@ -232,12 +237,11 @@ static void ht_collapse_early_enumeration(struct bus *bus,
 		dummy.device = (id >> 16) & 0xffff;
 		dummy.hdr_type = pci_read_config8(&dummy, PCI_HEADER_TYPE);
 
-		pos = ht_lookup_slave_capability(&dummy);
+		pos = ht_lookup_slave_capability(&dummy, &flags);
 		if (!pos)
 			continue;
 
 		/* Clear the unitid. */
-		flags = pci_read_config16(&dummy, pos + PCI_CAP_FLAGS);
 		flags &= ~0x1f;
 		pci_write_config16(&dummy, pos + PCI_CAP_FLAGS, flags);
 		printk(BIOS_SPEW, "Collapsing %s [%04x/%04x]\n",
@@ -339,7 +343,7 @@ static unsigned int do_hypertransport_scan_chain(struct bus *bus, unsigned min_d
 			break;
 
 		/* Find the hypertransport link capability. */
-		pos = ht_lookup_slave_capability(dev);
+		pos = ht_lookup_slave_capability(dev, &flags);
 		if (pos == 0) {
 			printk(BIOS_ERR, "%s Hypertransport link capability "
 			       "not found", dev_path(dev));
@@ -347,8 +351,6 @@ static unsigned int do_hypertransport_scan_chain(struct bus *bus, unsigned min_d
 		}
 
 		/* Update the unitid of the current device. */
-		flags = pci_read_config16(dev, pos + PCI_CAP_FLAGS);
-
 		/*
 		 * If the device has a unitid set and is at devfn 0 we are
 		 * done. This can happen with shadow hypertransport devices,
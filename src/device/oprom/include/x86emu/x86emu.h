@@ -147,6 +147,7 @@ void 	X86EMU_setupIntrFuncs(X86EMU_intrFuncs funcs[]);
 void 	X86EMU_prepareForInt(int num);
 
 void X86EMU_setMemBase(void *base, size_t size);
+void X86EMU_setCodeWindow(u32 start, u32 size, void *host);
 
 /* decode.c */
 
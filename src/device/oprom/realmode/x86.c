@@ -22,6 +22,7 @@
 #include <console/console.h>
 #include <cpu/amd/lxdef.h>
 #include <cpu/amd/vr.h>
+#include <cpu/x86/profiler.h>
 #include <delay.h>
 #include <device/pci.h>
 #include <device/pci_ids.h>
@@ -286,8 +287,10 @@ void vbe_set_graphics(void)
 void vbe_textmode_console(void)
 {
 	delay(2);
+	profiler_pause();
 	realmode_interrupt(0x10, 0x0003, 0x0000, 0x0000,
 				0x0000, 0x0000, 0x0000);
+	profiler_resume();
 }
 
 int fill_lb_framebuffer(struct lb_framebuffer *framebuffer)
@@ -346,6 +349,7 @@ void run_bios(struct device *dev, unsigned long addr)
 	printk(BIOS_DEBUG, "Calling Option ROM...\n");
 	/* TODO ES:DI Pointer to System BIOS PnP Installation Check Structure */
 	/* Option ROM entry point is at OPROM start + 3 */
+	profiler_pause();
 	realmode_call(addr + 0x0003, num_dev, 0xffff, 0x0000, 0xffff, 0x0, 0x0);
 	printk(BIOS_DEBUG, "... Option ROM returned.\n");
 
@@ -353,6 +357,7 @@ void run_bios(struct device *dev, unsigned long addr)
 	if ((dev->class >> 8)== PCI_CLASS_DISPLAY_VGA)
 		vbe_set_graphics();
 #endif
+	profiler_resume();
 }
 
 #if IS_ENABLED(CONFIG_GEODE_VSA)
@@ -414,8 +419,10 @@ void do_vsmbios(void)
 	printk(BIOS_DEBUG, "Calling VSA module...\n");
 
 	/* ECX gets SMM, EDX gets SYSMEM */
+	profiler_pause();
 	realmode_call(VSA2_ENTRY_POINT, 0x0, 0x0, MSR_GLIU0_SMM,
 			MSR_GLIU0_SYSMEM, 0x0, 0x0);
+	profiler_resume();
 
 	printk(BIOS_DEBUG, "... VSA module returned.\n");
 
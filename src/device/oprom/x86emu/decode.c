@@ -41,6 +41,43 @@
 
 /*----------------------------- Implementation ----------------------------*/
 
+/****************************************************************************
+REMARKS:
+Instruction byte fetches. These read straight from host memory when the
+address is inside the code window, and use the memory access functions
+otherwise. The window is checked without overflow for accesses that
+straddle its end.
+****************************************************************************/
+static inline u8 fetch_code_byte(u32 addr)
+{
+    u32 offset = addr - sys_code_start;
+
+    if (offset < sys_code_size)
+        return sys_code_host[offset];
+    return (*sys_rdb)(addr);
+}
+
+static inline u16 fetch_code_word(u32 addr)
+{
+    u32 offset = addr - sys_code_start;
+
+    if (offset < sys_code_size && sys_code_size - offset >= 2)
+        return sys_code_host[offset] | (sys_code_host[offset + 1] << 8);
+    return (*sys_rdw)(addr);
+}
+
+static inline u32 fetch_code_long(u32 addr)
+{
+    u32 offset = addr - sys_code_start;
+
+    if (offset < sys_code_size && sys_code_size - offset >= 4)
+        return sys_code_host[offset] |
+            (sys_code_host[offset + 1] << 8) |
+            (sys_code_host[offset + 2] << 16) |
+            ((u32)sys_code_host[offset + 3] << 24);
+    return (*sys_rdl)(addr);
+}
+
 /****************************************************************************
 REMARKS:
 Handles any pending asynchronous interrupts.
@@ -119,7 +156,7 @@ DB(             if (M.x86.R_SP != 0) {
                 x86emu_intr_handle();
             }
         }
-        op1 = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+        op1 = fetch_code_byte(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
         (*x86emu_optab[op1])(op1);
         //if (M.x86.debug & DEBUG_EXIT) {
         //    M.x86.debug &= ~DEBUG_EXIT;
@@ -158,7 +195,7 @@ void fetch_decode_modrm(
 
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+    fetched = fetch_code_byte(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
     INC_DECODED_INST_LEN(1);
     *mod  = (fetched >> 6) & 0x03;
     *regh = (fetched >> 3) & 0x07;
@@ -181,7 +218,7 @@ u8 fetch_byte_imm(void)
 
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdb)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
+    fetched = fetch_code_byte(((u32)M.x86.R_CS << 4) + (M.x86.R_IP++));
     INC_DECODED_INST_LEN(1);
     return fetched;
 }
@@ -202,7 +239,7 @@ u16 fetch_word_imm(void)
 
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdw)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
+    fetched = fetch_code_word(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
     M.x86.R_IP += 2;
     INC_DECODED_INST_LEN(2);
     return fetched;
@@ -224,7 +261,7 @@ u32 fetch_long_imm(void)
 
 DB( if (CHECK_IP_FETCH())
         x86emu_check_ip_access();)
-    fetched = (*sys_rdl)(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
+    fetched = fetch_code_long(((u32)M.x86.R_CS << 4) + (M.x86.R_IP));
     M.x86.R_IP += 4;
     INC_DECODED_INST_LEN(4);
     return fetched;
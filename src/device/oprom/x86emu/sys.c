@@ -310,6 +310,11 @@ void (X86APIP sys_outb) (X86EMU_pioAddr addr, u8 val) = p_outb;
 void (X86APIP sys_outw) (X86EMU_pioAddr addr, u16 val) = p_outw;
 void (X86APIP sys_outl) (X86EMU_pioAddr addr, u32 val) = p_outl;
 
+/* Instruction fetches in this range bypass the memory access functions. */
+u32 sys_code_start;
+u32 sys_code_size;
+u8 *sys_code_host;
+
 /*----------------------------- Setup -------------------------------------*/
 
 /****************************************************************************
@@ -404,3 +409,23 @@ void X86EMU_setMemBase(void *base, size_t size)
 	M.mem_base = (unsigned long) base;
 	M.mem_size = size;
 }
+
+/****************************************************************************
+PARAMETERS:
+start	- Linear address of the window
+size	- Size of the window in bytes, 0 to disable it
+host	- Host pointer the window start maps to
+
+REMARKS:
+Instruction fetches go through the memory access functions like any other
+read, which may have to check every address against device mappings. This
+function declares a range of plain memory, usually the option ROM image,
+that instruction bytes may be read from directly. Writes still go through
+the memory access functions and must end up in the same host memory.
+****************************************************************************/
+void X86EMU_setCodeWindow(u32 start, u32 size, void *host)
+{
+	sys_code_start = start;
+	sys_code_size = size;
+	sys_code_host = host;
+}
@@ -87,6 +87,10 @@ extern void (X86APIP sys_wrb)(u32 addr,u8 val);
 extern void (X86APIP sys_wrw)(u32 addr,u16 val);
 extern void (X86APIP sys_wrl)(u32 addr,u32 val);
 
+extern u32	sys_code_start;
+extern u32	sys_code_size;
+extern u8	*sys_code_host;
+
 extern u8  	(X86APIP sys_inb)(X86EMU_pioAddr addr);
 extern u16 	(X86APIP sys_inw)(X86EMU_pioAddr addr);
 extern u32 	(X86APIP sys_inl)(X86EMU_pioAddr addr);
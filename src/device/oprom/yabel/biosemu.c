@@ -208,6 +208,9 @@ biosemu(u8 *biosmem, u32 biosmem_size, struct device * dev, unsigned long rom_ad
 		dump(mem_img, 0x20);
 		return 0;
 	}
+	// the option ROM area is plain memory, let the emulator fetch
+	// instructions from it without going through my_rdb()
+	X86EMU_setCodeWindow(OPTION_ROM_CODE_SEGMENT << 4, 0x10000, mem_img);
 	// setup default Interrupt Vectors
 	// some expansion ROMs seem to check for these addresses..
 	// each handler is only an IRET (0xCF) instruction
@@ -46,6 +46,9 @@
 #include <device/pcix.h>
 #include <device/pciexp.h>
 #include <device/hypertransport.h>
+#if IS_ENABLED(CONFIG_PCI_PARALLEL_PROBE)
+#include <cpu/x86/mp.h>
+#endif
 #include <pc80/i8259.h>
 #include <security/vboot/vbnv.h>
 #include <timestamp.h>
@@ -110,12 +113,10 @@ u32 pci_moving_config32(struct device *dev, unsigned int reg)
  * @param last Location of the PCI capability register to start from.
  * @return The next matching capability.
  */
-unsigned pci_find_next_capability(struct device *dev, unsigned cap,
-				  unsigned last)
+static unsigned int pci_first_capability(struct device *dev)
 {
-	unsigned pos = 0;
+	unsigned int pos;
 	u16 status;
-	unsigned reps = 48;
 
 	status = pci_read_config16(dev, PCI_STATUS);
 	if (!(status & PCI_STATUS_CAP_LIST))
@@ -133,7 +134,16 @@ unsigned pci_find_next_capability(struct device *dev, unsigned cap,
 		return 0;
 	}
 
-	pos = pci_read_config8(dev, pos);
+	return pci_read_config8(dev, pos);
+}
+
+unsigned pci_find_next_capability(struct device *dev, unsigned cap,
+				  unsigned last)
+{
+	unsigned pos;
+	unsigned reps = 48;
+
+	pos = pci_first_capability(dev);
 	while (reps-- && (pos >= 0x40)) { /* Loop through the linked list. */
 		int this_cap;
 
@@ -163,8 +173,52 @@ unsigned pci_find_next_capability(struct device *dev, unsigned cap,
  * @param cap PCI_CAP_LIST_ID of the PCI capability we're looking for.
  * @return The next matching capability.
  */
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+/* Walk the capability list once and note the first entry of each ID. */
+static void pci_fill_capability_cache(struct device *dev)
+{
+	unsigned int pos;
+	unsigned int reps = 48;
+
+	memset(dev->pci_cap_pos, 0, sizeof(dev->pci_cap_pos));
+
+	pos = pci_first_capability(dev);
+	while (reps-- && (pos >= 0x40)) {
+		u8 this_cap;
+
+		pos &= ~3;
+		this_cap = pci_read_config8(dev, pos + PCI_CAP_LIST_ID);
+		if (this_cap == 0xff)
+			break;
+
+		if (this_cap < ARRAY_SIZE(dev->pci_cap_pos) &&
+		    !dev->pci_cap_pos[this_cap])
+			dev->pci_cap_pos[this_cap] = pos;
+
+		pos = pci_read_config8(dev, pos + PCI_CAP_LIST_NEXT);
+	}
+}
+#endif
+
 unsigned int pci_find_capability(struct device *dev, unsigned int cap)
 {
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	if (cap < ARRAY_SIZE(dev->pci_cap_pos)) {
+		u16 vendor;
+
+		pci_cfg_cache_sync(dev);
+		if (dev->pci_cfg_valid & PCI_CFG_CAPS_VALID)
+			return dev->pci_cap_pos[cap];
+
+		pci_fill_capability_cache(dev);
+
+		/* Like the shadow registers, skip functions not up yet. */
+		vendor = pci_read_config16(dev, PCI_VENDOR_ID);
+		if (vendor != 0x0000 && vendor != 0x0001 && vendor != 0xffff)
+			dev->pci_cfg_valid |= PCI_CFG_CAPS_VALID;
+		return dev->pci_cap_pos[cap];
+	}
+#endif
 	return pci_find_next_capability(dev, cap, 0);
 }
 
@@ -1041,6 +1095,93 @@ static struct device *pci_scan_get_dev(struct device **list, unsigned int devfn)
 	return dev;
 }
 
+#if IS_ENABLED(CONFIG_PCI_PARALLEL_PROBE)
+/*
+ * Vendor/device IDs of one PCI slot, read ahead of the actual scan. Bit n of
+ * 'probed' is set when id[n] holds the ID of function n.
+ */
+struct pci_probe_slot {
+	struct bus *bus;
+	unsigned int devfn;
+	u8 probed;
+	u32 id[8];
+};
+
+static struct pci_probe_slot probe_slots[32];
+static struct mp_job probe_jobs[32];
+
+static int pci_id_present(u32 id)
+{
+	return id != 0xffffffff && id != 0x00000000 &&
+		id != 0x0000ffff && id != 0xffff0000;
+}
+
+static void pci_probe_slot(void *arg)
+{
+	struct pci_probe_slot *slot = arg;
+	struct device dummy;
+	unsigned int fn;
+
+	memset(&dummy, 0, sizeof(dummy));
+	dummy.bus = slot->bus;
+	dummy.path.type = DEVICE_PATH_PCI;
+
+	for (fn = 0; fn < 8; fn++) {
+		dummy.path.pci.devfn = slot->devfn + fn;
+		slot->id[fn] = pci_read_config32(&dummy, PCI_VENDOR_ID);
+		slot->probed |= 1 << fn;
+
+		/* Only look further on multi-function devices. What else
+		 * there is gets probed during the scan as usual. */
+		if (fn == 0 && (!pci_id_present(slot->id[0]) ||
+		    !(pci_read_config8(&dummy, PCI_HEADER_TYPE) & 0x80)))
+			break;
+	}
+}
+
+/*
+ * Read the IDs of all slots in [min_devfn, max_devfn] with the slots spread
+ * across the BSP and the idle APs. This only reads registers, the device
+ * structures are still created by pci_scan_bus() in devfn order.
+ */
+static void pci_probe_slots(struct bus *bus, unsigned int min_devfn,
+			    unsigned int max_devfn)
+{
+	unsigned int slot;
+	size_t num = 0;
+
+	for (slot = PCI_SLOT(min_devfn); slot <= PCI_SLOT(max_devfn); slot++) {
+		probe_slots[slot].bus = bus;
+		probe_slots[slot].devfn = PCI_DEVFN(slot, 0);
+		probe_slots[slot].probed = 0;
+		probe_jobs[num].func = pci_probe_slot;
+		probe_jobs[num].arg = &probe_slots[slot];
+		num++;
+	}
+
+	mp_run_jobs(probe_jobs, num, 0);
+}
+
+/* Return 1 if the read ahead found nothing at devfn. */
+static int pci_probed_absent(unsigned int devfn)
+{
+	const struct pci_probe_slot *slot = &probe_slots[PCI_SLOT(devfn)];
+	unsigned int fn = PCI_FUNC(devfn);
+
+	return (slot->probed & (1 << fn)) && !pci_id_present(slot->id[fn]);
+}
+#else
+static void pci_probe_slots(struct bus *bus, unsigned int min_devfn,
+			    unsigned int max_devfn)
+{
+}
+
+static int pci_probed_absent(unsigned int devfn)
+{
+	return 0;
+}
+#endif
+
 /**
  * Scan a PCI bus.
  *
@@ -1062,6 +1203,7 @@ struct device *pci_probe_dev(struct device *dev, struct bus *bus,
 	if (!dev) {
 		struct device dummy;
 
+		memset(&dummy, 0, sizeof(dummy));
 		dummy.bus = bus;
 		dummy.path.type = DEVICE_PATH_PCI;
 		dummy.path.pci.devfn = devfn;
@@ -1198,6 +1340,8 @@ void pci_scan_bus(struct bus *bus, unsigned min_devfn,
 
 	post_code(0x24);
 
+	pci_probe_slots(bus, min_devfn, max_devfn);
+
 	/*
 	 * Probe all devices/functions on this bus with some optimization for
 	 * non-existence and single function devices.
@@ -1208,8 +1352,13 @@ void pci_scan_bus(struct bus *bus, unsigned min_devfn,
 		/* First thing setup the device structure. */
 		dev = pci_scan_get_dev(&old_devices, devfn);
 
-		/* See if a device is present and setup the device structure. */
-		dev = pci_probe_dev(dev, bus, devfn);
+		/*
+		 * See if a device is present and setup the device structure.
+		 * Static devices are always probed since their enable_dev()
+		 * may only now make them show up.
+		 */
+		if (dev || !pci_probed_absent(devfn))
+			dev = pci_probe_dev(dev, bus, devfn);
 
 		/*
 		 * If this is not a multi function device, or the device is
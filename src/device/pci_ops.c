@@ -68,23 +68,120 @@ static struct bus *get_pbus(struct device *dev)
 	return pbus;
 }
 
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+/*
+ * The vendor/device ID, class/revision and subsystem ID dwords are read over
+ * and over by the scan and the drivers but never change on their own, so
+ * keep them in the struct device once read. Writes through the functions
+ * below drop the copy of the dword they hit. Only the dummy devices of the
+ * scan move between bus/devfn; pci_cfg_cache_sync() catches those.
+ */
+static const u8 pci_cfg_cache_regs[] = {
+	PCI_VENDOR_ID, PCI_CLASS_REVISION, PCI_SUBSYSTEM_VENDOR_ID,
+};
+
+static int pci_cfg_cache_slot(unsigned int where)
+{
+	int slot;
+
+	for (slot = 0; slot < ARRAY_SIZE(pci_cfg_cache_regs); slot++) {
+		if ((where & ~3) == pci_cfg_cache_regs[slot])
+			return slot;
+	}
+	return -1;
+}
+
+void pci_cfg_cache_sync(struct device *dev)
+{
+	u32 key = dev->bus->secondary << 8 | dev->path.pci.devfn;
+
+	if (dev->pci_cfg_key != key) {
+		dev->pci_cfg_key = key;
+		dev->pci_cfg_valid = 0;
+	}
+}
+
+static u32 pci_cfg_cache_read(struct device *dev, int slot)
+{
+	struct bus *pbus;
+	u32 val;
+	u16 vendor;
+
+	pci_cfg_cache_sync(dev);
+	if (dev->pci_cfg_valid & (1 << slot))
+		return dev->pci_cfg[slot];
+
+	pbus = get_pbus(dev);
+	val = pci_bus_ops(pbus, dev)->read32(pbus, dev->bus->secondary,
+					     dev->path.pci.devfn,
+					     pci_cfg_cache_regs[slot]);
+
+	/* Don't remember empty slots or functions that aren't up yet. */
+	vendor = dev->pci_cfg_valid & 1 ? dev->pci_cfg[0] : val;
+	if (val == 0xffffffff || vendor == 0x0000 || vendor == 0x0001 ||
+	    vendor == 0xffff)
+		return val;
+
+	dev->pci_cfg[slot] = val;
+	dev->pci_cfg_valid |= 1 << slot;
+	return val;
+}
+
+static void pci_cfg_cache_write(struct device *dev, unsigned int where)
+{
+	int slot = pci_cfg_cache_slot(where);
+
+	pci_cfg_cache_sync(dev);
+	if (slot >= 0)
+		dev->pci_cfg_valid &= ~(1 << slot);
+
+	/*
+	 * The capability pointer is writable on some parts, and chipset
+	 * registers further up may hide or reveal capabilities.
+	 */
+	if (where >= PCI_CAPABILITY_LIST)
+		dev->pci_cfg_valid &= ~PCI_CFG_CAPS_VALID;
+}
+#endif
+
 u8 pci_read_config8(struct device *dev, unsigned int where)
 {
-	struct bus *pbus = get_pbus(dev);
+	struct bus *pbus;
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	int slot = pci_cfg_cache_slot(where);
+
+	if (slot >= 0)
+		return pci_cfg_cache_read(dev, slot) >> ((where & 3) * 8);
+#endif
+	pbus = get_pbus(dev);
 	return pci_bus_ops(pbus, dev)->read8(pbus, dev->bus->secondary,
 					dev->path.pci.devfn, where);
 }
 
 u16 pci_read_config16(struct device *dev, unsigned int where)
 {
-	struct bus *pbus = get_pbus(dev);
+	struct bus *pbus;
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	int slot = pci_cfg_cache_slot(where);
+
+	if (slot >= 0 && !(where & 1))
+		return pci_cfg_cache_read(dev, slot) >> ((where & 2) * 8);
+#endif
+	pbus = get_pbus(dev);
 	return pci_bus_ops(pbus, dev)->read16(pbus, dev->bus->secondary,
 					 dev->path.pci.devfn, where);
 }
 
 u32 pci_read_config32(struct device *dev, unsigned int where)
 {
-	struct bus *pbus = get_pbus(dev);
+	struct bus *pbus;
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	int slot = pci_cfg_cache_slot(where);
+
+	if (slot >= 0 && !(where & 3))
+		return pci_cfg_cache_read(dev, slot);
+#endif
+	pbus = get_pbus(dev);
 	return pci_bus_ops(pbus, dev)->read32(pbus, dev->bus->secondary,
 					 dev->path.pci.devfn, where);
 }
@@ -92,6 +189,9 @@ u32 pci_read_config32(struct device *dev, unsigned int where)
 void pci_write_config8(struct device *dev, unsigned int where, u8 val)
 {
 	struct bus *pbus = get_pbus(dev);
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	pci_cfg_cache_write(dev, where);
+#endif
 	pci_bus_ops(pbus, dev)->write8(pbus, dev->bus->secondary,
 				  dev->path.pci.devfn, where, val);
 }
@@ -99,6 +199,9 @@ void pci_write_config8(struct device *dev, unsigned int where, u8 val)
 void pci_write_config16(struct device *dev, unsigned int where, u16 val)
 {
 	struct bus *pbus = get_pbus(dev);
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	pci_cfg_cache_write(dev, where);
+#endif
 	pci_bus_ops(pbus, dev)->write16(pbus, dev->bus->secondary,
 				   dev->path.pci.devfn, where, val);
 }
@@ -106,6 +209,9 @@ void pci_write_config16(struct device *dev, unsigned int where, u16 val)
 void pci_write_config32(struct device *dev, unsigned int where, u32 val)
 {
 	struct bus *pbus = get_pbus(dev);
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	pci_cfg_cache_write(dev, where);
+#endif
 	pci_bus_ops(pbus, dev)->write32(pbus, dev->bus->secondary,
 				   dev->path.pci.devfn, where, val);
 }
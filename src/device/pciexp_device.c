@@ -14,6 +14,7 @@
  * GNU General Public License for more details.
  */
 
+#include <bootstate.h>
 #include <console/console.h>
 #include <delay.h>
 #include <device/device.h>
@@ -21,6 +22,7 @@
 #include <device/pci_ids.h>
 #include <device/pci_ops.h>
 #include <device/pciexp.h>
+#include <thread.h>
 
 unsigned int pciexp_find_extended_cap(struct device *dev, unsigned int cap)
 {
@@ -49,9 +51,29 @@ unsigned int pciexp_find_extended_cap(struct device *dev, unsigned int cap)
  * Re-train a PCIe link
  */
 #define PCIE_TRAIN_RETRY 10000
-static int pciexp_retrain_link(struct device *dev, unsigned cap)
+
+static int pciexp_link_training(struct device *dev, unsigned int cap)
+{
+	return !!(pci_read_config16(dev, cap + PCI_EXP_LNKSTA) &
+		  PCI_EXP_LNKSTA_LT);
+}
+
+static int pciexp_wait_training(struct device *dev, unsigned int cap)
 {
 	unsigned int try;
+
+	for (try = PCIE_TRAIN_RETRY; try > 0; try--) {
+		if (!pciexp_link_training(dev, cap))
+			return 0;
+		udelay(100);
+	}
+
+	printk(BIOS_ERR, "%s: Link Retrain timeout\n", dev_path(dev));
+	return -1;
+}
+
+static int pciexp_start_retrain(struct device *dev, unsigned int cap)
+{
 	u16 lnk;
 
 	/*
@@ -61,41 +83,36 @@ static int pciexp_retrain_link(struct device *dev, unsigned cap)
 	 * This is meant to avoid a race condition when using the
 	 * Retrain Link mechanism.
 	 */
-	for (try = PCIE_TRAIN_RETRY; try > 0; try--) {
-		lnk = pci_read_config16(dev, cap + PCI_EXP_LNKSTA);
-		if (!(lnk & PCI_EXP_LNKSTA_LT))
-			break;
-		udelay(100);
-	}
-	if (try == 0) {
-		printk(BIOS_ERR, "%s: Link Retrain timeout\n", dev_path(dev));
+	if (pciexp_wait_training(dev, cap))
 		return -1;
-	}
 
 	/* Start link retraining */
 	lnk = pci_read_config16(dev, cap + PCI_EXP_LNKCTL);
 	lnk |= PCI_EXP_LNKCTL_RL;
 	pci_write_config16(dev, cap + PCI_EXP_LNKCTL, lnk);
 
-	/* Wait for training to complete */
-	for (try = PCIE_TRAIN_RETRY; try > 0; try--) {
-		lnk = pci_read_config16(dev, cap + PCI_EXP_LNKSTA);
-		if (!(lnk & PCI_EXP_LNKSTA_LT))
-			return 0;
-		udelay(100);
-	}
+	return 0;
+}
 
-	printk(BIOS_ERR, "%s: Link Retrain timeout\n", dev_path(dev));
-	return -1;
+static int pciexp_retrain_link(struct device *dev, unsigned int cap)
+{
+	if (pciexp_start_retrain(dev, cap))
+		return -1;
+
+	/* Wait for training to complete */
+	return pciexp_wait_training(dev, cap);
 }
 
 /*
  * Check the Slot Clock Configuration for root port and endpoint
  * and enable Common Clock Configuration if possible.  If CCC is
- * enabled the link must be retrained.
+ * enabled the link must be retrained. With PCIEXP_ASYNC_RETRAIN the
+ * retraining is only started and 1 is returned while it is going on.
  */
-static void pciexp_enable_common_clock(struct device *root, unsigned root_cap,
-				       struct device *endp, unsigned endp_cap)
+static int pciexp_enable_common_clock(struct device *root,
+				      unsigned int root_cap,
+				      struct device *endp,
+				      unsigned int endp_cap)
 {
 	u16 root_scc, endp_scc, lnkctl;
 
@@ -122,8 +139,12 @@ static void pciexp_enable_common_clock(struct device *root, unsigned root_cap,
 		pci_write_config16(root, root_cap + PCI_EXP_LNKCTL, lnkctl);
 
 		/* Retrain link if CCC was enabled */
+		if (IS_ENABLED(CONFIG_PCIEXP_ASYNC_RETRAIN))
+			return pciexp_start_retrain(root, root_cap) == 0;
 		pciexp_retrain_link(root, root_cap);
 	}
+
+	return 0;
 }
 
 static void pciexp_enable_clock_power_pm(struct device *endp, unsigned endp_cap)
@@ -412,6 +433,134 @@ static void pciexp_enable_aspm(struct device *root, unsigned root_cap,
 	printk(BIOS_INFO, "ASPM: Enabled %s\n", aspm_type_str[apmc]);
 }
 
+/* Everything done to a link after Common Clock has been sorted out. */
+static void pciexp_tune_link(struct device *root, unsigned int root_cap,
+			     struct device *dev, unsigned int cap)
+{
+	/* Check if per port CLK req is supported by endpoint*/
+	if (IS_ENABLED(CONFIG_PCIEXP_CLK_PM))
+		pciexp_enable_clock_power_pm(dev, cap);
+
+	/* Enable L1 Sub-State when both root port and endpoint support */
+	if (IS_ENABLED(CONFIG_PCIEXP_L1_SUB_STATE))
+		pciexp_config_L1_sub_state(root, dev);
+
+	/* Check for and enable ASPM */
+	if (IS_ENABLED(CONFIG_PCIEXP_ASPM))
+		pciexp_enable_aspm(root, root_cap, dev, cap);
+}
+
+#if IS_ENABLED(CONFIG_PCIEXP_ASYNC_RETRAIN)
+/*
+ * Links that are retraining with the rest of their tuning still to do. The
+ * endpoint can't be touched while its link retrains without stalling the
+ * CPU, so it is put aside and the scan moves on to the next port.
+ */
+#define PCIEXP_MAX_RETRAINS 32
+
+static struct pciexp_retrain {
+	struct device *dev;
+	unsigned int root_cap;
+	unsigned int cap;
+} retrains[PCIEXP_MAX_RETRAINS];
+static size_t num_retrains;
+
+/*
+ * Bridges whose LTR setup waits for the retrains, it writes to the
+ * endpoints below them too.
+ */
+static struct device *ltr_bridges[PCIEXP_MAX_RETRAINS];
+static size_t num_ltr_bridges;
+
+static int pciexp_defer_tune(struct device *dev, unsigned int root_cap,
+			     unsigned int cap)
+{
+	if (num_retrains == ARRAY_SIZE(retrains))
+		return -1;
+
+	retrains[num_retrains].dev = dev;
+	retrains[num_retrains].root_cap = root_cap;
+	retrains[num_retrains].cap = cap;
+	num_retrains++;
+
+	return 0;
+}
+
+/*
+ * Wait for all links retraining at once, under a single deadline, and
+ * finish tuning each of them as soon as it is back.
+ */
+static void pciexp_finish_retrains(void *unused)
+{
+	unsigned int try;
+	size_t i, left = num_retrains;
+
+	for (try = PCIE_TRAIN_RETRY; left && try > 0; try--) {
+		for (i = 0; i < num_retrains; i++) {
+			struct pciexp_retrain *r = &retrains[i];
+			struct device *root;
+
+			if (!r->dev)
+				continue;
+
+			root = r->dev->bus->dev;
+			if (pciexp_link_training(root, r->root_cap))
+				continue;
+
+			pciexp_tune_link(root, r->root_cap, r->dev, r->cap);
+			r->dev = NULL;
+			left--;
+		}
+
+		if (left && thread_yield_microseconds(100))
+			udelay(100);
+	}
+
+	/* Like the synchronous path, carry on after a timeout. */
+	for (i = 0; i < num_retrains; i++) {
+		struct pciexp_retrain *r = &retrains[i];
+
+		if (!r->dev)
+			continue;
+
+		printk(BIOS_ERR, "%s: Link Retrain timeout\n",
+		       dev_path(r->dev->bus->dev));
+		pciexp_tune_link(r->dev->bus->dev, r->root_cap, r->dev,
+				 r->cap);
+		r->dev = NULL;
+	}
+
+	num_retrains = 0;
+
+	for (i = 0; i < num_ltr_bridges; i++)
+		pciexp_enable_ltr(ltr_bridges[i]);
+	num_ltr_bridges = 0;
+}
+
+static void pciexp_defer_ltr(struct device *dev)
+{
+	/* Out of room, get the retrains over with now. */
+	if (num_ltr_bridges == ARRAY_SIZE(ltr_bridges))
+		pciexp_finish_retrains(NULL);
+
+	ltr_bridges[num_ltr_bridges++] = dev;
+}
+
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENUMERATE, BS_ON_EXIT, pciexp_finish_retrains,
+		      NULL);
+#else
+static int pciexp_defer_tune(struct device *dev, unsigned int root_cap,
+			     unsigned int cap)
+{
+	return -1;
+}
+
+static void pciexp_defer_ltr(struct device *dev)
+{
+	pciexp_enable_ltr(dev);
+}
+#endif
+
 static void pciexp_tune_dev(struct device *dev)
 {
 	struct device *root = dev->bus->dev;
@@ -426,20 +575,15 @@ static void pciexp_tune_dev(struct device *dev)
 		return;
 
 	/* Check for and enable Common Clock */
-	if (IS_ENABLED(CONFIG_PCIEXP_COMMON_CLOCK))
-		pciexp_enable_common_clock(root, root_cap, dev, cap);
-
-	/* Check if per port CLK req is supported by endpoint*/
-	if (IS_ENABLED(CONFIG_PCIEXP_CLK_PM))
-		pciexp_enable_clock_power_pm(dev, cap);
-
-	/* Enable L1 Sub-State when both root port and endpoint support */
-	if (IS_ENABLED(CONFIG_PCIEXP_L1_SUB_STATE))
-		pciexp_config_L1_sub_state(root, dev);
+	if (IS_ENABLED(CONFIG_PCIEXP_COMMON_CLOCK) &&
+	    pciexp_enable_common_clock(root, root_cap, dev, cap)) {
+		/* The link is retraining, finish up once it is back. */
+		if (!pciexp_defer_tune(dev, root_cap, cap))
+			return;
+		pciexp_wait_training(root, root_cap);
+	}
 
-	/* Check for and enable ASPM */
-	if (IS_ENABLED(CONFIG_PCIEXP_ASPM))
-		pciexp_enable_aspm(root, root_cap, dev, cap);
+	pciexp_tune_link(root, root_cap, dev, cap);
 }
 
 void pciexp_scan_bus(struct bus *bus, unsigned int min_devfn,
@@ -460,7 +604,7 @@ void pciexp_scan_bus(struct bus *bus, unsigned int min_devfn,
 void pciexp_scan_bridge(struct device *dev)
 {
 	do_pci_scan_bridge(dev, pciexp_scan_bus);
-	pciexp_enable_ltr(dev);
+	pciexp_defer_ltr(dev);
 }
 
 /** Default device operations for PCI Express bridges */
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/acpi.h>
+#include <bootstate.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <device/device.h>
+#include <device/pci.h>
+#include <device/pci_ops.h>
+#include <device/resume_script.h>
+
+#define RESUME_SCRIPT_SIZE	(16 * KiB)
+
+/* Lives in CBMEM, which S3 leaves alone. */
+static const struct reg_record_log *resume_script_valid(void)
+{
+	const struct reg_record_log *log;
+
+	log = cbmem_find(CBMEM_ID_RESUME_SCRIPT);
+	if (!log || log->signature != REG_RECORD_SIGNATURE ||
+	    log->incomplete || !log->used)
+		return NULL;
+	return log;
+}
+
+int resume_script_minimal_resume(void)
+{
+	return acpi_is_wakeup_s3() && resume_script_valid() != NULL;
+}
+
+int resume_script_replay(void)
+{
+	const struct reg_record_log *log = resume_script_valid();
+
+	if (!log)
+		return -1;
+
+	printk(BIOS_DEBUG, "Replaying %u words of recorded device setup\n",
+	       log->used);
+	return reg_record_replay(log);
+}
+
+static void record_config(struct device *dev, unsigned int reg, int size)
+{
+	uint32_t addr = CONFIG_MMCONF_BASE_ADDRESS |
+		(dev->bus->secondary << 20) | (dev->path.pci.devfn << 12) | reg;
+
+	if (size == 1)
+		reg_record_write(REG_RECORD_MMIO, REG_RECORD_SIZE_8, addr,
+				 pci_read_config8(dev, reg));
+	else if (size == 2)
+		reg_record_write(REG_RECORD_MMIO, REG_RECORD_SIZE_16, addr,
+				 pci_read_config16(dev, reg));
+	else
+		reg_record_write(REG_RECORD_MMIO, REG_RECORD_SIZE_32, addr,
+				 pci_read_config32(dev, reg));
+}
+
+/*
+ * Bus numbers, bridge windows and BARs have to be back before anything
+ * that is recorded behind them, the command register last so nothing
+ * decodes half programmed ranges.
+ */
+static void record_pci_dev(struct device *dev)
+{
+	unsigned int reg, last_bar = PCI_BASE_ADDRESS_5;
+
+	if ((dev->hdr_type & 0x7f) == PCI_HEADER_TYPE_BRIDGE) {
+		last_bar = PCI_BASE_ADDRESS_1;
+		record_config(dev, PCI_PRIMARY_BUS, 4);
+		record_config(dev, PCI_IO_BASE, 2);
+		record_config(dev, PCI_MEMORY_BASE, 4);
+		record_config(dev, PCI_PREF_MEMORY_BASE, 4);
+		record_config(dev, PCI_PREF_BASE_UPPER32, 4);
+		record_config(dev, PCI_PREF_LIMIT_UPPER32, 4);
+		record_config(dev, PCI_IO_BASE_UPPER16, 4);
+		record_config(dev, PCI_BRIDGE_CONTROL, 2);
+	}
+
+	for (reg = PCI_BASE_ADDRESS_0; reg <= last_bar; reg += 4)
+		record_config(dev, reg, 4);
+
+	record_config(dev, PCI_CACHE_LINE_SIZE, 1);
+	record_config(dev, PCI_LATENCY_TIMER, 1);
+	record_config(dev, PCI_INTERRUPT_LINE, 1);
+	record_config(dev, PCI_COMMAND, 2);
+}
+
+static void record_pci_bus(struct bus *bus)
+{
+	struct device *dev;
+	struct bus *link;
+
+	for (dev = bus->children; dev; dev = dev->sibling) {
+		if (!dev->enabled || dev->path.type != DEVICE_PATH_PCI)
+			continue;
+		record_pci_dev(dev);
+		for (link = dev->link_list; link; link = link->next)
+			record_pci_bus(link);
+	}
+}
+
+/*
+ * Resources are assigned and enabled, device init comes next. Recording
+ * goes on until device init is done, so reg_script writes of the inits
+ * end up in the log too.
+ */
+static void resume_script_start(void *unused)
+{
+	struct device *dev;
+	struct bus *link;
+
+	if (acpi_is_wakeup_s3())
+		return;
+
+	if (!reg_record_start(CBMEM_ID_RESUME_SCRIPT, RESUME_SCRIPT_SIZE))
+		return;
+
+	/* Host bridges and domains aren't PCI devices themselves. */
+	for (dev = all_devices; dev; dev = dev->next) {
+		if (dev->path.type != DEVICE_PATH_DOMAIN)
+			continue;
+		for (link = dev->link_list; link; link = link->next)
+			record_pci_bus(link);
+	}
+}
+
+static void resume_script_stop(void *unused)
+{
+	reg_record_stop();
+}
+
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENABLE, BS_ON_EXIT, resume_script_start, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, resume_script_stop, NULL);
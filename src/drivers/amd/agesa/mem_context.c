@@ -0,0 +1,189 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/acpi.h>
+#include <bootstate.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <fmap.h>
+#include <region_file.h>
+#include <string.h>
+#include <version.h>
+#include <northbridge/amd/agesa/state_machine.h>
+
+/*
+ * The memory context AmdInitPost hands out with SaveMemContextCtl is kept
+ * in flash and handed back with MemRestoreCtl on the next normal boot, so
+ * AGESA programs the DCTs from it instead of training again. AGESA itself
+ * checks the DIMM configuration and memory clock against the context and
+ * trains as usual when they changed. A different coreboot build may come
+ * with a different AGESA, so the context is also tied to the build.
+ */
+#define MEM_CONTEXT_REGION	"RW_AGESA_MEM_CONTEXT"
+#define MEM_CONTEXT_SIGNATURE	0x434d454d	/* 'MEMC' */
+
+/* Stored right in front of the context, in flash and in CBMEM. */
+struct mem_context_header {
+	uint32_t signature;
+	uint32_t size;
+	uint64_t fingerprint;
+} __packed;
+
+#define FNV64_OFFSET	0xcbf29ce484222325ULL
+#define FNV64_PRIME	0x100000001b3ULL
+
+static uint64_t fnv64_str(uint64_t hash, const char *str)
+{
+	while (*str) {
+		hash ^= (uint8_t)*str++;
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t mem_context_fingerprint(void)
+{
+	uint64_t hash = FNV64_OFFSET;
+
+	hash = fnv64_str(hash, coreboot_version);
+	hash = fnv64_str(hash, coreboot_compile_time);
+	return hash;
+}
+
+static int mem_context_open(struct region_file *file, int rw)
+{
+	struct region_device rdev;
+	int ret;
+
+	if (rw)
+		ret = fmap_locate_area_as_rdev_rw(MEM_CONTEXT_REGION, &rdev);
+	else
+		ret = fmap_locate_area_as_rdev(MEM_CONTEXT_REGION, &rdev);
+	if (ret < 0)
+		return -1;
+
+	return region_file_init(file, &rdev);
+}
+
+#if ENV_ROMSTAGE
+
+void agesa_mem_context_restore(AMD_POST_PARAMS *Post)
+{
+	const struct mem_context_header *header;
+	struct region_file file;
+	struct region_device rdev;
+
+	/* Have AGESA hand out the context whenever it trains. */
+	Post->MemConfig.SaveMemContextCtl = TRUE;
+
+	if (mem_context_open(&file, 0) < 0 ||
+	    region_file_data(&file, &rdev) < 0)
+		return;
+
+	/* The boot device is memory mapped, AGESA can read it in place. */
+	header = rdev_mmap_full(&rdev);
+	if (header == NULL)
+		return;
+
+	if (header->signature != MEM_CONTEXT_SIGNATURE ||
+	    header->size != region_device_sz(&rdev) - sizeof(*header) ||
+	    header->fingerprint != mem_context_fingerprint()) {
+		printk(BIOS_DEBUG, "AGESA: No memory context to restore\n");
+		return;
+	}
+
+	Post->MemConfig.MemContext.NvStorage = (void *)(header + 1);
+	Post->MemConfig.MemContext.NvStorageSize = header->size;
+	Post->MemConfig.MemRestoreCtl = TRUE;
+	printk(BIOS_DEBUG, "AGESA: Restoring memory context from flash\n");
+}
+
+void agesa_mem_context_saved(struct sysinfo *cb, AMD_POST_PARAMS *Post)
+{
+	/* After a restore this is the flash copy, ramstage leaves it be. */
+	cb->mem_context = Post->MemConfig.MemContext.NvStorage;
+	cb->mem_context_size = Post->MemConfig.MemContext.NvStorageSize;
+}
+
+void agesa_mem_context_stash(struct sysinfo *cb)
+{
+	struct mem_context_header *header;
+
+	if (cb->s3resume || cb->mem_context == NULL ||
+	    cb->mem_context_size == 0)
+		return;
+
+	/* The AGESA heap is still around, ramstage wipes it. */
+	header = cbmem_add(CBMEM_ID_MRCDATA,
+			   sizeof(*header) + cb->mem_context_size);
+	if (header == NULL) {
+		printk(BIOS_ERR, "AGESA: No room for the memory context\n");
+		return;
+	}
+
+	header->signature = MEM_CONTEXT_SIGNATURE;
+	header->size = cb->mem_context_size;
+	header->fingerprint = mem_context_fingerprint();
+	memcpy(header + 1, cb->mem_context, cb->mem_context_size);
+}
+
+#endif /* ENV_ROMSTAGE */
+
+#if ENV_RAMSTAGE
+
+static void mem_context_update(void *unused)
+{
+	const struct mem_context_header *header;
+	struct region_file file;
+	struct region_device rdev;
+	const struct cbmem_entry *entry;
+	size_t size;
+
+	if (acpi_is_wakeup_s3())
+		return;
+
+	entry = cbmem_entry_find(CBMEM_ID_MRCDATA);
+	if (entry == NULL)
+		return;
+
+	header = cbmem_entry_start(entry);
+	size = sizeof(*header) + header->size;
+
+	if (mem_context_open(&file, 1) < 0) {
+		printk(BIOS_ERR, "AGESA: No %s region in the FMAP\n",
+		       MEM_CONTEXT_REGION);
+		return;
+	}
+
+	/* Training may well end up with the same values, save the flash. */
+	if (region_file_data(&file, &rdev) == 0 &&
+	    region_device_sz(&rdev) == size) {
+		const void *old = rdev_mmap_full(&rdev);
+		int same = old != NULL && !memcmp(old, header, size);
+
+		if (old != NULL)
+			rdev_munmap(&rdev, (void *)old);
+		if (same)
+			return;
+	}
+
+	if (region_file_update_data(&file, header, size) < 0)
+		printk(BIOS_ERR, "AGESA: Failed to save the memory context\n");
+	else
+		printk(BIOS_DEBUG, "AGESA: Saved the memory context\n");
+}
+
+/* Like OemS3Save(), the SPI flash driver is only there in ramstage. */
+BOOT_STATE_INIT_ENTRY(BS_POST_DEVICE, BS_ON_ENTRY, mem_context_update, NULL);
+
+#endif /* ENV_RAMSTAGE */
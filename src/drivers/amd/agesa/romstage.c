@@ -107,6 +107,9 @@ void *asmlinkage romstage_main(unsigned long bist)
 		halt();
 	}
 
+	if (cbmem_initted)
+		agesa_mem_context_stash(cb);
+
 	romstage_handoff_init(cb->s3resume);
 
 	postcar_frame_init(&pcf, HIGH_ROMSTAGE_STACK_SIZE);
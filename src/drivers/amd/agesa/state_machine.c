@@ -148,8 +148,10 @@ static AGESA_STATUS romstage_dispatch(struct sysinfo *cb,
 			AMD_POST_PARAMS *param = (void *)StdHeader;
 			platform_BeforeInitPost(cb, param);
 			board_BeforeInitPost(cb, param);
+			agesa_mem_context_restore(param);
 			status = module_dispatch(func, StdHeader);
 			platform_AfterInitPost(cb, param);
+			agesa_mem_context_saved(cb, param);
 			break;
 		}
 
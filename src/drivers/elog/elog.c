@@ -26,7 +26,9 @@
 #include <boot_device.h>
 #include <commonlib/region.h>
 #include <fmap.h>
+#include <ip_checksum.h>
 #include <lib.h>
+#include <rules.h>
 #include <rtc.h>
 #include <smbios.h>
 #include <stdint.h>
@@ -56,6 +58,9 @@ static u16 shrink_size;
 static size_t mirror_last_write;
 static size_t nv_last_write;
 
+/* Start of the newest event in the mirror, 0 if there is none. */
+static size_t mirror_last_event;
+
 static struct region_device nv_dev;
 /* Device that mirrors the eventlog in memory. */
 static struct mem_region_device mirror_dev;
@@ -66,6 +71,9 @@ static enum {
 	ELOG_BROKEN,
 } elog_initialized = ELOG_UNINITIALIZED;
 
+/* Set once the events held back in the mirror have been written. */
+static bool elog_flushed;
+
 static inline struct region_device *mirror_dev_get(void)
 {
 	return &mirror_dev.rdev;
@@ -352,15 +360,99 @@ static void elog_nv_erase(void)
 		printk(BIOS_ERR, "ELOG: erase failure.\n");
 }
 
+#define ELOG_HINT_SIGNATURE	0x454c	/* 'LE' */
+
+/* Where the last event was when the log was last written to flash. */
+struct elog_hint {
+	u16 signature;
+	u16 last_event;
+	u16 checksum;
+} __packed;
+
+static void elog_hint_write(void)
+{
+#if IS_ENABLED(CONFIG_ARCH_X86)
+	struct elog_hint hint = {
+		.signature = ELOG_HINT_SIGNATURE,
+		.last_event = mirror_last_event,
+	};
+	u8 *p = (u8 *)&hint;
+	size_t i;
+
+	if (!CONFIG_ELOG_LAST_EVENT_CMOS_OFFSET)
+		return;
+
+	hint.checksum = compute_ip_checksum(&hint,
+		offsetof(struct elog_hint, checksum));
+
+	for (i = 0; i < sizeof(hint); i++)
+		cmos_write(p[i], CONFIG_ELOG_LAST_EVENT_CMOS_OFFSET + i);
+#endif
+}
+
+/* Return the offset of the last event if the hint points at one. */
+static size_t elog_hint_last_event(void)
+{
+#if IS_ENABLED(CONFIG_ARCH_X86)
+	struct elog_hint hint;
+	u8 *p = (u8 *)&hint;
+	const size_t type_offset = offsetof(struct event_header, type);
+	size_t i, len;
+	u8 type;
+
+	if (!CONFIG_ELOG_LAST_EVENT_CMOS_OFFSET)
+		return 0;
+
+	for (i = 0; i < sizeof(hint); i++)
+		p[i] = cmos_read(CONFIG_ELOG_LAST_EVENT_CMOS_OFFSET + i);
+
+	if (hint.signature != ELOG_HINT_SIGNATURE ||
+	    hint.checksum != compute_ip_checksum(&hint,
+				offsetof(struct elog_hint, checksum)))
+		return 0;
+
+	if (hint.last_event < elog_events_start() ||
+	    hint.last_event >= region_device_sz(&nv_dev))
+		return 0;
+
+	/* It must be a valid event with nothing after it. */
+	len = elog_is_event_valid(hint.last_event);
+	if (!len)
+		return 0;
+
+	if (rdev_readat(mirror_dev_get(), &type,
+			hint.last_event + len + type_offset, sizeof(type)) < 0)
+		return 0;
+
+	if (type != ELOG_TYPE_EOL)
+		return 0;
+
+	return hint.last_event;
+#else
+	return 0;
+#endif
+}
+
 /*
  * Scan the event area and validate each entry and update the ELOG state.
  */
 static int elog_update_event_buffer_state(void)
 {
 	size_t offset = elog_events_start();
+	size_t last_event;
 
 	elog_debug("elog_update_event_buffer_state()\n");
 
+	mirror_last_event = 0;
+
+	/* Everything before the last event written was valid back then. */
+	last_event = elog_hint_last_event();
+	if (last_event) {
+		elog_debug("ELOG: last event at 0x%zx\n", last_event);
+		elog_tandem_increment_last_write(last_event - offset);
+		offset = last_event;
+	}
+
 	/* Go through each event and validate it */
 	while (1) {
 		uint8_t type;
@@ -387,6 +479,7 @@ static int elog_update_event_buffer_state(void)
 		}
 
 		/* Move to the next event */
+		mirror_last_event = offset;
 		elog_tandem_increment_last_write(len);
 		offset += len;
 	}
@@ -715,6 +808,7 @@ static int elog_sync_to_nv(void)
 
 	elog_nv_write(offset, size);
 	elog_nv_increment_last_write(size);
+	elog_hint_write();
 
 	/*
 	 * If erase wasn't performed then don't rescan. Assume the appended
@@ -736,6 +830,13 @@ static int elog_sync_to_nv(void)
 	return 0;
 }
 
+/* Only ramstage holds back events, SMM has no end of boot to wait for. */
+static bool elog_nv_writes_deferred(void)
+{
+	return IS_ENABLED(CONFIG_ELOG_DEFER_NV_WRITES) && ENV_RAMSTAGE &&
+		!elog_flushed;
+}
+
 /*
  * Do not log boot count events in S3 resume or SMM.
  */
@@ -879,6 +980,8 @@ int elog_add_event_raw(u8 event_type, void *data, u8 data_size)
 	if (data_size)
 		memcpy(&event[1], data, data_size);
 
+	mirror_last_event = mirror_last_write;
+
 	/* Zero the checksum byte and then compute checksum */
 	elog_update_checksum(event, 0);
 	elog_update_checksum(event, -(elog_checksum_event(event)));
@@ -900,10 +1003,24 @@ int elog_add_event_raw(u8 event_type, void *data, u8 data_size)
 	if (elog_shrink() < 0)
 		return -1;
 
+	if (elog_nv_writes_deferred())
+		return 0;
+
 	/* Ensure the updates hit the non-volatile storage. */
 	return elog_sync_to_nv();
 }
 
+int elog_flush(void)
+{
+	if (elog_initialized != ELOG_INITIALIZED)
+		return -1;
+
+	/* Whatever comes after this is written right away. */
+	elog_flushed = true;
+
+	return elog_sync_to_nv();
+}
+
 int elog_add_event(u8 event_type)
 {
 	return elog_add_event_raw(event_type, NULL, 0);
@@ -936,3 +1053,9 @@ int elog_add_event_wake(u8 source, u32 instance)
 /* Make sure elog_init() runs at least once to log System Boot event. */
 static void elog_bs_init(void *unused) { elog_init(); }
 BOOT_STATE_INIT_ENTRY(BS_POST_DEVICE, BS_ON_ENTRY, elog_bs_init, NULL);
+
+#if IS_ENABLED(CONFIG_ELOG_DEFER_NV_WRITES)
+static void elog_bs_flush(void *unused) { elog_flush(); }
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, elog_bs_flush, NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, elog_bs_flush, NULL);
+#endif
@@ -83,6 +83,10 @@ enum {
 	STATUS_SLAVE_ACTIVITY		= (1 << 6),
 };
 
+/* Component parameter register, FIFO depths are stored minus one */
+#define COMP_PARAM1_TX_DEPTH(p)		((((p) >> 16) & 0xff) + 1)
+#define COMP_PARAM1_RX_DEPTH(p)		((((p) >> 8) & 0xff) + 1)
+
 /* Enable register definitions */
 enum {
 	ENABLE_CONTROLLER		= (1 << 0),
@@ -304,42 +308,112 @@ static int dw_i2c_wait_for_bus_idle(struct dw_i2c_regs *regs)
 	return -1;
 }
 
-/* Transfer one byte of one segment, sending stop bit if requested */
-static int dw_i2c_transfer_byte(struct dw_i2c_regs *regs,
-				  const struct i2c_msg *segment,
-				  size_t byte, int send_stop)
+/* Return the first segment from seg on that has data (to read, if rd). */
+static const struct i2c_msg *dw_i2c_next_segment(const struct i2c_msg *seg,
+						 const struct i2c_msg *end,
+						 int rd)
+{
+	while (seg < end && (!seg->len || (rd && !(seg->flags & I2C_M_RD))))
+		seg++;
+	return seg;
+}
+
+/*
+ * Transfer all bytes of all segments, sending a stop bit after the last one.
+ *
+ * Commands are queued as long as the TX FIFO has room and read data is
+ * collected as soon as it shows up in the RX FIFO, so the controller is
+ * kept busy across bytes and segments instead of waiting on the CPU after
+ * each one. Reads in flight are capped at the RX FIFO depth so it can't
+ * overrun.
+ */
+static int dw_i2c_transfer_segments(struct dw_i2c_regs *regs,
+				    const struct i2c_msg *segments,
+				    size_t count)
 {
+	const struct i2c_msg *end = segments + count;
+	const struct i2c_msg *last = NULL;
+	const struct i2c_msg *tx_seg, *rx_seg;
+	size_t tx_byte = 0, rx_byte = 0;
+	size_t tx_depth, rx_depth, reads_pending = 0;
 	struct stopwatch sw;
-	uint32_t cmd = CMD_DATA_CMD; /* Read op */
+	uint32_t param;
+
+	param = read32(&regs->comp_param1);
+	tx_depth = COMP_PARAM1_TX_DEPTH(param);
+	rx_depth = COMP_PARAM1_RX_DEPTH(param);
+
+	for (tx_seg = segments; tx_seg < end; tx_seg++)
+		if (tx_seg->len)
+			last = tx_seg;
+
+	tx_seg = dw_i2c_next_segment(segments, end, 0);
+	rx_seg = dw_i2c_next_segment(segments, end, 1);
 
 	stopwatch_init_usecs_expire(&sw, DW_I2C_TIMEOUT_US);
 
-	if (!(segment->flags & I2C_M_RD)) {
-		/* Write op only: Wait for FIFO not full */
-		while (!(read32(&regs->status) & STATUS_TX_FIFO_NOT_FULL)) {
-			if (stopwatch_expired(&sw)) {
-				printk(BIOS_ERR, "I2C transmit timeout\n");
-				return -1;
-			}
+	while (tx_seg < end || rx_seg < end) {
+		size_t tx_room, rx_avail;
+		int progress = 0;
+
+		if (read32(&regs->raw_intr_stat) & INTR_STAT_TX_ABORT) {
+			printk(BIOS_ERR, "I2C transfer aborted, source 0x%x\n",
+			       read32(&regs->tx_abort_source));
+			return -1;
 		}
-		cmd = segment->buf[byte];
-	}
 
-	/* Send stop on last byte, if desired */
-	if (send_stop && byte == segment->len - 1)
-		cmd |= CMD_DATA_STOP;
+		/* Fill the TX FIFO with data or read commands */
+		tx_room = tx_depth - MIN(read32(&regs->tx_level), tx_depth);
+		while (tx_seg < end && tx_room) {
+			uint32_t cmd;
+
+			if (tx_seg->flags & I2C_M_RD) {
+				if (reads_pending == rx_depth)
+					break;
+				cmd = CMD_DATA_CMD;
+				reads_pending++;
+			} else {
+				cmd = tx_seg->buf[tx_byte];
+			}
 
-	write32(&regs->cmd_data, cmd);
+			/*
+			 * Set stop condition on final byte only. Repeated
+			 * start will be automatically generated by the
+			 * controller on R->W or W->R switch.
+			 */
+			if (tx_seg == last && tx_byte == tx_seg->len - 1)
+				cmd |= CMD_DATA_STOP;
 
-	if (segment->flags & I2C_M_RD) {
-		/* Read op only: Wait for FIFO data and store it */
-		while (!(read32(&regs->status) & STATUS_RX_FIFO_NOT_EMPTY)) {
-			if (stopwatch_expired(&sw)) {
-				printk(BIOS_ERR, "I2C receive timeout\n");
-				return -1;
+			write32(&regs->cmd_data, cmd);
+			tx_room--;
+			progress = 1;
+
+			if (++tx_byte == tx_seg->len) {
+				tx_seg = dw_i2c_next_segment(tx_seg + 1, end, 0);
+				tx_byte = 0;
 			}
 		}
-		segment->buf[byte] = read32(&regs->cmd_data);
+
+		/* Drain whatever the RX FIFO holds into the read segments */
+		rx_avail = read32(&regs->rx_level);
+		while (rx_seg < end && rx_avail--) {
+			rx_seg->buf[rx_byte] = read32(&regs->cmd_data);
+			reads_pending--;
+			progress = 1;
+
+			if (++rx_byte == rx_seg->len) {
+				rx_seg = dw_i2c_next_segment(rx_seg + 1, end, 1);
+				rx_byte = 0;
+			}
+		}
+
+		if (progress) {
+			stopwatch_init_usecs_expire(&sw, DW_I2C_TIMEOUT_US);
+		} else if (stopwatch_expired(&sw)) {
+			printk(BIOS_ERR, "I2C %s timeout\n",
+			       tx_seg < end ? "transmit" : "receive");
+			return -1;
+		}
 	}
 
 	return 0;
@@ -350,7 +424,8 @@ static int _dw_i2c_transfer(unsigned int bus, const struct i2c_msg *segments,
 {
 	struct stopwatch sw;
 	struct dw_i2c_regs *regs;
-	size_t byte;
+	size_t i;
+	int j;
 	int ret = -1;
 
 	regs = (struct dw_i2c_regs *)dw_i2c_base_address(bus);
@@ -368,40 +443,22 @@ static int _dw_i2c_transfer(unsigned int bus, const struct i2c_msg *segments,
 
 	dw_i2c_enable(regs);
 
-	/* Process each segment */
-	while (count--) {
-		if (IS_ENABLED(CONFIG_DRIVERS_I2C_DESIGNWARE_DEBUG)) {
-			printk(BIOS_DEBUG, "i2c %u:%02x %s %d bytes : ",
-			       bus, segments->slave,
-			       (segments->flags & I2C_M_RD) ? "R" : "W",
-			       segments->len);
-		}
-
-		/* Read or write each byte in segment */
-		for (byte = 0; byte < segments->len; byte++) {
-			/*
-			 * Set stop condition on final segment only.
-			 * Repeated start will be automatically generated
-			 * by the controller on R->W or W->R switch.
-			 */
-			if (dw_i2c_transfer_byte(regs, segments, byte,
-						   count == 0) < 0) {
-				printk(BIOS_ERR, "I2C %s failed: bus %u "
-				       "addr 0x%02x\n",
-				       (segments->flags & I2C_M_RD) ?
-				       "read" : "write", bus, segments->slave);
-				goto out;
-			}
-		}
+	if (dw_i2c_transfer_segments(regs, segments, count) < 0) {
+		printk(BIOS_ERR, "I2C transfer failed: bus %u addr 0x%02x\n",
+		       bus, segments->slave);
+		goto out;
+	}
 
-		if (IS_ENABLED(CONFIG_DRIVERS_I2C_DESIGNWARE_DEBUG)) {
-			int j;
-			for (j = 0; j < segments->len; j++)
-				printk(BIOS_DEBUG, "%02x ", segments->buf[j]);
+	if (IS_ENABLED(CONFIG_DRIVERS_I2C_DESIGNWARE_DEBUG)) {
+		for (i = 0; i < count; i++) {
+			printk(BIOS_DEBUG, "i2c %u:%02x %s %d bytes : ",
+			       bus, segments[i].slave,
+			       (segments[i].flags & I2C_M_RD) ? "R" : "W",
+			       segments[i].len);
+			for (j = 0; j < segments[i].len; j++)
+				printk(BIOS_DEBUG, "%02x ", segments[i].buf[j]);
 			printk(BIOS_DEBUG, "\n");
 		}
-
-		segments++;
 	}
 
 	/* Wait for interrupt status to indicate transfer is complete */
@@ -75,15 +75,7 @@ __weak int tis_plat_irq_status(void)
 /* Wait for interrupt to indicate the TPM is ready */
 static int cr50_i2c_wait_tpm_ready(struct tpm_chip *chip)
 {
-	struct stopwatch sw;
-
-	stopwatch_init_msecs_expire(&sw, CR50_TIMEOUT_IRQ_MS);
-
-	while (!tis_plat_irq_status())
-		if (stopwatch_expired(&sw))
-			return -1;
-
-	return 0;
+	return tis_wait_irq(CR50_TIMEOUT_IRQ_MS) ? 0 : -1;
 }
 
 /*
@@ -73,8 +73,7 @@ int tis_init(void)
 				CONFIG_DRIVER_TPM_I2C_ADDR);
 }
 
-static ssize_t tpm_transmit(const uint8_t *sbuf, size_t sbufsiz, void *rbuf,
-			size_t rbufsiz)
+static int tpm_send(const uint8_t *sbuf, size_t sbufsiz)
 {
 	int rc;
 	uint32_t count;
@@ -100,9 +99,17 @@ static ssize_t tpm_transmit(const uint8_t *sbuf, size_t sbufsiz, void *rbuf,
 	rc = chip->vendor.send(chip, (uint8_t *) sbuf, count);
 	if (rc < 0) {
 		printk(BIOS_DEBUG, "tpm_transmit: tpm_send error\n");
-		goto out;
+		return -1;
 	}
 
+	return 0;
+}
+
+static ssize_t tpm_recv(void *rbuf, size_t rbufsiz)
+{
+	int rc;
+	struct tpm_chip *chip = car_get_var_ptr(&g_chip);
+
 	int timeout = 2 * 60 * 1000; /* two minutes timeout */
 	while (timeout) {
 		ASSERT(chip->vendor.status);
@@ -137,8 +144,7 @@ out:
 	return rc;
 }
 
-int tis_sendrecv(const uint8_t *sendbuf, size_t sbuf_size,
-		uint8_t *recvbuf, size_t *rbuf_len)
+int tis_send(const uint8_t *sendbuf, size_t sbuf_size)
 {
 	ASSERT(sbuf_size >= 10);
 
@@ -150,7 +156,12 @@ int tis_sendrecv(const uint8_t *sendbuf, size_t sbuf_size,
 		hexdump(sendbuf, sbuf_size);
 	}
 
-	int len = tpm_transmit(sendbuf, sbuf_size, recvbuf, *rbuf_len);
+	return tpm_send(sendbuf, sbuf_size);
+}
+
+int tis_recv(uint8_t *recvbuf, size_t *rbuf_len)
+{
+	int len = tpm_recv(recvbuf, *rbuf_len);
 
 	if (len < 10) {
 		*rbuf_len = 0;
@@ -174,3 +185,14 @@ int tis_sendrecv(const uint8_t *sendbuf, size_t sbuf_size,
 
 	return 0;
 }
+
+int tis_sendrecv(const uint8_t *sendbuf, size_t sbuf_size,
+		uint8_t *recvbuf, size_t *rbuf_len)
+{
+	if (tis_send(sendbuf, sbuf_size)) {
+		*rbuf_len = 0;
+		return -1;
+	}
+
+	return tis_recv(recvbuf, rbuf_len);
+}
@@ -103,17 +103,115 @@ struct hob_resource *fsp_hob_header_to_resource(const struct hob_header *hob)
 
 static void *fsp_hob_list_ptr CAR_GLOBAL;
 
+/*
+ * Kept in CBMEM behind the HOB list pointer: an open addressing hash table
+ * of the resource descriptor and GUID extension HOBs, keyed by type and
+ * GUID, so lookups don't walk the whole list. Slots hold the offset of the
+ * HOB from the start of the list, 0 marks an empty slot since the list
+ * starts with the handoff HOB. Only the first HOB of a type and GUID is
+ * entered, which is the one a walk would find.
+ */
+struct hob_index {
+	uint32_t hob_list;
+	uint32_t slots;
+	uint32_t offset[0];
+};
+
+static bool hob_is_indexed(const struct hob_header *hob)
+{
+	return hob->type == HOB_TYPE_RESOURCE_DESCRIPTOR ||
+		hob->type == HOB_TYPE_GUID_EXTENSION;
+}
+
+static const uint8_t *hob_guid(const struct hob_header *hob)
+{
+	if (hob->type == HOB_TYPE_RESOURCE_DESCRIPTOR)
+		return fsp_hob_header_to_resource(hob)->owner_guid;
+	return hob_header_to_struct(hob);
+}
+
+static uint32_t hob_index_hash(uint16_t type, const uint8_t guid[16],
+			       uint32_t slots)
+{
+	uint32_t key;
+
+	/* The first GUID field is the one that differs between GUIDs. */
+	memcpy(&key, guid, sizeof(key));
+	return ((key ^ type) * 0x9e3779b1) & (slots - 1);
+}
+
+static const struct hob_header *hob_index_find(const struct hob_index *idx,
+					       uint16_t type,
+					       const uint8_t guid[16])
+{
+	const struct hob_header *hob;
+	uint32_t i;
+
+	i = hob_index_hash(type, guid, idx->slots);
+	for (; idx->offset[i]; i = (i + 1) & (idx->slots - 1)) {
+		hob = (void *)(uintptr_t)(idx->hob_list + idx->offset[i]);
+		if (hob->type == type && fsp_guid_compare(hob_guid(hob), guid))
+			return hob;
+	}
+	return NULL;
+}
+
+static void hob_index_build(struct hob_index *idx)
+{
+	const struct hob_header *hob;
+	uint32_t i;
+
+	memset(idx->offset, 0, idx->slots * sizeof(idx->offset[0]));
+
+	for (hob = (void *)(uintptr_t)idx->hob_list;
+	     hob->type != HOB_TYPE_END_OF_HOB_LIST; hob = fsp_next_hob(hob)) {
+		if (!hob_is_indexed(hob) ||
+		    hob_index_find(idx, hob->type, hob_guid(hob)))
+			continue;
+
+		i = hob_index_hash(hob->type, hob_guid(hob), idx->slots);
+		while (idx->offset[i])
+			i = (i + 1) & (idx->slots - 1);
+		idx->offset[i] = (uintptr_t)hob - idx->hob_list;
+	}
+}
+
 static void save_hob_list(int is_recovery)
 {
-	uint32_t *cbmem_loc;
+	const struct cbmem_entry *entry;
+	const struct hob_header *hob;
+	struct hob_index *idx;
 	const void *hob_list;
-	cbmem_loc = cbmem_add(CBMEM_ID_FSP_RUNTIME, sizeof(*cbmem_loc));
-	if (cbmem_loc == NULL)
-		die("Error: Could not add cbmem area for hob list.\n");
+	uint32_t count = 0, slots = 1;
+	size_t size;
+
 	hob_list = fsp_get_hob_list();
 	if (!hob_list)
 		die("Error: Could not locate hob list pointer.\n");
-	*cbmem_loc = (uintptr_t)hob_list;
+
+	/* Keep the table at most half full. */
+	for (hob = hob_list; hob->type != HOB_TYPE_END_OF_HOB_LIST;
+	     hob = fsp_next_hob(hob))
+		count += hob_is_indexed(hob);
+	while (slots < 2 * count)
+		slots <<= 1;
+
+	size = sizeof(*idx) + slots * sizeof(idx->offset[0]);
+	entry = cbmem_entry_add(CBMEM_ID_FSP_RUNTIME, size);
+	if (entry == NULL)
+		die("Error: Could not add cbmem area for hob list.\n");
+	idx = cbmem_entry_start(entry);
+
+	idx->hob_list = (uintptr_t)hob_list;
+
+	/* An entry left from the previous boot on resume may be too small. */
+	if (cbmem_entry_size(entry) < size) {
+		idx->slots = 0;
+		return;
+	}
+
+	idx->slots = slots;
+	hob_index_build(idx);
 }
 
 ROMSTAGE_CBMEM_INIT_HOOK(save_hob_list);
@@ -133,25 +231,38 @@ void *fsp_get_hob_list_ptr(void)
 	return car_get_var_ptr(&fsp_hob_list_ptr);
 }
 
-static const
-struct hob_resource *find_resource_hob_by_guid(const struct hob_header *hob,
-					       const uint8_t guid[16])
+static const struct hob_header *find_hob_by_guid(const struct hob_header *hob,
+						 uint16_t type,
+						 const uint8_t guid[16])
 {
-	const struct hob_resource *res;
+	const struct hob_index *idx = NULL;
+
+	/*
+	 * Not in romstage: finding CBMEM there goes through cbmem_top(),
+	 * which may itself look up the FSP reserved memory HOB.
+	 */
+	if (ENV_RAMSTAGE)
+		idx = cbmem_find(CBMEM_ID_FSP_RUNTIME);
+	if (idx && idx->slots && idx->hob_list == (uintptr_t)hob)
+		return hob_index_find(idx, type, guid);
 
 	for ( ; hob->type != HOB_TYPE_END_OF_HOB_LIST;
 		hob = fsp_next_hob(hob)) {
 
-		if (hob->type != HOB_TYPE_RESOURCE_DESCRIPTOR)
-			continue;
-
-		res = fsp_hob_header_to_resource(hob);
-		if (fsp_guid_compare(res->owner_guid, guid))
-			return res;
+		if (hob->type == type && fsp_guid_compare(hob_guid(hob), guid))
+			return hob;
 	}
 	return NULL;
 }
 
+static const
+struct hob_resource *find_resource_hob_by_guid(const struct hob_header *hob,
+					       const uint8_t guid[16])
+{
+	hob = find_hob_by_guid(hob, HOB_TYPE_RESOURCE_DESCRIPTOR, guid);
+	return hob ? fsp_hob_header_to_resource(hob) : NULL;
+}
+
 void fsp_print_guid(const void *base)
 {
 	uint32_t big;
@@ -196,26 +307,17 @@ int fsp_find_reserved_memory(struct range_entry *re)
 
 const void *fsp_find_extension_hob_by_guid(const uint8_t *guid, size_t *size)
 {
-	const uint8_t *hob_guid;
 	const struct hob_header *hob = fsp_get_hob_list();
 
 	if (!hob)
 		return NULL;
 
-	for ( ; hob->type != HOB_TYPE_END_OF_HOB_LIST;
-		hob = fsp_next_hob(hob)) {
-
-		if (hob->type != HOB_TYPE_GUID_EXTENSION)
-			continue;
-
-		hob_guid = hob_header_to_struct(hob);
-		if (fsp_guid_compare(hob_guid, guid)) {
-			*size = hob->length - (HOB_HEADER_LEN + 16);
-			return hob_header_to_extension_hob(hob);
-		}
-	}
+	hob = find_hob_by_guid(hob, HOB_TYPE_GUID_EXTENSION, guid);
+	if (!hob)
+		return NULL;
 
-	return NULL;
+	*size = hob->length - (HOB_HEADER_LEN + 16);
+	return hob_header_to_extension_hob(hob);
 }
 
 static void display_fsp_version_info_hob(const void *hob, size_t size)
@@ -381,10 +381,16 @@ void fsp_memory_init(bool s3wake)
 		_car_relocatable_data_end - _car_region_start, 0);
 	memranges_insert(&memmap, (uintptr_t)_program, _program_size, 0);
 
+	/*
+	 * Whether copying FSP-M out of flash pays off over running it in
+	 * place depends on the flash, so record it for comparing builds.
+	 */
+	timestamp_add_now(TS_FSPM_LOAD_START);
 	if (!IS_ENABLED(CONFIG_FSP_M_XIP))
 		status = load_fspm_mem(&hdr, &file_data, &memmap);
 	else
 		status = load_fspm_xip(&hdr, &file_data);
+	timestamp_add_now(TS_FSPM_LOAD_END);
 
 	if (status != CB_SUCCESS)
 		die("Loading FSPM failed!\n");
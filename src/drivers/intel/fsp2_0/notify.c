@@ -12,6 +12,8 @@
 
 #include <arch/cpu.h>
 #include <bootstate.h>
+#include <bs_times.h>
+#include <commonlib/helpers.h>
 #include <compiler.h>
 #include <console/console.h>
 #include <fsp/util.h>
@@ -19,11 +21,46 @@
 #include <string.h>
 #include <timestamp.h>
 
-static void fsp_notify(enum fsp_notify_phase phase)
+struct notify_phase_info {
+	enum fsp_notify_phase phase;
+	const char *name;
+	uint16_t ts_before;
+	uint16_t ts_after;
+	uint8_t post_before;
+	uint8_t post_after;
+};
+
+static const struct notify_phase_info notify_phases[] = {
+	{ AFTER_PCI_ENUM, "AfterPciEnumeration",
+	  TS_FSP_BEFORE_ENUMERATE, TS_FSP_AFTER_ENUMERATE,
+	  POST_FSP_NOTIFY_BEFORE_ENUMERATE, POST_FSP_NOTIFY_BEFORE_ENUMERATE },
+	{ READY_TO_BOOT, "ReadyToBoot",
+	  TS_FSP_BEFORE_FINALIZE, TS_FSP_AFTER_FINALIZE,
+	  POST_FSP_NOTIFY_BEFORE_FINALIZE, POST_FSP_NOTIFY_BEFORE_FINALIZE },
+	{ END_OF_FIRMWARE, "EndOfFirmware",
+	  TS_FSP_BEFORE_END_OF_FIRMWARE, TS_FSP_AFTER_END_OF_FIRMWARE,
+	  POST_FSP_NOTIFY_BEFORE_END_OF_FIRMWARE,
+	  POST_FSP_NOTIFY_AFTER_END_OF_FIRMWARE },
+};
+
+static const struct notify_phase_info *notify_phase_info(
+	enum fsp_notify_phase phase)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(notify_phases); i++)
+		if (notify_phases[i].phase == phase)
+			return &notify_phases[i];
+	return NULL;
+}
+
+static void fsp_notify(enum fsp_notify_phase phase, boot_state_t state)
 {
 	uint32_t ret;
 	fsp_notify_fn fspnotify;
 	struct fsp_notify_params notify_params = { .phase = phase };
+	const struct notify_phase_info *info = notify_phase_info(phase);
+	struct mono_time start;
 
 	if (!fsps_hdr.notify_phase_entry_offset)
 		die("Notify_phase_entry_offset is zero!\n");
@@ -32,28 +69,19 @@ static void fsp_notify(enum fsp_notify_phase phase)
 			    fsps_hdr.notify_phase_entry_offset);
 	fsp_before_debug_notify(fspnotify, &notify_params);
 
-	if (phase == AFTER_PCI_ENUM) {
-		timestamp_add_now(TS_FSP_BEFORE_ENUMERATE);
-		post_code(POST_FSP_NOTIFY_BEFORE_ENUMERATE);
-	} else if (phase == READY_TO_BOOT) {
-		timestamp_add_now(TS_FSP_BEFORE_FINALIZE);
-		post_code(POST_FSP_NOTIFY_BEFORE_FINALIZE);
-	} else if (phase == END_OF_FIRMWARE) {
-		timestamp_add_now(TS_FSP_BEFORE_END_OF_FIRMWARE);
-		post_code(POST_FSP_NOTIFY_BEFORE_END_OF_FIRMWARE);
+	if (info) {
+		timestamp_add_now(info->ts_before);
+		post_code(info->post_before);
 	}
 
+	bs_times_start(&start);
 	ret = fspnotify(&notify_params);
 
-	if (phase == AFTER_PCI_ENUM) {
-		timestamp_add_now(TS_FSP_AFTER_ENUMERATE);
-		post_code(POST_FSP_NOTIFY_BEFORE_ENUMERATE);
-	} else if (phase == READY_TO_BOOT) {
-		timestamp_add_now(TS_FSP_AFTER_FINALIZE);
-		post_code(POST_FSP_NOTIFY_BEFORE_FINALIZE);
-	} else if (phase == END_OF_FIRMWARE) {
-		timestamp_add_now(TS_FSP_AFTER_END_OF_FIRMWARE);
-		post_code(POST_FSP_NOTIFY_AFTER_END_OF_FIRMWARE);
+	if (info) {
+		timestamp_add_now(info->ts_after);
+		post_code(info->post_after);
+		bs_times_stop(&start, BS_TIMES_FSP_NOTIFY, state,
+			      (uintptr_t)fspnotify, info->name);
 	}
 	fsp_debug_after_notify(ret);
 
@@ -68,25 +96,38 @@ static void fsp_notify(enum fsp_notify_phase phase)
 	platform_fsp_notify_status(phase);
 }
 
-static void fsp_notify_dummy(void *arg)
+static void fsp_notify_dummy(enum fsp_notify_phase phase, boot_state_t state)
 {
-	enum fsp_notify_phase phase = (uint32_t)arg;
-
 	/* Display the MTRRs */
 	if (IS_ENABLED(CONFIG_DISPLAY_MTRRS))
 		soc_display_mtrrs();
 
-	fsp_notify(phase);
+	fsp_notify(phase, state);
 	if (phase == READY_TO_BOOT)
-		fsp_notify(END_OF_FIRMWARE);
+		fsp_notify(END_OF_FIRMWARE, state);
+}
+
+static void fsp_notify_after_pci_enum(void *unused)
+{
+	fsp_notify_dummy(AFTER_PCI_ENUM, BS_DEV_ENABLE);
+}
+
+static void fsp_notify_ready_to_boot(void *unused)
+{
+	fsp_notify_dummy(READY_TO_BOOT, BS_PAYLOAD_LOAD);
+}
+
+static void fsp_notify_ready_to_resume(void *unused)
+{
+	fsp_notify_dummy(READY_TO_BOOT, BS_OS_RESUME);
 }
 
-BOOT_STATE_INIT_ENTRY(BS_DEV_ENABLE, BS_ON_ENTRY, fsp_notify_dummy,
-						(void *) AFTER_PCI_ENUM);
-BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_LOAD, BS_ON_EXIT, fsp_notify_dummy,
-						(void *) READY_TO_BOOT);
-BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, fsp_notify_dummy,
-						(void *) READY_TO_BOOT);
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENABLE, BS_ON_ENTRY, fsp_notify_after_pci_enum,
+						NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_LOAD, BS_ON_EXIT, fsp_notify_ready_to_boot,
+						NULL);
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, fsp_notify_ready_to_resume,
+						NULL);
 
 __weak void platform_fsp_notify_status(
 	enum fsp_notify_phase phase)
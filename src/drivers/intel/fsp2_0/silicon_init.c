@@ -71,18 +71,22 @@ void fsps_load(bool s3wake)
 	struct region_device rdev;
 	const char *name = CONFIG_FSP_S_CBFS;
 	void *dest;
-	size_t size;
+	size_t size, buf_size;
+	uint32_t compression;
 	struct prog fsps = PROG_INIT(PROG_REFCODE, name);
 	static int load_done;
 
 	if (load_done)
 		return;
 
+	timestamp_add_now(TS_FSPS_LOAD_START);
+
 	if (s3wake && !IS_ENABLED(CONFIG_NO_STAGE_CACHE)) {
 		printk(BIOS_DEBUG, "Loading FSPS from stage_cache\n");
 		stage_cache_load_stage(STAGE_REFCODE, &fsps);
 		if (fsp_validate_component(hdr, prog_rdev(&fsps)) != CB_SUCCESS)
 			die("On resume fsps header is invalid\n");
+		timestamp_add_now(TS_FSPS_LOAD_END);
 		load_done = 1;
 		return;
 	}
@@ -94,14 +98,22 @@ void fsps_load(bool s3wake)
 
 	cbfs_file_data(&rdev, &file_desc);
 
+	if (cbfsf_decompression_info(&file_desc, &compression, &size) < 0)
+		die("Failed to read FSPS metadata!\n");
+
+	/* LZ4 decompresses in place and needs a little room at the end. */
+	buf_size = size;
+	if (compression == CBFS_COMPRESS_LZ4)
+		buf_size += 8 + size / 255;
+
 	/* Load and relocate into CBMEM. */
-	size = region_device_sz(&rdev);
-	dest = cbmem_add(CBMEM_ID_REFCODE, size);
+	dest = cbmem_add(CBMEM_ID_REFCODE, buf_size);
 
 	if (dest == NULL)
 		die("Could not add FSPS to CBMEM!\n");
 
-	if (rdev_readat(&rdev, dest, 0, size) < 0)
+	if (cbfs_load_and_decompress(&rdev, 0, region_device_sz(&rdev), dest,
+				     buf_size, compression) != size)
 		die("Failed to read FSPS!\n");
 
 	if (fsp_component_relocate((uintptr_t)dest, dest, size) < 0)
@@ -119,6 +131,7 @@ void fsps_load(bool s3wake)
 
 	/* Signal that FSP component has been loaded. */
 	prog_segment_loaded(hdr->image_base, hdr->image_size, SEG_FINAL);
+	timestamp_add_now(TS_FSPS_LOAD_END);
 	load_done = 1;
 }
 
@@ -18,6 +18,10 @@
 #include <arch/io.h>
 #include <console/console.h>
 #include <delay.h>
+#include <fmap.h>
+#include <ip_checksum.h>
+#include <region_file.h>
+#include <string.h>
 
 #include "i915_reg.h"
 #include "edid.h"
@@ -66,13 +70,11 @@ void intel_gmbus_stop(u8 *mmio)
 	intel_gmbus_stop_bus(mmio, 2);
 }
 
-void intel_gmbus_read_edid(u8 *mmio, u8 bus, u8 slave, u8 *edid, u32 edid_size)
+static void intel_gmbus_read(u8 *mmio, u8 bus, u8 slave, u8 offset,
+			     u8 *buf, u32 size)
 {
 	int i;
 
-	slave &= 0x7f;
-	edid_size &= 0x1fc;
-
 	wait_rdy(mmio);
 	/* 100 KHz, hold 0ns,  */
 	write32(GMBUS0_ADDR, bus);
@@ -80,21 +82,21 @@ void intel_gmbus_read_edid(u8 *mmio, u8 bus, u8 slave, u8 *edid, u32 edid_size)
 	/* Ensure index bits are disabled.  */
 	write32(GMBUS5_ADDR, 0);
 	write32(GMBUS1_ADDR, GMBUS_SW_RDY | GMBUS_CYCLE_WAIT | GMBUS_CYCLE_INDEX
-		| (slave << 1) );
+		| (offset << GMBUS_SLAVE_INDEX_SHIFT) | (slave << 1) );
 	wait_rdy(mmio);
 	/* Ensure index bits are disabled.  */
 	write32(GMBUS5_ADDR, 0);
 	write32(GMBUS1_ADDR, GMBUS_SW_RDY | GMBUS_SLAVE_READ | GMBUS_CYCLE_WAIT
 		| GMBUS_CYCLE_STOP
-		| (edid_size << GMBUS_BYTE_COUNT_SHIFT) | (slave << 1) );
-	for (i = 0; i < edid_size / 4; i++) {
+		| (size << GMBUS_BYTE_COUNT_SHIFT) | (slave << 1) );
+	for (i = 0; i < size / 4; i++) {
 		u32 reg32;
 		wait_rdy(mmio);
 		reg32 = read32(GMBUS3_ADDR);
-		edid[4 * i] = reg32 & 0xff;
-		edid[4 * i + 1] = (reg32 >> 8) & 0xff;
-		edid[4 * i + 2] = (reg32 >> 16) & 0xff;
-		edid[4 * i + 3] = (reg32 >> 24) & 0xff;
+		buf[4 * i] = reg32 & 0xff;
+		buf[4 * i + 1] = (reg32 >> 8) & 0xff;
+		buf[4 * i + 2] = (reg32 >> 16) & 0xff;
+		buf[4 * i + 3] = (reg32 >> 24) & 0xff;
 	}
 	wait_rdy(mmio);
 	write32(GMBUS1_ADDR, GMBUS_SW_RDY
@@ -103,6 +105,187 @@ void intel_gmbus_read_edid(u8 *mmio, u8 bus, u8 slave, u8 *edid, u32 edid_size)
 	wait_rdy(mmio);
 	write32(GMBUS1_ADDR, GMBUS_SW_RDY | GMBUS_CYCLE_STOP );
 	write32(GMBUS2_ADDR, GMBUS_INUSE);
+}
+
+/*
+ * EDID cache
+ *
+ * Reading a whole EDID at 100 KHz takes longer than the rest of the panel
+ * setup. The EDIDs of earlier boots are kept in flash, and only the bytes
+ * identifying the display plus the checksum are read back to tell if the
+ * same display is still attached.
+ */
+#define EDID_CACHE_REGION	"RW_EDID_CACHE"
+#define EDID_CACHE_SIGNATURE	0x44494445	/* 'EDID' */
+#define EDID_CACHE_ENTRIES	2
+#define EDID_CACHE_MAX_SIZE	256
+
+/* Manufacturer and product code, and the checksum of the base block */
+#define EDID_ID_OFFSET		8
+#define EDID_CSUM_OFFSET	124
+#define EDID_PROBE_SIZE		4
+
+struct edid_cache_entry {
+	u8 bus;
+	u8 slave;
+	u16 size;
+	u8 edid[EDID_CACHE_MAX_SIZE];
+};
+
+struct edid_cache {
+	u32 signature;
+	struct edid_cache_entry entry[EDID_CACHE_ENTRIES];
+	u32 checksum;
+};
+
+static struct edid_cache edid_cache;
+static int edid_cache_loaded;
+
+static int edid_cache_open(struct region_file *file, int rw)
+{
+	struct region_device rdev;
+	int ret;
+
+	if (rw)
+		ret = fmap_locate_area_as_rdev_rw(EDID_CACHE_REGION, &rdev);
+	else
+		ret = fmap_locate_area_as_rdev(EDID_CACHE_REGION, &rdev);
+	if (ret < 0)
+		return -1;
+
+	return region_file_init(file, &rdev);
+}
+
+static u32 edid_cache_checksum(const struct edid_cache *cache)
+{
+	return compute_ip_checksum(cache, offsetof(struct edid_cache, checksum));
+}
+
+static void edid_cache_load(void)
+{
+	struct region_file file;
+	struct region_device rdev;
+
+	if (edid_cache_loaded)
+		return;
+	edid_cache_loaded = 1;
+
+	if (edid_cache_open(&file, 0) < 0
+	    || region_file_data(&file, &rdev) < 0
+	    || region_device_sz(&rdev) != sizeof(edid_cache)
+	    || rdev_readat(&rdev, &edid_cache, 0, sizeof(edid_cache))
+	       != sizeof(edid_cache)
+	    || edid_cache.signature != EDID_CACHE_SIGNATURE
+	    || edid_cache.checksum != edid_cache_checksum(&edid_cache))
+		memset(&edid_cache, 0, sizeof(edid_cache));
+}
+
+static struct edid_cache_entry *edid_cache_find(u8 bus, u8 slave, u32 size)
+{
+	int i;
+
+	for (i = 0; i < EDID_CACHE_ENTRIES; i++) {
+		struct edid_cache_entry *entry = &edid_cache.entry[i];
+		if (entry->size == size && entry->bus == bus
+		    && entry->slave == slave)
+			return entry;
+	}
+	return NULL;
+}
+
+static int edid_cache_lookup(u8 *mmio, u8 bus, u8 slave, u8 *edid,
+			     u32 edid_size)
+{
+	struct edid_cache_entry *entry;
+	u8 probe[EDID_PROBE_SIZE];
+
+	edid_cache_load();
+
+	entry = edid_cache_find(bus, slave, edid_size);
+	if (!entry)
+		return -1;
+
+	intel_gmbus_read(mmio, bus, slave, EDID_ID_OFFSET, probe,
+			 sizeof(probe));
+	if (memcmp(probe, &entry->edid[EDID_ID_OFFSET], sizeof(probe)))
+		return -1;
+
+	intel_gmbus_read(mmio, bus, slave, EDID_CSUM_OFFSET, probe,
+			 sizeof(probe));
+	if (memcmp(probe, &entry->edid[EDID_CSUM_OFFSET], sizeof(probe)))
+		return -1;
+
+	printk(BIOS_DEBUG, "EDID: Using cached EDID for GMBUS port %u\n", bus);
+	memcpy(edid, entry->edid, edid_size);
+	return 0;
+}
+
+static int edid_base_block_valid(const u8 *edid)
+{
+	static const u8 header[8] = {
+		0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00
+	};
+	u8 sum = 0;
+	int i;
+
+	if (memcmp(edid, header, sizeof(header)))
+		return 0;
+	for (i = 0; i < 128; i++)
+		sum += edid[i];
+	return sum == 0;
+}
+
+static void edid_cache_update(u8 bus, u8 slave, const u8 *edid,
+			      u32 edid_size)
+{
+	struct edid_cache_entry *entry;
+	struct region_file file;
+	int i;
+
+	/* Nothing worth remembering without a display attached. */
+	if (edid_size < 128 || edid_size > EDID_CACHE_MAX_SIZE
+	    || !edid_base_block_valid(edid))
+		return;
+
+	entry = edid_cache_find(bus, slave, edid_size);
+	if (entry && !memcmp(entry->edid, edid, edid_size))
+		return;
+
+	/* Reuse the entry of this port, or else the first free one. */
+	for (i = 0; !entry && i < EDID_CACHE_ENTRIES; i++)
+		if (!edid_cache.entry[i].size)
+			entry = &edid_cache.entry[i];
+	if (!entry)
+		entry = &edid_cache.entry[0];
+
+	memset(entry, 0, sizeof(*entry));
+	entry->bus = bus;
+	entry->slave = slave;
+	entry->size = edid_size;
+	memcpy(entry->edid, edid, edid_size);
+
+	edid_cache.signature = EDID_CACHE_SIGNATURE;
+	edid_cache.checksum = edid_cache_checksum(&edid_cache);
+
+	if (edid_cache_open(&file, 1) < 0
+	    || region_file_update_data(&file, &edid_cache,
+				       sizeof(edid_cache)) < 0)
+		printk(BIOS_ERR, "EDID: Failed to update EDID cache\n");
+}
+
+void intel_gmbus_read_edid(u8 *mmio, u8 bus, u8 slave, u8 *edid, u32 edid_size)
+{
+	int i;
+
+	slave &= 0x7f;
+	edid_size &= 0x1fc;
+
+	if (!IS_ENABLED(CONFIG_INTEL_EDID_CACHE)
+	    || edid_cache_lookup(mmio, bus, slave, edid, edid_size)) {
+		intel_gmbus_read(mmio, bus, slave, 0, edid, edid_size);
+		if (IS_ENABLED(CONFIG_INTEL_EDID_CACHE))
+			edid_cache_update(bus, slave, edid, edid_size);
+	}
 
 	printk (BIOS_SPEW, "EDID:\n");
 	for (i = 0; i < 128; i++) {
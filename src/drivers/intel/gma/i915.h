@@ -84,6 +84,14 @@ void io_i915_write32(unsigned long val, unsigned long addr);
 void intel_prepare_ddi(void);
 
 int gtt_poll(u32 reg, u32 mask, u32 value);
+
+/*
+ * Wait for the panel power sequence to finish, then write `control` to
+ * `control_reg`. With INTEL_GMA_ASYNC_PANEL_POWER the wait happens in the
+ * background and is only enforced before the tables are written.
+ */
+void gma_panel_power_wait(u8 *mmio, u32 status_reg, u32 control_reg,
+			  u32 control);
 void gtt_write(u32 reg, u32 data);
 u32 gtt_read(u32 reg);
 
@@ -48,6 +48,22 @@ void *locate_vbt(size_t *vbt_size)
 
 	const char *filename = mainboard_vbt_filename();
 
+	/*
+	 * An uncompressed VBT had its signature checked at build time and
+	 * can be used in place.
+	 */
+	if (IS_ENABLED(CONFIG_INTEL_GMA_VBT_UNCOMPRESSED)) {
+		static void *vbt_mapped;
+		static size_t vbt_mapped_sz;
+
+		if (!vbt_mapped)
+			vbt_mapped = cbfs_boot_map_with_leak(filename,
+				CBFS_TYPE_RAW, &vbt_mapped_sz);
+		if (vbt_mapped && vbt_size)
+			*vbt_size = vbt_mapped_sz;
+		return vbt_mapped;
+	}
+
 	size_t file_size = cbfs_boot_load_file(filename,
 		vbt_data, sizeof(vbt_data), CBFS_TYPE_RAW);
 
@@ -0,0 +1,89 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/io.h>
+#include <bootstate.h>
+#include <console/console.h>
+#include <drivers/intel/gma/i915.h>
+#include <timer.h>
+
+/*
+ * The panel power sequencer steps through T1-T3 on its own once the panel
+ * was told to power on, which takes a couple of hundred milliseconds on
+ * most panels. Instead of spinning on PP_STATUS, poll it from the timer
+ * queue while the other devices are initialized.
+ */
+#define PANEL_POWER_POLL_USECS	1000
+
+static struct {
+	u8 *mmio;
+	u32 status_reg;
+	u32 control_reg;
+	u32 control;
+	int pending;
+	struct timeout_callback tocb;
+} panel_power;
+
+static int panel_power_sequence_done(void)
+{
+	u32 reg32 = read32(panel_power.mmio + panel_power.status_reg);
+
+	if ((reg32 & PP_SEQUENCE_MASK) != PP_SEQUENCE_NONE)
+		return 0;
+
+	write32(panel_power.mmio + panel_power.control_reg,
+		panel_power.control);
+	panel_power.pending = 0;
+	printk(BIOS_DEBUG, "panel powered up\n");
+	return 1;
+}
+
+static void panel_power_poll(struct timeout_callback *tocb)
+{
+	if (!panel_power_sequence_done())
+		timer_sched_callback(tocb, PANEL_POWER_POLL_USECS);
+}
+
+void gma_panel_power_wait(u8 *mmio, u32 status_reg, u32 control_reg,
+			  u32 control)
+{
+	panel_power.mmio = mmio;
+	panel_power.status_reg = status_reg;
+	panel_power.control_reg = control_reg;
+	panel_power.control = control;
+	panel_power.pending = 1;
+
+	printk(BIOS_DEBUG, "waiting for panel powerup\n");
+
+	if (IS_ENABLED(CONFIG_INTEL_GMA_ASYNC_PANEL_POWER)) {
+		panel_power.tocb.callback = panel_power_poll;
+		if (!timer_sched_callback(&panel_power.tocb,
+					  PANEL_POWER_POLL_USECS))
+			return;
+	}
+
+	while (!panel_power_sequence_done())
+		;
+}
+
+/* The panel has to be up before the framebuffer is handed over. */
+static void panel_power_finish(void *unused)
+{
+	if (!panel_power.pending)
+		return;
+
+	while (!panel_power_sequence_done())
+		;
+}
+
+BOOT_STATE_INIT_ENTRY(BS_WRITE_TABLES, BS_ON_ENTRY, panel_power_finish, NULL);
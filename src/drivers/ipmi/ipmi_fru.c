@@ -0,0 +1,386 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <commonlib/helpers.h>
+#include <commonlib/region.h>
+#include <console/console.h>
+#include <mrc_cache.h>
+#include <smbios.h>
+#include <stddef.h>
+#include <string.h>
+#include "ipmi_kcs.h"
+#include "ipmi_fru.h"
+
+#define FRU_DEVICE_ID		0
+/* Bytes per Read FRU Data, small enough for any BMC's KCS buffer */
+#define FRU_READ_CHUNK		16
+/* The areas used here come first, anything past this is ignored. */
+#define FRU_MAX_SIZE		1024
+#define FRU_CACHE_VERSION	1
+
+/* Common header, area offsets are in multiples of 8 bytes */
+#define FRU_COMMON_HEADER_LEN	8
+#define FRU_HDR_CHASSIS		2
+#define FRU_HDR_BOARD		3
+#define FRU_HDR_PRODUCT		4
+
+/* Bytes ahead of the first field of each area */
+#define FRU_CHASSIS_FIELDS	3
+#define FRU_BOARD_FIELDS	6
+#define FRU_PRODUCT_FIELDS	3
+
+/* Type/length byte of a field */
+#define FRU_FIELD_TYPE(x)	((x) >> 6)
+#define FRU_FIELD_LEN(x)	((x) & 0x3f)
+#define FRU_FIELD_BCD_PLUS	1
+#define FRU_FIELD_6BIT_ASCII	2
+#define FRU_FIELD_8BIT_ASCII	3
+#define FRU_FIELD_END		0xc1
+
+struct fru_image {
+	uint16_t size;
+	uint8_t data[FRU_MAX_SIZE];
+} __packed;
+
+struct fru_area_info_rsp {
+	struct ipmi_rsp resp;
+	uint16_t size;
+	uint8_t access;
+} __packed;
+
+struct fru_read_req {
+	uint8_t fru_device_id;
+	uint16_t offset;
+	uint8_t count;
+} __packed;
+
+struct fru_read_rsp {
+	struct ipmi_rsp resp;
+	uint8_t count;
+	uint8_t data[FRU_READ_CHUNK];
+} __packed;
+
+static struct fru_image fru;
+static struct ipmi_fru_info fru_info;
+/* 0: not read yet, 1: fru_info is valid, -1: reading the FRU failed */
+static int fru_state;
+
+static int fru_area_size(int port, size_t *size)
+{
+	const unsigned char req = FRU_DEVICE_ID;
+	struct fru_area_info_rsp rsp;
+	int ret;
+
+	ret = ipmi_kcs_message(port, IPMI_NETFN_STORAGE, 0,
+			       IPMI_STORAGE_GET_FRU_INVENTORY_AREA_INFO,
+			       &req, sizeof(req),
+			       (unsigned char *)&rsp, sizeof(rsp));
+	if (ret < (int)sizeof(rsp) || rsp.resp.completion_code)
+		return -1;
+
+	*size = MIN(rsp.size, FRU_MAX_SIZE);
+	return 0;
+}
+
+static int fru_read(int port, size_t offset, uint8_t *buf, size_t len)
+{
+	struct fru_read_req req = { .fru_device_id = FRU_DEVICE_ID };
+	struct fru_read_rsp rsp;
+	int ret;
+
+	while (len) {
+		req.offset = offset;
+		req.count = MIN(len, FRU_READ_CHUNK);
+
+		ret = ipmi_kcs_message(port, IPMI_NETFN_STORAGE, 0,
+				       IPMI_STORAGE_READ_FRU_DATA,
+				       (const unsigned char *)&req, sizeof(req),
+				       (unsigned char *)&rsp, sizeof(rsp));
+		if (ret < (int)offsetof(struct fru_read_rsp, data) ||
+		    rsp.resp.completion_code || !rsp.count ||
+		    rsp.count > req.count)
+			return -1;
+
+		memcpy(buf, rsp.data, rsp.count);
+		buf += rsp.count;
+		offset += rsp.count;
+		len -= rsp.count;
+	}
+
+	return 0;
+}
+
+static int fru_cache_load(struct fru_image *img)
+{
+	struct region_device rdev;
+	size_t size;
+
+	if (!IS_ENABLED(CONFIG_IPMI_FRU_CACHE))
+		return 0;
+
+	if (mrc_cache_get_current(MRC_IPMI_FRU_DATA, FRU_CACHE_VERSION,
+				  &rdev) < 0)
+		return 0;
+
+	size = region_device_sz(&rdev);
+	if (size < offsetof(struct fru_image, data) || size > sizeof(*img))
+		return 0;
+
+	if (rdev_readat(&rdev, img, 0, size) != size)
+		return 0;
+
+	return offsetof(struct fru_image, data) + img->size == size;
+}
+
+/*
+ * The FRU has no change counter, so compare its size, the common header and
+ * the checksum closing each area that is used. Any edit of an area changes
+ * its checksum unless the sum of the changed bytes happens to stay the same.
+ */
+static int fru_cache_matches(int port, const struct fru_image *img)
+{
+	static const int areas[] = {
+		FRU_HDR_CHASSIS, FRU_HDR_BOARD, FRU_HDR_PRODUCT
+	};
+	uint8_t hdr[FRU_COMMON_HEADER_LEN];
+	size_t size, offset, len;
+	uint8_t sum;
+	int i;
+
+	if (fru_area_size(port, &size) < 0 || size != img->size)
+		return 0;
+
+	if (size < sizeof(hdr) || fru_read(port, 0, hdr, sizeof(hdr)) < 0 ||
+	    memcmp(hdr, img->data, sizeof(hdr)))
+		return 0;
+
+	for (i = 0; i < ARRAY_SIZE(areas); i++) {
+		offset = hdr[areas[i]] * 8;
+		if (!offset || offset + 2 > size)
+			continue;
+		len = img->data[offset + 1] * 8;
+		if (!len || offset + len > size)
+			continue;
+		if (fru_read(port, offset + len - 1, &sum, 1) < 0 ||
+		    sum != img->data[offset + len - 1])
+			return 0;
+	}
+
+	return 1;
+}
+
+static void fru_cache_stash(const struct fru_image *img)
+{
+	if (!IS_ENABLED(CONFIG_IPMI_FRU_CACHE))
+		return;
+
+	/* The MRC cache only writes to flash when something changed. */
+	if (mrc_cache_stash_data(MRC_IPMI_FRU_DATA, FRU_CACHE_VERSION, img,
+				 offsetof(struct fru_image, data) + img->size))
+		printk(BIOS_ERR, "IPMI: failed to stash the FRU\n");
+}
+
+/*
+ * Decode the field at p into out. Returns the next field, or NULL past the
+ * last one. Binary fields come out empty.
+ */
+static const uint8_t *fru_field(const uint8_t *p, const uint8_t *end,
+				char *out)
+{
+	static const char bcd_plus[] = "0123456789 -.:,_";
+	size_t len, i, n = 0;
+
+	if (p >= end || *p == FRU_FIELD_END)
+		return NULL;
+
+	len = FRU_FIELD_LEN(*p);
+	if (p + 1 + len > end)
+		return NULL;
+
+	switch (FRU_FIELD_TYPE(*p)) {
+	case FRU_FIELD_BCD_PLUS:
+		for (i = 0; i < len; i++) {
+			out[n++] = bcd_plus[p[1 + i] >> 4];
+			out[n++] = bcd_plus[p[1 + i] & 0xf];
+		}
+		break;
+	case FRU_FIELD_6BIT_ASCII:
+		/* Four characters packed LSB first into every three bytes */
+		for (i = 0; i < len * 8 / 6; i++) {
+			size_t bit = i * 6;
+			unsigned int v = p[1 + bit / 8];
+
+			if (bit / 8 + 1 < len)
+				v |= p[2 + bit / 8] << 8;
+			out[n++] = ((v >> (bit % 8)) & 0x3f) + ' ';
+		}
+		break;
+	case FRU_FIELD_8BIT_ASCII:
+		memcpy(out, p + 1, len);
+		n = len;
+		break;
+	}
+	out[n] = '\0';
+
+	return p + 1 + len;
+}
+
+static void fru_parse_area(const struct fru_image *img, int area,
+			   size_t skip, char *const fields[], size_t count)
+{
+	const uint8_t *p, *end;
+	size_t offset, i;
+
+	offset = img->data[area] * 8;
+	if (!offset || offset + 2 > img->size)
+		return;
+
+	end = img->data + MIN(offset + img->data[offset + 1] * 8, img->size);
+	p = img->data + offset + skip;
+
+	for (i = 0; i < count && p; i++)
+		p = fru_field(p, end, fields[i]);
+}
+
+static void fru_parse(const struct fru_image *img, struct ipmi_fru_info *info)
+{
+	char *const chassis[] = {
+		info->chassis_part_number,
+		info->chassis_serial_number,
+	};
+	char *const board[] = {
+		info->board_manufacturer,
+		info->board_product_name,
+		info->board_serial_number,
+		info->board_part_number,
+	};
+	char *const product[] = {
+		info->product_manufacturer,
+		info->product_name,
+		info->product_part_number,
+		info->product_version,
+		info->product_serial_number,
+		info->product_asset_tag,
+	};
+
+	memset(info, 0, sizeof(*info));
+
+	if (img->size < FRU_COMMON_HEADER_LEN)
+		return;
+
+	fru_parse_area(img, FRU_HDR_CHASSIS, FRU_CHASSIS_FIELDS, chassis,
+		       ARRAY_SIZE(chassis));
+	fru_parse_area(img, FRU_HDR_BOARD, FRU_BOARD_FIELDS, board,
+		       ARRAY_SIZE(board));
+	fru_parse_area(img, FRU_HDR_PRODUCT, FRU_PRODUCT_FIELDS, product,
+		       ARRAY_SIZE(product));
+}
+
+const struct ipmi_fru_info *ipmi_fru_get(int port)
+{
+	size_t size;
+
+	if (fru_state)
+		return fru_state > 0 ? &fru_info : NULL;
+
+	fru_state = -1;
+
+	if (fru_cache_load(&fru) && fru_cache_matches(port, &fru)) {
+		printk(BIOS_DEBUG, "IPMI: FRU is cached\n");
+	} else {
+		if (fru_area_size(port, &size) < 0 ||
+		    fru_read(port, 0, fru.data, size) < 0) {
+			printk(BIOS_ERR, "IPMI: failed to read the FRU\n");
+			return NULL;
+		}
+		fru.size = size;
+	}
+
+	fru_cache_stash(&fru);
+	fru_parse(&fru, &fru_info);
+	fru_state = 1;
+
+	return &fru_info;
+}
+
+/* Read the FRU early enough for the MRC cache to save it on this boot. */
+static void ipmi_fru_init(void *unused)
+{
+	ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_PRE_DEVICE, BS_ON_EXIT, ipmi_fru_init, NULL);
+
+#if IS_ENABLED(CONFIG_IPMI_FRU_SMBIOS)
+static const char *fru_string(const char *s, const char *fallback)
+{
+	return s[0] ? s : fallback;
+}
+
+const char *smbios_mainboard_manufacturer(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	if (!info)
+		return CONFIG_MAINBOARD_SMBIOS_MANUFACTURER;
+	return fru_string(info->product_manufacturer,
+			  fru_string(info->board_manufacturer,
+				     CONFIG_MAINBOARD_SMBIOS_MANUFACTURER));
+}
+
+const char *smbios_mainboard_product_name(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	if (!info)
+		return CONFIG_MAINBOARD_SMBIOS_PRODUCT_NAME;
+	return fru_string(info->product_name,
+			  fru_string(info->board_product_name,
+				     CONFIG_MAINBOARD_SMBIOS_PRODUCT_NAME));
+}
+
+const char *smbios_mainboard_serial_number(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	if (!info)
+		return CONFIG_MAINBOARD_SERIAL_NUMBER;
+	return fru_string(info->product_serial_number,
+			  fru_string(info->board_serial_number,
+				     CONFIG_MAINBOARD_SERIAL_NUMBER));
+}
+
+const char *smbios_mainboard_version(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	if (!info)
+		return CONFIG_MAINBOARD_VERSION;
+	return fru_string(info->product_version, CONFIG_MAINBOARD_VERSION);
+}
+
+const char *smbios_mainboard_sku(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	return info ? info->product_part_number : "";
+}
+
+const char *smbios_mainboard_asset_tag(void)
+{
+	const struct ipmi_fru_info *info = ipmi_fru_get(CONFIG_IPMI_KCS_BASE);
+
+	return info ? info->product_asset_tag : "";
+}
+#endif
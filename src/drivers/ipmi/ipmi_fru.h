@@ -0,0 +1,47 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __IPMI_FRU_H
+#define __IPMI_FRU_H
+
+#define IPMI_STORAGE_GET_FRU_INVENTORY_AREA_INFO 0x10
+#define IPMI_STORAGE_READ_FRU_DATA 0x11
+
+/* Longest field: 63 bytes of 6-bit ASCII unpack to 84 characters. */
+#define IPMI_FRU_STRING_LEN 85
+
+/* The strings of the BMC's FRU, empty where the FRU has none. */
+struct ipmi_fru_info {
+	char chassis_part_number[IPMI_FRU_STRING_LEN];
+	char chassis_serial_number[IPMI_FRU_STRING_LEN];
+	char board_manufacturer[IPMI_FRU_STRING_LEN];
+	char board_product_name[IPMI_FRU_STRING_LEN];
+	char board_serial_number[IPMI_FRU_STRING_LEN];
+	char board_part_number[IPMI_FRU_STRING_LEN];
+	char product_manufacturer[IPMI_FRU_STRING_LEN];
+	char product_name[IPMI_FRU_STRING_LEN];
+	char product_part_number[IPMI_FRU_STRING_LEN];
+	char product_version[IPMI_FRU_STRING_LEN];
+	char product_serial_number[IPMI_FRU_STRING_LEN];
+	char product_asset_tag[IPMI_FRU_STRING_LEN];
+};
+
+/*
+ * Read and parse FRU device 0 of the BMC at the KCS interface at port, once
+ * per boot. With IPMI_FRU_CACHE the FRU is kept on flash and only a few
+ * bytes are read from the BMC to check that it didn't change. Returns NULL
+ * if the FRU couldn't be read.
+ */
+const struct ipmi_fru_info *ipmi_fru_get(int port);
+
+#endif
@@ -19,6 +19,7 @@
 #include <arch/io.h>
 #include <string.h>
 #include <delay.h>
+#include <timer.h>
 #include "ipmi_kcs.h"
 
 #define IPMI_KCS_STATE(_x)	((_x) >> 6)
@@ -41,44 +42,56 @@
 #define IPMI_DATA(_x) ((_x))
 #define IPMI_STAT(_x) ((_x) + 1)
 
+/* The BMC gets 100ms to accept or provide each byte. */
+#define IPMI_KCS_TIMEOUT_US	(100 * 1000)
+/* Poll interval, udelay() lets other threads run meanwhile. */
+#define IPMI_KCS_POLL_US	10
+
 static unsigned char ipmi_kcs_status(int port)
 {
 	unsigned char status = inb(IPMI_STAT(port));
-	printk(BIOS_DEBUG, "%s: 0x%02x\n", __func__, status);
+	if (IS_ENABLED(CONFIG_IPMI_KCS_DEBUG))
+		printk(BIOS_SPEW, "%s: 0x%02x\n", __func__, status);
 	return status;
 }
 
-static int wait_ibf_timeout(int port)
+/* Wait until (status & mask) == value. Returns 0 on success. */
+static int ipmi_kcs_wait(int port, unsigned char mask, unsigned char value)
 {
-	int timeout = 1000;
+	struct stopwatch sw;
+
+	stopwatch_init_usecs_expire(&sw, IPMI_KCS_TIMEOUT_US);
 	do {
-		if (!(ipmi_kcs_status(port) & IPMI_KCS_IBF))
+		if ((ipmi_kcs_status(port) & mask) == value)
 			return 0;
-		udelay(100);
-	} while (timeout--);
+		udelay(IPMI_KCS_POLL_US);
+	} while (!stopwatch_expired(&sw));
+
+	return 1;
+}
+
+static int wait_ibf_timeout(int port)
+{
+	if (!ipmi_kcs_wait(port, IPMI_KCS_IBF, 0))
+		return 0;
 	printk(BIOS_ERR, "wait_ibf timeout!\n");
-	return timeout;
+	return 1;
 }
 
 static int wait_obf_timeout(int port)
 {
-	int timeout = 1000;
-	do {
-		if ((ipmi_kcs_status(port) & IPMI_KCS_OBF))
-			return 0;
-		udelay(100);
-	} while (timeout--);
-
+	if (!ipmi_kcs_wait(port, IPMI_KCS_OBF, IPMI_KCS_OBF))
+		return 0;
 	printk(BIOS_ERR, "wait_obf timeout!\n");
-	return timeout;
+	return 1;
 }
 
-
 static int ipmi_kcs_send_data_byte(int port, const unsigned char byte)
 {
 	unsigned char status;
 
-	printk(BIOS_DEBUG, "%s: %02x\n", __func__, byte);
+	if (IS_ENABLED(CONFIG_IPMI_KCS_DEBUG))
+		printk(BIOS_SPEW, "%s: %02x\n", __func__, byte);
 
 	outb(byte, IPMI_DATA(port));
 
@@ -101,7 +114,8 @@ static int ipmi_kcs_send_last_data_byte(int port, const unsigned char byte)
 {
 	unsigned char status;
 
-	printk(BIOS_DEBUG, "%s: %02x\n", __func__, byte);
+	if (IS_ENABLED(CONFIG_IPMI_KCS_DEBUG))
+		printk(BIOS_SPEW, "%s: %02x\n", __func__, byte);
 
 	if (wait_ibf_timeout(port))
 		return 1;
@@ -122,7 +136,8 @@ static int ipmi_kcs_send_last_data_byte(int port, const unsigned char byte)
 
 static int ipmi_kcs_send_cmd_byte(int port, const unsigned char byte)
 {
-	printk(BIOS_DEBUG, "%s: 0x%02x\n", __func__, byte);
+	if (IS_ENABLED(CONFIG_IPMI_KCS_DEBUG))
+		printk(BIOS_SPEW, "%s: 0x%02x\n", __func__, byte);
 
 	if (wait_ibf_timeout(port))
 		return 1;
@@ -143,25 +158,19 @@ static int ipmi_kcs_send_cmd_byte(int port, const unsigned char byte)
 static int ipmi_kcs_send_message(int port, int netfn, int lun, int cmd,
 				const unsigned char *msg, int len)
 {
-	int ret;
+	const unsigned char hdr[2] = { (netfn << 2) | (lun & 3), cmd };
+	int ret, i;
 
 	if ((ret = ipmi_kcs_send_cmd_byte(port, IPMI_KCS_START_WRITE))) {
 		printk(BIOS_ERR, "IPMI START WRITE failed\n");
 		return ret;
 	}
 
-	if ((ret = ipmi_kcs_send_data_byte(port, (netfn << 2) | (lun & 3)))) {
-		printk(BIOS_ERR, "IPMI NETFN failed\n");
-		return ret;
-	}
-
-	if ((ret = ipmi_kcs_send_data_byte(port, cmd))) {
-		printk(BIOS_ERR, "IPMI CMD failed\n");
-		return ret;
-	}
+	/* The header counts as data, so requests without any are fine too. */
+	for (i = 0; i < len + 1; i++) {
+		unsigned char byte = i < 2 ? hdr[i] : msg[i - 2];
 
-	while (len-- > 1) {
-		if ((ret = ipmi_kcs_send_data_byte(port, *msg++))) {
+		if ((ret = ipmi_kcs_send_data_byte(port, byte))) {
 			printk(BIOS_ERR, "IPMI BYTE WRITE failed\n");
 			return ret;
 		}
@@ -172,7 +181,8 @@ static int ipmi_kcs_send_message(int port, int netfn, int lun, int cmd,
 		return ret;
 	}
 
-	if ((ret = ipmi_kcs_send_last_data_byte(port, *msg++))) {
+	if ((ret = ipmi_kcs_send_last_data_byte(port,
+						len ? msg[len - 1] : cmd))) {
 		printk(BIOS_ERR, "IPMI BYTE WRITE failed\n");
 		return ret;
 	}
@@ -203,7 +213,11 @@ static int ipmi_kcs_read_message(int port, unsigned char *msg, int len)
 		if (wait_obf_timeout(port))
 			return -1;
 
-		*msg++ = inb(IPMI_DATA(port));
+		/* Drop what doesn't fit, the BMC still needs to be drained. */
+		if (ret < len)
+			*msg++ = inb(IPMI_DATA(port));
+		else
+			inb(IPMI_DATA(port));
 		ret++;
 
 		if (wait_ibf_timeout(port))
@@ -225,3 +239,29 @@ int ipmi_kcs_message(int port, int netfn, int lun, int cmd,
 
 	return ipmi_kcs_read_message(port, outmsg, outlen);
 }
+
+int ipmi_kcs_get_device_id(int port, struct ipmi_devid_rsp *rsp)
+{
+	static struct ipmi_devid_rsp cache;
+	static int cached_port = -1;
+	int ret;
+
+	/* The answer is static, don't bother a slow BMC with it twice. */
+	if (cached_port != port) {
+		ret = ipmi_kcs_message(port, IPMI_NETFN_APPLICATION, 0,
+				       IPMI_BMC_GET_DEVICE_ID, NULL, 0,
+				       (unsigned char *)&cache, sizeof(cache));
+		/* Make sure this is the answer to our request. */
+		if (ret < (int)sizeof(cache) ||
+		    cache.resp.lun >> 2 != (IPMI_NETFN_APPLICATION | 1) ||
+		    cache.resp.cmd != IPMI_BMC_GET_DEVICE_ID ||
+		    cache.resp.completion_code) {
+			printk(BIOS_ERR, "IPMI: Get Device ID failed\n");
+			return -1;
+		}
+		cached_port = port;
+	}
+
+	memcpy(rsp, &cache, sizeof(*rsp));
+	return 0;
+}
@@ -16,6 +16,9 @@
  * GNU General Public License for more details.
  */
 
+#include <compiler.h>
+#include <stdint.h>
+
 #define IPMI_NETFN_CHASSIS 0x00
 #define IPMI_NETFN_BRIDGE 0x02
 #define IPMI_NETFN_SENSOREVENT 0x04
@@ -25,8 +28,34 @@
 #define IPMI_NETFN_TRANSPORT 0x0c
 
 #define IPMI_CMD_ACPI_POWERON 0x06
+#define IPMI_BMC_GET_DEVICE_ID 0x01
+
+/* Every response starts with this. */
+struct ipmi_rsp {
+	uint8_t lun;
+	uint8_t cmd;
+	uint8_t completion_code;
+} __packed;
+
+struct ipmi_devid_rsp {
+	struct ipmi_rsp resp;
+	uint8_t device_id;
+	uint8_t device_revision;
+	uint8_t fw_rev1;
+	uint8_t fw_rev2;
+	uint8_t ipmi_version;
+	uint8_t additional_device_support;
+	uint8_t manufacturer_id[3];
+	uint8_t product_id[2];
+} __packed;
 
 extern int ipmi_kcs_message(int port, int netfn, int lun, int cmd,
 			    const unsigned char *inmsg, int inlen,
 			    unsigned char *outmsg, int outlen);
+
+/*
+ * Get Device ID, asked only once per port and boot. Returns 0 on success and
+ * -1 otherwise.
+ */
+int ipmi_kcs_get_device_id(int port, struct ipmi_devid_rsp *rsp);
 #endif
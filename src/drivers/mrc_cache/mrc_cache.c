@@ -24,8 +24,10 @@
 #include <fmap.h>
 #include <ip_checksum.h>
 #include <region_file.h>
+#include <rules.h>
 #include <security/vboot/vboot_common.h>
 #include <spi_flash.h>
+#include <stdlib.h>
 
 #include "mrc_cache.h"
 
@@ -33,6 +35,8 @@
 #define VARIABLE_MRC_CACHE	"RW_VAR_MRC_CACHE"
 #define RECOVERY_MRC_CACHE	"RECOVERY_MRC_CACHE"
 #define UNIFIED_MRC_CACHE	"UNIFIED_MRC_CACHE"
+#define SPD_CACHE		"RW_SPD_CACHE"
+#define IPMI_FRU_CACHE		"RW_IPMI_FRU_CACHE"
 
 #define MRC_DATA_SIGNATURE       (('M'<<0)|('R'<<8)|('C'<<16)|('D'<<24))
 
@@ -89,11 +93,29 @@ static const struct cache_region variable_data = {
 	.flags = NORMAL_FLAG | RECOVERY_FLAG,
 };
 
+static const struct cache_region spd_data = {
+	.name = SPD_CACHE,
+	.cbmem_id = CBMEM_ID_SPD,
+	.type = MRC_SPD_DATA,
+	.elog_slot = ELOG_MEM_CACHE_UPDATE_SLOT_SPD,
+	.flags = NORMAL_FLAG | RECOVERY_FLAG,
+};
+
+static const struct cache_region ipmi_fru_data = {
+	.name = IPMI_FRU_CACHE,
+	.cbmem_id = CBMEM_ID_IPMI_FRU,
+	.type = MRC_IPMI_FRU_DATA,
+	.elog_slot = ELOG_MEM_CACHE_UPDATE_SLOT_IPMI_FRU,
+	.flags = NORMAL_FLAG | RECOVERY_FLAG,
+};
+
 /* Order matters here for priority in matching. */
 static const struct cache_region *cache_regions[] = {
 	&recovery_training,
 	&normal_training,
 	&variable_data,
+	&spd_data,
+	&ipmi_fru_data,
 };
 
 static int lookup_region_by_name(const char *name, struct region *r)
@@ -123,8 +145,7 @@ static const struct cache_region *lookup_region_type(int type)
 	return NULL;
 }
 
-int mrc_cache_stash_data(int type, uint32_t version, const void *data,
-			size_t size)
+void *mrc_cache_stash_reserve(int type, uint32_t version, size_t size)
 {
 	const struct cache_region *cr;
 	size_t cbmem_size;
@@ -134,7 +155,7 @@ int mrc_cache_stash_data(int type, uint32_t version, const void *data,
 	if (cr == NULL) {
 		printk(BIOS_ERR, "MRC: failed to add to cbmem for type %d.\n",
 			type);
-		return -1;
+		return NULL;
 	}
 
 	cbmem_size = sizeof(*md) + size;
@@ -144,20 +165,86 @@ int mrc_cache_stash_data(int type, uint32_t version, const void *data,
 	if (md == NULL) {
 		printk(BIOS_ERR, "MRC: failed to add '%s' to cbmem.\n",
 			cr->name);
-		return -1;
+		return NULL;
 	}
 
 	memset(md, 0, sizeof(*md));
 	md->signature = MRC_DATA_SIGNATURE;
 	md->data_size = size;
 	md->version = version;
-	md->data_checksum = compute_ip_checksum(data, size);
+
+	return &md[1];
+}
+
+int mrc_cache_stash_commit(int type)
+{
+	const struct cache_region *cr;
+	struct mrc_metadata *md;
+
+	cr = lookup_region_type(type);
+	if (cr == NULL)
+		return -1;
+
+	md = cbmem_find(cr->cbmem_id);
+	if (md == NULL) {
+		printk(BIOS_ERR, "MRC: no data reserved for '%s'.\n",
+			cr->name);
+		return -1;
+	}
+
+	md->data_checksum = compute_ip_checksum(&md[1], md->data_size);
+	md->header_checksum = 0;
 	md->header_checksum = compute_ip_checksum(md, sizeof(*md));
-	memcpy(&md[1], data, size);
 
 	return 0;
 }
 
+int mrc_cache_stash_data(int type, uint32_t version, const void *data,
+			size_t size)
+{
+	void *buf;
+
+	buf = mrc_cache_stash_reserve(type, version, size);
+	if (buf == NULL)
+		return -1;
+
+	memcpy(buf, data, size);
+
+	return mrc_cache_stash_commit(type);
+}
+
+#define FNV_PRIME	0x01000193
+#define FNV_OFFSET	0x811c9dc5
+
+static uint32_t fnv1a(uint32_t hash, const void *buf, size_t size)
+{
+	const uint8_t *p = buf;
+
+	while (size--)
+		hash = (hash ^ *p++) * FNV_PRIME;
+
+	return hash;
+}
+
+uint32_t mrc_cache_spd_version(uint32_t version, const uint8_t *const spd[],
+				size_t num, size_t spd_size)
+{
+	uint32_t hash = fnv1a(FNV_OFFSET, &version, sizeof(version));
+	const uint8_t empty = 0;
+	size_t i;
+
+	/* The serial numbers are hashed as well, identical modules could
+	 * still train differently. */
+	for (i = 0; i < num; i++) {
+		if (spd[i] == NULL)
+			hash = fnv1a(hash, &empty, sizeof(empty));
+		else
+			hash = fnv1a(hash, spd[i], spd_size);
+	}
+
+	return hash;
+}
+
 static const struct cache_region *lookup_region(struct region *r, int type)
 {
 	const struct cache_region *cr;
@@ -252,7 +339,7 @@ static int mrc_cache_latest(const char *name,
 				bool fail_bad_data)
 {
 	/* Init and obtain a handle to the file data. */
-	if (region_file_init(cache_file, backing_rdev) < 0) {
+	if (region_file_init_named(cache_file, backing_rdev, name) < 0) {
 		printk(BIOS_ERR, "MRC: region file invalid in '%s'\n", name);
 		return -1;
 	}
@@ -283,6 +370,38 @@ static int mrc_cache_latest(const char *name,
 	return 0;
 }
 
+/*
+ * Look for the newest data of the given version, going back from the latest
+ * update. An update without a valid header, as written to invalidate the
+ * cache, hides everything older.
+ */
+static int mrc_cache_find_version(const char *name,
+				const struct region_file *cache_file,
+				uint32_t version, struct mrc_metadata *md,
+				struct region_device *rdev)
+{
+	size_t age;
+
+	if (!IS_ENABLED(CONFIG_MRC_CACHE_MULTIPLE_CONFIGS))
+		return -1;
+
+	for (age = 0; region_file_data_prev(cache_file, age, rdev) == 0;
+	     age++) {
+		if (mrc_header_valid(rdev, md) < 0)
+			break;
+		if (md->version != version)
+			continue;
+		if (mrc_data_valid(rdev, md) < 0)
+			continue;
+
+		printk(BIOS_DEBUG, "MRC: version %x is %zu updates old in '%s'\n",
+			version, age, name);
+		return 0;
+	}
+
+	return -1;
+}
+
 int mrc_cache_get_current(int type, uint32_t version,
 				struct region_device *rdev)
 {
@@ -307,7 +426,9 @@ int mrc_cache_get_current(int type, uint32_t version,
 		fail_bad_data) < 0)
 		return -1;
 
-	if (version != md.version) {
+	if (version != md.version &&
+	    mrc_cache_find_version(cr->name, &cache_file, version, &md,
+				   rdev) < 0) {
 		printk(BIOS_INFO, "MRC: version mismatch: %x vs %x\n",
 			md.version, version);
 		return -1;
@@ -318,26 +439,101 @@ int mrc_cache_get_current(int type, uint32_t version,
 	return rdev_chain(rdev, rdev, md_size, data_size);
 }
 
+static size_t count_differences(const uint8_t *a, const uint8_t *b,
+				size_t size)
+{
+	size_t i, diff = 0;
+
+	for (i = 0; i < size; i++) {
+		if (a[i] != b[i])
+			diff++;
+	}
+
+	return diff;
+}
+
 static bool mrc_cache_needs_update(const struct region_device *rdev,
 				const struct cbmem_entry *to_be_updated)
 {
-	void *mapping;
+	const size_t md_size = sizeof(struct mrc_metadata);
+	const uint8_t *new_data = cbmem_entry_start(to_be_updated);
+	const struct mrc_metadata *new_md = (const void *)new_data;
+	const struct mrc_metadata *md;
+	uint8_t *mapping;
 	size_t size = region_device_sz(rdev);
+	size_t diff;
 	bool need_update = false;
 
 	if (cbmem_entry_size(to_be_updated) != size)
 		return true;
 
 	mapping = rdev_mmap_full(rdev);
+	md = (const void *)mapping;
 
-	if (memcmp(cbmem_entry_start(to_be_updated), mapping, size))
+	if (memcmp(new_data, mapping, size))
 		need_update = true;
 
+	/* The checksums in the header change with any of the data. Some
+	 * blobs carry things like timestamps which change on every boot
+	 * without the training being any different. */
+	if (need_update && CONFIG_MRC_CACHE_IGNORE_DIFF_BYTES &&
+	    new_md->version == md->version) {
+		diff = count_differences(&new_data[md_size],
+					 &mapping[md_size], size - md_size);
+		if (diff <= CONFIG_MRC_CACHE_IGNORE_DIFF_BYTES) {
+			printk(BIOS_DEBUG, "MRC: ignoring %zu changed bytes.\n",
+				diff);
+			need_update = false;
+		}
+	}
+
 	rdev_munmap(rdev, mapping);
 
 	return need_update;
 }
 
+/* Rewrite only the flash sectors of the latest data that changed. */
+static int mrc_cache_patch(struct region_file *cache_file,
+				const struct region_device *latest_rdev,
+				const struct mrc_metadata *latest_md,
+				const struct cbmem_entry *to_be_updated)
+{
+	const struct mrc_metadata *new_md = cbmem_entry_start(to_be_updated);
+	const struct spi_flash *flash;
+	void *scratch;
+	int sectors;
+
+	if (!IS_ENABLED(CONFIG_MRC_CACHE_PATCH_IN_PLACE) || !ENV_RAMSTAGE)
+		return -1;
+
+	if (region_device_sz(latest_rdev) != cbmem_entry_size(to_be_updated))
+		return -1;
+
+	/* Don't overwrite the data of another memory configuration. */
+	if (latest_md->version != new_md->version)
+		return -1;
+
+	flash = boot_device_spi_flash();
+	if (flash == NULL)
+		return -1;
+
+	scratch = malloc(flash->sector_size);
+	if (scratch == NULL)
+		return -1;
+
+	sectors = region_file_patch_data(cache_file,
+		cbmem_entry_start(to_be_updated),
+		cbmem_entry_size(to_be_updated), scratch, flash->sector_size);
+	free(scratch);
+
+	if (sectors < 0)
+		return -1;
+
+	printk(BIOS_DEBUG, "MRC: patched %d sectors in place.\n", sectors);
+
+	return 0;
+}
+
 static void log_event_cache_update(uint8_t slot, enum result res)
 {
 	const int type = ELOG_TYPE_MEM_CACHE_UPDATE;
@@ -377,6 +573,10 @@ static void update_mrc_cache_by_type(int type)
 	struct incoherent_rdev backing_irdev;
 	const struct region_device *backing_rdev;
 	struct region_device latest_rdev;
+	struct region_device prev_rdev;
+	const struct region_device *compare_rdev;
+	struct mrc_metadata prev_md;
+	const struct mrc_metadata *new_md;
 	const bool fail_bad_data = false;
 
 	cr = lookup_region(&region, type);
@@ -410,14 +610,26 @@ static void update_mrc_cache_by_type(int type)
 		&latest_rdev, fail_bad_data) < 0)
 		return;
 
-	if (!mrc_cache_needs_update(&latest_rdev, to_be_updated)) {
+	/* The latest data may be that of another memory configuration, then
+	 * compare against what was saved for this one. */
+	new_md = cbmem_entry_start(to_be_updated);
+	compare_rdev = &latest_rdev;
+	if (region_device_sz(&latest_rdev) && md.version != new_md->version &&
+	    mrc_cache_find_version(cr->name, &cache_file, new_md->version,
+				   &prev_md, &prev_rdev) == 0)
+		compare_rdev = &prev_rdev;
+
+	if (!mrc_cache_needs_update(compare_rdev, to_be_updated)) {
 		log_event_cache_update(cr->elog_slot, ALREADY_UPTODATE);
 		return;
 	}
 
 	printk(BIOS_DEBUG, "MRC: cache data '%s' needs update.\n", cr->name);
 
-	if (region_file_update_data(&cache_file,
+	if (mrc_cache_patch(&cache_file, &latest_rdev, &md,
+			    to_be_updated) == 0)
+		log_event_cache_update(cr->elog_slot, UPDATE_SUCCESS);
+	else if (region_file_update_data(&cache_file,
 		cbmem_entry_start(to_be_updated),
 		cbmem_entry_size(to_be_updated)) < 0)
 		log_event_cache_update(cr->elog_slot, UPDATE_FAILURE);
@@ -531,7 +743,7 @@ static void invalidate_normal_cache(void)
 		return;
 	}
 
-	if (region_file_init(&cache_file, &rdev) < 0) {
+	if (region_file_init_named(&cache_file, &rdev, name) < 0) {
 		printk(BIOS_ERR, "MRC: region file invalid for '%s'. Invalidation failed\n",
 			name);
 		return;
@@ -550,6 +762,12 @@ static void update_mrc_cache(void *unused)
 	if (IS_ENABLED(CONFIG_MRC_SETTINGS_VARIABLE_DATA))
 		update_mrc_cache_by_type(MRC_VARIABLE_DATA);
 
+	if (IS_ENABLED(CONFIG_SPD_CACHE))
+		update_mrc_cache_by_type(MRC_SPD_DATA);
+
+	if (IS_ENABLED(CONFIG_IPMI_FRU_CACHE))
+		update_mrc_cache_by_type(MRC_IPMI_FRU_DATA);
+
 	if (IS_ENABLED(CONFIG_MRC_CLEAR_NORMAL_CACHE_ON_RECOVERY_RETRAIN))
 		invalidate_normal_cache();
 
@@ -558,11 +776,27 @@ static void update_mrc_cache(void *unused)
 
 /*
  * Ensures MRC training data is stored into SPI after PCI enumeration is done.
- * Some implementations may require this to be later than others.
+ * Some implementations may require this to be later than others. With
+ * background flash writes the update overlaps device initialization, but
+ * still completes before finalization and OS resume.
  */
 
+static void update_mrc_cache_bs(void *unused)
+{
+	if (!IS_ENABLED(CONFIG_SPI_FLASH_BACKGROUND_WRITES))
+		update_mrc_cache(NULL);
+	else if (IS_ENABLED(CONFIG_MRC_WRITE_NV_LATE))
+		spi_flash_run_in_background(update_mrc_cache, NULL,
+					    BS_OS_RESUME_CHECK, BS_ON_EXIT);
+	else
+		spi_flash_run_in_background(update_mrc_cache, NULL,
+					    BS_POST_DEVICE, BS_ON_ENTRY);
+}
+
 #if IS_ENABLED(CONFIG_MRC_WRITE_NV_LATE)
-BOOT_STATE_INIT_ENTRY(BS_OS_RESUME_CHECK, BS_ON_ENTRY, update_mrc_cache, NULL);
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME_CHECK, BS_ON_ENTRY, update_mrc_cache_bs,
+		      NULL);
 #else
-BOOT_STATE_INIT_ENTRY(BS_DEV_ENUMERATE, BS_ON_EXIT, update_mrc_cache, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENUMERATE, BS_ON_EXIT, update_mrc_cache_bs,
+		      NULL);
 #endif
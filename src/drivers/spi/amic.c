@@ -146,6 +146,7 @@ int spi_flash_probe_amic(const struct spi_slave *spi, u8 *idcode,
 	flash->size = flash->sector_size * params->sectors_per_block *
 			params->nr_blocks;
 	flash->erase_cmd = CMD_A25_SE;
+	spi_flash_add_erase_type(flash, CMD_A25_BE, 64 * KiB);
 
 	flash->ops = &spi_flash_ops;
 
@@ -24,7 +24,10 @@
 #include <spi_flash.h>
 #include <symbols.h>
 #include <cbmem.h>
+#include <commonlib/boot_media_trace_serialized.h>
+#include <compiler.h>
 #include <stdint.h>
+#include <string.h>
 #include <timer.h>
 
 static struct spi_flash spi_flash_info;
@@ -41,15 +44,215 @@ static bool spi_flash_init_done;
  */
 #define SPI_SPEED_DEBUG		0
 
+#if IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_TRACE)
+/* Reads issued before CBMEM is up, moved there by trace_move_to_cbmem(). */
+#define EARLY_TRACE_ENTRIES	64
+
+static struct boot_media_trace_entry early_trace[EARLY_TRACE_ENTRIES];
+static uint32_t early_trace_count;
+static uint32_t early_trace_dropped;
+static struct boot_media_trace *trace;
+
+static void trace_read(size_t offset, size_t size)
+{
+	struct boot_media_trace_entry *e;
+
+	if (trace == NULL) {
+		if (early_trace_count == ARRAY_SIZE(early_trace)) {
+			early_trace_dropped++;
+			return;
+		}
+		e = &early_trace[early_trace_count++];
+	} else {
+		if (trace->num_entries == trace->max_entries) {
+			trace->dropped++;
+			return;
+		}
+		e = &trace->entries[trace->num_entries++];
+	}
+	e->offset = offset;
+	e->size = size;
+}
+
+static void trace_move_to_cbmem(int is_recovery)
+{
+	const size_t max = CONFIG_BOOT_DEVICE_SPI_FLASH_TRACE_ENTRIES;
+	uint32_t i;
+
+	/* Later stages append to the table the first one created. */
+	trace = cbmem_find(CBMEM_ID_BOOT_MEDIA_TRACE);
+	if (trace == NULL) {
+		trace = cbmem_add(CBMEM_ID_BOOT_MEDIA_TRACE, sizeof(*trace) +
+				  max * sizeof(trace->entries[0]));
+		if (trace == NULL)
+			return;
+		memset(trace, 0, sizeof(*trace));
+		trace->max_entries = max;
+	}
+
+	for (i = 0; i < early_trace_count; i++)
+		trace_read(early_trace[i].offset, early_trace[i].size);
+	trace->dropped += early_trace_dropped;
+	early_trace_count = 0;
+	early_trace_dropped = 0;
+}
+ROMSTAGE_CBMEM_INIT_HOOK(trace_move_to_cbmem);
+POSTCAR_CBMEM_INIT_HOOK(trace_move_to_cbmem);
+RAMSTAGE_CBMEM_INIT_HOOK(trace_move_to_cbmem);
+#else
+static inline void trace_read(size_t offset, size_t size) {}
+#endif
+
+#if IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_PREFETCH)
+enum {
+	PREFETCH_NONE,
+	PREFETCH_RUNNING,
+	PREFETCH_DONE,
+};
+
+static struct {
+	struct spi_flash_async_read rd;
+	size_t offset;
+	size_t size;
+	uint8_t *buf;
+	int state;
+} prefetch;
+
+static struct mmap_helper_region_device *boot_mdev(void);
+
+int boot_device_prefetch(size_t offset, size_t size)
+{
+	struct mem_pool *pool = &boot_mdev()->pool;
+	uint8_t *buf;
+
+	if (spi_flash_init_done != true || prefetch.state != PREFETCH_NONE)
+		return -1;
+
+	/* Leave at least as much of the cache to mappings. */
+	if (size > (pool->size - pool->free_offset) / 2)
+		return -1;
+
+	buf = mem_pool_alloc(pool, size);
+	if (buf == NULL)
+		return -1;
+
+	trace_read(offset, size);
+	if (spi_flash_read_start(&prefetch.rd, &spi_flash_info, offset, size,
+				 buf)) {
+		mem_pool_free(pool, buf);
+		return -1;
+	}
+
+	prefetch.offset = offset;
+	prefetch.size = size;
+	prefetch.buf = buf;
+	prefetch.state = PREFETCH_RUNNING;
+	boot_device_prefetch_poll();
+	return 0;
+}
+
+void boot_device_prefetch_poll(void)
+{
+	int ret;
+
+	if (prefetch.state != PREFETCH_RUNNING)
+		return;
+
+	ret = spi_flash_read_poll(&prefetch.rd);
+	if (ret == SPI_XFER_IN_PROGRESS)
+		return;
+
+	prefetch.state = ret ? PREFETCH_NONE : PREFETCH_DONE;
+}
+
+void boot_device_prefetch_end(void)
+{
+	if (prefetch.buf == NULL)
+		return;
+
+	if (prefetch.state == PREFETCH_RUNNING)
+		spi_flash_read_pause(&prefetch.rd);
+	prefetch.state = PREFETCH_NONE;
+
+	/* Only given back if nothing was mapped after it and kept. */
+	mem_pool_free(&boot_mdev()->pool, prefetch.buf);
+	prefetch.buf = NULL;
+}
+
+/* Let a synchronous read through between two chunks of the prefetch. */
+static int flash_read(void *b, size_t offset, size_t size)
+{
+	int ret;
+
+	if (prefetch.state == PREFETCH_RUNNING &&
+	    spi_flash_read_pause(&prefetch.rd))
+		prefetch.state = PREFETCH_NONE;
+
+	ret = spi_flash_read(&spi_flash_info, offset, size, b);
+	boot_device_prefetch_poll();
+
+	return ret;
+}
+
+/*
+ * Serve a read overlapping the prefetched range from the buffer, waiting
+ * for the prefetch first. Returns 1 if it did, 0 if the read has to go to
+ * the flash and < 0 on error.
+ */
+static int prefetch_readat(uint8_t *b, size_t offset, size_t size)
+{
+	size_t start = MAX(offset, prefetch.offset);
+	size_t end = MIN(offset + size, prefetch.offset + prefetch.size);
+
+	if (prefetch.state == PREFETCH_NONE || start >= end)
+		return 0;
+
+	while (prefetch.state == PREFETCH_RUNNING)
+		boot_device_prefetch_poll();
+
+	if (prefetch.state != PREFETCH_DONE)
+		return 0;
+
+	memcpy(b + start - offset, prefetch.buf + start - prefetch.offset,
+	       end - start);
+
+	if (start > offset && flash_read(b, offset, start - offset))
+		return -1;
+	if (offset + size > end &&
+	    flash_read(b + end - offset, end, offset + size - end))
+		return -1;
+
+	return 1;
+}
+#else
+static int flash_read(void *b, size_t offset, size_t size)
+{
+	return spi_flash_read(&spi_flash_info, offset, size, b);
+}
+
+static int prefetch_readat(uint8_t *b, size_t offset, size_t size)
+{
+	return 0;
+}
+#endif
+
 static ssize_t spi_readat(const struct region_device *rd, void *b,
 				size_t offset, size_t size)
 {
 	struct stopwatch sw;
 	bool show = SPI_SPEED_DEBUG && size >= 4 * KiB;
+	int ret;
+
+	ret = prefetch_readat(b, offset, size);
+	if (ret < 0)
+		return -1;
+	if (ret)
+		return size;
 
+	trace_read(offset, size);
 	if (show)
 		stopwatch_init(&sw);
-	if (spi_flash_read(&spi_flash_info, offset, size, b))
+	if (flash_read(b, offset, size))
 		return -1;
 	if (show) {
 		long usecs;
@@ -95,6 +298,26 @@ static const struct region_device_ops spi_ops = {
 static struct mmap_helper_region_device mdev =
 	MMAP_HELPER_REGION_INIT(&spi_ops, 0, CONFIG_ROM_SIZE);
 
+#if IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_READAHEAD)
+#define READAHEAD_BLOCK_SIZE	512
+
+static uint8_t readahead_cache[CONFIG_BOOT_DEVICE_SPI_FLASH_READAHEAD_SIZE]
+	__aligned(8);
+static struct readahead_region_device radev;
+#endif
+
+static const struct region_device *boot_rdev;
+
+/* Return the mmap helper backing mappings of the boot device. */
+static struct mmap_helper_region_device *boot_mdev(void)
+{
+#if IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_READAHEAD)
+	if (boot_rdev == &radev.mdev.rdev)
+		return &radev.mdev;
+#endif
+	return &mdev;
+}
+
 static void switch_to_postram_cache(int unused)
 {
 	/*
@@ -104,7 +327,7 @@ static void switch_to_postram_cache(int unused)
 	 */
 	boot_device_init();
 	if (_preram_cbfs_cache != _postram_cbfs_cache)
-		mmap_helper_device_init(&mdev, _postram_cbfs_cache,
+		mmap_helper_device_init(boot_mdev(), _postram_cbfs_cache,
 					_postram_cbfs_cache_size);
 }
 ROMSTAGE_CBMEM_INIT_HOOK(switch_to_postram_cache);
@@ -122,7 +345,20 @@ void boot_device_init(void)
 
 	spi_flash_init_done = true;
 
-	mmap_helper_device_init(&mdev, _cbfs_cache, _cbfs_cache_size);
+	boot_rdev = &mdev.rdev;
+
+#if IS_ENABLED(CONFIG_BOOT_DEVICE_SPI_FLASH_READAHEAD)
+	{
+		const struct region_device *rdev;
+
+		rdev = readahead_rdev_init(&radev, &mdev.rdev, readahead_cache,
+				sizeof(readahead_cache), READAHEAD_BLOCK_SIZE);
+		if (rdev != NULL)
+			boot_rdev = rdev;
+	}
+#endif
+
+	mmap_helper_device_init(boot_mdev(), _cbfs_cache, _cbfs_cache_size);
 }
 
 /* Return the CBFS boot device. */
@@ -131,7 +367,7 @@ const struct region_device *boot_device_ro(void)
 	if (spi_flash_init_done != true)
 		return NULL;
 
-	return &mdev.rdev;
+	return boot_rdev;
 }
 
 /* The read-only and read-write implementations are symmetric. */
@@ -158,6 +158,7 @@ int spi_flash_probe_eon(const struct spi_slave *spi, u8 *idcode,
 	flash->sector_size = params->page_size * params->pages_per_sector;
 	flash->size = flash->sector_size * params->nr_sectors;
 	flash->erase_cmd = CMD_EN25_SE;
+	spi_flash_add_erase_type(flash, CMD_EN25_BE, 64 * KiB);
 	flash->status_cmd = CMD_EN25_RDSR;
 
 	flash->ops = &spi_flash_ops;
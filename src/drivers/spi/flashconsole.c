@@ -19,35 +19,57 @@
 #include <fmap.h>
 #include <console/console.h>
 #include <console/flash.h>
+#include <stdlib.h>
 #include <string.h>
 
-#define LINE_BUFFER_SIZE 128
-#define READ_BUFFER_SIZE 0x100
+/*
+ * Output is collected up to the next flash page boundary and programmed a
+ * page at a time. Partial pages are only written at explicit sync points.
+ */
+#define FLASH_PAGE_SIZE 256
 
 static const struct region_device *g_rdev_ptr CAR_GLOBAL;
 static struct region_device g_rdev CAR_GLOBAL;
-static uint8_t g_line_buffer[LINE_BUFFER_SIZE] CAR_GLOBAL;
+static uint8_t g_line_buffer[FLASH_PAGE_SIZE] CAR_GLOBAL;
 static size_t g_offset CAR_GLOBAL;
 static size_t g_line_offset CAR_GLOBAL;
 
+/*
+ * The log is text up to the first 0xff, erased flash after it, so the end
+ * of the previous log can be found by bisection instead of reading the
+ * whole region.
+ */
+static int flashconsole_find_end(const struct region_device *rdev,
+				 size_t *end)
+{
+	size_t lo = 0, hi = region_device_sz(rdev);
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		uint8_t c;
+
+		if (rdev_readat(rdev, &c, mid, 1) != 1)
+			return -1;
+		if (c == 0xff)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	*end = lo;
+	return 0;
+}
+
 void flashconsole_init(void)
 {
 	struct region_device *rdev = car_get_var_ptr(&g_rdev);
-	uint8_t buffer[READ_BUFFER_SIZE];
-	size_t size;
-	size_t offset = 0;
-	size_t len = READ_BUFFER_SIZE;
-	size_t i;
+	size_t offset;
 
 	if (fmap_locate_area_as_rdev_rw("CONSOLE", rdev)) {
 		printk(BIOS_INFO, "Can't find 'CONSOLE' area in FMAP\n");
 		return;
 	}
-	size = region_device_sz(rdev);
 
 	/*
-	 * We need to check the region until we find a 0xff indicating
-	 * the end of a previous log write.
 	 * We can't erase the region because one stage would erase the
 	 * data from the previous stage. Also, it looks like doing an
 	 * erase could completely freeze the SPI controller and then
@@ -55,60 +77,30 @@ void flashconsole_init(void)
 	 * the sector is already erased, so we would need to read
 	 * anyways to check if it's all 0xff).
 	 */
-	for (i = 0; i < len && offset < size; ) {
-		// Fill the buffer on first iteration
-		if (i == 0) {
-			len = min(READ_BUFFER_SIZE, size - offset);
-			if (rdev_readat(rdev, buffer, offset, len) != len)
-				return;
-		}
-		if (buffer[i] == 0xff) {
-			offset += i;
-			break;
-		}
-		// If we're done, repeat the process for the next sector
-		if (++i == READ_BUFFER_SIZE) {
-			offset += len;
-			i = 0;
-		}
-	}
+	if (flashconsole_find_end(rdev, &offset))
+		return;
+
 	// Make sure there is still space left on the console
-	if (offset >= size) {
+	if (offset >= region_device_sz(rdev)) {
 		printk(BIOS_INFO, "No space left on 'console' region in SPI flash\n");
 		return;
 	}
 
 	car_set_var(g_offset, offset);
+	car_set_var(g_line_offset, 0);
 	/* Set g_rdev_ptr last so tx_byte doesn't get executed early */
 	car_set_var(g_rdev_ptr, rdev);
 }
 
-void flashconsole_tx_byte(unsigned char c)
+/* Bytes that fit before the next page boundary or the end of the region. */
+static size_t flashconsole_room(const struct region_device *rdev, size_t offset)
 {
-	const struct region_device *rdev = car_get_var(g_rdev_ptr);
-	uint8_t *line_buffer;
-	size_t offset;
-	size_t len;
-	size_t region_size;
+	size_t page_end = ALIGN_UP(offset + 1, FLASH_PAGE_SIZE);
 
-	if (!rdev)
-		return;
-
-	line_buffer = car_get_var_ptr(g_line_buffer);
-	offset = car_get_var(g_offset);
-	len = car_get_var(g_line_offset);
-	region_size = region_device_sz(rdev);
-
-	line_buffer[len++] = c;
-	car_set_var(g_line_offset, len);
-
-	if (len >= LINE_BUFFER_SIZE ||
-		offset + len >= region_size || c == '\n') {
-		flashconsole_tx_flush();
-	}
+	return MIN(page_end, region_device_sz(rdev)) - offset;
 }
 
-void flashconsole_tx_flush(void)
+static void flashconsole_write(void)
 {
 	const struct region_device *rdev = car_get_var(g_rdev_ptr);
 	uint8_t *line_buffer = car_get_var_ptr(g_line_buffer);
@@ -116,18 +108,15 @@ void flashconsole_tx_flush(void)
 	size_t len = car_get_var(g_line_offset);
 	size_t region_size;
 
-	if (!rdev)
+	if (!rdev || !len)
 		return;
+	region_size = region_device_sz(rdev);
 
 	/* Prevent any recursive loops in case the spi flash driver
 	 * calls printk (in case of transaction timeout or
 	 * any other error while writing) */
 	car_set_var(g_rdev_ptr, NULL);
 
-	region_size = region_device_sz(rdev);
-	if (offset + len >= region_size)
-		len = region_size - offset;
-
 	if (rdev_writeat(rdev, line_buffer, offset, len) != len)
 		rdev = NULL;
 
@@ -140,3 +129,32 @@ void flashconsole_tx_flush(void)
 
 	car_set_var(g_rdev_ptr, rdev);
 }
+
+void flashconsole_tx_byte(unsigned char c)
+{
+	const struct region_device *rdev = car_get_var(g_rdev_ptr);
+	uint8_t *line_buffer;
+	size_t len;
+
+	if (!rdev)
+		return;
+
+	line_buffer = car_get_var_ptr(g_line_buffer);
+	len = car_get_var(g_line_offset);
+
+	line_buffer[len++] = c;
+	car_set_var(g_line_offset, len);
+
+	if (len >= flashconsole_room(rdev, car_get_var(g_offset)))
+		flashconsole_write();
+}
+
+void flashconsole_tx_flush(void)
+{
+	/* Only whole pages are written as they fill up. */
+}
+
+void flashconsole_tx_sync(void)
+{
+	flashconsole_write();
+}
@@ -0,0 +1,151 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <spi_flash.h>
+#include <string.h>
+
+/*
+ * Decoding of the JEDEC basic flash parameter table (BFPT) as described by
+ * JESD216. Fetching the table is up to the caller, as SPI flash controllers
+ * may expose it through registers instead of the SFDP read command.
+ */
+
+/* JESD216 v1.0 tables are 9 DWORDs long. */
+#define BFPT_MIN_DWORDS		9
+
+/* DWORD numbers below are 0-based, the standard counts from 1. */
+#define BFPT_4K_ERASE_MASK	0x3
+#define BFPT_4K_ERASE		0x1
+#define BFPT_ADDR_SHIFT		17
+#define BFPT_ADDR_MASK		0x3
+#define BFPT_DENSITY_EXP	(1U << 31)
+#define BFPT_PAGE_SIZE_DWORD	10
+#define BFPT_QER_DWORD		14
+#define BFPT_QER_SHIFT		20
+#define BFPT_QER_MASK		0x7
+#define BFPT_SUSPEND_DWORD	11
+#define BFPT_NO_SUSPEND		(1U << 31)
+#define BFPT_SUSPEND_CMDS_DWORD	12
+
+/*
+ * Fast read commands, widest first. The support bit is in DWORD 0, the dummy
+ * clocks, mode clocks and opcode are a 16 bit field in DWORD 2 or 3.
+ */
+static const struct {
+	u8 addr_width;
+	u8 data_width;
+	u8 support_bit;
+	u8 dword;
+	u8 shift;
+} bfpt_read_modes[SFDP_READ_MODES] = {
+	{ 4, 4, 21, 2, 0 },	/* 1-4-4 */
+	{ 1, 4, 22, 2, 16 },	/* 1-1-4 */
+	{ 2, 2, 20, 3, 16 },	/* 1-2-2 */
+	{ 1, 2, 16, 3, 0 },	/* 1-1-2 */
+};
+
+static void bfpt_erase_type(struct spi_flash_erase_type *type, u32 field)
+{
+	type->shift = field & 0xff;
+	type->opcode = (field >> 8) & 0xff;
+
+	/* A size exponent of 0 marks an unused erase type. */
+	if (type->shift == 0 || type->shift > 31)
+		memset(type, 0, sizeof(*type));
+}
+
+int sfdp_parse_bfpt(const u32 *bfpt, size_t dwords,
+			struct sfdp_params *params)
+{
+	size_t i;
+
+	memset(params, 0, sizeof(*params));
+
+	if (dwords < BFPT_MIN_DWORDS)
+		return -1;
+
+	/* Density is given in bits. */
+	if (bfpt[1] & BFPT_DENSITY_EXP) {
+		u32 exp = bfpt[1] & ~BFPT_DENSITY_EXP;
+
+		if (exp < 3 || exp > 34)
+			return -1;
+		params->size = 1U << (exp - 3);
+	} else {
+		params->size = (bfpt[1] >> 3) + 1;
+	}
+
+	params->addr_mode = (bfpt[0] >> BFPT_ADDR_SHIFT) & BFPT_ADDR_MASK;
+
+	for (i = 0; i < SFDP_READ_MODES; i++) {
+		struct sfdp_read_mode *mode = &params->read_modes[i];
+		u32 field;
+
+		mode->addr_width = bfpt_read_modes[i].addr_width;
+		mode->data_width = bfpt_read_modes[i].data_width;
+
+		if (!(bfpt[0] & (1 << bfpt_read_modes[i].support_bit)))
+			continue;
+
+		field = bfpt[bfpt_read_modes[i].dword];
+		field = (field >> bfpt_read_modes[i].shift) & 0xffff;
+
+		mode->opcode = field >> 8;
+		mode->dummy_clocks = (field & 0x1f) + ((field >> 5) & 0x7);
+	}
+
+	bfpt_erase_type(&params->erase[0], bfpt[7]);
+	bfpt_erase_type(&params->erase[1], bfpt[7] >> 16);
+	bfpt_erase_type(&params->erase[2], bfpt[8]);
+	bfpt_erase_type(&params->erase[3], bfpt[8] >> 16);
+
+	/* Fall back to the 4 KiB erase described in DWORD 0. */
+	for (i = 0; i < SPI_FLASH_ERASE_TYPES; i++)
+		if (params->erase[i].shift)
+			break;
+
+	if (i == SPI_FLASH_ERASE_TYPES) {
+		if ((bfpt[0] & BFPT_4K_ERASE_MASK) != BFPT_4K_ERASE)
+			return -1;
+		params->erase[0].shift = 12;
+		params->erase[0].opcode = (bfpt[0] >> 8) & 0xff;
+	}
+
+	/* Page size and QE bit arrived with JESD216A. */
+	if (dwords > BFPT_PAGE_SIZE_DWORD)
+		params->page_size =
+			1U << ((bfpt[BFPT_PAGE_SIZE_DWORD] >> 4) & 0xf);
+	else
+		params->page_size = 256;
+
+	/* Only use suspend and resume if program and erase share them, as
+	   their users can't tell which operation is in progress. */
+	if (dwords > BFPT_SUSPEND_CMDS_DWORD &&
+	    !(bfpt[BFPT_SUSPEND_DWORD] & BFPT_NO_SUSPEND)) {
+		const u32 cmds = bfpt[BFPT_SUSPEND_CMDS_DWORD];
+
+		if ((cmds & 0xffff) == (cmds >> 16)) {
+			params->suspend_cmd = (cmds >> 8) & 0xff;
+			params->resume_cmd = cmds & 0xff;
+		}
+	}
+
+	if (dwords > BFPT_QER_DWORD)
+		params->quad_enable =
+			(bfpt[BFPT_QER_DWORD] >> BFPT_QER_SHIFT) &
+			BFPT_QER_MASK;
+	else
+		params->quad_enable = SFDP_QER_UNKNOWN;
+
+	return 0;
+}
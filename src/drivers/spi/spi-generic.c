@@ -43,6 +43,10 @@ static int spi_xfer_single_op(const struct spi_slave *slave,
 	if (!ctrlr || !ctrlr->xfer)
 		return -1;
 
+	/* xfer() only knows about regular single line transfers. */
+	if (op->width > 1)
+		return -1;
+
 	ret = ctrlr->xfer(slave, op->dout, op->bytesout, op->din, op->bytesin);
 	if (ret)
 		op->status = SPI_OP_FAILURE;
@@ -89,6 +93,28 @@ int spi_xfer(const struct spi_slave *slave, const void *dout, size_t bytesout,
 	return -1;
 }
 
+int spi_xfer_start(const struct spi_slave *slave, const void *dout,
+		   size_t bytesout, void *din, size_t bytesin)
+{
+	const struct spi_ctrlr *ctrlr = slave->ctrlr;
+
+	if (ctrlr && ctrlr->xfer_start && ctrlr->xfer_poll)
+		return ctrlr->xfer_start(slave, dout, bytesout, din, bytesin);
+
+	return spi_xfer(slave, dout, bytesout, din, bytesin);
+}
+
+int spi_xfer_poll(const struct spi_slave *slave)
+{
+	const struct spi_ctrlr *ctrlr = slave->ctrlr;
+
+	if (ctrlr && ctrlr->xfer_start && ctrlr->xfer_poll)
+		return ctrlr->xfer_poll(slave);
+
+	/* spi_xfer_start() already did all the work. */
+	return 0;
+}
+
 unsigned int spi_crop_chunk(const struct spi_slave *slave, unsigned int cmd_len,
 			unsigned int buf_len)
 {
@@ -11,13 +11,16 @@
 #include <assert.h>
 #include <boot_device.h>
 #include <cbfs.h>
+#include <commonlib/endian.h>
 #include <cpu/x86/smm.h>
 #include <delay.h>
+#include <lib.h>
 #include <rules.h>
 #include <stdlib.h>
 #include <string.h>
 #include <spi-generic.h>
 #include <spi_flash.h>
+#include <thread.h>
 
 #include "spi_flash_internal.h"
 #include <timer.h>
@@ -141,11 +144,75 @@ static int spi_flash_cmd_read_array_wrapped(const struct spi_slave *spi,
 	return 0;
 }
 
+/* Longest mode and dummy phase accepted from SFDP, in bytes. */
+#define SPI_FLASH_MAX_DUMMY_BYTES	8
+
+/* Read using a dual or quad I/O command. The opcode is always sent on a
+ * single line, the address, mode and dummy bytes and the data follow in
+ * separate ops on as many lines as the command uses. */
+static int spi_flash_cmd_read_multi_io(const struct spi_flash *flash,
+				u32 offset, size_t len, void *buf)
+{
+	const struct spi_flash_read_cmd *rd = &flash->read_cmd;
+	const struct spi_slave *spi = &flash->spi;
+	const size_t cmd_len = 1 + 3 + rd->dummy_bytes;
+	u8 addr[3 + SPI_FLASH_MAX_DUMMY_BYTES];
+	uint8_t *data = buf;
+	size_t xfer_len;
+	int ret;
+
+	/* Mode bits of zero keep the part out of continuous read mode. */
+	memset(addr, 0, sizeof(addr));
+
+	while (len) {
+		struct spi_op vectors[] = {
+			[0] = { .dout = &rd->opcode, .bytesout = 1,
+				.din = NULL, .bytesin = 0, .width = 1 },
+			[1] = { .dout = addr, .bytesout = 3 + rd->dummy_bytes,
+				.din = NULL, .bytesin = 0,
+				.width = rd->addr_width },
+			[2] = { .dout = NULL, .bytesout = 0,
+				.din = data, .bytesin = 0,
+				.width = rd->data_width },
+		};
+
+		xfer_len = spi_crop_chunk(spi, cmd_len, len);
+		vectors[2].bytesin = xfer_len;
+
+		addr[0] = offset >> 16;
+		addr[1] = offset >> 8;
+		addr[2] = offset >> 0;
+
+		if (spi_claim_bus(spi))
+			return -1;
+
+		ret = spi_xfer_vector(spi, vectors, ARRAY_SIZE(vectors));
+
+		spi_release_bus(spi);
+
+		if (ret) {
+			printk(BIOS_WARNING, "SF: Failed to send read command "
+				"%02x (%zu bytes): %d\n", rd->opcode, xfer_len,
+				ret);
+			return ret;
+		}
+
+		offset += xfer_len;
+		data += xfer_len;
+		len -= xfer_len;
+	}
+
+	return 0;
+}
+
 int spi_flash_cmd_read_fast(const struct spi_flash *flash, u32 offset,
 			size_t len, void *data)
 {
 	u8 cmd[5];
 
+	if (flash->read_cmd.data_width > 1)
+		return spi_flash_cmd_read_multi_io(flash, offset, len, data);
+
 	cmd[0] = CMD_READ_ARRAY_FAST;
 	cmd[4] = 0x00;
 
@@ -163,8 +230,43 @@ int spi_flash_cmd_read_slow(const struct spi_flash *flash, u32 offset,
 					offset, len, data);
 }
 
-int spi_flash_cmd_poll_bit(const struct spi_flash *flash, unsigned long timeout,
-			   u8 cmd, u8 poll_bit)
+/* How long a background writer yields between polls of the status. */
+#define SPI_FLASH_POLL_YIELD_USECS	100
+/* Suspending program or erase takes tens of microseconds. */
+#define SPI_FLASH_SUSPEND_TIMEOUT	1
+
+/*
+ * With SPI_FLASH_BACKGROUND_WRITES the flash operations of ramstage threads
+ * are serialized through spi_flash_sem. A thread writing the flash gives it
+ * up while it waits for a program or erase to complete, so other threads
+ * can run and even read the flash in the meantime.
+ */
+static struct thread_sem spi_flash_sem = { .count = 1 };
+static bool spi_flash_writing;
+/* Part with a program or erase in progress while its writer yields. */
+static const struct spi_flash *spi_flash_busy;
+
+static bool spi_flash_background(void)
+{
+	return ENV_RAMSTAGE && IS_ENABLED(CONFIG_SPI_FLASH_BACKGROUND_WRITES);
+}
+
+static int spi_flash_lock(void)
+{
+	if (!spi_flash_background())
+		return 0;
+
+	return thread_sem_down(&spi_flash_sem);
+}
+
+static void spi_flash_unlock(void)
+{
+	if (spi_flash_background())
+		thread_sem_up(&spi_flash_sem);
+}
+
+static int spi_flash_poll(const struct spi_flash *flash, unsigned long timeout,
+			  u8 cmd, u8 poll_bit, bool yield)
 {
 	const struct spi_slave *spi = &flash->spi;
 	int ret;
@@ -181,6 +283,12 @@ int spi_flash_cmd_poll_bit(const struct spi_flash *flash, unsigned long timeout,
 			return -1;
 		if ((status & poll_bit) == 0)
 			return 0;
+		if (yield) {
+			spi_flash_unlock();
+			thread_yield_microseconds(SPI_FLASH_POLL_YIELD_USECS);
+			if (spi_flash_lock())
+				return -1;
+		}
 		timer_monotonic_get(&current);
 	} while (!mono_time_after(&current, &end));
 
@@ -188,11 +296,77 @@ int spi_flash_cmd_poll_bit(const struct spi_flash *flash, unsigned long timeout,
 	return -1;
 }
 
+int spi_flash_cmd_poll_bit(const struct spi_flash *flash, unsigned long timeout,
+			   u8 cmd, u8 poll_bit)
+{
+	return spi_flash_poll(flash, timeout, cmd, poll_bit, false);
+}
+
 int spi_flash_cmd_wait_ready(const struct spi_flash *flash,
 			unsigned long timeout)
 {
-	return spi_flash_cmd_poll_bit(flash, timeout,
-		CMD_READ_STATUS, STATUS_WIP);
+	int ret;
+
+	if (!spi_flash_background() || !spi_flash_writing)
+		return spi_flash_cmd_poll_bit(flash, timeout,
+			CMD_READ_STATUS, STATUS_WIP);
+
+	spi_flash_busy = flash;
+	ret = spi_flash_poll(flash, timeout, CMD_READ_STATUS, STATUS_WIP,
+			     true);
+	spi_flash_busy = NULL;
+
+	return ret;
+}
+
+void spi_flash_add_erase_type(struct spi_flash *flash, u8 opcode, u32 size)
+{
+	size_t i;
+
+	if (!IS_POWER_OF_2(size) || size <= flash->sector_size)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(flash->erase_types); i++) {
+		if (flash->erase_types[i].shift == log2(size))
+			return;
+		if (!flash->erase_types[i].shift) {
+			flash->erase_types[i].opcode = opcode;
+			flash->erase_types[i].shift = log2(size);
+			return;
+		}
+	}
+}
+
+/*
+ * Plan the next erase operation of the range [offset, end): the largest
+ * erase type which is aligned at offset and fits the rest of the range.
+ * Since all erase sizes are powers of two this covers the range in the
+ * fewest operations. Returns the erase size and sets the opcode.
+ */
+static u32 spi_flash_erase_step(const struct spi_flash *flash, u32 offset,
+				u32 end, u8 *opcode)
+{
+	u32 erase_size = flash->sector_size;
+	size_t i;
+
+	*opcode = flash->erase_cmd;
+
+	for (i = 0; i < ARRAY_SIZE(flash->erase_types); i++) {
+		const struct spi_flash_erase_type *type = &flash->erase_types[i];
+		u32 size;
+
+		if (!type->shift)
+			continue;
+
+		size = 1U << type->shift;
+		if (size <= erase_size || offset % size || end - offset < size)
+			continue;
+
+		erase_size = size;
+		*opcode = type->opcode;
+	}
+
+	return erase_size;
 }
 
 int spi_flash_cmd_erase(const struct spi_flash *flash, u32 offset, size_t len)
@@ -207,11 +381,11 @@ int spi_flash_cmd_erase(const struct spi_flash *flash, u32 offset, size_t len)
 		return -1;
 	}
 
-	cmd[0] = flash->erase_cmd;
 	start = offset;
 	end = start + len;
 
 	while (offset < end) {
+		erase_size = spi_flash_erase_step(flash, offset, end, &cmd[0]);
 		spi_flash_addr(offset, cmd);
 		offset += erase_size;
 
@@ -223,11 +397,17 @@ int spi_flash_cmd_erase(const struct spi_flash *flash, u32 offset, size_t len)
 		if (ret)
 			goto out;
 
-		ret = spi_flash_cmd_write(&flash->spi, cmd, sizeof(cmd), NULL, 0);
+		/* Chip erase takes no address. */
+		if (cmd[0] == CMD_CHIP_ERASE)
+			ret = spi_flash_cmd(&flash->spi, cmd[0], NULL, 0);
+		else
+			ret = spi_flash_cmd_write(&flash->spi, cmd,
+						sizeof(cmd), NULL, 0);
 		if (ret)
 			goto out;
 
-		ret = spi_flash_cmd_wait_ready(flash, SPI_FLASH_PAGE_ERASE_TIMEOUT);
+		ret = spi_flash_cmd_wait_ready(flash, SPI_FLASH_PAGE_ERASE_TIMEOUT *
+					(erase_size / flash->sector_size));
 		if (ret)
 			goto out;
 	}
@@ -311,11 +491,266 @@ static struct {
 };
 #define IDCODE_LEN (IDCODE_CONT_LEN + IDCODE_PART_LEN)
 
+#define SFDP_SIGNATURE			0x50444653	/* "SFDP" */
+#define SFDP_BFPT_MAX_DWORDS		16
+
+static int spi_flash_sfdp_read(const struct spi_slave *spi, u32 offset,
+				void *buf, size_t len)
+{
+	u8 cmd[5];
+
+	cmd[0] = CMD_READ_SFDP;
+	cmd[4] = 0x00;
+
+	return spi_flash_cmd_read_array_wrapped(spi, cmd, sizeof(cmd),
+					offset, len, buf);
+}
+
+/* Fetch the basic flash parameter table (BFPT) of the part and decode it. */
+static int spi_flash_sfdp_params(const struct spi_slave *spi,
+				struct sfdp_params *params)
+{
+	u32 bfpt[SFDP_BFPT_MAX_DWORDS];
+	u8 hdr[16];
+	size_t dwords, i;
+
+	if (!IS_ENABLED(CONFIG_SPI_FLASH_SFDP))
+		return -1;
+
+	/* SPI flash controllers with their own probe may only pass a fixed
+	   set of opcodes, keep them on the commands of the vendor tables. */
+	if (spi->ctrlr == NULL || spi->ctrlr->flash_probe != NULL)
+		return -1;
+
+	/* SFDP header followed by the first parameter header, which always
+	   points to the BFPT. */
+	if (spi_flash_sfdp_read(spi, 0, hdr, sizeof(hdr)))
+		return -1;
+
+	if (read_le32(&hdr[0]) != SFDP_SIGNATURE || hdr[8] != 0x00)
+		return -1;
+
+	dwords = min(hdr[11], SFDP_BFPT_MAX_DWORDS);
+
+	if (spi_flash_sfdp_read(spi, hdr[12] | hdr[13] << 8 | hdr[14] << 16,
+				bfpt, dwords * sizeof(u32)))
+		return -1;
+
+	for (i = 0; i < dwords; i++)
+		bfpt[i] = read_le32(&bfpt[i]);
+
+	return sfdp_parse_bfpt(bfpt, dwords, params);
+}
+
+static bool spi_ctrlr_supports_width(u32 flags, unsigned int width, bool tx)
+{
+	const u32 dual = tx ? SPI_CNTRLR_TX_DUAL : SPI_CNTRLR_RX_DUAL;
+	const u32 quad = tx ? SPI_CNTRLR_TX_QUAD : SPI_CNTRLR_RX_QUAD;
+
+	switch (width) {
+	case 1:
+		return true;
+	case 2:
+		return !!(flags & dual);
+	case 4:
+		return !!(flags & quad);
+	default:
+		return false;
+	}
+}
+
+/*
+ * Quad I/O needs the QE bit on most parts since WP# and HOLD# share pins
+ * with IO2 and IO3. Setting it is a non-volatile board decision, so quad
+ * commands are only used if it is already set.
+ */
+static bool spi_flash_sfdp_quad_enabled(const struct spi_slave *spi,
+				const struct sfdp_params *params)
+{
+	u8 status;
+
+	switch (params->quad_enable) {
+	case 0:
+		/* No QE bit. */
+		return true;
+	case 1:
+	case 4:
+	case 5:
+		if (spi_flash_cmd(spi, CMD_READ_STATUS2, &status, 1))
+			return false;
+		return !!(status & (1 << 1));
+	case 2:
+		if (spi_flash_cmd(spi, CMD_READ_STATUS, &status, 1))
+			return false;
+		return !!(status & (1 << 6));
+	case 3:
+		if (spi_flash_cmd(spi, CMD_READ_STATUS2_ALT, &status, 1))
+			return false;
+		return !!(status & (1 << 7));
+	default:
+		return false;
+	}
+}
+
+/*
+ * Pick the read command used by spi_flash_cmd_read_fast(): the widest one
+ * advertised in the SFDP of the part that the controller can handle, or the
+ * single line fast read otherwise.
+ */
+static void spi_flash_select_read_cmd(const struct spi_slave *spi,
+				struct spi_flash *flash,
+				const struct sfdp_params *params)
+{
+	struct spi_flash_read_cmd *rd = &flash->read_cmd;
+	const u32 flags = spi->ctrlr ? spi->ctrlr->flags : 0;
+	int quad_enabled = -1;
+	size_t i;
+
+	rd->opcode = CMD_READ_ARRAY_FAST;
+	rd->addr_width = 1;
+	rd->data_width = 1;
+	rd->dummy_bytes = 1;
+
+	if (params == NULL)
+		return;
+
+	if (!(flags & (SPI_CNTRLR_RX_DUAL | SPI_CNTRLR_RX_QUAD)))
+		return;
+
+	/* Parts which need the slow read command keep it. */
+	if (flash->ops->read != spi_flash_cmd_read_fast)
+		return;
+
+	/* Only 3 byte addresses are sent. */
+	if (params->addr_mode == SFDP_ADDR_4B)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(params->read_modes); i++) {
+		const struct sfdp_read_mode *mode = &params->read_modes[i];
+		const unsigned int aw = mode->addr_width;
+		const unsigned int dw = mode->data_width;
+
+		if (!mode->opcode)
+			continue;
+
+		if (!spi_ctrlr_supports_width(flags, aw, true) ||
+		    !spi_ctrlr_supports_width(flags, dw, false))
+			continue;
+
+		/* Mode and dummy clocks have to add up to whole bytes. */
+		if ((mode->dummy_clocks * aw) % 8 ||
+		    mode->dummy_clocks * aw / 8 > SPI_FLASH_MAX_DUMMY_BYTES)
+			continue;
+
+		if (dw == 4) {
+			if (quad_enabled < 0)
+				quad_enabled = spi_flash_sfdp_quad_enabled(spi,
+								params);
+			if (!quad_enabled)
+				continue;
+		}
+
+		rd->opcode = mode->opcode;
+		rd->addr_width = aw;
+		rd->data_width = dw;
+		rd->dummy_bytes = mode->dummy_clocks * aw / 8;
+
+		printk(BIOS_INFO, "SF: Using 1-%u-%u read command %02x\n",
+			aw, dw, rd->opcode);
+		return;
+	}
+}
+
+static int spi_flash_sfdp_write(const struct spi_flash *flash, u32 offset,
+				size_t len, const void *buf)
+{
+	size_t chunk_len;
+	size_t actual;
+	int ret;
+	u8 cmd[4];
+
+	for (actual = 0; actual < len; actual += chunk_len) {
+		chunk_len = min(len - actual,
+				flash->page_size - offset % flash->page_size);
+		chunk_len = spi_crop_chunk(&flash->spi, sizeof(cmd), chunk_len);
+
+		cmd[0] = CMD_PAGE_PROGRAM;
+		spi_flash_addr(offset, cmd);
+
+		ret = spi_flash_cmd(&flash->spi, CMD_WRITE_ENABLE, NULL, 0);
+		if (ret) {
+			printk(BIOS_WARNING, "SF: Enabling Write failed\n");
+			return ret;
+		}
+
+		ret = spi_flash_cmd_write(&flash->spi, cmd, sizeof(cmd),
+				(const u8 *)buf + actual, chunk_len);
+		if (ret) {
+			printk(BIOS_WARNING, "SF: Page Program failed\n");
+			return ret;
+		}
+
+		ret = spi_flash_cmd_wait_ready(flash, SPI_FLASH_PROG_TIMEOUT);
+		if (ret)
+			return ret;
+
+		offset += chunk_len;
+	}
+
+	return 0;
+}
+
+static const struct spi_flash_ops spi_flash_sfdp_ops = {
+	.write = spi_flash_sfdp_write,
+	.erase = spi_flash_cmd_erase,
+	.status = spi_flash_cmd_status,
+#if IS_ENABLED(CONFIG_SPI_FLASH_NO_FAST_READ)
+	.read = spi_flash_cmd_read_slow,
+#else
+	.read = spi_flash_cmd_read_fast,
+#endif
+};
+
+/* Describe a part missing from the vendor tables from its SFDP alone. */
+static int spi_flash_probe_sfdp(const struct spi_slave *spi,
+				struct spi_flash *flash,
+				const struct sfdp_params *params)
+{
+	const struct spi_flash_erase_type *smallest = NULL;
+	size_t i;
+
+	if (params->addr_mode == SFDP_ADDR_4B)
+		return -1;
+
+	for (i = 0; i < ARRAY_SIZE(params->erase); i++) {
+		if (!params->erase[i].shift)
+			continue;
+		if (!smallest || params->erase[i].shift < smallest->shift)
+			smallest = &params->erase[i];
+	}
+
+	if (!smallest)
+		return -1;
+
+	memcpy(&flash->spi, spi, sizeof(*spi));
+	flash->name = "SFDP";
+	flash->size = params->size;
+	flash->page_size = params->page_size;
+	flash->sector_size = 1U << smallest->shift;
+	flash->erase_cmd = smallest->opcode;
+	flash->status_cmd = CMD_READ_STATUS;
+	flash->ops = &spi_flash_sfdp_ops;
+
+	return 0;
+}
+
 int spi_flash_generic_probe(const struct spi_slave *spi,
 				struct spi_flash *flash)
 {
 	int ret, i, shift;
 	u8 idcode[IDCODE_LEN], *idp;
+	struct sfdp_params params;
+	bool have_params;
 
 	/* Read the ID codes */
 	ret = spi_flash_cmd(spi, CMD_READ_ID, idcode, sizeof(idcode));
@@ -336,16 +771,40 @@ int spi_flash_generic_probe(const struct spi_slave *spi,
 
 	printk(BIOS_INFO, "Manufacturer: %02x\n", *idp);
 
+	/* Vendor probes may add larger erase types. */
+	memset(flash->erase_types, 0, sizeof(flash->erase_types));
+
 	/* search the table for matches in shift and id */
 	for (i = 0; i < ARRAY_SIZE(flashes); ++i)
 		if (flashes[i].shift == shift && flashes[i].idcode == *idp) {
 			/* we have a match, call probe */
 			if (flashes[i].probe(spi, idp, flash) == 0)
-				return 0;
+				break;
 		}
 
-	/* No match, return error. */
-	return -1;
+	have_params = !spi_flash_sfdp_params(spi, &params);
+
+	/* No match, try to get by with SFDP or return error. */
+	if (i == ARRAY_SIZE(flashes)) {
+		if (!have_params || spi_flash_probe_sfdp(spi, flash, &params))
+			return -1;
+	}
+
+	flash->suspend_cmd = 0;
+	flash->resume_cmd = 0;
+	if (have_params) {
+		memcpy(flash->erase_types, params.erase,
+			sizeof(flash->erase_types));
+		flash->suspend_cmd = params.suspend_cmd;
+		flash->resume_cmd = params.resume_cmd;
+	}
+
+	/* Chip erase is a single operation covering the whole part. */
+	spi_flash_add_erase_type(flash, CMD_CHIP_ERASE, flash->size);
+
+	spi_flash_select_read_cmd(spi, flash, have_params ? &params : NULL);
+
+	return 0;
 }
 
 int spi_flash_probe(unsigned int bus, unsigned int cs, struct spi_flash *flash)
@@ -383,10 +842,175 @@ int spi_flash_probe(unsigned int bus, unsigned int cs, struct spi_flash *flash)
 	return 0;
 }
 
+/*
+ * Read from a part whose writer yields during a program or erase. Suspend
+ * the operation if the part can, else wait for it to complete. Either way
+ * this must not yield, or the writer would find the part idle.
+ */
+static int spi_flash_read_busy(const struct spi_flash *flash, u32 offset,
+			       size_t len, void *buf)
+{
+	const struct spi_flash *busy = spi_flash_busy;
+	unsigned long timeout;
+	int ret;
+
+	if (busy->suspend_cmd) {
+		if (spi_flash_cmd(&busy->spi, busy->suspend_cmd, NULL, 0))
+			return -1;
+		timeout = SPI_FLASH_SUSPEND_TIMEOUT;
+	} else {
+		timeout = SPI_FLASH_PAGE_ERASE_TIMEOUT * 16;
+	}
+
+	ret = spi_flash_cmd_poll_bit(busy, timeout, CMD_READ_STATUS,
+				     STATUS_WIP);
+	if (!ret)
+		ret = flash->ops->read(flash, offset, len, buf);
+
+	if (busy->suspend_cmd &&
+	    spi_flash_cmd(&busy->spi, busy->resume_cmd, NULL, 0))
+		ret = -1;
+
+	return ret;
+}
+
 int spi_flash_read(const struct spi_flash *flash, u32 offset, size_t len,
 		void *buf)
 {
-	return flash->ops->read(flash, offset, len, buf);
+	int ret;
+
+	if (spi_flash_lock())
+		return -1;
+
+	if (spi_flash_background() && spi_flash_busy != NULL &&
+	    spi_flash_busy->spi.bus == flash->spi.bus &&
+	    spi_flash_busy->spi.cs == flash->spi.cs)
+		ret = spi_flash_read_busy(flash, offset, len, buf);
+	else
+		ret = flash->ops->read(flash, offset, len, buf);
+
+	spi_flash_unlock();
+
+	return ret;
+}
+
+static int spi_flash_read_chunk_start(struct spi_flash_async_read *rd)
+{
+	const struct spi_slave *spi = &rd->flash->spi;
+	size_t xfer_len;
+
+	if (spi_flash_lock())
+		return -1;
+
+	xfer_len = spi_crop_chunk(spi, rd->cmd_len, rd->len);
+	spi_flash_addr(rd->offset, rd->cmd);
+
+	if (spi_claim_bus(spi)) {
+		spi_flash_unlock();
+		return -1;
+	}
+
+	if (spi_xfer(spi, rd->cmd, rd->cmd_len, NULL, 0) ||
+	    spi_xfer_start(spi, NULL, 0, rd->buf, xfer_len)) {
+		spi_release_bus(spi);
+		spi_flash_unlock();
+		return -1;
+	}
+
+	rd->chunk = xfer_len;
+	return 0;
+}
+
+/* Wrap up the chunk in flight once spi_xfer_poll() returned ret for it. */
+static int spi_flash_read_chunk_done(struct spi_flash_async_read *rd, int ret)
+{
+	spi_release_bus(&rd->flash->spi);
+	spi_flash_unlock();
+
+	if (ret < 0) {
+		printk(BIOS_WARNING, "SF: Failed to read %zu bytes: %d\n",
+		       rd->chunk, ret);
+		rd->chunk = 0;
+		return ret;
+	}
+
+	rd->offset += rd->chunk;
+	rd->buf += rd->chunk;
+	rd->len -= rd->chunk;
+	rd->chunk = 0;
+	return 0;
+}
+
+int spi_flash_read_start(struct spi_flash_async_read *rd,
+			 const struct spi_flash *flash, u32 offset, size_t len,
+			 void *buf)
+{
+	memset(rd, 0, sizeof(*rd));
+	rd->flash = flash;
+	rd->offset = offset;
+	rd->len = len;
+	rd->buf = buf;
+
+	if (flash->ops->read == spi_flash_cmd_read_fast &&
+	    flash->read_cmd.data_width == 1) {
+		rd->cmd[0] = CMD_READ_ARRAY_FAST;
+		rd->cmd_len = 5;
+	} else if (flash->ops->read == spi_flash_cmd_read_slow) {
+		rd->cmd[0] = CMD_READ_ARRAY_SLOW;
+		rd->cmd_len = 4;
+	}
+
+	/*
+	 * Multi I/O and vendor read commands, and reads that might have to
+	 * suspend a background program or erase, are done right away.
+	 */
+	if (!rd->cmd_len || spi_flash_background()) {
+		if (spi_flash_read(flash, offset, len, buf))
+			return -1;
+		rd->len = 0;
+		return 0;
+	}
+
+	if (!len)
+		return 0;
+
+	return spi_flash_read_chunk_start(rd);
+}
+
+int spi_flash_read_poll(struct spi_flash_async_read *rd)
+{
+	int ret;
+
+	if (rd->chunk) {
+		ret = spi_xfer_poll(&rd->flash->spi);
+		if (ret == SPI_XFER_IN_PROGRESS)
+			return ret;
+		ret = spi_flash_read_chunk_done(rd, ret);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (!rd->len)
+		return 0;
+
+	if (spi_flash_read_chunk_start(rd))
+		return -1;
+
+	return SPI_XFER_IN_PROGRESS;
+}
+
+int spi_flash_read_pause(struct spi_flash_async_read *rd)
+{
+	int ret;
+
+	if (!rd->chunk)
+		return 0;
+
+	do {
+		ret = spi_xfer_poll(&rd->flash->spi);
+	} while (ret == SPI_XFER_IN_PROGRESS);
+
+	return spi_flash_read_chunk_done(rd, ret);
 }
 
 int spi_flash_write(const struct spi_flash *flash, u32 offset, size_t len,
@@ -394,13 +1018,24 @@ int spi_flash_write(const struct spi_flash *flash, u32 offset, size_t len,
 {
 	int ret;
 
-	if (spi_flash_volatile_group_begin(flash))
+	if (spi_flash_lock())
+		return -1;
+
+	if (spi_flash_volatile_group_begin(flash)) {
+		spi_flash_unlock();
 		return -1;
+	}
 
+	if (spi_flash_background())
+		spi_flash_writing = true;
 	ret = flash->ops->write(flash, offset, len, buf);
+	if (spi_flash_background())
+		spi_flash_writing = false;
 
 	if (spi_flash_volatile_group_end(flash))
-		return -1;
+		ret = -1;
+
+	spi_flash_unlock();
 
 	return ret;
 }
@@ -409,23 +1044,51 @@ int spi_flash_erase(const struct spi_flash *flash, u32 offset, size_t len)
 {
 	int ret;
 
-	if (spi_flash_volatile_group_begin(flash))
+	if (spi_flash_lock())
 		return -1;
 
+	if (spi_flash_volatile_group_begin(flash)) {
+		spi_flash_unlock();
+		return -1;
+	}
+
+	if (spi_flash_background())
+		spi_flash_writing = true;
 	ret = flash->ops->erase(flash, offset, len);
+	if (spi_flash_background())
+		spi_flash_writing = false;
 
 	if (spi_flash_volatile_group_end(flash))
-		return -1;
+		ret = -1;
+
+	spi_flash_unlock();
 
 	return ret;
 }
 
 int spi_flash_status(const struct spi_flash *flash, u8 *reg)
 {
-	if (flash->ops->status)
-		return flash->ops->status(flash, reg);
+	int ret = -1;
 
-	return -1;
+	if (!flash->ops->status)
+		return ret;
+
+	if (spi_flash_lock())
+		return -1;
+
+	ret = flash->ops->status(flash, reg);
+
+	spi_flash_unlock();
+
+	return ret;
+}
+
+void spi_flash_run_in_background(void (*func)(void *), void *arg,
+				 boot_state_t state, boot_state_sequence_t seq)
+{
+	if (!spi_flash_background() ||
+	    thread_run_until(func, arg, state, seq))
+		func(arg);
 }
 
 static uint32_t volatile_group_count CAR_GLOBAL;
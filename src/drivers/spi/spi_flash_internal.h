@@ -22,11 +22,16 @@
 #define CMD_READ_ARRAY_SLOW		0x03
 #define CMD_READ_ARRAY_FAST		0x0b
 #define CMD_READ_ARRAY_LEGACY		0xe8
+#define CMD_READ_SFDP			0x5a
 
 #define CMD_READ_STATUS			0x05
+#define CMD_READ_STATUS2		0x35
+#define CMD_READ_STATUS2_ALT		0x3f
 #define CMD_WRITE_ENABLE		0x06
+#define CMD_PAGE_PROGRAM		0x02
 
 #define CMD_BLOCK_ERASE			0xD8
+#define CMD_CHIP_ERASE			0xc7
 
 /* Common status */
 #define STATUS_WIP			0x01
@@ -57,7 +62,14 @@ int spi_flash_cmd_poll_bit(const struct spi_flash *flash, unsigned long timeout,
  */
 int spi_flash_cmd_wait_ready(const struct spi_flash *flash, unsigned long timeout);
 
-/* Erase sectors. */
+/*
+ * Declare an erase command of size bytes besides flash->erase_cmd, for use by
+ * spi_flash_cmd_erase(). Sizes which aren't a power of two or not larger than
+ * flash->sector_size are ignored, as are types exceeding the table.
+ */
+void spi_flash_add_erase_type(struct spi_flash *flash, u8 opcode, u32 size);
+
+/* Erase sectors, using the largest erase types which fit. */
 int spi_flash_cmd_erase(const struct spi_flash *flash, u32 offset, size_t len);
 
 /* Read status register. */
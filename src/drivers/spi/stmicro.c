@@ -265,6 +265,8 @@ int spi_flash_probe_stmicro(const struct spi_slave *spi, u8 *idcode,
 	flash->sector_size = params->page_size * params->pages_per_sector;
 	flash->size = flash->sector_size * params->nr_sectors;
 	flash->erase_cmd = params->op_erase;
+	if (params->op_erase == CMD_M25PXX_SSE)
+		spi_flash_add_erase_type(flash, CMD_M25PXX_SE, 64 * KiB);
 
 	flash->ops = &spi_flash_ops;
 
@@ -93,3 +93,20 @@ int tis_sendrecv(const uint8_t *sendbuf, size_t sbuf_size,
 
 	return 0;
 }
+
+int tis_send(const uint8_t *sendbuf, size_t sbuf_size)
+{
+	return tpm2_send_command(sendbuf, sbuf_size) ? -1 : 0;
+}
+
+int tis_recv(uint8_t *recvbuf, size_t *rbuf_len)
+{
+	size_t len = tpm2_receive_response(recvbuf, *rbuf_len);
+
+	if (len == 0)
+		return -1;
+
+	*rbuf_len = len;
+
+	return 0;
+}
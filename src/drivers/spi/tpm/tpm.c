@@ -86,14 +86,9 @@ __weak int tis_plat_irq_status(void)
  */
 static int tpm_sync(void)
 {
-	struct stopwatch sw;
-
-	stopwatch_init_msecs_expire(&sw, 10);
-	while (!tis_plat_irq_status()) {
-		if (stopwatch_expired(&sw)) {
-			printk(BIOS_ERR, "Timeout wait for tpm irq!\n");
-			return 0;
-		}
+	if (!tis_wait_irq(10)) {
+		printk(BIOS_ERR, "Timeout wait for tpm irq!\n");
+		return 0;
 	}
 	return 1;
 }
@@ -609,22 +604,16 @@ static void fifo_transfer(size_t transfer_size,
 	} while (handled_so_far != transfer_size);
 }
 
-size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
-			    void *tpm2_response, size_t max_response)
+int tpm2_send_command(const void *tpm2_command, size_t command_size)
 {
-	uint32_t status;
-	uint32_t expected_status_bits;
 	size_t payload_size;
-	size_t bytes_to_go;
 	const uint8_t *cmd_body = tpm2_command;
-	uint8_t *rsp_body = tpm2_response;
 	union fifo_transfer_buffer fifo_buffer;
-	const int HEADER_SIZE = 6;
 	struct tpm2_info *tpm_info = car_get_var_ptr(&g_tpm_info);
 
 	/* Do not try using an uninitialized TPM. */
 	if (!tpm_info->vendor_id)
-		return 0;
+		return -1;
 
 	/* Skip the two byte tag, read the size field. */
 	payload_size = read_be32(cmd_body + 2);
@@ -636,7 +625,7 @@ size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
 		       payload_size, command_size);
 		trace_dump("W", TPM_DATA_FIFO_REG, command_size, cmd_body, 1);
 		printk(BIOS_DEBUG, "\n");
-		return 0;
+		return -1;
 	}
 
 	/* Let the TPM know that the command is coming. */
@@ -659,17 +648,23 @@ size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
 	/* Now tell the TPM it can start processing the command. */
 	write_tpm_sts(TPM_STS_GO);
 
+	return 0;
+}
+
+size_t tpm2_receive_response(void *tpm2_response, size_t max_response)
+{
+	uint32_t status;
+	uint32_t expected_status_bits;
+	size_t payload_size;
+	size_t bytes_to_go;
+	uint8_t *rsp_body = tpm2_response;
+	union fifo_transfer_buffer fifo_buffer;
+	const int HEADER_SIZE = 6;
+
 	/* Now wait for it to report that the response is ready. */
 	expected_status_bits = TPM_STS_VALID | TPM_STS_DATA_AVAIL;
-	if (!wait_for_status(expected_status_bits, expected_status_bits)) {
-		/*
-		 * If timed out, which should never happen, let's at least
-		 * print out the offending command.
-		 */
-		trace_dump("W", TPM_DATA_FIFO_REG, command_size, cmd_body, 1);
-		printk(BIOS_DEBUG, "\n");
+	if (!wait_for_status(expected_status_bits, expected_status_bits))
 		return 0;
-	}
 
 	/*
 	 * The response is ready, let's read it. First we read the FIFO
@@ -729,3 +724,27 @@ size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
 
 	return payload_size;
 }
+
+size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
+			    void *tpm2_response, size_t max_response)
+{
+	size_t response_size;
+
+	if (tpm2_send_command(tpm2_command, command_size))
+		return 0;
+
+	response_size = tpm2_receive_response(tpm2_response, max_response);
+	if (!response_size) {
+		/*
+		 * If failed, which should never happen, let's at least print
+		 * out the offending command. The caller may have handed us
+		 * the same buffer for the command and the response, in which
+		 * case this shows the partial response instead.
+		 */
+		trace_dump("W", TPM_DATA_FIFO_REG, command_size,
+			   tpm2_command, 1);
+		printk(BIOS_DEBUG, "\n");
+	}
+
+	return response_size;
+}
@@ -42,6 +42,17 @@ int tpm2_init(struct spi_slave *spi_if);
 size_t tpm2_process_command(const void *tpm2_command, size_t command_size,
 			    void *tpm2_response, size_t max_response);
 
+/*
+ * The two halves of tpm2_process_command(), to let the caller do other work
+ * while the TPM is busy. Only one command may be outstanding at a time.
+ *
+ * tpm2_send_command() returns 0 once the command has been handed to the TPM,
+ * non-zero on failure. tpm2_receive_response() waits for the TPM to finish
+ * and returns the size of the response, or zero on failure.
+ */
+int tpm2_send_command(const void *tpm2_command, size_t command_size);
+size_t tpm2_receive_response(void *tpm2_response, size_t max_response);
+
 /* Get information about previously initialized TPM device. */
 void tpm2_get_info(struct tpm2_info *info);
 
@@ -229,6 +229,7 @@ int spi_flash_probe_winbond(const struct spi_slave *spi, u8 *idcode,
 	flash->size = flash->sector_size * params->sectors_per_block *
 			params->nr_blocks;
 	flash->erase_cmd = CMD_W25_SE;
+	spi_flash_add_erase_type(flash, CMD_W25_BE, 64 * KiB);
 	flash->status_cmd = CMD_W25_RDSR;
 
 	flash->ops = &spi_flash_ops;
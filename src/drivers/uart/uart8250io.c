@@ -16,6 +16,7 @@
 
 #include <rules.h>
 #include <stdlib.h>
+#include <arch/early_variables.h>
 #include <arch/io.h>
 #include <boot/coreboot_tables.h>
 #include <console/uart.h>
@@ -33,6 +34,30 @@
 #define SINGLE_CHAR_TIMEOUT	(50 * 1000)
 #define FIFO_TIMEOUT		(16 * SINGLE_CHAR_TIMEOUT)
 
+/*
+ * Once LSR_THRE reads as set the TX FIFO is empty and takes a whole FIFO of
+ * bytes. tx_room counts down what's left of that, so the LSR is polled once
+ * per FIFO instead of once per byte.
+ */
+static unsigned int tx_base CAR_GLOBAL;
+static size_t tx_fifo_size CAR_GLOBAL;
+static size_t tx_room CAR_GLOBAL;
+
+static size_t uart8250_fifo_size(unsigned int base_port)
+{
+	if (car_get_var(tx_base) != base_port) {
+		car_set_var(tx_base, base_port);
+		car_set_var(tx_room, 0);
+		/* Whoever set up the UART may have left the FIFO off. */
+		if ((inb(base_port + UART8250_IIR) & UART8250_IIR_FIFO_EN) ==
+		    UART8250_IIR_FIFO_EN)
+			car_set_var(tx_fifo_size, UART8250_FIFO_SIZE);
+		else
+			car_set_var(tx_fifo_size, 1);
+	}
+	return car_get_var(tx_fifo_size);
+}
+
 static int uart8250_can_tx_byte(unsigned base_port)
 {
 	return inb(base_port + UART8250_LSR) & UART8250_LSR_THRE;
@@ -40,15 +65,38 @@ static int uart8250_can_tx_byte(unsigned base_port)
 
 static void uart8250_tx_byte(unsigned base_port, unsigned char data)
 {
-	unsigned long int i = SINGLE_CHAR_TIMEOUT;
-	while (i-- && !uart8250_can_tx_byte(base_port));
+	size_t fifo_size = uart8250_fifo_size(base_port);
+
+	if (!car_get_var(tx_room)) {
+		unsigned long int i = SINGLE_CHAR_TIMEOUT;
+		while (i-- && !uart8250_can_tx_byte(base_port));
+		car_set_var(tx_room, fifo_size);
+	}
 	outb(data, base_port + UART8250_TBR);
+	car_set_var(tx_room, car_get_var(tx_room) - 1);
+}
+
+static size_t uart8250_tx_nowait(unsigned int base_port, const uint8_t *data,
+				 size_t len)
+{
+	size_t room = uart8250_fifo_size(base_port);
+	size_t i;
+
+	if (!uart8250_can_tx_byte(base_port))
+		return 0;
+
+	for (i = 0; i < len && i < room; i++)
+		outb(data[i], base_port + UART8250_TBR);
+	car_set_var(tx_room, room - i);
+
+	return i;
 }
 
 static void uart8250_tx_flush(unsigned base_port)
 {
 	unsigned long int i = FIFO_TIMEOUT;
 	while (i-- && !(inb(base_port + UART8250_LSR) & UART8250_LSR_TEMT));
+	car_set_var(tx_room, 0);
 }
 
 static int uart8250_can_rx_byte(unsigned base_port)
@@ -88,6 +136,9 @@ static void uart8250_init(unsigned base_port, unsigned divisor)
 
 	/* Set to 3 for 8N1 */
 	outb(CONFIG_TTYS0_LCS, base_port + UART8250_LCR);
+
+	/* Detect the FIFO again on the next byte. */
+	car_set_var(tx_base, 0);
 	ENABLE_TRACE;
 }
 
@@ -125,6 +176,11 @@ void uart_tx_flush(int idx)
 	uart8250_tx_flush(uart_platform_base(idx));
 }
 
+size_t uart_tx_nowait(int idx, const uint8_t *data, size_t len)
+{
+	return uart8250_tx_nowait(uart_platform_base(idx), data, len);
+}
+
 #if ENV_RAMSTAGE
 void uart_fill_lb(void *data)
 {
@@ -14,6 +14,7 @@
  * GNU General Public License for more details.
  */
 
+#include <arch/early_variables.h>
 #include <arch/io.h>
 #include <boot/coreboot_tables.h>
 #include <console/uart.h>
@@ -54,6 +55,29 @@ static void uart8250_write(void *base, uint8_t reg, uint8_t data)
 }
 #endif
 
+/*
+ * Once LSR_THRE reads as set the TX FIFO is empty and takes a whole FIFO of
+ * bytes. tx_room counts down what's left of that, so the LSR is polled once
+ * per FIFO instead of once per byte.
+ */
+static void *tx_base CAR_GLOBAL;
+static size_t tx_fifo_size CAR_GLOBAL;
+static size_t tx_room CAR_GLOBAL;
+
+static size_t uart8250_mem_fifo_size(void *base)
+{
+	if (car_get_var(tx_base) != base) {
+		car_set_var(tx_base, base);
+		car_set_var(tx_room, 0);
+		if ((uart8250_read(base, UART8250_IIR) & UART8250_IIR_FIFO_EN)
+		    == UART8250_IIR_FIFO_EN)
+			car_set_var(tx_fifo_size, UART8250_FIFO_SIZE);
+		else
+			car_set_var(tx_fifo_size, 1);
+	}
+	return car_get_var(tx_fifo_size);
+}
+
 static int uart8250_mem_can_tx_byte(void *base)
 {
 	return uart8250_read(base, UART8250_LSR) & UART8250_LSR_THRE;
@@ -61,10 +85,32 @@ static int uart8250_mem_can_tx_byte(void *base)
 
 static void uart8250_mem_tx_byte(void *base, unsigned char data)
 {
-	unsigned long int i = SINGLE_CHAR_TIMEOUT;
-	while (i-- && !uart8250_mem_can_tx_byte(base))
-		udelay(1);
+	size_t fifo_size = uart8250_mem_fifo_size(base);
+
+	if (!car_get_var(tx_room)) {
+		unsigned long int i = SINGLE_CHAR_TIMEOUT;
+		while (i-- && !uart8250_mem_can_tx_byte(base))
+			udelay(1);
+		car_set_var(tx_room, fifo_size);
+	}
 	uart8250_write(base, UART8250_TBR, data);
+	car_set_var(tx_room, car_get_var(tx_room) - 1);
+}
+
+static size_t uart8250_mem_tx_nowait(void *base, const uint8_t *data,
+				     size_t len)
+{
+	size_t room = uart8250_mem_fifo_size(base);
+	size_t i;
+
+	if (!uart8250_mem_can_tx_byte(base))
+		return 0;
+
+	for (i = 0; i < len && i < room; i++)
+		uart8250_write(base, UART8250_TBR, data[i]);
+	car_set_var(tx_room, room - i);
+
+	return i;
 }
 
 static void uart8250_mem_tx_flush(void *base)
@@ -72,6 +118,7 @@ static void uart8250_mem_tx_flush(void *base)
 	unsigned long int i = FIFO_TIMEOUT;
 	while (i-- && !(uart8250_read(base, UART8250_LSR) & UART8250_LSR_TEMT))
 		udelay(1);
+	car_set_var(tx_room, 0);
 }
 
 static int uart8250_mem_can_rx_byte(void *base)
@@ -110,6 +157,9 @@ static void uart8250_mem_init(void *base, unsigned divisor)
 
 	/* Set to 3 for 8N1 */
 	uart8250_write(base, UART8250_LCR, CONFIG_TTYS0_LCS);
+
+	/* Detect the FIFO again on the next byte. */
+	car_set_var(tx_base, NULL);
 }
 
 void uart_init(int idx)
@@ -148,6 +198,14 @@ void uart_tx_flush(int idx)
 	uart8250_mem_tx_flush(base);
 }
 
+size_t uart_tx_nowait(int idx, const uint8_t *data, size_t len)
+{
+	void *base = uart_platform_baseptr(idx);
+	if (!base)
+		return len;
+	return uart8250_mem_tx_nowait(base, data, len);
+}
+
 #if ENV_RAMSTAGE
 void uart_fill_lb(void *data)
 {
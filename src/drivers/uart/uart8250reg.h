@@ -35,8 +35,11 @@
 #define   UART8250_IIR_THRI	0x02 /* Transmitter holding register empty */
 #define   UART8250_IIR_RDI	0x04 /* Receiver data interrupt */
 #define   UART8250_IIR_RLSI	0x06 /* Receiver line status interrupt */
+#define   UART8250_IIR_FIFO_EN	0xc0 /* Both set: FIFOs enabled (16550A) */
 
 #define UART8250_FCR 0x02
+/* Bytes the TX FIFO of a 16550 takes once LSR_THRE reads as empty. */
+#define   UART8250_FIFO_SIZE		16
 #define   UART8250_FCR_FIFO_EN		0x01 /* Fifo enable */
 #define   UART8250_FCR_CLEAR_RCVR	0x02 /* Clear the RCVR FIFO */
 #define   UART8250_FCR_CLEAR_XMIT	0x04 /* Clear the XMIT FIFO */
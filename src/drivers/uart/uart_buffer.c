@@ -0,0 +1,105 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <console/uart.h>
+#include <smp/spinlock.h>
+#include <timer.h>
+
+/* How often the timer queue gives the UART more of the buffer. 16 bytes
+ * take about 1.4ms at 115200 baud. */
+#define UART_BUFFER_POLL_US	1000
+
+#define UART_BUFFER_SIZE	CONFIG_CONSOLE_SERIAL_BUFFER_SIZE
+
+/* head and tail run freely, only their difference is bounded by the size. */
+static uint8_t buffer[UART_BUFFER_SIZE];
+static size_t head;
+static size_t tail;
+
+/* printk() may run on any CPU while the BSP drains from its timer. */
+DECLARE_SPIN_LOCK(uart_buffer_lock)
+
+static struct timeout_callback drain_timer;
+
+/* Hand the UART as much as it takes. Returns how much is left over. */
+static size_t drain_locked(void)
+{
+	while (head != tail) {
+		size_t pos = tail % UART_BUFFER_SIZE;
+		size_t len = head - tail;
+		size_t sent;
+
+		/* Only up to the end of the buffer in one go. */
+		if (len > UART_BUFFER_SIZE - pos)
+			len = UART_BUFFER_SIZE - pos;
+
+		sent = uart_tx_nowait(CONFIG_UART_FOR_CONSOLE, &buffer[pos],
+				      len);
+		if (!sent)
+			break;
+		tail += sent;
+	}
+
+	return head - tail;
+}
+
+void uart_buffer_tx_byte(unsigned char data)
+{
+	spin_lock(&uart_buffer_lock);
+
+	/* Waiting for the UART is better than losing output. */
+	while (head - tail == UART_BUFFER_SIZE)
+		drain_locked();
+
+	buffer[head % UART_BUFFER_SIZE] = data;
+	head++;
+
+	spin_unlock(&uart_buffer_lock);
+}
+
+void uart_buffer_drain(void)
+{
+	spin_lock(&uart_buffer_lock);
+	drain_locked();
+	spin_unlock(&uart_buffer_lock);
+}
+
+void uart_buffer_sync(void)
+{
+	spin_lock(&uart_buffer_lock);
+	while (drain_locked())
+		;
+	spin_unlock(&uart_buffer_lock);
+
+	uart_tx_flush(CONFIG_UART_FOR_CONSOLE);
+}
+
+static void drain_timer_callback(struct timeout_callback *tocb)
+{
+	uart_buffer_drain();
+	timer_sched_callback(tocb, UART_BUFFER_POLL_US);
+}
+
+/*
+ * The timer queue is run on every boot state transition, while a state is
+ * blocked and from the idle thread. That is where the draining between two
+ * printk() calls happens.
+ */
+static void uart_buffer_start(void *unused)
+{
+	drain_timer.callback = drain_timer_callback;
+	timer_sched_callback(&drain_timer, UART_BUFFER_POLL_US);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_PRE_DEVICE, BS_ON_ENTRY, uart_buffer_start, NULL);
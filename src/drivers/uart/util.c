@@ -11,6 +11,7 @@
  * GNU General Public License for more details.
  */
 
+#include <compiler.h>
 #include <console/console.h>
 #include <console/uart.h>
 #include <types.h>
@@ -56,6 +57,17 @@ unsigned int uart_platform_refclk(void)
 }
 #endif
 
+/* For drivers that can't tell whether the UART takes another byte. */
+size_t __weak uart_tx_nowait(int idx, const uint8_t *data, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		uart_tx_byte(idx, data[i]);
+
+	return len;
+}
+
 /* Helper function to allow bitbanging an 8n1 UART. */
 void uart_bitbang_tx_byte(unsigned char data, void (*set_tx)(int line_state))
 {
@@ -14,29 +14,65 @@
  * GNU General Public License for more details.
  */
 
+#include <bootstate.h>
 #include <console/usb.h>
+#include <rules.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ehci_debug.h"
 
+#define DBGP_PACKET_SIZE	8
+/* Drop at most 2^8 - 1 packets between tries of a failing dongle. */
+#define DBGP_MAX_BACKOFF	8
+
+/*
+ * Send the buffered output in whole packets, and also the partial packet
+ * at the end if `all` is set. A dongle that stops answering costs a full
+ * transfer timeout per packet, so after each failure the next 2^n - 1
+ * packets are dropped without trying.
+ */
+static void usbdebug_tx_packets(struct dbgp_pipe *pipe,
+				struct dbgp_console_buffer *cb, int all)
+{
+	size_t sent = 0;
+
+	while (cb->len - sent >= DBGP_PACKET_SIZE || (all && sent < cb->len)) {
+		size_t len = MIN(DBGP_PACKET_SIZE, cb->len - sent);
+
+		if (cb->skip) {
+			cb->skip--;
+		} else if (dbgp_bulk_write_x(pipe, cb->buf + sent, len) < 0) {
+			if (cb->failures < DBGP_MAX_BACKOFF)
+				cb->failures++;
+			cb->skip = (1 << cb->failures) - 1;
+		} else {
+			cb->failures = 0;
+		}
+		sent += len;
+	}
+
+	memmove(cb->buf, cb->buf + sent, cb->len - sent);
+	cb->len -= sent;
+}
+
 static void usbdebug_tx_byte(struct dbgp_pipe *pipe, unsigned char data)
 {
+	struct dbgp_console_buffer *cb;
+
 	if (!dbgp_try_get(pipe))
 		return;
-	pipe->buf[pipe->bufidx++] = data;
-	if (pipe->bufidx >= 8) {
-		dbgp_bulk_write_x(pipe, pipe->buf, pipe->bufidx);
-		pipe->bufidx = 0;
-	}
+	cb = dbgp_console_buffer();
+	cb->buf[cb->len++] = data;
+	if (cb->len >= sizeof(cb->buf))
+		usbdebug_tx_packets(pipe, cb, 0);
 	dbgp_put(pipe);
 }
 
-static void usbdebug_tx_flush(struct dbgp_pipe *pipe)
+static void usbdebug_tx_flush(struct dbgp_pipe *pipe, int all)
 {
 	if (!dbgp_try_get(pipe))
 		return;
-	if (pipe->bufidx > 0) {
-		dbgp_bulk_write_x(pipe, pipe->buf, pipe->bufidx);
-		pipe->bufidx = 0;
-	}
+	usbdebug_tx_packets(pipe, dbgp_console_buffer(), all);
 	dbgp_put(pipe);
 }
 
@@ -62,9 +98,15 @@ void usb_tx_byte(int idx, unsigned char data)
 	usbdebug_tx_byte(dbgp_console_output(), data);
 }
 
+/* Called after every message; the partial packet waits for more output. */
 void usb_tx_flush(int idx)
 {
-	usbdebug_tx_flush(dbgp_console_output());
+	usbdebug_tx_flush(dbgp_console_output(), 0);
+}
+
+void usb_tx_sync(int idx)
+{
+	usbdebug_tx_flush(dbgp_console_output(), 1);
 }
 
 unsigned char usb_rx_byte(int idx)
@@ -76,3 +118,15 @@ int usb_can_rx_byte(int idx)
 {
 	return dbgp_ep_is_active(dbgp_console_input());
 }
+
+#if ENV_RAMSTAGE
+static void usbdebug_bs_sync(void *unused)
+{
+	usb_tx_sync(USB_PIPE_FOR_CONSOLE);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENUMERATE, BS_ON_EXIT, usbdebug_bs_sync, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_RESOURCES, BS_ON_EXIT, usbdebug_bs_sync, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, usbdebug_bs_sync, NULL);
+BOOT_STATE_INIT_ENTRY(BS_POST_DEVICE, BS_ON_EXIT, usbdebug_bs_sync, NULL);
+#endif
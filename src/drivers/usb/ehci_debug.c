@@ -31,6 +31,7 @@ struct ehci_debug_info {
 	void *ehci_debug;
 
 	struct dbgp_pipe ep_pipe[DBGP_MAX_ENDPOINTS];
+	struct dbgp_console_buffer console;
 };
 
 #if IS_ENABLED(CONFIG_DEBUG_USBDEBUG)
@@ -713,6 +714,11 @@ struct dbgp_pipe *dbgp_console_input(void)
 	return &dbgp_ehci_info()->ep_pipe[DBGP_CONSOLE_EPIN];
 }
 
+struct dbgp_console_buffer *dbgp_console_buffer(void)
+{
+	return &dbgp_ehci_info()->console;
+}
+
 void usbdebug_init(void)
 {
 	/* USB console init is done early in romstage, yet delayed to
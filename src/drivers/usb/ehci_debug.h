@@ -53,6 +53,17 @@ struct dbgp_pipe
 	char buf[8];
 };
 
+/* Console output waiting to fill a packet, kept with the debug port state. */
+struct dbgp_console_buffer
+{
+	u16 len;
+	u16 skip;	/* Packets to drop before trying the dongle again. */
+	u8 failures;
+	char buf[CONFIG_USBDEBUG_BUFFER_SIZE];
+};
+
+struct dbgp_console_buffer *dbgp_console_buffer(void);
+
 void dbgp_put(struct dbgp_pipe *pipe);
 int dbgp_try_get(struct dbgp_pipe *pipe);
 
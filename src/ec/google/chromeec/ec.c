@@ -512,6 +512,102 @@ int google_chromeec_check_feature(int feature)
 	return r.flags[feature / 32] & EC_FEATURE_MASK_0(feature);
 }
 
+/*
+ * Board properties the EC reports, asked once per boot. They are collected
+ * in CAR and move to CBMEM with it, so later stages don't ask again.
+ */
+struct chromeec_info {
+	uint32_t valid;
+	uint32_t board_version;
+	uint32_t sku_id;
+	uint32_t cbi_sku_id;
+	uint32_t cbi_oem_id;
+};
+
+#define EC_INFO_BOARD_VERSION	(1 << 0)
+#define EC_INFO_SKU_ID		(1 << 1)
+#define EC_INFO_CBI_SKU_ID	(1 << 2)
+#define EC_INFO_CBI_OEM_ID	(1 << 3)
+
+static struct chromeec_info ec_info CAR_GLOBAL;
+
+static struct chromeec_info *chromeec_info(void)
+{
+	struct chromeec_info *info = NULL;
+
+	if (!ENV_SMM && cbmem_possibly_online())
+		info = cbmem_find(CBMEM_ID_EC_INFO);
+
+	return info ? info : car_get_var_ptr(&ec_info);
+}
+
+static void chromeec_info_stash(int is_recovery)
+{
+	struct chromeec_info *car = car_get_var_ptr(&ec_info);
+	struct chromeec_info *info;
+
+	/* After S3 the entry from the first boot is still there. */
+	info = cbmem_find(CBMEM_ID_EC_INFO);
+	if (!info) {
+		info = cbmem_add(CBMEM_ID_EC_INFO, sizeof(*info));
+		if (!info)
+			return;
+		memset(info, 0, sizeof(*info));
+	}
+
+	if (car->valid & EC_INFO_BOARD_VERSION)
+		info->board_version = car->board_version;
+	if (car->valid & EC_INFO_SKU_ID)
+		info->sku_id = car->sku_id;
+	if (car->valid & EC_INFO_CBI_SKU_ID)
+		info->cbi_sku_id = car->cbi_sku_id;
+	if (car->valid & EC_INFO_CBI_OEM_ID)
+		info->cbi_oem_id = car->cbi_oem_id;
+	info->valid |= car->valid;
+}
+
+ROMSTAGE_CBMEM_INIT_HOOK(chromeec_info_stash)
+
+int google_chromeec_start_vboot_hash(void)
+{
+	struct ec_params_vboot_hash p = {
+		.cmd = EC_VBOOT_HASH_GET,
+	};
+	struct ec_response_vboot_hash r;
+	struct chromeec_command cmd = {
+		.cmd_code = EC_CMD_VBOOT_HASH,
+		.cmd_version = 0,
+		.cmd_data_in = &p,
+		.cmd_size_in = sizeof(p),
+		.cmd_data_out = &r,
+		.cmd_size_out = sizeof(r),
+		.cmd_dev_index = 0,
+	};
+
+	if (google_chromeec_command(&cmd) != 0)
+		return -1;
+
+	/* Leave a hash that is done or on its way alone. */
+	if (r.status != EC_VBOOT_HASH_STATUS_NONE)
+		return 0;
+
+	p.cmd = EC_VBOOT_HASH_START;
+	p.hash_type = EC_VBOOT_HASH_TYPE_SHA256;
+	p.offset = EC_VBOOT_HASH_OFFSET_ACTIVE;
+	p.size = 0;
+	cmd.cmd_size_out = 0;
+
+	return google_chromeec_command(&cmd) ? -1 : 0;
+}
+
+#if IS_ENABLED(CONFIG_VBOOT_EC_SOFTWARE_SYNC) && !defined(__SMM__)
+void vboot_ec_sync_prepare(void)
+{
+	if (google_chromeec_start_vboot_hash() < 0)
+		printk(BIOS_WARNING, "Chrome EC: failed to start RW hash\n");
+}
+#endif
+
 int google_chromeec_set_sku_id(u32 skuid)
 {
 	struct chromeec_command cmd;
@@ -530,6 +626,8 @@ int google_chromeec_set_sku_id(u32 skuid)
 	if (google_chromeec_command(&cmd) != 0)
 		return -1;
 
+	chromeec_info()->valid &= ~EC_INFO_SKU_ID;
+
 	return 0;
 }
 
@@ -599,20 +697,42 @@ static int cbi_get_uint32(uint32_t *id, uint32_t tag)
 
 int google_chromeec_cbi_get_sku_id(uint32_t *id)
 {
-	return cbi_get_uint32(id, CBI_TAG_SKU_ID);
+	struct chromeec_info *info = chromeec_info();
+
+	if (!(info->valid & EC_INFO_CBI_SKU_ID)) {
+		if (cbi_get_uint32(&info->cbi_sku_id, CBI_TAG_SKU_ID) < 0)
+			return -1;
+		info->valid |= EC_INFO_CBI_SKU_ID;
+	}
+
+	*id = info->cbi_sku_id;
+	return 0;
 }
 
 int google_chromeec_cbi_get_oem_id(uint32_t *id)
 {
-	return cbi_get_uint32(id, CBI_TAG_OEM_ID);
+	struct chromeec_info *info = chromeec_info();
+
+	if (!(info->valid & EC_INFO_CBI_OEM_ID)) {
+		if (cbi_get_uint32(&info->cbi_oem_id, CBI_TAG_OEM_ID) < 0)
+			return -1;
+		info->valid |= EC_INFO_CBI_OEM_ID;
+	}
+
+	*id = info->cbi_oem_id;
+	return 0;
 }
 
 #ifndef __SMM__
 u16 google_chromeec_get_board_version(void)
 {
+	struct chromeec_info *info = chromeec_info();
 	struct chromeec_command cmd;
 	struct ec_response_board_version board_v;
 
+	if (info->valid & EC_INFO_BOARD_VERSION)
+		return info->board_version;
+
 	cmd.cmd_code = EC_CMD_GET_BOARD_VERSION;
 	cmd.cmd_version = 0;
 	cmd.cmd_size_in = 0;
@@ -623,14 +743,21 @@ u16 google_chromeec_get_board_version(void)
 	if (google_chromeec_command(&cmd) != 0)
 		return 0;
 
+	info->board_version = board_v.board_version;
+	info->valid |= EC_INFO_BOARD_VERSION;
+
 	return board_v.board_version;
 }
 
 u32 google_chromeec_get_sku_id(void)
 {
+	struct chromeec_info *info = chromeec_info();
 	struct chromeec_command cmd;
 	struct ec_sku_id_info sku_v;
 
+	if (info->valid & EC_INFO_SKU_ID)
+		return info->sku_id;
+
 	cmd.cmd_code = EC_CMD_GET_SKU_ID;
 	cmd.cmd_version = 0;
 	cmd.cmd_size_in = 0;
@@ -641,6 +768,9 @@ u32 google_chromeec_get_sku_id(void)
 	if (google_chromeec_command(&cmd) != 0)
 		return 0;
 
+	info->sku_id = sku_v.sku_id;
+	info->valid |= EC_INFO_SKU_ID;
+
 	return sku_v.sku_id;
 }
 
@@ -49,6 +49,9 @@ uint8_t google_chromeec_calc_checksum(const uint8_t *data, int size);
 u16 google_chromeec_get_board_version(void);
 u32 google_chromeec_get_sku_id(void);
 int google_chromeec_set_sku_id(u32 skuid);
+/* Have the EC hash its active RW image in the background unless it already
+ * has. Returns 0 on success, < 0 on error. */
+int google_chromeec_start_vboot_hash(void);
 uint64_t  google_chromeec_get_events_b(void);
 int google_chromeec_clear_events_b(uint64_t mask);
 int google_chromeec_kbbacklight(int percent);
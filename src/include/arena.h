@@ -0,0 +1,41 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/*
+ * Scratch memory for ramstage work which is done with as a whole, like
+ * building a table out of temporary pieces. arena_begin() opens a scope,
+ * arena_alloc() hands out memory from the innermost one and
+ * arena_release() frees everything allocated in a scope at once. Scopes
+ * nest; releasing one also releases those opened inside it.
+ *
+ * The memory is 8 byte aligned and comes from a buffer of ARENA_SIZE
+ * bytes taken from the heap on the first use.
+ */
+struct arena_scope {
+	size_t mark;
+	unsigned int depth;
+};
+
+struct arena_scope arena_begin(void);
+
+/* Returns NULL when the arena is full or no scope is open. */
+void *arena_alloc(size_t size);
+
+void arena_release(struct arena_scope scope);
+
+#endif /* ARENA_H */
@@ -50,4 +50,17 @@ int boot_device_rw_subregion(const struct region *sub,
  **/
 void boot_device_init(void);
 
+/*
+ * Start reading size bytes at offset of the read-only boot device in the
+ * background, for BOOT_DEVICE_SPI_FLASH_PREFETCH. The data goes to the
+ * CBFS cache. Reads of the boot device overlapping that range wait for it
+ * and are served from there. Every other read, and
+ * boot_device_prefetch_poll(), moves the prefetch along.
+ * boot_device_prefetch_end() drops it. Only one prefetch runs at a time.
+ * Returns < 0 if none was started.
+ */
+int boot_device_prefetch(size_t offset, size_t size);
+void boot_device_prefetch_poll(void);
+void boot_device_prefetch_end(void);
+
 #endif /* _BOOT_DEVICE_H_ */
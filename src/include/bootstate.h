@@ -111,14 +111,31 @@ typedef enum {
 	BS_ON_EXIT
 } boot_state_sequence_t;
 
+/*
+ * A callback flagged BS_CALLBACK_CONCURRENT may run in a thread of its own
+ * alongside the other callbacks of the phase, as long as
+ * COOP_MULTITASKING is available. It gets the small stack of a thread and
+ * everything it shares with other callbacks has to cope with that. The
+ * phase is complete only once all of them returned.
+ */
+#define BS_CALLBACK_CONCURRENT		(1 << 0)
+
 struct boot_state_callback {
 	void *arg;
 	void (*callback)(void *arg);
+	unsigned int flags;
+	/* The callback does not start before any callback of the same phase
+	 * calling depends() has finished. */
+	void (*depends)(void *arg);
 	/* For use internal to the boot state machine. */
 	struct boot_state_callback *next;
+	int running;
 #if IS_ENABLED(CONFIG_DEBUG_BOOT_STATE)
 	const char *location;
 #endif
+#if IS_ENABLED(CONFIG_BS_TIMES)
+	const char *name;
+#endif
 };
 
 #if IS_ENABLED(CONFIG_DEBUG_BOOT_STATE)
@@ -133,14 +150,26 @@ struct boot_state_callback {
 #define INIT_BOOT_STATE_CALLBACK_DEBUG(bscb_)
 #endif
 
-#define BOOT_STATE_CALLBACK_INIT(func_, arg_)		\
+#if IS_ENABLED(CONFIG_BS_TIMES)
+#define BOOT_STATE_CALLBACK_INIT_NAME(func_) .name = #func_,
+#else
+#define BOOT_STATE_CALLBACK_INIT_NAME(func_)
+#endif
+
+#define BOOT_STATE_CALLBACK_INIT_DEPS(func_, arg_, flags_, depends_) \
 	{						\
 		.arg = arg_,				\
 		.callback = func_,			\
+		.flags = flags_,			\
+		.depends = depends_,			\
 		.next = NULL,				\
 		BOOT_STATE_CALLBACK_INIT_DEBUG		\
+		BOOT_STATE_CALLBACK_INIT_NAME(func_)	\
 	}
 
+#define BOOT_STATE_CALLBACK_INIT(func_, arg_)		\
+	BOOT_STATE_CALLBACK_INIT_DEPS(func_, arg_, 0, NULL)
+
 #define BOOT_STATE_CALLBACK(name_, func_, arg_)	\
 	struct boot_state_callback name_ = BOOT_STATE_CALLBACK_INIT(func_, arg_)
 
@@ -154,8 +183,8 @@ struct boot_state_callback {
 
 /* The following 2 functions schedule a callback to be called on entry/exit
  * to a given state. Note that there are no ordering guarantees between the
- * individual callbacks on a given state. 0 is returned on success < 0 on
- * error. */
+ * individual callbacks on a given state other than the ones made with
+ * depends. 0 is returned on success < 0 on error. */
 int boot_state_sched_on_entry(struct boot_state_callback *bscb,
 				boot_state_t state);
 int boot_state_sched_on_exit(struct boot_state_callback *bscb,
@@ -188,17 +217,22 @@ struct boot_state_init_entry {
 #define BOOT_STATE_INIT_ATTR  __attribute__((unused))
 #endif
 
-#define BOOT_STATE_INIT_ENTRY(state_, when_, func_, arg_)		\
+#define BOOT_STATE_INIT_ENTRY_DEPS(state_, when_, func_, arg_, flags_,	\
+				   depends_)				\
 	static struct boot_state_init_entry func_ ##_## state_ ##_## when_ = \
 	{								\
 		.state = state_,					\
 		.when = when_,						\
-		.bscb = BOOT_STATE_CALLBACK_INIT(func_, arg_),		\
+		.bscb = BOOT_STATE_CALLBACK_INIT_DEPS(func_, arg_, flags_, \
+						      depends_),	\
 	};								\
 	static struct boot_state_init_entry *				\
 		bsie_ ## func_ ##_## state_ ##_## when_ BOOT_STATE_INIT_ATTR = \
 		&func_ ##_## state_ ##_## when_;
 
+#define BOOT_STATE_INIT_ENTRY(state_, when_, func_, arg_)		\
+	BOOT_STATE_INIT_ENTRY_DEPS(state_, when_, func_, arg_, 0, NULL)
+
 /* Hook per arch when coreboot is exiting to payload or ACPI OS resume. It's
  * the very last thing done before the transition. */
 void arch_bootstate_coreboot_exit(void);
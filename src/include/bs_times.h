@@ -0,0 +1,47 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BS_TIMES_H
+#define BS_TIMES_H
+
+#include <bootstate.h>
+#include <commonlib/bs_times_serialized.h>
+#include <timer.h>
+
+/*
+ * Time a boot state callback or device operation into the CBMEM table
+ * util/cbmem reports the slowest of:
+ *
+ *	struct mono_time start;
+ *
+ *	bs_times_start(&start);
+ *	dev->ops->init(dev);
+ *	bs_times_stop(&start, BS_TIMES_INIT, BS_DEV_INIT,
+ *		      (uintptr_t)dev->ops->init, dev_path(dev));
+ */
+#if IS_ENABLED(CONFIG_BS_TIMES) && ENV_RAMSTAGE
+static inline void bs_times_start(struct mono_time *start)
+{
+	timer_monotonic_get(start);
+}
+
+void bs_times_stop(const struct mono_time *start, enum bs_times_kind kind,
+		   boot_state_t state, uintptr_t func, const char *name);
+#else
+static inline void bs_times_start(struct mono_time *start) {}
+static inline void bs_times_stop(const struct mono_time *start,
+				 enum bs_times_kind kind, boot_state_t state,
+				 uintptr_t func, const char *name) {}
+#endif
+
+#endif /* BS_TIMES_H */
@@ -0,0 +1,29 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __BZIMAGE_PAYLOAD_H_
+#define __BZIMAGE_PAYLOAD_H_
+
+#include <program_loading.h>
+
+/*
+ * Load a Linux bzImage payload to where it runs, along with the optional
+ * CBFS_PREFIX/initrd and CBFS_PREFIX/cmdline files, and set up its boot
+ * parameters. The entry argument of the payload points to them.
+ */
+void bzimage_payload(struct prog *payload);
+
+/* Start a payload loaded by bzimage_payload(). Does not return. */
+void bzimage_run(struct prog *payload);
+
+#endif /* __BZIMAGE_PAYLOAD_H_ */
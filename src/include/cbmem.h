@@ -111,6 +111,8 @@ void cbmem_fail_resume(void);
 /* Ramstage only functions. */
 /* Add the cbmem memory used to the memory map at boot. */
 void cbmem_add_bootmem(void);
+/* Return the location and size of all of cbmem. */
+void cbmem_get_region(void **baseptr, size_t *size);
 void cbmem_list(void);
 void cbmem_add_records_to_cbtable(struct lb_header *header);
 
@@ -0,0 +1,37 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef CBMEM_ARENA_H
+#define CBMEM_ARENA_H
+
+#include <commonlib/cbmem_arena_serialized.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Small records that don't merit a CBMEM entry of their own share one. The
+ * arena is created on the first allocation once CBMEM is up and lives on
+ * across stages and S3 resume. "cbmem -a" lists the records.
+ *
+ * Returns the zeroed payload or NULL when the arena is full or missing.
+ */
+void *cbmem_arena_alloc(uint32_t tag, size_t size);
+
+/*
+ * Walks the records carrying tag, starting after prev or from the first one
+ * when prev is NULL. Returns the payload and fills in size if not NULL;
+ * NULL when there are no more.
+ */
+void *cbmem_arena_next(uint32_t tag, const void *prev, size_t *size);
+
+#endif /* CBMEM_ARENA_H */
@@ -0,0 +1,40 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef CONSOLE_BINLOG_H
+#define CONSOLE_BINLOG_H
+
+#include <rules.h>
+#include <console/vtxprintf.h>
+
+/*
+ * Record a printk() message into the binary console log without formatting
+ * it. Returns 0 when recorded, < 0 when the message has to go out as text
+ * because the log isn't up yet, is full or can't describe it.
+ */
+#if IS_ENABLED(CONFIG_CONSOLE_BINARY_LOG) && ENV_RAMSTAGE
+/* Recorded messages less important than this are not printed as text. */
+#define CONSOLE_BINLOG_TEXT_LEVEL CONFIG_CONSOLE_BINARY_LOG_TEXT_LEVEL
+
+int console_binlog_printk(int msg_level, const char *fmt, va_list args);
+#else
+#define CONSOLE_BINLOG_TEXT_LEVEL BIOS_SPEW
+
+static inline int console_binlog_printk(int msg_level, const char *fmt,
+					va_list args)
+{
+	return -1;
+}
+#endif
+
+#endif /* CONSOLE_BINLOG_H */
@@ -57,9 +57,13 @@ void die_notify(void);
 #if __CONSOLE_ENABLE__
 asmlinkage void console_init(void);
 int console_log_level(int msg_level);
+/* Return the CONSOLE_SINK_* a message of msg_level goes to, 0 for none. */
+int console_log_sinks(int msg_level);
 int do_printk(int msg_level, const char *fmt, ...)
 	__attribute__((format(printf, 2, 3)));
 void do_putchar(unsigned char byte);
+/* Wait until all console output buffered so far has gone out. */
+void console_tx_sync(void);
 
 #define printk(LEVEL, fmt, args...) \
 	do { do_printk(LEVEL, fmt, ##args); } while (0)
@@ -79,8 +83,10 @@ static inline int get_console_loglevel(void)
 #else
 static inline void console_init(void) {}
 static inline int console_log_level(int msg_level) { return 0; }
+static inline int console_log_sinks(int msg_level) { return 0; }
 static inline void printk(int LEVEL, const char *fmt, ...) {}
 static inline void do_putchar(unsigned char byte) {}
+static inline void console_tx_sync(void) {}
 #endif
 
 #if IS_ENABLED(CONFIG_VBOOT)
@@ -22,6 +22,8 @@
 void flashconsole_init(void);
 void flashconsole_tx_byte(unsigned char c);
 void flashconsole_tx_flush(void);
+/* Write out the partial page, e.g. before the next stage or on die(). */
+void flashconsole_tx_sync(void);
 
 #define __CONSOLE_FLASH_ENABLE__	IS_ENABLED(CONFIG_CONSOLE_SPI_FLASH)
 
@@ -35,10 +37,15 @@ static inline void __flashconsole_tx_flush(void)
 {
 	flashconsole_tx_flush();
 }
+static inline void __flashconsole_tx_sync(void)
+{
+	flashconsole_tx_sync();
+}
 #else
 static inline void __flashconsole_init(void)	{}
 static inline void __flashconsole_tx_byte(u8 data)	{}
 static inline void __flashconsole_tx_flush(void)	{}
+static inline void __flashconsole_tx_sync(void)	{}
 #endif /* __CONSOLE_FLASH_ENABLE__ */
 
 
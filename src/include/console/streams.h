@@ -19,6 +19,16 @@
 
 void console_hw_init(void);
 void console_tx_byte(unsigned char byte);
+
+/* Consoles with a log level of their own, the rest use the console's. */
+#define CONSOLE_SINK_CBMEM	(1 << 0)
+#define CONSOLE_SINK_SERIAL	(1 << 1)
+#define CONSOLE_SINK_OTHERS	(1 << 2)
+#define CONSOLE_SINK_ALL	(CONSOLE_SINK_CBMEM | CONSOLE_SINK_SERIAL | \
+				 CONSOLE_SINK_OTHERS)
+
+/* Send a string to the consoles in the CONSOLE_SINK_* mask sinks. */
+void console_tx_buffer(const void *data, size_t len, int sinks);
 void console_tx_flush(void);
 
 /*
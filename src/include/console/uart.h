@@ -17,6 +17,7 @@
 #define CONSOLE_UART_H
 
 #include <rules.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /* Return the clock frequency UART uses as reference clock for
@@ -53,6 +54,9 @@ void uart_init(int idx);
 void uart_tx_byte(int idx, unsigned char data);
 void uart_tx_flush(int idx);
 unsigned char uart_rx_byte(int idx);
+/* Send as many of the bytes as the UART takes without waiting and return
+ * how many that were. Drivers that can't tell wait for each byte. */
+size_t uart_tx_nowait(int idx, const uint8_t *data, size_t len);
 
 uintptr_t uart_platform_base(int idx);
 
@@ -68,6 +72,14 @@ void oxford_remap(unsigned int new_base);
 	(ENV_BOOTBLOCK || ENV_ROMSTAGE || ENV_RAMSTAGE || ENV_VERSTAGE || \
 	ENV_POSTCAR || (ENV_SMM && IS_ENABLED(CONFIG_DEBUG_SMI))))
 
+#define __CONSOLE_SERIAL_BUFFERED__	\
+	(IS_ENABLED(CONFIG_CONSOLE_SERIAL_BUFFERED) && ENV_RAMSTAGE)
+
+/* Buffered console output, see CONSOLE_SERIAL_BUFFERED. */
+void uart_buffer_tx_byte(unsigned char data);
+void uart_buffer_drain(void);
+void uart_buffer_sync(void);
+
 #if __CONSOLE_SERIAL_ENABLE__
 static inline void __uart_init(void)
 {
@@ -75,16 +87,28 @@ static inline void __uart_init(void)
 }
 static inline void __uart_tx_byte(u8 data)
 {
-	uart_tx_byte(CONFIG_UART_FOR_CONSOLE, data);
+	if (__CONSOLE_SERIAL_BUFFERED__)
+		uart_buffer_tx_byte(data);
+	else
+		uart_tx_byte(CONFIG_UART_FOR_CONSOLE, data);
 }
 static inline void __uart_tx_flush(void)
 {
-	uart_tx_flush(CONFIG_UART_FOR_CONSOLE);
+	if (__CONSOLE_SERIAL_BUFFERED__)
+		uart_buffer_drain();
+	else
+		uart_tx_flush(CONFIG_UART_FOR_CONSOLE);
+}
+static inline void __uart_tx_sync(void)
+{
+	if (__CONSOLE_SERIAL_BUFFERED__)
+		uart_buffer_sync();
 }
 #else
 static inline void __uart_init(void)		{}
 static inline void __uart_tx_byte(u8 data)	{}
 static inline void __uart_tx_flush(void)	{}
+static inline void __uart_tx_sync(void)		{}
 #endif
 
 #if IS_ENABLED(CONFIG_GDB_STUB) && (ENV_ROMSTAGE || ENV_RAMSTAGE)
@@ -24,6 +24,7 @@ void usbdebug_init(void);
 
 void usb_tx_byte(int idx, unsigned char data);
 void usb_tx_flush(int idx);
+void usb_tx_sync(int idx);
 unsigned char usb_rx_byte(int idx);
 int usb_can_rx_byte(int idx);
 
@@ -42,10 +43,12 @@ static inline void __usb_tx_byte(u8 data)
 	usb_tx_byte(USB_PIPE_FOR_CONSOLE, data);
 }
 static inline void __usb_tx_flush(void)	{ usb_tx_flush(USB_PIPE_FOR_CONSOLE); }
+static inline void __usb_tx_sync(void)	{ usb_tx_sync(USB_PIPE_FOR_CONSOLE); }
 #else
 static inline void __usbdebug_init(void)	{}
 static inline void __usb_tx_byte(u8 data)	{}
 static inline void __usb_tx_flush(void)	{}
+static inline void __usb_tx_sync(void)	{}
 #endif
 
 /*  */
@@ -17,6 +17,7 @@
 #define _X86_MP_H_
 
 #include <arch/smp/atomic.h>
+#include <cpu/x86/msr.h>
 #include <cpu/x86/smm.h>
 
 #define CACHELINE_SIZE 64
@@ -29,6 +30,24 @@ static inline void mfence(void)
 	__asm__ __volatile__("mfence\t\n": : :"memory");
 }
 
+/* Which CPUs write an mp_msr_setting. */
+enum mp_msr_scope {
+	MP_MSR_SCOPE_THREAD,	/* every logical cpu */
+	MP_MSR_SCOPE_CORE,	/* the first thread of each core */
+	MP_MSR_SCOPE_PACKAGE,	/* the first thread of each package */
+};
+
+/*
+ * Set the bits in mask of MSR index to value. The bits in mask are read back
+ * afterwards, so they must not include self-clearing or write-only bits.
+ */
+struct mp_msr_setting {
+	uint32_t index;
+	enum mp_msr_scope scope;
+	msr_t mask;
+	msr_t value;
+};
+
 /* The sequence of the callbacks are in calling order. */
 struct mp_ops {
 	/*
@@ -57,6 +76,14 @@ struct mp_ops {
 	 * can load the microcode in parallel.
 	 */
 	void (*get_microcode_info)(const void **microcode, int *parallel);
+	/*
+	 * Optionally provide a table of MSR settings. Every CPU applies it
+	 * right before its CPU driver runs: the BSP first, then all APs in
+	 * parallel. The table must stay valid until mp_init_with_smm()
+	 * returns.
+	 */
+	void (*get_msr_settings)(const struct mp_msr_setting **settings,
+				 size_t *count);
 	/*
 	 * Optionally adjust SMM handler parameters to override the default
 	 * values.  The is_perm variable indicates if the parameters to adjust
@@ -105,14 +132,15 @@ struct mp_ops {
  * 2. get_cpu_count()
  * 3. get_smm_info()
  * 4. get_microcode_info()
- * 5. adjust_cpu_apic_entry() for each number of get_cpu_count()
- * 6. adjust_smm_params(is_perm = 0)
- * 7. adjust_smm_params(is_perm = 1)
- * 8. pre_mp_smm_init()
- * 9. per_cpu_smm_trigger() in parallel for all cpus which calls
+ * 5. get_msr_settings()
+ * 6. adjust_cpu_apic_entry() for each number of get_cpu_count()
+ * 7. adjust_smm_params(is_perm = 0)
+ * 8. adjust_smm_params(is_perm = 1)
+ * 9. pre_mp_smm_init()
+ * 10. per_cpu_smm_trigger() in parallel for all cpus which calls
  *    relocation_handler() in SMM.
- * 10. mp_initialize_cpu() for each cpu
- * 11. post_mp_init()
+ * 11. MSR settings and mp_initialize_cpu() for each cpu
+ * 12. post_mp_init()
  */
 int mp_init_with_smm(struct bus *cpu_bus, const struct mp_ops *mp_ops);
 
@@ -139,6 +167,56 @@ int mp_run_on_aps(void (*func)(void *), void *arg, int logical_cpu_num,
 /* Like mp_run_on_aps() but also runs func on BSP. */
 int mp_run_on_all_cpus(void (*func)(void *), void *arg, long expire_us);
 
+struct mp_job {
+	void (*func)(void *arg);
+	void *arg;
+};
+
+/*
+ * Run num_jobs independent jobs in parallel on the BSP and all the APs and
+ * return once every job has completed. The jobs are spread across per-cpu
+ * queues and idle cpus steal work from the busy ones, so the jobs may run in
+ * any order and on any cpu. Without PARALLEL_MP_AP_WORK the jobs are run
+ * serially on the BSP. Like mp_run_on_aps() this may only be called on the
+ * BSP and jobs must not call any of these functions themselves.
+ *
+ * When expire_us runs out, the jobs no cpu has started yet are dropped and
+ * -1 is returned once the jobs already running have completed. Either way no
+ * cpu uses the jobs array or the job arguments after this returns, so they
+ * may live on the caller's stack.
+ */
+int mp_run_jobs(struct mp_job *jobs, size_t num_jobs, long expire_us);
+
+/*
+ * Split version of mp_run_jobs(). mp_queue_jobs() returns as soon as the APs
+ * have started on the jobs, leaving the BSP free to do other work until it
+ * calls mp_wait_jobs(). The jobs array must stay valid until then and only
+ * one batch of jobs may be queued at a time.
+ */
+int mp_queue_jobs(struct mp_job *jobs, size_t num_jobs, long expire_us);
+int mp_wait_jobs(long expire_us);
+
+/*
+ * Clear all RAM that is neither reserved nor in use by coreboot itself, with
+ * the BSP and all APs each taking chunks of it. This is done automatically at
+ * the end of device init when platform_requires_memory_clear() returns
+ * non-zero, e.g. because the OS asked for it through the MOR bit. Returns < 0
+ * when some RAM could not be cleared.
+ */
+int mp_clear_memory(void);
+int platform_requires_memory_clear(void);
+
+/*
+ * Test the same RAM mp_clear_memory() would clear with the BSP and all APs
+ * each taking chunks of it, with 128-bit streaming stores where the CPU has
+ * SSE2. Bad addresses are logged to the console and the event log. RAM is
+ * left cleared. Returns the number of bad addresses found or < 0 when some
+ * RAM could not be tested.
+ */
+int mp_test_memory(void);
+/* Index of the DIMM in the CBMEM_ID_MEMINFO table holding addr, or -1. */
+int platform_memtest_dimm(uint64_t addr);
+
 /*
  * Park all APs to prepare for OS boot. This is handled automatically
  * by the coreboot infrastructure.
@@ -153,5 +231,12 @@ int mp_park_aps(void);
 void smm_initiate_relocation_parallel(void);
 /* Send SMI to self with single execution. */
 void smm_initiate_relocation(void);
+/*
+ * Relocate the current cpu from a per_cpu_smm_trigger() callback, where the
+ * BSP has already been relocated once from pre_mp_smm_init(). Relocation runs
+ * on all cpus in parallel if the relocation handler could move the save state
+ * into MSRs, else the APs relocate one at a time.
+ */
+void smm_relocate_cpu(int parallel);
 
 #endif /* _X86_MP_H_ */
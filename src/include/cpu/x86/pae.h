@@ -1,6 +1,7 @@
 #ifndef CPU_X86_PAE_H
 #define CPU_X86_PAE_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /* Enable paging with cr3 value for page directory pointer table as well as PAE
@@ -37,6 +38,18 @@ int paging_enable_for_car(const char *pdpt_name, const char *pt_name);
  * PAT defines above. 0 is returned on success, < 0 on failure. */
 int paging_identity_map_addr(uintptr_t base, size_t size, int pat);
 
+/* Return 1 if the CPU supports 1GiB pages in long mode, 0 otherwise. */
+int paging_has_1g_pages(void);
+/* Return the size of the page tables paging_identity_map_long() needs to
+ * identity map [0, limit). */
+size_t paging_long_tables_size(uint64_t limit);
+/* Build long mode page tables in the 4KiB aligned buffer 'pgtbl' of 'size'
+ * bytes which identity map [0, limit) as WB. 1GiB pages are used where the
+ * CPU supports them, 2MiB pages otherwise. The value to load into cr3 is
+ * returned in 'cr3'. 0 is returned on success, < 0 on failure. */
+int paging_identity_map_long(void *pgtbl, size_t size, uint64_t limit,
+			     uintptr_t *cr3);
+
 #define MAPPING_ERROR ((void *)0xffffffffUL)
 void *map_2M_page(unsigned long page);
 
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef CPU_X86_PROFILER_H
+#define CPU_X86_PROFILER_H
+
+#include <rules.h>
+
+/*
+ * Vector of the LAPIC timer interrupt, above the ones of the 8259 PICs.
+ * The low four bits are all set so the spurious interrupt vector, which
+ * has them hardwired to one on older CPUs, can share it.
+ */
+#define PROFILER_VECTOR		0x3f
+
+#define HAVE_SAMPLING_PROFILER	\
+	(IS_ENABLED(CONFIG_SAMPLING_PROFILER) && ENV_RAMSTAGE)
+
+#ifndef __ASSEMBLER__
+
+#include <stdint.h>
+
+#if HAVE_SAMPLING_PROFILER
+/* Count the instruction the profiler interrupt arrived at. */
+void profiler_sample(uintptr_t ip);
+
+/* Stop sampling around code that brings its own interrupt vectors. */
+void profiler_pause(void);
+void profiler_resume(void);
+#else
+static inline void profiler_pause(void) {}
+static inline void profiler_resume(void) {}
+#endif
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* CPU_X86_PROFILER_H */
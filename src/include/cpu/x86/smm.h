@@ -474,6 +474,7 @@ typedef struct {
 #define APM_CNT_GNVS_UPDATE	0xea
 #define APM_CNT_FINALIZE	0xcb
 #define APM_CNT_LEGACY		0xcc
+#define APM_CNT_SMI_LATENCY	0xe7
 #define APM_STS		0xb3
 
 /* SMI handler function prototypes */
@@ -536,6 +537,20 @@ struct smm_module_params {
 /* smm_handler_t is called with arg of smm_module_params pointer. */
 typedef asmlinkage void (*smm_handler_t)(void *);
 
+/*
+ * SMI latency histogram kept for each CPU when SMM_LATENCY_HISTOGRAM is
+ * selected. bucket[n] counts the SMIs which kept the CPU in SMM for
+ * [2^n, 2^(n+1)) TSC ticks. The last bucket also absorbs anything longer.
+ */
+#define SMM_LATENCY_BUCKETS	32
+
+struct smm_latency_hist {
+	u32 count;
+	u32 reserved;
+	u64 max;
+	u32 bucket[SMM_LATENCY_BUCKETS];
+} __packed;
+
 #ifdef __SMM__
 /* SMM Runtime helpers. */
 
@@ -545,6 +560,10 @@ asmlinkage void smm_handler_start(void *params);
 /* Retrieve SMM save state for a given CPU. WARNING: This does not take into
  * account CPUs which are configured to not save their state to RAM. */
 void *smm_get_save_state(int cpu);
+
+/* Copy the per-CPU SMI latency histograms, indexed by CPU number, to buf.
+ * Returns the number of bytes copied. */
+size_t smm_latency_export(void *buf, size_t size);
 #endif /* __SMM__ */
 
 /* SMM Module Loading API */
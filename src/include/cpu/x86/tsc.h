@@ -65,4 +65,11 @@ static inline uint64_t tsc_to_uint64(tsc_t tstamp)
 /* Provided by CPU/chipset code for the TSC rate in MHz. */
 unsigned long tsc_freq_mhz(void);
 
+/*
+ * The TSC rate in MHz that udelay() uses: tsc_freq_mhz() with
+ * TSC_CONSTANT_RATE, otherwise read from CPUID or calibrated against the
+ * PIT once per stage.
+ */
+unsigned long tsc_calibrated_freq_mhz(void);
+
 #endif /* CPU_X86_TSC_H */
@@ -76,6 +76,11 @@ struct device_operations {
 	const struct smbus_bus_operations *ops_smbus_bus;
 	const struct pci_bus_operations * (*ops_pci_bus)(struct device *dev);
 	const struct pnp_mode_ops *ops_pnp_mode;
+	/*
+	 * init() may run on an idle AP, see PARALLEL_DEVICE_INIT. It must
+	 * not use CBFS, VPD or malloc().
+	 */
+	unsigned int init_on_ap : 1;
 };
 
 /**
@@ -135,6 +140,13 @@ struct device {
 	unsigned int    disable_pcie_aspm : 1;
 	struct pci_irq_info pci_irq_info[4];
 	u8 command;
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+	/* Shadow of read-only config registers, see pci_ops.c */
+	u32 pci_cfg_key;		/* bus << 8 | devfn the shadow is of */
+	u8 pci_cfg_valid;		/* one bit per pci_cfg[] slot */
+	u32 pci_cfg[3];			/* 0x00, 0x08 and 0x2c */
+	u8 pci_cap_pos[0x14];		/* first capability by ID, 0 if none */
+#endif
 
 	/* Base registers for this device. I/O, MEM and Expansion ROM */
 	DEVTREE_CONST struct resource *resource_list;
@@ -159,6 +171,9 @@ struct device {
 extern DEVTREE_CONST struct device	dev_root;
 /* list of all devices */
 extern DEVTREE_CONST struct device * DEVTREE_CONST all_devices;
+/* Static PCI devices by slot, from static.c */
+extern DEVTREE_CONST struct device * const static_pci_devs[];
+extern const uint16_t static_pci_slot_index[];
 extern struct resource	*free_resources;
 extern struct bus	*free_links;
 
@@ -187,6 +202,7 @@ void scan_bridges(struct bus *bus);
 void assign_resources(struct bus *bus);
 const char *dev_name(struct device *dev);
 const char *dev_path(const struct device *dev);
+const char *dev_path_buf(const struct device *dev, char *buffer, size_t size);
 u32 dev_path_encode(const struct device *dev);
 const char *bus_path(struct bus *bus);
 void dev_set_enabled(struct device *dev, int enable);
@@ -47,6 +47,7 @@
 #ifndef DEVICE_EARLY_SMBUS_H
 #define DEVICE_EARLY_SMBUS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -66,6 +67,10 @@ int smbus_wait_until_ready(u32 smbus_dev);
 u16 smbus_read_word(u32 smbus_dev, u8 addr, u8 offset);
 u8 smbus_read_byte(u32 smbus_dev, u8 addr, u8 offset);
 u8 smbus_write_byte(u32 smbus_dev, u8 addr, u8 offset, u8 value);
+/* Only where the controller can do I2C block reads, see
+ * CONFIG_SMBUS_HAS_I2C_BLOCK_READ. Returns the number of bytes read or < 0. */
+int smbus_i2c_block_read(u32 smbus_dev, u8 addr, u8 offset, size_t bytes,
+				u8 *buf);
 void smbus_delay(void);
 
 #endif				/* DEVICE_EARLY_SMBUS_H */
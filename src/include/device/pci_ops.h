@@ -6,6 +6,51 @@
 #include <arch/pci_ops.h>
 
 #ifndef __SIMPLE_DEVICE__
+#if IS_ENABLED(CONFIG_PCI_DIRECT_MMCONF)
+#include <arch/io.h>
+
+#define PCI_DIRECT_ADDR(dev, where, mask)				\
+	((void *)(((uintptr_t)CONFIG_MMCONF_BASE_ADDRESS |		\
+		   (((dev)->bus->secondary & 0xfff) << 20) |		\
+		   (((dev)->path.pci.devfn & 0xff) << 12) |		\
+		   ((where) & 0xfff)) & ~(mask)))
+
+static inline __attribute__((always_inline))
+u8 pci_read_config8(struct device *dev, unsigned int where)
+{
+	return read8(PCI_DIRECT_ADDR(dev, where, 0));
+}
+
+static inline __attribute__((always_inline))
+u16 pci_read_config16(struct device *dev, unsigned int where)
+{
+	return read16(PCI_DIRECT_ADDR(dev, where, 1));
+}
+
+static inline __attribute__((always_inline))
+u32 pci_read_config32(struct device *dev, unsigned int where)
+{
+	return read32(PCI_DIRECT_ADDR(dev, where, 3));
+}
+
+static inline __attribute__((always_inline))
+void pci_write_config8(struct device *dev, unsigned int where, u8 val)
+{
+	write8(PCI_DIRECT_ADDR(dev, where, 0), val);
+}
+
+static inline __attribute__((always_inline))
+void pci_write_config16(struct device *dev, unsigned int where, u16 val)
+{
+	write16(PCI_DIRECT_ADDR(dev, where, 1), val);
+}
+
+static inline __attribute__((always_inline))
+void pci_write_config32(struct device *dev, unsigned int where, u32 val)
+{
+	write32(PCI_DIRECT_ADDR(dev, where, 3), val);
+}
+#else
 u8 pci_read_config8(struct device *dev, unsigned int where);
 u16 pci_read_config16(struct device *dev, unsigned int where);
 u32 pci_read_config32(struct device *dev, unsigned int where);
@@ -13,6 +58,15 @@ void pci_write_config8(struct device *dev, unsigned int where, u8 val);
 void pci_write_config16(struct device *dev, unsigned int where, u16 val);
 void pci_write_config32(struct device *dev, unsigned int where, u32 val);
 
+#if IS_ENABLED(CONFIG_PCI_CONFIG_CACHE)
+/* pci_cfg_valid bit for dev->pci_cap_pos[] */
+#define PCI_CFG_CAPS_VALID	(1 << 7)
+
+/* Drop the shadow registers if dev was moved to another bus/devfn. */
+void pci_cfg_cache_sync(struct device *dev);
+#endif
+#endif
+
 #endif
 
 /*
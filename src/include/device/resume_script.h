@@ -0,0 +1,55 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef DEVICE_RESUME_SCRIPT_H
+#define DEVICE_RESUME_SCRIPT_H
+
+#include <arch/io.h>
+#include <reg_record.h>
+#include <stdint.h>
+
+/*
+ * With S3_MINIMAL_RESUME, a normal boot records the register writes that
+ * bring the devices into their configured state with reg_record. On S3
+ * resume they are replayed instead of enumerating, allocating and
+ * initializing the device tree again. The PCI resource assignment and
+ * all reg_script writes during device init are recorded automatically.
+ * Drivers record whatever else their init leaves behind in the hardware
+ * through the helpers below, which do the access and record it in one go.
+ */
+
+/* Returns 0 if a complete recording was found and replayed. */
+int resume_script_replay(void);
+
+/* Whether the device phases of this boot are replaced by the replay. */
+int resume_script_minimal_resume(void);
+
+/*
+ * Everything the recorded writes can't bring back, e.g. CPU and SMM
+ * setup, has to be redone by the SoC. Called after the replay.
+ */
+void soc_minimal_resume(void);
+
+static inline void resume_script_write32(uintptr_t addr, uint32_t value)
+{
+	write32((void *)addr, value);
+	reg_record_write(REG_RECORD_MMIO, REG_RECORD_SIZE_32, addr, value);
+}
+
+static inline void resume_script_outl(uint16_t port, uint32_t value)
+{
+	outl(value, port);
+	reg_record_write(REG_RECORD_IO, REG_RECORD_SIZE_32, port, value);
+}
+
+#endif /* DEVICE_RESUME_SCRIPT_H */
@@ -111,6 +111,32 @@ int fdt_node_name(void *blob, uint32_t offset, const char **name);
 void fdt_print_node(void *blob, uint32_t offset);
 int fdt_skip_node(void *blob, uint32_t offset);
 
+// Copy a version 17 tree into a buffer of size bytes, with whatever the tree
+// doesn't use as room to edit it in place with the functions below. Node and
+// property offsets are invalidated by any edit in front of them. The ones
+// returning an int return 0 on success, others return 0 if there's no node.
+int fdt_open_into(const void *blob, void *buf, uint32_t size);
+// Shrink totalsize to what the tree uses, once it is done.
+void fdt_pack(void *blob);
+// Walk the children of a node, returning 0 past the last one.
+uint32_t fdt_first_child(void *blob, uint32_t node);
+uint32_t fdt_next_sibling(void *blob, uint32_t node);
+// Look up a child node by the first len characters of name.
+uint32_t fdt_find_node(void *blob, uint32_t parent, const char *name,
+		       uint32_t len);
+// Look up or create a node through its '/' separated path from the root.
+uint32_t fdt_find_node_by_path(void *blob, const char *path, int create);
+uint32_t fdt_add_node(void *blob, uint32_t parent, const char *name);
+void fdt_delete_node(void *blob, uint32_t node);
+// Look up a property, returning its offset and filling in prop if found.
+uint32_t fdt_find_prop(void *blob, uint32_t node, const char *name,
+		       struct fdt_property *prop);
+// Add a property or replace the value of an existing one.
+int fdt_set_prop(void *blob, uint32_t node, const char *name,
+		 const void *data, uint32_t size);
+int fdt_set_u32_prop(void *blob, uint32_t node, const char *name, u32 val);
+int fdt_add_reserve_map_entry(void *blob, uint64_t start, uint64_t size);
+
 // Read a flattened device tree into a heirarchical structure which refers to
 // the contents of the flattened tree in place. Modifying the flat tree
 // invalidates the unflattened one.
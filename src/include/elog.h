@@ -193,6 +193,8 @@ struct elog_event_data_me_extended {
 #define  ELOG_MEM_CACHE_UPDATE_SLOT_NORMAL    0
 #define  ELOG_MEM_CACHE_UPDATE_SLOT_RECOVERY  1
 #define  ELOG_MEM_CACHE_UPDATE_SLOT_VARIABLE  2
+#define  ELOG_MEM_CACHE_UPDATE_SLOT_SPD       3
+#define  ELOG_MEM_CACHE_UPDATE_SLOT_IPMI_FRU  4
 #define  ELOG_MEM_CACHE_UPDATE_STATUS_SUCCESS 0
 #define  ELOG_MEM_CACHE_UPDATE_STATUS_FAIL    1
 struct elog_event_mem_cache_update {
@@ -219,6 +221,25 @@ struct elog_event_mem_cache_update {
 #define ELOG_TYPE_S0IX_ENTER              0xaf
 #define ELOG_TYPE_S0IX_EXIT               0xb0
 
+/* A boot phase took longer than its timestamp budget */
+#define ELOG_TYPE_BOOT_PHASE_OVERRUN      0xb1
+struct elog_event_data_phase_overrun {
+	u32 start_id;
+	u32 end_id;
+	u32 usecs;
+	u32 budget_usecs;
+} __packed;
+
+/* The memory test found a bad address */
+#define ELOG_TYPE_MEM_TEST_FAIL           0xb2
+struct elog_event_data_mem_test {
+	u64 address;
+	u64 expected;
+	u64 actual;
+	u8 channel;	/* 0xff if the DIMM is unknown */
+	u8 dimm;	/* 0xff if the DIMM is unknown */
+} __packed;
+
 #if IS_ENABLED(CONFIG_ELOG)
 /* Eventlog backing storage must be initialized before calling elog_init(). */
 extern int elog_init(void);
@@ -231,6 +252,8 @@ extern int elog_add_event_word(u8 event_type, u16 data);
 extern int elog_add_event_dword(u8 event_type, u32 data);
 extern int elog_add_event_wake(u8 source, u32 instance);
 extern int elog_smbios_write_type15(unsigned long *current, int handle);
+/* Write events held back by CONFIG_ELOG_DEFER_NV_WRITES to flash. */
+extern int elog_flush(void);
 #else
 /* Stubs to help avoid littering sources with #if CONFIG_ELOG */
 static inline int elog_init(void) { return -1; }
@@ -246,6 +269,7 @@ static inline int elog_smbios_write_type15(unsigned long *current,
 						int handle) {
 	return 0;
 }
+static inline int elog_flush(void) { return 0; }
 #endif
 
 extern u32 gsmi_exec(u8 command, u32 *param);
@@ -27,9 +27,15 @@
 struct fit_image_node
 {
 	const char *name;
+	/* NULL for images with external data, which sit at offset. */
 	void *data;
+	size_t offset;
 	uint32_t size;
 	int compression;
+	/* Digest of the stored image, hash_size is 0 if there is none. */
+	const char *hash_algo;
+	const void *hash;
+	uint32_t hash_size;
 
 	struct list_node list_node;
 };
@@ -69,6 +75,16 @@ void fit_add_compat_string(const char *str);
  */
 void fit_update_memory(struct device_tree *tree);
 
+/*
+ * fit_update_chosen(), fit_update_memory() and fit_add_ramdisk() for a flat
+ * devicetree opened with fdt_open_into(), for when no fixups need the
+ * unflattened tree. They return 0 on success, non-zero when the tree ran out
+ * of room.
+ */
+int fit_update_chosen_flat(void *blob, const char *cmd_line);
+int fit_update_memory_flat(void *blob);
+int fit_add_ramdisk_flat(void *blob, void *ramdisk_addr, size_t ramdisk_size);
+
 /*
  * Do architecture specific payload placements and fixups.
  * Set entrypoint and first argument (if any).
@@ -89,9 +105,19 @@ bool fit_payload_arch(struct prog *payload, struct fit_config_node *config,
 /*
  * Unpack a FIT image into memory, choosing the right configuration through the
  * compatible string set by fit_add_compat() and return the selected config
- * node.
+ * node. The structure has to be mapped at fit, image data outside of it is
+ * read from rdev. Only devicetrees are read this early, the other images
+ * stay where they are.
+ */
+struct fit_config_node *fit_load(void *fit, const struct region_device *rdev);
+
+/*
+ * Decompress up to size bytes from the start of image node into buf, to
+ * peek at headers. Returns the size decompressed, errors can't be told
+ * apart from short images.
  */
-struct fit_config_node *fit_load(void *fit);
+size_t fit_image_head(const struct fit_image_node *node, void *buf,
+		      size_t size);
 
 void fit_add_ramdisk(struct device_tree *tree, void *ramdisk_addr,
 		     size_t ramdisk_size);
@@ -104,14 +104,14 @@ int imd_lockdown(struct imd *imd);
 int imd_region_used(struct imd *imd, void **base, size_t *size);
 
 /* Add an entry to the imd. If id already exists NULL is returned. */
-const struct imd_entry *imd_entry_add(const struct imd *imd, uint32_t id,
+const struct imd_entry *imd_entry_add(struct imd *imd, uint32_t id,
 					size_t size);
 
 /* Locate an entry within the imd. NULL is returned when not found. */
-const struct imd_entry *imd_entry_find(const struct imd *imd, uint32_t id);
+const struct imd_entry *imd_entry_find(struct imd *imd, uint32_t id);
 
 /* Find an existing entry or add a new one. */
-const struct imd_entry *imd_entry_find_or_add(const struct imd *imd,
+const struct imd_entry *imd_entry_find_or_add(struct imd *imd,
 						uint32_t id, size_t size);
 
 /* Returns size of entry or 0 on failure. */
@@ -124,7 +124,7 @@ void *imd_entry_at(const struct imd *imd, const struct imd_entry *entry);
 uint32_t imd_entry_id(const struct imd *imd, const struct imd_entry *entry);
 
 /* Attempt to remove entry from imd. */
-int imd_entry_remove(const struct imd *imd, const struct imd_entry *entry);
+int imd_entry_remove(struct imd *imd, const struct imd_entry *entry);
 
 /* Print the entry information provided by lookup with the specified size. */
 struct imd_lookup {
@@ -153,9 +153,13 @@ struct imdr {
 	uintptr_t limit;
 	void *r;
 };
+#define IMD_CACHE_BITS	4
+
 struct imd {
 	struct imdr lg;
 	struct imdr sm;
+	/* Last entry found per id hash, validated on every use. */
+	const struct imd_entry *cache[1 << IMD_CACHE_BITS];
 };
 
 struct imd_cursor {
@@ -23,6 +23,18 @@
 /* Defined in src/lib/lzma.c. Returns decompressed size or 0 on error. */
 size_t ulzman(const void *src, size_t srcn, void *dst, size_t dstn);
 
+struct region_device;
+/* Same as ulzman() but streams the srcn bytes of input at offset of rdev in
+ * small chunks instead of requiring all of it to be mapped. */
+size_t ulzman_rdev(const struct region_device *rdev, size_t offset,
+		   size_t srcn, void *dst, size_t dstn);
+
+#define ULZMAN_SCRATCH_SIZE 15980
+/* Same as ulzman() but keeps the decoder state in the ULZMAN_SCRATCH_SIZE
+ * bytes at scratch, so that several CPUs can decompress at the same time. */
+size_t ulzman_scratch(const void *src, size_t srcn, void *dst, size_t dstn,
+		      void *scratch);
+
 /* Defined in src/lib/ramtest.c */
 void ram_check(unsigned long start, unsigned long stop);
 int ram_check_nodie(unsigned long start, unsigned long stop);
@@ -34,6 +46,8 @@ int primitive_memtest(uintptr_t base, uintptr_t size);
 
 /* Defined in src/lib/stack.c */
 int checkstack(void *top_of_stack, int core);
+/* Bytes of the painted stack at stack, of size bytes, that were ever used. */
+size_t stack_used(const void *stack, size_t size);
 
 /*
  * Defined in src/lib/hexdump.c
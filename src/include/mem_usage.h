@@ -0,0 +1,34 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef MEM_USAGE_H
+#define MEM_USAGE_H
+
+#include <commonlib/mem_usage_serialized.h>
+#include <rules.h>
+#include <stddef.h>
+
+/*
+ * Record the high-water mark of a memory region into the CBMEM table
+ * "cbmem -u" prints. A second entry of the same kind and CPU in the same
+ * stage replaces the first one. CBMEM has to be up already.
+ */
+#if IS_ENABLED(CONFIG_MEM_USAGE) && (ENV_ROMSTAGE || ENV_RAMSTAGE)
+void mem_usage_add(enum mem_usage_kind kind, unsigned int cpu, size_t used,
+		   size_t size);
+#else
+static inline void mem_usage_add(enum mem_usage_kind kind, unsigned int cpu,
+				 size_t used, size_t size) {}
+#endif
+
+#endif /* MEM_USAGE_H */
@@ -23,6 +23,8 @@
 enum {
 	MRC_TRAINING_DATA,
 	MRC_VARIABLE_DATA,
+	MRC_SPD_DATA,
+	MRC_IPMI_FRU_DATA,
 };
 
 /*
@@ -41,4 +43,22 @@ int mrc_cache_get_current(int type, uint32_t version,
 int mrc_cache_stash_data(int type, uint32_t version, const void *data,
 			size_t size);
 
+/*
+ * Stash data that is built in place: mrc_cache_stash_reserve() returns a
+ * buffer of size bytes in cbmem, or NULL on error. Once the caller has
+ * filled it in, mrc_cache_stash_commit() seals it for saving. This spares
+ * callers with little memory a copy of the data of their own.
+ */
+void *mrc_cache_stash_reserve(int type, uint32_t version, size_t size);
+int mrc_cache_stash_commit(int type);
+
+/*
+ * Fold the SPDs of the installed DIMMs into version, so that training data
+ * is only used with the memory it was trained on. spd[i] is NULL for empty
+ * slots. With CONFIG_MRC_CACHE_MULTIPLE_CONFIGS the data of several memory
+ * configurations is kept side by side.
+ */
+uint32_t mrc_cache_spd_version(uint32_t version, const uint8_t *const spd[],
+				size_t num, size_t spd_size);
+
 #endif /* _COMMON_MRC_CACHE_H_ */
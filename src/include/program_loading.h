@@ -24,6 +24,10 @@ enum {
 	/* Last segment of program. Can be used to take different actions for
 	 * cache maintenance of a program load. */
 	SEG_FINAL = 1 << 0,
+	/* The program is only run by the CPU loading it, with caches and MMU
+	 * as they are. Architectures may then skip writing the data back to
+	 * memory and only make it visible to instruction fetches. */
+	SEG_CPU_LOCAL = 1 << 1,
 };
 
 enum prog_type {
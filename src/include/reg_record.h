@@ -0,0 +1,75 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef REG_RECORD_H
+#define REG_RECORD_H
+
+#include <rules.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Records the effective register writes made while recording is on, so
+ * they can be applied again later without running the code that made
+ * them. reg_script writes are recorded by themselves, other code calls
+ * reg_record_write() next to its own access.
+ *
+ * The log is a sequence of 32-bit words. Each record starts with a header
+ * word, followed by the address and the values:
+ *
+ *	[31:8] number of values	[7:4] REG_RECORD_SIZE_*	[3:0] REG_RECORD_*
+ *
+ * A record of n values writes them to n consecutive registers of its
+ * size, starting at the address. Values take one word each, 64-bit ones
+ * two, low word first. PCI config writes are logged as MMIO to MMCONF.
+ */
+enum {
+	REG_RECORD_MMIO = 1,
+	REG_RECORD_IO = 2,
+	REG_RECORD_MSR = 3,
+};
+
+enum {
+	REG_RECORD_SIZE_8,
+	REG_RECORD_SIZE_16,
+	REG_RECORD_SIZE_32,
+	REG_RECORD_SIZE_64,
+};
+
+#define REG_RECORD_SIGNATURE	0x43455252	/* 'RREC' */
+
+struct reg_record_log {
+	uint32_t signature;
+	uint32_t capacity;	/* in words */
+	uint32_t used;		/* in words */
+	/* Set when a write couldn't be logged, the log must not be used. */
+	uint32_t incomplete;
+	uint32_t words[0];
+};
+
+#if IS_ENABLED(CONFIG_REG_RECORD) && ENV_RAMSTAGE
+/* Start recording into a new CBMEM entry of the given size. */
+struct reg_record_log *reg_record_start(uint32_t cbmem_id, size_t size);
+void reg_record_stop(void);
+void reg_record_write(int type, int size, uint32_t addr, uint64_t value);
+/* Marks the running log incomplete, for writes that can't be logged. */
+void reg_record_unrecordable(void);
+/* Returns 0 once all writes of a complete log have been applied. */
+int reg_record_replay(const struct reg_record_log *log);
+#else
+static inline void reg_record_write(int type, int size, uint32_t addr,
+				    uint64_t value) {}
+static inline void reg_record_unrecordable(void) {}
+#endif
+
+#endif /* REG_RECORD_H */
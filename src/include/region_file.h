@@ -37,16 +37,43 @@ struct region_file;
  */
 int region_file_init(struct region_file *f, const struct region_device *p);
 
+/*
+ * Same as region_file_init(), but the state found is kept under name. Opening
+ * the file with that name again, in this or a later stage, then needs no
+ * flash access. All updates of the file have to be made through handles of
+ * the same name to keep that state right.
+ */
+int region_file_init_named(struct region_file *f, const struct region_device *p,
+				const char *name);
+
 /*
  * Initialize region device object associated with latest update of file data.
  * Returns < 0 on error, 0 on success.
  */
 int region_file_data(const struct region_file *f, struct region_device *rdev);
 
+/*
+ * Same as region_file_data() but for the data written age updates before the
+ * latest one, which stays around until the region has to be emptied.
+ * Returns < 0 on error or when there is no such update, 0 on success.
+ */
+int region_file_data_prev(const struct region_file *f, size_t age,
+				struct region_device *rdev);
+
 /* Update region file with latest data. Returns < 0 on error, 0 on success. */
 int region_file_update_data(struct region_file *f, const void *buf,
 				size_t size);
 
+/*
+ * Overwrite the latest data in place with data of the same size, erasing and
+ * rewriting only the erase_size sized sectors which differ. scratch has to
+ * hold erase_size bytes. A power loss while patching leaves a mix of old and
+ * new data behind, so the data needs to carry its own checksum. Returns < 0
+ * on error, the number of sectors rewritten on success.
+ */
+int region_file_patch_data(struct region_file *f, const void *buf,
+				size_t size, void *scratch, size_t erase_size);
+
 /* Declared here for easy object allocation. */
 struct region_file {
 	/* Region device covering file */
@@ -57,6 +84,8 @@ struct region_file {
 	uint16_t data_blocks[2];
 	/* Current slot in metadata marking end of data. */
 	int slot;
+	/* Entry + 1 of the named state cache, 0 for none. */
+	int cache_entry;
 };
 
 #endif /* REGION_FILE_H */
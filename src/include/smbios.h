@@ -23,6 +23,11 @@
 
 unsigned long smbios_write_tables(unsigned long start);
 int smbios_add_string(u8 *start, const char *str);
+/* Structures kept across boots, see SMBIOS_CACHE. */
+int smbios_cache_restore(void *tables, int *len, int *max_struct_size,
+			 int *struct_count);
+void smbios_cache_save(void *tables, int len, int max_struct_size,
+		       int struct_count);
 int smbios_string_table_len(u8 *start);
 
 /* Used by mainboard to add an on-board device */
@@ -53,6 +53,9 @@ void print_spd_info(uint8_t spd[]);
 /* Return 0 on success & -1 on failure */
 int get_spd_cbfs_rdev(struct region_device *spd_rdev, u8 spd_index);
 void dump_spd_info(struct spd_block *blk);
+/* The DIMMs are only read once, later calls return the same SPDs. With
+   CONFIG_SPD_CACHE only a few bytes of each DIMM are read while the SPDs
+   cached on flash are still good. */
 void get_spd_smbus(struct spd_block *blk);
 
 /* expects SPD size to be 128 bytes, reads from "spd.bin" in CBFS and
@@ -51,6 +51,10 @@ enum spi_op_status {
  * bytesout:	Count of data in bytes to send.
  * din:	Pointer to store received data.
  * bytesin:	Count of data in bytes to receive.
+ * width:	Number of data lines used by the op: 0 or 1 for regular SPI,
+ *		2 for dual and 4 for quad I/O. Only controllers advertising the
+ *		matching SPI_CNTRLR_{TX,RX}_{DUAL,QUAD} flag are passed ops
+ *		wider than one line, and they must handle them in xfer_vector.
  */
 struct spi_op {
 	const void *dout;
@@ -58,6 +62,7 @@ struct spi_op {
 	void *din;
 	size_t bytesin;
 	enum spi_op_status status;
+	unsigned int width;
 };
 
 enum spi_clock_phase {
@@ -106,6 +111,13 @@ enum {
 	   register for the command byte would set this flag which would
 	   allow the use of the maximum transfer size. */
 	SPI_CNTRLR_DEDUCT_OPCODE_LEN = 1 << 1,
+	/* The controller can send (TX) or receive (RX) an op on two or four
+	   data lines. The SPI flash layer uses these to pick the widest
+	   read command both the controller and the flash part support. */
+	SPI_CNTRLR_TX_DUAL = 1 << 2,
+	SPI_CNTRLR_TX_QUAD = 1 << 3,
+	SPI_CNTRLR_RX_DUAL = 1 << 4,
+	SPI_CNTRLR_RX_QUAD = 1 << 5,
 };
 
 /*-----------------------------------------------------------------------
@@ -119,6 +131,10 @@ enum {
  * setup:		Setup given SPI device bus.
  * xfer:		Perform one SPI transfer operation.
  * xfer_vector:	Vector of SPI transfer operations.
+ * xfer_start:	Kick off one SPI transfer operation without waiting for it
+ *		to complete. Optional; must be paired with xfer_poll.
+ * xfer_poll:	Make progress on the transfer started with xfer_start.
+ *		Returns SPI_XFER_IN_PROGRESS while it is still running.
  * max_xfer_size:	Maximum transfer size supported by the controller
  *			(0 = invalid,
  *			 SPI_CTRLR_DEFAULT_MAX_XFER_SIZE = unlimited)
@@ -139,6 +155,9 @@ struct spi_ctrlr {
 		    size_t bytesout, void *din, size_t bytesin);
 	int (*xfer_vector)(const struct spi_slave *slave,
 			struct spi_op vectors[], size_t count);
+	int (*xfer_start)(const struct spi_slave *slave, const void *dout,
+			  size_t bytesout, void *din, size_t bytesin);
+	int (*xfer_poll)(const struct spi_slave *slave);
 	uint32_t max_xfer_size;
 	uint32_t flags;
 	int (*flash_probe)(const struct spi_slave *slave,
@@ -257,6 +276,31 @@ int spi_xfer(const struct spi_slave *slave, const void *dout, size_t bytesout,
 int spi_xfer_vector(const struct spi_slave *slave,
 		struct spi_op vectors[], size_t count);
 
+/* Returned by spi_xfer_poll() while the transfer has not finished yet. */
+#define SPI_XFER_IN_PROGRESS	1
+
+/*-----------------------------------------------------------------------
+ * Asynchronous SPI transfer
+ *
+ * spi_xfer_start() takes the same arguments as spi_xfer() but returns as
+ * soon as the controller has been set up, leaving the transfer running
+ * (usually by DMA) in the background. spi_xfer_poll() must then be called
+ * until it stops returning SPI_XFER_IN_PROGRESS; controllers that move data
+ * through a FIFO by hand do so from spi_xfer_poll(), so call it often.
+ * Neither the buffers nor the bus may be touched in the meantime, and only
+ * one transfer can be in flight per bus.
+ *
+ * Controllers without asynchronous support complete the whole transfer in
+ * spi_xfer_start().
+ *
+ *   Returns: spi_xfer_start(): 0 on success, not 0 on failure
+ *	      spi_xfer_poll(): 0 once the transfer completed successfully,
+ *	      SPI_XFER_IN_PROGRESS while it is running, <0 on failure
+ */
+int spi_xfer_start(const struct spi_slave *slave, const void *dout,
+		   size_t bytesout, void *din, size_t bytesin);
+int spi_xfer_poll(const struct spi_slave *slave);
+
 /*-----------------------------------------------------------------------
  * Given command length and length of remaining data, return the maximum data
  * that can be transferred in next spi_xfer.
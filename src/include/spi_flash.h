@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include <spi-generic.h>
 #include <boot/coreboot_tables.h>
+#include <bootstate.h>
 
 /* SPI Flash opcodes */
 #define SPI_OPCODE_WREN 0x06
@@ -42,6 +43,32 @@ struct spi_flash_ops {
 	int (*status)(const struct spi_flash *flash, u8 *reg);
 };
 
+/*
+ * Read command used by spi_flash_cmd_read_fast():
+ * opcode:	Read command opcode.
+ * addr_width:	Number of data lines for the address, mode and dummy bytes.
+ * data_width:	Number of data lines for the data read back.
+ * dummy_bytes:	Number of mode and dummy bytes following the address.
+ */
+struct spi_flash_read_cmd {
+	u8 opcode;
+	u8 addr_width;
+	u8 data_width;
+	u8 dummy_bytes;
+};
+
+/*
+ * Erase command of the flash part:
+ * opcode:	Erase command opcode.
+ * shift:	log2 of the erase size, 0 if the entry is unused.
+ */
+struct spi_flash_erase_type {
+	u8 opcode;
+	u8 shift;
+};
+
+#define SPI_FLASH_ERASE_TYPES	4
+
 struct spi_flash {
 	struct spi_slave spi;
 	const char *name;
@@ -50,9 +77,69 @@ struct spi_flash {
 	u32 page_size;
 	u8 erase_cmd;
 	u8 status_cmd;
+	/* Program and erase suspend and resume opcodes, 0 if unsupported. */
+	u8 suspend_cmd;
+	u8 resume_cmd;
+	struct spi_flash_read_cmd read_cmd;
+	/* Additional erase sizes, used by spi_flash_cmd_erase() when set. */
+	struct spi_flash_erase_type erase_types[SPI_FLASH_ERASE_TYPES];
 	const struct spi_flash_ops *ops;
 };
 
+/*
+ * Fast read command described by SFDP. dummy_clocks includes the mode clocks
+ * and is counted on addr_width lines. opcode is 0 if unsupported.
+ */
+struct sfdp_read_mode {
+	u8 opcode;
+	u8 addr_width;
+	u8 data_width;
+	u8 dummy_clocks;
+};
+
+/* 1-4-4, 1-1-4, 1-2-2 and 1-1-2, in this order. */
+#define SFDP_READ_MODES		4
+
+enum sfdp_addr_mode {
+	SFDP_ADDR_3B = 0,
+	SFDP_ADDR_3B_OR_4B = 1,
+	SFDP_ADDR_4B = 2,
+};
+
+/* Quad enable requirement of DWORD 15, if the table is too old for it. */
+#define SFDP_QER_UNKNOWN	0xff
+
+/*
+ * Parameters decoded from the JEDEC basic flash parameter table:
+ * size:	Size in bytes.
+ * page_size:	Page program size in bytes.
+ * addr_mode:	Supported address lengths, see enum sfdp_addr_mode.
+ * quad_enable:	Quad enable requirement (QER) of the part.
+ * suspend_cmd:	Program and erase suspend opcode, 0 if unsupported.
+ * resume_cmd:	Program and erase resume opcode.
+ * erase:	Erase types, unused entries are zero.
+ * read_modes:	Multi I/O fast read commands, widest first.
+ */
+struct sfdp_params {
+	u32 size;
+	u32 page_size;
+	u8 addr_mode;
+	u8 quad_enable;
+	u8 suspend_cmd;
+	u8 resume_cmd;
+	struct spi_flash_erase_type erase[SPI_FLASH_ERASE_TYPES];
+	struct sfdp_read_mode read_modes[SFDP_READ_MODES];
+};
+
+/*
+ * Decode the basic flash parameter table (the first SFDP parameter table),
+ * given as dwords DWORDs in CPU byte order.
+ *
+ * Returns 0 on success, < 0 if the table is unusable.
+ */
+int sfdp_parse_bfpt(const u32 *bfpt, size_t dwords,
+			struct sfdp_params *params);
+
 void lb_spi_flash(struct lb_header *header);
 
 /* SPI Flash Driver Public API */
@@ -91,6 +178,32 @@ int spi_flash_read(const struct spi_flash *flash, u32 offset, size_t len,
 		   void *buf);
 int spi_flash_write(const struct spi_flash *flash, u32 offset, size_t len,
 		    const void *buf);
+
+/*
+ * Asynchronous read. spi_flash_read_start() starts reading len bytes at
+ * offset into buf and returns. spi_flash_read_poll() moves the read along,
+ * chunk by chunk, and returns SPI_XFER_IN_PROGRESS until it is done, then
+ * 0, or < 0 on error. The bus is only held while a chunk is in flight.
+ * spi_flash_read_pause() waits for that chunk without starting the next,
+ * so other flash operations may run before the next poll. Parts read with
+ * multi I/O commands and controllers without asynchronous transfers
+ * complete the read in spi_flash_read_start().
+ */
+struct spi_flash_async_read {
+	const struct spi_flash *flash;
+	u8 cmd[5];
+	size_t cmd_len;
+	u32 offset;
+	size_t len;
+	u8 *buf;
+	size_t chunk;	/* Bytes in flight, 0 between chunks. */
+};
+
+int spi_flash_read_start(struct spi_flash_async_read *rd,
+			 const struct spi_flash *flash, u32 offset, size_t len,
+			 void *buf);
+int spi_flash_read_poll(struct spi_flash_async_read *rd);
+int spi_flash_read_pause(struct spi_flash_async_read *rd);
 int spi_flash_erase(const struct spi_flash *flash, u32 offset, size_t len);
 int spi_flash_status(const struct spi_flash *flash, u8 *reg);
 /*
@@ -116,6 +229,16 @@ int spi_flash_volatile_group_end(const struct spi_flash *flash);
 int chipset_volatile_group_begin(const struct spi_flash *flash);
 int chipset_volatile_group_end(const struct spi_flash *flash);
 
+/*
+ * Run func(arg), which programs or erases SPI flash, in a ramstage thread of
+ * its own when SPI_FLASH_BACKGROUND_WRITES is enabled, else right away. The
+ * boot state (state, seq) is held off until it returns. While the thread
+ * waits for a program or erase to complete other threads run, and their
+ * spi_flash_read() calls suspend the operation or wait for it.
+ */
+void spi_flash_run_in_background(void (*func)(void *), void *arg,
+				 boot_state_t state, boot_state_sequence_t seq);
+
 /* Return spi_flash object reference for the boot device. This is only valid
  * if CONFIG_BOOT_DEVICE_SPI_FLASH is enabled. */
 const struct spi_flash *boot_device_spi_flash(void);
@@ -42,12 +42,35 @@ void stage_cache_get_raw(int stage_id, void **base, size_t *size);
 void stage_cache_load_stage(int stage_id, struct prog *stage);
 /* Fill in parameters for the external stage cache, if utilized. */
 void stage_cache_external_region(void **base, size_t *size);
+/* Record the part of a cached stage that changes while it runs. With
+ * STAGE_CACHE_IN_PLACE only that part is restored on resume. */
+void stage_cache_set_writable(int stage_id, const void *start, size_t size);
 
 /* Metadata associated with each stage. */
 struct stage_cache {
 	uint64_t load_addr;
 	uint64_t entry_addr;
 	uint64_t arg;
+	uint32_t size;		/* of the stage, not of its cached copy */
+	uint32_t checksum;	/* CRC-32 of the stage, when compressed */
+	uint32_t rw_offset;	/* of the part that changes once it runs */
+	uint32_t rw_size;	/* 0 while that part is unknown */
+	uint32_t reserved;
 };
 
+/*
+ * The cached copy of a stage, compressed with STAGE_CACHE_COMPRESS, for the
+ * stage cache implementations: the bytes it takes, filling it in together
+ * with the stage's metadata and restoring the stage to its load address.
+ * Restoring returns < 0 when the copy doesn't pass verification.
+ * stage_cache_data_writable() checks and fills in the writable part.
+ */
+size_t stage_cache_data_size(const struct prog *stage);
+void stage_cache_data_save(void *c, size_t size, const struct prog *stage,
+			   struct stage_cache *meta);
+int stage_cache_data_load(const struct stage_cache *meta, const void *c,
+			  size_t size);
+int stage_cache_data_writable(struct stage_cache *meta, const void *start,
+			      size_t size);
+
 #endif /* _STAGE_CACHE_H_ */
@@ -1,6 +1,7 @@
 #ifndef STDLIB_H
 #define STDLIB_H
 
+#include <rules.h>
 #include <stddef.h>
 
 #define min(a, b) MIN((a), (b))
@@ -8,8 +9,15 @@
 
 void *memalign(size_t boundary, size_t size);
 void *malloc(size_t size);
+/* The size of the heap and the most of it in use so far, in bytes. */
+void malloc_usage(size_t *peak, size_t *size);
+#if IS_ENABLED(CONFIG_HEAP_FREE) && \
+	(ENV_RAMSTAGE || (ENV_SMM && IS_ENABLED(CONFIG_SMM_TSEG)))
+void free(void *ptr);
+#else
 /* We never free memory */
 static inline void free(void *ptr) {}
+#endif
 
 #ifndef __ROMCC__
 static inline unsigned long div_round_up(unsigned int n, unsigned int d)
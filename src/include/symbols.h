@@ -66,6 +66,10 @@ extern u8 _program[];
 extern u8 _eprogram[];
 #define _program_size (_eprogram - _program)
 
+/* Where the writable part of the current stage starts. */
+extern u8 _data[];
+extern u8 _edata[];
+
 /* _<stage>_size is always the maximum amount allocated in memlayout, whereas
  * _program_size gives the actual memory footprint *used* by current stage. */
 extern u8 _decompressor[];
@@ -21,16 +21,55 @@
 #include <timer.h>
 #include <arch/cpu.h>
 
+struct thread;
+
+/* Threads blocked until someone wakes them up. */
+struct thread_waitq {
+	struct thread *waiters;
+};
+
+/* Tracks a thread started by thread_run() so it can be joined. */
+struct thread_handle {
+	enum {
+		THREAD_INIT = 0,
+		THREAD_STARTED,
+		THREAD_DONE,
+	} state;
+	struct thread_waitq joiners;
+};
+
+/* A counting semaphore threads can block on. */
+struct thread_sem {
+	int count;
+	struct thread_waitq waitq;
+};
+
+/*
+ * Runnable threads of higher priority always run before those of lower
+ * priority once the running thread yields. Threads are never preempted.
+ */
+#define THREAD_PRIORITY_IDLE	(-1)
+#define THREAD_PRIORITY_NORMAL	0
+#define THREAD_PRIORITY_HIGH	1
+
+static inline void thread_sem_init(struct thread_sem *sem, int count)
+{
+	sem->count = count;
+	sem->waitq.waiters = NULL;
+}
+
 #if IS_ENABLED(CONFIG_COOP_MULTITASKING) && !defined(__SMM__) && !defined(__PRE_RAM__)
 
 struct thread {
 	int id;
+	int priority;
 	uintptr_t stack_current;
 	uintptr_t stack_orig;
 	struct thread *next;
 	void (*entry)(void *);
 	void *entry_arg;
 	int can_yield;
+	struct thread_handle *handle;
 };
 
 void threads_initialize(void);
@@ -39,10 +78,10 @@ void threads_initialize(void);
  * aligned to CONFIG_STACK_SIZE, or NULL.
  */
 void *arch_get_thread_stackbase(void);
-/* Run func(arrg) on a new thread. Return 0 on successful start of thread, < 0
- * when thread could not be started. Note that the thread will block the
- * current state in the boot state machine until it is complete. */
-int thread_run(void (*func)(void *), void *arg);
+/* Start func(arg) in a new thread. The handle, if not NULL, can be passed to
+ * thread_join() later on. The current boot state phase does not complete
+ * until the thread returns. Returns 0 on success, < 0 on error. */
+int thread_run(struct thread_handle *handle, void (*func)(void *), void *arg);
 /* thread_run_until is the same as thread_run() except that it blocks state
  * transitions from occurring in the (state, seq) pair of the boot state
  * machine. */
@@ -52,10 +91,28 @@ int thread_run_until(void (*func)(void *), void *arg,
  * did not yield. */
 int thread_yield_microseconds(unsigned int microsecs);
 
+/* Wait for the thread of handle to return. Returns < 0 if the thread never
+ * started or the current thread can't yield. */
+int thread_join(struct thread_handle *handle);
+
+/* Block the current thread until woken up through waitq. Returns < 0 if the
+ * current thread can't yield. */
+int thread_wait(struct thread_waitq *waitq);
+/* Make all threads waiting on waitq runnable again. Returns how many. */
+int thread_wake_all(struct thread_waitq *waitq);
+
+/* Take one count of sem, waiting for it if needed. Returns < 0 if it had to
+ * wait but the current thread can't yield. */
+int thread_sem_down(struct thread_sem *sem);
+void thread_sem_up(struct thread_sem *sem);
+
+/* Change the priority of the current thread and return the old one. */
+int thread_set_priority(int priority);
+
 /* Allow and prevent thread cooperation on current running thread. By default
  * all threads are marked to be cooperative. That means a thread can yield
- * to another thread at a pre-determined switch point. Current there is
- * only a single place where switching may occur: a call to udelay(). */
+ * to another thread at a pre-determined switch point: a call to udelay(),
+ * or one of the calls above that may block. */
 void thread_cooperate(void);
 void thread_prevent_coop(void);
 
@@ -73,11 +130,48 @@ void arch_prepare_thread(struct thread *t,
 			 asmlinkage void (*thread_entry)(void *), void *arg);
 #else
 static inline void threads_initialize(void) {}
-static inline int thread_run(void (*func)(void *), void *arg) { return -1; }
+static inline int thread_run(struct thread_handle *handle,
+			     void (*func)(void *), void *arg)
+{
+	return -1;
+}
+static inline int thread_run_until(void (*func)(void *), void *arg,
+				   boot_state_t state,
+				   boot_state_sequence_t seq)
+{
+	return -1;
+}
 static inline int thread_yield_microseconds(unsigned int microsecs)
 {
 	return -1;
 }
+static inline int thread_join(struct thread_handle *handle)
+{
+	return handle->state == THREAD_DONE ? 0 : -1;
+}
+static inline int thread_wait(struct thread_waitq *waitq)
+{
+	return -1;
+}
+static inline int thread_wake_all(struct thread_waitq *waitq)
+{
+	return 0;
+}
+static inline int thread_sem_down(struct thread_sem *sem)
+{
+	if (sem->count == 0)
+		return -1;
+	sem->count--;
+	return 0;
+}
+static inline void thread_sem_up(struct thread_sem *sem)
+{
+	sem->count++;
+}
+static inline int thread_set_priority(int priority)
+{
+	return THREAD_PRIORITY_NORMAL;
+}
 static inline void thread_cooperate(void) {}
 static inline void thread_prevent_coop(void) {}
 struct cpu_info;
@@ -17,6 +17,7 @@
 #ifndef __TIMESTAMP_H__
 #define __TIMESTAMP_H__
 
+#include <stddef.h>
 #include <commonlib/timestamp_serialized.h>
 
 #if IS_ENABLED(CONFIG_COLLECT_TIMESTAMPS) && (IS_ENABLED(CONFIG_EARLY_CBMEM_INIT) \
@@ -37,6 +38,12 @@ void timestamp_init(uint64_t base);
 void timestamp_add(enum timestamp_id id, uint64_t ts_time);
 /* Calls timestamp_add with current timestamp. */
 void timestamp_add_now(enum timestamp_id id);
+/*
+ * Mark the begin and the end of a span, which may nest. id is either an
+ * enum timestamp_id or a TIMESTAMP_CUSTOM_ID().
+ */
+void timestamp_begin(uint32_t id);
+void timestamp_end(uint32_t id);
 
 /* Apply a factor of N/M to all timestamps recorded so far. */
 void timestamp_rescale_table(uint16_t N, uint16_t M);
@@ -53,6 +60,8 @@ uint32_t get_us_since_boot(void);
 #define timestamp_init(base)
 #define timestamp_add(id, time)
 #define timestamp_add_now(id)
+#define timestamp_begin(id)
+#define timestamp_end(id)
 #define timestamp_rescale_table(N, M)
 #define get_us_since_boot() 0
 #endif
@@ -69,6 +78,22 @@ uint64_t timestamp_get(void);
 #define timestamp_get() 0
 #endif
 
+/*
+ * A limit for the time from the first start timestamp to the first end
+ * timestamp after it. A start of 0 is the base time of the table.
+ */
+struct timestamp_budget {
+	uint32_t start;
+	uint32_t end;
+	uint32_t max_usecs;
+};
+
+/*
+ * With TIMESTAMP_BUDGETS, boards can return count budgets to check on top of
+ * the Kconfig ones.
+ */
+const struct timestamp_budget *mainboard_timestamp_budgets(size_t *count);
+
 uint64_t get_initial_timestamp(void);
 /* Returns timestamp tick frequency in MHz. */
 int timestamp_tick_freq_mhz(void);
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arena.h>
+#include <commonlib/mem_pool.h>
+#include <console/console.h>
+#include <stdlib.h>
+
+static struct mem_pool pool;
+static unsigned int depth;
+
+struct arena_scope arena_begin(void)
+{
+	struct arena_scope scope;
+
+	if (!pool.buf)
+		mem_pool_init(&pool, malloc(CONFIG_ARENA_SIZE),
+			      CONFIG_ARENA_SIZE);
+
+	scope.mark = mem_pool_mark(&pool);
+	scope.depth = depth++;
+
+	return scope;
+}
+
+void *arena_alloc(size_t size)
+{
+	void *p;
+
+	if (!depth) {
+		printk(BIOS_ERR, "%s: no arena scope is open\n", __func__);
+		return NULL;
+	}
+
+	p = mem_pool_alloc(&pool, size);
+	if (!p)
+		printk(BIOS_ERR, "%s: %zu bytes don't fit, %zu of %zu in use\n",
+		       __func__, size, pool.free_offset, pool.size);
+
+	return p;
+}
+
+void arena_release(struct arena_scope scope)
+{
+	if (scope.depth >= depth) {
+		printk(BIOS_ERR, "%s: the scope is not open\n", __func__);
+		return;
+	}
+
+	mem_pool_release(&pool, scope.mark);
+	depth = scope.depth;
+
+	/* Nothing is left to hold on to the buffer. */
+	if (!depth && IS_ENABLED(CONFIG_HEAP_FREE)) {
+		free(pool.buf);
+		pool.buf = NULL;
+	}
+}
@@ -15,6 +15,7 @@
 
 #include <rules.h>
 #include <bootmode.h>
+#include <option.h>
 #include <vendorcode/google/chromeos/chromeos.h>
 
 #if ENV_RAMSTAGE
@@ -35,10 +36,21 @@ void gfx_set_init_done(int done)
 
 int display_init_required(void)
 {
+	u8 display_init;
+
 	/* For Chrome OS always honor vboot_handoff_skip_display_init(). */
 	if (IS_ENABLED(CONFIG_CHROMEOS))
 		return !vboot_handoff_skip_display_init();
 
+	/*
+	 * Headless setups can turn display init off with the display_init
+	 * CMOS option. Among others, this skips running the VGA option ROM,
+	 * which can take seconds when it is emulated.
+	 */
+	if (ENV_RAMSTAGE &&
+	    get_option(&display_init, "display_init") == CB_SUCCESS)
+		return display_init;
+
 	/* By default always initialize display. */
 	return 1;
 }
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bs_times.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <smp/spinlock.h>
+#include <string.h>
+
+#define BS_TIMES_ENTRIES CONFIG_BS_TIMES_ENTRIES
+
+/* Entries go here until CBMEM is up. */
+static struct {
+	struct bs_times_table table;
+	struct bs_times_entry entries[BS_TIMES_ENTRIES];
+} bs_times_cache = {
+	.table = {
+		.max_entries = BS_TIMES_ENTRIES,
+	},
+};
+
+static struct bs_times_table *bs_times = &bs_times_cache.table;
+static int bs_times_dropped;
+
+/* Device inits may run on APs. */
+DECLARE_SPIN_LOCK(bs_times_lock)
+
+void bs_times_stop(const struct mono_time *start, enum bs_times_kind kind,
+		   boot_state_t state, uintptr_t func, const char *name)
+{
+	struct bs_times_entry *e;
+	struct mono_time now;
+
+	timer_monotonic_get(&now);
+
+	spin_lock(&bs_times_lock);
+
+	if (bs_times->num_entries >= bs_times->max_entries) {
+		bs_times_dropped++;
+		spin_unlock(&bs_times_lock);
+		return;
+	}
+
+	e = &bs_times->entries[bs_times->num_entries++];
+	e->func = func;
+	e->start = start->microseconds;
+	e->usecs = mono_time_diff_microseconds(start, &now);
+	e->kind = kind;
+	e->state = state;
+	e->reserved = 0;
+	if (name != NULL) {
+		strncpy(e->name, name, sizeof(e->name) - 1);
+		e->name[sizeof(e->name) - 1] = '\0';
+	} else {
+		e->name[0] = '\0';
+	}
+
+	spin_unlock(&bs_times_lock);
+}
+
+static void bs_times_cbmem_init(int is_recovery)
+{
+	struct bs_times_table *table;
+	size_t size;
+
+	size = sizeof(*table) + BS_TIMES_ENTRIES * sizeof(table->entries[0]);
+	table = cbmem_add(CBMEM_ID_BS_TIMES, size);
+	if (table == NULL) {
+		printk(BIOS_ERR, "BS times: no room in CBMEM\n");
+		return;
+	}
+
+	spin_lock(&bs_times_lock);
+	memcpy(table, &bs_times_cache, sizeof(bs_times_cache));
+	bs_times = table;
+	spin_unlock(&bs_times_lock);
+}
+RAMSTAGE_CBMEM_INIT_HOOK(bs_times_cbmem_init)
+
+static void bs_times_report_dropped(void *unused)
+{
+	if (bs_times_dropped)
+		printk(BIOS_WARNING, "BS times: %d entries did not fit\n",
+		       bs_times_dropped);
+}
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_LOAD, BS_ON_ENTRY, bs_times_report_dropped,
+		      NULL);
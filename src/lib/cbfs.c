@@ -14,11 +14,13 @@
  * GNU General Public License for more details.
  */
 
+#include <arch/early_variables.h>
 #include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <boot_device.h>
 #include <cbfs.h>
+#include <cbmem.h>
 #include <commonlib/compression.h>
 #include <compiler.h>
 #include <endian.h>
@@ -36,12 +38,228 @@
 #define DEBUG(x...)
 #endif
 
-int cbfs_boot_locate(struct cbfsf *fh, const char *name, uint32_t *type)
+/* Return the lookup index for the boot CBFS described by props, building it
+ * on first use. Returns NULL when no index is available. */
+static const struct cbfs_index *cbfs_boot_index(const struct cbfs_props *props,
+						const struct region_device *cbfs)
+{
+	static struct cbfs_index *index;
+	static struct cbfs_props index_props;
+	static int index_failed;
+
+	if (!IS_ENABLED(CONFIG_CBFS_LOOKUP_INDEX) || !ENV_RAMSTAGE)
+		return NULL;
+
+	/* The index is only valid for the CBFS it was built from. */
+	if (index != NULL && index_props.size != 0 &&
+	    index_props.offset == props->offset &&
+	    index_props.size == props->size)
+		return index;
+
+	if (index_failed)
+		return NULL;
+
+	if (index == NULL) {
+		index = malloc(cbfs_index_size(
+				CONFIG_CBFS_LOOKUP_INDEX_ENTRIES));
+		if (index == NULL) {
+			index_failed = 1;
+			return NULL;
+		}
+	}
+
+	/* Whatever was indexed before is gone once the build starts. */
+	index_props.size = 0;
+	index->max_entries = CONFIG_CBFS_LOOKUP_INDEX_ENTRIES;
+
+	if (cbfs_index_build(index, cbfs)) {
+		ERROR("Falling back to linear lookups.\n");
+		free(index);
+		index = NULL;
+		index_failed = 1;
+		return NULL;
+	}
+
+	index_props = *props;
+
+	return index;
+}
+
+/* Lookup index shared with the stages after romstage through CBMEM. */
+struct cbfs_index_cbmem {
+	/* Location of the indexed CBFS on the boot device. A size of 0 marks
+	 * an invalid index. */
+	uint32_t offset;
+	uint32_t size;
+	struct cbfs_index index;
+};
+
+static struct cbfs_index_cbmem *cbfs_index_cbmem CAR_GLOBAL;
+
+static size_t cbfs_index_cbmem_size(void)
+{
+	return offsetof(struct cbfs_index_cbmem, index) +
+		cbfs_index_size(CONFIG_CBFS_LOOKUP_INDEX_ENTRIES);
+}
+
+/* Build the index in CBMEM once romstage brings CBMEM online. It is rebuilt
+ * even when CBMEM is recovered since the CBFS contents or the selected CBFS
+ * region may have changed since the previous boot. */
+static void cbfs_index_cbmem_init(int unused)
+{
+	const struct cbmem_entry *e;
+	struct cbfs_index_cbmem *ic;
+	const struct region_device *boot_dev;
+	struct region_device rdev;
+	struct cbfs_props props;
+
+	if (!IS_ENABLED(CONFIG_CBFS_LOOKUP_INDEX_CBMEM))
+		return;
+
+	e = cbmem_entry_add(CBMEM_ID_CBFS_INDEX, cbfs_index_cbmem_size());
+	if (e == NULL || cbmem_entry_size(e) < cbfs_index_cbmem_size())
+		return;
+
+	ic = cbmem_entry_start(e);
+	ic->size = 0;
+
+	if (cbfs_boot_region_properties(&props))
+		return;
+
+	boot_dev = boot_device_ro();
+
+	if (boot_dev == NULL)
+		return;
+
+	if (rdev_chain(&rdev, boot_dev, props.offset, props.size))
+		return;
+
+	ic->index.max_entries = CONFIG_CBFS_LOOKUP_INDEX_ENTRIES;
+
+	if (cbfs_index_build(&ic->index, &rdev))
+		return;
+
+	ic->offset = props.offset;
+	ic->size = props.size;
+
+	car_set_var(cbfs_index_cbmem, ic);
+}
+ROMSTAGE_CBMEM_INIT_HOOK(cbfs_index_cbmem_init);
+
+/* Return the index left in CBMEM by romstage or NULL if there is none. */
+static const struct cbfs_index_cbmem *cbfs_shared_index(void)
+{
+	struct cbfs_index_cbmem *ic;
+
+	if (!IS_ENABLED(CONFIG_CBFS_LOOKUP_INDEX_CBMEM))
+		return NULL;
+
+	ic = car_get_var(cbfs_index_cbmem);
+
+	/* CBMEM is online for the whole lifetime of these stages. */
+	if (ic == NULL && (ENV_POSTCAR || ENV_RAMSTAGE)) {
+		ic = cbmem_find(CBMEM_ID_CBFS_INDEX);
+		car_set_var(cbfs_index_cbmem, ic);
+	}
+
+	if (ic == NULL || ic->size == 0)
+		return NULL;
+
+	return ic;
+}
+
+/* This only supports the "COREBOOT" fmap region. */
+static int cbfs_master_header_read(struct cbfs_header *header)
+{
+	const struct region_device *bdev;
+	int32_t rel_offset;
+	size_t offset;
+
+	bdev = boot_device_ro();
+
+	if (bdev == NULL)
+		return -1;
+
+	size_t fmap_top = ___FMAP__COREBOOT_BASE + ___FMAP__COREBOOT_SIZE;
+
+	/* Find location of header using signed 32-bit offset from
+	 * end of CBFS region. */
+	offset = fmap_top - sizeof(int32_t);
+	if (rdev_readat(bdev, &rel_offset, offset, sizeof(int32_t)) < 0)
+		return -1;
+
+	offset = fmap_top + rel_offset;
+	if (rdev_readat(bdev, header, offset, sizeof(*header)) < 0)
+		return -1;
+
+	header->magic = ntohl(header->magic);
+	header->romsize = ntohl(header->romsize);
+	header->offset = ntohl(header->offset);
+	header->stage_offset = ntohl(header->stage_offset);
+
+	if (header->magic != CBFS_HEADER_MAGIC)
+		return -1;
+
+	return 0;
+}
+
+/* Check the file cbfstool recorded as the first stage of the bootblock in the
+ * master header before walking the CBFS for name. */
+static int cbfs_boot_stage_hint(const struct cbfs_props *props,
+				const struct region_device *cbfs,
+				struct cbfsf *fh, const char *name,
+				uint32_t *type)
+{
+	struct cbfs_header header;
+
+	if (!ENV_BOOTBLOCK)
+		return -1;
+
+	if (cbfs_master_header_read(&header))
+		return -1;
+
+	/* Another locator may have picked a CBFS without a master header. */
+	if (header.offset != props->offset)
+		return -1;
+
+	if (header.stage_offset < header.offset ||
+	    header.stage_offset >= header.romsize)
+		return -1;
+
+	if (cbfs_locate_at(fh, cbfs, header.stage_offset - header.offset,
+			   name, type))
+		return -1;
+
+	DEBUG("'%s' found through the master header\n", name);
+
+	return 0;
+}
+
+static int cbfs_boot_locate_file(struct cbfsf *fh, const char *name,
+				 uint32_t *type)
 {
 	struct region_device rdev;
 	const struct region_device *boot_dev;
+	const struct cbfs_index_cbmem *ic;
+	const struct cbfs_index *index;
 	struct cbfs_props props;
 
+	/* The shared index also records the CBFS region picked by romstage so
+	 * the CBFS locators don't need to run again. */
+	ic = cbfs_shared_index();
+	if (ic != NULL) {
+		boot_device_init();
+		boot_dev = boot_device_ro();
+
+		if (boot_dev == NULL)
+			return -1;
+
+		if (rdev_chain(&rdev, boot_dev, ic->offset, ic->size))
+			return -1;
+
+		return cbfs_index_locate(&ic->index, fh, &rdev, name, type);
+	}
+
 	if (cbfs_boot_region_properties(&props))
 		return -1;
 
@@ -54,9 +272,63 @@ int cbfs_boot_locate(struct cbfsf *fh, const char *name, uint32_t *type)
 	if (rdev_chain(&rdev, boot_dev, props.offset, props.size))
 		return -1;
 
+	if (!cbfs_boot_stage_hint(&props, &rdev, fh, name, type))
+		return 0;
+
+	index = cbfs_boot_index(&props, &rdev);
+	if (index != NULL)
+		return cbfs_index_locate(index, fh, &rdev, name, type);
+
 	return cbfs_locate(fh, &rdev, name, type);
 }
 
+/* Files are only checked once vboot may have picked an RW CBFS. */
+#define CBFS_VERIFY_FILE_HASHES (IS_ENABLED(CONFIG_VBOOT_CBFS_FILE_HASHES) && \
+				 (ENV_ROMSTAGE || ENV_POSTCAR || ENV_RAMSTAGE))
+
+/*
+ * Boot device offsets of the data of the files verified in this stage. Most
+ * files are looked up again and again, but only need to be hashed once.
+ */
+#define CBFS_VERIFIED_FILES 16
+static size_t cbfs_verified[CBFS_VERIFIED_FILES] CAR_GLOBAL;
+static size_t cbfs_verified_next CAR_GLOBAL;
+
+static int cbfs_boot_verify(struct cbfsf *fh)
+{
+	size_t *verified = car_get_var_ptr(cbfs_verified);
+	size_t offset = region_device_offset(&fh->data);
+	size_t next;
+	int i;
+
+	for (i = 0; i < CBFS_VERIFIED_FILES; i++)
+		if (verified[i] == offset)
+			return 0;
+
+	if (cbfsf_verify_hash(fh) < 0)
+		return -1;
+
+	/* Data never starts at offset 0, which marks an unused entry. */
+	next = car_get_var(cbfs_verified_next);
+	verified[next] = offset;
+	car_set_var(cbfs_verified_next, (next + 1) % CBFS_VERIFIED_FILES);
+
+	return 0;
+}
+
+int cbfs_boot_locate(struct cbfsf *fh, const char *name, uint32_t *type)
+{
+	if (cbfs_boot_locate_file(fh, name, type))
+		return -1;
+
+	if (CBFS_VERIFY_FILE_HASHES && cbfs_boot_verify(fh) < 0) {
+		ERROR("'%s' failed verification.\n", name);
+		return -1;
+	}
+
+	return 0;
+}
+
 void *cbfs_boot_map_with_leak(const char *name, uint32_t type, size_t *size)
 {
 	struct cbfsf fh;
@@ -87,6 +359,31 @@ int cbfs_locate_file_in_region(struct cbfsf *fh, const char *region_name,
 	return cbfs_locate(fh, &rdev, name, type);
 }
 
+struct cbfs_lz4_fetch {
+	const struct region_device *rdev;
+	size_t offset;
+	void *dst;
+	uint64_t start_ticks;
+	uint64_t read_ticks;
+};
+
+static int cbfs_lz4_fetch_block(void *arg, size_t offset, size_t size)
+{
+	struct cbfs_lz4_fetch *fetch = arg;
+	uint64_t start = timestamp_get();
+	ssize_t ret;
+
+	if (!fetch->start_ticks)
+		fetch->start_ticks = start;
+
+	ret = rdev_readat(fetch->rdev, fetch->dst + offset,
+			  fetch->offset + offset, size);
+
+	fetch->read_ticks += timestamp_get() - start;
+
+	return ret == size ? 0 : -1;
+}
+
 size_t cbfs_load_and_decompress(const struct region_device *rdev, size_t offset,
 	size_t in_size, void *buffer, size_t buffer_size, uint32_t compression)
 {
@@ -109,13 +406,24 @@ size_t cbfs_load_and_decompress(const struct region_device *rdev, size_t offset,
 		 * area for in-place decompression. It is the responsibility of
 		 * the caller to ensure that buffer_size is large enough
 		 * (see compression.h, guaranteed by cbfstool for stages). */
-		void *compr_start = buffer + buffer_size - in_size;
-		if (rdev_readat(rdev, compr_start, offset, in_size) != in_size)
-			return 0;
-
+		struct cbfs_lz4_fetch fetch = {
+			.rdev = rdev,
+			.offset = offset,
+			.dst = buffer + buffer_size - in_size,
+		};
+
+		/* Each block is read right before it gets decompressed, so
+		 * reading and decompression alternate per block instead of
+		 * running back to back over the whole file. */
 		timestamp_add_now(TS_START_ULZ4F);
-		out_size = ulz4fn(compr_start, in_size, buffer, buffer_size);
+		out_size = ulz4fn_fetch(fetch.dst, in_size, buffer, buffer_size,
+					cbfs_lz4_fetch_block, &fetch);
 		timestamp_add_now(TS_END_ULZ4F);
+
+		DEBUG("LZ4: %zu bytes read in %lu ticks, %zu bytes total in "
+		      "%lu ticks\n", in_size, (unsigned long)fetch.read_ticks,
+		      out_size,
+		      (unsigned long)(timestamp_get() - fetch.start_ticks));
 		return out_size;
 
 	case CBFS_COMPRESS_LZMA:
@@ -127,6 +435,18 @@ size_t cbfs_load_and_decompress(const struct region_device *rdev, size_t offset,
 		if ((ENV_ROMSTAGE || ENV_POSTCAR)
 			&& !IS_ENABLED(CONFIG_COMPRESS_RAMSTAGE))
 			return 0;
+
+		/* Stream the compressed data from media that isn't memory
+		 * mapped instead of bouncing all of it through the CBFS cache
+		 * before decompressing. */
+		if (!IS_ENABLED(CONFIG_BOOT_DEVICE_MEMORY_MAPPED)) {
+			timestamp_add_now(TS_START_ULZMA);
+			out_size = ulzman_rdev(rdev, offset, in_size, buffer,
+					       buffer_size);
+			timestamp_add_now(TS_END_ULZMA);
+			return out_size;
+		}
+
 		void *map = rdev_mmap(rdev, offset, in_size);
 		if (map == NULL)
 			return 0;
@@ -224,6 +544,7 @@ int cbfs_prog_stage_load(struct prog *pstage)
 	void *entry;
 	size_t fsize;
 	size_t foffset;
+	int flags;
 	const struct region_device *fh = prog_rdev(pstage);
 
 	if (rdev_readat(fh, &stage, 0, sizeof(stage)) != sizeof(stage))
@@ -259,7 +580,14 @@ int cbfs_prog_stage_load(struct prog *pstage)
 	/* Clear area not covered by file. */
 	memset(&load[fsize], 0, stage.memlen - fsize);
 
-	prog_segment_loaded((uintptr_t)load, stage.memlen, SEG_FINAL);
+	/* Later stages run on this CPU, unlike e.g. BL32. */
+	flags = SEG_FINAL;
+	if (prog_type(pstage) == PROG_VERSTAGE ||
+	    prog_type(pstage) == PROG_ROMSTAGE ||
+	    prog_type(pstage) == PROG_RAMSTAGE)
+		flags |= SEG_CPU_LOCAL;
+
+	prog_segment_loaded((uintptr_t)load, stage.memlen, flags);
 
 out:
 	prog_set_area(pstage, load, stage.memlen);
@@ -268,36 +596,11 @@ out:
 	return 0;
 }
 
-/* This only supports the "COREBOOT" fmap region. */
 static int cbfs_master_header_props(struct cbfs_props *props)
 {
 	struct cbfs_header header;
-	const struct region_device *bdev;
-	int32_t rel_offset;
-	size_t offset;
-
-	bdev = boot_device_ro();
-
-	if (bdev == NULL)
-		return -1;
-
-	size_t fmap_top = ___FMAP__COREBOOT_BASE + ___FMAP__COREBOOT_SIZE;
-
-	/* Find location of header using signed 32-bit offset from
-	 * end of CBFS region. */
-	offset = fmap_top - sizeof(int32_t);
-	if (rdev_readat(bdev, &rel_offset, offset, sizeof(int32_t)) < 0)
-		return -1;
-
-	offset = fmap_top + rel_offset;
-	if (rdev_readat(bdev, &header, offset, sizeof(header)) < 0)
-		return -1;
-
-	header.magic = ntohl(header.magic);
-	header.romsize = ntohl(header.romsize);
-	header.offset = ntohl(header.offset);
 
-	if (header.magic != CBFS_HEADER_MAGIC)
+	if (cbfs_master_header_read(&header))
 		return -1;
 
 	props->offset = header.offset;
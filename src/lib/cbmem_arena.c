@@ -0,0 +1,109 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <cbmem.h>
+#include <cbmem_arena.h>
+#include <commonlib/helpers.h>
+#include <console/console.h>
+#include <string.h>
+
+static size_t record_size(size_t size)
+{
+	return ALIGN_UP(sizeof(struct cbmem_arena_record) + size,
+			CBMEM_ARENA_ALIGN);
+}
+
+static struct cbmem_arena *arena_get(void)
+{
+	struct cbmem_arena *arena;
+
+	arena = cbmem_find(CBMEM_ID_ARENA);
+	if (arena != NULL) {
+		if (arena->used > arena->size)
+			return NULL;
+		return arena;
+	}
+
+	arena = cbmem_add(CBMEM_ID_ARENA,
+			  sizeof(*arena) + CONFIG_CBMEM_ARENA_SIZE);
+	if (arena == NULL)
+		return NULL;
+
+	memset(arena, 0, sizeof(*arena));
+	arena->size = CONFIG_CBMEM_ARENA_SIZE;
+
+	return arena;
+}
+
+void *cbmem_arena_alloc(uint32_t tag, size_t size)
+{
+	struct cbmem_arena *arena;
+	struct cbmem_arena_record *rec;
+
+	arena = arena_get();
+	if (arena == NULL)
+		return NULL;
+
+	if (size > arena->size ||
+	    record_size(size) > arena->size - arena->used) {
+		printk(BIOS_ERR, "CBMEM arena: no room for %zu bytes of "
+		       "0x%08x\n", size, tag);
+		return NULL;
+	}
+
+	rec = (void *)&arena->data[arena->used];
+	rec->tag = tag;
+	rec->size = size;
+	memset(rec->data, 0, size);
+
+	arena->used += record_size(size);
+	arena->num_records++;
+
+	return rec->data;
+}
+
+void *cbmem_arena_next(uint32_t tag, const void *prev, size_t *size)
+{
+	struct cbmem_arena *arena;
+	struct cbmem_arena_record *rec;
+	size_t offset = 0;
+
+	arena = cbmem_find(CBMEM_ID_ARENA);
+	if (arena == NULL || arena->used > arena->size)
+		return NULL;
+
+	if (prev != NULL) {
+		rec = (void *)((uintptr_t)prev - sizeof(*rec));
+		offset = (uintptr_t)rec - (uintptr_t)arena->data;
+		offset += record_size(rec->size);
+	}
+
+	while (offset + sizeof(*rec) <= arena->used) {
+		rec = (void *)&arena->data[offset];
+		offset += sizeof(*rec);
+
+		/* Don't walk off the end of a corrupted arena. */
+		if (rec->size > arena->used - offset)
+			break;
+		offset += record_size(rec->size) - sizeof(*rec);
+
+		if (rec->tag != tag)
+			continue;
+
+		if (size != NULL)
+			*size = rec->size;
+		return rec->data;
+	}
+
+	return NULL;
+}
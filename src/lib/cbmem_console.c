@@ -13,6 +13,7 @@
  * GNU General Public License for more details.
  */
 
+#include <commonlib/helpers.h>
 #include <compiler.h>
 #include <console/console.h>
 #include <console/cbmem_console.h>
@@ -142,32 +143,69 @@ void cbmemc_tx_byte(unsigned char data)
 	cbm_cons_p->cursor = flags | cursor;
 }
 
+void cbmemc_write(const void *data, size_t len)
+{
+	struct cbmem_console *cbm_cons_p = current_console();
+	const u8 *src = data;
+	u32 flags, cursor, size;
+	size_t chunk;
+
+	if (!cbm_cons_p || !cbm_cons_p->size)
+		return;
+
+	size = cbm_cons_p->size;
+	flags = cbm_cons_p->cursor & ~CURSOR_MASK;
+	cursor = cbm_cons_p->cursor & CURSOR_MASK;
+
+	/* Only the last size bytes would survive the wraparound anyway. */
+	if (len > size) {
+		cursor = (cursor + (len - size)) % size;
+		src += len - size;
+		len = size;
+		flags |= OVERFLOW;
+	}
+
+	while (len) {
+		chunk = MIN(len, size - cursor);
+		memcpy(&cbm_cons_p->body[cursor], src, chunk);
+		src += chunk;
+		len -= chunk;
+		cursor += chunk;
+		if (cursor >= size) {
+			cursor = 0;
+			flags |= OVERFLOW;
+		}
+	}
+
+	cbm_cons_p->cursor = flags | cursor;
+}
+
 /*
  * Copy the current console buffer (either from the cache as RAM area or from
  * the static buffer, pointed at by src_cons_p) into the newly initialized CBMEM
- * console. The use of cbmemc_tx_byte() ensures that all special cases for the
+ * console. The use of cbmemc_write() ensures that all special cases for the
  * target console (e.g. overflow) will be handled. If there had been an
  * overflow in the source console, log a message to that effect.
  */
 static void copy_console_buffer(struct cbmem_console *src_cons_p)
 {
-	u32 c;
+	u32 cursor;
 
 	if (!src_cons_p)
 		return;
 
+	cursor = src_cons_p->cursor & CURSOR_MASK;
+
 	if (src_cons_p->cursor & OVERFLOW) {
 		const char overflow_warning[] = "\n*** Pre-CBMEM " ENV_STRING
 			" console overflowed, log truncated! ***\n";
-		for (c = 0; c < sizeof(overflow_warning) - 1; c++)
-			cbmemc_tx_byte(overflow_warning[c]);
-		for (c = src_cons_p->cursor & CURSOR_MASK;
-		     c < src_cons_p->size; c++)
-			cbmemc_tx_byte(src_cons_p->body[c]);
+		cbmemc_write(overflow_warning, sizeof(overflow_warning) - 1);
+		/* The oldest part runs from the cursor to the end. */
+		cbmemc_write(&src_cons_p->body[cursor],
+			     src_cons_p->size - cursor);
 	}
 
-	for (c = 0; c < (src_cons_p->cursor & CURSOR_MASK); c++)
-		cbmemc_tx_byte(src_cons_p->body[c]);
+	cbmemc_write(src_cons_p->body, cursor);
 
 	/* Invalidate the source console, so it will be reinitialized on the
 	   next reboot. Otherwise, we might copy the same bytes again. */
@@ -24,6 +24,7 @@ void stage_cache_add(int stage_id, const struct prog *stage)
 {
 	struct stage_cache *meta;
 	void *c;
+	size_t size;
 
 	meta = cbmem_add(CBMEM_ID_STAGEx_META + stage_id, sizeof(*meta));
 	if (meta == NULL) {
@@ -35,14 +36,15 @@ void stage_cache_add(int stage_id, const struct prog *stage)
 	meta->entry_addr = (uintptr_t)prog_entry(stage);
 	meta->arg = (uintptr_t)prog_entry_arg(stage);
 
-	c = cbmem_add(CBMEM_ID_STAGEx_CACHE + stage_id, prog_size(stage));
+	size = stage_cache_data_size(stage);
+	c = cbmem_add(CBMEM_ID_STAGEx_CACHE + stage_id, size);
 	if (c == NULL) {
 		printk(BIOS_ERR, "Error: Can't add stage_cache %x to cbmem\n",
 				CBMEM_ID_STAGEx_CACHE + stage_id);
 		return;
 	}
 
-	memcpy(c, prog_start(stage), prog_size(stage));
+	stage_cache_data_save(c, size, stage, meta);
 }
 
 void stage_cache_add_raw(int stage_id, const void *base, const size_t size)
@@ -74,6 +76,19 @@ void stage_cache_get_raw(int stage_id, void **base, size_t *size)
 	*size = cbmem_entry_size(e);
 }
 
+void stage_cache_set_writable(int stage_id, const void *start, size_t size)
+{
+	struct stage_cache *meta;
+
+	meta = cbmem_find(CBMEM_ID_STAGEx_META + stage_id);
+	if (meta == NULL)
+		return;
+
+	if (stage_cache_data_writable(meta, start, size))
+		printk(BIOS_ERR, "Error: %zu bytes at %p are not in stage %x\n",
+		       size, start, CBMEM_ID_STAGEx_CACHE + stage_id);
+}
+
 void stage_cache_load_stage(int stage_id, struct prog *stage)
 {
 	struct stage_cache *meta;
@@ -103,9 +118,10 @@ void stage_cache_load_stage(int stage_id, struct prog *stage)
 	size = cbmem_entry_size(e);
 	load_addr = (void *)(uintptr_t)meta->load_addr;
 
-	memcpy(load_addr, c, size);
+	if (stage_cache_data_load(meta, c, size))
+		return;
 
-	prog_set_area(stage, load_addr, size);
+	prog_set_area(stage, load_addr, meta->size);
 	prog_set_entry(stage, (void *)(uintptr_t)meta->entry_addr,
 			(void *)(uintptr_t)meta->arg);
 }
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <cbfs.h>
 #include <cbmem.h>
+#include <commonlib/sdhci.h>
 #include <bootmem.h>
 #include <spi_flash.h>
 #include <security/vboot/vbnv_layout.h>
@@ -291,6 +292,21 @@ static void lb_boot_media_params(struct lb_header *header)
 		bmp->fmap_offset = region_device_offset(&fmrd);
 }
 
+static void lb_mmc_info(struct lb_header *header)
+{
+	struct lb_mmc_info *rec;
+	const struct sdhci_handoff *handoff;
+
+	handoff = cbmem_find(CBMEM_ID_SDHCI_HANDOFF);
+	if (!handoff)
+		return;
+
+	rec = (struct lb_mmc_info *)lb_new_record(header);
+	rec->tag = LB_TAG_MMC_INFO;
+	rec->size = sizeof(*rec);
+	rec->early_cmd1_status = handoff->early_cmd1_status;
+}
+
 static void lb_ram_code(struct lb_header *header)
 {
 	struct lb_strapping_id *rec;
@@ -462,6 +478,41 @@ static struct lb_forward *lb_forward(struct lb_header *header,
 	return forward;
 }
 
+/*
+ * Put an LB_TAG_DIRECTORY record in front of all the others. This has to be
+ * the last record added, and nothing may hold on to pointers into the table
+ * across it since all records move.
+ */
+static void lb_directory(struct lb_header *head)
+{
+	struct lb_directory *dir;
+	struct lb_record *rec;
+	size_t dir_size, bytes;
+	uint32_t i, entries;
+
+	entries = head->table_entries;
+	if (!entries)
+		return;
+
+	bytes = head->table_bytes + lb_last_record(head)->size;
+	dir_size = sizeof(*dir) + entries * sizeof(dir->entries[0]);
+	dir = (struct lb_directory *)lb_first_record(head);
+	memmove((char *)dir + dir_size, dir, bytes);
+
+	dir->tag = LB_TAG_DIRECTORY;
+	dir->size = dir_size;
+	rec = (struct lb_record *)((char *)dir + dir_size);
+	for (i = 0; i < entries; i++) {
+		dir->entries[i].tag = rec->tag;
+		dir->entries[i].offset = (char *)rec - (char *)head;
+		rec = (struct lb_record *)((char *)rec + rec->size);
+	}
+
+	/* The directory goes before the last record, which stays the last. */
+	head->table_bytes += dir_size;
+	head->table_entries++;
+}
+
 static unsigned long lb_table_fini(struct lb_header *head)
 {
 	struct lb_record *rec, *first_rec;
@@ -576,12 +627,19 @@ static uintptr_t write_coreboot_table(uintptr_t rom_table_end)
 
 	lb_boot_media_params(head);
 
+	/* Let the payload pick up an eMMC device that is already powering up */
+	if (IS_ENABLED(CONFIG_SDHCI_CONTROLLER))
+		lb_mmc_info(head);
+
 	/* Add architecture records. */
 	lb_arch_add_records(head);
 
 	/* Add all cbmem entries into the coreboot tables. */
 	cbmem_add_records_to_cbtable(head);
 
+	/* Let payloads find records without walking the table. */
+	lb_directory(head);
+
 	/* Remember where my valid memory ranges are */
 	return lb_table_fini(head);
 }
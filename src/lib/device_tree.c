@@ -149,6 +149,311 @@ int fdt_skip_node(void *blob, uint32_t start_offset)
 
 
 
+/*
+ * Functions for editing flattened trees in place. The blocks are kept in the
+ * order reserve map, structure, strings, and whatever totalsize leaves after
+ * the strings is room to grow into. Every edit moves what comes after it, so
+ * it invalidates offsets past the point of the edit.
+ */
+
+static uint32_t fdt_used_size(struct fdt_header *header)
+{
+	return be32toh(header->strings_offset) + be32toh(header->strings_size);
+}
+
+static void fdt_header_add(uint32_t *field, int32_t delta)
+{
+	*field = htobe32(be32toh(*field) + delta);
+}
+
+// Make old_len bytes at offset new_len bytes long, moving everything after.
+static int fdt_splice(void *blob, uint32_t offset, uint32_t old_len,
+		      uint32_t new_len)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+	uint32_t used = fdt_used_size(header);
+	uint8_t *ptr = (uint8_t *)blob + offset;
+
+	if (used - old_len + new_len > be32toh(header->totalsize))
+		return -1;
+
+	memmove(ptr + new_len, ptr + old_len, used - offset - old_len);
+	return 0;
+}
+
+static int fdt_splice_struct(void *blob, uint32_t offset, uint32_t old_len,
+			     uint32_t new_len)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+
+	if (fdt_splice(blob, offset, old_len, new_len))
+		return -1;
+
+	fdt_header_add(&header->structure_size, new_len - old_len);
+	fdt_header_add(&header->strings_offset, new_len - old_len);
+	return 0;
+}
+
+// Returns the offset of name in the strings block, adding it if needed.
+static int fdt_string_offset(void *blob, const char *name)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+	char *strings = (char *)blob + be32toh(header->strings_offset);
+	uint32_t size = be32toh(header->strings_size);
+	uint32_t len = strlen(name) + 1;
+
+	for (uint32_t offset = 0; offset < size;
+	     offset += strlen(strings + offset) + 1) {
+		if (!strcmp(strings + offset, name))
+			return offset;
+	}
+
+	if (fdt_used_size(header) + len > be32toh(header->totalsize))
+		return -1;
+
+	memcpy(strings + size, name, len);
+	fdt_header_add(&header->strings_size, len);
+	return size;
+}
+
+int fdt_open_into(const void *blob, void *buf, uint32_t size)
+{
+	const struct fdt_header *src = (const struct fdt_header *)blob;
+	struct fdt_header *header = (struct fdt_header *)buf;
+	const uint64_t *reserve;
+	uint32_t reserve_size = 0;
+
+	if (be32toh(src->magic) != FDT_HEADER_MAGIC ||
+	    be32toh(src->version) < 17)
+		return -1;
+
+	reserve = (const uint64_t *)((const uint8_t *)blob +
+				     be32toh(src->reserve_map_offset));
+	do {
+		reserve_size += 2 * sizeof(uint64_t);
+		reserve += 2;
+	} while (reserve[-2] || reserve[-1]);
+
+	uint32_t reserve_offset = ALIGN_UP(sizeof(*header), sizeof(uint64_t));
+	uint32_t struct_offset = reserve_offset + reserve_size;
+	uint32_t struct_size = be32toh(src->structure_size);
+	uint32_t strings_offset = struct_offset + struct_size;
+	uint32_t strings_size = be32toh(src->strings_size);
+
+	if (strings_offset + strings_size > size)
+		return -1;
+
+	memset(header, 0, reserve_offset);
+	header->magic = htobe32(FDT_HEADER_MAGIC);
+	header->totalsize = htobe32(size);
+	header->reserve_map_offset = htobe32(reserve_offset);
+	header->structure_offset = htobe32(struct_offset);
+	header->structure_size = htobe32(struct_size);
+	header->strings_offset = htobe32(strings_offset);
+	header->strings_size = htobe32(strings_size);
+	header->version = htobe32(17);
+	header->last_compatible_version = htobe32(16);
+	header->boot_cpuid_phys = src->boot_cpuid_phys;
+
+	memcpy((uint8_t *)buf + reserve_offset,
+	       (const uint8_t *)blob + be32toh(src->reserve_map_offset),
+	       reserve_size);
+	memcpy((uint8_t *)buf + struct_offset,
+	       (const uint8_t *)blob + be32toh(src->structure_offset),
+	       struct_size);
+	memcpy((uint8_t *)buf + strings_offset,
+	       (const uint8_t *)blob + be32toh(src->strings_offset),
+	       strings_size);
+
+	return 0;
+}
+
+void fdt_pack(void *blob)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+
+	header->totalsize = htobe32(fdt_used_size(header));
+}
+
+uint32_t fdt_first_child(void *blob, uint32_t node)
+{
+	uint32_t offset = node + fdt_node_name(blob, node, NULL);
+	int size;
+
+	while ((size = fdt_next_property(blob, offset, NULL)))
+		offset += size;
+
+	return fdt_node_name(blob, offset, NULL) ? offset : 0;
+}
+
+uint32_t fdt_next_sibling(void *blob, uint32_t node)
+{
+	uint32_t offset = node + fdt_skip_node(blob, node);
+
+	return fdt_node_name(blob, offset, NULL) ? offset : 0;
+}
+
+uint32_t fdt_find_node(void *blob, uint32_t parent, const char *name,
+		       uint32_t len)
+{
+	uint32_t node;
+	const char *child;
+
+	for (node = fdt_first_child(blob, parent); node;
+	     node = fdt_next_sibling(blob, node)) {
+		fdt_node_name(blob, node, &child);
+		if (strlen(child) == len && !strncmp(child, name, len))
+			return node;
+	}
+
+	return 0;
+}
+
+static uint32_t fdt_insert_node(void *blob, uint32_t parent,
+				const char *name, uint32_t len)
+{
+	// New nodes go last, right before the end token of the parent.
+	uint32_t offset = parent + fdt_skip_node(blob, parent) -
+			  sizeof(uint32_t);
+	uint32_t name_size = ALIGN_UP(len + 1, sizeof(uint32_t));
+	uint32_t *ptr;
+
+	if (fdt_splice_struct(blob, offset, 0, name_size + 8))
+		return 0;
+
+	ptr = (uint32_t *)((uint8_t *)blob + offset);
+	ptr[0] = htobe32(FDT_TOKEN_BEGIN_NODE);
+	memset(&ptr[1], 0, name_size);
+	memcpy(&ptr[1], name, len);
+	ptr[1 + name_size / sizeof(uint32_t)] = htobe32(FDT_TOKEN_END_NODE);
+
+	return offset;
+}
+
+uint32_t fdt_add_node(void *blob, uint32_t parent, const char *name)
+{
+	return fdt_insert_node(blob, parent, name, strlen(name));
+}
+
+uint32_t fdt_find_node_by_path(void *blob, const char *path, int create)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+	uint32_t node = be32toh(header->structure_offset);
+
+	while (node && *path) {
+		const char *end = path;
+		uint32_t child;
+
+		while (*end && *end != '/')
+			end++;
+
+		if (end != path) {
+			child = fdt_find_node(blob, node, path, end - path);
+			if (!child && create)
+				child = fdt_insert_node(blob, node, path,
+							end - path);
+			node = child;
+		}
+
+		path = *end ? end + 1 : end;
+	}
+
+	return node;
+}
+
+uint32_t fdt_find_prop(void *blob, uint32_t node, const char *name,
+		       struct fdt_property *prop)
+{
+	uint32_t offset = node + fdt_node_name(blob, node, NULL);
+	struct fdt_property found;
+	int size;
+
+	while ((size = fdt_next_property(blob, offset, &found))) {
+		if (!strcmp(found.name, name)) {
+			if (prop)
+				*prop = found;
+			return offset;
+		}
+		offset += size;
+	}
+
+	return 0;
+}
+
+int fdt_set_prop(void *blob, uint32_t node, const char *name,
+		 const void *data, uint32_t size)
+{
+	struct fdt_property prop;
+	uint32_t new_len = 3 * sizeof(uint32_t) + ALIGN_UP(size, 4);
+	uint32_t offset = fdt_find_prop(blob, node, name, &prop);
+	uint32_t *ptr;
+	int name_offset;
+
+	if (offset) {
+		uint32_t old_len = 3 * sizeof(uint32_t) +
+				   ALIGN_UP(prop.size, 4);
+
+		if (fdt_splice_struct(blob, offset, old_len, new_len))
+			return -1;
+		ptr = (uint32_t *)((uint8_t *)blob + offset);
+	} else {
+		name_offset = fdt_string_offset(blob, name);
+		if (name_offset < 0)
+			return -1;
+
+		offset = node + fdt_node_name(blob, node, NULL);
+		if (fdt_splice_struct(blob, offset, 0, new_len))
+			return -1;
+		ptr = (uint32_t *)((uint8_t *)blob + offset);
+		ptr[0] = htobe32(FDT_TOKEN_PROPERTY);
+		ptr[2] = htobe32(name_offset);
+	}
+
+	ptr[1] = htobe32(size);
+	if (size)
+		ptr[2 + DIV_ROUND_UP(size, 4)] = 0;
+	memcpy(&ptr[3], data, size);
+
+	return 0;
+}
+
+int fdt_set_u32_prop(void *blob, uint32_t node, const char *name, u32 val)
+{
+	u32 data = htobe32(val);
+
+	return fdt_set_prop(blob, node, name, &data, sizeof(data));
+}
+
+void fdt_delete_node(void *blob, uint32_t node)
+{
+	fdt_splice_struct(blob, node, fdt_skip_node(blob, node), 0);
+}
+
+int fdt_add_reserve_map_entry(void *blob, uint64_t start, uint64_t size)
+{
+	struct fdt_header *header = (struct fdt_header *)blob;
+	uint32_t offset = be32toh(header->reserve_map_offset);
+	uint64_t *entry = (uint64_t *)((uint8_t *)blob + offset);
+
+	// Insert in front of the terminating all zero entry.
+	while (entry[0] || entry[1]) {
+		entry += 2;
+		offset += 2 * sizeof(uint64_t);
+	}
+
+	if (fdt_splice(blob, offset, 0, 2 * sizeof(uint64_t)))
+		return -1;
+
+	fdt_header_add(&header->structure_offset, 2 * sizeof(uint64_t));
+	fdt_header_add(&header->strings_offset, 2 * sizeof(uint64_t));
+	entry[0] = htobe64(start);
+	entry[1] = htobe64(size);
+
+	return 0;
+}
+
+
+
 /*
  * Functions to turn a flattened tree into an unflattened one.
  */
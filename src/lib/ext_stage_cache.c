@@ -64,6 +64,7 @@ void stage_cache_add(int stage_id, const struct prog *stage)
 	const struct imd_entry *e;
 	struct stage_cache *meta;
 	void *c;
+	size_t size;
 
 	imd = imd_get();
 	e = imd_entry_add(imd, CBMEM_ID_STAGEx_META + stage_id, sizeof(*meta));
@@ -80,8 +81,8 @@ void stage_cache_add(int stage_id, const struct prog *stage)
 	meta->entry_addr = (uintptr_t)prog_entry(stage);
 	meta->arg = (uintptr_t)prog_entry_arg(stage);
 
-	e = imd_entry_add(imd, CBMEM_ID_STAGEx_CACHE + stage_id,
-				prog_size(stage));
+	size = stage_cache_data_size(stage);
+	e = imd_entry_add(imd, CBMEM_ID_STAGEx_CACHE + stage_id, size);
 
 	if (e == NULL) {
 		printk(BIOS_DEBUG, "Error: Can't add stage_cache %x to imd\n",
@@ -91,7 +92,7 @@ void stage_cache_add(int stage_id, const struct prog *stage)
 
 	c = imd_entry_at(imd, e);
 
-	memcpy(c, prog_start(stage), prog_size(stage));
+	stage_cache_data_save(c, size, stage, meta);
 }
 
 void stage_cache_add_raw(int stage_id, const void *base, const size_t size)
@@ -143,6 +144,8 @@ void stage_cache_load_stage(int stage_id, struct prog *stage)
 	void *c;
 	size_t size;
 
+	prog_set_entry(stage, NULL, NULL);
+
 	imd = imd_get();
 	e = imd_entry_find(imd, CBMEM_ID_STAGEx_META + stage_id);
 	if (e == NULL) {
@@ -164,9 +167,10 @@ void stage_cache_load_stage(int stage_id, struct prog *stage)
 	c = imd_entry_at(imd, e);
 	size = imd_entry_size(imd, e);
 
-	memcpy((void *)(uintptr_t)meta->load_addr, c, size);
+	if (stage_cache_data_load(meta, c, size))
+		return;
 
-	prog_set_area(stage, (void *)(uintptr_t)meta->load_addr, size);
+	prog_set_area(stage, (void *)(uintptr_t)meta->load_addr, meta->size);
 	prog_set_entry(stage, (void *)(uintptr_t)meta->entry_addr,
 			(void *)(uintptr_t)meta->arg);
 }
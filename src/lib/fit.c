@@ -33,6 +33,9 @@ static struct list_node image_nodes;
 static struct list_node config_nodes;
 static struct list_node compat_strings;
 
+/* Where "data-offset" of external image data counts from. */
+static size_t external_data_base;
+
 struct compat_string_entry {
 	const char *compat_string;
 	struct list_node list_node;
@@ -77,6 +80,39 @@ static void fit_add_default_compat_strings(void)
 	fit_add_compat_string(compat_string);
 }
 
+static uint32_t prop_u32(const struct fdt_property *prop)
+{
+	if (prop->size != sizeof(uint32_t))
+		return 0;
+	return be32toh(*(uint32_t *)prop->data);
+}
+
+/* Only the first hash node is used, mkimage puts the strongest there. */
+static void image_hash_node(struct fit_image_node *image,
+			    struct device_tree_node *node)
+{
+	const char *algo = NULL;
+	const void *value = NULL;
+	uint32_t size = 0;
+
+	struct device_tree_property *prop;
+	list_for_each(prop, node->properties, list_node) {
+		if (!strcmp("algo", prop->prop.name)) {
+			algo = prop->prop.data;
+		} else if (!strcmp("value", prop->prop.name)) {
+			value = prop->prop.data;
+			size = prop->prop.size;
+		}
+	}
+
+	if (!algo || !value || image->hash_size)
+		return;
+
+	image->hash_algo = algo;
+	image->hash = value;
+	image->hash_size = size;
+}
+
 static void image_node(struct device_tree_node *node)
 {
 	struct fit_image_node *image = xzalloc(sizeof(*image));
@@ -89,6 +125,13 @@ static void image_node(struct device_tree_node *node)
 		if (!strcmp("data", prop->prop.name)) {
 			image->data = prop->prop.data;
 			image->size = prop->prop.size;
+		} else if (!strcmp("data-offset", prop->prop.name)) {
+			image->offset = external_data_base +
+					prop_u32(&prop->prop);
+		} else if (!strcmp("data-position", prop->prop.name)) {
+			image->offset = prop_u32(&prop->prop);
+		} else if (!strcmp("data-size", prop->prop.name)) {
+			image->size = prop_u32(&prop->prop);
 		} else if (!strcmp("compression", prop->prop.name)) {
 			if (!strcmp("none", prop->prop.data))
 				image->compression = CBFS_COMPRESS_NONE;
@@ -101,6 +144,12 @@ static void image_node(struct device_tree_node *node)
 		}
 	}
 
+	struct device_tree_node *child;
+	list_for_each(child, node->children, list_node) {
+		if (!strncmp("hash", child->name, strlen("hash")))
+			image_hash_node(image, child);
+	}
+
 	list_insert_after(&image->list_node, &image_nodes);
 }
 
@@ -318,12 +367,49 @@ void fit_add_compat_string(const char *str)
 	list_insert_after(&compat_node->list_node, &compat_strings);
 }
 
+/* Collects the memory for the OS and builds the 'reg' property for it. */
+static void *memory_reg(struct mem_map *map, u32 addr_cells, u32 size_cells,
+			size_t *length)
+{
+	const struct range_entry *r;
+
+	memranges_init_empty(&map->mem, NULL, 0);
+	memranges_init_empty(&map->reserved, NULL, 0);
+
+	bootmem_walk_os_mem(walk_memory_table, map);
+
+	/*
+	 * Count the amount of 'reg' entries we need (account for size limits).
+	 */
+	size_t count = 0;
+	memranges_each_entry(r, &map->mem) {
+		uint64_t size = range_entry_size(r);
+		uint64_t max_size = max_range(size_cells);
+		count += DIV_ROUND_UP(size, max_size);
+	}
+
+	/* Allocate the right amount of space and fill up the entries. */
+	*length = count * (addr_cells + size_cells) * sizeof(u32);
+
+	void *data = xzalloc(*length);
+
+	struct entry_params add_params = { addr_cells, size_cells, data };
+	memranges_each_entry(r, &map->mem) {
+		update_mem_property(range_entry_base(r), range_entry_end(r),
+				    &add_params);
+	}
+	assert(add_params.data - data == *length);
+
+	return data;
+}
+
 void fit_update_memory(struct device_tree *tree)
 {
 	const struct range_entry *r;
 	struct device_tree_node *node;
 	u32 addr_cells = 1, size_cells = 1;
 	struct mem_map map;
+	size_t length;
 
 	printk(BIOS_INFO, "FIT: Updating devicetree memory entries\n");
 
@@ -344,10 +430,7 @@ void fit_update_memory(struct device_tree *tree)
 	list_insert_after(&node->list_node, &tree->root->children);
 	dt_add_string_prop(node, "device_type", (char *)"memory");
 
-	memranges_init_empty(&map.mem, NULL, 0);
-	memranges_init_empty(&map.reserved, NULL, 0);
-
-	bootmem_walk_os_mem(walk_memory_table, &map);
+	void *data = memory_reg(&map, addr_cells, size_cells, &length);
 
 	/* CBMEM regions are both carved out and explicitly reserved. */
 	memranges_each_entry(r, &map.reserved) {
@@ -355,33 +438,118 @@ void fit_update_memory(struct device_tree *tree)
 				   tree);
 	}
 
-	/*
-	 * Count the amount of 'reg' entries we need (account for size limits).
-	 */
-	size_t count = 0;
-	memranges_each_entry(r, &map.mem) {
-		uint64_t size = range_entry_size(r);
-		uint64_t max_size = max_range(size_cells);
-		count += DIV_ROUND_UP(size, max_size);
-	}
+	/* Assemble the final property and add it to the device tree. */
+	dt_add_bin_prop(node, "reg", data, length);
 
-	/* Allocate the right amount of space and fill up the entries. */
-	size_t length = count * (addr_cells + size_cells) * sizeof(u32);
+	memranges_teardown(&map.mem);
+	memranges_teardown(&map.reserved);
+}
 
-	void *data = xzalloc(length);
+int fit_update_chosen_flat(void *blob, const char *cmd_line)
+{
+	uint32_t node = fdt_find_node_by_path(blob, "chosen", 1);
 
-	struct entry_params add_params = { addr_cells, size_cells, data };
-	memranges_each_entry(r, &map.mem) {
-		update_mem_property(range_entry_base(r), range_entry_end(r),
-				    &add_params);
+	if (!node)
+		return -1;
+
+	return fdt_set_prop(blob, node, "bootargs", cmd_line,
+			    strlen(cmd_line) + 1);
+}
+
+int fit_add_ramdisk_flat(void *blob, void *ramdisk_addr, size_t ramdisk_size)
+{
+	uint32_t node = fdt_find_node_by_path(blob, "chosen", 1);
+
+	/* Warning: this assumes the ramdisk is currently located below 4GiB. */
+	u32 start = (uintptr_t)ramdisk_addr;
+	u32 end = start + ramdisk_size;
+
+	if (!node)
+		return -1;
+
+	/* Adding properties doesn't move the node they are added to. */
+	if (fdt_set_u32_prop(blob, node, "linux,initrd-start", start) ||
+	    fdt_set_u32_prop(blob, node, "linux,initrd-end", end))
+		return -1;
+
+	return 0;
+}
+
+static u32 flat_cell_prop(void *blob, uint32_t node, const char *name,
+			  u32 default_cells)
+{
+	struct fdt_property prop;
+
+	if (!fdt_find_prop(blob, node, name, &prop) ||
+	    prop.size != sizeof(u32))
+		return default_cells;
+
+	return be32toh(*(u32 *)prop.data);
+}
+
+static bool flat_is_memory_node(void *blob, uint32_t node)
+{
+	struct fdt_property prop;
+
+	return fdt_find_prop(blob, node, "device_type", &prop) &&
+	       prop.size == sizeof("memory") &&
+	       !memcmp(prop.data, "memory", sizeof("memory"));
+}
+
+int fit_update_memory_flat(void *blob)
+{
+	const struct range_entry *r;
+	struct fdt_header *header = blob;
+	struct mem_map map;
+	uint32_t root, node;
+	size_t length;
+	int ret = -1;
+
+	printk(BIOS_INFO, "FIT: Updating devicetree memory entries\n");
+
+	root = be32toh(header->structure_offset);
+	u32 addr_cells = flat_cell_prop(blob, root, "#address-cells", 1);
+	u32 size_cells = flat_cell_prop(blob, root, "#size-cells", 1);
+
+	void *data = memory_reg(&map, addr_cells, size_cells, &length);
+
+	/* The reserve map sits in front of the structure, so it goes first. */
+	memranges_each_entry(r, &map.reserved) {
+		if (fdt_add_reserve_map_entry(blob, range_entry_base(r),
+					      range_entry_size(r)))
+			goto out;
 	}
-	assert(add_params.data - data == length);
 
-	/* Assemble the final property and add it to the device tree. */
-	dt_add_bin_prop(node, "reg", data, length);
+	/*
+	 * First remove all existing device_type="memory" nodes, then add ours.
+	 */
+	root = be32toh(header->structure_offset);
+	node = fdt_first_child(blob, root);
+	while (node) {
+		if (!flat_is_memory_node(blob, node)) {
+			node = fdt_next_sibling(blob, node);
+			continue;
+		}
+
+		/* The next sibling moves up to where this one was. */
+		fdt_delete_node(blob, node);
+		if (!fdt_node_name(blob, node, NULL))
+			node = 0;
+	}
 
+	node = fdt_add_node(blob, root, "memory");
+	if (!node ||
+	    fdt_set_prop(blob, node, "device_type", "memory",
+			 sizeof("memory")) ||
+	    fdt_set_prop(blob, node, "reg", data, length))
+		goto out;
+
+	ret = 0;
+out:
+	free(data);
 	memranges_teardown(&map.mem);
 	memranges_teardown(&map.reserved);
+	return ret;
 }
 
 /*
@@ -412,7 +580,28 @@ static void fit_update_compat(void *fdt_blob, struct fit_config_node *config)
 	}
 }
 
-struct fit_config_node *fit_load(void *fit)
+/* Devicetrees are needed to pick a config, read them if they are external. */
+static bool read_external_fdt(struct fit_image_node *image,
+			      const struct region_device *rdev)
+{
+	void *data;
+
+	if (image->data)
+		return true;
+
+	data = malloc(image->size);
+	if (!data || rdev_readat(rdev, data, image->offset, image->size) !=
+	    image->size) {
+		printk(BIOS_ERR, "FIT: Can't read FDT %s.\n", image->name);
+		free(data);
+		return false;
+	}
+
+	image->data = data;
+	return true;
+}
+
+struct fit_config_node *fit_load(void *fit, const struct region_device *rdev)
 {
 	struct fdt_header *header = (struct fdt_header *)fit;
 	struct fit_image_node *image;
@@ -426,6 +615,7 @@ struct fit_config_node *fit_load(void *fit)
 		       be32toh(header->magic));
 		return NULL;
 	}
+	external_data_base = ALIGN_UP(be32toh(header->totalsize), 4);
 	struct device_tree *tree = fdt_unflatten(fit);
 
 	const char *default_config_name = NULL;
@@ -484,6 +674,11 @@ struct fit_config_node *fit_load(void *fit)
 				continue;
 			}
 
+			if (!read_external_fdt(config->fdt_node, rdev)) {
+				list_remove(&config->list_node);
+				continue;
+			}
+
 			config->compat_pos = -1;
 			config->compat_rank = -1;
 
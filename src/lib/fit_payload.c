@@ -17,6 +17,7 @@
 
 #include <console/console.h>
 #include <bootmem.h>
+#include <endian.h>
 #include <cbmem.h>
 #include <device/resource.h>
 #include <stdlib.h>
@@ -30,6 +31,9 @@
 #include <lib.h>
 #include <fit_payload.h>
 
+/* Room for the fixups when the devicetree is patched in place. */
+#define FDT_PATCH_ROOM	(16 * KiB)
+
 /* Pack the device_tree and place it at given position. */
 static void pack_fdt(struct region *fdt, struct device_tree *dt)
 {
@@ -40,35 +44,199 @@ static void pack_fdt(struct region *fdt, struct device_tree *dt)
 	prog_segment_loaded(fdt->offset, fdt->size, 0);
 }
 
-/**
- * Extract a node to given regions.
+/*
+ * Without board fixups nothing needs the unflattened tree, so the devicetree
+ * is copied where it ends up and patched there.
  * Returns true on error, false on success.
  */
-static bool extract(struct region *region, struct fit_image_node *node)
+static bool patch_fdt(struct region *fdt, struct fit_config_node *config,
+		      struct region *initrd)
 {
-	void *dst = (void *)region->offset;
-	const char *comp_name;
-	size_t true_size = 0;
+	void *blob = (void *)fdt->offset;
 
-	switch (node->compression) {
-	case CBFS_COMPRESS_NONE:
-		comp_name = "Relocating uncompressed";
-		break;
-	case CBFS_COMPRESS_LZMA:
-		comp_name = "Decompressing LZMA";
-		break;
-	case CBFS_COMPRESS_LZ4:
-		comp_name = "Decompressing LZ4";
-		break;
-	default:
-		printk(BIOS_ERR, "ERROR: Unsupported compression\n");
+	printk(BIOS_INFO, "FIT: Patching FDT at %p\n", blob);
+
+	if (fdt_open_into(config->fdt_node->data, blob, fdt->size))
+		return true;
+
+#if defined(CONFIG_LINUX_COMMAND_LINE)
+	if (fit_update_chosen_flat(blob, CONFIG_LINUX_COMMAND_LINE))
+		return true;
+#endif
+	if (fit_update_memory_flat(blob))
+		return true;
+
+	if (config->ramdisk_node &&
+	    fit_add_ramdisk_flat(blob, (void *)initrd->offset, initrd->size))
+		return true;
+
+	fdt_pack(blob);
+	prog_segment_loaded(fdt->offset, fdt->size, 0);
+
+	return false;
+}
+
+static bool can_patch_fdt(const struct fit_config_node *config)
+{
+	const struct fdt_header *header = config->fdt_node->data;
+
+	return !device_tree_fixups.next && be32toh(header->version) >= 17;
+}
+
+/* The payload, external image data is read from there. */
+static const struct region_device *fit_rdev;
+
+/*
+ * Hashes what passes through it on the way to the decompressor, so verifying
+ * an image costs no extra pass over it. That only works as long as the image
+ * is read front to back, which is what cbfs_load_and_decompress() does.
+ */
+struct hash_rdev {
+	struct region_device rdev;
+	const struct region_device *parent;
+	struct vb2_digest_context ctx;
+	size_t hashed;
+	bool in_order;
+};
+
+static void hash_rdev_extend(struct hash_rdev *h, const void *buf,
+			     size_t offset, size_t size)
+{
+	if (offset != h->hashed) {
+		h->in_order = false;
+		return;
+	}
+
+	if (vb2_digest_extend(&h->ctx, buf, size))
+		h->in_order = false;
+	h->hashed += size;
+}
+
+static void *hash_rdev_mmap(const struct region_device *rd, size_t offset,
+			    size_t size)
+{
+	struct hash_rdev *h = container_of(rd, struct hash_rdev, rdev);
+	void *mapping = rdev_mmap(h->parent, offset, size);
+
+	if (mapping)
+		hash_rdev_extend(h, mapping, offset, size);
+
+	return mapping;
+}
+
+static int hash_rdev_munmap(const struct region_device *rd, void *mapping)
+{
+	struct hash_rdev *h = container_of(rd, struct hash_rdev, rdev);
+
+	return rdev_munmap(h->parent, mapping);
+}
+
+static ssize_t hash_rdev_readat(const struct region_device *rd, void *b,
+				size_t offset, size_t size)
+{
+	struct hash_rdev *h = container_of(rd, struct hash_rdev, rdev);
+	ssize_t ret = rdev_readat(h->parent, b, offset, size);
+
+	if (ret == size)
+		hash_rdev_extend(h, b, offset, size);
+
+	return ret;
+}
+
+static const struct region_device_ops hash_rdev_ops = {
+	.mmap = hash_rdev_mmap,
+	.munmap = hash_rdev_munmap,
+	.readat = hash_rdev_readat,
+};
+
+static enum vb2_hash_algorithm hash_algo(const struct fit_image_node *node)
+{
+	if (!IS_ENABLED(CONFIG_FIT_VERIFY_HASHES) || !node->hash_size)
+		return VB2_HASH_INVALID;
+
+	if (!strcmp(node->hash_algo, "sha1"))
+		return VB2_HASH_SHA1;
+	if (!strcmp(node->hash_algo, "sha256"))
+		return VB2_HASH_SHA256;
+	if (!strcmp(node->hash_algo, "sha512"))
+		return VB2_HASH_SHA512;
+
+	printk(BIOS_WARNING, "FIT: Can't check %s hash of %s\n",
+	       node->hash_algo, node->name);
+	return VB2_HASH_INVALID;
+}
+
+/* Returns true if there is a digest and it doesn't match. */
+static bool hash_mismatch(const struct fit_image_node *node,
+			  struct vb2_digest_context *ctx)
+{
+	uint8_t digest[VB2_SHA512_DIGEST_SIZE];
+
+	if (node->hash_size > sizeof(digest) ||
+	    vb2_digest_finalize(ctx, digest, node->hash_size) ||
+	    memcmp(digest, node->hash, node->hash_size)) {
+		printk(BIOS_ERR, "ERROR: Hash of %s does not match\n",
+		       node->name);
 		return true;
 	}
 
-	printk(BIOS_INFO, "FIT: %s %s to %p\n", comp_name, node->name, dst);
+	printk(BIOS_DEBUG, "FIT: %s hash of %s is good\n", node->hash_algo,
+	       node->name);
+	return false;
+}
+
+/* Hash an image the decompressor didn't read in one go. */
+static bool rehash_mismatch(const struct fit_image_node *node,
+			    const struct region_device *rdev,
+			    enum vb2_hash_algorithm algo)
+{
+	struct vb2_digest_context ctx;
+	uint8_t buffer[1024];
+	size_t offset;
+
+	if (vb2_digest_init(&ctx, algo))
+		return true;
+
+	for (offset = 0; offset < node->size; offset += sizeof(buffer)) {
+		size_t size = MIN(sizeof(buffer), node->size - offset);
+
+		if (rdev_readat(rdev, buffer, offset, size) != size ||
+		    vb2_digest_extend(&ctx, buffer, size))
+			return true;
+	}
+
+	return hash_mismatch(node, &ctx);
+}
+
+/* Check an image which is in the mapped FIT structure. */
+static bool embedded_hash_mismatch(const struct fit_image_node *node)
+{
+	enum vb2_hash_algorithm algo = hash_algo(node);
+	struct vb2_digest_context ctx;
+
+	if (algo == VB2_HASH_INVALID)
+		return false;
+
+	if (vb2_digest_init(&ctx, algo) ||
+	    vb2_digest_extend(&ctx, node->data, node->size))
+		return true;
+
+	return hash_mismatch(node, &ctx);
+}
+
+static size_t extract_embedded(struct region *region,
+			       struct fit_image_node *node)
+{
+	void *dst = (void *)region->offset;
+	size_t true_size = 0;
+
+	if (embedded_hash_mismatch(node))
+		return 0;
 
 	switch (node->compression) {
 	case CBFS_COMPRESS_NONE:
+		if (node->size > region->size)
+			return 0;
 		memcpy(dst, node->data, node->size);
 		true_size = node->size;
 		break;
@@ -82,20 +250,153 @@ static bool extract(struct region *region, struct fit_image_node *node)
 		true_size = ulz4fn(node->data, node->size, dst, region->size);
 		timestamp_add_now(TS_END_ULZ4F);
 		break;
+	}
+
+	return true_size;
+}
+
+/*
+ * External data goes straight from the boot media to where it ends up. LZMA
+ * is decompressed as it streams in and LZ4 in place once it is read, so the
+ * image is never kept in memory in between.
+ */
+static size_t extract_external(struct region *region,
+			       struct fit_image_node *node)
+{
+	enum vb2_hash_algorithm algo = hash_algo(node);
+	struct region_device image;
+	struct hash_rdev h;
+	const struct region_device *src = &image;
+	size_t true_size;
+
+	if (rdev_chain(&image, fit_rdev, node->offset, node->size)) {
+		printk(BIOS_ERR, "ERROR: %s is outside of the FIT\n",
+		       node->name);
+		return 0;
+	}
+
+	/* In place decompression needs room for the source at the end. */
+	if (node->compression == CBFS_COMPRESS_LZ4 &&
+	    node->size > region->size)
+		return 0;
+
+	if (algo != VB2_HASH_INVALID) {
+		if (vb2_digest_init(&h.ctx, algo))
+			return 0;
+		region_device_init(&h.rdev, &hash_rdev_ops, 0, node->size);
+		h.parent = &image;
+		h.hashed = 0;
+		h.in_order = true;
+		src = &h.rdev;
+	}
+
+	true_size = cbfs_load_and_decompress(src, 0, node->size,
+					     (void *)region->offset,
+					     region->size, node->compression);
+	if (!true_size || algo == VB2_HASH_INVALID)
+		return true_size;
+
+	if (h.in_order && h.hashed == node->size) {
+		if (hash_mismatch(node, &h.ctx))
+			return 0;
+	} else if (rehash_mismatch(node, &image, algo)) {
+		return 0;
+	}
+
+	return true_size;
+}
+
+/**
+ * Extract a node to given regions, passing flags on to prog_segment_loaded().
+ * Returns true on error, false on success.
+ */
+static bool extract(struct region *region, struct fit_image_node *node,
+		    int flags)
+{
+	void *dst = (void *)region->offset;
+	const char *comp_name;
+	size_t true_size = 0;
+
+	switch (node->compression) {
+	case CBFS_COMPRESS_NONE:
+		comp_name = "Relocating uncompressed";
+		break;
+	case CBFS_COMPRESS_LZMA:
+		comp_name = "Decompressing LZMA";
+		break;
+	case CBFS_COMPRESS_LZ4:
+		comp_name = "Decompressing LZ4";
+		break;
 	default:
+		printk(BIOS_ERR, "ERROR: Unsupported compression\n");
 		return true;
 	}
 
+	printk(BIOS_INFO, "FIT: %s %s to %p\n", comp_name, node->name, dst);
+
+	if (node->data)
+		true_size = extract_embedded(region, node);
+	else
+		true_size = extract_external(region, node);
+
 	if (!true_size) {
 		printk(BIOS_ERR, "ERROR: %s node failed!\n", comp_name);
 		return true;
 	}
 
-	prog_segment_loaded(region->offset, true_size, 0);
+	prog_segment_loaded(region->offset, true_size, flags);
 
 	return false;
 }
 
+size_t fit_image_head(const struct fit_image_node *node, void *buf,
+		      size_t size)
+{
+	struct region_device image;
+	size_t true_size = 0;
+	void *data;
+
+	if (node->data) {
+		switch (node->compression) {
+		case CBFS_COMPRESS_NONE:
+			true_size = MIN(size, node->size);
+			memcpy(buf, node->data, true_size);
+			break;
+		case CBFS_COMPRESS_LZMA:
+			true_size = ulzman(node->data, node->size, buf, size);
+			break;
+		case CBFS_COMPRESS_LZ4:
+			true_size = ulz4fn(node->data, node->size, buf, size);
+			break;
+		}
+		return true_size;
+	}
+
+	if (rdev_chain(&image, fit_rdev, node->offset, node->size))
+		return 0;
+
+	switch (node->compression) {
+	case CBFS_COMPRESS_NONE:
+		true_size = MIN(size, node->size);
+		if (rdev_readat(&image, buf, 0, true_size) != true_size)
+			true_size = 0;
+		break;
+	case CBFS_COMPRESS_LZMA:
+		true_size = ulzman_rdev(&image, 0, node->size, buf, size);
+		break;
+	case CBFS_COMPRESS_LZ4:
+		/* The LZ4 decoder wants all of its input at hand. */
+		data = rdev_mmap_full(&image);
+		if (!data)
+			break;
+		true_size = ulz4fn(data, node->size, buf, size);
+		rdev_munmap(&image, data);
+		break;
+	}
+
+	return true_size;
+}
+
 /*
  * Parse the uImage FIT, choose a configuration and extract images.
  */
@@ -103,16 +404,25 @@ void fit_payload(struct prog *payload)
 {
 	struct device_tree *dt = NULL;
 	struct region kernel = {0}, fdt = {0}, initrd = {0};
+	struct fdt_header header;
+	bool flat = false;
 	void *data;
 
-	data = rdev_mmap_full(prog_rdev(payload));
+	/* Only map the structure, images with external data are read later. */
+	fit_rdev = prog_rdev(payload);
+	if (rdev_readat(fit_rdev, &header, 0, sizeof(header)) !=
+	    sizeof(header))
+		return;
+
+	data = rdev_mmap(fit_rdev, 0, MIN(be32toh(header.totalsize),
+					  region_device_sz(fit_rdev)));
 
 	if (data == NULL)
 		return;
 
 	printk(BIOS_INFO, "FIT: Examine payload %s\n", payload->name);
 
-	struct fit_config_node *config = fit_load(data);
+	struct fit_config_node *config = fit_load(data, fit_rdev);
 
 	if (!config || !config->kernel_node) {
 		printk(BIOS_ERR, "ERROR: Could not load FIT\n");
@@ -121,6 +431,15 @@ void fit_payload(struct prog *payload)
 	}
 
 	if (config->fdt_node) {
+		if (embedded_hash_mismatch(config->fdt_node)) {
+			rdev_munmap(prog_rdev(payload), data);
+			return;
+		}
+
+		flat = can_patch_fdt(config);
+	}
+
+	if (config->fdt_node && !flat) {
 		dt = fdt_unflatten(config->fdt_node->data);
 		if (!dt) {
 			printk(BIOS_ERR,
@@ -140,7 +459,10 @@ void fit_payload(struct prog *payload)
 
 	/* Collect infos for fit_payload_arch */
 	kernel.size = config->kernel_node->size;
-	fdt.size = dt ? dt_flat_size(dt) : 0;
+	if (flat)
+		fdt.size = config->fdt_node->size + FDT_PATCH_ROOM;
+	else
+		fdt.size = dt ? dt_flat_size(dt) : 0;
 	initrd.size = config->ramdisk_node ? config->ramdisk_node->size : 0;
 
 	/* Invoke arch specific payload placement and fixups */
@@ -152,7 +474,11 @@ void fit_payload(struct prog *payload)
 	}
 
 	/* Load the images to given position */
-	if (config->fdt_node) {
+	if (flat && patch_fdt(&fdt, config, &initrd)) {
+		printk(BIOS_ERR, "ERROR: Failed to patch the FDT\n");
+		rdev_munmap(prog_rdev(payload), data);
+		return;
+	} else if (dt) {
 		/* Update device_tree */
 		if (config->ramdisk_node)
 			fit_add_ramdisk(dt, (void *)initrd.offset, initrd.size);
@@ -161,7 +487,7 @@ void fit_payload(struct prog *payload)
 	}
 
 	if (config->ramdisk_node &&
-	    extract(&initrd, config->ramdisk_node)) {
+	    extract(&initrd, config->ramdisk_node, 0)) {
 		printk(BIOS_ERR, "ERROR: Failed to extract initrd\n");
 		rdev_munmap(prog_rdev(payload), data);
 		return;
@@ -169,7 +495,8 @@ void fit_payload(struct prog *payload)
 
 	timestamp_add_now(TS_KERNEL_DECOMPRESSION);
 
-	if (extract(&kernel, config->kernel_node)) {
+	/* The kernel goes last, so it completes the cache maintenance. */
+	if (extract(&kernel, config->kernel_node, SEG_FINAL)) {
 		printk(BIOS_ERR, "ERROR: Failed to extract kernel\n");
 		rdev_munmap(prog_rdev(payload), data);
 		return;
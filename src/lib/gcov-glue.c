@@ -143,12 +143,16 @@ static void coverage_init(void *unused)
 }
 
 void __gcov_flush(void);
+static void coverage_write_compact(void);
 static void coverage_exit(void *unused)
 {
 #if IS_ENABLED(CONFIG_DEBUG_COVERAGE)
 	printk(BIOS_DEBUG, "Syncing coverage data.\n");
 #endif
-	__gcov_flush();
+	if (IS_ENABLED(CONFIG_COVERAGE_COMPACT))
+		coverage_write_compact();
+	else
+		__gcov_flush();
 }
 
 BOOT_STATE_INIT_ENTRY(BS_PRE_DEVICE, BS_ON_ENTRY, coverage_init, NULL);
@@ -21,6 +21,7 @@
 #include <adainit.h>
 #include <arch/exception.h>
 #include <bootstate.h>
+#include <bs_times.h>
 #include <compiler.h>
 #include <console/console.h>
 #include <console/post_codes.h>
@@ -28,6 +29,7 @@
 #include <version.h>
 #include <device/device.h>
 #include <device/pci.h>
+#include <device/resume_script.h>
 #include <delay.h>
 #include <stdlib.h>
 #include <reset.h>
@@ -72,6 +74,8 @@ struct boot_state_times {
  * field is 0 a transition may occur. */
 struct boot_phase {
 	struct boot_state_callback *callbacks;
+	/* Concurrent callbacks started in this phase. */
+	struct boot_state_callback *running;
 	int blockers;
 };
 
@@ -93,7 +97,7 @@ struct boot_state {
 		.name = #state_,				\
 		.id = state_,					\
 		.post_code = POST_ ## state_,			\
-		.phases = { { NULL, 0 }, { NULL, 0 } },		\
+		.phases = { { NULL, NULL, 0 }, { NULL, NULL, 0 } }, \
 		.run_state = run_func_,				\
 		.arg = NULL,					\
 		.complete = 0,					\
@@ -133,8 +137,25 @@ static boot_state_t bs_dev_init_chips(void *arg)
 	return BS_DEV_ENUMERATE;
 }
 
+static int minimal_resume(void)
+{
+	return IS_ENABLED(CONFIG_S3_MINIMAL_RESUME) &&
+		resume_script_minimal_resume();
+}
+
 static boot_state_t bs_dev_enumerate(void *arg)
 {
+	/*
+	 * On a minimal resume the recorded script stands in for this and
+	 * the following device phases. Their boot state callbacks still
+	 * run.
+	 */
+	if (minimal_resume()) {
+		resume_script_replay();
+		soc_minimal_resume();
+		return BS_DEV_RESOURCES;
+	}
+
 	/* Find the devices we don't have hard coded knowledge about. */
 	dev_enumerate();
 
@@ -146,7 +167,8 @@ static boot_state_t bs_dev_resources(void *arg)
 	timestamp_add_now(TS_DEVICE_CONFIGURE);
 
 	/* Now compute and assign the bus resources. */
-	dev_configure();
+	if (!minimal_resume())
+		dev_configure();
 
 	return BS_DEV_ENABLE;
 }
@@ -156,7 +178,8 @@ static boot_state_t bs_dev_enable(void *arg)
 	timestamp_add_now(TS_DEVICE_ENABLE);
 
 	/* Now actually enable devices on the bus */
-	dev_enable();
+	if (!minimal_resume())
+		dev_enable();
 
 	return BS_DEV_INIT;
 }
@@ -166,7 +189,8 @@ static boot_state_t bs_dev_init(void *arg)
 	timestamp_add_now(TS_DEVICE_INITIALIZE);
 
 	/* And of course initialize devices on the bus */
-	dev_initialize();
+	if (!minimal_resume())
+		dev_initialize();
 
 	return BS_POST_DEVICE;
 }
@@ -283,6 +307,101 @@ static void bs_run_timers(int drain)
 static void bs_run_timers(int drain) {}
 #endif
 
+/* Keep track of the current state. */
+static struct state_tracker {
+	boot_state_t state_id;
+	boot_state_sequence_t seq;
+} current_phase = {
+	.state_id = BS_PRE_DEVICE,
+	.seq = BS_ON_ENTRY,
+};
+
+/* Run a callback, timing it for the BS times table. */
+static void bs_time_callback(struct boot_state_callback *bscb)
+{
+	struct mono_time start;
+
+	bs_times_start(&start);
+	bscb->callback(bscb->arg);
+#if IS_ENABLED(CONFIG_BS_TIMES)
+	bs_times_stop(&start, current_phase.seq == BS_ON_ENTRY ?
+		      BS_TIMES_ON_ENTRY : BS_TIMES_ON_EXIT,
+		      current_phase.state_id, (uintptr_t)bscb->callback,
+		      bscb->name);
+#endif
+}
+
+/* Returns 1 if a callback calling func is still to run or running. */
+static int bs_callback_pending(struct boot_phase *phase,
+			       void (*func)(void *arg))
+{
+	struct boot_state_callback *bscb;
+
+	if (func == NULL)
+		return 0;
+
+	for (bscb = phase->callbacks; bscb != NULL; bscb = bscb->next) {
+		if (bscb->callback == func)
+			return 1;
+	}
+
+	for (bscb = phase->running; bscb != NULL; bscb = bscb->next) {
+		if (bscb->running && bscb->callback == func)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Unlink the first callback whose dependency is done, NULL if none is. */
+static struct boot_state_callback *bs_next_callback(struct boot_phase *phase)
+{
+	struct boot_state_callback **prev_ptr = &phase->callbacks;
+	struct boot_state_callback *bscb;
+
+	for (bscb = phase->callbacks; bscb != NULL; bscb = bscb->next) {
+		if (!bs_callback_pending(phase, bscb->depends)) {
+			*prev_ptr = bscb->next;
+			bscb->next = NULL;
+			return bscb;
+		}
+		prev_ptr = &bscb->next;
+	}
+
+	return NULL;
+}
+
+static void bs_run_concurrent(void *arg)
+{
+	struct boot_state_callback *bscb = arg;
+
+	bs_time_callback(bscb);
+	bscb->running = 0;
+}
+
+static void bs_run_callback(struct boot_phase *phase,
+			    struct boot_state_callback *bscb)
+{
+#if IS_ENABLED(CONFIG_DEBUG_BOOT_STATE)
+	printk(BIOS_DEBUG, "BS: callback (%p) @ %s.\n",
+		bscb, bscb->location);
+#endif
+	if (bscb->flags & BS_CALLBACK_CONCURRENT) {
+		/* The thread blocks the current phase until it is done. */
+		bscb->running = 1;
+		bscb->next = phase->running;
+		phase->running = bscb;
+		if (thread_run(NULL, bs_run_concurrent, bscb) == 0)
+			return;
+
+		phase->running = bscb->next;
+		bscb->next = NULL;
+		bscb->running = 0;
+	}
+
+	bs_time_callback(bscb);
+}
+
 static void bs_call_callbacks(struct boot_state *state,
 			      boot_state_sequence_t seq)
 {
@@ -292,22 +411,26 @@ static void bs_call_callbacks(struct boot_state *state,
 		if (phase->callbacks != NULL) {
 			struct boot_state_callback *bscb;
 
-			/* Remove the first callback. */
-			bscb = phase->callbacks;
-			phase->callbacks = bscb->next;
-			bscb->next = NULL;
-
-#if IS_ENABLED(CONFIG_DEBUG_BOOT_STATE)
-			printk(BIOS_DEBUG, "BS: callback (%p) @ %s.\n",
-				bscb, bscb->location);
-#endif
-			bscb->callback(bscb->arg);
-			continue;
+			bscb = bs_next_callback(phase);
+
+			/* Nothing left that could break the cycle. */
+			if (bscb == NULL && !phase->blockers) {
+				printk(BIOS_ERR, "BS: %s callback dependencies "
+				       "never resolve.\n", state->name);
+				bscb = phase->callbacks;
+				phase->callbacks = bscb->next;
+				bscb->next = NULL;
+			}
+
+			if (bscb != NULL) {
+				bs_run_callback(phase, bscb);
+				continue;
+			}
 		}
 
 		/* All callbacks are complete and there are no blockers for
 		 * this state. Therefore, this part of the state is complete. */
-		if (!phase->blockers)
+		if (phase->callbacks == NULL && !phase->blockers)
 			break;
 
 		/* Something is blocking this state from transitioning. As
@@ -315,16 +438,9 @@ static void bs_call_callbacks(struct boot_state *state,
 		 * ran to unblock the state. */
 		bs_run_timers(0);
 	}
-}
 
-/* Keep track of the current state. */
-static struct state_tracker {
-	boot_state_t state_id;
-	boot_state_sequence_t seq;
-} current_phase = {
-	.state_id = BS_PRE_DEVICE,
-	.seq = BS_ON_ENTRY,
-};
+	phase->running = NULL;
+}
 
 static void bs_walk_state_machine(void)
 {
@@ -0,0 +1,348 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <commonlib/helpers.h>
+#include <console/console.h>
+#include <rules.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#if IS_ENABLED(CONFIG_DEBUG_MALLOC)
+#define MALLOCDBG(x...) printk(BIOS_SPEW, x)
+#else
+#define MALLOCDBG(x...)
+#endif
+
+#define HEAP_ALIGN		sizeof(u64)
+
+/* The flags live in the low bits of the block size. */
+#define HEAP_IN_USE		(1 << 0)
+#define HEAP_PREV_FREE		(1 << 1)
+#define HEAP_FLAGS		(HEAP_IN_USE | HEAP_PREV_FREE)
+
+/* Bin n holds the free blocks of HEAP_MIN_BLOCK << n bytes and up. */
+#define HEAP_NUM_BINS		16
+#define HEAP_MAX_CALLERS	32
+
+/*
+ * Every block starts with its size and the caller which allocated it. Free
+ * blocks link into their bin in place of the data and end in a copy of
+ * their size, so that free() finds the start of a free block in front of
+ * the one it frees. There are never two free blocks next to each other.
+ */
+struct heap_block {
+	size_t head;
+	size_t caller;
+	/* Only in free blocks: */
+	struct heap_block *next;
+	struct heap_block *prev;
+};
+
+#define HEAP_HDR_SIZE	offsetof(struct heap_block, next)
+#define HEAP_MIN_BLOCK	ALIGN_UP(sizeof(struct heap_block) + sizeof(size_t), \
+				 HEAP_ALIGN)
+
+struct heap_caller {
+	void *addr;
+	unsigned int allocs;
+	size_t in_use;
+	size_t peak;
+};
+
+extern unsigned char _heap, _eheap;
+
+static struct heap_block *bins[HEAP_NUM_BINS];
+/* The end of the heap is a used block of size 0. */
+static struct heap_block *heap_start, *heap_end;
+
+static struct heap_caller callers[HEAP_MAX_CALLERS];
+static size_t heap_in_use, heap_peak;
+
+static inline size_t block_size(const struct heap_block *b)
+{
+	return b->head & ~HEAP_FLAGS;
+}
+
+static inline struct heap_block *next_block(const struct heap_block *b)
+{
+	return (void *)((uintptr_t)b + block_size(b));
+}
+
+static inline size_t *block_footer(const struct heap_block *b)
+{
+	return (size_t *)next_block(b) - 1;
+}
+
+static int size_to_bin(size_t size)
+{
+	int bin = 0;
+
+	while (bin < HEAP_NUM_BINS - 1 && size >= HEAP_MIN_BLOCK << (bin + 1))
+		bin++;
+
+	return bin;
+}
+
+static void bin_insert(struct heap_block *b)
+{
+	struct heap_block **bin = &bins[size_to_bin(block_size(b))];
+
+	b->head &= ~HEAP_IN_USE;
+	*block_footer(b) = block_size(b);
+	next_block(b)->head |= HEAP_PREV_FREE;
+
+	b->prev = NULL;
+	b->next = *bin;
+	if (b->next)
+		b->next->prev = b;
+	*bin = b;
+}
+
+static void bin_remove(struct heap_block *b)
+{
+	if (b->prev)
+		b->prev->next = b->next;
+	else
+		bins[size_to_bin(block_size(b))] = b->next;
+	if (b->next)
+		b->next->prev = b->prev;
+}
+
+static void heap_init(void)
+{
+	uintptr_t start = ALIGN_UP((uintptr_t)&_heap, HEAP_ALIGN);
+	uintptr_t end = ALIGN_DOWN((uintptr_t)&_eheap, HEAP_ALIGN) -
+			HEAP_HDR_SIZE;
+
+	heap_start = (void *)start;
+	heap_end = (void *)end;
+	heap_end->head = HEAP_IN_USE;
+
+	heap_start->head = end - start;
+	bin_insert(heap_start);
+}
+
+/* First fit, starting with the bin of the size asked for. */
+static struct heap_block *find_free(size_t size)
+{
+	struct heap_block *b;
+	int bin;
+
+	for (bin = size_to_bin(size); bin < HEAP_NUM_BINS; bin++) {
+		for (b = bins[bin]; b; b = b->next) {
+			if (block_size(b) >= size)
+				return b;
+		}
+	}
+
+	return NULL;
+}
+
+/* Give everything of 'b' beyond 'size' back to the bins. */
+static void split_block(struct heap_block *b, size_t size)
+{
+	struct heap_block *rest;
+
+	if (block_size(b) - size < HEAP_MIN_BLOCK)
+		return;
+
+	rest = (void *)((uintptr_t)b + size);
+	rest->head = block_size(b) - size;
+	b->head = size | (b->head & HEAP_FLAGS);
+	bin_insert(rest);
+}
+
+/* Move the start of the free block 'b' to where its data is aligned to
+ * 'boundary' and free what is left in front. */
+static struct heap_block *align_block(struct heap_block *b, size_t boundary)
+{
+	uintptr_t data = (uintptr_t)b + HEAP_HDR_SIZE;
+	size_t gap = ALIGN_UP(data, boundary) - data;
+	struct heap_block *aligned;
+
+	if (!gap)
+		return b;
+
+	while (gap < HEAP_MIN_BLOCK)
+		gap += boundary;
+
+	aligned = (void *)((uintptr_t)b + gap);
+	aligned->head = block_size(b) - gap;
+	b->head = gap | (b->head & HEAP_FLAGS);
+	bin_insert(b);
+
+	return aligned;
+}
+
+static size_t caller_index(void *addr)
+{
+	size_t i;
+
+	for (i = 0; i < HEAP_MAX_CALLERS; i++) {
+		if (callers[i].addr == addr)
+			return i + 1;
+		if (!callers[i].addr) {
+			callers[i].addr = addr;
+			return i + 1;
+		}
+	}
+
+	/* Too many callers, only the totals count this one. */
+	return 0;
+}
+
+static void account(struct heap_block *b, int alloc)
+{
+	size_t size = block_size(b);
+	struct heap_caller *c = NULL;
+
+	if (b->caller)
+		c = &callers[b->caller - 1];
+
+	if (alloc) {
+		heap_in_use += size;
+		heap_peak = MAX(heap_peak, heap_in_use);
+		if (c) {
+			c->allocs++;
+			c->in_use += size;
+			c->peak = MAX(c->peak, c->in_use);
+		}
+	} else {
+		heap_in_use -= size;
+		if (c)
+			c->in_use -= size;
+	}
+}
+
+static void *heap_alloc(size_t boundary, size_t size, void *caller)
+{
+	struct heap_block *b;
+	size_t need;
+
+	MALLOCDBG("%s Enter, boundary %zu, size %zu, caller %p\n",
+		__func__, boundary, size, caller);
+
+	if (!heap_start)
+		heap_init();
+
+	if (boundary < HEAP_ALIGN)
+		boundary = HEAP_ALIGN;
+
+	need = ALIGN_UP(size + HEAP_HDR_SIZE, HEAP_ALIGN);
+	need = MAX(need, HEAP_MIN_BLOCK);
+
+	/* Room for moving the start and freeing what is in front. */
+	if (boundary > HEAP_ALIGN)
+		b = find_free(need + boundary + HEAP_MIN_BLOCK);
+	else
+		b = find_free(need);
+
+	if (!b) {
+		printk(BIOS_ERR, "memalign(boundary=%zu, size=%zu): failed: ",
+				boundary, size);
+		printk(BIOS_ERR, "%zu of %zu bytes in use\n", heap_in_use,
+				(size_t)((uintptr_t)heap_end -
+					 (uintptr_t)heap_start));
+		die("Error! memalign: Out of memory");
+	}
+
+	bin_remove(b);
+	if (boundary > HEAP_ALIGN)
+		b = align_block(b, boundary);
+	split_block(b, need);
+
+	b->head |= HEAP_IN_USE;
+	next_block(b)->head &= ~HEAP_PREV_FREE;
+	b->caller = caller_index(caller);
+	account(b, 1);
+
+	MALLOCDBG("memalign %p\n", (void *)((uintptr_t)b + HEAP_HDR_SIZE));
+
+	return (void *)((uintptr_t)b + HEAP_HDR_SIZE);
+}
+
+void *memalign(size_t boundary, size_t size)
+{
+	return heap_alloc(boundary, size, __builtin_return_address(0));
+}
+
+void *malloc(size_t size)
+{
+	return heap_alloc(sizeof(u64), size, __builtin_return_address(0));
+}
+
+void free(void *ptr)
+{
+	struct heap_block *b, *next;
+
+	if (!ptr)
+		return;
+
+	b = (void *)((uintptr_t)ptr - HEAP_HDR_SIZE);
+	if (b < heap_start || b >= heap_end || !(b->head & HEAP_IN_USE)) {
+		printk(BIOS_ERR, "%s(%p): not allocated from the heap\n",
+		       __func__, ptr);
+		return;
+	}
+
+	MALLOCDBG("%s %p, size %zu\n", __func__, ptr, block_size(b));
+
+	account(b, 0);
+
+	/* Sizes are aligned, adding them leaves the flags alone. */
+	next = next_block(b);
+	if (!(next->head & HEAP_IN_USE)) {
+		bin_remove(next);
+		b->head += block_size(next);
+	}
+
+	if (b->head & HEAP_PREV_FREE) {
+		size_t prev_size = *((size_t *)b - 1);
+		struct heap_block *prev = (void *)((uintptr_t)b - prev_size);
+
+		bin_remove(prev);
+		prev->head += block_size(b);
+		b = prev;
+	}
+
+	bin_insert(b);
+}
+
+void malloc_usage(size_t *peak, size_t *size)
+{
+	*peak = heap_peak;
+	*size = &_eheap - &_heap;
+}
+
+#if ENV_RAMSTAGE
+static void heap_report(void *unused)
+{
+	size_t i;
+
+	if (!heap_start)
+		return;
+
+	printk(BIOS_DEBUG, "Heap: %zu bytes in use, at most %zu of %zu\n",
+	       heap_in_use, heap_peak,
+	       (size_t)((uintptr_t)heap_end - (uintptr_t)heap_start));
+
+	for (i = 0; i < HEAP_MAX_CALLERS && callers[i].addr; i++)
+		printk(BIOS_SPEW, "Heap: %p: %u allocations, %zu bytes in use, "
+		       "at most %zu\n", callers[i].addr, callers[i].allocs,
+		       callers[i].in_use, callers[i].peak);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, heap_report, NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, heap_report, NULL);
+#endif
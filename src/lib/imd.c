@@ -396,11 +396,30 @@ static const struct imdr *imd_entry_to_imdr(const struct imd *imd,
 	return NULL;
 }
 
+static size_t imd_cache_slot(uint32_t id)
+{
+	/* Fibonacci hashing, the ids are mostly ASCII and alike. */
+	return (uint32_t)(id * 0x9e3779b1) >> (32 - IMD_CACHE_BITS);
+}
+
+static const struct imd_entry *imd_cache_find(const struct imd *imd,
+						uint32_t id)
+{
+	const struct imd_entry *e = imd->cache[imd_cache_slot(id)];
+
+	/* The slot may be stale: the entry removed or the slot reused. */
+	if (e == NULL || imd_entry_to_imdr(imd, e) == NULL || e->id != id)
+		return NULL;
+
+	return e;
+}
+
 /* Initialize imd handle. */
 void imd_handle_init(struct imd *imd, void *upper_limit)
 {
 	imdr_init(&imd->lg, upper_limit);
 	imdr_init(&imd->sm, NULL);
+	memset(imd->cache, 0, sizeof(imd->cache));
 }
 
 void imd_handle_init_partial_recovery(struct imd *imd)
@@ -554,13 +573,16 @@ int imd_region_used(struct imd *imd, void **base, size_t *size)
 	return 0;
 }
 
-const struct imd_entry *imd_entry_add(const struct imd *imd, uint32_t id,
+const struct imd_entry *imd_entry_add(struct imd *imd, uint32_t id,
 					size_t size)
 {
 	struct imd_root *r;
 	const struct imdr *imdr;
 	const struct imd_entry *e = NULL;
 
+	/* Lookups return the first entry with an id, which may change. */
+	imd->cache[imd_cache_slot(id)] = NULL;
+
 	/*
 	 * Determine if requested size is less than 1/4 of small data
 	 * region is left.
@@ -581,10 +603,14 @@ const struct imd_entry *imd_entry_add(const struct imd *imd, uint32_t id,
 	return e;
 }
 
-const struct imd_entry *imd_entry_find(const struct imd *imd, uint32_t id)
+const struct imd_entry *imd_entry_find(struct imd *imd, uint32_t id)
 {
 	const struct imd_entry *e;
 
+	e = imd_cache_find(imd, id);
+	if (e != NULL)
+		return e;
+
 	/* Many of the smaller allocations are used a lot. Therefore, try
 	 * the small region first. */
 	e = imdr_entry_find(&imd->sm, id);
@@ -592,10 +618,13 @@ const struct imd_entry *imd_entry_find(const struct imd *imd, uint32_t id)
 	if (e == NULL)
 		e = imdr_entry_find(&imd->lg, id);
 
+	if (e != NULL)
+		imd->cache[imd_cache_slot(id)] = e;
+
 	return e;
 }
 
-const struct imd_entry *imd_entry_find_or_add(const struct imd *imd,
+const struct imd_entry *imd_entry_find_or_add(struct imd *imd,
 						uint32_t id, size_t size)
 {
 	const struct imd_entry *e;
@@ -630,7 +659,7 @@ uint32_t imd_entry_id(const struct imd *imd, const struct imd_entry *entry)
 	return entry->id;
 }
 
-int imd_entry_remove(const struct imd *imd, const struct imd_entry *entry)
+int imd_entry_remove(struct imd *imd, const struct imd_entry *entry)
 {
 	struct imd_root *r;
 	const struct imdr *imdr;
@@ -651,6 +680,7 @@ int imd_entry_remove(const struct imd *imd, const struct imd_entry *entry)
 	if (entry != root_last_entry(r))
 		return -1;
 
+	imd->cache[imd_cache_slot(entry->id)] = NULL;
 	r->num_entries--;
 
 	return 0;
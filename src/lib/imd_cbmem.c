@@ -294,12 +294,20 @@ void *cbmem_entry_start(const struct cbmem_entry *entry)
 	return imd_entry_at(imd, cbmem_to_imd(entry));
 }
 
+void cbmem_get_region(void **baseptr, size_t *size)
+{
+	*baseptr = NULL;
+	*size = 0;
+
+	imd_region_used(cbmem_get_imd(), baseptr, size);
+}
+
 void cbmem_add_bootmem(void)
 {
-	void *baseptr = NULL;
-	size_t size = 0;
+	void *baseptr;
+	size_t size;
 
-	imd_region_used(cbmem_get_imd(), &baseptr, &size);
+	cbmem_get_region(&baseptr, &size);
 	bootmem_add_range((uintptr_t)baseptr, size, BM_MEM_TABLE);
 }
 
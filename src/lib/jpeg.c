@@ -21,6 +21,7 @@
  */
 
 #define __LITTLE_ENDIAN
+#include <stdint.h>
 #include <string.h>
 #include "jpeg.h"
 #define ISHIFT 11
@@ -719,6 +720,17 @@ void idct(int *in, int *out, PREC *lquant, PREC off, int max)
 	for (i = 0; i < 8; i++) {
 		j = *zig2p++;
 		t0 += in[j] * lquant[j];
+		/* Most columns have no AC part, they come out flat. */
+		if (!(in[zig2p[0]] | in[zig2p[1]] | in[zig2p[2]] |
+		      in[zig2p[3]] | in[zig2p[4]] | in[zig2p[5]] |
+		      in[zig2p[6]])) {
+			zig2p += 7;
+			for (j = 0; j < 8; j++)
+				tmpp[j * 8] = t0;
+			tmpp++;
+			t0 = 0;
+			continue;
+		}
 		j = *zig2p++;
 		t5 = in[j] * lquant[j];
 		j = *zig2p++;
@@ -747,6 +759,14 @@ void idct(int *in, int *out, PREC *lquant, PREC off, int max)
 	}
 	for (i = 0; i < 8; i++) {
 		t0 = tmp[8 * i + 0];
+		if (!(tmp[8 * i + 1] | tmp[8 * i + 2] | tmp[8 * i + 3] |
+		      tmp[8 * i + 4] | tmp[8 * i + 5] | tmp[8 * i + 6] |
+		      tmp[8 * i + 7])) {
+			t0 = ITOINT(t0);
+			for (j = 0; j < 8; j++)
+				out[8 * i + j] = t0;
+			continue;
+		}
 		t1 = tmp[8 * i + 1];
 		t2 = tmp[8 * i + 2];
 		t3 = tmp[8 * i + 3];
@@ -876,15 +896,18 @@ static void initcol(PREC q[][64])
 	STORECLAMP(p[(xout) * 3 + 2], y + cb)	\
 )
 
+/*
+ * The picture usually is the framebuffer, which is slow to access. Store
+ * whole pixels instead of single bytes where the byte order allows it.
+ */
 #ifdef __LITTLE_ENDIAN
 #define PIC_16(yin, xin, p, xout, add)				\
 (								\
 	y = outy[(yin) * 8 + xin],				\
-	y = ((CLAMP(y + cr + add*2+1) & 0xf8) <<  8) |		\
+	((uint16_t *)(p))[xout] =				\
+		((CLAMP(y + cr + add*2+1) & 0xf8) <<  8) |	\
 		((CLAMP(y - cg + add)     & 0xfc) <<  3) |	\
-		((CLAMP(y + cb + add*2+1))        >>  3),	\
-	p[(xout) * 2 + 0] = y & 0xff,				\
-	p[(xout) * 2 + 1] = y >> 8				\
+		((CLAMP(y + cb + add*2+1))        >>  3)	\
 )
 #else
 #ifdef CONFIG_PPC
@@ -910,6 +933,16 @@ static void initcol(PREC q[][64])
 #endif
 #endif
 
+#ifdef __LITTLE_ENDIAN
+#define PIC_32(yin, xin, p, xout)		\
+(						\
+	y = outy[(yin) * 8 + xin],		\
+	((uint32_t *)(p))[xout] =		\
+		CLAMP(y + cr) |			\
+		CLAMP(y - cg) << 8 |		\
+		CLAMP(y + cb) << 16		\
+)
+#else
 #define PIC_32(yin, xin, p, xout)		\
 (						\
 	y = outy[(yin) * 8 + xin],		\
@@ -918,6 +951,7 @@ static void initcol(PREC q[][64])
 	STORECLAMP(p[(xout) * 4 + 2], y + cb),	\
 	p[(xout) * 4 + 3] = 0			\
 )
+#endif
 
 #define PIC221111(xin)							\
 (									\
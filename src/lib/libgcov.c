@@ -27,6 +27,8 @@ permissions described in the GCC Runtime Library Exception, version
 #include <string.h>
 #include <console/console.h>
 #include <assert.h>
+#include <commonlib/coverage_serialized.h>
+#include <commonlib/helpers.h>
 typedef s32 pid_t;
 #define gcc_assert(x) ASSERT(x)
 #define fprintf(file, x...) printk(BIOS_ERR, x)
@@ -783,6 +785,111 @@ __gcov_flush(void)
 	}
 }
 
+/* Lay the arc counters out as described in coverage_serialized.h, counts
+   that do not fit 32 bits saturate. With a NULL BUF only the size is
+   returned.  */
+
+static size_t
+coverage_pack(uint8_t *buf)
+{
+	const struct gcov_info *gi_ptr;
+	struct coverage_compact *hdr = (void *)buf;
+	size_t size = sizeof(*hdr);
+	uint32_t num_objects = 0;
+
+	for (gi_ptr = gcov_list; gi_ptr; gi_ptr = gi_ptr->next) {
+		struct coverage_object *obj = (void *)(buf + size);
+		size_t name_size = ALIGN_UP(strlen(gi_ptr->filename) + 1, 4);
+		unsigned int f_ix;
+
+		if (buf) {
+			obj->stamp = gi_ptr->stamp;
+			obj->name_size = name_size;
+			obj->num_functions = gi_ptr->n_functions;
+			memset(&obj[1], 0, name_size);
+			strcpy((char *)&obj[1], gi_ptr->filename);
+		}
+		size += sizeof(*obj) + name_size;
+		num_objects++;
+
+		for (f_ix = 0; f_ix < gi_ptr->n_functions; f_ix++) {
+			const struct gcov_fn_info *gfi_ptr =
+				gi_ptr->functions[f_ix];
+			struct coverage_function *fn = (void *)(buf + size);
+			uint32_t *counters = (void *)&fn[1];
+			const struct gcov_ctr_info *arcs = NULL;
+			uint32_t flags = 0;
+			unsigned int c_num;
+
+			if (!gfi_ptr || gfi_ptr->key != gi_ptr)
+				flags = COVERAGE_FN_NO_DATA;
+			else if (gi_ptr->merge[GCOV_COUNTER_ARCS])
+				arcs = gfi_ptr->ctrs;
+
+			if (arcs) {
+				flags = COVERAGE_FN_NOT_RUN;
+				for (c_num = 0; c_num < arcs->num; c_num++) {
+					if (arcs->values[c_num]) {
+						flags = 0;
+						break;
+					}
+				}
+			}
+
+			if (buf) {
+				memset(fn, 0, sizeof(*fn));
+				fn->flags = flags;
+				if (gfi_ptr && !(flags & COVERAGE_FN_NO_DATA)) {
+					fn->ident = gfi_ptr->ident;
+					fn->lineno_checksum =
+						gfi_ptr->lineno_checksum;
+					fn->cfg_checksum =
+						gfi_ptr->cfg_checksum;
+				}
+				if (arcs)
+					fn->num_counters = arcs->num;
+				for (c_num = 0; !flags && arcs &&
+				     c_num < arcs->num; c_num++)
+					counters[c_num] =
+						MIN(arcs->values[c_num],
+						    (gcov_type)0xffffffff);
+			}
+			size += sizeof(*fn);
+			if (!flags && arcs)
+				size += arcs->num * sizeof(uint32_t);
+		}
+	}
+
+	if (buf) {
+		hdr->magic = COVERAGE_COMPACT_MAGIC;
+		hdr->size = size;
+		hdr->version = GCOV_VERSION;
+		hdr->num_objects = num_objects;
+	}
+
+	return size;
+}
+
+/* Store only the arc counters in CBMEM, cbmem -C writes the .gcda files
+   from them.  */
+
+static void
+coverage_write_compact(void)
+{
+	const struct cbmem_entry *entry;
+	size_t size = coverage_pack(NULL);
+
+	entry = cbmem_entry_add(CBMEM_ID_COVERAGE, size);
+	if (!entry || cbmem_entry_size(entry) < size) {
+		printk(BIOS_ERR, "Coverage: no room for %zu bytes of "
+			"counters\n", size);
+		return;
+	}
+
+	coverage_pack(cbmem_entry_start(entry));
+	printk(BIOS_DEBUG, "Coverage: %zu bytes of counters\n", size);
+}
+
 #endif /* L_gcov */
 
 #ifdef L_gcov_merge_add
@@ -10,6 +10,7 @@
  *
  */
 
+#include <commonlib/region.h>
 #include <console/console.h>
 #include <string.h>
 #include <lib.h>
@@ -17,25 +18,46 @@
 
 #include "lzmadecode.h"
 
-size_t ulzman(const void *src, size_t srcn, void *dst, size_t dstn)
+#define LZMA_HEADER_SIZE (LZMA_PROPERTIES_SIZE + 8)
+
+/* Input is read from the boot media in chunks of this size when streaming. */
+#define LZMA_STREAM_CHUNK_SIZE (4 * KiB)
+
+static SizeT lzma_stream_chunk(void *object, const unsigned char **buffer)
+{
+	ssize_t size;
+
+	size = rdev_stream_next(object, (const void **)buffer);
+
+	if (size < 0) {
+		printk(BIOS_WARNING, "lzma: Failed to read input.\n");
+		return 0;
+	}
+
+	return size;
+}
+
+static size_t lzma_decode(const unsigned char *header,
+			  const void *data, size_t datan,
+			  struct rdev_stream *stream, void *dst, size_t dstn,
+			  void *scratch)
 {
 	unsigned char properties[LZMA_PROPERTIES_SIZE];
-	const int data_offset = LZMA_PROPERTIES_SIZE + 8;
 	UInt32 outSize;
 	SizeT inProcessed;
 	SizeT outProcessed;
 	int res;
 	CLzmaDecoderState state;
 	SizeT mallocneeds;
-	MAYBE_STATIC unsigned char scratchpad[15980];
+	MAYBE_STATIC unsigned char scratchpad[ULZMAN_SCRATCH_SIZE];
 	const unsigned char *cp;
 
-	memcpy(properties, src, LZMA_PROPERTIES_SIZE);
+	memcpy(properties, header, LZMA_PROPERTIES_SIZE);
 	/* The outSize in LZMA stream is a 64bit integer stored in little-endian
 	 * (ref: lzma.cc@LZMACompress: put_64). To prevent accessing by
 	 * unaligned memory address and to load in correct endianness, read each
 	 * byte and re-construct. */
-	cp = src + LZMA_PROPERTIES_SIZE;
+	cp = header + LZMA_PROPERTIES_SIZE;
 	outSize = cp[3] << 24 | cp[2] << 16 | cp[1] << 8 | cp[0];
 	if (outSize > dstn)
 		outSize = dstn;
@@ -45,16 +67,60 @@ size_t ulzman(const void *src, size_t srcn, void *dst, size_t dstn)
 		return 0;
 	}
 	mallocneeds = (LzmaGetNumProbs(&state.Properties) * sizeof(CProb));
-	if (mallocneeds > 15980) {
+	if (mallocneeds > ULZMAN_SCRATCH_SIZE) {
 		printk(BIOS_WARNING, "lzma: Decoder scratchpad too small!\n");
 		return 0;
 	}
-	state.Probs = (CProb *)scratchpad;
-	res = LzmaDecode(&state, src + data_offset, srcn - data_offset,
-			 &inProcessed, dst, outSize, &outProcessed);
+	state.Probs = (CProb *)(scratch != NULL ? scratch : scratchpad);
+	state.InCallback = stream != NULL ? lzma_stream_chunk : NULL;
+	state.InCallbackObject = stream;
+	res = LzmaDecode(&state, data, datan, &inProcessed, dst, outSize,
+			 &outProcessed);
 	if (res != 0) {
 		printk(BIOS_WARNING, "lzma: Decoding error = %d\n", res);
 		return 0;
 	}
 	return outProcessed;
 }
+
+size_t ulzman(const void *src, size_t srcn, void *dst, size_t dstn)
+{
+	if (srcn < LZMA_HEADER_SIZE)
+		return 0;
+
+	return lzma_decode(src, src + LZMA_HEADER_SIZE,
+			   srcn - LZMA_HEADER_SIZE, NULL, dst, dstn, NULL);
+}
+
+size_t ulzman_scratch(const void *src, size_t srcn, void *dst, size_t dstn,
+		      void *scratch)
+{
+	if (srcn < LZMA_HEADER_SIZE)
+		return 0;
+
+	return lzma_decode(src, src + LZMA_HEADER_SIZE,
+			   srcn - LZMA_HEADER_SIZE, NULL, dst, dstn, scratch);
+}
+
+size_t ulzman_rdev(const struct region_device *rdev, size_t offset,
+		   size_t srcn, void *dst, size_t dstn)
+{
+	unsigned char header[LZMA_HEADER_SIZE];
+	struct rdev_stream stream;
+	size_t out_size;
+
+	if (srcn < LZMA_HEADER_SIZE)
+		return 0;
+
+	if (rdev_readat(rdev, header, offset, sizeof(header)) != sizeof(header))
+		return 0;
+
+	rdev_stream_init(&stream, rdev, offset + LZMA_HEADER_SIZE,
+			 srcn - LZMA_HEADER_SIZE, LZMA_STREAM_CHUNK_SIZE);
+
+	out_size = lzma_decode(header, NULL, 0, &stream, dst, dstn, NULL);
+
+	rdev_stream_finish(&stream);
+
+	return out_size;
+}
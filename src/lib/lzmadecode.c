@@ -20,7 +20,9 @@
 */
 
 #include "lzmadecode.h"
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #define kNumTopBits 24
 #define kTopValue ((UInt32)1 << kNumTopBits)
@@ -51,7 +53,17 @@
 }
 
 
-#define RC_TEST { if (Buffer == BufferLim) return LZMA_RESULT_DATA_ERROR; }
+#define RC_TEST {							\
+	if (Buffer == BufferLim) {					\
+		const Byte *chunk;					\
+		SizeT chunk_size = LzmaNextChunk(vs, &chunk);		\
+									\
+		if (chunk_size == 0)					\
+			return LZMA_RESULT_DATA_ERROR;			\
+		Buffer = chunk;						\
+		BufferLim = chunk + chunk_size;				\
+	}								\
+}
 
 #define RC_INIT(buffer, bufferSize) Buffer = buffer; \
 	BufferLim = buffer + bufferSize; RC_INIT2
@@ -91,6 +103,12 @@
 
 #define RC_GET_BIT(p, mi) RC_GET_BIT2(p, mi, ;, ;)
 
+/* One bit of a plain literal, unrolled eight times below. */
+#define LITERAL_BIT {					\
+	CProb *probLit = prob + symbol;			\
+	RC_GET_BIT(probLit, symbol)			\
+}
+
 #define RangeDecoderBitTreeDecode(probs, numLevels, res)	\
 {								\
 	int i = numLevels;					\
@@ -183,6 +201,16 @@ int LzmaDecodeProperties(CLzmaProperties *propsRes,
 
 #define kLzmaStreamWasFinishedId (-1)
 
+/* Kept out of line: this is the slow path of every range coder input test. */
+__attribute__((noinline))
+static SizeT LzmaNextChunk(CLzmaDecoderState *vs, const Byte **chunk)
+{
+	if (vs->InCallback == NULL)
+		return 0;
+
+	return vs->InCallback(vs->InCallbackObject, chunk);
+}
+
 int LzmaDecode(CLzmaDecoderState *vs,
 	const unsigned char *inStream, SizeT inSize, SizeT *inSizeProcessed,
 	unsigned char *outStream, SizeT outSize, SizeT *outSizeProcessed)
@@ -236,24 +264,28 @@ int LzmaDecode(CLzmaDecoderState *vs,
 				+ (previousByte >> (8 - lc))));
 
 			if (state >= kNumLitStates) {
-				int matchByte;
-				matchByte = outStream[nowPos - rep0];
+				/*
+				 * Matched literal. offs drops to 0 at the
+				 * first bit that differs from the match byte,
+				 * after which the remaining bits use the plain
+				 * literal probabilities, without a branch out
+				 * of the loop.
+				 */
+				UInt32 matchByte = outStream[nowPos - rep0];
+				UInt32 offs = 0x100;
 				do {
-					int bit;
+					UInt32 bit;
 					CProb *probLit;
 					matchByte <<= 1;
-					bit = (matchByte & 0x100);
-					probLit = prob + 0x100 + bit + symbol;
+					bit = matchByte & offs;
+					probLit = prob + offs + bit + symbol;
 					RC_GET_BIT2(probLit, symbol,
-						if (bit != 0)
-							break,
-						if (bit == 0)
-							break)
+						offs &= ~bit,
+						offs &= bit)
 				} while (symbol < 0x100);
-			}
-			while (symbol < 0x100) {
-				CProb *probLit = prob + symbol;
-				RC_GET_BIT(probLit, symbol)
+			} else {
+				LITERAL_BIT LITERAL_BIT LITERAL_BIT LITERAL_BIT
+				LITERAL_BIT LITERAL_BIT LITERAL_BIT LITERAL_BIT
 			}
 			previousByte = (Byte)symbol;
 
@@ -376,14 +408,17 @@ int LzmaDecode(CLzmaDecoderState *vs,
 							- posSlot - 1;
 					} else {
 						numDirectBits -= kNumAlignBits;
+						/* t is all ones when the bit
+						 * is 0, so no branch on the
+						 * (random) direct bits. */
 						do {
+							UInt32 t;
 							RC_NORMALIZE
 							Range >>= 1;
-							rep0 <<= 1;
-							if (Code >= Range) {
-								Code -= Range;
-								rep0 |= 1;
-							}
+							Code -= Range;
+							t = 0 - (Code >> 31);
+							Code += Range & t;
+							rep0 = (rep0 << 1) + (t + 1);
 						} while (--numDirectBits != 0);
 						prob = p + Align;
 						rep0 <<= kNumAlignBits;
@@ -413,18 +448,33 @@ int LzmaDecode(CLzmaDecoderState *vs,
 			if (rep0 > nowPos)
 				return LZMA_RESULT_DATA_ERROR;
 
+			{
+				Byte *dest = outStream + nowPos;
+				const Byte *src = dest - rep0;
+
+				if ((SizeT)len > outSize - nowPos)
+					len = outSize - nowPos;
+				nowPos += len;
 
-			do {
-				previousByte = outStream[nowPos - rep0];
-				len--;
-				outStream[nowPos++] = previousByte;
-			} while (len != 0 && nowPos < outSize);
+				/* Long matches that don't overlap their
+				 * source are a plain copy. */
+				if (len >= 16 && rep0 >= (UInt32)len) {
+					memcpy(dest, src, len);
+				} else {
+					do {
+						*dest++ = *src++;
+					} while (--len != 0);
+				}
+				previousByte = outStream[nowPos - 1];
+			}
 		}
 	}
 	RC_NORMALIZE;
 
 
-	*inSizeProcessed = (SizeT)(Buffer - inStream);
+	/* Not meaningful once input was pulled through the callback. */
+	if (vs->InCallback == NULL)
+		*inSizeProcessed = (SizeT)(Buffer - inStream);
 	*outSizeProcessed = nowPos;
 	return LZMA_RESULT_OK;
 }
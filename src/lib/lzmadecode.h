@@ -55,6 +55,11 @@ int LzmaDecodeProperties(CLzmaProperties *propsRes,
 typedef struct _CLzmaDecoderState {
 	CLzmaProperties Properties;
 	CProb *Probs;
+	/* Optional input callback for streaming. It is called whenever the
+	 * input buffer is used up, places the next chunk of input in *buffer
+	 * and returns its size, or 0 when there is no more input. */
+	SizeT (*InCallback)(void *object, const unsigned char **buffer);
+	void *InCallbackObject;
 } CLzmaDecoderState;
 
 
@@ -46,3 +46,10 @@ void *malloc(size_t size)
 {
 	return memalign(sizeof(u64), size);
 }
+
+void malloc_usage(size_t *peak, size_t *size)
+{
+	/* Nothing is ever freed, the pointer only goes up. */
+	*peak = free_mem_ptr - (void *)&_heap;
+	*size = &_eheap - &_heap;
+}
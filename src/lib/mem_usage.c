@@ -0,0 +1,112 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <lib.h>
+#include <mem_usage.h>
+#include <stdlib.h>
+#include <symbols.h>
+
+/* CAR stack and data, heap, CBMEM and one stack per CPU, with some slack. */
+#define MEM_USAGE_ENTRIES	(8 + CONFIG_MAX_CPUS)
+
+static struct mem_usage_table *mem_usage_table(void)
+{
+	struct mem_usage_table *table;
+	size_t size;
+
+	table = cbmem_find(CBMEM_ID_MEM_USAGE);
+	if (table != NULL)
+		return table;
+
+	size = sizeof(*table) + MEM_USAGE_ENTRIES * sizeof(table->entries[0]);
+	table = cbmem_add(CBMEM_ID_MEM_USAGE, size);
+	if (table == NULL)
+		return NULL;
+
+	table->max_entries = MEM_USAGE_ENTRIES;
+	table->num_entries = 0;
+	return table;
+}
+
+void mem_usage_add(enum mem_usage_kind kind, unsigned int cpu, size_t used,
+		   size_t size)
+{
+	const uint8_t stage = ENV_ROMSTAGE ? MEM_USAGE_ROMSTAGE :
+					     MEM_USAGE_RAMSTAGE;
+	struct mem_usage_table *table = mem_usage_table();
+	struct mem_usage_entry *e;
+	size_t i;
+
+	if (table == NULL) {
+		printk(BIOS_ERR, "MEM USAGE: no room in CBMEM\n");
+		return;
+	}
+
+	/* Entries left over from an earlier boot or report get updated. */
+	for (i = 0; i < table->num_entries; i++) {
+		e = &table->entries[i];
+		if (e->stage == stage && e->kind == kind && e->cpu == cpu)
+			break;
+	}
+
+	if (i == table->num_entries) {
+		if (table->num_entries >= table->max_entries) {
+			printk(BIOS_WARNING, "MEM USAGE: table full\n");
+			return;
+		}
+		table->num_entries++;
+	}
+
+	e = &table->entries[i];
+	e->stage = stage;
+	e->kind = kind;
+	e->cpu = cpu;
+	e->used = used;
+	e->size = size;
+}
+
+#if ENV_RAMSTAGE
+static void mem_usage_report(void *unused)
+{
+	const size_t stack_size = CONFIG_STACK_SIZE ? CONFIG_STACK_SIZE :
+					_stack_size;
+	size_t used, size, i;
+	void *cbmem_base;
+
+	/* CPU i runs on the i-th stack from the top of the region. */
+	for (i = 0; i < _stack_size / stack_size; i++) {
+		const void *stack = _estack - (i + 1) * stack_size;
+
+		used = stack_used(stack, stack_size);
+		/* APs that never came up leave their stacks untouched. */
+		if (i > 0 && used == 0)
+			continue;
+		mem_usage_add(MEM_USAGE_STACK, i, used, stack_size);
+		printk(BIOS_DEBUG, "MEM USAGE: CPU%zu stack %zu/%zu bytes\n",
+		       i, used, stack_size);
+	}
+
+	malloc_usage(&used, &size);
+	mem_usage_add(MEM_USAGE_HEAP, 0, used, size);
+	printk(BIOS_DEBUG, "MEM USAGE: heap %zu/%zu bytes\n", used, size);
+
+	cbmem_get_region(&cbmem_base, &size);
+	mem_usage_add(MEM_USAGE_CBMEM, 0, size, 0);
+	printk(BIOS_DEBUG, "MEM USAGE: CBMEM %zu bytes\n", size);
+}
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, mem_usage_report, NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, mem_usage_report, NULL);
+#endif
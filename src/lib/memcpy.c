@@ -1,12 +1,48 @@
+#include <stdint.h>
 #include <string.h>
+
+/* Equally aligned buffers are copied a word at a time. */
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+#define WORD_MASK	(sizeof(word_t) - 1)
+
 void *memcpy(void *vdest, const void *vsrc, size_t bytes)
 {
 	const char *src = vsrc;
 	char *dest = vdest;
-	int i;
 
-	for (i = 0; i < (int)bytes; i++)
-		dest[i] = src[i];
+	if ((((uintptr_t)dest ^ (uintptr_t)src) & WORD_MASK) == 0) {
+		const word_t *s;
+		word_t *d;
+
+		while (bytes && ((uintptr_t)dest & WORD_MASK)) {
+			*dest++ = *src++;
+			bytes--;
+		}
+
+		s = (const word_t *)src;
+		d = (word_t *)dest;
+
+		while (bytes >= 4 * sizeof(word_t)) {
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			d[3] = s[3];
+			d += 4;
+			s += 4;
+			bytes -= 4 * sizeof(word_t);
+		}
+
+		while (bytes >= sizeof(word_t)) {
+			*d++ = *s++;
+			bytes -= sizeof(word_t);
+		}
+
+		src = (const char *)s;
+		dest = (char *)d;
+	}
+
+	while (bytes--)
+		*dest++ = *src++;
 
 	return vdest;
 }
@@ -1,17 +1,65 @@
+#include <stdint.h>
 #include <string.h>
+
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+#define WORD_MASK	(sizeof(word_t) - 1)
+
+/* Both directions go a word at a time when the buffers are equally aligned,
+ * then the distance between them is a multiple of the word size. */
 void *memmove(void *vdest, const void *vsrc, size_t count)
 {
 	const char *src = vsrc;
 	char *dest = vdest;
+	const int aligned =
+		(((uintptr_t)dest ^ (uintptr_t)src) & WORD_MASK) == 0;
 
 	if (dest <= src) {
+		if (aligned) {
+			const word_t *s;
+			word_t *d;
+
+			while (count && ((uintptr_t)dest & WORD_MASK)) {
+				*dest++ = *src++;
+				count--;
+			}
+
+			s = (const word_t *)src;
+			d = (word_t *)dest;
+			while (count >= sizeof(word_t)) {
+				*d++ = *s++;
+				count -= sizeof(word_t);
+			}
+			src = (const char *)s;
+			dest = (char *)d;
+		}
+
 		while (count--)
 			*dest++ = *src++;
 	} else {
-		src  += count - 1;
-		dest += count - 1;
+		src  += count;
+		dest += count;
+
+		if (aligned) {
+			const word_t *s;
+			word_t *d;
+
+			while (count && ((uintptr_t)dest & WORD_MASK)) {
+				*--dest = *--src;
+				count--;
+			}
+
+			s = (const word_t *)src;
+			d = (word_t *)dest;
+			while (count >= sizeof(word_t)) {
+				*--d = *--s;
+				count -= sizeof(word_t);
+			}
+			src = (const char *)s;
+			dest = (char *)d;
+		}
+
 		while (count--)
-			*dest-- = *src--;
+			*--dest = *--src;
 	}
 	return vdest;
 }
@@ -13,6 +13,7 @@
  * GNU General Public License for more details.
  */
 #include <stdlib.h>
+#include <commonlib/helpers.h>
 #include <console/console.h>
 #include <memrange.h>
 
@@ -101,15 +102,44 @@ static void merge_neighbor_entries(struct memranges *ranges)
 	}
 }
 
-static void remove_memranges(struct memranges *ranges,
-			     resource_t begin, resource_t end,
-			     unsigned long unused)
+/* Merge r with its neighbors. This is enough to keep the whole list merged
+ * as long as r is the only entry which may have changed. */
+static void merge_entry_neighbors(struct memranges *ranges,
+				  struct range_entry **prev_ptr,
+				  struct range_entry *r)
+{
+	struct range_entry *prev;
+	struct range_entry *next = r->next;
+
+	if (next != NULL && r->end + 1 >= next->begin && r->tag == next->tag) {
+		r->end = next->end;
+		range_entry_unlink_and_free(ranges, &r->next, next);
+	}
+
+	if (prev_ptr == &ranges->entries)
+		return;
+
+	prev = container_of(prev_ptr, struct range_entry, next);
+	if (prev->end + 1 >= r->begin && prev->tag == r->tag) {
+		prev->end = r->end;
+		range_entry_unlink_and_free(ranges, prev_ptr, r);
+	}
+}
+
+/*
+ * Remove [begin, end] from all entries. Returns where a new entry covering
+ * [begin, end] would have to be linked in to keep the list sorted.
+ */
+static struct range_entry **remove_range(struct memranges *ranges,
+					 resource_t begin, resource_t end)
 {
 	struct range_entry *cur;
 	struct range_entry *next;
 	struct range_entry **prev_ptr;
+	struct range_entry **insert_ptr;
 
 	prev_ptr = &ranges->entries;
+	insert_ptr = prev_ptr;
 	for (cur = ranges->entries; cur != NULL; cur = next) {
 		resource_t tmp_end;
 
@@ -123,6 +153,7 @@ static void remove_memranges(struct memranges *ranges,
 		/* The removal range starts after this one. */
 		if (begin > cur->end) {
 			prev_ptr = &cur->next;
+			insert_ptr = prev_ptr;
 			continue;
 		}
 
@@ -154,6 +185,7 @@ static void remove_memranges(struct memranges *ranges,
 			range_list_add(ranges, &cur->next, end + 1, cur->end,
 				       cur->tag);
 			cur->end = begin - 1;
+			insert_ptr = &cur->next;
 			break;
 		}
 
@@ -162,43 +194,37 @@ static void remove_memranges(struct memranges *ranges,
 			cur->begin = tmp_end + 1;
 
 		/* Removal at end. */
-		if (tmp_end == cur->end)
+		if (tmp_end == cur->end) {
 			cur->end = begin - 1;
+			insert_ptr = &cur->next;
+		}
 	}
+
+	return insert_ptr;
+}
+
+static void remove_memranges(struct memranges *ranges,
+			     resource_t begin, resource_t end,
+			     unsigned long unused)
+{
+	remove_range(ranges, begin, end);
 }
 
 static void merge_add_memranges(struct memranges *ranges,
 				resource_t begin, resource_t end,
 				unsigned long tag)
 {
-	struct range_entry *cur;
+	struct range_entry *new_entry;
 	struct range_entry **prev_ptr;
 
-	prev_ptr = &ranges->entries;
-
-	/* Remove all existing entries covered by the range. */
-	remove_memranges(ranges, begin, end, -1);
-
-	/* Find the entry to place the new entry after. Since
-	 * remove_memranges() was called above there is a guaranteed
-	 * spot for this new entry. */
-	for (cur = ranges->entries; cur != NULL; cur = cur->next) {
-		/* Found insertion spot before current entry. */
-		if (end < cur->begin)
-			break;
-
-		/* Keep track of previous entry to insert new entry after it. */
-		prev_ptr = &cur->next;
-
-		/* The new entry starts after this one. */
-		if (begin > cur->end)
-			continue;
-
-	}
+	/* Remove all existing entries covered by the range. That also finds
+	 * the spot for the new entry, so the list is walked only once. */
+	prev_ptr = remove_range(ranges, begin, end);
 
 	/* Add new entry and merge with neighbors. */
-	range_list_add(ranges, prev_ptr, begin, end, tag);
-	merge_neighbor_entries(ranges);
+	new_entry = range_list_add(ranges, prev_ptr, begin, end, tag);
+	if (new_entry != NULL)
+		merge_entry_neighbors(ranges, prev_ptr, new_entry);
 }
 
 void memranges_update_tag(struct memranges *ranges, unsigned long old_tag,
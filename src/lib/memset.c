@@ -1,12 +1,48 @@
+#include <stdint.h>
 #include <string.h>
 
+typedef unsigned long __attribute__((__may_alias__)) word_t;
+#define WORD_MASK	(sizeof(word_t) - 1)
+
 void *memset(void *s, int c, size_t n)
 {
-	int i;
 	char *ss = (char *) s;
 
-	for (i = 0; i < (int)n; i++)
-		ss[i] = c;
+	if (n >= 2 * sizeof(word_t)) {
+		word_t w = (unsigned char)c;
+		word_t *d;
+
+		/* Split up the shift so it stays defined for 32-bit words. */
+		w |= w << 8;
+		w |= w << 16;
+		w |= (w << 16) << 16;
+
+		while ((uintptr_t)ss & WORD_MASK) {
+			*ss++ = c;
+			n--;
+		}
+
+		d = (word_t *)ss;
+
+		while (n >= 4 * sizeof(word_t)) {
+			d[0] = w;
+			d[1] = w;
+			d[2] = w;
+			d[3] = w;
+			d += 4;
+			n -= 4 * sizeof(word_t);
+		}
+
+		while (n >= sizeof(word_t)) {
+			*d++ = w;
+			n -= sizeof(word_t);
+		}
+
+		ss = (char *)d;
+	}
+
+	while (n--)
+		*ss++ = c;
 
 	return s;
 }
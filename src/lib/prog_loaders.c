@@ -31,6 +31,7 @@
 #include <symbols.h>
 #include <timestamp.h>
 #include <cbfs.h>
+#include <bzimage_payload.h>
 #include <fit_payload.h>
 
 /* Only can represent up to 1 byte less than size_t. */
@@ -189,6 +190,12 @@ void payload_load(void)
 	case CBFS_TYPE_SELF: /* Simple ELF */
 		selfload(payload, true);
 		break;
+	case CBFS_TYPE_BZIMAGE: /* Linux kernel */
+		if (IS_ENABLED(CONFIG_PAYLOAD_BZIMAGE_SUPPORT))
+			bzimage_payload(payload);
+		else
+			die("Unsupported payload type.\n");
+		break;
 	case CBFS_TYPE_FIT: /* Flattened image tree */
 		if (IS_ENABLED(CONFIG_PAYLOAD_FIT_SUPPORT)) {
 			fit_payload(payload);
@@ -223,6 +230,9 @@ void payload_run(void)
 	 */
 	checkstack(_estack, 0);
 
+	/* Nothing buffered may be left behind for the payload to lose. */
+	console_tx_sync();
+
 	prog_run(payload);
 }
 
@@ -15,6 +15,7 @@
  */
 
 #include <compiler.h>
+#include <console/console.h>
 #include <program_loading.h>
 
 /* For each segment of a program loaded this function is called*/
@@ -38,6 +39,9 @@ void __weak arch_segment_loaded(uintptr_t start, size_t size,
 
 void prog_run(struct prog *prog)
 {
+	/* Buffered console output doesn't survive into the next program. */
+	console_tx_sync();
+
 	platform_prog_run(prog);
 	arch_prog_run(prog);
 }
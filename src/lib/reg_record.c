@@ -0,0 +1,202 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <arch/io.h>
+#include <cbmem.h>
+#include <console/console.h>
+#include <reg_record.h>
+
+#if IS_ENABLED(CONFIG_ARCH_X86)
+#include <cpu/x86/msr.h>
+#endif
+
+#define HDR(type, size, count)	((count) << 8 | (size) << 4 | (type))
+#define HDR_TYPE(hdr)		((hdr) & 0xf)
+#define HDR_SIZE(hdr)		(((hdr) >> 4) & 0xf)
+#define HDR_COUNT(hdr)		((hdr) >> 8)
+#define HDR_MAX_COUNT		0xffffff
+
+static struct reg_record_log *recording;
+/* Index of the header of the last record, to extend it with adjacent MMIO. */
+static uint32_t last_hdr;
+
+struct reg_record_log *reg_record_start(uint32_t cbmem_id, size_t size)
+{
+	struct reg_record_log *log;
+
+	log = cbmem_add(cbmem_id, size);
+	if (!log || size < sizeof(*log))
+		return NULL;
+
+	log->signature = REG_RECORD_SIGNATURE;
+	log->capacity = (size - sizeof(*log)) / sizeof(uint32_t);
+	log->used = 0;
+	log->incomplete = 0;
+
+	recording = log;
+	last_hdr = ~0;
+	return log;
+}
+
+void reg_record_stop(void)
+{
+	if (recording)
+		printk(BIOS_DEBUG, "Recorded %u words of register writes%s\n",
+		       recording->used,
+		       recording->incomplete ? ", incomplete" : "");
+	recording = NULL;
+}
+
+void reg_record_unrecordable(void)
+{
+	if (recording)
+		recording->incomplete = 1;
+}
+
+static int value_words(int size)
+{
+	return size == REG_RECORD_SIZE_64 ? 2 : 1;
+}
+
+static void append_value(struct reg_record_log *log, int size, uint64_t value)
+{
+	log->words[log->used++] = value;
+	if (size == REG_RECORD_SIZE_64)
+		log->words[log->used++] = value >> 32;
+}
+
+void reg_record_write(int type, int size, uint32_t addr, uint64_t value)
+{
+	struct reg_record_log *log = recording;
+	uint32_t hdr, count;
+
+	if (!log || log->incomplete)
+		return;
+
+	/* Continue the last record if this is the MMIO register after it. */
+	if (type == REG_RECORD_MMIO && last_hdr != ~0) {
+		hdr = log->words[last_hdr];
+		count = HDR_COUNT(hdr);
+		if (HDR_TYPE(hdr) == type && HDR_SIZE(hdr) == size &&
+		    count < HDR_MAX_COUNT &&
+		    log->words[last_hdr + 1] + (count << size) == addr &&
+		    log->used + value_words(size) <= log->capacity) {
+			log->words[last_hdr] = HDR(type, size, count + 1);
+			append_value(log, size, value);
+			return;
+		}
+	}
+
+	if (log->used + 2 + value_words(size) > log->capacity) {
+		printk(BIOS_ERR, "Register write log is full\n");
+		log->incomplete = 1;
+		return;
+	}
+
+	last_hdr = log->used;
+	log->words[log->used++] = HDR(type, size, 1);
+	log->words[log->used++] = addr;
+	append_value(log, size, value);
+}
+
+static void replay_mmio(int size, uintptr_t addr, const uint32_t *v,
+			uint32_t count)
+{
+	uint32_t i;
+
+	switch (size) {
+	case REG_RECORD_SIZE_8:
+		for (i = 0; i < count; i++)
+			write8((void *)(addr + i), v[i]);
+		break;
+	case REG_RECORD_SIZE_16:
+		for (i = 0; i < count; i++)
+			write16((void *)(addr + 2 * i), v[i]);
+		break;
+	case REG_RECORD_SIZE_32:
+		for (i = 0; i < count; i++)
+			write32((void *)(addr + 4 * i), v[i]);
+		break;
+	}
+}
+
+static void replay_io(int size, uint16_t port, const uint32_t *v,
+		      uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (size == REG_RECORD_SIZE_8)
+			outb(v[i], port + i);
+		else if (size == REG_RECORD_SIZE_16)
+			outw(v[i], port + 2 * i);
+		else
+			outl(v[i], port + 4 * i);
+	}
+}
+
+static void replay_msr(uint32_t index, const uint32_t *v, uint32_t count)
+{
+#if IS_ENABLED(CONFIG_ARCH_X86)
+	msr_t msr;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		msr.lo = v[2 * i];
+		msr.hi = v[2 * i + 1];
+		wrmsr(index + i, msr);
+	}
+#endif
+}
+
+int reg_record_replay(const struct reg_record_log *log)
+{
+	uint32_t pos = 0, hdr, addr, count, words;
+	int type, size;
+
+	if (!log || log->signature != REG_RECORD_SIGNATURE ||
+	    log->incomplete || log->used > log->capacity)
+		return -1;
+
+	/* Check the whole log first so a broken one isn't half applied. */
+	while (pos < log->used) {
+		hdr = log->words[pos];
+		words = HDR_COUNT(hdr) * value_words(HDR_SIZE(hdr));
+		if (HDR_TYPE(hdr) < REG_RECORD_MMIO ||
+		    HDR_TYPE(hdr) > REG_RECORD_MSR ||
+		    HDR_SIZE(hdr) > REG_RECORD_SIZE_64 || !HDR_COUNT(hdr) ||
+		    (HDR_TYPE(hdr) == REG_RECORD_MSR) !=
+		    (HDR_SIZE(hdr) == REG_RECORD_SIZE_64) ||
+		    pos + 2 + words > log->used)
+			return -1;
+		pos += 2 + words;
+	}
+
+	for (pos = 0; pos < log->used; pos += 2 + words) {
+		hdr = log->words[pos];
+		type = HDR_TYPE(hdr);
+		size = HDR_SIZE(hdr);
+		count = HDR_COUNT(hdr);
+		addr = log->words[pos + 1];
+		words = count * value_words(size);
+
+		if (type == REG_RECORD_MMIO)
+			replay_mmio(size, addr, &log->words[pos + 2], count);
+		else if (type == REG_RECORD_IO)
+			replay_io(size, addr, &log->words[pos + 2], count);
+		else
+			replay_msr(addr, &log->words[pos + 2], count);
+	}
+
+	return 0;
+}
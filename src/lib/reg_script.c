@@ -20,6 +20,7 @@
 #include <device/resource.h>
 #include <device/pci.h>
 #include <stdint.h>
+#include <reg_record.h>
 #include <reg_script.h>
 
 #if IS_ENABLED(CONFIG_ARCH_X86)
@@ -93,10 +94,36 @@ static uint32_t reg_script_read_pci(struct reg_script_context *ctx)
 	return 0;
 }
 
+/* Log what a step wrote, when a reg_record log is running. */
+static void reg_script_record(struct reg_script_context *ctx, int type,
+			      uint32_t addr)
+{
+	const struct reg_script *step = reg_script_get_step(ctx);
+
+	reg_record_write(type, step->size, addr, step->value);
+}
+
+static void reg_script_record_pci(struct reg_script_context *ctx)
+{
+#if IS_ENABLED(CONFIG_REG_RECORD) && ENV_RAMSTAGE
+	const struct reg_script *step = reg_script_get_step(ctx);
+
+	if (!IS_ENABLED(CONFIG_MMCONF_SUPPORT)) {
+		reg_record_unrecordable();
+		return;
+	}
+	reg_script_record(ctx, REG_RECORD_MMIO, CONFIG_MMCONF_BASE_ADDRESS |
+			  ctx->dev->bus->secondary << 20 |
+			  ctx->dev->path.pci.devfn << 12 | step->reg);
+#endif
+}
+
 static void reg_script_write_pci(struct reg_script_context *ctx)
 {
 	const struct reg_script *step = reg_script_get_step(ctx);
 
+	reg_script_record_pci(ctx);
+
 	switch (step->size) {
 	case REG_SCRIPT_SIZE_8:
 		pci_write_config8(ctx->dev, step->reg, step->value);
@@ -129,6 +156,8 @@ static void reg_script_write_io(struct reg_script_context *ctx)
 {
 	const struct reg_script *step = reg_script_get_step(ctx);
 
+	reg_script_record(ctx, REG_RECORD_IO, step->reg);
+
 	switch (step->size) {
 	case REG_SCRIPT_SIZE_8:
 		outb(step->value, step->reg);
@@ -161,6 +190,8 @@ static void reg_script_write_mmio(struct reg_script_context *ctx)
 {
 	const struct reg_script *step = reg_script_get_step(ctx);
 
+	reg_script_record(ctx, REG_RECORD_MMIO, step->reg);
+
 	switch (step->size) {
 	case REG_SCRIPT_SIZE_8:
 		write8((u8 *)step->reg, step->value);
@@ -387,6 +418,8 @@ static void reg_script_write_msr(struct reg_script_context *ctx)
 	msr.hi = step->value >> 32;
 	msr.lo = step->value & 0xffffffff;
 	wrmsr(step->reg, msr);
+	reg_record_write(REG_RECORD_MSR, REG_RECORD_SIZE_64, step->reg,
+			 step->value);
 #endif
 }
 
@@ -521,6 +554,7 @@ static void reg_script_write(struct reg_script_context *ctx)
 	case REG_SCRIPT_TYPE_IOSF:
 		ctx->display_prefix = "IOSF";
 		reg_script_write_iosf(ctx);
+		reg_record_unrecordable();
 		break;
 #endif /* HAS_IOSF */
 	default:
@@ -531,6 +565,7 @@ static void reg_script_write(struct reg_script_context *ctx)
 			bus = find_bus(step);
 			if (bus != NULL) {
 				bus->reg_script_write(ctx);
+				reg_record_unrecordable();
 				break;
 			}
 		}
@@ -13,9 +13,13 @@
  * GNU General Public License for more details.
  */
 
+#include <arch/early_variables.h>
+#include <cbmem.h>
+#include <commonlib/fmap_serialized.h>
 #include <commonlib/helpers.h>
 #include <console/console.h>
 #include <region_file.h>
+#include <rules.h>
 #include <string.h>
 
 /*
@@ -60,6 +64,27 @@ struct metadata_block {
 	uint16_t blocks[REGF_UPDATES_PER_METADATA_BLOCK];
 };
 
+/*
+ * State of the files opened with region_file_init_named(). Romstage keeps it
+ * in CAR until CBMEM is up and hands it on to ramstage in CBMEM from there.
+ */
+#define REGF_CACHE_ENTRIES	4
+
+struct regf_cache_entry {
+	char name[FMAP_STRLEN];
+	uint32_t size;
+	uint32_t metadata_size;
+	uint16_t data_blocks[2];
+	int32_t slot;
+};
+
+struct regf_cache {
+	struct regf_cache_entry entries[REGF_CACHE_ENTRIES];
+};
+
+static struct regf_cache early_cache CAR_GLOBAL;
+static struct regf_cache *cbmem_cache CAR_GLOBAL;
+
 static size_t block_to_bytes(uint16_t offset)
 {
 	return (size_t)offset << REGF_BLOCK_SHIFT;
@@ -253,6 +278,127 @@ int region_file_init(struct region_file *f, const struct region_device *p)
 	return 0;
 }
 
+static struct regf_cache *regf_cache_get(void)
+{
+	struct regf_cache *cache;
+
+	/* cbmem_find() isn't safe in romstage before CBMEM is up. */
+	if (ENV_ROMSTAGE)
+		cache = car_get_var(cbmem_cache);
+	else
+		cache = cbmem_find(CBMEM_ID_REGF_CACHE);
+
+	if (cache == NULL)
+		cache = car_get_var_ptr(&early_cache);
+
+	return cache;
+}
+
+static void regf_cache_save(const struct region_file *f)
+{
+	struct regf_cache_entry *e;
+
+	if (!f->cache_entry)
+		return;
+
+	e = &regf_cache_get()->entries[f->cache_entry - 1];
+
+	/* A broken file is looked at again the next time. */
+	if (f->slot == RF_FATAL) {
+		memset(e, 0, sizeof(*e));
+		return;
+	}
+
+	e->size = region_device_sz(&f->rdev);
+	e->metadata_size = region_device_sz(&f->metadata);
+	e->data_blocks[0] = f->data_blocks[0];
+	e->data_blocks[1] = f->data_blocks[1];
+	e->slot = f->slot;
+}
+
+int region_file_init_named(struct region_file *f, const struct region_device *p,
+				const char *name)
+{
+	struct regf_cache *cache = regf_cache_get();
+	struct regf_cache_entry *e;
+	int i, free_entry = -1;
+
+	if (strlen(name) >= FMAP_STRLEN)
+		return region_file_init(f, p);
+
+	for (i = 0; i < REGF_CACHE_ENTRIES; i++) {
+		e = &cache->entries[i];
+
+		if (e->name[0] == '\0') {
+			if (free_entry < 0)
+				free_entry = i;
+			continue;
+		}
+
+		if (strcmp(e->name, name))
+			continue;
+
+		if (e->size != region_device_sz(p))
+			break;
+
+		memset(f, 0, sizeof(*f));
+		if (rdev_chain(&f->rdev, p, 0, e->size) ||
+		    rdev_chain(&f->metadata, p, 0, e->metadata_size))
+			break;
+		f->data_blocks[0] = e->data_blocks[0];
+		f->data_blocks[1] = e->data_blocks[1];
+		f->slot = e->slot;
+		f->cache_entry = i + 1;
+
+		return 0;
+	}
+
+	/* A name seen before whose state doesn't fit the region. */
+	if (i < REGF_CACHE_ENTRIES) {
+		free_entry = i;
+		memset(&cache->entries[i], 0, sizeof(cache->entries[i]));
+	}
+
+	if (region_file_init(f, p) < 0)
+		return -1;
+
+	if (free_entry >= 0) {
+		e = &cache->entries[free_entry];
+		strcpy(e->name, name);
+		f->cache_entry = free_entry + 1;
+		regf_cache_save(f);
+	}
+
+	return 0;
+}
+
+/* Ramstage finds the state romstage collected in CBMEM. */
+static void regf_cache_to_cbmem(int is_recovery)
+{
+	struct regf_cache *early = car_get_var_ptr(&early_cache);
+	struct regf_cache *cache;
+	int i;
+
+	for (i = 0; i < REGF_CACHE_ENTRIES; i++) {
+		if (early->entries[i].name[0] != '\0')
+			break;
+	}
+
+	/* Nothing was opened by name. What a previous boot left behind in
+	 * CBMEM may be out of date by now, so it is replaced nonetheless. */
+	if (i == REGF_CACHE_ENTRIES && !is_recovery)
+		return;
+
+	cache = cbmem_add(CBMEM_ID_REGF_CACHE, sizeof(*cache));
+	if (cache == NULL)
+		return;
+
+	memcpy(cache, early, sizeof(*cache));
+	car_set_var(cbmem_cache, cache);
+}
+
+ROMSTAGE_CBMEM_INIT_HOOK(regf_cache_to_cbmem)
+
 int region_file_data(const struct region_file *f, struct region_device *rdev)
 {
 
@@ -269,6 +415,33 @@ int region_file_data(const struct region_file *f, struct region_device *rdev)
 	return rdev_chain(rdev, &f->rdev, offset, size);
 }
 
+int region_file_data_prev(const struct region_file *f, size_t age,
+				struct region_device *rdev)
+{
+	uint16_t blocks[2];
+	size_t offset;
+	size_t size;
+
+	if (f->slot <= RF_ONLY_METADATA || age >= (size_t)f->slot)
+		return -1;
+
+	if (age == 0)
+		return region_file_data(f, rdev);
+
+	/* Slot n holds the end of update n, slot 0 the start of the data. */
+	offset = (f->slot - age - 1) * sizeof(blocks[0]);
+	if (rdev_readat(&f->metadata, blocks, offset, sizeof(blocks)) < 0)
+		return -1;
+
+	if (blocks[0] >= blocks[1] || block_offset_unallocated(blocks[1]))
+		return -1;
+
+	offset = block_to_bytes(blocks[0]);
+	size = block_to_bytes(blocks[1]) - offset;
+
+	return rdev_chain(rdev, &f->rdev, offset, size);
+}
+
 /*
  * Allocate enough metadata blocks to maximize data updates. Do this in
  * terms of blocks. To solve the balance of metadata vs data, 2 linear
@@ -470,5 +643,58 @@ int region_file_update_data(struct region_file *f, const void *buf, size_t size)
 			break;
 	}
 
+	regf_cache_save(f);
+
 	return ret;
 }
+
+int region_file_patch_data(struct region_file *f, const void *buf,
+				size_t size, void *scratch, size_t erase_size)
+{
+	size_t begin, end, sector;
+	uint8_t *s = scratch;
+	int patched = 0;
+
+	/* Only an update taking up the same blocks can be patched. */
+	if (f->slot <= RF_ONLY_METADATA)
+		return -1;
+
+	begin = block_to_bytes(region_file_data_begin(f));
+	end = begin + size;
+
+	if (bytes_to_block(ALIGN_UP(size, REGF_BLOCK_GRANULARITY)) !=
+		region_file_data_end(f) - region_file_data_begin(f))
+		return -1;
+
+	if (!erase_size || ALIGN_UP(end, erase_size) >
+		region_device_sz(&f->rdev))
+		return -1;
+
+	for (sector = ALIGN_DOWN(begin, erase_size); sector < end;
+		sector += erase_size) {
+		size_t from = MAX(sector, begin);
+		size_t to = MIN(sector + erase_size, end);
+
+		if (rdev_readat(&f->rdev, s, sector, erase_size) < 0)
+			return -1;
+
+		if (!memcmp(&s[from - sector], (const uint8_t *)buf +
+			from - begin, to - from))
+			continue;
+
+		/* Whatever else is in the sector is written back as is. */
+		memcpy(&s[from - sector], (const uint8_t *)buf + from - begin,
+			to - from);
+
+		if (rdev_eraseat(&f->rdev, sector, erase_size) < 0 ||
+			rdev_writeat(&f->rdev, s, sector, erase_size) < 0) {
+			printk(BIOS_ERR, "REGF failed to patch sector at %zx.\n",
+				sector);
+			return -1;
+		}
+
+		patched++;
+	}
+
+	return patched;
+}
@@ -22,6 +22,7 @@
 #include <console/console.h>
 #include <program_loading.h>
 #include <rmodule.h>
+#include <timestamp.h>
 
 /* Change this define to get more verbose debugging for module loading. */
 #define PK_ADJ_LEVEL BIOS_NEVER
@@ -54,7 +55,8 @@ int rmodule_parse(void *ptr, struct rmodule *module)
 	/* Sanity check the raw data. */
 	if (rhdr->magic != RMODULE_MAGIC)
 		return -1;
-	if (rhdr->version != RMODULE_VERSION_1)
+	if (rhdr->version != RMODULE_VERSION_1 &&
+	    rhdr->version != RMODULE_VERSION_2)
 		return -1;
 
 	/* Indicate the module hasn't been loaded yet. */
@@ -113,16 +115,6 @@ static void rmodule_clear_bss(struct rmodule *module)
 	memset(begin, 0, size);
 }
 
-static inline size_t rmodule_number_relocations(const struct rmodule *module)
-{
-	size_t r;
-
-	r = module->header->relocations_end_offset;
-	r -= module->header->relocations_begin_offset;
-	r /= sizeof(uintptr_t);
-	return r;
-}
-
 static void rmodule_copy_payload(const struct rmodule *module)
 {
 	printk(BIOS_DEBUG, "Loading module at %p with entry %p. "
@@ -138,35 +130,99 @@ static void rmodule_copy_payload(const struct rmodule *module)
 	memcpy(module->location, module->payload, module->payload_size);
 }
 
+static inline void rmodule_adjust(const struct rmodule *module,
+				  uintptr_t reloc, uintptr_t adjustment)
+{
+	uintptr_t *adjust_loc = rmodule_load_addr(module, reloc);
+
+	printk(PK_ADJ_LEVEL, "Adjusting %p: 0x%08lx -> 0x%08lx\n",
+	       adjust_loc, (unsigned long) *adjust_loc,
+	       (unsigned long) (*adjust_loc + adjustment));
+	*adjust_loc += adjustment;
+}
+
+static inline uintptr_t rmodule_read_varint(const uint8_t **ptr)
+{
+	const uint8_t *p = *ptr;
+	uintptr_t value = 0;
+	unsigned int shift = 0;
+	uint8_t byte;
+
+	do {
+		byte = *p++;
+		value |= (uintptr_t)(byte & ~RMODULE_VARINT_MORE) << shift;
+		shift += RMODULE_VARINT_BITS;
+	} while (byte & RMODULE_VARINT_MORE);
+
+	*ptr = p;
+	return value;
+}
+
+static size_t rmodule_relocate_flat(const struct rmodule *module,
+				    uintptr_t adjustment)
+{
+	const uintptr_t *reloc = module->relocations;
+	size_t num_relocations;
+
+	num_relocations = module->header->relocations_end_offset -
+			  module->header->relocations_begin_offset;
+	num_relocations /= sizeof(uintptr_t);
+
+	for (size_t i = 0; i < num_relocations; i++)
+		rmodule_adjust(module, reloc[i], adjustment);
+
+	return num_relocations;
+}
+
+static size_t rmodule_relocate_packed(const struct rmodule *module,
+				      uintptr_t adjustment)
+{
+	const uint8_t *p = module->relocations;
+	const uint8_t *end = p + module->header->relocations_end_offset -
+			     module->header->relocations_begin_offset;
+	uintptr_t reloc = module->header->module_link_start_address;
+	size_t num_relocations = 0;
+
+	while (p < end) {
+		uintptr_t record = rmodule_read_varint(&p);
+		size_t run = 0;
+
+		if (record & 1)
+			run = rmodule_read_varint(&p);
+
+		reloc += record >> 1;
+		rmodule_adjust(module, reloc, adjustment);
+
+		num_relocations += run + 1;
+		while (run--) {
+			reloc += sizeof(uintptr_t);
+			rmodule_adjust(module, reloc, adjustment);
+		}
+	}
+
+	return num_relocations;
+}
+
 static int rmodule_relocate(const struct rmodule *module)
 {
 	size_t num_relocations;
-	const uintptr_t *reloc;
 	uintptr_t adjustment;
 
 	/* Each relocation needs to be adjusted relative to the beginning of
 	 * the loaded program. */
 	adjustment = (uintptr_t)rmodule_load_addr(module, 0);
 
-	reloc = module->relocations;
-	num_relocations = rmodule_number_relocations(module);
-
-	printk(BIOS_DEBUG, "Processing %zu relocs. Offset value of 0x%08lx\n",
-	       num_relocations, (unsigned long)adjustment);
+	timestamp_add_now(TS_START_RMODULE_RELOC);
 
-	while (num_relocations > 0) {
-		uintptr_t *adjust_loc;
+	if (module->header->version == RMODULE_VERSION_1)
+		num_relocations = rmodule_relocate_flat(module, adjustment);
+	else
+		num_relocations = rmodule_relocate_packed(module, adjustment);
 
-		/* If the adjustment location is non-NULL adjust it. */
-		adjust_loc = rmodule_load_addr(module, *reloc);
-		printk(PK_ADJ_LEVEL, "Adjusting %p: 0x%08lx -> 0x%08lx\n",
-		       adjust_loc, (unsigned long) *adjust_loc,
-		       (unsigned long) (*adjust_loc + adjustment));
-		*adjust_loc += adjustment;
+	timestamp_add_now(TS_END_RMODULE_RELOC);
 
-		reloc++;
-		num_relocations--;
-	}
+	printk(BIOS_DEBUG, "Processed %zu relocs. Offset value of 0x%08lx\n",
+	       num_relocations, (unsigned long)adjustment);
 
 	return 0;
 }
@@ -30,6 +30,11 @@
 #include <timestamp.h>
 #include <cbmem.h>
 
+#if IS_ENABLED(CONFIG_SELF_PARALLEL_DECOMPRESS)
+#include <cpu/x86/mp.h>
+#include <timer.h>
+#endif
+
 static const unsigned long lb_start = (unsigned long)&_program;
 static const unsigned long lb_end = (unsigned long)&_eprogram;
 
@@ -37,10 +42,15 @@ struct segment {
 	struct segment *next;
 	struct segment *prev;
 	unsigned long s_dstaddr;
+	/* Offset of the data from the start of the payload. */
 	unsigned long s_srcaddr;
 	unsigned long s_memsz;
 	unsigned long s_filesz;
 	int compression;
+	/* Set when the data was decompressed ahead of the serial loading. */
+	int preloaded;
+	const void *map;
+	size_t loaded;
 };
 
 static void segment_insert_before(struct segment *seg, struct segment *new)
@@ -240,22 +250,26 @@ static void cbfs_decode_payload_segment(struct cbfs_payload_segment *segment,
 
 static int build_self_segment_list(
 	struct segment *head,
-	struct cbfs_payload *cbfs_payload, uintptr_t *entry)
+	const struct region_device *rdev, uintptr_t *entry)
 {
 	struct segment *new;
-	struct cbfs_payload_segment *current_segment, *first_segment, segment;
+	struct cbfs_payload_segment raw_segment, segment;
+	size_t offset;
 
 	memset(head, 0, sizeof(*head));
 	head->next = head->prev = head;
 
-	first_segment = &cbfs_payload->segments;
-
-	for (current_segment = first_segment;; ++current_segment) {
+	/* The segment table starts the payload, the data follows it. */
+	for (offset = 0;; offset += sizeof(raw_segment)) {
 		printk(BIOS_DEBUG,
-			"Loading segment from ROM address 0x%p\n",
-			current_segment);
+			"Loading segment from payload offset 0x%zx\n", offset);
 
-		cbfs_decode_payload_segment(&segment, current_segment);
+		if (rdev_readat(rdev, &raw_segment, offset,
+				sizeof(raw_segment)) != sizeof(raw_segment)) {
+			printk(BIOS_ERR, "Could not read the segment table\n");
+			return 0;
+		}
+		cbfs_decode_payload_segment(&segment, &raw_segment);
 
 		switch (segment.type) {
 		case PAYLOAD_SEGMENT_PARAMS:
@@ -269,12 +283,11 @@ static int build_self_segment_list(
 				?  "code" : "data", segment.compression);
 
 			new = malloc(sizeof(*new));
+			memset(new, 0, sizeof(*new));
 			new->s_dstaddr = segment.load_addr;
 			new->s_memsz = segment.mem_len;
 			new->compression = segment.compression;
-			new->s_srcaddr = (uintptr_t)
-				((unsigned char *)first_segment)
-				+ segment.offset;
+			new->s_srcaddr = segment.offset;
 			new->s_filesz = segment.len;
 
 			printk(BIOS_DEBUG,
@@ -296,10 +309,9 @@ static int build_self_segment_list(
 				(intptr_t)segment.load_addr, segment.mem_len);
 
 			new = malloc(sizeof(*new));
+			memset(new, 0, sizeof(*new));
 			new->s_filesz = 0;
-			new->s_srcaddr = (uintptr_t)
-				((unsigned char *)first_segment)
-				+ segment.offset;
+			new->s_srcaddr = segment.offset;
 			new->s_dstaddr = segment.load_addr;
 			new->s_memsz = segment.mem_len;
 			new->compression = CBFS_COMPRESS_NONE;
@@ -371,9 +383,173 @@ static int payload_targets_usable_ram(struct segment *head)
 	return 1;
 }
 
+/* Returns the number of bytes loaded, 0 on error unless there is no data. */
+static size_t load_segment(const struct region_device *rdev,
+			   struct segment *seg)
+{
+	void *dest = (void *)seg->s_dstaddr;
+	size_t len;
+	void *map;
+
+	switch (seg->compression) {
+	case CBFS_COMPRESS_LZMA:
+		printk(BIOS_DEBUG, "using LZMA\n");
+		return cbfs_load_and_decompress(rdev, seg->s_srcaddr,
+				seg->s_filesz, dest, seg->s_memsz,
+				CBFS_COMPRESS_LZMA);
+
+	case CBFS_COMPRESS_LZ4:
+		printk(BIOS_DEBUG, "using LZ4\n");
+		/*
+		 * Off media which isn't memory mapped the data is read to the
+		 * end of the segment and decompressed in place instead of
+		 * going through a mapping. That fails cleanly when there is
+		 * not enough room behind the data.
+		 */
+		if (!IS_ENABLED(CONFIG_BOOT_DEVICE_MEMORY_MAPPED) &&
+		    seg->s_memsz >= seg->s_filesz) {
+			len = cbfs_load_and_decompress(rdev, seg->s_srcaddr,
+					seg->s_filesz, dest, seg->s_memsz,
+					CBFS_COMPRESS_LZ4);
+			if (len)
+				return len;
+			printk(BIOS_DEBUG, "no room to decompress in place\n");
+		}
+
+		map = rdev_mmap(rdev, seg->s_srcaddr, seg->s_filesz);
+		if (map == NULL)
+			return 0;
+		timestamp_add_now(TS_START_ULZ4F);
+		len = ulz4fn(map, seg->s_filesz, dest, seg->s_memsz);
+		timestamp_add_now(TS_END_ULZ4F);
+		rdev_munmap(rdev, map);
+		return len;
+
+	case CBFS_COMPRESS_NONE:
+		printk(BIOS_DEBUG, "it's not compressed!\n");
+		if (!seg->s_filesz)
+			return 0;
+		if (rdev_readat(rdev, dest, seg->s_srcaddr, seg->s_filesz) !=
+		    seg->s_filesz)
+			return 0;
+		return seg->s_filesz;
+
+	default:
+		printk(BIOS_INFO,  "CBFS:  Unknown compression type %d\n",
+			seg->compression);
+		return 0;
+	}
+}
+
+#if IS_ENABLED(CONFIG_SELF_PARALLEL_DECOMPRESS)
+#define SELF_LOAD_JOBS	MIN(CONFIG_MAX_CPUS, 4)
+
+struct decompress_job {
+	struct segment *head;
+	unsigned int index;
+	unsigned int num;
+};
+
+static struct decompress_job decompress_jobs[SELF_LOAD_JOBS];
+static struct mp_job mp_jobs[SELF_LOAD_JOBS];
+static uint8_t lzma_scratch[SELF_LOAD_JOBS][ULZMAN_SCRATCH_SIZE];
+
+/* Job n takes every num'th of the mapped segments, starting at the n'th. */
+static void decompress_job(void *arg)
+{
+	const struct decompress_job *job = arg;
+	struct segment *ptr;
+	unsigned int i = 0;
+
+	for (ptr = job->head->next; ptr != job->head; ptr = ptr->next) {
+		if (ptr->map == NULL || i++ % job->num != job->index)
+			continue;
+
+		if (ptr->compression == CBFS_COMPRESS_LZMA)
+			ptr->loaded = ulzman_scratch(ptr->map, ptr->s_filesz,
+					(void *)ptr->s_dstaddr, ptr->s_memsz,
+					lzma_scratch[job->index]);
+		else
+			ptr->loaded = ulz4fn(ptr->map, ptr->s_filesz,
+					(void *)ptr->s_dstaddr, ptr->s_memsz);
+	}
+}
+
+static int segments_overlap(const struct segment *a, const struct segment *b)
+{
+	return a->s_dstaddr < b->s_dstaddr + b->s_memsz &&
+	       b->s_dstaddr < a->s_dstaddr + a->s_memsz;
+}
+
+/*
+ * Decompress the compressed segments on the BSP and the APs at the same time,
+ * leaving everything else to the serial loading. Only done when no segment
+ * overlaps another, so that the order of loading doesn't matter.
+ */
+static void decompress_in_parallel(const struct region_device *rdev,
+				   struct segment *head)
+{
+	struct segment *ptr, *other;
+	struct stopwatch sw;
+	unsigned int num = 0, i;
+
+	for (ptr = head->next; ptr != head; ptr = ptr->next) {
+		for (other = ptr->next; other != head; other = other->next) {
+			if (segments_overlap(ptr, other))
+				return;
+		}
+		if (ptr->s_filesz && (ptr->compression == CBFS_COMPRESS_LZMA ||
+				      ptr->compression == CBFS_COMPRESS_LZ4))
+			num++;
+	}
+
+	if (num < 2)
+		return;
+
+	num = 0;
+	for (ptr = head->next; ptr != head; ptr = ptr->next) {
+		if (!ptr->s_filesz || (ptr->compression != CBFS_COMPRESS_LZMA &&
+				       ptr->compression != CBFS_COMPRESS_LZ4))
+			continue;
+		ptr->map = rdev_mmap(rdev, ptr->s_srcaddr, ptr->s_filesz);
+		if (ptr->map != NULL)
+			num++;
+	}
+	num = MIN(num, SELF_LOAD_JOBS);
+
+	for (i = 0; i < num; i++) {
+		decompress_jobs[i].head = head;
+		decompress_jobs[i].index = i;
+		decompress_jobs[i].num = num;
+		mp_jobs[i].func = decompress_job;
+		mp_jobs[i].arg = &decompress_jobs[i];
+	}
+
+	stopwatch_init(&sw);
+	if (num && mp_run_jobs(mp_jobs, num, 0) == 0) {
+		for (ptr = head->next; ptr != head; ptr = ptr->next)
+			ptr->preloaded = ptr->map != NULL;
+		printk(BIOS_DEBUG, "Decompressed segments in %u jobs in %ld us\n",
+		       num, stopwatch_duration_usecs(&sw));
+	}
+
+	for (ptr = head->next; ptr != head; ptr = ptr->next) {
+		if (ptr->map != NULL)
+			rdev_munmap(rdev, (void *)ptr->map);
+		ptr->map = NULL;
+	}
+}
+#else
+static void decompress_in_parallel(const struct region_device *rdev,
+				   struct segment *head)
+{
+}
+#endif
+
 static int load_self_segments(struct segment *head, struct prog *payload,
 			      bool check_regions)
 {
+	const struct region_device *rdev = prog_rdev(payload);
 	struct segment *ptr;
 	unsigned long bounce_high = lb_end;
 
@@ -404,69 +580,42 @@ static int load_self_segments(struct segment *head, struct prog *payload,
 		return 0;
 	}
 
+	/* Modify the segments to load onto the bounce_buffer if necessary.
+	 * A piece split off in front of a segment is visited next. */
 	for (ptr = head->next; ptr != head; ptr = ptr->next) {
-		unsigned char *dest, *src, *middle, *end;
-		size_t len, memsz;
-		printk(BIOS_DEBUG,
-			"Loading Segment: addr: 0x%016lx memsz: 0x%016lx filesz: 0x%016lx\n",
-			ptr->s_dstaddr, ptr->s_memsz, ptr->s_filesz);
-
-		/* Modify the segment to load onto the bounce_buffer if
-		 * necessary.
-		 */
-		if (relocate_segment(bounce_buffer, ptr)) {
+		if (relocate_segment(bounce_buffer, ptr))
 			ptr = (ptr->prev)->prev;
-			continue;
-		}
+	}
+
+	decompress_in_parallel(rdev, head);
 
+	for (ptr = head->next; ptr != head; ptr = ptr->next) {
+		unsigned char *dest, *middle, *end;
+		size_t len;
 		printk(BIOS_DEBUG,
-			"Post relocation: addr: 0x%016lx memsz: 0x%016lx filesz: 0x%016lx\n",
+			"Loading Segment: addr: 0x%016lx memsz: 0x%016lx filesz: 0x%016lx\n",
 			ptr->s_dstaddr, ptr->s_memsz, ptr->s_filesz);
 
 		/* Compute the boundaries of the segment */
 		dest = (unsigned char *)(ptr->s_dstaddr);
-		src = (unsigned char *)(ptr->s_srcaddr);
-		len = ptr->s_filesz;
-		memsz = ptr->s_memsz;
-		end = dest + memsz;
-
-		/* Copy data from the initial buffer */
-		switch (ptr->compression) {
-		case CBFS_COMPRESS_LZMA: {
-			printk(BIOS_DEBUG, "using LZMA\n");
-			timestamp_add_now(TS_START_ULZMA);
-			len = ulzman(src, len, dest, memsz);
-			timestamp_add_now(TS_END_ULZMA);
-			if (!len) /* Decompression Error. */
-				return 0;
-			break;
-		}
-		case CBFS_COMPRESS_LZ4: {
-			printk(BIOS_DEBUG, "using LZ4\n");
-			timestamp_add_now(TS_START_ULZ4F);
-			len = ulz4fn(src, len, dest, memsz);
-			timestamp_add_now(TS_END_ULZ4F);
-			if (!len) /* Decompression Error. */
-				return 0;
-			break;
-		}
-		case CBFS_COMPRESS_NONE: {
-			printk(BIOS_DEBUG, "it's not compressed!\n");
-			memcpy(dest, src, len);
-			break;
-		}
-		default:
-			printk(BIOS_INFO,  "CBFS:  Unknown compression type %d\n",
-				ptr->compression);
-			return -1;
+		end = dest + ptr->s_memsz;
+
+		if (ptr->preloaded)
+			len = ptr->loaded;
+		else
+			len = load_segment(rdev, ptr);
+		if (!len && ptr->s_filesz) {
+			printk(BIOS_ERR, "Could not load the segment\n");
+			return 0;
 		}
+
 		/* Calculate middle after any changes to len. */
 		middle = dest + len;
 		printk(BIOS_SPEW, "[ 0x%08lx, %08lx, 0x%08lx) <- %08lx\n",
 			(unsigned long)dest,
 			(unsigned long)middle,
 			(unsigned long)end,
-			(unsigned long)src);
+			ptr->s_srcaddr);
 
 		/* Zero the extra bytes between middle & end */
 		if (middle < end) {
@@ -525,25 +674,17 @@ bool selfload(struct prog *payload, bool check_regions)
 {
 	uintptr_t entry = 0;
 	struct segment head;
-	void *data;
-
-	data = rdev_mmap_full(prog_rdev(payload));
-
-	if (data == NULL)
-		return false;
 
 	/* Preprocess the self segments */
-	if (!build_self_segment_list(&head, data, &entry))
-		goto out;
+	if (!build_self_segment_list(&head, prog_rdev(payload), &entry))
+		return false;
 
 	/* Load the segments */
 	if (!load_self_segments(&head, payload, check_regions))
-		goto out;
+		return false;
 
 	printk(BIOS_SPEW, "Loaded segments\n");
 
-	rdev_munmap(prog_rdev(payload), data);
-
 	/* Update the payload's area with the bounce buffer information. */
 	prog_set_area(payload, (void *)(uintptr_t)bounce_buffer, bounce_size);
 
@@ -551,7 +692,4 @@ bool selfload(struct prog *payload, bool check_regions)
 	prog_set_entry(payload, (void *)entry, cbmem_find(CBMEM_ID_CBTABLE));
 
 	return true;
-out:
-	rdev_munmap(prog_rdev(payload), data);
-	return false;
 }
@@ -15,13 +15,28 @@
 
 #include <arch/byteorder.h>
 #include <cbfs.h>
+#include <cbmem.h>
 #include <console/console.h>
+#include <mrc_cache.h>
 #include <spd_bin.h>
 #include <string.h>
 #include <device/early_smbus.h>
 #include <device/dram/ddr3.h>
 
+/* What is read from a DIMM to tell whether its cached SPD is still good. */
+#define SPD_CRC_OFF		126
+#define SPD_CRC_LEN		2
+#define DDR3_SPD_SERIAL_OFF	122
+#define DDR4_SPD_SERIAL_OFF	325
+#define SPD_SERIAL_LEN		4
+
+#define SPD_CACHE_VERSION	1
+
+/* I2C block reads are kept to the SMBus block size. */
+#define SPD_BLOCK_LEN		32
+
 static u8 spd_data[CONFIG_DIMM_MAX * CONFIG_DIMM_SPD_SIZE] CAR_GLOBAL;
+static int spd_data_read CAR_GLOBAL;
 
 void dump_spd_info(struct spd_block *blk)
 {
@@ -125,11 +140,29 @@ int get_spd_cbfs_rdev(struct region_device *spd_rdev, u8 spd_index)
 							CONFIG_DIMM_SPD_SIZE);
 }
 
+static int smbus_read_spd_blocks(u8 *spd, u8 addr)
+{
+	u16 i;
+
+	for (i = 0; i < SPD_PAGE_LEN; i += SPD_BLOCK_LEN) {
+		if (smbus_i2c_block_read(0, addr, i, SPD_BLOCK_LEN, &spd[i]) !=
+		    SPD_BLOCK_LEN)
+			return -1;
+	}
+
+	return 0;
+}
+
 static void smbus_read_spd(u8 *spd, u8 addr)
 {
 	u16 i;
 	u8 step = 1;
 
+	/* Fall back to reading the page piece by piece if that fails. */
+	if (IS_ENABLED(CONFIG_SMBUS_HAS_I2C_BLOCK_READ) &&
+	    smbus_read_spd_blocks(spd, addr) == 0)
+		return;
+
 	if (IS_ENABLED(CONFIG_SPD_READ_BY_WORD))
 		step = sizeof(uint16_t);
 
@@ -142,7 +175,62 @@ static void smbus_read_spd(u8 *spd, u8 addr)
 	}
 }
 
-static void get_spd(u8 *spd, u8 addr)
+static int smbus_spd_matches(const u8 *spd, u8 addr, u16 offset, u16 len)
+{
+	u16 i;
+
+	for (i = offset; i < offset + len; i++) {
+		if (smbus_read_byte(0, addr, i % SPD_PAGE_LEN) != spd[i])
+			return 0;
+	}
+
+	return 1;
+}
+
+/* Compare the few bytes telling DIMMs apart with the cached SPD. */
+static int spd_cache_matches(const u8 *spd, u8 addr)
+{
+	int match;
+
+	if (smbus_read_byte(0, addr, SPD_DRAM_TYPE) != spd[SPD_DRAM_TYPE])
+		return 0;
+
+	if (!smbus_spd_matches(spd, addr, SPD_CRC_OFF, SPD_CRC_LEN))
+		return 0;
+
+	if (spd[SPD_DRAM_TYPE] != SPD_DRAM_DDR4)
+		return smbus_spd_matches(spd, addr, DDR3_SPD_SERIAL_OFF,
+					 SPD_SERIAL_LEN);
+
+	/* Without the second page there is no serial number to compare. */
+	if (CONFIG_DIMM_SPD_SIZE <= SPD_PAGE_LEN)
+		return 1;
+
+	smbus_write_byte(0, SPD_PAGE_1, 0, 0);
+	match = smbus_spd_matches(spd, addr, DDR4_SPD_SERIAL_OFF,
+				  SPD_SERIAL_LEN);
+	smbus_write_byte(0, SPD_PAGE_0, 0, 0);
+
+	return match;
+}
+
+static int spd_cache_load(u8 *spd, size_t size)
+{
+	struct region_device rdev;
+
+	if (!IS_ENABLED(CONFIG_SPD_CACHE))
+		return 0;
+
+	if (mrc_cache_get_current(MRC_SPD_DATA, SPD_CACHE_VERSION, &rdev) < 0)
+		return 0;
+
+	if (region_device_sz(&rdev) != size)
+		return 0;
+
+	return rdev_readat(&rdev, spd, 0, size) == size;
+}
+
+static void get_spd(u8 *spd, u8 addr, int cached)
 {
 	if (smbus_read_byte(0, addr, 0) == 0xff) {
 		printk(BIOS_INFO, "No memory dimm at address %02X\n",
@@ -151,6 +239,12 @@ static void get_spd(u8 *spd, u8 addr)
 		memset(spd, 0, CONFIG_DIMM_SPD_SIZE);
 		return;
 	}
+
+	if (cached && spd_cache_matches(spd, addr)) {
+		printk(BIOS_DEBUG, "SPD @ 0x%02X is cached\n", addr << 1);
+		return;
+	}
+
 	smbus_read_spd(spd, addr);
 
 	/* Check if module is DDR4, DDR4 spd is 512 byte. */
@@ -168,16 +262,39 @@ void get_spd_smbus(struct spd_block *blk)
 {
 	u8 i;
 	unsigned char *spd_data_ptr = car_get_var_ptr(&spd_data);
+	int cached;
 
-	for (i = 0 ; i < CONFIG_DIMM_MAX; i++) {
-		get_spd(spd_data_ptr + i * CONFIG_DIMM_SPD_SIZE,
-			blk->addr_map[i]);
-		blk->spd_array[i] = spd_data_ptr + i * CONFIG_DIMM_SPD_SIZE;
+	/* Asking twice doesn't read the DIMMs again. */
+	if (!car_get_var(spd_data_read)) {
+		cached = spd_cache_load(spd_data_ptr, sizeof(spd_data));
+
+		for (i = 0 ; i < CONFIG_DIMM_MAX; i++)
+			get_spd(spd_data_ptr + i * CONFIG_DIMM_SPD_SIZE,
+				blk->addr_map[i], cached);
+
+		car_set_var(spd_data_read, 1);
 	}
 
+	for (i = 0 ; i < CONFIG_DIMM_MAX; i++)
+		blk->spd_array[i] = spd_data_ptr + i * CONFIG_DIMM_SPD_SIZE;
+
 	update_spd_len(blk);
 }
 
+/* The MRC cache only writes to flash when something changed. */
+static void spd_cache_stash(int is_recovery)
+{
+	if (!IS_ENABLED(CONFIG_SPD_CACHE) || !car_get_var(spd_data_read))
+		return;
+
+	if (mrc_cache_stash_data(MRC_SPD_DATA, SPD_CACHE_VERSION,
+				 car_get_var_ptr(&spd_data),
+				 sizeof(spd_data)) < 0)
+		printk(BIOS_ERR, "SPD: failed to stash the SPD data\n");
+}
+
+ROMSTAGE_CBMEM_INIT_HOOK(spd_cache_stash)
+
 #if CONFIG_DIMM_SPD_SIZE == 128
 int read_ddr3_spd_from_cbfs(u8 *buf, int idx)
 {
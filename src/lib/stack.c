@@ -27,6 +27,20 @@ it with the version available from LANL.
 #include <console/console.h>
 #include <symbols.h>
 
+size_t stack_used(const void *stack, size_t size)
+{
+	const u32 *words = stack;
+	size_t i;
+
+	/* Stacks grow down, the paint is left at the bottom. */
+	for (i = 0; i < size / sizeof(*words); i++) {
+		if (words[i] != 0xDEADBEEF)
+			break;
+	}
+
+	return size - i * sizeof(*words);
+}
+
 int checkstack(void *top_of_stack, int core)
 {
 	/* Not all archs use CONFIG_STACK_SIZE, those who don't set it to 0. */
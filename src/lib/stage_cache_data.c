@@ -0,0 +1,127 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <bootstate.h>
+#include <commonlib/compression.h>
+#include <console/console.h>
+#include <rules.h>
+#include <stage_cache.h>
+#include <string.h>
+#include <symbols.h>
+
+/* CRC-32 (IEEE 802.3) a nibble at a time for a small table. */
+static uint32_t crc32(const void *buf, size_t size)
+{
+	static const uint32_t table[16] = {
+		0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+		0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+		0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+		0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+	};
+	const uint8_t *p = buf;
+	uint32_t crc = ~0U;
+
+	while (size--) {
+		crc ^= *p++;
+		crc = (crc >> 4) ^ table[crc & 0xf];
+		crc = (crc >> 4) ^ table[crc & 0xf];
+	}
+
+	return ~crc;
+}
+
+size_t stage_cache_data_size(const struct prog *stage)
+{
+	if (!IS_ENABLED(CONFIG_STAGE_CACHE_COMPRESS))
+		return prog_size(stage);
+
+	return lz4f_compress(prog_start(stage), prog_size(stage), NULL, 0);
+}
+
+void stage_cache_data_save(void *c, size_t size, const struct prog *stage,
+			   struct stage_cache *meta)
+{
+	meta->size = prog_size(stage);
+	meta->checksum = 0;
+	meta->rw_offset = 0;
+	meta->rw_size = 0;
+
+	if (!IS_ENABLED(CONFIG_STAGE_CACHE_COMPRESS)) {
+		memcpy(c, prog_start(stage), prog_size(stage));
+		return;
+	}
+
+	meta->checksum = crc32(prog_start(stage), prog_size(stage));
+	lz4f_compress(prog_start(stage), prog_size(stage), c, size);
+
+	printk(BIOS_DEBUG, "Stage cache: %zu bytes compressed to %zu\n",
+	       prog_size(stage), size);
+}
+
+int stage_cache_data_load(const struct stage_cache *meta, const void *c,
+			  size_t size)
+{
+	void *load_addr = (void *)(uintptr_t)meta->load_addr;
+
+	/* The rest of the stage is still in place from the last boot. */
+	if (IS_ENABLED(CONFIG_STAGE_CACHE_IN_PLACE) && meta->rw_size) {
+		memcpy((uint8_t *)load_addr + meta->rw_offset,
+		       (const uint8_t *)c + meta->rw_offset, meta->rw_size);
+		printk(BIOS_DEBUG, "Stage cache: restored %u of %u bytes in "
+		       "place\n", meta->rw_size, meta->size);
+		return 0;
+	}
+
+	if (!IS_ENABLED(CONFIG_STAGE_CACHE_COMPRESS)) {
+		memcpy(load_addr, c, size);
+		return 0;
+	}
+
+	if (ulz4fn(c, size, load_addr, meta->size) != meta->size) {
+		printk(BIOS_ERR, "Stage cache: failed to decompress\n");
+		return -1;
+	}
+
+	if (crc32(load_addr, meta->size) != meta->checksum) {
+		printk(BIOS_ERR, "Stage cache: checksum mismatch\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+int stage_cache_data_writable(struct stage_cache *meta, const void *start,
+			      size_t size)
+{
+	uintptr_t offset = (uintptr_t)start - (uintptr_t)meta->load_addr;
+
+	if ((uintptr_t)start < meta->load_addr || offset > meta->size ||
+	    size > meta->size - offset)
+		return -1;
+
+	meta->rw_offset = offset;
+	meta->rw_size = size;
+
+	return 0;
+}
+
+#if ENV_RAMSTAGE && IS_ENABLED(CONFIG_STAGE_CACHE_IN_PLACE)
+/* Nothing before data, bss and the heap is written while ramstage runs. */
+static void stage_cache_ramstage_writable(void *unused)
+{
+	stage_cache_set_writable(STAGE_RAMSTAGE, _data, _eprogram - _data);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_PRE_DEVICE, BS_ON_ENTRY,
+		      stage_cache_ramstage_writable, NULL);
+#endif
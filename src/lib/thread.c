@@ -21,6 +21,7 @@
 #include <thread.h>
 
 static void idle_thread_init(void);
+static void schedule(struct thread *t);
 
 /* There needs to be at least one thread to run the ramstate state machine. */
 #define TOTAL_NUM_THREADS (CONFIG_NUM_THREADS + 1)
@@ -75,9 +76,14 @@ static inline void push_thread(struct thread **list, struct thread *t)
 	*list = t;
 }
 
+/* Queue t in front of all runnable threads of the same or lower priority. */
 static inline void push_runnable(struct thread *t)
 {
-	push_thread(&runnable_threads, t);
+	struct thread **list = &runnable_threads;
+
+	while (*list != NULL && (*list)->priority > t->priority)
+		list = &(*list)->next;
+	push_thread(list, t);
 }
 
 static inline struct thread *pop_runnable(void)
@@ -106,6 +112,9 @@ static inline struct thread *get_free_thread(void)
 	/* Reset the current stack value to the original. */
 	t->stack_current = t->stack_orig;
 
+	t->priority = THREAD_PRIORITY_NORMAL;
+	t->handle = NULL;
+
 	return t;
 }
 
@@ -121,8 +130,12 @@ static void idle_thread(void *unused)
 {
 	/* This thread never voluntarily yields. */
 	thread_prevent_coop();
-	while (1)
+	while (1) {
 		timers_run();
+		/* Hand over to whatever the timers made runnable. */
+		if (!thread_list_empty(&runnable_threads))
+			schedule(pop_runnable());
+	}
 }
 
 static void schedule(struct thread *t)
@@ -143,6 +156,10 @@ static void schedule(struct thread *t)
 
 static void terminate_thread(struct thread *t)
 {
+	if (t->handle != NULL) {
+		t->handle->state = THREAD_DONE;
+		thread_wake_all(&t->handle->joiners);
+	}
 	free_thread(t);
 	schedule(NULL);
 }
@@ -218,6 +235,7 @@ static void idle_thread_init(void)
 
 	/* Queue idle thread to run once all other threads have yielded. */
 	prepare_thread(t, idle_thread, NULL, call_wrapper, NULL);
+	t->priority = THREAD_PRIORITY_IDLE;
 	push_runnable(t);
 	/* Mark the currently executing thread to cooperate. */
 	thread_cooperate();
@@ -279,7 +297,7 @@ void threads_initialize(void)
 	idle_thread_init();
 }
 
-int thread_run(void (*func)(void *), void *arg)
+int thread_run(struct thread_handle *handle, void (*func)(void *), void *arg)
 {
 	struct thread *current;
 	struct thread *t;
@@ -299,6 +317,12 @@ int thread_run(void (*func)(void *), void *arg)
 		return -1;
 	}
 
+	if (handle != NULL) {
+		handle->state = THREAD_STARTED;
+		handle->joiners.waiters = NULL;
+		t->handle = handle;
+	}
+
 	prepare_thread(t, func, arg, call_wrapper_block_current, NULL);
 	schedule(t);
 
@@ -352,6 +376,80 @@ int thread_yield_microseconds(unsigned int microsecs)
 	return 0;
 }
 
+int thread_wait(struct thread_waitq *waitq)
+{
+	struct thread *current;
+
+	current = current_thread();
+
+	if (!thread_can_yield(current))
+		return -1;
+
+	push_thread(&waitq->waiters, current);
+	schedule(NULL);
+
+	return 0;
+}
+
+int thread_wake_all(struct thread_waitq *waitq)
+{
+	int woken = 0;
+
+	while (!thread_list_empty(&waitq->waiters)) {
+		push_runnable(pop_thread(&waitq->waiters));
+		woken++;
+	}
+
+	return woken;
+}
+
+int thread_join(struct thread_handle *handle)
+{
+	if (handle->state == THREAD_INIT)
+		return -1;
+
+	while (handle->state != THREAD_DONE) {
+		if (thread_wait(&handle->joiners))
+			return -1;
+	}
+
+	return 0;
+}
+
+int thread_sem_down(struct thread_sem *sem)
+{
+	while (sem->count == 0) {
+		if (thread_wait(&sem->waitq))
+			return -1;
+	}
+
+	sem->count--;
+
+	return 0;
+}
+
+void thread_sem_up(struct thread_sem *sem)
+{
+	sem->count++;
+	thread_wake_all(&sem->waitq);
+}
+
+int thread_set_priority(int priority)
+{
+	struct thread *current;
+	int old;
+
+	current = current_thread();
+
+	if (current == NULL)
+		return THREAD_PRIORITY_NORMAL;
+
+	old = current->priority;
+	current->priority = priority;
+
+	return old;
+}
+
 void thread_cooperate(void)
 {
 	struct thread *current;
@@ -15,11 +15,15 @@
  */
 
 #include <assert.h>
+#include <bootstate.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <compiler.h>
 #include <console/console.h>
 #include <cbmem.h>
+#include <elog.h>
+#include <smp/spinlock.h>
+#include <string.h>
 #include <symbols.h>
 #include <timer.h>
 #include <timestamp.h>
@@ -27,7 +31,7 @@
 #include <rules.h>
 #include <smp/node.h>
 
-#define MAX_TIMESTAMPS 192
+#define MAX_TIMESTAMPS CONFIG_TIMESTAMPS_CBMEM_ENTRIES
 
 /* When changing this number, adjust TIMESTAMP() size ASSERT() in memlayout.h */
 #define MAX_BSS_TIMESTAMP_CACHE 16
@@ -154,10 +158,14 @@ static struct timestamp_table *timestamp_table_get(void)
 	return ts_table;
 }
 
-static const char *timestamp_name(enum timestamp_id id)
+static const char *timestamp_name(uint32_t id)
 {
 	int i;
 
+	id &= ~TIMESTAMP_SPAN_MASK;
+	if (id & TIMESTAMP_CUSTOM)
+		return "Custom timestamp ID";
+
 	for (i = 0; i < ARRAY_SIZE(timestamp_ids); i++) {
 		if (timestamp_ids[i].id == id)
 			return timestamp_ids[i].name;
@@ -167,7 +175,7 @@ static const char *timestamp_name(enum timestamp_id id)
 }
 
 static void timestamp_add_table_entry(struct timestamp_table *ts_table,
-				      enum timestamp_id id, uint64_t ts_time)
+				      uint32_t id, uint64_t ts_time)
 {
 	struct timestamp_entry *tse;
 
@@ -186,10 +194,117 @@ static void timestamp_add_table_entry(struct timestamp_table *ts_table,
 		printk(BIOS_ERR, "ERROR: Timestamp table full\n");
 }
 
-void timestamp_add(enum timestamp_id id, uint64_t ts_time)
+#define TIMESTAMP_PER_CPU \
+	(IS_ENABLED(CONFIG_TIMESTAMPS_PER_CPU) && ENV_RAMSTAGE)
+
+#if TIMESTAMP_PER_CPU
+/*
+ * Each AP only appends to its own buffer and the BSP keeps track of how far
+ * it merged it, so neither needs to wait for the other.
+ */
+static struct timestamp_cpu_buffer {
+	volatile uint32_t num_entries;
+	uint32_t num_merged;
+	struct timestamp_entry entries[CONFIG_TIMESTAMPS_PER_CPU_ENTRIES];
+} timestamp_cpu_buffers[CONFIG_MAX_CPUS];
+
+static int timestamp_on_ap(void)
+{
+	return cpu_index() != 0;
+}
+
+static void timestamp_add_cpu_entry(uint32_t id, uint64_t ts_time)
+{
+	unsigned long cpu = cpu_index();
+	struct timestamp_cpu_buffer *buf;
+	struct timestamp_entry *tse;
+
+	if (cpu >= CONFIG_MAX_CPUS)
+		return;
+
+	buf = &timestamp_cpu_buffers[cpu];
+	if (buf->num_entries >= ARRAY_SIZE(buf->entries))
+		return;
+
+	/* The base time is applied once the BSP merges it. */
+	tse = &buf->entries[buf->num_entries];
+	tse->entry_id = id;
+	tse->entry_stamp = ts_time;
+
+	/* The entry has to be complete before the BSP gets to see it. */
+	barrier();
+	buf->num_entries++;
+}
+
+/* Put an entry into the table where its time says it belongs. */
+static void timestamp_insert_table_entry(struct timestamp_table *ts_table,
+					 uint32_t id, uint64_t ts_time)
+{
+	uint64_t stamp = ts_time - ts_table->base_time;
+	uint32_t i;
+
+	if (ts_table->num_entries >= ts_table->max_entries)
+		return;
+
+	/* The APs don't lag far behind, so look from the end. */
+	i = ts_table->num_entries;
+	while (i > 0 && ts_table->entries[i - 1].entry_stamp > stamp)
+		i--;
+
+	memmove(&ts_table->entries[i + 1], &ts_table->entries[i],
+		(ts_table->num_entries - i) * sizeof(ts_table->entries[0]));
+	ts_table->entries[i].entry_id = id;
+	ts_table->entries[i].entry_stamp = stamp;
+	ts_table->num_entries++;
+}
+
+static void timestamp_merge_cpu_buffers(struct timestamp_table *ts_table)
+{
+	int cpu;
+
+	for (cpu = 1; cpu < CONFIG_MAX_CPUS; cpu++) {
+		struct timestamp_cpu_buffer *buf = &timestamp_cpu_buffers[cpu];
+		uint32_t num = buf->num_entries;
+
+		/* Don't read entries ahead of the count. */
+		barrier();
+		for (; buf->num_merged < num; buf->num_merged++) {
+			const struct timestamp_entry *tse =
+				&buf->entries[buf->num_merged];
+
+			timestamp_insert_table_entry(ts_table, tse->entry_id,
+						     tse->entry_stamp);
+		}
+	}
+}
+
+static void timestamp_merge_aps(void *unused)
+{
+	struct timestamp_table *ts_table = timestamp_table_get();
+
+	if (ts_table)
+		timestamp_merge_cpu_buffers(ts_table);
+}
+
+/* Catch whatever the APs recorded after the last BSP timestamp. */
+BOOT_STATE_INIT_ENTRY(BS_OS_RESUME, BS_ON_ENTRY, timestamp_merge_aps, NULL);
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, timestamp_merge_aps,
+		      NULL);
+#else
+static int timestamp_on_ap(void) { return 0; }
+static void timestamp_add_cpu_entry(uint32_t id, uint64_t ts_time) {}
+static void timestamp_merge_cpu_buffers(struct timestamp_table *ts_table) {}
+#endif
+
+static void timestamp_add_id(uint32_t id, uint64_t ts_time)
 {
 	struct timestamp_table *ts_table;
 
+	if (timestamp_on_ap()) {
+		timestamp_add_cpu_entry(id, ts_time);
+		return;
+	}
+
 	ts_table = timestamp_table_get();
 
 	if (!ts_table) {
@@ -197,14 +312,31 @@ void timestamp_add(enum timestamp_id id, uint64_t ts_time)
 		return;
 	}
 
+	/* Keep the table in time order, the APs' entries are older. */
+	timestamp_merge_cpu_buffers(ts_table);
 	timestamp_add_table_entry(ts_table, id, ts_time);
 }
 
+void timestamp_add(enum timestamp_id id, uint64_t ts_time)
+{
+	timestamp_add_id(id, ts_time);
+}
+
 void timestamp_add_now(enum timestamp_id id)
 {
 	timestamp_add(id, timestamp_get());
 }
 
+void timestamp_begin(uint32_t id)
+{
+	timestamp_add_id(id | TIMESTAMP_SPAN_BEGIN, timestamp_get());
+}
+
+void timestamp_end(uint32_t id)
+{
+	timestamp_add_id(id | TIMESTAMP_SPAN_END, timestamp_get());
+}
+
 void timestamp_init(uint64_t base)
 {
 	struct timestamp_cache *ts_cache;
@@ -311,6 +443,8 @@ static void timestamp_sync_cache_to_cbmem(int is_recovery)
 	if (ENV_RAMSTAGE)
 		ts_cbmem_table->tick_freq_mhz = timestamp_tick_freq_mhz();
 
+	timestamp_merge_cpu_buffers(ts_cbmem_table);
+
 	/* Cache no longer required. */
 	ts_cache_table->num_entries = 0;
 	ts_cache->cache_state = TIMESTAMP_CACHE_NOT_NEEDED;
@@ -357,6 +491,97 @@ uint32_t get_us_since_boot(void)
 	return (timestamp_get() - ts->base_time) / ts->tick_freq_mhz;
 }
 
+#if ENV_RAMSTAGE && IS_ENABLED(CONFIG_TIMESTAMP_BUDGETS)
+const struct timestamp_budget * __weak mainboard_timestamp_budgets(
+	size_t *count)
+{
+	*count = 0;
+	return NULL;
+}
+
+/* Find the first entry with id, at or after the stamp at. */
+static const struct timestamp_entry *timestamp_find(
+	const struct timestamp_table *ts_table, uint32_t id, uint64_t at)
+{
+	const struct timestamp_entry *found = NULL;
+	uint32_t i;
+
+	for (i = 0; i < ts_table->num_entries; i++) {
+		const struct timestamp_entry *tse = &ts_table->entries[i];
+
+		if (tse->entry_id != id || tse->entry_stamp < at)
+			continue;
+		if (!found || tse->entry_stamp < found->entry_stamp)
+			found = tse;
+	}
+
+	return found;
+}
+
+static void timestamp_check_budget(const struct timestamp_table *ts_table,
+				   const struct timestamp_budget *budget)
+{
+	const struct timestamp_entry *start, *end;
+	struct elog_event_data_phase_overrun overrun;
+	uint64_t start_stamp = 0;
+	uint64_t usecs;
+
+	if (budget->start) {
+		start = timestamp_find(ts_table, budget->start, 0);
+		if (!start)
+			return;
+		start_stamp = start->entry_stamp;
+	}
+	end = timestamp_find(ts_table, budget->end, start_stamp);
+	if (!end)
+		return;
+
+	usecs = (end->entry_stamp - start_stamp) / ts_table->tick_freq_mhz;
+	if (usecs <= budget->max_usecs)
+		return;
+
+	printk(BIOS_WARNING, "Boot phase %s -> %s took %" PRIu64
+	       " us, budget %u us\n",
+	       budget->start ? timestamp_name(budget->start) : "boot",
+	       timestamp_name(budget->end), usecs, budget->max_usecs);
+
+	overrun.start_id = budget->start;
+	overrun.end_id = budget->end;
+	overrun.usecs = MIN(usecs, UINT32_MAX);
+	overrun.budget_usecs = budget->max_usecs;
+	elog_add_event_raw(ELOG_TYPE_BOOT_PHASE_OVERRUN, &overrun,
+			   sizeof(overrun));
+}
+
+static void timestamp_check_budgets(void *unused)
+{
+	static const struct timestamp_budget kconfig_budgets[] = {
+		{ TS_BEFORE_INITRAM, TS_AFTER_INITRAM,
+		  CONFIG_TIMESTAMP_BUDGET_RAMINIT_MS * 1000 },
+		{ 0, TS_LOAD_PAYLOAD, CONFIG_TIMESTAMP_BUDGET_BOOT_MS * 1000 },
+	};
+	const struct timestamp_table *ts_table = timestamp_table_get();
+	const struct timestamp_budget *budgets;
+	size_t i, count;
+
+	/* Without a frequency there's no telling how long anything took. */
+	if (!ts_table || !ts_table->tick_freq_mhz)
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(kconfig_budgets); i++) {
+		if (kconfig_budgets[i].max_usecs)
+			timestamp_check_budget(ts_table, &kconfig_budgets[i]);
+	}
+
+	budgets = mainboard_timestamp_budgets(&count);
+	for (i = 0; i < count; i++)
+		timestamp_check_budget(ts_table, &budgets[i]);
+}
+
+BOOT_STATE_INIT_ENTRY(BS_PAYLOAD_BOOT, BS_ON_ENTRY, timestamp_check_budgets,
+		      NULL);
+#endif
+
 ROMSTAGE_CBMEM_INIT_HOOK(timestamp_sync_cache_to_cbmem)
 RAMSTAGE_CBMEM_INIT_HOOK(timestamp_sync_cache_to_cbmem)
 
@@ -88,5 +88,6 @@ void main(void)
 			 CACHED_MEM);
 	mmu_config_range(_dma_coherent, _dma_coherent_size, UNCACHED_MEM);
 	cbmem_initialize_empty();
+	sdram_stash_training(get_sdram_config());
 	run_ramstage();
 }
@@ -46,6 +46,10 @@ struct sysinfo
 	AMD_CONFIG_PARAMS StdHeader;
 
 	int s3resume;
+
+	/* Memory context AmdInitPost handed out, in the AGESA heap. */
+	void *mem_context;
+	u32 mem_context_size;
 };
 
 void agesa_main(struct sysinfo *cb);
@@ -72,6 +76,17 @@ void platform_BeforeInitPost(struct sysinfo *cb, AMD_POST_PARAMS *Post);
 void board_BeforeInitPost(struct sysinfo *cb, AMD_POST_PARAMS *Post);
 void platform_AfterInitPost(struct sysinfo *cb, AMD_POST_PARAMS *Post);
 
+#if IS_ENABLED(CONFIG_AGESA_FAST_BOOT)
+void agesa_mem_context_restore(AMD_POST_PARAMS *Post);
+void agesa_mem_context_saved(struct sysinfo *cb, AMD_POST_PARAMS *Post);
+void agesa_mem_context_stash(struct sysinfo *cb);
+#else
+static inline void agesa_mem_context_restore(AMD_POST_PARAMS *Post) {}
+static inline void agesa_mem_context_saved(struct sysinfo *cb,
+	AMD_POST_PARAMS *Post) {}
+static inline void agesa_mem_context_stash(struct sysinfo *cb) {}
+#endif
+
 void platform_BeforeInitEnv(struct sysinfo *cb, AMD_ENV_PARAMS *Env);
 void board_BeforeInitEnv(struct sysinfo *cb, AMD_ENV_PARAMS *Env);
 void platform_AfterInitEnv(struct sysinfo *cb, AMD_ENV_PARAMS *Env);
@@ -156,6 +156,14 @@ typedef struct {
 #define FOR_EACH_POPULATED_CHANNEL(dimms, idx) \
 	FOR_EACH_CHANNEL(idx) IF_CHANNEL_POPULATED(dimms, idx)
 
+/* Trained values in the packed form they are stored in. */
+typedef struct {
+	u8		rec_c[TOTAL_CHANNELS];
+	u32		rec[TOTAL_CHANNELS][4];
+	u8		read_training[TOTAL_CHANNELS * 8];
+	u8		write_training[TOTAL_CHANNELS * 4 * 2];
+} training_results_t;
+
 #define RANKS_PER_CHANNEL 4 /* Only two may be populated */
 #define IF_RANK_POPULATED(dimms, ch, r) \
 	if (dimms[ch].card_type && ((r) < dimms[ch].ranks))
@@ -425,9 +433,18 @@ u32 raminit_get_rank_addr(unsigned int channel, unsigned int rank);
 
 void raminit_rcomp_calibration(stepping_t stepping);
 void raminit_reset_readwrite_pointers(void);
-void raminit_receive_enable_calibration(const timings_t *, const dimminfo_t *);
-void raminit_write_training(const mem_clock_t, const dimminfo_t *, int s3resume);
-void raminit_read_training(const dimminfo_t *, int s3resume);
+/*
+ * The training steps fill `results`. If `cached` is set, they program the
+ * values in `results` instead of training.
+ */
+void raminit_receive_enable_calibration(const timings_t *, const dimminfo_t *,
+					training_results_t *results, int cached);
+void raminit_write_training(const mem_clock_t, const dimminfo_t *, int s3resume,
+			    training_results_t *results, int cached);
+void raminit_read_training(const dimminfo_t *, int s3resume,
+			   training_results_t *results, int cached);
+/* Returns 1 if a test pattern reads back from every populated rank. */
+int raminit_verify_training(const dimminfo_t *);
 
 void gm45_late_init(stepping_t);
 
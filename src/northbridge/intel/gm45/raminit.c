@@ -16,11 +16,16 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <arch/cpu.h>
+#include <arch/early_variables.h>
 #include <arch/io.h>
+#include <cbmem.h>
 #include <device/pci_def.h>
 #include <device/pnp_def.h>
 #include <device/device.h>
+#include <device/dram/ddr3.h>
+#include <mrc_cache.h>
 #include <spd.h>
 #include <console/console.h>
 #include <lib.h>
@@ -29,6 +34,19 @@
 #include "gm45.h"
 #include "chip.h"
 
+#define MRC_CACHE_VERSION 0
+
+/* Training results of a cold boot and what they are valid for. */
+struct training_cache {
+	u16			spd_crc[TOTAL_CHANNELS];
+	timings_t		timings;
+	dimminfo_t		dimms[TOTAL_CHANNELS];
+	training_results_t	results;
+};
+
+static struct training_cache training CAR_GLOBAL;
+static int training_changed CAR_GLOBAL;
+
 static const gmch_gfx_t gmch_gfx_types[][5] = {
 /*  MAX_667MHz    MAX_533MHz    MAX_400MHz    MAX_333MHz    MAX_800MHz    */
   { GMCH_UNKNOWN, GMCH_UNKNOWN, GMCH_UNKNOWN, GMCH_UNKNOWN, GMCH_UNKNOWN  },
@@ -1678,6 +1696,87 @@ static void dram_optimizations(const timings_t *const timings,
 	}
 }
 
+/* Identify the DIMMs by the unique CRC over their SPD's module id. */
+static void fill_training_key(const sysinfo_t *const sysinfo,
+			      struct training_cache *const cache)
+{
+	u8 spd[128];
+	unsigned int i;
+	int ch;
+
+	memset(cache, 0, sizeof(*cache));
+	FOR_EACH_POPULATED_CHANNEL(sysinfo->dimms, ch) {
+		for (i = 117; i < sizeof(spd); ++i)
+			spd[i] = smbus_read_byte(sysinfo->spd_map[2 * ch], i);
+		cache->spd_crc[ch] = spd_ddr3_calc_unique_crc(spd, sizeof(spd));
+	}
+	cache->timings = sysinfo->selected_timings;
+	memcpy(cache->dimms, sysinfo->dimms, sizeof(cache->dimms));
+}
+
+/* Returns 1 if the MRC cache holds training results for these DIMMs. */
+static int find_cached_training(const sysinfo_t *const sysinfo)
+{
+	struct training_cache *const cache = car_get_var_ptr(&training);
+	const struct training_cache *stored;
+	struct region_device rdev;
+
+	fill_training_key(sysinfo, cache);
+
+	if (mrc_cache_get_current(MRC_TRAINING_DATA, MRC_CACHE_VERSION, &rdev))
+		return 0;
+	if (region_device_sz(&rdev) != sizeof(*cache))
+		return 0;
+	stored = rdev_mmap_full(&rdev);
+	if (!stored)
+		return 0;
+
+	if (memcmp(stored, cache, offsetof(struct training_cache, results))) {
+		printk(BIOS_DEBUG, "DIMMs changed, retraining.\n");
+		rdev_munmap(&rdev, (void *)stored);
+		return 0;
+	}
+	cache->results = stored->results;
+	rdev_munmap(&rdev, (void *)stored);
+	return 1;
+}
+
+static void stash_training(int is_recovery)
+{
+	if (!IS_ENABLED(CONFIG_GM45_CACHE_TRAINING))
+		return;
+	if (is_recovery || !car_get_var(training_changed))
+		return;
+	mrc_cache_stash_data(MRC_TRAINING_DATA, MRC_CACHE_VERSION,
+			     car_get_var_ptr(&training),
+			     sizeof(struct training_cache));
+}
+ROMSTAGE_CBMEM_INIT_HOOK(stash_training)
+
+static void train_receive_enable_read_write(const timings_t *const timings,
+					    const dimminfo_t *const dimms,
+					    const int s3resume,
+					    training_results_t *const results,
+					    const int cached)
+{
+	/* Perform receive-enable calibration. */
+	raminit_receive_enable_calibration(timings, dimms, results, cached);
+	/* Lend clock values from receive-enable calibration. */
+	MCHBAR32(CxDRT5_MCHBAR(0)) =
+		(MCHBAR32(CxDRT5_MCHBAR(0)) & ~(0xf0)) |
+		((((MCHBAR32(CxDRT3_MCHBAR(0)) >> 7) - 1) & 0xf) << 4);
+	MCHBAR32(CxDRT5_MCHBAR(1)) =
+		(MCHBAR32(CxDRT5_MCHBAR(1)) & ~(0xf0)) |
+		((((MCHBAR32(CxDRT3_MCHBAR(1)) >> 7) - 1) & 0xf) << 4);
+
+	/* Perform read/write training for high clock rate. */
+	if (timings->mem_clock == MEM_CLOCK_1067MT) {
+		raminit_read_training(dimms, s3resume, results, cached);
+		raminit_write_training(timings->mem_clock, dimms, s3resume,
+				       results, cached);
+	}
+}
+
 u32 raminit_get_rank_addr(unsigned int channel, unsigned int rank)
 {
 	if (!channel && !rank)
@@ -1712,8 +1811,10 @@ void raminit(sysinfo_t *const sysinfo, const int s3resume)
 {
 	const dimminfo_t *const dimms = sysinfo->dimms;
 	const timings_t *const timings = &sysinfo->selected_timings;
+	training_results_t *const results =
+		&((struct training_cache *)car_get_var_ptr(&training))->results;
 
-	int ch;
+	int ch, cached = 0;
 	u8 reg8;
 
 	timestamp_add_now(TS_BEFORE_INITRAM);
@@ -1732,6 +1833,10 @@ void raminit(sysinfo_t *const sysinfo, const int s3resume)
 	/* Check for bad warm boot. */
 	reset_on_bad_warmboot();
 
+	/* Look for training results of the same DIMMs. */
+	if (!s3resume && IS_ENABLED(CONFIG_GM45_CACHE_TRAINING))
+		cached = find_cached_training(sysinfo);
+
 
 	/***** From now on, program according to collected infos: *****/
 
@@ -1801,21 +1906,19 @@ void raminit(sysinfo_t *const sysinfo, const int s3resume)
 	/* Perform ZQ calibration for DDR3. */
 	ddr3_calibrate_zq();
 
-	/* Perform receive-enable calibration. */
-	raminit_receive_enable_calibration(timings, dimms);
-	/* Lend clock values from receive-enable calibration. */
-	MCHBAR32(CxDRT5_MCHBAR(0)) =
-		(MCHBAR32(CxDRT5_MCHBAR(0)) & ~(0xf0)) |
-		((((MCHBAR32(CxDRT3_MCHBAR(0)) >> 7) - 1) & 0xf) << 4);
-	MCHBAR32(CxDRT5_MCHBAR(1)) =
-		(MCHBAR32(CxDRT5_MCHBAR(1)) & ~(0xf0)) |
-		((((MCHBAR32(CxDRT3_MCHBAR(1)) >> 7) - 1) & 0xf) << 4);
-
-	/* Perform read/write training for high clock rate. */
-	if (timings->mem_clock == MEM_CLOCK_1067MT) {
-		raminit_read_training(dimms, s3resume);
-		raminit_write_training(timings->mem_clock, dimms, s3resume);
-	}
+	/* Perform or restore receive-enable calibration and read/write
+	   training. Cached results are checked and retrained on failure. */
+	train_receive_enable_read_write(timings, dimms, s3resume,
+					results, cached);
+	if (cached && !raminit_verify_training(dimms)) {
+		printk(BIOS_DEBUG, "Cached training results failed, "
+		       "retraining.\n");
+		cached = 0;
+		train_receive_enable_read_write(timings, dimms, s3resume,
+						results, cached);
+	}
+	if (!s3resume && !cached)
+		car_set_var(training_changed, 1);
 
 	igd_compute_ggc(sysinfo);
 
@@ -211,31 +211,38 @@ static void read_training_per_lane(const int channel, const int lane,
 	printk(RAM_DEBUG, "Final timings for ");
 	print_read_timing(BIOS_DEBUG, "", lane, channel, &lower);
 }
+static void read_training_prepare(const dimminfo_t *const dimms,
+				  const int channel,
+				  address_bunch_t *const addresses)
+{
+	int i;
+
+	FOR_EACH_POPULATED_RANK_IN_CHANNEL(dimms, channel, i)
+		addresses->addr[addresses->count++] =
+			raminit_get_rank_addr(channel, i);
+
+	for (i = 0; i < addresses->count; ++i) {
+		/* Write test pattern. */
+		unsigned int offset;
+		for (offset = 0; offset < 320; offset += 4)
+			write32((u32 *)(addresses->addr[i] + offset),
+				read_training_schedule[offset >> 3]);
+	}
+}
 static void perform_read_training(const dimminfo_t *const dimms)
 {
 	int ch, i;
 
 	FOR_EACH_POPULATED_CHANNEL(dimms, ch) {
 		address_bunch_t addresses = { { 0, }, 0 };
-		FOR_EACH_POPULATED_RANK_IN_CHANNEL(dimms, ch, i)
-			addresses.addr[addresses.count++] =
-				raminit_get_rank_addr(ch, i);
-
-		for (i = 0; i < addresses.count; ++i) {
-			/* Write test pattern. */
-			unsigned int offset;
-			for (offset = 0; offset < 320; offset += 4)
-				write32((u32 *)(addresses.addr[i] + offset),
-					read_training_schedule[offset >> 3]);
-		}
+		read_training_prepare(dimms, ch, &addresses);
 
 		for (i = 0; i < 8; ++i)
 			read_training_per_lane(ch, i, &addresses);
 	}
 }
-static void read_training_store_results(void)
+static void read_training_store_results(u8 bytes[TOTAL_CHANNELS * 8])
 {
-	u8 bytes[TOTAL_CHANNELS * 8];
 	int ch, i;
 
 	/* Store one timing pair in one byte each. */
@@ -253,14 +260,17 @@ static void read_training_store_results(void)
 	for (i = 0; i < (TOTAL_CHANNELS * 8); ++i)
 		cmos_write(bytes[i], CMOS_READ_TRAINING + i);
 }
-static void read_training_restore_results(void)
+static void read_training_load_results(u8 bytes[TOTAL_CHANNELS * 8])
 {
-	u8 bytes[TOTAL_CHANNELS * 8];
-	int ch, i;
+	int i;
 
 	/* Read from CMOS. */
 	for (i = 0; i < (TOTAL_CHANNELS * 8); ++i)
 		bytes[i] = cmos_read(CMOS_READ_TRAINING + i);
+}
+static void read_training_restore_results(const u8 bytes[TOTAL_CHANNELS * 8])
+{
+	int ch, i;
 
 	/* Program restored results. */
 	FOR_EACH_CHANNEL(ch) {
@@ -276,16 +286,40 @@ static void read_training_restore_results(void)
 		}
 	}
 }
-void raminit_read_training(const dimminfo_t *const dimms, const int s3resume)
+void raminit_read_training(const dimminfo_t *const dimms, const int s3resume,
+			   training_results_t *const results, const int cached)
 {
-	if (!s3resume) {
-		perform_read_training(dimms);
-		read_training_store_results();
+	if (s3resume) {
+		read_training_load_results(results->read_training);
+		read_training_restore_results(results->read_training);
+	} else if (cached) {
+		read_training_restore_results(results->read_training);
+		read_training_store_results(results->read_training);
 	} else {
-		read_training_restore_results();
+		perform_read_training(dimms);
+		read_training_store_results(results->read_training);
 	}
 	raminit_reset_readwrite_pointers();
 }
+int raminit_verify_training(const dimminfo_t *const dimms)
+{
+	int ch, i;
+
+	FOR_EACH_POPULATED_CHANNEL(dimms, ch) {
+		address_bunch_t addresses = { { 0, }, 0 };
+		read_training_prepare(dimms, ch, &addresses);
+
+		for (i = 0; i < 8; ++i) {
+			if (!read_training_test(ch, i, &addresses)) {
+				printk(BIOS_DEBUG, "Training verification "
+				       "failed on byte lane %d, ch %d.\n",
+				       i, ch);
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
 
 /* Write Training. */
 #define CxWRTy_T_SHIFT		28
@@ -597,9 +631,9 @@ static void perform_write_training(const int memclk1067,
 		}
 	}
 }
-static void write_training_store_results(void)
+/* two bytes per group */
+static void write_training_store_results(u8 bytes[TOTAL_CHANNELS * 4 * 2])
 {
-	u8 bytes[TOTAL_CHANNELS * 4 * 2]; /* two bytes per group */
 	int ch, i;
 
 	/* Store one T/P pair in one, F in the other byte. */
@@ -620,16 +654,20 @@ static void write_training_store_results(void)
 	for (i = 0; i < (TOTAL_CHANNELS * 4 * 2); ++i)
 		cmos_write(bytes[i], CMOS_WRITE_TRAINING + i);
 }
-static void write_training_restore_results(const int memclk1067)
+static void write_training_load_results(u8 bytes[TOTAL_CHANNELS * 4 * 2])
 {
-	const int t_bound = memclk1067 ? 12 : 11;
-
-	u8 bytes[TOTAL_CHANNELS * 4 * 2]; /* two bytes per group */
-	int ch, i;
+	int i;
 
 	/* Read from CMOS. */
 	for (i = 0; i < (TOTAL_CHANNELS * 4 * 2); ++i)
 		bytes[i] = cmos_read(CMOS_WRITE_TRAINING + i);
+}
+static void write_training_restore_results(
+		const u8 bytes[TOTAL_CHANNELS * 4 * 2], const int memclk1067)
+{
+	const int t_bound = memclk1067 ? 12 : 11;
+
+	int ch, i;
 
 	/* Program with original program_write_timing(). */
 	FOR_EACH_CHANNEL(ch) {
@@ -647,15 +685,23 @@ static void write_training_restore_results(const int memclk1067)
 }
 void raminit_write_training(const mem_clock_t ddr3clock,
 			    const dimminfo_t *const dimms,
-			    const int s3resume)
+			    const int s3resume,
+			    training_results_t *const results,
+			    const int cached)
 {
 	const int memclk1067 = ddr3clock == MEM_CLOCK_1067MT;
 
-	if (!s3resume) {
-		perform_write_training(memclk1067, dimms);
-		write_training_store_results();
+	if (s3resume) {
+		write_training_load_results(results->write_training);
+		write_training_restore_results(results->write_training,
+					       memclk1067);
+	} else if (cached) {
+		write_training_restore_results(results->write_training,
+					       memclk1067);
+		write_training_store_results(results->write_training);
 	} else {
-		write_training_restore_results(memclk1067);
+		perform_write_training(memclk1067, dimms);
+		write_training_store_results(results->write_training);
 	}
 	raminit_reset_readwrite_pointers();
 }
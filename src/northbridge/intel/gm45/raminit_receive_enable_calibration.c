@@ -274,8 +274,43 @@ static void receive_enable_calibration(const timings_t *const timings,
 	}
 }
 
+static void store_results(const dimminfo_t *const dimms,
+			  training_results_t *const results)
+{
+	int ch, group;
+
+	FOR_EACH_POPULATED_CHANNEL(dimms, ch) {
+		results->rec_c[ch] = (MCHBAR32(CxDRT3_MCHBAR(ch)) &
+				      CxDRT3_C_MASK) >> CxDRT3_C_SHIFT;
+		for (group = 0; group < 4; ++group)
+			results->rec[ch][group] =
+				MCHBAR32(CxRECy_MCHBAR(ch, group)) &
+				CxRECy_TIMING_MASK;
+	}
+}
+
+static void restore_results(const dimminfo_t *const dimms,
+			    const training_results_t *const results)
+{
+	int ch, group;
+
+	FOR_EACH_POPULATED_CHANNEL(dimms, ch) {
+		unsigned int mchbar = CxDRT3_MCHBAR(ch);
+		MCHBAR32(mchbar) = (MCHBAR32(mchbar) & ~CxDRT3_C_MASK) |
+					CxDRT3_C(results->rec_c[ch]);
+		for (group = 0; group < 4; ++group) {
+			mchbar = CxRECy_MCHBAR(ch, group);
+			MCHBAR32(mchbar) = (MCHBAR32(mchbar) &
+					    ~CxRECy_TIMING_MASK) |
+					   results->rec[ch][group];
+		}
+	}
+}
+
 void raminit_receive_enable_calibration(const timings_t *const timings,
-					const dimminfo_t *const dimms)
+					const dimminfo_t *const dimms,
+					training_results_t *const results,
+					const int cached)
 {
 	int ch;
 
@@ -299,7 +334,12 @@ void raminit_receive_enable_calibration(const timings_t *const timings,
 	MCHBAR32(0x14f0) = (MCHBAR32(0x14f0) & ~(3 << 9)) | (1 << 9);
 	MCHBAR32(0x15f0) = (MCHBAR32(0x15f0) & ~(3 << 9)) | (1 << 9);
 
-	receive_enable_calibration(timings, dimms);
+	if (!cached) {
+		receive_enable_calibration(timings, dimms);
+		store_results(dimms, results);
+	} else {
+		restore_results(dimms, results);
+	}
 
 	MCHBAR32(0x12a4) &= ~(1 << 31);
 	MCHBAR32(0x13a4) &= ~(1 << 31);
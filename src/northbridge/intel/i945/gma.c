@@ -332,16 +332,8 @@ static int intel_gma_init_lvds(struct northbridge_intel_i945_config *conf,
 	write32(mmiobase + PP_CONTROL, PANEL_UNLOCK_REGS
 		| PANEL_POWER_ON | PANEL_POWER_RESET);
 
-	printk(BIOS_DEBUG, "waiting for panel powerup\n");
-	while (1) {
-		u32 reg32;
-		reg32 = read32(mmiobase + PP_STATUS);
-		if ((reg32 & PP_SEQUENCE_MASK) == PP_SEQUENCE_NONE)
-			break;
-	}
-	printk(BIOS_DEBUG, "panel powered up\n");
-
-	write32(mmiobase + PP_CONTROL, PANEL_POWER_ON | PANEL_POWER_RESET);
+	gma_panel_power_wait(mmiobase, PP_STATUS, PP_CONTROL,
+			     PANEL_POWER_ON | PANEL_POWER_RESET);
 
 	/* Clear interrupts. */
 	write32(mmiobase + DEIIR, 0xffffffff);
@@ -444,16 +444,8 @@ int i915lightup_sandy(const struct i915_gpu_controller_info *info,
 	write32(mmio + PCH_PP_CONTROL, PANEL_UNLOCK_REGS
 		| PANEL_POWER_ON | PANEL_POWER_RESET);
 
-	printk (BIOS_DEBUG, "waiting for panel powerup\n");
-	while (1) {
-		u32 reg32;
-		reg32 = read32(mmio + PCH_PP_STATUS);
-		if (((reg32 >> 28) & 3) == 0)
-			break;
-	}
-	printk (BIOS_DEBUG, "panel powered up\n");
-
-	write32(mmio + PCH_PP_CONTROL, PANEL_POWER_ON | PANEL_POWER_RESET);
+	gma_panel_power_wait(mmio, PCH_PP_STATUS, PCH_PP_CONTROL,
+			     PANEL_POWER_ON | PANEL_POWER_RESET);
 
 	/* Enable screen memory.  */
 	vga_sr_write(1, vga_sr_read(1) & ~0x20);
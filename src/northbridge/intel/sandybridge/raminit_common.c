@@ -2325,81 +2325,113 @@ int command_training(ramctr_timing *ctrl)
 }
 
 
-static int discover_edges_real(ramctr_timing *ctrl, int channel, int slotrank,
-				int *edges)
+/* Queue and start one MPR read test of slotrank on channel at this edge. */
+static void edge_test_start(ramctr_timing *ctrl, int channel, int slotrank,
+			    int edge)
 {
-	int edge;
-	int statistics[NUM_LANES][MAX_EDGE_TIMING + 1];
 	int lane;
 
-	for (edge = 0; edge <= MAX_EDGE_TIMING; edge++) {
-		FOR_ALL_LANES {
-			ctrl->timings[channel][slotrank].lanes[lane].rising =
-			    edge;
-			ctrl->timings[channel][slotrank].lanes[lane].falling =
-			    edge;
-		}
-		program_timings(ctrl, channel);
+	FOR_ALL_LANES {
+		ctrl->timings[channel][slotrank].lanes[lane].rising = edge;
+		ctrl->timings[channel][slotrank].lanes[lane].falling = edge;
+	}
+	program_timings(ctrl, channel);
 
-		FOR_ALL_LANES {
-			volatile u32 tmp;
-			MCHBAR32(0x4340 + 0x400 * channel + 4 * lane) = 0;
-			tmp = MCHBAR32(0x400 * channel + 4 * lane + 0x4140);
-		}
+	FOR_ALL_LANES {
+		volatile u32 tmp;
+		MCHBAR32(0x4340 + 0x400 * channel + 4 * lane) = 0;
+		tmp = MCHBAR32(0x400 * channel + 4 * lane + 0x4140);
+	}
 
-		wait_428c(channel);
-		/* DRAM command MRS
-		 * write MR3 MPR enable
-		 * in this mode only RD and RDA are allowed
-		 * all reads return a predefined pattern */
-		MCHBAR32(0x4220 + 0x400 * channel) = 0x1f000;
-		MCHBAR32(0x4230 + 0x400 * channel) =
-			0xc01 | (ctrl->tMOD << 16);
-		MCHBAR32(0x4200 + 0x400 * channel) =
-			(slotrank << 24) | 0x360004;
-		MCHBAR32(0x4210 + 0x400 * channel) = 0;
+	wait_428c(channel);
+	/* DRAM command MRS
+	 * write MR3 MPR enable
+	 * in this mode only RD and RDA are allowed
+	 * all reads return a predefined pattern */
+	MCHBAR32(0x4220 + 0x400 * channel) = 0x1f000;
+	MCHBAR32(0x4230 + 0x400 * channel) =
+		0xc01 | (ctrl->tMOD << 16);
+	MCHBAR32(0x4200 + 0x400 * channel) =
+		(slotrank << 24) | 0x360004;
+	MCHBAR32(0x4210 + 0x400 * channel) = 0;
 
-		/* DRAM command RD */
-		MCHBAR32(0x4224 + 0x400 * channel) = 0x1f105;
-		MCHBAR32(0x4234 + 0x400 * channel) = 0x40411f4;
-		MCHBAR32(0x4204 + 0x400 * channel) = slotrank << 24;
-		MCHBAR32(0x4214 + 0x400 * channel) = 0;
+	/* DRAM command RD */
+	MCHBAR32(0x4224 + 0x400 * channel) = 0x1f105;
+	MCHBAR32(0x4234 + 0x400 * channel) = 0x40411f4;
+	MCHBAR32(0x4204 + 0x400 * channel) = slotrank << 24;
+	MCHBAR32(0x4214 + 0x400 * channel) = 0;
 
-		/* DRAM command RD */
-		MCHBAR32(0x4228 + 0x400 * channel) = 0x1f105;
-		MCHBAR32(0x4238 + 0x400 * channel) =
-			0x1001 | ((ctrl->CAS + 8) << 16);
-		MCHBAR32(0x4208 + 0x400 * channel) = (slotrank << 24) | 0x60000;
-		MCHBAR32(0x4218 + 0x400 * channel) = 0;
+	/* DRAM command RD */
+	MCHBAR32(0x4228 + 0x400 * channel) = 0x1f105;
+	MCHBAR32(0x4238 + 0x400 * channel) =
+		0x1001 | ((ctrl->CAS + 8) << 16);
+	MCHBAR32(0x4208 + 0x400 * channel) = (slotrank << 24) | 0x60000;
+	MCHBAR32(0x4218 + 0x400 * channel) = 0;
 
-		/* DRAM command MRS
-		 * MR3 disable MPR */
-		MCHBAR32(0x422c + 0x400 * channel) = 0x1f000;
-		MCHBAR32(0x423c + 0x400 * channel) = 0xc01 | (ctrl->tMOD << 16);
-		MCHBAR32(0x420c + 0x400 * channel) =
-			(slotrank << 24) | 0x360000;
-		MCHBAR32(0x421c + 0x400 * channel) = 0;
+	/* DRAM command MRS
+	 * MR3 disable MPR */
+	MCHBAR32(0x422c + 0x400 * channel) = 0x1f000;
+	MCHBAR32(0x423c + 0x400 * channel) = 0xc01 | (ctrl->tMOD << 16);
+	MCHBAR32(0x420c + 0x400 * channel) =
+		(slotrank << 24) | 0x360000;
+	MCHBAR32(0x421c + 0x400 * channel) = 0;
 
-		MCHBAR32(0x4284 + 0x400 * channel) = 0xc0001;
+	MCHBAR32(0x4284 + 0x400 * channel) = 0xc0001;
+}
 
-		wait_428c(channel);
+/*
+ * Sweep the read edges of slotrank on all channels that have it. Each
+ * channel has its own command sequencer, so the channels are tested in
+ * lockstep: both are started before waiting for either.
+ */
+static int discover_edges_real(ramctr_timing *ctrl, int slotrank,
+			       int edges[NUM_CHANNELS][NUM_SLOTRANKS][NUM_LANES])
+{
+	u8 failed[NUM_CHANNELS][NUM_LANES][MAX_EDGE_TIMING + 1];
+	int statistics[MAX_EDGE_TIMING + 1];
+	int channel, edge, lane, i;
 
-		FOR_ALL_LANES {
-			statistics[lane][edge] =
-				MCHBAR32(0x4340 + 0x400 * channel + lane * 4);
+	for (edge = 0; edge <= MAX_EDGE_TIMING; edge++) {
+		FOR_ALL_CHANNELS {
+			if (ctrl->rankmap[channel] & (1 << slotrank))
+				edge_test_start(ctrl, channel, slotrank, edge);
+		}
+
+		FOR_ALL_CHANNELS {
+			if (!(ctrl->rankmap[channel] & (1 << slotrank)))
+				continue;
+
+			wait_428c(channel);
+
+			FOR_ALL_LANES {
+				failed[channel][lane][edge] = !!MCHBAR32(0x4340
+					+ 0x400 * channel + lane * 4);
+			}
 		}
 	}
-	FOR_ALL_LANES {
-		struct run rn =
-		    get_longest_zero_run(statistics[lane], MAX_EDGE_TIMING + 1);
-		edges[lane] = rn.middle;
-		if (rn.all) {
-			printk(BIOS_EMERG, "edge discovery failed: %d, %d, %d\n",
-			       channel, slotrank, lane);
-			return MAKE_ERR;
+
+	FOR_ALL_CHANNELS {
+		if (!(ctrl->rankmap[channel] & (1 << slotrank)))
+			continue;
+
+		FOR_ALL_LANES {
+			struct run rn;
+
+			for (i = 0; i <= MAX_EDGE_TIMING; i++)
+				statistics[i] = failed[channel][lane][i];
+
+			rn = get_longest_zero_run(statistics,
+						  MAX_EDGE_TIMING + 1);
+			edges[channel][slotrank][lane] = rn.middle;
+			if (rn.all) {
+				printk(BIOS_EMERG,
+				       "edge discovery failed: %d, %d, %d\n",
+				       channel, slotrank, lane);
+				return MAKE_ERR;
+			}
+			printram("eval %d, %d, %d: %02x\n", channel, slotrank,
+			       lane, edges[channel][slotrank][lane]);
 		}
-		printram("eval %d, %d, %d: %02x\n", channel, slotrank,
-		       lane, edges[lane]);
 	}
 	return 0;
 }
@@ -2549,9 +2581,8 @@ int discover_edges(ramctr_timing *ctrl)
 	MCHBAR32(0x4eb0) = 0x300;
 	printram("discover falling edges:\n[%x] = %x\n", 0x4eb0, 0x300);
 
-	FOR_ALL_CHANNELS FOR_ALL_POPULATED_RANKS {
-		err = discover_edges_real(ctrl, channel, slotrank,
-			falling_edges[channel][slotrank]);
+	for (slotrank = 0; slotrank < NUM_SLOTRANKS; slotrank++) {
+		err = discover_edges_real(ctrl, slotrank, falling_edges);
 		if (err)
 			return err;
 	}
@@ -2559,9 +2590,8 @@ int discover_edges(ramctr_timing *ctrl)
 	MCHBAR32(0x4eb0) = 0x200;
 	printram("discover rising edges:\n[%x] = %x\n", 0x4eb0, 0x200);
 
-	FOR_ALL_CHANNELS FOR_ALL_POPULATED_RANKS {
-		err = discover_edges_real(ctrl, channel, slotrank,
-				    rising_edges[channel][slotrank]);
+	for (slotrank = 0; slotrank < NUM_SLOTRANKS; slotrank++) {
+		err = discover_edges_real(ctrl, slotrank, rising_edges);
 		if (err)
 			return err;
 	}
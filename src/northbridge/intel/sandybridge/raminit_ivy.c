@@ -20,6 +20,7 @@
 #include <delay.h>
 #include <arch/io.h>
 #include <device/pci_ops.h>
+#include <timestamp.h>
 #include "raminit_native.h"
 #include "raminit_common.h"
 
@@ -704,6 +705,7 @@ int try_init_dram_ddr3_ivy(ramctr_timing *ctrl, int fast_boot,
 		/* MRS commands */
 		dram_mrscommands(ctrl);
 		printk(BIOS_DEBUG, "Done MRS commands\n");
+		timestamp_add_now(TS_RAMINIT_JEDEC_DONE);
 
 		/* Prepare for memory training */
 		prepare_training(ctrl);
@@ -711,32 +713,38 @@ int try_init_dram_ddr3_ivy(ramctr_timing *ctrl, int fast_boot,
 		err = read_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_READ_TRAINING_DONE);
 
 		err = write_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_TRAINING_DONE);
 
 		printram("CP5a\n");
 
 		err = discover_edges(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_READ_EDGES_DONE);
 
 		printram("CP5b\n");
 
 		err = command_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_CMD_TRAINING_DONE);
 
 		printram("CP5c\n");
 
 		err = discover_edges_write(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_EDGES_DONE);
 
 		err = discover_timC_write(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_TIMC_DONE);
 
 		normalize_training(ctrl);
 	}
@@ -749,6 +757,7 @@ int try_init_dram_ddr3_ivy(ramctr_timing *ctrl, int fast_boot,
 		err = channel_test(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_CHANNEL_TEST_DONE);
 	}
 
 	return 0;
@@ -18,6 +18,7 @@
 #include <console/console.h>
 #include <console/usb.h>
 #include <delay.h>
+#include <timestamp.h>
 #include "raminit_native.h"
 #include "raminit_common.h"
 
@@ -474,6 +475,7 @@ int try_init_dram_ddr3_sandy(ramctr_timing *ctrl, int fast_boot,
 		/* MRS commands */
 		dram_mrscommands(ctrl);
 		printk(BIOS_DEBUG, "Done MRS commands\n");
+		timestamp_add_now(TS_RAMINIT_JEDEC_DONE);
 
 		/* Prepare for memory training */
 		prepare_training(ctrl);
@@ -481,32 +483,38 @@ int try_init_dram_ddr3_sandy(ramctr_timing *ctrl, int fast_boot,
 		err = read_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_READ_TRAINING_DONE);
 
 		err = write_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_TRAINING_DONE);
 
 		printram("CP5a\n");
 
 		err = discover_edges(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_READ_EDGES_DONE);
 
 		printram("CP5b\n");
 
 		err = command_training(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_CMD_TRAINING_DONE);
 
 		printram("CP5c\n");
 
 		err = discover_edges_write(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_EDGES_DONE);
 
 		err = discover_timC_write(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_WRITE_TIMC_DONE);
 
 		normalize_training(ctrl);
 	}
@@ -519,6 +527,7 @@ int try_init_dram_ddr3_sandy(ramctr_timing *ctrl, int fast_boot,
 		err = channel_test(ctrl);
 		if (err)
 			return err;
+		timestamp_add_now(TS_RAMINIT_CHANNEL_TEST_DONE);
 	}
 
 	return 0;
@@ -88,6 +88,34 @@ int tis_close(void);
 int tis_sendrecv(const u8 *sendbuf, size_t send_size, u8 *recvbuf,
 			size_t *recv_len);
 
+/*
+ * tis_send()
+ *
+ * Send the requested data to the TPM without waiting for it to respond. The
+ * response must be collected with tis_recv() before the next command is sent.
+ * Only available if the driver selects TPM_SPLIT_TRANSACTIONS.
+ *
+ * @sendbuf - buffer of the data to send
+ * @send_size size of the data to send
+ *
+ * Returns 0 on success or -1 on failure.
+ */
+int tis_send(const u8 *sendbuf, size_t send_size);
+
+/*
+ * tis_recv()
+ *
+ * Wait for the TPM to finish the command sent with tis_send() and get its
+ * response.
+ *
+ * @recvbuf - memory to save the response to
+ * @recv_len - pointer to the size of the response buffer
+ *
+ * Returns 0 on success (and places the number of response bytes at recv_len)
+ * or -1 on failure.
+ */
+int tis_recv(u8 *recvbuf, size_t *recv_len);
+
 /*
  * tis_plat_irq_status()
  *
@@ -97,4 +125,16 @@ int tis_sendrecv(const u8 *sendbuf, size_t send_size, u8 *recvbuf,
  */
 int tis_plat_irq_status(void);
 
+/*
+ * tis_wait_irq()
+ *
+ * Wait for tis_plat_irq_status() to report the TPM irq, letting other
+ * threads run in the meantime if the caller is one.
+ *
+ * @timeout_ms - how long to wait for the irq
+ *
+ * Returns 1 when the irq arrived or 0 on timeout.
+ */
+int tis_wait_irq(unsigned int timeout_ms);
+
 #endif /* TIS_H_ */
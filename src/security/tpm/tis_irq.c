@@ -0,0 +1,35 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <security/tpm/tis.h>
+#include <thread.h>
+#include <timer.h>
+
+/* How long other threads get to run between two looks at the irq. */
+#define TIS_IRQ_POLL_USECS	10
+
+int tis_wait_irq(unsigned int timeout_ms)
+{
+	struct stopwatch sw;
+
+	stopwatch_init_msecs_expire(&sw, timeout_ms);
+
+	while (!tis_plat_irq_status()) {
+		if (stopwatch_expired(&sw))
+			return 0;
+		/* Busy wait if the caller isn't a thread. */
+		thread_yield_microseconds(TIS_IRQ_POLL_USECS);
+	}
+
+	return 1;
+}
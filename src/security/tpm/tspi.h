@@ -55,4 +55,11 @@ uint32_t tpm_clear_and_reenable(void);
  */
 uint32_t tpm_setup(int s3flag);
 
+/**
+ * Get TPM startup going ahead of tpm_setup(), which then only collects the
+ * result. Failures are left for tpm_setup() to deal with.
+ * @param s3flag tells the tpm setup if we wake up from a s3 state on x86
+ */
+void tpm_start_setup(int s3flag);
+
 #endif /* TSPI_H_ */
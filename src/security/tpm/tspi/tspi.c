@@ -150,6 +150,16 @@ out:
 	return result;
 }
 
+void tpm_start_setup(int s3flag)
+{
+	/* TPM2_Startup(SU_STATE) on resume is cheap, don't bother. */
+	if (!IS_ENABLED(CONFIG_TPM_ASYNC_COMMANDS) || s3flag)
+		return;
+
+	if (tlcl_startup_async() != TPM_SUCCESS)
+		printk(BIOS_INFO, "TPM: Can't send early startup command.\n");
+}
+
 uint32_t tpm_clear_and_reenable(void)
 {
 	uint32_t result;
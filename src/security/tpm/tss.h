@@ -95,6 +95,13 @@ uint32_t tlcl_send_receive(const uint8_t *request, uint8_t *response,
  */
 uint32_t tlcl_startup(void);
 
+/**
+ * Send a TPM2_Startup(SU_CLEAR) without waiting for it to complete. The next
+ * tlcl_startup() returns its result instead of sending another one. Does
+ * nothing unless TPM_ASYNC_COMMANDS is enabled.
+ */
+uint32_t tlcl_startup_async(void);
+
 /**
  * Resume by sending a TPM_Startup(ST_STATE).  The TPM error code is returned
  * (0 for success).
@@ -21,46 +21,107 @@
  * TPM2 specification.
  */
 
-void *tpm_process_command(TPM_CC command, void *command_body)
+/* Command/response buffer. */
+static uint8_t cr_buffer[TPM_BUFFER_SIZE] CAR_GLOBAL;
+
+/* Command sent by tpm_send_async() whose response is still outstanding. */
+static TPM_CC async_command CAR_GLOBAL;
+
+static const uint8_t *tpm_marshal(TPM_CC command, void *command_body,
+				  size_t *out_size)
 {
 	struct obuf ob;
+
+	obuf_init(&ob, car_get_var_ptr(cr_buffer), sizeof(cr_buffer));
+
+	if (tpm_marshal_command(command, command_body, &ob) < 0) {
+		printk(BIOS_ERR, "command %#x\n", command);
+		return NULL;
+	}
+
+	return obuf_contents(&ob, out_size);
+}
+
+static struct tpm2_response *tpm_unmarshal(TPM_CC command, size_t in_size)
+{
 	struct ibuf ib;
+
+	ibuf_init(&ib, car_get_var_ptr(cr_buffer), in_size);
+
+	return tpm_unmarshal_response(command, &ib);
+}
+
+/*
+ * Hand a command to the TPM without waiting for it to complete. The response
+ * has to be collected with tpm_complete_async() before the next command.
+ */
+static int tpm_send_async(TPM_CC command, void *command_body)
+{
 	size_t out_size;
-	size_t in_size;
 	const uint8_t *sendb;
-	/* Command/response buffer. */
-	static uint8_t cr_buffer[TPM_BUFFER_SIZE] CAR_GLOBAL;
 
-	uint8_t *cr_buffer_ptr = car_get_var_ptr(cr_buffer);
+	sendb = tpm_marshal(command, command_body, &out_size);
+	if (!sendb)
+		return -1;
 
-	obuf_init(&ob, cr_buffer_ptr, sizeof(cr_buffer));
+	if (tis_send(sendb, out_size)) {
+		printk(BIOS_ERR, "tpm transaction failed\n");
+		return -1;
+	}
 
-	if (tpm_marshal_command(command, command_body, &ob) < 0) {
-		printk(BIOS_ERR, "command %#x\n", command);
+	car_set_var(async_command, command);
+
+	return 0;
+}
+
+static struct tpm2_response *tpm_complete_async(void)
+{
+	TPM_CC command = car_get_var(async_command);
+	size_t in_size = sizeof(cr_buffer);
+
+	car_set_var(async_command, 0);
+
+	if (tis_recv(car_get_var_ptr(cr_buffer), &in_size)) {
+		printk(BIOS_ERR, "tpm transaction failed\n");
 		return NULL;
 	}
 
-	sendb = obuf_contents(&ob, &out_size);
+	return tpm_unmarshal(command, in_size);
+}
+
+void *tpm_process_command(TPM_CC command, void *command_body)
+{
+	size_t out_size;
+	size_t in_size;
+	const uint8_t *sendb;
+
+	/* Only one command can be in flight, finish the previous one. */
+	if (IS_ENABLED(CONFIG_TPM_ASYNC_COMMANDS) &&
+	    car_get_var(async_command)) {
+		TPM_CC pending = car_get_var(async_command);
+		struct tpm2_response *response = tpm_complete_async();
+
+		printk(BIOS_INFO, "%s: dropped response %x to command %#x\n",
+		       __func__, response ? response->hdr.tpm_code : -1,
+		       pending);
+	}
+
+	sendb = tpm_marshal(command, command_body, &out_size);
+	if (!sendb)
+		return NULL;
 
 	in_size = sizeof(cr_buffer);
-	if (tis_sendrecv(sendb, out_size, cr_buffer_ptr, &in_size)) {
+	if (tis_sendrecv(sendb, out_size, car_get_var_ptr(cr_buffer),
+			 &in_size)) {
 		printk(BIOS_ERR, "tpm transaction failed\n");
 		return NULL;
 	}
 
-	ibuf_init(&ib, cr_buffer_ptr, in_size);
-
-	return tpm_unmarshal_response(command, &ib);
+	return tpm_unmarshal(command, in_size);
 }
 
-static uint32_t tlcl_send_startup(TPM_SU type)
+static uint32_t tlcl_check_startup(struct tpm2_response *response)
 {
-	struct tpm2_startup startup;
-	struct tpm2_response *response;
-
-	startup.startup_type = type;
-	response = tpm_process_command(TPM2_Startup, &startup);
-
 	if (response && response->hdr.tpm_code &&
 	    (response->hdr.tpm_code != TPM_RC_INITIALIZE)) {
 		printk(BIOS_INFO, "%s: Startup return code is %x\n",
@@ -68,7 +129,16 @@ static uint32_t tlcl_send_startup(TPM_SU type)
 		return TPM_E_IOERROR;
 	}
 	return TPM_SUCCESS;
+}
 
+static uint32_t tlcl_send_startup(TPM_SU type)
+{
+	struct tpm2_startup startup;
+
+	startup.startup_type = type;
+
+	return tlcl_check_startup(tpm_process_command(TPM2_Startup,
+						      &startup));
 }
 
 uint32_t tlcl_resume(void)
@@ -237,9 +307,34 @@ uint32_t tlcl_lock_nv_write(uint32_t index)
 
 uint32_t tlcl_startup(void)
 {
+	/* Pick up the result of tlcl_startup_async(), if it got sent. */
+	if (IS_ENABLED(CONFIG_TPM_ASYNC_COMMANDS) &&
+	    car_get_var(async_command) == TPM2_Startup)
+		return tlcl_check_startup(tpm_complete_async());
+
 	return tlcl_send_startup(TPM_SU_CLEAR);
 }
 
+uint32_t tlcl_startup_async(void)
+{
+	struct tpm2_startup startup;
+	uint32_t result;
+
+	/* Without split transactions tlcl_startup() does all the work. */
+	if (!IS_ENABLED(CONFIG_TPM_ASYNC_COMMANDS))
+		return TPM_SUCCESS;
+
+	result = tlcl_lib_init();
+	if (result != TPM_SUCCESS)
+		return result;
+
+	startup.startup_type = TPM_SU_CLEAR;
+	if (tpm_send_async(TPM2_Startup, &startup))
+		return TPM_E_IOERROR;
+
+	return TPM_SUCCESS;
+}
+
 uint32_t tlcl_write(uint32_t index, const void *data, uint32_t length)
 {
 	struct tpm2_nv_write_cmd nv_writec;
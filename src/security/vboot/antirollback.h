@@ -85,6 +85,9 @@ uint32_t antirollback_lock_space_rec_hash(void);
 /* Start of the root of trust */
 uint32_t vboot_setup_tpm(struct vb2_context *ctx);
 
+/* Get the TPM starting up early, vboot_setup_tpm() finishes the job. */
+void vboot_start_tpm(struct vb2_context *ctx);
+
 /* vboot_extend_pcr function for vb2 context */
 uint32_t vboot_extend_pcr(struct vb2_context *ctx, int pcr,
 			enum vb2_pcr_digest which_digest);
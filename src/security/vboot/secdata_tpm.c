@@ -457,6 +457,11 @@ uint32_t vboot_setup_tpm(struct vb2_context *ctx)
 	return result;
 }
 
+void vboot_start_tpm(struct vb2_context *ctx)
+{
+	tpm_start_setup(ctx->flags & VB2_CONTEXT_S3_RESUME);
+}
+
 uint32_t antirollback_read_space_firmware(struct vb2_context *ctx)
 {
 	uint32_t rv;
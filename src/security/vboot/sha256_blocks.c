@@ -0,0 +1,124 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright 2018 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * vboot hash hooks for CPUs with SHA-256 instructions. The architecture only
+ * supplies the block transform; buffering and padding live here. CPUs that
+ * lack the instructions report the algorithm as unsupported and vboot falls
+ * back to its own C implementation.
+ */
+
+#include <arch/early_variables.h>
+#include <console/console.h>
+#include <endian.h>
+#include <security/vboot/sha256_blocks.h>
+#include <string.h>
+#include <types.h>
+#include <vb2_api.h>
+
+#define SHA256_BLOCK_SIZE	64
+#define SHA256_DIGEST_SIZE	32
+
+static const uint32_t sha256_h0[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+struct sha256_blocks_ctx {
+	uint32_t state[8];
+	uint8_t buf[SHA256_BLOCK_SIZE];
+	size_t buf_len;
+	uint64_t total;
+};
+
+static struct sha256_blocks_ctx sha256_ctx CAR_GLOBAL;
+
+int vb2ex_hwcrypto_digest_init(enum vb2_hash_algorithm hash_alg,
+			       uint32_t data_size)
+{
+	struct sha256_blocks_ctx *ctx = car_get_var_ptr(&sha256_ctx);
+
+	if (hash_alg != VB2_HASH_SHA256 || !sha256_blocks_init())
+		return VB2_ERROR_EX_HWCRYPTO_UNSUPPORTED;
+
+	memcpy(ctx->state, sha256_h0, sizeof(ctx->state));
+	ctx->buf_len = 0;
+	ctx->total = 0;
+
+	printk(BIOS_DEBUG, "Using SHA-256 instructions for %u byte SHA256\n",
+	       data_size);
+	return VB2_SUCCESS;
+}
+
+int vb2ex_hwcrypto_digest_extend(const uint8_t *buf, uint32_t size)
+{
+	struct sha256_blocks_ctx *ctx = car_get_var_ptr(&sha256_ctx);
+	size_t blocks;
+
+	ctx->total += size;
+
+	if (ctx->buf_len) {
+		size_t fill = MIN(size, SHA256_BLOCK_SIZE - ctx->buf_len);
+
+		memcpy(ctx->buf + ctx->buf_len, buf, fill);
+		ctx->buf_len += fill;
+		buf += fill;
+		size -= fill;
+		if (ctx->buf_len < SHA256_BLOCK_SIZE)
+			return VB2_SUCCESS;
+		sha256_blocks_transform(ctx->state, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+
+	blocks = size / SHA256_BLOCK_SIZE;
+	if (blocks) {
+		sha256_blocks_transform(ctx->state, buf, blocks);
+		buf += blocks * SHA256_BLOCK_SIZE;
+		size -= blocks * SHA256_BLOCK_SIZE;
+	}
+
+	memcpy(ctx->buf, buf, size);
+	ctx->buf_len = size;
+
+	return VB2_SUCCESS;
+}
+
+int vb2ex_hwcrypto_digest_finalize(uint8_t *digest, uint32_t digest_size)
+{
+	struct sha256_blocks_ctx *ctx = car_get_var_ptr(&sha256_ctx);
+	uint64_t bits = cpu_to_be64(ctx->total * 8);
+	int i;
+
+	if (digest_size != SHA256_DIGEST_SIZE)
+		return VB2_ERROR_UNKNOWN;
+
+	ctx->buf[ctx->buf_len++] = 0x80;
+	if (ctx->buf_len > SHA256_BLOCK_SIZE - sizeof(uint64_t)) {
+		memset(ctx->buf + ctx->buf_len, 0,
+		       SHA256_BLOCK_SIZE - ctx->buf_len);
+		sha256_blocks_transform(ctx->state, ctx->buf, 1);
+		ctx->buf_len = 0;
+	}
+	memset(ctx->buf + ctx->buf_len, 0,
+	       SHA256_BLOCK_SIZE - sizeof(uint64_t) - ctx->buf_len);
+	memcpy(ctx->buf + SHA256_BLOCK_SIZE - sizeof(bits), &bits, sizeof(bits));
+	sha256_blocks_transform(ctx->state, ctx->buf, 1);
+
+	for (i = 0; i < ARRAY_SIZE(ctx->state); i++)
+		ctx->state[i] = cpu_to_be32(ctx->state[i]);
+	memcpy(digest, ctx->state, SHA256_DIGEST_SIZE);
+
+	return VB2_SUCCESS;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright 2018 Google Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __VBOOT_SHA256_BLOCKS_H__
+#define __VBOOT_SHA256_BLOCKS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Architecture hooks for CPUs with SHA-256 instructions. sha256_blocks.c
+ * builds the vb2ex_hwcrypto_digest_*() functions on top of them.
+ */
+
+/* Returns 1 if sha256_blocks_transform() can run on this CPU, 0 if not. */
+int sha256_blocks_init(void);
+
+/* Hash 'blocks' (non-zero) consecutive 64-byte blocks into 'state'. */
+void sha256_blocks_transform(uint32_t state[8], const uint8_t *data,
+			     size_t blocks);
+
+#endif /* __VBOOT_SHA256_BLOCKS_H__ */
@@ -103,6 +103,12 @@ int vboot_platform_is_resuming(void);
  */
 void verstage_main(void);
 void verstage_mainboard_init(void);
+/*
+ * Called when verstage starts so the EC can get ahead on the work for EC
+ * software sync, e.g. hashing its RW image, while the AP firmware is
+ * verified.
+ */
+void vboot_ec_sync_prepare(void);
 
 /* Check boot modes */
 #if IS_ENABLED(CONFIG_VBOOT)
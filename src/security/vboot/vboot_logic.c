@@ -31,8 +31,6 @@
 /* The max hash size to expect is for SHA512. */
 #define VBOOT_MAX_HASH_SIZE VB2_SHA512_DIGEST_SIZE
 
-#define TODO_BLOCK_SIZE 1024
-
 static int is_slot_a(struct vb2_context *ctx)
 {
 	return !(ctx->flags & VB2_CONTEXT_FW_SLOT_B);
@@ -108,6 +106,11 @@ int vb2ex_hwcrypto_digest_finalize(uint8_t *digest, uint32_t digest_size)
 	return VB2_ERROR_UNKNOWN;
 }
 
+__weak
+void vboot_ec_sync_prepare(void)
+{
+}
+
 static int handle_digest_result(void *slot_hash, size_t slot_hash_sz)
 {
 	int is_resume;
@@ -175,10 +178,11 @@ static int hash_body(struct vb2_context *ctx, struct region_device *fw_main)
 {
 	uint64_t load_ts;
 	uint32_t expected_size;
-	uint8_t block[TODO_BLOCK_SIZE];
+	uint8_t block[IS_ENABLED(CONFIG_BOOT_DEVICE_MEMORY_MAPPED) ? 1 :
+		      CONFIG_VBOOT_HASH_BLOCK_SIZE];
 	uint8_t hash_digest[VBOOT_MAX_HASH_SIZE];
 	const size_t hash_digest_sz = sizeof(hash_digest);
-	size_t block_size = sizeof(block);
+	size_t block_size = CONFIG_VBOOT_HASH_BLOCK_SIZE;
 	size_t offset;
 	int rv;
 
@@ -217,15 +221,28 @@ static int hash_body(struct vb2_context *ctx, struct region_device *fw_main)
 	/* Extend over the body */
 	while (expected_size) {
 		uint64_t temp_ts;
+		void *data;
+
 		if (block_size > expected_size)
 			block_size = expected_size;
 
+		/* Memory mapped media can be hashed in place, saving a copy
+		 * of the whole body through the block buffer. */
 		temp_ts = timestamp_get();
-		if (rdev_readat(fw_main, block, offset, block_size) < 0)
-			return VB2_ERROR_UNKNOWN;
+		if (IS_ENABLED(CONFIG_BOOT_DEVICE_MEMORY_MAPPED)) {
+			data = rdev_mmap(fw_main, offset, block_size);
+			if (data == NULL)
+				return VB2_ERROR_UNKNOWN;
+		} else {
+			data = block;
+			if (rdev_readat(fw_main, block, offset, block_size) < 0)
+				return VB2_ERROR_UNKNOWN;
+		}
 		load_ts += timestamp_get() - temp_ts;
 
-		rv = vb2api_extend_hash(ctx, block, block_size);
+		rv = vb2api_extend_hash(ctx, data, block_size);
+		if (IS_ENABLED(CONFIG_BOOT_DEVICE_MEMORY_MAPPED))
+			rdev_munmap(fw_main, data);
 		if (rv)
 			return rv;
 
@@ -302,9 +319,6 @@ void verstage_main(void)
 	/* Set up context and work buffer */
 	vb2_init_work_context(&ctx);
 
-	/* Initialize and read nvdata from non-volatile storage. */
-	vbnv_init(ctx.nvdata);
-
 	/* Set S3 resume flag if vboot should behave differently when selecting
 	 * which slot to boot.  This is only relevant to vboot if the platform
 	 * does verification of memory init and thus must ensure it resumes with
@@ -314,6 +328,15 @@ void verstage_main(void)
 	    vboot_platform_is_resuming())
 		ctx.flags |= VB2_CONTEXT_S3_RESUME;
 
+	/* Let the TPM start up while nvdata is being read. */
+	vboot_start_tpm(&ctx);
+
+	if (IS_ENABLED(CONFIG_VBOOT_EC_SOFTWARE_SYNC))
+		vboot_ec_sync_prepare();
+
+	/* Initialize and read nvdata from non-volatile storage. */
+	vbnv_init(ctx.nvdata);
+
 	/* Read secdata from TPM. Initialize TPM if secdata not found. We don't
 	 * check the return value here because vb2api_fw_phase1 will catch
 	 * invalid secdata and tell us what to do (=reboot). */
@@ -305,16 +305,7 @@ void smm_initialize(void)
  * parallel SMM relocation is even feasible. */
 void smm_relocate(void)
 {
-	/*
-	 * If smm_save_state_in_msrs is non-zero then parallel SMM relocation
-	 * shall take place. Run the relocation handler a second time on the
-	 * BSP to do * the final move. For APs, a relocation handler always
-	 * needs to be run.
-	 */
-	if (smm_reloc_params.smm_save_state_in_msrs)
-		smm_initiate_relocation_parallel();
-	else if (!boot_cpu())
-		smm_initiate_relocation();
+	smm_relocate_cpu(smm_reloc_params.smm_save_state_in_msrs);
 }
 
 void smm_lock(void)
@@ -91,25 +91,26 @@ void bootblock_pch_early_init(void)
 static void soc_config_acpibase(void)
 {
 	uint32_t pmc_reg_value;
-
-	pmc_reg_value = pcr_read32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
-						PCR_PSFX_TO_SHDW_BAR4);
-
-	if (pmc_reg_value != 0xFFFFFFFF)
-	{
+	static const struct pcr_rmw32_op abase_ops[] = {
 		/* Disable Io Space before changing the address */
-		pcr_rmw32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
+		PCR_RMW32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
 				PCR_PSFX_T0_SHDW_PCIEN,
-				~PCR_PSFX_TO_SHDW_PCIEN_IOEN, 0);
+				~PCR_PSFX_TO_SHDW_PCIEN_IOEN, 0),
 		/* Program ABASE in PSF3 PMC space BAR4*/
-		pcr_write32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
+		PCR_WRITE32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
 				PCR_PSFX_TO_SHDW_BAR4,
-				ACPI_BASE_ADDRESS);
+				ACPI_BASE_ADDRESS),
 		/* Enable IO Space */
-		pcr_rmw32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
+		PCR_RMW32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
 				PCR_PSFX_T0_SHDW_PCIEN,
-				~0, PCR_PSFX_TO_SHDW_PCIEN_IOEN);
-	}
+				~0, PCR_PSFX_TO_SHDW_PCIEN_IOEN),
+	};
+
+	pmc_reg_value = pcr_read32(PID_PSF3, PCR_PSF3_TO_SHDW_PMC_REG_BASE +
+						PCR_PSFX_TO_SHDW_BAR4);
+
+	if (pmc_reg_value != 0xFFFFFFFF)
+		pcr_rmw32_list(abase_ops, ARRAY_SIZE(abase_ops));
 }
 
 static void soc_config_tco(void)
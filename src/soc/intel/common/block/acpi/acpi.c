@@ -414,6 +414,7 @@ void generate_cpu_entries(struct device *device)
 	int totalcores = dev_count_cpu();
 	int cores_per_package = get_cores_per_package();
 	int numcpus = totalcores / cores_per_package;
+	struct acpigen_template cst;
 
 	printk(BIOS_DEBUG, "Found %d CPU(s) with %d core(s) each.\n",
 	       numcpus, cores_per_package);
@@ -429,8 +430,17 @@ void generate_cpu_entries(struct device *device)
 			acpigen_write_processor((cpu_id) * cores_per_package +
 						core_id, pcontrol_blk, plen);
 
-			/* Generate C-state tables */
-			generate_c_state_entries();
+			/*
+			 * Generate C-state tables. They are the same for all
+			 * cores, so the first ones are copied for the others.
+			 */
+			if (cpu_id == 0 && core_id == 0) {
+				acpigen_template_begin(&cst);
+				generate_c_state_entries();
+				acpigen_template_end(&cst);
+			} else {
+				acpigen_template_emit(&cst);
+			}
 
 			/* Soc specific power states generation */
 			soc_power_states_generation(core_id, cores_per_package);
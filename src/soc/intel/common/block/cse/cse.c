@@ -25,6 +25,7 @@
 #include <soc/iomap.h>
 #include <soc/pci_devs.h>
 #include <string.h>
+#include <thread.h>
 #include <timer.h>
 
 #define MAX_HECI_MESSAGE_RETRY_COUNT 5
@@ -490,6 +491,51 @@ int heci_reset(void)
 	return 0;
 }
 
+/* Only one transaction may own the HECI circular buffers at a time. */
+static struct thread_sem heci_lock = { .count = 1 };
+
+static void heci_transaction_run(void *arg)
+{
+	struct heci_transaction *t = arg;
+
+	thread_sem_down(&heci_lock);
+
+	if (t->reset && !heci_reset())
+		t->status = 0;
+	else
+		t->status = heci_send(t->msg, t->len, t->host_addr,
+				      t->client_addr) &&
+			    heci_receive(t->reply, &t->reply_size);
+
+	thread_sem_up(&heci_lock);
+
+	t->done = 1;
+	thread_wake_all(&t->waitq);
+}
+
+void heci_transaction_start(struct heci_transaction *t,
+			    boot_state_t state, boot_state_sequence_t seq)
+{
+	t->status = 0;
+	t->done = 0;
+	t->waitq.waiters = NULL;
+
+	if (thread_run_until(heci_transaction_run, t, state, seq) < 0)
+		heci_transaction_run(t);
+}
+
+int heci_transaction_wait(struct heci_transaction *t)
+{
+	while (!t->done) {
+		if (thread_wait(&t->waitq) < 0) {
+			printk(BIOS_ERR, "HECI: can't wait for transaction\n");
+			return 0;
+		}
+	}
+
+	return t->status;
+}
+
 #if ENV_RAMSTAGE
 
 static void update_sec_bar(struct device *dev)
@@ -98,6 +98,9 @@
 /* Maximum bytes of data that can fit in FDATAn (0x10) registers */
 #define SPIBAR_FDATA_FIFO_SIZE		0x40
 
+/* At most 16 MiB of the BIOS region are memory mapped below 4 GiB. */
+#define SPIBAR_BIOS_MMAP_MAX_SIZE	(16 * MiB)
+
 /* Bit definitions for FDOC (0xB4) register */
 #define SPIBAR_FDOC_COMPONENT		(1 << 12)
 #define SPIBAR_FDOC_FDSI_1		(1 << 2)
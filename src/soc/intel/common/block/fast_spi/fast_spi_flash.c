@@ -86,20 +86,37 @@ static uint32_t fast_spi_flash_read_sfdp_param(struct fast_spi_flash_ctx *ctx,
 	return fast_spi_flash_ctrlr_reg_read(ctx, SPIBAR_PTDATA);
 }
 
-/* Fill FDATAn FIFO in preparation for a write transaction. */
+/*
+ * Fill FDATAn FIFO in preparation for a write transaction. FDATAn does not
+ * require 32-bit accesses, but they take a quarter of the MMIO cycles of a
+ * bytewise memcpy(). Bytes past len are don't care, as FDBC bounds the cycle.
+ */
 static void fill_xfer_fifo(struct fast_spi_flash_ctx *ctx, const void *data,
 			   size_t len)
 {
-	/* YES! memcpy() works. FDATAn does not require 32-bit accesses. */
-	memcpy((void *)(ctx->mmio_base + SPIBAR_FDATA(0)), data, len);
+	const uint8_t *src = data;
+	uint32_t val;
+	size_t i;
+
+	for (i = 0; i < len; i += sizeof(val)) {
+		val = 0;
+		memcpy(&val, src + i, min(sizeof(val), len - i));
+		write32((void *)(ctx->mmio_base + SPIBAR_FDATA(0) + i), val);
+	}
 }
 
 /* Drain FDATAn FIFO after a read transaction populates data. */
 static void drain_xfer_fifo(struct fast_spi_flash_ctx *ctx, void *dest,
 				size_t len)
 {
-	/* YES! memcpy() works. FDATAn does not require 32-bit accesses. */
-	memcpy(dest, (void *)(ctx->mmio_base + SPIBAR_FDATA(0)), len);
+	uint8_t *dst = dest;
+	uint32_t val;
+	size_t i;
+
+	for (i = 0; i < len; i += sizeof(val)) {
+		val = read32((void *)(ctx->mmio_base + SPIBAR_FDATA(0) + i));
+		memcpy(dst + i, &val, min(sizeof(val), len - i));
+	}
 }
 
 /* Fire up a transfer using the hardware sequencer. */
@@ -152,8 +169,8 @@ static int exec_sync_hwseq_xfer(struct fast_spi_flash_ctx *ctx,
 }
 
 /*
- * Ensure read/write xfer len is not greater than SPIBAR_FDATA_FIFO_SIZE and
- * that the operation does not cross page boundary.
+ * Ensure write xfer len is not greater than SPIBAR_FDATA_FIFO_SIZE and that
+ * the operation does not cross page boundary.
  */
 static size_t get_xfer_len(const struct spi_flash *flash, uint32_t addr,
 			   size_t len)
@@ -167,6 +184,41 @@ static size_t get_xfer_len(const struct spi_flash *flash, uint32_t addr,
 	return xfer_len;
 }
 
+/*
+ * Set once this stage programs or erases the flash. The memory mapped BIOS
+ * region may be cached, so later reads have to go through the sequencer.
+ */
+static bool mmap_stale CAR_GLOBAL;
+
+/*
+ * Return a pointer to [addr, addr + len) in the memory mapped BIOS region,
+ * or NULL if it isn't entirely decoded there. The region ends right below
+ * 4 GiB, minus what the platform reserves for other purposes.
+ */
+static const void *fast_spi_flash_mmap(uint32_t addr, size_t len)
+{
+	size_t bios_start, bios_size, mapped_start, mapped_end;
+
+	if (car_get_var(mmap_stale))
+		return NULL;
+
+	bios_start = fast_spi_get_bios_region(&bios_size);
+	if (bios_size <= CONFIG_FAST_SPI_MMAP_RESERVED_SIZE)
+		return NULL;
+
+	mapped_end = bios_start + bios_size -
+		CONFIG_FAST_SPI_MMAP_RESERVED_SIZE;
+	mapped_start = bios_start;
+	if (bios_size > SPIBAR_BIOS_MMAP_MAX_SIZE)
+		mapped_start += bios_size - SPIBAR_BIOS_MMAP_MAX_SIZE;
+
+	if (addr < mapped_start || addr >= mapped_end ||
+	    len > mapped_end - addr)
+		return NULL;
+
+	return (void *)(uintptr_t)(4ULL * GiB - bios_size +
+				   (addr - bios_start));
+}
 
 static int fast_spi_flash_erase(const struct spi_flash *flash,
 				uint32_t offset, size_t len)
@@ -182,6 +234,8 @@ static int fast_spi_flash_erase(const struct spi_flash *flash,
 		return E_ARGUMENT;
 	}
 
+	car_set_var(mmap_stale, true);
+
 	while (len) {
 		if (IS_ALIGNED(offset, 64 * KiB) && (len >= 64 * KiB)) {
 			erase_size = 64 * KiB;
@@ -210,11 +264,23 @@ static int fast_spi_flash_read(const struct spi_flash *flash,
 	int ret;
 	size_t xfer_len;
 	uint8_t *data = buf;
+	const void *mapped;
 
 	BOILERPLATE_CREATE_CTX(ctx);
 
+	mapped = fast_spi_flash_mmap(addr, len);
+	if (mapped) {
+		memcpy(buf, mapped, len);
+		return SUCCESS;
+	}
+
 	while (len) {
-		xfer_len = get_xfer_len(flash, addr, len);
+		/*
+		 * Reads may cross page boundaries, so each cycle moves a full
+		 * FIFO's worth and the next one is started right after the
+		 * FIFO is drained.
+		 */
+		xfer_len = min(len, SPIBAR_FDATA_FIFO_SIZE);
 
 		ret = exec_sync_hwseq_xfer(ctx, SPIBAR_HSFSTS_CYCLE_READ,
 						addr, xfer_len);
@@ -240,6 +306,8 @@ static int fast_spi_flash_write(const struct spi_flash *flash,
 
 	BOILERPLATE_CREATE_CTX(ctx);
 
+	car_set_var(mmap_stale, true);
+
 	while (len) {
 		xfer_len = get_xfer_len(flash, addr, len);
 		fill_xfer_fifo(ctx, data, xfer_len);
@@ -279,6 +347,9 @@ const struct spi_flash_ops fast_spi_flash_ops = {
 	.status = fast_spi_flash_status,
 };
 
+/* The controller requires SFDP 1.5 or newer, which has 16 DWORD tables. */
+#define FAST_SPI_BFPT_DWORDS	16
+
 /*
  * We can't use FDOC and FDOD to read FLCOMP, as previous platforms did.
  * For details see:
@@ -290,26 +361,32 @@ static int fast_spi_flash_probe(const struct spi_slave *dev,
 				struct spi_flash *flash)
 {
 	BOILERPLATE_CREATE_CTX(ctx);
-	uint32_t flash_bits;
+	uint32_t bfpt[FAST_SPI_BFPT_DWORDS];
+	struct sfdp_params params;
+	size_t i;
 
-	/*
-	 * bytes = (bits + 1) / 8;
-	 * But we need to do the addition in a way which doesn't overflow for
-	 * 4 Gbit devices (flash_bits == 0xffffffff).
-	 */
-	flash_bits = fast_spi_flash_read_sfdp_param(ctx, 0x04);
-	flash->size = (flash_bits >> 3) + 1;
+	for (i = 0; i < ARRAY_SIZE(bfpt); i++)
+		bfpt[i] = fast_spi_flash_read_sfdp_param(ctx,
+						i * sizeof(uint32_t));
+
+	if (sfdp_parse_bfpt(bfpt, ARRAY_SIZE(bfpt), &params)) {
+		printk(BIOS_ERR, "FAST_SPI: Invalid SFDP parameter table\n");
+		return -1;
+	}
 
 	memcpy(&flash->spi, dev, sizeof(*dev));
 	flash->name = "FAST_SPI Hardware Sequencer";
+	flash->size = params.size;
+	flash->page_size = params.page_size;
 
 	/* Can erase both 4 KiB and 64 KiB chunks. Declare the smaller size. */
 	flash->sector_size = 4 * KiB;
-	flash->page_size = 256;
+	for (i = 0; i < ARRAY_SIZE(params.erase); i++)
+		if (params.erase[i].shift == 12)
+			flash->erase_cmd = params.erase[i].opcode;
 	/*
-	 * FIXME: Get erase+cmd, and status_cmd from SFDP.
+	 * FIXME: Get status_cmd from SFDP.
 	 *
-	 * flash->erase_cmd = ???
 	 * flash->status_cmd = ???
 	 */
 
@@ -89,12 +89,6 @@ static inline size_t gpio_group_index(const struct pad_community *comm,
 	return i;
 }
 
-static inline size_t gpio_group_index_scaled(const struct pad_community *comm,
-					unsigned int relative_pad, size_t scale)
-{
-	return gpio_group_index(comm, relative_pad) * scale;
-}
-
 static inline size_t gpio_within_group(const struct pad_community *comm,
 						unsigned int relative_pad)
 {
@@ -127,53 +121,6 @@ static const struct pad_community *gpio_get_community(gpio_t pad)
 	return NULL;
 }
 
-static void gpio_configure_owner(const struct pad_config *cfg,
-				const struct pad_community *comm)
-{
-	uint16_t hostsw_reg;
-	int pin;
-
-	pin = relative_pad_in_comm(comm, cfg->pad);
-
-	/* The 4th bit in pad_config 1 (RO) is used to indicate if the pad
-	 * needs GPIO driver ownership.
-	 */
-	if (!(cfg->pad_config[1] & PAD_CFG1_GPIO_DRIVER))
-		return;
-
-	/* Based on the gpio pin number configure the corresponding bit in
-	 * HOSTSW_OWN register. Value of 0x1 indicates GPIO Driver onwership.
-	 */
-	hostsw_reg = comm->host_own_reg_0;
-	hostsw_reg += gpio_group_index_scaled(comm, pin, sizeof(uint32_t));
-	pcr_or32(comm->port, hostsw_reg, gpio_bitmask_within_group(comm, pin));
-}
-
-static void gpi_enable_smi(const struct pad_config *cfg,
-				const struct pad_community *comm)
-{
-	uint32_t value;
-	uint16_t sts_reg;
-	uint16_t en_reg;
-	int group;
-	int pin;
-
-	if (((cfg->pad_config[0]) & PAD_CFG0_ROUTE_SMI) != PAD_CFG0_ROUTE_SMI)
-		return;
-
-	pin = relative_pad_in_comm(comm, cfg->pad);
-	group = gpio_group_index(comm, pin);
-
-	sts_reg = GPI_SMI_STS_OFFSET(comm, group);
-	value = pcr_read32(comm->port, sts_reg);
-	/* Write back 1 to reset the sts bits */
-	pcr_write32(comm->port, sts_reg, value);
-
-	/* Set enable bits */
-	en_reg = GPI_SMI_EN_OFFSET(comm, group);
-	pcr_or32(comm->port, en_reg, gpio_bitmask_within_group(comm, pin));
-}
-
 static void gpio_configure_itss(const struct pad_config *cfg, uint16_t port,
 	uint16_t  pad_cfg_offset)
 {
@@ -245,15 +192,61 @@ static const int mask[4] = {
 	PAD_DW0_MASK, PAD_DW1_MASK, PAD_DW2_MASK, PAD_DW3_MASK
 };
 
-static void gpio_configure_pad(const struct pad_config *cfg)
+/*
+ * HOSTSW_OWN and the GPI SMI registers hold one bit per pad of a group. Pad
+ * tables collect those bits and write each group once instead of doing a
+ * read-modify-write for every pad.
+ */
+struct gpio_group_bits {
+	const struct pad_community *comm;
+	size_t group;
+	uint32_t host_own;
+	uint32_t smi_en;
+};
+
+static void gpio_group_bits_flush(struct gpio_group_bits *bits)
+{
+	const struct pad_community *comm = bits->comm;
+	uint16_t reg;
+
+	if (comm == NULL)
+		return;
+
+	/* Value of 0x1 indicates GPIO Driver ownership. */
+	if (bits->host_own) {
+		reg = comm->host_own_reg_0 + bits->group * sizeof(uint32_t);
+		pcr_or32(comm->port, reg, bits->host_own);
+	}
+
+	if (bits->smi_en) {
+		reg = GPI_SMI_STS_OFFSET(comm, bits->group);
+		/* Write back 1 to reset the sts bits */
+		pcr_write32(comm->port, reg, pcr_read32(comm->port, reg));
+		pcr_or32(comm->port, GPI_SMI_EN_OFFSET(comm, bits->group),
+			bits->smi_en);
+	}
+
+	bits->comm = NULL;
+	bits->host_own = 0;
+	bits->smi_en = 0;
+}
+
+static void gpio_configure_pad_batched(const struct pad_config *cfg,
+				const struct pad_community *comm,
+				struct gpio_group_bits *bits)
 {
-	const struct pad_community *comm = gpio_get_community(cfg->pad);
 	uint16_t config_offset;
 	uint32_t pad_conf, soc_pad_conf;
+	size_t pin, group;
+	uint32_t bit;
 	int i;
 
 	config_offset = pad_config_offset(comm, cfg->pad);
 	for (i = 0; i < GPIO_NUM_PAD_CFG_REGS; i++) {
+		/* Nothing to change, skip the read and write back. */
+		if (!mask[i])
+			continue;
+
 		pad_conf = pcr_read32(comm->port,
 			PAD_CFG_OFFSET(config_offset, i));
 
@@ -276,16 +269,56 @@ static void gpio_configure_pad(const struct pad_config *cfg)
 			soc_pad_conf);
 	}
 	gpio_configure_itss(cfg, comm->port, config_offset);
-	gpio_configure_owner(cfg, comm);
-	gpi_enable_smi(cfg, comm);
+
+	pin = relative_pad_in_comm(comm, cfg->pad);
+	group = gpio_group_index(comm, pin);
+	bit = 1U << (pin - comm->groups[group].first_pad);
+
+	if (bits->comm != comm || bits->group != group) {
+		gpio_group_bits_flush(bits);
+		bits->comm = comm;
+		bits->group = group;
+	}
+
+	/* The 4th bit in pad_config 1 (RO) is used to indicate if the pad
+	 * needs GPIO driver ownership.
+	 */
+	if (cfg->pad_config[1] & PAD_CFG1_GPIO_DRIVER)
+		bits->host_own |= bit;
+
+	if ((cfg->pad_config[0] & PAD_CFG0_ROUTE_SMI) == PAD_CFG0_ROUTE_SMI)
+		bits->smi_en |= bit;
+}
+
+static void gpio_configure_pad(const struct pad_config *cfg)
+{
+	struct gpio_group_bits bits = { NULL };
+
+	gpio_configure_pad_batched(cfg, gpio_get_community(cfg->pad), &bits);
+	gpio_group_bits_flush(&bits);
+}
+
+/* Pad tables are mostly sorted, so keep the community of the last pad. */
+static const struct pad_community *gpio_get_community_cached(gpio_t pad,
+				const struct pad_community *last)
+{
+	if (last != NULL && pad >= last->first_pad && pad <= last->last_pad)
+		return last;
+
+	return gpio_get_community(pad);
 }
 
 void gpio_configure_pads(const struct pad_config *cfg, size_t num_pads)
 {
+	struct gpio_group_bits bits = { NULL };
+	const struct pad_community *comm = NULL;
 	size_t i;
 
-	for (i = 0; i < num_pads; i++)
-		gpio_configure_pad(cfg + i);
+	for (i = 0; i < num_pads; i++) {
+		comm = gpio_get_community_cached(cfg[i].pad, comm);
+		gpio_configure_pad_batched(cfg + i, comm, &bits);
+	}
+	gpio_group_bits_flush(&bits);
 }
 
 /*
@@ -315,14 +348,18 @@ void gpio_configure_pads_with_override(const struct pad_config *base_cfg,
 					const struct pad_config *override_cfg,
 					size_t override_num_pads)
 {
+	struct gpio_group_bits bits = { NULL };
+	const struct pad_community *comm = NULL;
 	size_t i;
 	const struct pad_config *c;
 
 	for (i = 0; i < base_num_pads; i++) {
 		c = gpio_get_config(base_cfg + i, override_cfg,
 				override_num_pads);
-		gpio_configure_pad(c);
+		comm = gpio_get_community_cached(c->pad, comm);
+		gpio_configure_pad_batched(c, comm, &bits);
 	}
+	gpio_group_bits_flush(&bits);
 }
 
 void *gpio_dwx_address(const gpio_t pad)
@@ -17,7 +17,10 @@
 #ifndef SOC_INTEL_COMMON_CSE_H
 #define SOC_INTEL_COMMON_CSE_H
 
+#include <bootstate.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <thread.h>
 
 /* set up device for use in early boot enviroument with temp bar */
 void heci_init(uintptr_t bar);
@@ -44,6 +47,44 @@ heci_send(const void *msg, size_t len, uint8_t host_addr, uint8_t cse_addr);
  */
 int heci_reset(void);
 
+/*
+ * A send/receive exchange with the CSE that runs while the rest of ramstage
+ * carries on. The caller fills in everything above 'status' and keeps the
+ * structure alive until heci_transaction_wait() has returned.
+ */
+struct heci_transaction {
+	const void *msg;
+	size_t len;
+	uint8_t host_addr;
+	uint8_t client_addr;
+	/* Issue heci_reset() before sending msg. */
+	int reset;
+	void *reply;
+	/* Size of reply on entry, size of the received message on return. */
+	size_t reply_size;
+
+	int status;
+	int done;
+	struct thread_waitq waitq;
+};
+
+/*
+ * Start transaction t in its own thread. It is polled in the background
+ * whenever other code yields (e.g. in udelay()) and has to be complete
+ * before boot state 'state' moves past 'seq'. Without COOP_MULTITASKING or
+ * outside of ramstage the transaction runs to completion right away.
+ * Transactions are serialized against each other, but not against the
+ * heci_send()/heci_receive() calls above: don't use those while a
+ * transaction is in flight.
+ */
+void heci_transaction_start(struct heci_transaction *t,
+			    boot_state_t state, boot_state_sequence_t seq);
+/*
+ * Wait for transaction t to complete. Returns 1 if the message was sent and
+ * a reply received and 0 otherwise.
+ */
+int heci_transaction_wait(struct heci_transaction *t);
+
 #define BIOS_HOST_ADDR							0x00
 #define HECI_MKHI_ADDR							0x07
 
@@ -20,6 +20,7 @@
 #define PCR_PORTID_SHIFT	16
 
 #if !defined(__ACPI__)
+#include <stddef.h>
 #include <stdint.h>
 
 uint32_t pcr_read32(uint8_t pid, uint16_t offset);
@@ -38,6 +39,25 @@ void pcr_or32(uint8_t pid, uint16_t offset, uint32_t ordata);
 void pcr_or16(uint8_t pid, uint16_t offset, uint16_t ordata);
 void pcr_or8(uint8_t pid, uint16_t offset, uint8_t ordata);
 
+/* One 32-bit read-modify-write for pcr_rmw32_list(). */
+struct pcr_rmw32_op {
+	uint8_t pid;
+	uint16_t offset;
+	uint32_t anddata;
+	uint32_t ordata;
+};
+
+#define PCR_RMW32(pid_, offset_, and_, or_) \
+	{ .pid = (pid_), .offset = (offset_), .anddata = (and_), .ordata = (or_) }
+/* A zero AND mask skips the read. */
+#define PCR_WRITE32(pid_, offset_, data_) PCR_RMW32(pid_, offset_, 0, data_)
+
+/*
+ * Perform the operations in order. Unlike separate pcr_rmw32() calls, the
+ * writes are only completed once per run of operations on the same port.
+ */
+void pcr_rmw32_list(const struct pcr_rmw32_op *ops, size_t num);
+
 /* SBI command */
 enum {
 	MEM_READ = 0,
@@ -79,6 +99,14 @@ struct pcr_sbi_msg {
 int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 		uint8_t *response);
 
+/*
+ * Send 'num' messages back to back. data[i] and response[i] belong to
+ * msgs[i]. Routing registers that don't change between messages are
+ * programmed only once. Stops at the first failing message.
+ */
+int pcr_execute_sideband_msgs(const struct pcr_sbi_msg *msgs, uint32_t *data,
+		uint8_t *response, size_t num);
+
 /* Get the starting address of the port's registers. */
 void *pcr_reg_address(uint8_t pid, uint16_t offset);
 #endif /* if !defined(__ACPI__) */
@@ -219,6 +219,34 @@ void pcr_or8(uint8_t pid, uint16_t offset, uint8_t ordata)
 	pcr_write8(pid, offset, data8);
 }
 
+void pcr_rmw32_list(const struct pcr_rmw32_op *ops, size_t num)
+{
+	const struct pcr_rmw32_op *last = NULL;
+	uint32_t data32;
+	void *reg;
+	size_t i;
+
+	for (i = 0; i < num; i++, ops++) {
+		/* Ensure the PCR offset is correctly aligned. */
+		assert(IS_ALIGNED(ops->offset, sizeof(uint32_t)));
+
+		/*
+		 * Accesses to one port stay in order, so the writes only need
+		 * to be completed when the list moves on to another port.
+		 */
+		if (last != NULL && last->pid != ops->pid)
+			write_completion(last->pid, last->offset);
+
+		reg = __pcr_reg_address(ops->pid, ops->offset);
+		data32 = ops->anddata ? read32(reg) & ops->anddata : 0;
+		write32(reg, data32 | ops->ordata);
+		last = ops;
+	}
+
+	if (last != NULL)
+		write_completion(last->pid, last->offset);
+}
+
 #if !IS_ENABLED(CONFIG_PCR_COMMON_IOSF_1_0)
 
 static int pcr_wait_for_completion(device_t dev)
@@ -235,36 +263,16 @@ static int pcr_wait_for_completion(device_t dev)
 	return -1;
 }
 
-/*
- * API to perform sideband communication
- *
- * Input:
- * struct pcr_sbi_msg
- * data - read/write for sbi message
- * response -
- * 0 - successful
- * 1 - unsuccessful
- * 2 - powered down
- * 3 - multi-cast mixed
- *
- * Output:
- * 0: SBI message is successfully completed
- * -1: SBI message failure
- */
-int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
-		uint8_t *response)
+static uint16_t pcr_sbi_rid(const struct pcr_sbi_msg *msg)
 {
-#if defined(__SIMPLE_DEVICE__)
-	pci_devfn_t dev = PCH_DEV_P2SB;
-#else
-	struct device *dev = PCH_DEV_P2SB;
-#endif
-	uint32_t sbi_data;
-	uint16_t sbi_status;
-	uint16_t sbi_rid;
-
-	assert(msg && data && response);
+	return ((msg->fast_byte_enable & P2SB_CR_SBI_FBE_MASK)
+					<< P2SB_CR_SBI_FBE) |
+			((msg->bar & P2SB_CR_SBI_MASK) << P2SB_CR_SBI_BAR) |
+			(msg->fid & P2SB_CR_SBI_FID_MASK);
+}
 
+static int pcr_check_sideband_msg(const struct pcr_sbi_msg *msg)
+{
 	switch (msg->opcode) {
 		case MEM_READ:
 		case MEM_WRITE:
@@ -273,27 +281,28 @@ int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 		case PCR_READ:
 		case PCR_WRITE:
 		case GPIO_LOCK_UNLOCK:
-			break;
+			return 0;
 		default:
 			printk(BIOS_ERR, "SBI Failure: Wrong Input!\n");
 			return -1;
-			break;
-	}
-
-	if (pci_read_config16(dev, PCI_VENDOR_ID) == 0xffff) {
-		printk(BIOS_ERR, "SBI Failure: P2SB device Hidden!\n");
-		return -1;
 	}
+}
 
-	/*
-	 * BWG Section 2.2.1
-	 * 1. Poll P2SB PCI offset D8h[0] = 0b
-	 * Make sure the previous operation is completed.
-	 */
-	if (pcr_wait_for_completion(dev)) {
-		printk(BIOS_ERR, "SBI Failure: Time Out!\n");
-		return -1;
-	}
+/*
+ * Send one message. The interface is known to be idle. Registers that hold
+ * the same value as for 'prev', the message sent just before, are not
+ * written again.
+ */
+#if defined(__SIMPLE_DEVICE__)
+static int pcr_send_sideband_msg(pci_devfn_t dev,
+#else
+static int pcr_send_sideband_msg(struct device *dev,
+#endif
+		const struct pcr_sbi_msg *msg, const struct pcr_sbi_msg *prev,
+		uint32_t *data, uint8_t *response)
+{
+	uint32_t sbi_data;
+	uint16_t sbi_status;
 
 	/* Initial Response status */
 	*response = P2SB_CR_SBI_STATUS_NOT_SUPPORTED;
@@ -309,7 +318,9 @@ int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 	 * 3. Write P2SB PCI offset DCh[31:0] with extended address,
 	 * which is expected to be 0
 	 */
-	pci_write_config32(dev, P2SB_CR_SBI_EXT_ADDR, msg->offset >> 16);
+	if (prev == NULL || (prev->offset >> 16) != (msg->offset >> 16))
+		pci_write_config32(dev, P2SB_CR_SBI_EXT_ADDR,
+			msg->offset >> 16);
 
 	/*
 	 * 4. Set P2SB PCI offset D8h[15:8] = 00000110b for read
@@ -329,11 +340,9 @@ int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 	 *
 	 * Set RID[15:0] = Fbe << 12 | Bar << 8 | Fid
 	 */
-	sbi_rid = ((msg->fast_byte_enable & P2SB_CR_SBI_FBE_MASK)
-					<< P2SB_CR_SBI_FBE) |
-			((msg->bar & P2SB_CR_SBI_MASK) << P2SB_CR_SBI_BAR) |
-			(msg->fid & P2SB_CR_SBI_FID_MASK);
-	pci_write_config16(dev, P2SB_CR_SBI_ROUTE_IDEN, sbi_rid);
+	if (prev == NULL || pcr_sbi_rid(prev) != pcr_sbi_rid(msg))
+		pci_write_config16(dev, P2SB_CR_SBI_ROUTE_IDEN,
+			pcr_sbi_rid(msg));
 
 	switch (msg->opcode) {
 		case MEM_WRITE:
@@ -355,9 +364,9 @@ int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 	/*
 	 * 7. Set P2SB PCI offset D8h[0] = 1b, Poll P2SB PCI offset D8h[0] = 0b
 	 *
-	 * Set SBISTAT[0] = 1b, trigger the SBI operation
+	 * Set SBISTAT[0] = 1b, trigger the SBI operation. SBISTAT was written
+	 * in step 4, no need to read it back.
 	 */
-	sbi_status = pci_read_config16(dev, P2SB_CR_SBI_STATUS);
 	sbi_status |= P2SB_CR_SBI_STATUS_BUSY;
 	pci_write_config16(dev, P2SB_CR_SBI_STATUS, sbi_status);
 
@@ -390,4 +399,53 @@ int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
 		return -1;
 	}
 }
+
+int pcr_execute_sideband_msgs(const struct pcr_sbi_msg *msgs, uint32_t *data,
+		uint8_t *response, size_t num)
+{
+#if defined(__SIMPLE_DEVICE__)
+	pci_devfn_t dev = PCH_DEV_P2SB;
+#else
+	struct device *dev = PCH_DEV_P2SB;
+#endif
+	size_t i;
+
+	assert(msgs && data && response);
+
+	for (i = 0; i < num; i++) {
+		if (pcr_check_sideband_msg(&msgs[i]))
+			return -1;
+	}
+
+	if (pci_read_config16(dev, PCI_VENDOR_ID) == 0xffff) {
+		printk(BIOS_ERR, "SBI Failure: P2SB device Hidden!\n");
+		return -1;
+	}
+
+	/*
+	 * BWG Section 2.2.1
+	 * 1. Poll P2SB PCI offset D8h[0] = 0b
+	 * Make sure the previous operation is completed. Every message below
+	 * waits for its own completion, so this is only needed once.
+	 */
+	if (pcr_wait_for_completion(dev)) {
+		printk(BIOS_ERR, "SBI Failure: Time Out!\n");
+		return -1;
+	}
+
+	for (i = 0; i < num; i++) {
+		if (pcr_send_sideband_msg(dev, &msgs[i],
+				i ? &msgs[i - 1] : NULL, &data[i],
+				&response[i]))
+			return -1;
+	}
+
+	return 0;
+}
+
+int pcr_execute_sideband_msg(struct pcr_sbi_msg *msg, uint32_t *data,
+		uint8_t *response)
+{
+	return pcr_execute_sideband_msgs(msg, data, response, 1);
+}
 #endif
@@ -46,6 +46,12 @@ u8 smbus_read_byte(u32 smbus_dev, u8 addr, u8 offset)
 	return smbus_read8(SMBUS_IO_BASE, addr, offset);
 }
 
+int smbus_i2c_block_read(u32 smbus_dev, u8 addr, u8 offset, size_t bytes,
+				u8 *buf)
+{
+	return smbus_read_i2c_block(SMBUS_IO_BASE, addr, offset, bytes, buf);
+}
+
 u8 smbus_write_byte(u32 smbus_dev, u8 addr, u8 offset, u8 value)
 {
 	return smbus_write8(SMBUS_IO_BASE, addr, offset, value);
@@ -176,3 +176,67 @@ int smbus_read16(unsigned int smbus_base, unsigned int device,
 
 	return data;
 }
+
+int smbus_read_i2c_block(unsigned int smbus_base, unsigned int device,
+	unsigned int address, size_t bytes, u8 *buf)
+{
+	struct stopwatch sw;
+	unsigned char status;
+	size_t bytes_read = 0;
+
+	if (!bytes)
+		return 0;
+
+	if (smbus_wait_till_ready(smbus_base) < 0)
+		return SMBUS_WAIT_UNTIL_READY_TIMEOUT;
+
+	/* Set up transaction */
+	/* Disable interrupts */
+	outb(inb(smbus_base + SMBHSTCTL) & ~1, smbus_base + SMBHSTCTL);
+	/* Set the device I'm talking to, the read bit stays clear */
+	outb((device & 0x7f) << 1, smbus_base + SMBXMITADD);
+	/* The offset goes into the second data register */
+	outb(address & 0xff, smbus_base + SMBHSTDAT1);
+	/* Set up for an I2C block read */
+	outb((inb(smbus_base + SMBHSTCTL) & 0xc3) | SMBHSTCNT_I2C_BLOCK,
+		(smbus_base + SMBHSTCTL));
+	/* Clear any lingering errors, so the transaction will run */
+	outb(inb(smbus_base + SMBHSTSTAT), smbus_base + SMBHSTSTAT);
+
+	/* Start the command, a single byte is also the last one */
+	outb(inb(smbus_base + SMBHSTCTL) | SMBHSTCNT_START |
+		(bytes == 1 ? SMBHSTCNT_LAST_BYTE : 0),
+		smbus_base + SMBHSTCTL);
+
+	stopwatch_init_msecs_expire(&sw, SMBUS_TIMEOUT);
+	do {
+		status = inb(smbus_base + SMBHSTSTAT);
+		if (status & (SMBHSTSTS_FAILED | SMBHSTSTS_BUS_ERR |
+			      SMBHSTSTS_DEV_ERR))
+			return SMBUS_ERROR;
+
+		if (!(status & SMBHSTSTS_BYTE_DONE))
+			continue;
+
+		buf[bytes_read++] = inb(smbus_base + SMBBLKDAT);
+
+		/* Tell the controller before it fetches the last byte */
+		if (bytes_read + 1 == bytes)
+			outb(inb(smbus_base + SMBHSTCTL) | SMBHSTCNT_LAST_BYTE,
+				smbus_base + SMBHSTCTL);
+
+		/* Clearing byte done releases the next byte */
+		outb(status, smbus_base + SMBHSTSTAT);
+
+		if (bytes_read == bytes)
+			break;
+	} while (!stopwatch_expired(&sw));
+
+	if (bytes_read < bytes)
+		return SMBUS_WAIT_UNTIL_DONE_TIMEOUT;
+
+	if (smbus_wait_till_ready(smbus_base) < 0)
+		return SMBUS_WAIT_UNTIL_DONE_TIMEOUT;
+
+	return bytes_read;
+}
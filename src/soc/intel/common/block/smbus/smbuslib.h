@@ -16,6 +16,9 @@
 #ifndef SOC_INTEL_COMMON_BLOCK_SMBUS__LIB_H
 #define SOC_INTEL_COMMON_BLOCK_SMBUS__LIB_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* SMBus IO Base Address */
 #define SMBUS_IO_BASE	0xefa0
 /* PCI Configuration Space : SMBus */
@@ -27,6 +30,18 @@
 #define SMBHSTCMD	0x3
 #define SMBXMITADD	0x4
 #define SMBHSTDAT0	0x5
+#define SMBHSTDAT1	0x6
+#define SMBBLKDAT	0x7
+
+/* SMBus host control and status bits. */
+#define SMBHSTCNT_LAST_BYTE	(1 << 5)
+#define SMBHSTCNT_START		(1 << 6)
+#define SMBHSTCNT_I2C_BLOCK	(6 << 2)
+#define SMBHSTSTS_BYTE_DONE	(1 << 7)
+#define SMBHSTSTS_FAILED	(1 << 4)
+#define SMBHSTSTS_BUS_ERR	(1 << 3)
+#define SMBHSTSTS_DEV_ERR	(1 << 2)
+#define SMBHSTSTS_HOST_BUSY	(1 << 0)
 
 #define SMBUS_TIMEOUT	15	/* 15ms */
 
@@ -36,5 +51,9 @@ int smbus_write8(unsigned int smbus_base, unsigned int device,
 		unsigned int address, unsigned int data);
 int smbus_read16(unsigned int smbus_base, unsigned int device,
 		unsigned int address);
+/* Read bytes starting at address with a single I2C block read. Returns the
+ * number of bytes read or < 0 on error. */
+int smbus_read_i2c_block(unsigned int smbus_base, unsigned int device,
+		unsigned int address, size_t bytes, u8 *buf);
 
 #endif	/* SOC_INTEL_COMMON_BLOCK_SMBUS__LIB_H */
@@ -16,9 +16,12 @@
 
 #include <arch/hlt.h>
 #include <arch/io.h>
+#include <commonlib/helpers.h>
 #include <compiler.h>
 #include <console/console.h>
 #include <cpu/x86/cache.h>
+#include <cpu/x86/msr.h>
+#include <cpu/x86/mtrr.h>
 #include <cpu/x86/smm.h>
 #include <delay.h>
 #include <device/pci_def.h>
@@ -294,6 +297,45 @@ static void southbridge_smi_gsmi(
 	save_state_ops->set_reg(io_smi, RAX, ret);
 }
 
+static void southbridge_smi_latency(
+	const struct smm_save_state_ops *save_state_ops)
+{
+	void *io_smi;
+	uint64_t smram, smram_size, buf, size;
+	msr_t base, mask;
+
+	io_smi = find_save_state(save_state_ops, APM_CNT_SMI_LATENCY);
+	if (!io_smi)
+		return;
+
+	/* Buffer address in EBX, buffer size in ECX */
+	buf = save_state_ops->get_reg(io_smi, RBX);
+	size = save_state_ops->get_reg(io_smi, RCX);
+
+	/* Never let the OS point us at SMRAM itself, as covered by SMRR */
+	base = rdmsr(IA32_SMRR_PHYS_BASE);
+	mask = rdmsr(IA32_SMRR_PHYS_MASK);
+	smram = base.lo & ~0xfff;
+	smram_size = 0;
+	if (mask.lo & MTRR_PHYS_MASK_VALID)
+		smram_size = (uint32_t)~(mask.lo & ~0xfff) + 1;
+
+	/*
+	 * The handler only reaches the low 4GiB, so check the full 64-bit
+	 * range before the pointer is cut down to that.
+	 */
+	if (buf > 4ULL * GiB || size > 4ULL * GiB - buf ||
+	    (buf < smram + smram_size && buf + size > smram)) {
+		printk(BIOS_ERR, "SMI#: Invalid latency buffer 0x%llx\n", buf);
+		save_state_ops->set_reg(io_smi, RAX, 0);
+		return;
+	}
+
+	/* Number of bytes copied in EAX */
+	size = smm_latency_export((void *)(uintptr_t)buf, size);
+	save_state_ops->set_reg(io_smi, RAX, size);
+}
+
 static void finalize(void)
 {
 	static int finalize_done;
@@ -369,6 +411,10 @@ void smihandler_southbridge_apmc(
 	case APM_CNT_FINALIZE:
 		finalize();
 		break;
+	case APM_CNT_SMI_LATENCY:
+		if (IS_ENABLED(CONFIG_SMM_LATENCY_HISTOGRAM))
+			southbridge_smi_latency(save_state_ops);
+		break;
 	}
 
 	mainboard_smi_apmc(reg8);
@@ -359,42 +359,41 @@ static void set_energy_perf_bias(u8 policy)
 	printk(BIOS_DEBUG, "cpu: energy policy set to %u\n", policy);
 }
 
-static void configure_c_states(void)
-{
-	msr_t msr;
+#define IRTL_SETTING(index_, limit_)					\
+	{								\
+		.index = index_,					\
+		.scope = MP_MSR_SCOPE_PACKAGE,				\
+		.mask = { .lo = 0xffffffff, .hi = 0xffffffff },		\
+		.value = { .lo = IRTL_VALID | IRTL_1024_NS | (limit_) },	\
+	}
 
+/* Settings every CPU applies during MP init, before soc_core_init(). */
+static const struct mp_msr_setting msr_settings[] = {
 	/* C-state Interrupt Response Latency Control 0 - package C3 latency */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS | C_STATE_LATENCY_CONTROL_0_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_0, msr);
-
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_0,
+		     C_STATE_LATENCY_CONTROL_0_LIMIT),
 	/* C-state Interrupt Response Latency Control 1 - package C6/C7 short */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS | C_STATE_LATENCY_CONTROL_1_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_1, msr);
-
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_1,
+		     C_STATE_LATENCY_CONTROL_1_LIMIT),
 	/* C-state Interrupt Response Latency Control 2 - package C6/C7 long */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS | C_STATE_LATENCY_CONTROL_2_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_2, msr);
-
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_2,
+		     C_STATE_LATENCY_CONTROL_2_LIMIT),
 	/* C-state Interrupt Response Latency Control 3 - package C8 */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS |
-		C_STATE_LATENCY_CONTROL_3_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_3, msr);
-
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_3,
+		     C_STATE_LATENCY_CONTROL_3_LIMIT),
 	/* C-state Interrupt Response Latency Control 4 - package C9 */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS |
-		C_STATE_LATENCY_CONTROL_4_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_4, msr);
-
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_4,
+		     C_STATE_LATENCY_CONTROL_4_LIMIT),
 	/* C-state Interrupt Response Latency Control 5 - package C10 */
-	msr.hi = 0;
-	msr.lo = IRTL_VALID | IRTL_1024_NS |
-		C_STATE_LATENCY_CONTROL_5_LIMIT;
-	wrmsr(MSR_C_STATE_LATENCY_CONTROL_5, msr);
+	IRTL_SETTING(MSR_C_STATE_LATENCY_CONTROL_5,
+		     C_STATE_LATENCY_CONTROL_5_LIMIT),
+};
+
+static void get_msr_settings(const struct mp_msr_setting **settings,
+			     size_t *count)
+{
+	*settings = msr_settings;
+	*count = ARRAY_SIZE(msr_settings);
 }
 
 /*
@@ -431,9 +430,6 @@ void soc_core_init(struct device *cpu)
 	enable_lapic_tpr();
 	setup_lapic();
 
-	/* Configure c-state interrupt response time */
-	configure_c_states();
-
 	/* Configure Enhanced SpeedStep and Thermal Sensors */
 	configure_misc();
 
@@ -493,6 +489,7 @@ static const struct mp_ops mp_ops = {
 	.get_cpu_count = get_cpu_count,
 	.get_smm_info = smm_info,
 	.get_microcode_info = get_microcode_info,
+	.get_msr_settings = get_msr_settings,
 	.pre_mp_smm_init = smm_initialize,
 	.per_cpu_smm_trigger = per_cpu_smm_trigger,
 	.relocation_handler = smm_relocation_handler,
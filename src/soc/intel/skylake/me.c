@@ -204,37 +204,52 @@ static const char *const me_progress_bup_values[] = {
 	"M0 kernel load",
 };
 
-static void print_me_version(void *unused)
-{
-	struct mkhi_hdr {
-		uint8_t group_id;
-		uint8_t command:7;
-		uint8_t is_resp:1;
-		uint8_t rsvd;
-		uint8_t result;
-	} __packed;
+struct mkhi_hdr {
+	uint8_t group_id;
+	uint8_t command:7;
+	uint8_t is_resp:1;
+	uint8_t rsvd;
+	uint8_t result;
+} __packed;
+
+struct version {
+	uint16_t minor;
+	uint16_t major;
+	uint16_t build;
+	uint16_t hotfix;
+} __packed;
+
+struct fw_ver_resp {
+	struct mkhi_hdr hdr;
+	struct version code;
+	struct version rec;
+	struct version fitc;
+} __packed;
+
+static const struct mkhi_hdr fw_ver_msg = {
+	.group_id = MKHI_GEN_GROUP_ID,
+	.command = MKHI_GET_FW_VERSION,
+};
 
-	struct version {
-		uint16_t minor;
-		uint16_t major;
-		uint16_t build;
-		uint16_t hotfix;
-	} __packed;
+static struct fw_ver_resp fw_ver_resp;
 
-	struct fw_ver_resp {
-		struct mkhi_hdr hdr;
-		struct version code;
-		struct version rec;
-		struct version fitc;
-	} __packed;
+static struct heci_transaction fw_ver_query = {
+	.msg = &fw_ver_msg,
+	.len = sizeof(fw_ver_msg),
+	.host_addr = BIOS_HOST_ADD,
+	.client_addr = HECI_MKHI_ADD,
+	/*
+	 * It is important to do a heci_reset to ensure BIOS and ME are in sync
+	 * before reading firmware version.
+	 */
+	.reset = 1,
+	.reply = &fw_ver_resp,
+};
 
-	const struct mkhi_hdr fw_ver_msg = {
-		.group_id = MKHI_GEN_GROUP_ID,
-		.command = MKHI_GET_FW_VERSION,
-	};
+static int fw_ver_query_started;
 
-	struct fw_ver_resp resp;
-	size_t resp_size = sizeof(resp);
+static void query_me_version(void *unused)
+{
 	union me_hfs hfs;
 
 	/*
@@ -251,37 +266,37 @@ static void print_me_version(void *unused)
 	 * - Operation mode is normal.
 	 */
 	if ((hfs.fields.working_state != ME_HFS_CWS_NORMAL) ||
-	    (hfs.fields.operation_mode != ME_HFS_MODE_NORMAL))
-		goto failed;
-
-	/*
-	 * It is important to do a heci_reset to ensure BIOS and ME are in sync
-	 * before reading firmware version.
-	 */
-	heci_reset();
-
-	if (!heci_send(&fw_ver_msg, sizeof(fw_ver_msg), BIOS_HOST_ADD,
-		       HECI_MKHI_ADD))
-		goto failed;
+	    (hfs.fields.operation_mode != ME_HFS_MODE_NORMAL)) {
+		printk(BIOS_DEBUG, "ME: Version : Unavailable\n");
+		return;
+	}
 
-	if (!heci_receive(&resp, &resp_size))
-		goto failed;
+	/* Let device init run while ME works on the reply. */
+	fw_ver_query.reply_size = sizeof(fw_ver_resp);
+	heci_transaction_start(&fw_ver_query, BS_DEV_INIT, BS_ON_EXIT);
+	fw_ver_query_started = 1;
+}
 
-	if (resp.hdr.result)
-		goto failed;
+static void print_me_version(void *unused)
+{
+	if (!fw_ver_query_started)
+		return;
 
-	printk(BIOS_DEBUG, "ME: Version : %d.%d.%d.%d\n", resp.code.major,
-	       resp.code.minor, resp.code.hotfix, resp.code.build);
-	return;
+	if (!heci_transaction_wait(&fw_ver_query) || fw_ver_resp.hdr.result) {
+		printk(BIOS_DEBUG, "ME: Version : Unavailable\n");
+		return;
+	}
 
-failed:
-	printk(BIOS_DEBUG, "ME: Version : Unavailable\n");
+	printk(BIOS_DEBUG, "ME: Version : %d.%d.%d.%d\n",
+	       fw_ver_resp.code.major, fw_ver_resp.code.minor,
+	       fw_ver_resp.code.hotfix, fw_ver_resp.code.build);
 }
 /*
  * This can't be put in intel_me_status because by the time control
  * reaches there, ME doesn't respond to GET_FW_VERSION command.
  */
-BOOT_STATE_INIT_ENTRY(BS_DEV_ENABLE, BS_ON_EXIT, print_me_version, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_ENABLE, BS_ON_EXIT, query_me_version, NULL);
+BOOT_STATE_INIT_ENTRY(BS_DEV_INIT, BS_ON_EXIT, print_me_version, NULL);
 
 void intel_me_status(void)
 {
@@ -24,6 +24,7 @@ __weak void mtk_soc_after_dram(void) { /* do nothing */ }
 void mtk_mmu_init(void)
 {
 	mmu_init();
+	mmu_batch_begin();
 
 	/* Set 0x0 to the end of 2GB dram address as device memory */
 	mmu_config_range((void *)0, (uintptr_t)_dram + 2U * GiB, DEV_MEM);
@@ -37,6 +38,7 @@ void mtk_mmu_init(void)
 	/* DMA is non-cached and is reserved for TPM & da9212 I2C DMA */
 	mmu_config_range(_dma_coherent, _dma_coherent_size, UNCACHED_MEM);
 
+	mmu_batch_end();
 	mmu_enable();
 }
 
@@ -60,6 +60,13 @@ struct tegra_spi_channel {
 	u8 *in_buf, *out_buf;
 	struct apb_dma_channel *dma_out, *dma_in;
 	enum spi_xfer_mode xfer_mode;
+
+	/* transfer in flight (see spi_xfer_start()) */
+	u8 *xfer_out, *xfer_in;
+	size_t xfer_out_bytes, xfer_in_bytes;
+	size_t xfer_todo;
+	int xfer_chunk;
+	int xfer_busy;
 };
 
 struct tegra_spi_channel *tegra_spi_init(unsigned int bus);
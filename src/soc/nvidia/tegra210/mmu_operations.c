@@ -34,6 +34,8 @@ static void tegra210_mmu_config(void)
 
 	memory_in_range_below_4gb(&start,&end);
 
+	mmu_batch_begin();
+
 	/* Device memory below DRAM */
 	mmu_config_range((void *)TEGRA_ARM_LOWEST_PERIPH, start * MiB, devmem);
 
@@ -52,6 +54,8 @@ static void tegra210_mmu_config(void)
 
 	mmu_config_range((void *)(tz_base_mib * MiB),
 			 tz_size_mib * MiB, secure_mem);
+
+	mmu_batch_end();
 }
 
 void tegra210_mmu_init(void)
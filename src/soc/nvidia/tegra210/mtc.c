@@ -16,7 +16,10 @@
 #include <cbfs.h>
 #include <cbmem.h>
 #include <console/console.h>
+#include <mrc_cache.h>
 #include <soc/mtc.h>
+#include <security/vboot/vboot_common.h>
+#include <soc/sdram_configs.h>
 #include <string.h>
 
 static size_t mtc_table_size;
@@ -25,6 +28,48 @@ static size_t mtc_table_size;
 #define MTC_TABLE_ENTRY_SIZE	4880
 #define MTC_TABLE_MAX_SIZE	(MAX_MTC_TABLE_ENTRIES * MTC_TABLE_ENTRY_SIZE)
 
+/*
+ * The saved table is only good for the same memory and firmware, so the
+ * hash of the SDRAM parameters is seeded with a hash of the firmware.
+ */
+static uint32_t mtc_cache_version(const void *fw, size_t fw_size)
+{
+	const uint8_t *params = (const uint8_t *)get_sdram_config();
+	const uint8_t *image = fw;
+	uint32_t fw_hash;
+
+	fw_hash = mrc_cache_spd_version(fw_size, &image, 1, fw_size);
+	return mrc_cache_spd_version(fw_hash, &params, 1,
+				     sizeof(struct sdram_params));
+}
+
+static int mtc_restore(uint32_t version)
+{
+	struct region_device rdev;
+	void *cbmem_tab;
+	size_t size;
+
+	if (mrc_cache_get_current(MRC_TRAINING_DATA, version, &rdev) < 0)
+		return -1;
+
+	size = region_device_sz(&rdev);
+	if (size == 0 || size > MTC_TABLE_MAX_SIZE)
+		return -1;
+
+	cbmem_tab = cbmem_add(CBMEM_ID_MTC, size);
+	if (cbmem_tab == NULL)
+		return -1;
+
+	if (rdev_readat(&rdev, cbmem_tab, 0, size) != size)
+		return -1;
+
+	mtc_table_size = size;
+	printk(BIOS_INFO, "MTC: Restored 0x%zx bytes of training data\n",
+	       size);
+
+	return 0;
+}
+
 int tegra210_run_mtc(void)
 {
 	ssize_t nread;
@@ -34,6 +79,7 @@ int tegra210_run_mtc(void)
 	void *const mtc = (void *)(uintptr_t)CONFIG_MTC_ADDRESS;
 	void *dvfs_table;
 	size_t (*mtc_fw)(void **dvfs_table) = (void *)mtc;
+	uint32_t version;
 
 	if (cbfs_boot_locate(&mtc_file, "tegra_mtc.bin", NULL)) {
 		printk(BIOS_ERR, "MTC file not found: tegra_mtc.bin\n");
@@ -53,6 +99,12 @@ int tegra210_run_mtc(void)
 
 	printk(BIOS_INFO, "MTC: %zu bytes loaded @ %p\n", nread, mtc);
 
+	/* Loading is cheap next to the training, and gives the key. */
+	version = mtc_cache_version(mtc, nread);
+	if (IS_ENABLED(CONFIG_MTC_CACHE) &&
+	    !vboot_recovery_mode_memory_retrain() && mtc_restore(version) == 0)
+		return 0;
+
 	mtc_table_size = (*mtc_fw)(&dvfs_table);
 
 	if ((mtc_table_size == 0) || (mtc_table_size > MTC_TABLE_MAX_SIZE)) {
@@ -73,6 +125,10 @@ int tegra210_run_mtc(void)
 	printk(BIOS_INFO, "MTC: Copied 0x%zx bytes from %p to %p\n",
 	       mtc_table_size, dvfs_table, cbmem_tab);
 
+	if (IS_ENABLED(CONFIG_MTC_CACHE))
+		mrc_cache_stash_data(MRC_TRAINING_DATA, version, cbmem_tab,
+				     mtc_table_size);
+
 	return 0;
 }
 
@@ -319,14 +319,19 @@ static inline unsigned int spi_byte_count(struct tegra_spi_channel *spi)
 		(SPI_STATUS_BLOCK_COUNT << SPI_STATUS_BLOCK_COUNT_SHIFT);
 }
 
+static int tegra_spi_ready(struct tegra_spi_channel *spi)
+{
+	return (read32(&spi->regs->trans_status) & SPI_STATUS_RDY) ==
+		SPI_STATUS_RDY;
+}
+
 static void tegra_spi_wait(struct tegra_spi_channel *spi)
 {
 	uint32_t dma_blk_count = 1 + (read32(&spi->regs->dma_blk) &
 				      (SPI_DMA_CTL_BLOCK_SIZE_MASK <<
 				       SPI_DMA_CTL_BLOCK_SIZE_SHIFT));
 
-	while ((read32(&spi->regs->trans_status) & SPI_STATUS_RDY) !=
-	       SPI_STATUS_RDY)
+	while (!tegra_spi_ready(spi))
 		;
 
 	/*
@@ -750,52 +755,50 @@ static int xfer_finish(struct tegra_spi_channel *spi)
 	return ret;
 }
 
-static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
-			  size_t out_bytes, void *din, size_t in_bytes)
+/*
+ * Sets up and kicks off the next chunk of the transfer in flight.
+ *
+ * Returns 1 if a chunk was started, 0 if there is nothing left to transfer
+ * and <0 to indicate error.
+ */
+static int xfer_next(struct tegra_spi_channel *spi)
 {
-	struct tegra_spi_channel *spi = to_tegra_spi(slave->bus);
-	u8 *out_buf = (u8 *)dout;
-	u8 *in_buf = (u8 *)din;
-	size_t todo;
-	int ret = 0;
-
-	/* tegra bus numbers start at 1 */
-	ASSERT(slave->bus >= 1 && slave->bus <= ARRAY_SIZE(tegra_spi_channels));
-
-	while (out_bytes || in_bytes) {
+	while (spi->xfer_out_bytes || spi->xfer_in_bytes) {
 		int x = 0;
 
-		if (out_bytes == 0)
-			todo = in_bytes;
-		else if (in_bytes == 0)
-			todo = out_bytes;
+		if (spi->xfer_out_bytes == 0)
+			spi->xfer_todo = spi->xfer_in_bytes;
+		else if (spi->xfer_in_bytes == 0)
+			spi->xfer_todo = spi->xfer_out_bytes;
 		else
-			todo = MIN(out_bytes, in_bytes);
+			spi->xfer_todo = MIN(spi->xfer_out_bytes,
+					     spi->xfer_in_bytes);
 
-		if (out_bytes) {
-			x = xfer_setup(spi, out_buf, todo, SPI_SEND);
+		if (spi->xfer_out_bytes) {
+			x = xfer_setup(spi, spi->xfer_out, spi->xfer_todo,
+				       SPI_SEND);
 			if (x < 0) {
 				if (spi->xfer_mode == XFER_MODE_NONE) {
 					spi->xfer_mode = XFER_MODE_PIO;
 					continue;
 				} else {
-					ret = -1;
-					break;
+					return -1;
 				}
 			}
 		}
-		if (in_bytes) {
-			x = xfer_setup(spi, in_buf, todo, SPI_RECEIVE);
+		if (spi->xfer_in_bytes) {
+			x = xfer_setup(spi, spi->xfer_in, spi->xfer_todo,
+				       SPI_RECEIVE);
 			if (x < 0) {
 				if (spi->xfer_mode == XFER_MODE_NONE) {
 					spi->xfer_mode = XFER_MODE_PIO;
 					continue;
 				} else {
-					ret = -1;
-					break;
+					return -1;
 				}
 			}
 		}
+		spi->xfer_chunk = x;
 
 		/*
 		 * Note: Some devices (such as Chrome EC) are sensitive to
@@ -803,29 +806,98 @@ static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
 		 * cause timeouts between transfers.
 		 */
 		xfer_start(spi);
-		xfer_wait(spi);
-		if (xfer_finish(spi)) {
-			ret = -1;
-			break;
-		}
-
-		/* Post-processing. */
-		if (out_bytes) {
-			out_bytes -= x;
-			out_buf += x;
-		}
-		if (in_bytes) {
-			in_bytes -= x;
-			in_buf += x;
-		}
+		return 1;
 	}
 
+	return 0;
+}
+
+static void xfer_error(struct tegra_spi_channel *spi)
+{
+	printk(BIOS_ERR, "%s: Error detected\n", __func__);
+	printk(BIOS_ERR, "Transaction size: %zu, bytes remaining: "
+			"%zu out / %zu in\n", spi->xfer_todo,
+			spi->xfer_out_bytes, spi->xfer_in_bytes);
+	clear_fifo_status(spi);
+	spi->xfer_busy = 0;
+}
+
+static int spi_ctrlr_xfer_start(const struct spi_slave *slave,
+				const void *dout, size_t out_bytes,
+				void *din, size_t in_bytes)
+{
+	struct tegra_spi_channel *spi = to_tegra_spi(slave->bus);
+	int ret;
+
+	/* tegra bus numbers start at 1 */
+	ASSERT(slave->bus >= 1 && slave->bus <= ARRAY_SIZE(tegra_spi_channels));
+
+	spi->xfer_out = (u8 *)dout;
+	spi->xfer_out_bytes = out_bytes;
+	spi->xfer_in = (u8 *)din;
+	spi->xfer_in_bytes = in_bytes;
+	spi->xfer_todo = 0;
+
+	ret = xfer_next(spi);
 	if (ret < 0) {
-		printk(BIOS_ERR, "%s: Error detected\n", __func__);
-		printk(BIOS_ERR, "Transaction size: %zu, bytes remaining: "
-				"%zu out / %zu in\n", todo, out_bytes, in_bytes);
-		clear_fifo_status(spi);
+		xfer_error(spi);
+		return -1;
+	}
+
+	spi->xfer_busy = ret;
+	return 0;
+}
+
+static int spi_ctrlr_xfer_poll(const struct spi_slave *slave)
+{
+	struct tegra_spi_channel *spi = to_tegra_spi(slave->bus);
+	int ret;
+
+	if (!spi->xfer_busy)
+		return 0;
+
+	if (!tegra_spi_ready(spi))
+		return SPI_XFER_IN_PROGRESS;
+
+	xfer_wait(spi);
+	if (xfer_finish(spi))
+		goto err;
+
+	/* Post-processing. */
+	if (spi->xfer_out_bytes) {
+		spi->xfer_out_bytes -= spi->xfer_chunk;
+		spi->xfer_out += spi->xfer_chunk;
 	}
+	if (spi->xfer_in_bytes) {
+		spi->xfer_in_bytes -= spi->xfer_chunk;
+		spi->xfer_in += spi->xfer_chunk;
+	}
+
+	ret = xfer_next(spi);
+	if (ret < 0)
+		goto err;
+
+	spi->xfer_busy = ret;
+	return ret ? SPI_XFER_IN_PROGRESS : 0;
+
+err:
+	xfer_error(spi);
+	return -1;
+}
+
+static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
+			  size_t out_bytes, void *din, size_t in_bytes)
+{
+	int ret;
+
+	ret = spi_ctrlr_xfer_start(slave, dout, out_bytes, din, in_bytes);
+	if (ret < 0)
+		return ret;
+
+	do {
+		ret = spi_ctrlr_xfer_poll(slave);
+	} while (ret == SPI_XFER_IN_PROGRESS);
+
 	return ret;
 }
 
@@ -833,6 +905,8 @@ static const struct spi_ctrlr spi_ctrlr = {
 	.claim_bus = spi_ctrlr_claim_bus,
 	.release_bus = spi_ctrlr_release_bus,
 	.xfer = spi_ctrlr_xfer,
+	.xfer_start = spi_ctrlr_xfer_start,
+	.xfer_poll = spi_ctrlr_xfer_poll,
 	.max_xfer_size = SPI_CTRLR_DEFAULT_MAX_XFER_SIZE,
 };
 
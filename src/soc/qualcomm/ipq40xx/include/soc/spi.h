@@ -184,6 +184,11 @@ struct ipq_spi_slave {
 	unsigned int initialized;
 	unsigned long freq;
 	int allocated;
+
+	/* Read in flight (see spi_xfer_start()) */
+	u8 *rx_buf;
+	unsigned int rx_bytes;		/* left in the whole read */
+	unsigned int rx_chunk;		/* left in the current QUP transfer */
 };
 
 #endif /* _IPQ40XX_SPI_H_ */
@@ -405,15 +405,10 @@ static void enable_io_config(struct ipq_spi_slave *ds,
 }
 
 /*
- * Function to read bytes number of data from the Input FIFO
+ * Function to start reading bytes number of data into the Input FIFO
  */
-static int __blsp_spi_read(struct ipq_spi_slave *ds, u8 *data_buffer,
-				unsigned int bytes)
+static int blsp_spi_read_setup(struct ipq_spi_slave *ds, unsigned int bytes)
 {
-	uint32_t val;
-	unsigned int i;
-	unsigned int fifo_count;
-	int ret = SUCCESS;
 	int state_config;
 
 	/* Configure no of bytes to read */
@@ -426,7 +421,50 @@ static int __blsp_spi_read(struct ipq_spi_slave *ds, u8 *data_buffer,
 
 	write32(ds->regs->qup_mx_input_count, bytes);
 
-	state_config = config_spi_state(ds, QUP_STATE_RUN);
+	return config_spi_state(ds, QUP_STATE_RUN);
+}
+
+/*
+ * Function to drain one block from the Input FIFO if it has one ready
+ */
+static void blsp_spi_read_service(struct ipq_spi_slave *ds, u8 **data_buffer,
+				unsigned int *bytes)
+{
+	uint32_t val;
+	unsigned int i;
+	unsigned int fifo_count;
+
+	val = read32(ds->regs->qup_operational);
+	if (!(val & INPUT_SERVICE_FLAG))
+		return;
+
+	/*
+	 * acknowledge to hw that software will
+	 * read input data
+	 */
+	val &= INPUT_SERVICE_FLAG;
+	write32(ds->regs->qup_operational, val);
+
+	fifo_count = ((*bytes > SPI_INPUT_BLOCK_SIZE) ?
+			SPI_INPUT_BLOCK_SIZE : *bytes);
+
+	for (i = 0; i < fifo_count; i++) {
+		**data_buffer = spi_read_byte(ds);
+		(*data_buffer)++;
+		(*bytes)--;
+	}
+}
+
+/*
+ * Function to read bytes number of data from the Input FIFO
+ */
+static int __blsp_spi_read(struct ipq_spi_slave *ds, u8 *data_buffer,
+				unsigned int bytes)
+{
+	int ret = SUCCESS;
+	int state_config;
+
+	state_config = blsp_spi_read_setup(ds, bytes);
 	if (state_config)
 		return state_config;
 
@@ -435,24 +473,7 @@ static int __blsp_spi_read(struct ipq_spi_slave *ds, u8 *data_buffer,
 		if (ret != SUCCESS)
 			goto out;
 
-		val = read32(ds->regs->qup_operational);
-		if (val & INPUT_SERVICE_FLAG) {
-			/*
-			 * acknowledge to hw that software will
-			 * read input data
-			 */
-			val &= INPUT_SERVICE_FLAG;
-			write32(ds->regs->qup_operational, val);
-
-			fifo_count = ((bytes > SPI_INPUT_BLOCK_SIZE) ?
-					SPI_INPUT_BLOCK_SIZE : bytes);
-
-			for (i = 0; i < fifo_count; i++) {
-				*data_buffer = spi_read_byte(ds);
-				data_buffer++;
-				bytes--;
-			}
-		}
+		blsp_spi_read_service(ds, &data_buffer, &bytes);
 	}
 
 out:
@@ -645,6 +666,71 @@ out:
 	return ret;
 }
 
+/*
+ * Only reads run in the background; anything with data to send is short
+ * (a flash command) and is done right away by spi_ctrlr_xfer().
+ */
+static int spi_ctrlr_xfer_start(const struct spi_slave *slave,
+				const void *dout, size_t out_bytes,
+				void *din, size_t in_bytes)
+{
+	struct ipq_spi_slave *ds = to_ipq_spi(slave);
+	int ret;
+
+	ds->rx_bytes = 0;
+	ds->rx_chunk = 0;
+
+	if (dout != NULL || din == NULL || in_bytes == 0)
+		return spi_ctrlr_xfer(slave, dout, out_bytes, din, in_bytes);
+
+	ret = config_spi_state(ds, QUP_STATE_RESET);
+	if (ret != SUCCESS)
+		return ret;
+
+	write_force_cs(slave, 1);
+
+	ds->rx_buf = din;
+	ds->rx_bytes = in_bytes;
+	return SUCCESS;
+}
+
+static int spi_ctrlr_xfer_poll(const struct spi_slave *slave)
+{
+	struct ipq_spi_slave *ds = to_ipq_spi(slave);
+	unsigned int before;
+	int ret = SUCCESS;
+
+	if (!ds->rx_bytes)
+		return SUCCESS;
+
+	if (!ds->rx_chunk) {
+		ds->rx_chunk = MIN(ds->rx_bytes, MAX_COUNT_SIZE);
+		ret = blsp_spi_read_setup(ds, ds->rx_chunk);
+		if (ret != SUCCESS)
+			goto out;
+	}
+
+	before = ds->rx_chunk;
+	blsp_spi_read_service(ds, &ds->rx_buf, &ds->rx_chunk);
+	ds->rx_bytes -= before - ds->rx_chunk;
+
+	if (ds->rx_bytes)
+		return SPI_XFER_IN_PROGRESS;
+
+out:
+	ds->rx_bytes = 0;
+	ds->rx_chunk = 0;
+	write_force_cs(slave, 0);
+
+	/*
+	 * Put the SPI Core back in the Reset State
+	 * to end the transfer
+	 */
+	(void)config_spi_state(ds, QUP_STATE_RESET);
+
+	return ret;
+}
+
 static int spi_ctrlr_setup(const struct spi_slave *slave)
 {
 	struct ipq_spi_slave *ds = NULL;
@@ -691,6 +777,8 @@ static const struct spi_ctrlr spi_ctrlr = {
 	.claim_bus = spi_ctrlr_claim_bus,
 	.release_bus = spi_ctrlr_release_bus,
 	.xfer = spi_ctrlr_xfer,
+	.xfer_start = spi_ctrlr_xfer_start,
+	.xfer_poll = spi_ctrlr_xfer_poll,
 	.max_xfer_size = MAX_PACKET_COUNT,
 };
 
@@ -26,8 +26,21 @@
 #include <stdlib.h>
 #include <timer.h>
 
+/* State of the transfer in flight, see spi_xfer_start(). */
+struct rockchip_spi_xfer {
+	const uint8_t *dout;
+	uint8_t *din;
+	size_t bytes_out, bytes_in;	/* left in the whole transfer */
+	size_t out_now, in_now;		/* size of the current chunk */
+	size_t out_rem, in_rem;		/* left in the current chunk */
+	size_t min_xfer;
+	bool use_16bit;
+	bool busy;
+};
+
 struct rockchip_spi_slave {
 	struct rockchip_spi *regs;
+	struct rockchip_spi_xfer xfer;
 };
 
 #define SPI_TIMEOUT_US	1000
@@ -189,29 +202,22 @@ static void set_transfer_mode(struct rockchip_spi *regs,
 		set_tmod(regs, SPI_TMOD_RO);	/* rx only */
 }
 
-/* returns 0 to indicate success, <0 otherwise */
-static int do_xfer(struct rockchip_spi *regs, bool use_16bit, const void *dout,
-		   size_t *bytes_out, void *din, size_t *bytes_in)
+/*
+ * Moves as much data through the FIFOs as they allow without waiting.
+ * Returns 0 once the current chunk has been transferred and
+ * SPI_XFER_IN_PROGRESS otherwise.
+ */
+static int service_fifos(struct rockchip_spi *regs,
+			 struct rockchip_spi_xfer *xfer)
 {
-	uint8_t *in_buf = din;
-	uint8_t *out_buf = (uint8_t *)dout;
-	size_t min_xfer;
-
-	if (*bytes_out == 0)
-		min_xfer = *bytes_in;
-	else if (*bytes_in == 0)
-		min_xfer = *bytes_out;
-	else
-		min_xfer = MIN(*bytes_in, *bytes_out);
-
-	while (min_xfer) {
+	while (xfer->min_xfer) {
 		uint32_t sr = read32(&regs->sr);
 		int xferred = 0;	/* in either (or both) directions */
 
-		if (*bytes_out && !(sr & SR_TF_FULL)) {
-			write32(&regs->txdr, *out_buf);
-			out_buf++;
-			*bytes_out -= 1;
+		if (xfer->out_rem && !(sr & SR_TF_FULL)) {
+			write32(&regs->txdr, *xfer->dout);
+			xfer->dout++;
+			xfer->out_rem -= 1;
 			xferred = 1;
 		}
 
@@ -220,42 +226,95 @@ static int do_xfer(struct rockchip_spi *regs, bool use_16bit, const void *dout,
 		 * Reading the status registers probably requires
 		 * sychronizing with the SPI clock which is pretty slow.
 		 */
-		if (*bytes_in && !(sr & SR_RF_EMPT)) {
+		if (xfer->in_rem && !(sr & SR_RF_EMPT)) {
 			int fifo = read32(&regs->rxflr) & RXFLR_LEVEL_MASK;
 			int val;
 
-			if (use_16bit)
+			if (xfer->use_16bit)
 				xferred = fifo * 2;
 			else
 				xferred = fifo;
-			*bytes_in -= xferred;
+			xfer->in_rem -= xferred;
 			while (fifo-- > 0) {
 				val = read32(&regs->rxdr);
-				if (use_16bit) {
-					*in_buf++ = val & 0xff;
-					*in_buf++ = (val >> 8) & 0xff;
+				if (xfer->use_16bit) {
+					*xfer->din++ = val & 0xff;
+					*xfer->din++ = (val >> 8) & 0xff;
 				} else {
-					*in_buf++ = val & 0xff;
+					*xfer->din++ = val & 0xff;
 				}
 			}
 		}
 
-		min_xfer -= xferred;
-	}
+		if (!xferred)
+			return SPI_XFER_IN_PROGRESS;
 
-	if (rockchip_spi_wait_till_not_busy(regs)) {
-		printk(BIOS_ERR, "Timed out waiting on SPI transfer\n");
-		return -1;
+		xfer->min_xfer -= xferred;
 	}
 
 	return 0;
 }
 
-static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
-			  size_t bytes_out, void *din, size_t bytes_in)
+static void start_chunk(struct rockchip_spi *regs,
+			struct rockchip_spi_xfer *xfer)
 {
-	struct rockchip_spi *regs = to_rockchip_spi(slave)->regs;
-	int ret = 0;
+	size_t in_now = MIN(xfer->bytes_in, 0xfffe);
+	size_t out_now = MIN(xfer->bytes_out, 0xfffe);
+	size_t mask;
+	bool use_16bit;
+
+	rockchip_spi_enable_chip(regs, 0);
+
+	/*
+	 * Use 16-bit transfers for higher-speed reads. If we are
+	 * transferring an odd number of bytes, try to make it even.
+	 */
+	use_16bit = false;
+	if (xfer->bytes_out == 0) {
+		if ((in_now & 1) && in_now > 1)
+			in_now--;
+		if (!(in_now & 1))
+			use_16bit = true;
+	}
+	mask = SPI_APB_8BIT << SPI_HALF_WORLD_TX_OFFSET;
+	if (use_16bit)
+		clrbits_le32(&regs->ctrlr0, mask);
+	else
+		setbits_le32(&regs->ctrlr0, mask);
+
+	/* Enable/disable transmitter and receiver as needed to
+	 * avoid sending or reading spurious bits. */
+	set_transfer_mode(regs, xfer->bytes_out, xfer->bytes_in);
+
+	/* MAX() in case either counter is 0 */
+	write32(&regs->ctrlr1, MAX(in_now, out_now) - 1);
+
+	rockchip_spi_enable_chip(regs, 1);
+
+	xfer->in_now = xfer->in_rem = in_now;
+	xfer->out_now = xfer->out_rem = out_now;
+	xfer->use_16bit = use_16bit;
+
+	if (out_now == 0)
+		xfer->min_xfer = in_now;
+	else if (in_now == 0)
+		xfer->min_xfer = out_now;
+	else
+		xfer->min_xfer = MIN(in_now, out_now);
+}
+
+static int spi_ctrlr_xfer_start(const struct spi_slave *slave,
+				const void *dout, size_t bytes_out,
+				void *din, size_t bytes_in)
+{
+	struct rockchip_spi_slave *espi = to_rockchip_spi(slave);
+	struct rockchip_spi_xfer *xfer = &espi->xfer;
+
+	xfer->dout = dout;
+	xfer->din = din;
+	xfer->bytes_out = bytes_out;
+	xfer->bytes_in = bytes_in;
+	xfer->busy = bytes_out || bytes_in;
 
 	/*
 	 * RK3288 SPI controller can transfer up to 65536 data frames (bytes
@@ -265,68 +324,70 @@ static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
 	 * ctrlr1, all bytes that we see in rxdr end up being 0x00. 0xffff - 1
 	 * seems to work fine.
 	 */
-	while (bytes_out || bytes_in) {
-		size_t in_now = MIN(bytes_in, 0xfffe);
-		size_t out_now = MIN(bytes_out, 0xfffe);
-		size_t in_rem, out_rem;
-		size_t mask;
-		bool use_16bit;
+	if (xfer->busy)
+		start_chunk(espi->regs, xfer);
+	else
+		rockchip_spi_enable_chip(espi->regs, 0);
 
-		rockchip_spi_enable_chip(regs, 0);
+	return 0;
+}
 
-		/*
-		 * Use 16-bit transfers for higher-speed reads. If we are
-		 * transferring an odd number of bytes, try to make it even.
-		 */
-		use_16bit = false;
-		if (bytes_out == 0) {
-			if ((in_now & 1) && in_now > 1)
-				in_now--;
-			if (!(in_now & 1))
-				use_16bit = true;
-		}
-		mask = SPI_APB_8BIT << SPI_HALF_WORLD_TX_OFFSET;
-		if (use_16bit)
-			clrbits_le32(&regs->ctrlr0, mask);
-		else
-			setbits_le32(&regs->ctrlr0, mask);
-
-		/* Enable/disable transmitter and receiver as needed to
-		 * avoid sending or reading spurious bits. */
-		set_transfer_mode(regs, bytes_out, bytes_in);
-
-		/* MAX() in case either counter is 0 */
-		write32(&regs->ctrlr1, MAX(in_now, out_now) - 1);
-
-		rockchip_spi_enable_chip(regs, 1);
-
-		in_rem = in_now;
-		out_rem = out_now;
-		ret = do_xfer(regs, use_16bit, dout, &out_rem, din, &in_rem);
-		if (ret < 0)
-			break;
-
-		if (bytes_out) {
-			size_t sent = out_now - out_rem;
-			bytes_out -= sent;
-			dout += sent;
-		}
+static int spi_ctrlr_xfer_poll(const struct spi_slave *slave)
+{
+	struct rockchip_spi_slave *espi = to_rockchip_spi(slave);
+	struct rockchip_spi_xfer *xfer = &espi->xfer;
+	int ret = 0;
 
-		if (bytes_in) {
-			size_t received = in_now - in_rem;
-			bytes_in -= received;
-			din += received;
-		}
+	if (!xfer->busy)
+		return 0;
+
+	if (service_fifos(espi->regs, xfer))
+		return SPI_XFER_IN_PROGRESS;
+
+	if (rockchip_spi_wait_till_not_busy(espi->regs)) {
+		printk(BIOS_ERR, "Timed out waiting on SPI transfer\n");
+		ret = -1;
+		goto done;
 	}
 
-	rockchip_spi_enable_chip(regs, 0);
-	return ret < 0 ? ret : 0;
+	if (xfer->bytes_out)
+		xfer->bytes_out -= xfer->out_now - xfer->out_rem;
+	if (xfer->bytes_in)
+		xfer->bytes_in -= xfer->in_now - xfer->in_rem;
+
+	if (xfer->bytes_out || xfer->bytes_in) {
+		start_chunk(espi->regs, xfer);
+		return SPI_XFER_IN_PROGRESS;
+	}
+
+done:
+	xfer->busy = false;
+	rockchip_spi_enable_chip(espi->regs, 0);
+	return ret;
+}
+
+static int spi_ctrlr_xfer(const struct spi_slave *slave, const void *dout,
+			  size_t bytes_out, void *din, size_t bytes_in)
+{
+	int ret;
+
+	ret = spi_ctrlr_xfer_start(slave, dout, bytes_out, din, bytes_in);
+	if (ret < 0)
+		return ret;
+
+	do {
+		ret = spi_ctrlr_xfer_poll(slave);
+	} while (ret == SPI_XFER_IN_PROGRESS);
+
+	return ret;
 }
 
 static const struct spi_ctrlr spi_ctrlr = {
 	.claim_bus = spi_ctrlr_claim_bus,
 	.release_bus = spi_ctrlr_release_bus,
 	.xfer = spi_ctrlr_xfer,
+	.xfer_start = spi_ctrlr_xfer_start,
+	.xfer_poll = spi_ctrlr_xfer_poll,
 	.max_xfer_size = 65535,
 };
 
@@ -65,6 +65,8 @@
 #define VOP_BIG_BASE		0xff900000 /* corresponds to vop_id 0 */
 #define VOP_LIT_BASE		0xff8f0000 /* corresponds to vop_id 1 */
 
+#define CRYPTO_BASE		0xff8b0000 /* crypto0, same block as RK3288 */
+
 
 #define DDRC0_BASE_ADDR		0xffa80000
 #define SERVER_MSCH0_BASE_ADDR	0xffa84000
@@ -193,6 +193,8 @@ struct rk3399_sdram_params {
 #define PI_FULL_TRAINING	(0xff)
 
 void sdram_init(const struct rk3399_sdram_params *sdram_params);
+/* Save the training results for the next boot, once cbmem is up. */
+void sdram_stash_training(const struct rk3399_sdram_params *sdram_params);
 u32 sdram_get_ram_code(void);
 const struct rk3399_sdram_params *get_sdram_config(void);
 size_t sdram_size_mb(void);
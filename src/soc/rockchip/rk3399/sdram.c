@@ -16,12 +16,14 @@
 #include <arch/io.h>
 #include <console/console.h>
 #include <delay.h>
+#include <mrc_cache.h>
 #include <reset.h>
 #include <soc/addressmap.h>
 #include <soc/clock.h>
 #include <soc/sdram.h>
 #include <soc/grf.h>
 #include <soc/soc.h>
+#include <security/vboot/vboot_common.h>
 #include <string.h>
 #include <timer.h>
 #include <types.h>
@@ -624,19 +626,170 @@ static void override_write_leveling_value(u32 channel)
 	clrsetbits_le32(&denali_ctl[200], 0x1 << 8, 0x1 << 8);
 }
 
-static int data_training(u32 channel,
-			 const struct rk3399_sdram_params *sdram_params,
-			 u32 training_flag)
+/* PHY_532/660/788 phy_adr_calvl_obs1_:0:32 */
+static int ca_training_obs_err(u32 *denali_phy)
+{
+	return ((read32(&denali_phy[532]) >> 30) & 0x3) ||
+	       ((read32(&denali_phy[660]) >> 30) & 0x3) ||
+	       ((read32(&denali_phy[788]) >> 30) & 0x3);
+}
+
+/*
+ * If error maybe can not get leveling done
+ * PHY_40/168/296/424 phy_wrlvl_status_obs_X:0:13
+ */
+static int write_leveling_obs_err(u32 *denali_phy)
+{
+	return ((read32(&denali_phy[40]) >> 12) & 0x1) ||
+	       ((read32(&denali_phy[168]) >> 12) & 0x1) ||
+	       ((read32(&denali_phy[296]) >> 12) & 0x1) ||
+	       ((read32(&denali_phy[424]) >> 12) & 0x1);
+}
+
+/* PHY_43/171/299/427 PHY_GTLVL_STATUS_OBS_x:16:8 */
+static int read_gate_training_obs_err(u32 *denali_phy)
+{
+	return ((read32(&denali_phy[43]) >> (16 + 6)) & 0x3) ||
+	       ((read32(&denali_phy[171]) >> (16 + 6)) & 0x3) ||
+	       ((read32(&denali_phy[299]) >> (16 + 6)) & 0x3) ||
+	       ((read32(&denali_phy[427]) >> (16 + 6)) & 0x3);
+}
+
+/*
+ * One kind of training done by the PI. It is enabled by writing 2 to the
+ * two bit PI_*_EN field and requested per rank through the PI_*_REQ bit and
+ * PI_*_CS field. PI_INT_STATUS then reports done or error.
+ */
+struct training_step {
+	u32 flag;
+	u16 en_reg, en_shift;
+	u16 req_reg, req_shift, cs_shift;
+	u16 done_bit, err_bit;		/* PI_INT_STATUS bits, offset_8 */
+	int (*obs_err)(u32 *denali_phy);
+};
+
+static const struct training_step training_steps[] = {
+	/* ca training(LPDDR4,LPDDR3 support) */
+	{
+		.flag = PI_CA_TRAINING,
+		/* PI_100 PI_CALVL_EN:RW:8:2 */
+		.en_reg = 100, .en_shift = 8,
+		/* PI_92 PI_CALVL_REQ:WR:16:1,PI_CALVL_CS:RW:24:2 */
+		.req_reg = 92, .req_shift = 16, .cs_shift = 24,
+		.done_bit = 11, .err_bit = 5,
+		.obs_err = ca_training_obs_err,
+	},
+	/* write leveling(LPDDR4,LPDDR3,DDR3 support) */
+	{
+		.flag = PI_WRITE_LEVELING,
+		/* PI_60 PI_WRLVL_EN:RW:8:2 */
+		.en_reg = 60, .en_shift = 8,
+		/* PI_59 PI_WRLVL_REQ:WR:8:1,PI_WRLVL_CS:RW:16:2 */
+		.req_reg = 59, .req_shift = 8, .cs_shift = 16,
+		.done_bit = 10, .err_bit = 4,
+		.obs_err = write_leveling_obs_err,
+	},
+	/* read gate training(LPDDR4,LPDDR3,DDR3 support) */
+	{
+		.flag = PI_READ_GATE_TRAINING,
+		/* PI_80 PI_RDLVL_GATE_EN:RW:24:2 */
+		.en_reg = 80, .en_shift = 24,
+		/* PI_74 PI_RDLVL_GATE_REQ:WR:16:1,PI_RDLVL_CS:RW:24:2 */
+		.req_reg = 74, .req_shift = 16, .cs_shift = 24,
+		.done_bit = 9, .err_bit = 3,
+		.obs_err = read_gate_training_obs_err,
+	},
+	/* read leveling(LPDDR4,LPDDR3,DDR3 support) */
+	{
+		.flag = PI_READ_LEVELING,
+		/* PI_80 PI_RDLVL_EN:RW:16:2 */
+		.en_reg = 80, .en_shift = 16,
+		/* PI_74 PI_RDLVL_REQ:WR:8:1,PI_RDLVL_CS:RW:24:2 */
+		.req_reg = 74, .req_shift = 8, .cs_shift = 24,
+		.done_bit = 8, .err_bit = 2,
+	},
+	/* wdq leveling(LPDDR4 support) */
+	{
+		.flag = PI_WDQ_LEVELING,
+		/* PI_124 PI_WDQLVL_EN:RW:16:2 */
+		.en_reg = 124, .en_shift = 16,
+		/* PI_121 PI_WDQLVL_REQ:WR:8:1,PI_WDQLVL_CS:RW:16:2 */
+		.req_reg = 121, .req_shift = 8, .cs_shift = 16,
+		.done_bit = 12, .err_bit = 6,
+	},
+};
+
+static void training_request(u32 channel, const struct training_step *step,
+			     u32 rank)
+{
+	u32 *denali_pi = rk3399_ddr_pi[channel]->denali_pi;
+
+	select_per_cs_training_index(channel, rank);
+
+	if (step->flag == PI_WDQ_LEVELING)
+		/*
+		 * disable PI_WDQLVL_VREF_EN before wdq leveling?
+		 * PI_181 PI_WDQLVL_VREF_EN:RW:8:1
+		 */
+		clrbits_le32(&denali_pi[181], 0x1 << 8);
+
+	clrsetbits_le32(&denali_pi[step->en_reg], 0x3 << step->en_shift,
+			0x2 << step->en_shift);
+	clrsetbits_le32(&denali_pi[step->req_reg],
+			(0x1 << step->req_shift) | (0x3 << step->cs_shift),
+			(0x1 << step->req_shift) | (rank << step->cs_shift));
+}
+
+/* Returns 1 once the request is done, 0 while it runs and -1 on error. */
+static int training_poll(u32 channel, const struct training_step *step)
 {
 	u32 *denali_pi = rk3399_ddr_pi[channel]->denali_pi;
 	u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
-	u32 i, tmp;
-	u32 obs_0, obs_1, obs_2, obs_3, obs_err = 0;
-	u32 rank = sdram_params->ch[channel].rank;
-	u32 reg_value = 0;
+	u32 tmp;
+	int obs_err;
+
+	/* PI_174 PI_INT_STATUS:RD:8:18 */
+	tmp = read32(&denali_pi[174]) >> 8;
+
+	/* check status obs */
+	obs_err = step->obs_err && step->obs_err(denali_phy);
+
+	if ((((tmp >> step->done_bit) & 0x1) == 0x1) &&
+	    (((tmp >> 13) & 0x1) == 0x1) &&
+	    (((tmp >> step->err_bit) & 0x1) == 0x0) &&
+	    !obs_err) {
+		/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
+		write32((&denali_pi[175]), 0x00003f7c);
+		return 1;
+	}
 
-	/* PHY_927 PHY_PAD_DQS_DRIVE  RPULL offset_22 */
-	setbits_le32(&denali_phy[927], (1 << 22));
+	if ((((tmp >> step->err_bit) & 0x1) == 0x1) || obs_err)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Every channel has its own PI doing the training, so each training request
+ * is issued to all channels before waiting for any of them. This runs the
+ * channels in parallel and takes about as long as training a single one.
+ */
+static int data_training(const struct rk3399_sdram_params *sdram_params,
+			 u32 training_flag)
+{
+	u32 ch_count = sdram_params->num_channels;
+	u32 reg_value[2] = { 0 };
+	u32 max_rank = 0;
+	u32 channel, i, s, pending;
+	int ret;
+
+	for (channel = 0; channel < ch_count; channel++) {
+		u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
+
+		/* PHY_927 PHY_PAD_DQS_DRIVE  RPULL offset_22 */
+		setbits_le32(&denali_phy[927], (1 << 22));
+		max_rank = MAX(max_rank, sdram_params->ch[channel].rank);
+	}
 
 	if (training_flag == PI_FULL_TRAINING) {
 		if (sdram_params->dramtype == LPDDR4) {
@@ -653,95 +806,13 @@ static int data_training(u32 channel,
 		}
 	}
 
-	/* ca training(LPDDR4,LPDDR3 support) */
-	if ((training_flag & PI_CA_TRAINING) == PI_CA_TRAINING) {
-		for (i = 0; i < rank; i++) {
-			select_per_cs_training_index(channel, i);
-			/* PI_100 PI_CALVL_EN:RW:8:2 */
-			clrsetbits_le32(&denali_pi[100], 0x3 << 8, 0x2 << 8);
-			/* PI_92 PI_CALVL_REQ:WR:16:1,PI_CALVL_CS:RW:24:2 */
-			clrsetbits_le32(&denali_pi[92],
-					(0x1 << 16) | (0x3 << 24),
-					(0x1 << 16) | (i << 24));
-
-			while (1) {
-				/* PI_174 PI_INT_STATUS:RD:8:18 */
-				tmp = read32(&denali_pi[174]) >> 8;
-
-				/*
-				 * check status obs
-				 * PHY_532/660/789 phy_adr_calvl_obs1_:0:32
-				 */
-				obs_0 = read32(&denali_phy[532]);
-				obs_1 = read32(&denali_phy[660]);
-				obs_2 = read32(&denali_phy[788]);
-				if (((obs_0 >> 30) & 0x3) ||
-				    ((obs_1 >> 30) & 0x3) ||
-				    ((obs_2 >> 30) & 0x3))
-					obs_err = 1;
-				if ((((tmp >> 11) & 0x1) == 0x1) &&
-				    (((tmp >> 13) & 0x1) == 0x1) &&
-				    (((tmp >> 5) & 0x1) == 0x0) &&
-				    (obs_err == 0))
-					break;
-				else if ((((tmp >> 5) & 0x1) == 0x1) ||
-					 (obs_err == 1))
-					return -1;
-			}
-			/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
-			write32((&denali_pi[175]), 0x00003f7c);
-		}
-		clrbits_le32(&denali_pi[100], 0x3 << 8);
-	}
-
-	/* write leveling(LPDDR4,LPDDR3,DDR3 support) */
-	if ((training_flag & PI_WRITE_LEVELING) == PI_WRITE_LEVELING) {
-		for (i = 0; i < rank; i++) {
-			select_per_cs_training_index(channel, i);
-			/* PI_60 PI_WRLVL_EN:RW:8:2 */
-			clrsetbits_le32(&denali_pi[60], 0x3 << 8, 0x2 << 8);
-			/* PI_59 PI_WRLVL_REQ:WR:8:1,PI_WRLVL_CS:RW:16:2 */
-			clrsetbits_le32(&denali_pi[59],
-					(0x1 << 8) | (0x3 << 16),
-					(0x1 << 8) | (i << 16));
-
-			while (1) {
-				/* PI_174 PI_INT_STATUS:RD:8:18 */
-				tmp = read32(&denali_pi[174]) >> 8;
-
-				/*
-				 * check status obs, if error maybe can not
-				 * get leveling done PHY_40/168/296/424
-				 * phy_wrlvl_status_obs_X:0:13
-				 */
-				obs_0 = read32(&denali_phy[40]);
-				obs_1 = read32(&denali_phy[168]);
-				obs_2 = read32(&denali_phy[296]);
-				obs_3 = read32(&denali_phy[424]);
-				if (((obs_0 >> 12) & 0x1) ||
-				    ((obs_1 >> 12) & 0x1) ||
-				    ((obs_2 >> 12) & 0x1) ||
-				    ((obs_3 >> 12) & 0x1))
-					obs_err = 1;
-				if ((((tmp >> 10) & 0x1) == 0x1) &&
-				    (((tmp >> 13) & 0x1) == 0x1) &&
-				    (((tmp >> 4) & 0x1) == 0x0) &&
-				    (obs_err == 0))
-					break;
-				else if ((((tmp >> 4) & 0x1) == 0x1) ||
-					 (obs_err == 1))
-					return -1;
-			}
-			/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
-			write32((&denali_pi[175]), 0x00003f7c);
-		}
-
-		override_write_leveling_value(channel);
-		clrbits_le32(&denali_pi[60], 0x3 << 8);
-	}
+	for (s = 0; s < ARRAY_SIZE(training_steps); s++) {
+		const struct training_step *step = &training_steps[s];
+		int gate_odt = step->flag == PI_READ_GATE_TRAINING &&
+			       sdram_params->dramtype != LPDDR4;
 
-	/* read gate training(LPDDR4,LPDDR3,DDR3 support) */
-	if ((training_flag & PI_READ_GATE_TRAINING) == PI_READ_GATE_TRAINING) {
+		if ((training_flag & step->flag) != step->flag)
+			continue;
 
 		/*
 		 * The differential signal of DQS needs to keep low level
@@ -752,8 +823,11 @@ static int data_training(u32 channel,
 		 * side ODT before gate training and restore ODT state
 		 * after gate training.
 		 */
-		if (sdram_params->dramtype != LPDDR4) {
-			reg_value = (read32(&denali_phy[6]) >> 24) & 0x7;
+		for (channel = 0; gate_odt && channel < ch_count; channel++) {
+			u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
+
+			reg_value[channel] = (read32(&denali_phy[6]) >> 24) &
+					     0x7;
 
 			/*
 			 * phy_dqs_tsel_enable_X 3bits
@@ -764,56 +838,49 @@ static int data_training(u32 channel,
 			clrbits_le32(&denali_phy[262], 0x7 << 24);
 			clrbits_le32(&denali_phy[390], 0x7 << 24);
 		}
-		for (i = 0; i < rank; i++) {
-			select_per_cs_training_index(channel, i);
-			/* PI_80 PI_RDLVL_GATE_EN:RW:24:2 */
-			clrsetbits_le32(&denali_pi[80], 0x3 << 24, 0x2 << 24);
-			/*
-			 * PI_74 PI_RDLVL_GATE_REQ:WR:16:1
-			 * PI_RDLVL_CS:RW:24:2
-			 */
-			clrsetbits_le32(&denali_pi[74],
-					(0x1 << 16) | (0x3 << 24),
-					(0x1 << 16) | (i << 24));
-
-			while (1) {
-				/* PI_174 PI_INT_STATUS:RD:8:18 */
-				tmp = read32(&denali_pi[174]) >> 8;
-
-				/*
-				 * check status obs
-				 * PHY_43/171/299/427
-				 *     PHY_GTLVL_STATUS_OBS_x:16:8
-				 */
-				obs_0 = read32(&denali_phy[43]);
-				obs_1 = read32(&denali_phy[171]);
-				obs_2 = read32(&denali_phy[299]);
-				obs_3 = read32(&denali_phy[427]);
-				if (((obs_0 >> (16 + 6)) & 0x3) ||
-				    ((obs_1 >> (16 + 6)) & 0x3) ||
-				    ((obs_2 >> (16 + 6)) & 0x3) ||
-				    ((obs_3 >> (16 + 6)) & 0x3))
-					obs_err = 1;
-				if ((((tmp >> 9) & 0x1) == 0x1) &&
-				    (((tmp >> 13) & 0x1) == 0x1) &&
-				    (((tmp >> 3) & 0x1) == 0x0) &&
-				    (obs_err == 0))
-					break;
-				else if ((((tmp >> 3) & 0x1) == 0x1) ||
-					 (obs_err == 1))
-					return -1;
+
+		for (i = 0; i < max_rank; i++) {
+			pending = 0;
+			for (channel = 0; channel < ch_count; channel++) {
+				if (i >= sdram_params->ch[channel].rank)
+					continue;
+				training_request(channel, step, i);
+				pending |= 1 << channel;
+			}
+
+			while (pending) {
+				for (channel = 0; channel < ch_count;
+				     channel++) {
+					if (!(pending & (1 << channel)))
+						continue;
+					ret = training_poll(channel, step);
+					if (ret < 0)
+						return -1;
+					if (ret)
+						pending &= ~(1 << channel);
+				}
 			}
-			/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
-			write32((&denali_pi[175]), 0x00003f7c);
 		}
-		clrbits_le32(&denali_pi[80], 0x3 << 24);
 
-		if (sdram_params->dramtype != LPDDR4) {
+		for (channel = 0; channel < ch_count; channel++) {
+			u32 *denali_pi = rk3399_ddr_pi[channel]->denali_pi;
+			u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
+			u32 tmp;
+
+			if (step->flag == PI_WRITE_LEVELING)
+				override_write_leveling_value(channel);
+
+			clrbits_le32(&denali_pi[step->en_reg],
+				     0x3 << step->en_shift);
+
+			if (!gate_odt)
+				continue;
+
 			/*
 			 * phy_dqs_tsel_enable_X 3bits
 			 * DENALI_PHY_6/134/262/390 offset_24
 			 */
-			tmp = reg_value << 24;
+			tmp = reg_value[channel] << 24;
 			clrsetbits_le32(&denali_phy[6], 0x7 << 24, tmp);
 			clrsetbits_le32(&denali_phy[134], 0x7 << 24, tmp);
 			clrsetbits_le32(&denali_phy[262], 0x7 << 24, tmp);
@@ -821,74 +888,13 @@ static int data_training(u32 channel,
 		}
 	}
 
-	/* read leveling(LPDDR4,LPDDR3,DDR3 support) */
-	if ((training_flag & PI_READ_LEVELING) == PI_READ_LEVELING) {
-		for (i = 0; i < rank; i++) {
-			select_per_cs_training_index(channel, i);
-			/* PI_80 PI_RDLVL_EN:RW:16:2 */
-			clrsetbits_le32(&denali_pi[80], 0x3 << 16, 0x2 << 16);
-			/* PI_74 PI_RDLVL_REQ:WR:8:1,PI_RDLVL_CS:RW:24:2 */
-			clrsetbits_le32(&denali_pi[74],
-					(0x1 << 8) | (0x3 << 24),
-					(0x1 << 8) | (i << 24));
-
-			while (1) {
-				/* PI_174 PI_INT_STATUS:RD:8:18 */
-				tmp = read32(&denali_pi[174]) >> 8;
-
-				/*
-				 * make sure status obs not report error bit
-				 * PHY_46/174/302/430
-				 *     phy_rdlvl_status_obs_X:16:8
-				 */
-				if ((((tmp >> 8) & 0x1) == 0x1) &&
-				    (((tmp >> 13) & 0x1) == 0x1) &&
-				    (((tmp >> 2) & 0x1) == 0x0))
-					break;
-				else if (((tmp >> 2) & 0x1) == 0x1)
-					return -1;
-			}
-			/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
-			write32((&denali_pi[175]), 0x00003f7c);
-		}
-		clrbits_le32(&denali_pi[80], 0x3 << 16);
-	}
+	for (channel = 0; channel < ch_count; channel++) {
+		u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
 
-	/* wdq leveling(LPDDR4 support) */
-	if ((training_flag & PI_WDQ_LEVELING) == PI_WDQ_LEVELING) {
-		for (i = 0; i < rank; i++) {
-			select_per_cs_training_index(channel, i);
-			/*
-			 * disable PI_WDQLVL_VREF_EN before wdq leveling?
-			 * PI_181 PI_WDQLVL_VREF_EN:RW:8:1
-			 */
-			clrbits_le32(&denali_pi[181], 0x1 << 8);
-			/* PI_124 PI_WDQLVL_EN:RW:16:2 */
-			clrsetbits_le32(&denali_pi[124], 0x3 << 16, 0x2 << 16);
-			/* PI_121 PI_WDQLVL_REQ:WR:8:1,PI_WDQLVL_CS:RW:16:2 */
-			clrsetbits_le32(&denali_pi[121],
-					(0x1 << 8) | (0x3 << 16),
-					(0x1 << 8) | (i << 16));
-
-			while (1) {
-				/* PI_174 PI_INT_STATUS:RD:8:18 */
-				tmp = read32(&denali_pi[174]) >> 8;
-				if ((((tmp >> 12) & 0x1) == 0x1) &&
-				    (((tmp >> 13) & 0x1) == 0x1) &&
-				    (((tmp >> 6) & 0x1) == 0x0))
-					break;
-				else if (((tmp >> 6) & 0x1) == 0x1)
-					return -1;
-			}
-			/* clear interrupt,PI_175 PI_INT_ACK:WR:0:17 */
-			write32((&denali_pi[175]), 0x00003f7c);
-		}
-		clrbits_le32(&denali_pi[124], 0x3 << 16);
+		/* PHY_927 PHY_PAD_DQS_DRIVE  RPULL offset_22 */
+		clrbits_le32(&denali_phy[927], (1 << 22));
 	}
 
-	/* PHY_927 PHY_PAD_DQS_DRIVE  RPULL offset_22 */
-	clrbits_le32(&denali_phy[927], (1 << 22));
-
 	return 0;
 }
 
@@ -975,7 +981,127 @@ static void dram_all_config(const struct rk3399_sdram_params *sdram_params)
 	clrsetbits_le32(&cru_ptr->glb_rst_con, 0x3, 0x3);
 }
 
-static void switch_to_phy_index1(const struct rk3399_sdram_params *sdram_params)
+/*
+ * Training results end up in the data slice (PHY_0 to PHY_511) and address
+ * slice (PHY_512 to PHY_895) registers of each channel. These are saved in
+ * the MRC cache, keyed by a hash of the SDRAM parameters.
+ */
+#define TRAINING_CACHE_VERSION	1
+#define TRAINING_CACHE_REGS	896
+
+static uint32_t training_cache_version(
+	const struct rk3399_sdram_params *sdram_params)
+{
+	const uint8_t *params = (const uint8_t *)sdram_params;
+
+	return mrc_cache_spd_version(TRAINING_CACHE_VERSION, &params, 1,
+				     sizeof(*sdram_params));
+}
+
+static int training_cache_find(const struct rk3399_sdram_params *sdram_params,
+			       struct region_device *rdev)
+{
+	if (!IS_ENABLED(CONFIG_RK3399_CACHE_DRAM_TRAINING))
+		return -1;
+
+	if (vboot_recovery_mode_memory_retrain())
+		return -1;
+
+	if (mrc_cache_get_current(MRC_TRAINING_DATA,
+				  training_cache_version(sdram_params),
+				  rdev) < 0)
+		return -1;
+
+	if (region_device_sz(rdev) != sdram_params->num_channels *
+				       TRAINING_CACHE_REGS * sizeof(u32))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Write and read back a few bursts spread over all of memory. The spots are
+ * skewed against each other so that they land in both channels whatever the
+ * channel stride is.
+ */
+static int training_cache_verify(void)
+{
+	size_t size = sdram_size_mb() * MiB;
+	uintptr_t addr;
+	u32 i, j, pass;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < 64; i++) {
+			addr = i * (size / 64) + (i % 32) * (4 * KiB + 64);
+			for (j = 0; j < 16; j++)
+				write32((void *)(addr + j * 4),
+					(addr + j * 4) ^ (pass ? ~0 : 0));
+		}
+
+		for (i = 0; i < 64; i++) {
+			addr = i * (size / 64) + (i % 32) * (4 * KiB + 64);
+			for (j = 0; j < 16; j++)
+				if (read32((void *)(addr + j * 4)) !=
+				    ((addr + j * 4) ^ (pass ? ~0 : 0)))
+					return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int training_cache_restore(
+	const struct rk3399_sdram_params *sdram_params,
+	const struct region_device *rdev)
+{
+	u32 buf[128];
+	u32 channel, i, j;
+	size_t offset = 0;
+
+	for (channel = 0; channel < sdram_params->num_channels; channel++) {
+		u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
+
+		for (i = 0; i < TRAINING_CACHE_REGS; i += ARRAY_SIZE(buf)) {
+			if (rdev_readat(rdev, buf, offset, sizeof(buf)) !=
+			    sizeof(buf))
+				return -1;
+			offset += sizeof(buf);
+
+			for (j = 0; j < ARRAY_SIZE(buf); j++)
+				write32(&denali_phy[i + j], buf[j]);
+		}
+	}
+
+	return training_cache_verify();
+}
+
+void sdram_stash_training(const struct rk3399_sdram_params *sdram_params)
+{
+	u32 *buf;
+	u32 channel, i;
+
+	if (!IS_ENABLED(CONFIG_RK3399_CACHE_DRAM_TRAINING))
+		return;
+
+	buf = mrc_cache_stash_reserve(MRC_TRAINING_DATA,
+				      training_cache_version(sdram_params),
+				      sdram_params->num_channels *
+				      TRAINING_CACHE_REGS * sizeof(u32));
+	if (buf == NULL)
+		return;
+
+	for (channel = 0; channel < sdram_params->num_channels; channel++) {
+		u32 *denali_phy = rk3399_ddr_publ[channel]->denali_phy;
+
+		for (i = 0; i < TRAINING_CACHE_REGS; i++)
+			*buf++ = read32(&denali_phy[i]);
+	}
+
+	mrc_cache_stash_commit(MRC_TRAINING_DATA);
+}
+
+static void switch_to_phy_index1(const struct rk3399_sdram_params *sdram_params,
+				 const struct region_device *cache)
 {
 	u32 channel;
 	u32 *denali_phy;
@@ -1007,10 +1133,19 @@ static void switch_to_phy_index1(const struct rk3399_sdram_params *sdram_params)
 	for (channel = 0; channel < ch_count; channel++) {
 		denali_phy = rk3399_ddr_publ[channel]->denali_phy;
 		clrsetbits_le32(&denali_phy[896], (0x3 << 8) | 1, 1 << 8);
-		if (data_training(channel, sdram_params, PI_FULL_TRAINING)) {
-			printk(BIOS_ERR, "index1 training failed, reset\n");
-			hard_reset();
+	}
+
+	if (cache) {
+		if (training_cache_restore(sdram_params, cache) == 0) {
+			printk(BIOS_INFO, "Restored saved DRAM training\n");
+			return;
 		}
+		printk(BIOS_WARNING, "Saved DRAM training failed, retrain\n");
+	}
+
+	if (data_training(sdram_params, PI_FULL_TRAINING)) {
+		printk(BIOS_ERR, "index1 training failed, reset\n");
+		hard_reset();
 	}
 }
 
@@ -1018,6 +1153,8 @@ void sdram_init(const struct rk3399_sdram_params *sdram_params)
 {
 	unsigned char dramtype = sdram_params->dramtype;
 	unsigned int ddr_freq = sdram_params->ddr_freq;
+	struct region_device cache;
+	int cached;
 	int channel;
 
 	printk(BIOS_INFO, "Starting SDRAM initialization...\n");
@@ -1029,6 +1166,13 @@ void sdram_init(const struct rk3399_sdram_params *sdram_params)
 
 	rkclk_configure_ddr(ddr_freq);
 
+	/*
+	 * With saved training results, skip training at the boot frequency
+	 * (index 0): memory isn't accessed before the switch to index 1,
+	 * where the saved results are restored and verified instead.
+	 */
+	cached = training_cache_find(sdram_params, &cache) == 0;
+
 	for (channel = 0; channel < 2; channel++) {
 		phy_dll_bypass_set(channel, rk3399_ddr_publ[channel], ddr_freq);
 
@@ -1048,18 +1192,20 @@ void sdram_init(const struct rk3399_sdram_params *sdram_params)
 		/* LPDDR2/LPDDR3 need to wait DAI complete, max 10us */
 		if (dramtype == LPDDR3)
 			udelay(10);
+	}
 
-		if (data_training(channel, sdram_params, PI_FULL_TRAINING)) {
-			printk(BIOS_ERR,
-			       "SDRAM initialization failed, reset\n");
-			hard_reset();
-		}
+	/* Train all channels at once, see data_training(). */
+	if (!cached && data_training(sdram_params, PI_FULL_TRAINING)) {
+		printk(BIOS_ERR, "SDRAM initialization failed, reset\n");
+		hard_reset();
+	}
 
+	for (channel = 0; channel < sdram_params->num_channels; channel++)
 		set_ddrconfig(sdram_params, channel,
 			      sdram_params->ch[channel].ddrconfig);
-	}
+
 	dram_all_config(sdram_params);
-	switch_to_phy_index1(sdram_params);
+	switch_to_phy_index1(sdram_params, cached ? &cache : NULL);
 
 	printk(BIOS_INFO, "Finish SDRAM initialization...\n");
 }
@@ -8,6 +8,7 @@
 
 #include <cbmem.h>
 #include <fmap.h>
+#include <lib.h>
 #include <stdlib.h>
 #include <string.h>
 #include <timestamp.h>
@@ -21,6 +22,7 @@ enum {
 	GOOGLE_VPD_2_0_OFFSET = 0x600,
 	CROSVPD_CBMEM_MAGIC = 0x43524f53,
 	CROSVPD_CBMEM_VERSION = 0x0001,
+	CROSVPD_INDEX_MAGIC = 0x56504449,
 };
 
 struct vpd_gets_arg {
@@ -41,6 +43,134 @@ struct vpd_cbmem {
 	 */
 };
 
+/*
+ * Hash table over the RO VPD strings in the vpd_cbmem blob, so that lookups
+ * don't decode the whole VPD again. Colliding keys go to the next slot.
+ */
+struct vpd_index_entry {
+	uint32_t hash;			/* 0 if the slot is free */
+	uint32_t key_offset;		/* in vpd_cbmem.blob */
+	uint32_t key_len;
+	uint32_t value_offset;		/* in vpd_cbmem.blob */
+	uint32_t value_len;
+};
+
+struct vpd_index {
+	uint32_t magic;
+	uint32_t slots;			/* power of two */
+	struct vpd_index_entry entries[0];
+};
+
+struct vpd_index_arg {
+	const uint8_t *blob;
+	struct vpd_index *index;
+	uint32_t count;
+};
+
+/* FNV-1a, never 0 so that 0 can mark free slots. */
+static uint32_t vpd_hash(const uint8_t *key, int32_t key_len)
+{
+	uint32_t hash = 2166136261u;
+
+	while (key_len--) {
+		hash ^= *key++;
+		hash *= 16777619;
+	}
+	return hash ? hash : 1;
+}
+
+static int vpd_count_callback(const uint8_t *key, int32_t key_len,
+			      const uint8_t *value, int32_t value_len,
+			      void *arg)
+{
+	struct vpd_index_arg *index_arg = arg;
+
+	index_arg->count++;
+	return VPD_OK;
+}
+
+static int vpd_index_callback(const uint8_t *key, int32_t key_len,
+			      const uint8_t *value, int32_t value_len,
+			      void *arg)
+{
+	struct vpd_index_arg *index_arg = arg;
+	struct vpd_index *index = index_arg->index;
+	const uint32_t hash = vpd_hash(key, key_len);
+	uint32_t slot = hash & (index->slots - 1);
+	struct vpd_index_entry *e;
+
+	for (;; slot = (slot + 1) & (index->slots - 1)) {
+		e = &index->entries[slot];
+		if (!e->hash)
+			break;
+		/* Like the linear search, the first of duplicate keys wins. */
+		if (e->hash == hash && e->key_len == key_len &&
+		    !memcmp(index_arg->blob + e->key_offset, key, key_len))
+			return VPD_OK;
+	}
+
+	e->hash = hash;
+	e->key_offset = key - index_arg->blob;
+	e->key_len = key_len;
+	e->value_offset = value - index_arg->blob;
+	e->value_len = value_len;
+	return VPD_OK;
+}
+
+static void cbmem_add_vpd_index(const struct vpd_cbmem *vpd)
+{
+	struct vpd_index_arg arg = { .blob = vpd->blob };
+	struct vpd_index *index;
+	uint32_t slots;
+	int consumed = 0;
+
+	while (decodeVpdString(vpd->ro_size, vpd->blob, &consumed,
+			       vpd_count_callback, &arg) == VPD_OK)
+		;
+	if (!arg.count)
+		return;
+
+	/* Keep the table at most half full. */
+	slots = 1 << log2_ceil(2 * arg.count);
+	index = cbmem_add(CBMEM_ID_VPD_INDEX, sizeof(*index) +
+			  slots * sizeof(index->entries[0]));
+	if (!index) {
+		printk(BIOS_ERR, "%s: Failed to allocate CBMEM.\n", __func__);
+		return;
+	}
+	memset(index, 0, sizeof(*index) + slots * sizeof(index->entries[0]));
+	index->slots = slots;
+
+	arg.index = index;
+	consumed = 0;
+	while (decodeVpdString(vpd->ro_size, vpd->blob, &consumed,
+			       vpd_index_callback, &arg) == VPD_OK)
+		;
+	index->magic = CROSVPD_INDEX_MAGIC;
+}
+
+static const void *vpd_index_find(const struct vpd_cbmem *vpd,
+				  const struct vpd_index *index,
+				  const char *key, int *size)
+{
+	const int32_t key_len = strlen(key);
+	const uint32_t hash = vpd_hash((const uint8_t *)key, key_len);
+	uint32_t slot = hash & (index->slots - 1);
+	const struct vpd_index_entry *e;
+
+	for (;; slot = (slot + 1) & (index->slots - 1)) {
+		e = &index->entries[slot];
+		if (!e->hash)
+			return NULL;
+		if (e->hash == hash && e->key_len == key_len &&
+		    !memcmp(vpd->blob + e->key_offset, key, key_len))
+			break;
+	}
+
+	*size = e->value_len;
+	return vpd->blob + e->value_offset;
+}
+
 /* returns the size of data in a VPD 2.0 formatted fmap region, or 0 */
 static int32_t get_vpd_size(const char *fmap_name, int32_t *base)
 {
@@ -139,6 +269,8 @@ static void cbmem_add_cros_vpd(int is_recovery)
 		timestamp_add_now(TS_END_COPYVPD_RO);
 	}
 
+	cbmem_add_vpd_index(cbmem);
+
 	if (rw_vpd_size) {
 		if (fmap_locate_area_as_rdev("RW_VPD", &vpd)) {
 			/* shouldn't happen, but let's be extra defensive */
@@ -183,11 +315,16 @@ const void *cros_vpd_find(const char *key, int *size)
 	struct vpd_gets_arg arg = {0};
 	int consumed = 0;
 	const struct vpd_cbmem *vpd;
+	const struct vpd_index *index;
 
 	vpd = cbmem_find(CBMEM_ID_VPD);
 	if (!vpd || !vpd->ro_size)
 		return NULL;
 
+	index = cbmem_find(CBMEM_ID_VPD_INDEX);
+	if (index && index->magic == CROSVPD_INDEX_MAGIC)
+		return vpd_index_find(vpd, index, key, size);
+
 	arg.key = (const uint8_t *)key;
 	arg.key_len = strlen(key);
 
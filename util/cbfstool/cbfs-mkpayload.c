@@ -78,6 +78,8 @@ int parse_elf_to_payload(const struct buffer *input, struct buffer *output,
 	int isize = 0, osize = 0;
 	int doffset = 0;
 	struct cbfs_payload_segment *segs = NULL;
+	struct compress_job *jobs = NULL;
+	size_t njobs = 0, j = 0;
 	int i;
 	int ret = 0;
 
@@ -183,6 +185,30 @@ int parse_elf_to_payload(const struct buffer *input, struct buffer *output,
 		}
 	}
 
+	/* Segments are compressed independently of each other, which allows
+	 * doing all of them in parallel up front. */
+	jobs = calloc(headers, sizeof(*jobs));
+	if (jobs == NULL) {
+		ret = -1;
+		goto out;
+	}
+	for (i = 0; i < headers; i++) {
+		if (phdr[i].p_type != PT_LOAD || phdr[i].p_memsz == 0 ||
+		    phdr[i].p_filesz == 0)
+			continue;
+		jobs[njobs].in = &header[phdr[i].p_offset];
+		jobs[njobs].in_len = phdr[i].p_filesz;
+		jobs[njobs].out = malloc(phdr[i].p_filesz);
+		if (jobs[njobs++].out == NULL) {
+			ret = -1;
+			goto out;
+		}
+	}
+	if (compress_parallel(compress, jobs, njobs)) {
+		ret = -1;
+		goto out;
+	}
+
 	for (i = 0; i < headers; i++) {
 		if (phdr[i].p_type != PT_LOAD)
 			continue;
@@ -209,10 +235,9 @@ int parse_elf_to_payload(const struct buffer *input, struct buffer *output,
 		/* If the compression failed or made the section is larger,
 		   use the original stuff */
 
-		int len;
-		if (compress((char *)&header[phdr[i].p_offset],
-			     phdr[i].p_filesz, output->data + doffset, &len) ||
-		    (unsigned int)len > phdr[i].p_filesz) {
+		struct compress_job *job = &jobs[j++];
+		int len = job->out_len;
+		if (job->result || (unsigned int)len > phdr[i].p_filesz) {
 			WARN("Compression failed or would make the data bigger "
 			     "- disabled.\n");
 			segs[segments].compression = 0;
@@ -222,6 +247,7 @@ int parse_elf_to_payload(const struct buffer *input, struct buffer *output,
 		} else {
 			segs[segments].compression = algo;
 			segs[segments].len = len;
+			memcpy(output->data + doffset, job->out, len);
 		}
 
 		doffset += segs[segments].len;
@@ -237,6 +263,11 @@ int parse_elf_to_payload(const struct buffer *input, struct buffer *output,
 	xdr_segs(output, segs, segments);
 
 out:
+	if (jobs) {
+		for (j = 0; j < njobs; j++)
+			free(jobs[j].out);
+		free(jobs);
+	}
 	if (segs) free(segs);
 	if (shdr) free(shdr);
 	if (phdr) free(phdr);
@@ -59,7 +59,7 @@ struct cbfs_header {
 	uint32_t align; /* hard coded to 64 byte */
 	uint32_t offset;
 	uint32_t architecture;	/* Version 2 */
-	uint32_t pad[1];
+	uint32_t stage_offset;	/* First stage of the bootblock, 0 if unset */
 } __packed;
 
 #define CBFS_ARCHITECTURE_UNKNOWN  0xFFFFFFFF
@@ -173,6 +173,7 @@ struct cbfs_payload {
 #define CBFS_COMPONENT_STAGE      0x10
 #define CBFS_COMPONENT_SELF       0x20
 #define CBFS_COMPONENT_FIT        0x21
+#define CBFS_COMPONENT_BZIMAGE    0x22
 #define CBFS_COMPONENT_OPTIONROM  0x30
 #define CBFS_COMPONENT_BOOTSPLASH 0x40
 #define CBFS_COMPONENT_RAW        0x50
@@ -207,6 +208,7 @@ static struct typedesc_t filetypes[] unused = {
 	{CBFS_COMPONENT_STAGE, "stage"},
 	{CBFS_COMPONENT_SELF, "simple elf"},
 	{CBFS_COMPONENT_FIT, "fit"},
+	{CBFS_COMPONENT_BZIMAGE, "bzimage"},
 	{CBFS_COMPONENT_OPTIONROM, "optionrom"},
 	{CBFS_COMPONENT_BOOTSPLASH, "bootsplash"},
 	{CBFS_COMPONENT_RAW, "raw"},
@@ -144,6 +144,7 @@ void cbfs_put_header(void *dest, const struct cbfs_header *header)
 	xdr_be.put32(&outheader, header->align);
 	xdr_be.put32(&outheader, header->offset);
 	xdr_be.put32(&outheader, header->architecture);
+	xdr_be.put32(&outheader, header->stage_offset);
 }
 
 static void cbfs_decode_payload_segment(struct cbfs_payload_segment *output,
@@ -215,6 +216,7 @@ void cbfs_get_header(struct cbfs_header *header, void *src)
 	header->align = xdr_be.get32(&outheader);
 	header->offset = xdr_be.get32(&outheader);
 	header->architecture = xdr_be.get32(&outheader);
+	header->stage_offset = xdr_be.get32(&outheader);
 }
 
 int cbfs_image_create(struct cbfs_image *image, size_t entries_size)
@@ -329,6 +331,7 @@ int cbfs_legacy_image_create(struct cbfs_image *image,
 	image->header.align = align;
 	image->header.offset = entries_offset;
 	image->header.architecture = architecture;
+	image->header.stage_offset = 0;
 
 	header_loc = (image->buffer.data + header_offset);
 	cbfs_put_header(header_loc, &image->header);
@@ -639,6 +642,82 @@ int cbfs_compact_instance(struct cbfs_image *image)
 	return 0;
 }
 
+bool cbfs_file_is_pinned(struct cbfs_file *entry)
+{
+	if (ntohl(entry->type) == CBFS_COMPONENT_CBFSHEADER)
+		return true;
+
+	for (struct cbfs_file_attribute *attr = cbfs_file_first_attr(entry);
+	     attr != NULL; attr = cbfs_file_next_attr(entry, attr)) {
+		uint32_t tag = ntohl(attr->tag);
+
+		if (tag == CBFS_FILE_ATTR_TAG_POSITION ||
+		    tag == CBFS_FILE_ATTR_TAG_ALIGNMENT)
+			return true;
+	}
+	return false;
+}
+
+int cbfs_order_instance(struct cbfs_image *image, const char *const names[],
+			size_t count)
+{
+	assert(image);
+
+	struct cbfs_file **saved = calloc(count, sizeof(*saved));
+	struct cbfs_file *entry;
+	size_t i;
+	int ret = 1;
+
+	if (!saved) {
+		ERROR("Out of memory saving files to reorder.\n");
+		return 1;
+	}
+
+	/* Take the listed files out of the image, keeping header and data. */
+	for (i = 0; i < count; i++) {
+		entry = cbfs_get_entry(image, names[i]);
+		if (!entry) {
+			ERROR("CBFS file %s not found.\n", names[i]);
+			goto out;
+		}
+		if (cbfs_file_is_pinned(entry)) {
+			ERROR("'%s' has a fixed location and can't be moved.\n",
+			      names[i]);
+			goto out;
+		}
+
+		saved[i] = malloc(cbfs_file_entry_size(entry));
+		if (!saved[i]) {
+			ERROR("Out of memory saving '%s'.\n", names[i]);
+			goto out;
+		}
+		memcpy(saved[i], entry, cbfs_file_entry_size(entry));
+		entry->type = htonl(CBFS_COMPONENT_DELETED);
+	}
+
+	/* Leave all the free space in one extent at the end... */
+	if (cbfs_compact_instance(image))
+		goto out;
+
+	/* ...and append the files to it back to back, in the given order. */
+	for (i = 0; i < count; i++) {
+		struct buffer data;
+
+		buffer_init(&data, saved[i]->filename, CBFS_SUBHEADER(saved[i]),
+			    cbfs_file_entry_data_size(saved[i]));
+		if (cbfs_add_entry(image, &data, 0, saved[i]))
+			goto out;
+	}
+	ret = 0;
+
+out:
+	/* On failure the caller is expected to drop the modified image. */
+	for (i = 0; i < count; i++)
+		free(saved[i]);
+	free(saved);
+	return ret;
+}
+
 int cbfs_image_delete(struct cbfs_image *image)
 {
 	if (image == NULL)
@@ -732,6 +811,81 @@ static int cbfs_add_entry_at(struct cbfs_image *image,
 	return 0;
 }
 
+/*
+ * A free extent is an empty entry spanning [addr, end), where end is the
+ * address of the entry following it.
+ */
+struct cbfs_free_extent {
+	struct cbfs_file *entry;
+	uint32_t addr;
+	uint32_t end;
+};
+
+/*
+ * Merges adjacent empty entries and collects what is left into an array
+ * ordered by address, so that placement decisions can compare every hole
+ * without walking the image again. The caller frees *extents.
+ * Returns the number of extents, or -1 if out of memory.
+ */
+static int cbfs_free_extents(struct cbfs_image *image,
+			     struct cbfs_free_extent **extents)
+{
+	struct cbfs_file *entry;
+	int count = 0, capacity = 0;
+
+	cbfs_walk(image, cbfs_merge_empty_entry, NULL);
+
+	*extents = NULL;
+	for (entry = cbfs_find_first_entry(image);
+	     entry && cbfs_is_valid_entry(image, entry);
+	     entry = cbfs_find_next_entry(image, entry)) {
+		if (ntohl(entry->type) != CBFS_COMPONENT_NULL)
+			continue;
+
+		if (count == capacity) {
+			struct cbfs_free_extent *grown;
+
+			capacity = capacity ? capacity * 2 : 16;
+			grown = realloc(*extents, capacity * sizeof(*grown));
+			if (!grown) {
+				free(*extents);
+				*extents = NULL;
+				return -1;
+			}
+			*extents = grown;
+		}
+		(*extents)[count].entry = entry;
+		(*extents)[count].addr = cbfs_get_entry_addr(image, entry);
+		(*extents)[count].end = cbfs_get_entry_addr(image,
+				cbfs_find_next_entry(image, entry));
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Picks the smallest free extent that can hold need_size bytes, preferring
+ * the lowest address among equally sized ones. Filling the tightest hole
+ * first keeps large holes intact for large files, where first-fit would
+ * chop them up with small files and leave alignment gaps unused.
+ */
+static const struct cbfs_free_extent *cbfs_best_fit(
+		const struct cbfs_free_extent *extents, int count,
+		uint32_t need_size)
+{
+	const struct cbfs_free_extent *best = NULL;
+
+	for (int i = 0; i < count; i++) {
+		uint32_t space = extents[i].end - extents[i].addr;
+
+		if (space < need_size)
+			continue;
+		if (!best || space < best->end - best->addr)
+			best = &extents[i];
+	}
+	return best;
+}
+
 int cbfs_add_entry(struct cbfs_image *image, struct buffer *buffer,
 		   uint32_t content_offset,
 		   struct cbfs_file *header)
@@ -743,9 +897,8 @@ int cbfs_add_entry(struct cbfs_image *image, struct buffer *buffer,
 
 	const char *name = header->filename;
 
-	uint32_t entry_type;
 	uint32_t addr, addr_next;
-	struct cbfs_file *entry, *next;
+	struct cbfs_file *entry;
 	uint32_t need_size;
 	uint32_t header_size = ntohl(header->offset);
 
@@ -753,21 +906,26 @@ int cbfs_add_entry(struct cbfs_image *image, struct buffer *buffer,
 	DEBUG("cbfs_add_entry('%s'@0x%x) => need_size = %u+%zu=%u\n",
 	      name, content_offset, header_size, buffer->size, need_size);
 
-	// Merge empty entries.
+	// Merge empty entries and index the remaining space.
 	DEBUG("(trying to merge empty entries...)\n");
-	cbfs_walk(image, cbfs_merge_empty_entry, NULL);
+	struct cbfs_free_extent *extents;
+	int count = cbfs_free_extents(image, &extents);
+	const struct cbfs_free_extent *extent = NULL;
 
-	for (entry = cbfs_find_first_entry(image);
-	     entry && cbfs_is_valid_entry(image, entry);
-	     entry = cbfs_find_next_entry(image, entry)) {
+	if (count < 0) {
+		ERROR("Out of memory indexing free space.\n");
+		return -1;
+	}
 
-		entry_type = ntohl(entry->type);
-		if (entry_type != CBFS_COMPONENT_NULL)
-			continue;
+	if (content_offset == 0) {
+		extent = cbfs_best_fit(extents, count, need_size);
+		if (extent)
+			content_offset = extent->addr + header_size;
+	}
 
-		addr = cbfs_get_entry_addr(image, entry);
-		next = cbfs_find_next_entry(image, entry);
-		addr_next = cbfs_get_entry_addr(image, next);
+	for (int i = 0; i < count && !extent; i++) {
+		addr = extents[i].addr;
+		addr_next = extents[i].end;
 
 		DEBUG("cbfs_add_entry: space at 0x%x+0x%x(%d) bytes\n",
 		      addr, addr_next - addr, addr_next - addr);
@@ -779,39 +937,36 @@ int cbfs_add_entry(struct cbfs_image *image, struct buffer *buffer,
 			continue;
 
 		// Test for complicated cases
-		if (content_offset > 0) {
-			if (addr_next < content_offset) {
-				DEBUG("Not for specified offset yet");
-				continue;
-			} else if (addr > content_offset) {
-				DEBUG("Exceed specified content_offset.");
-				break;
-			} else if (addr + header_size > content_offset) {
-				ERROR("Not enough space for header.\n");
-				break;
-			} else if (content_offset + buffer->size > addr_next) {
-				ERROR("Not enough space for content.\n");
-				break;
-			}
+		if (addr_next < content_offset) {
+			DEBUG("Not for specified offset yet");
+			continue;
+		} else if (addr > content_offset) {
+			DEBUG("Exceed specified content_offset.");
+			break;
+		} else if (addr + header_size > content_offset) {
+			ERROR("Not enough space for header.\n");
+			break;
+		} else if (content_offset + buffer->size > addr_next) {
+			ERROR("Not enough space for content.\n");
+			break;
 		}
 
 		// TODO there are more few tricky cases that we may
 		// want to fit by altering offset.
+		extent = &extents[i];
+	}
 
-		if (content_offset == 0) {
-			// we tested every condition earlier under which
-			// placing the file there might fail
-			content_offset = addr + header_size;
-		}
-
+	if (extent) {
 		DEBUG("section 0x%x+0x%x for content_offset 0x%x.\n",
-		      addr, addr_next - addr, content_offset);
+		      extent->addr, extent->end - extent->addr, content_offset);
 
+		entry = extent->entry;
+		free(extents);
 		if (cbfs_add_entry_at(image, entry, buffer->data,
-				      content_offset, header) == 0) {
+				      content_offset, header) == 0)
 			return 0;
-		}
-		break;
+	} else {
+		free(extents);
 	}
 
 	ERROR("Could not add [%s, %zd bytes (%zd KB)@0x%x]; too big?\n",
@@ -1942,12 +2097,48 @@ static size_t absolute_align(const struct cbfs_image *image, size_t val,
 
 }
 
+/* Returns where content fits inside [addr, addr_next), or -1. */
+static int32_t cbfs_locate_in_extent(const struct cbfs_image *image,
+				     size_t addr, size_t addr_next,
+				     size_t size, size_t page_size,
+				     size_t align, size_t metadata_size)
+{
+	size_t addr2, addr3, offset;
+
+	offset = absolute_align(image, addr + metadata_size, align);
+	if (is_in_same_page(offset, size, page_size) &&
+	    is_in_range(addr, addr_next, metadata_size, offset, size)) {
+		DEBUG("cbfs_locate_entry: FIT (PAGE1).");
+		return offset;
+	}
+
+	addr2 = align_up(addr, page_size);
+	offset = absolute_align(image, addr2, align);
+	if (is_in_range(addr, addr_next, metadata_size, offset, size)) {
+		DEBUG("cbfs_locate_entry: OVERLAP (PAGE2).");
+		return offset;
+	}
+
+	/* Assume page_size >= metadata_size so adding one page will
+	 * definitely provide the space for header. */
+	assert(page_size >= metadata_size);
+	addr3 = addr2 + page_size;
+	offset = absolute_align(image, addr3, align);
+	if (is_in_range(addr, addr_next, metadata_size, offset, size)) {
+		DEBUG("cbfs_locate_entry: OVERLAP+ (PAGE3).");
+		return offset;
+	}
+	return -1;
+}
+
 int32_t cbfs_locate_entry(struct cbfs_image *image, size_t size,
 			  size_t page_size, size_t align, size_t metadata_size)
 {
-	struct cbfs_file *entry;
+	struct cbfs_free_extent *extents;
 	size_t need_len;
-	size_t addr, addr_next, addr2, addr3, offset;
+	int32_t best = -1;
+	size_t best_space = 0;
+	int count;
 
 	/* Default values: allow fitting anywhere in ROM. */
 	if (!page_size)
@@ -1969,7 +2160,11 @@ int32_t cbfs_locate_entry(struct cbfs_image *image, size_t size,
 	need_len = metadata_size + size;
 
 	// Merge empty entries to build get max available space.
-	cbfs_walk(image, cbfs_merge_empty_entry, NULL);
+	count = cbfs_free_extents(image, &extents);
+	if (count < 0) {
+		ERROR("Out of memory indexing free space.\n");
+		return -1;
+	}
 
 	/* Three cases of content location on memory page:
 	 * case 1.
@@ -1991,44 +2186,26 @@ int32_t cbfs_locate_entry(struct cbfs_image *image, size_t size,
 	 * commands (will be re-calculated and positioned by cbfs_add_entry_at).
 	 * For stage targets, the address is also used to re-link stage before
 	 * being added into CBFS.
+	 *
+	 * Of all the empty entries offering a place, the smallest one wins
+	 * (see cbfs_best_fit()), so that aligned and page-bound files fill
+	 * the gaps left by earlier ones instead of fragmenting fresh space.
 	 */
-	for (entry = cbfs_find_first_entry(image);
-	     entry && cbfs_is_valid_entry(image, entry);
-	     entry = cbfs_find_next_entry(image, entry)) {
-
-		uint32_t type = ntohl(entry->type);
-		if (type != CBFS_COMPONENT_NULL)
-			continue;
+	for (int i = 0; i < count; i++) {
+		size_t space = extents[i].end - extents[i].addr;
+		int32_t offset;
 
-		addr = cbfs_get_entry_addr(image, entry);
-		addr_next = cbfs_get_entry_addr(image, cbfs_find_next_entry(
-				image, entry));
-		if (addr_next - addr < need_len)
+		if (space < need_len || (best >= 0 && space >= best_space))
 			continue;
 
-		offset = absolute_align(image, addr + metadata_size, align);
-		if (is_in_same_page(offset, size, page_size) &&
-		    is_in_range(addr, addr_next, metadata_size, offset, size)) {
-			DEBUG("cbfs_locate_entry: FIT (PAGE1).");
-			return offset;
-		}
-
-		addr2 = align_up(addr, page_size);
-		offset = absolute_align(image, addr2, align);
-		if (is_in_range(addr, addr_next, metadata_size, offset, size)) {
-			DEBUG("cbfs_locate_entry: OVERLAP (PAGE2).");
-			return offset;
-		}
-
-		/* Assume page_size >= metadata_size so adding one page will
-		 * definitely provide the space for header. */
-		assert(page_size >= metadata_size);
-		addr3 = addr2 + page_size;
-		offset = absolute_align(image, addr3, align);
-		if (is_in_range(addr, addr_next, metadata_size, offset, size)) {
-			DEBUG("cbfs_locate_entry: OVERLAP+ (PAGE3).");
-			return offset;
+		offset = cbfs_locate_in_extent(image, extents[i].addr,
+				extents[i].end, size, page_size, align,
+				metadata_size);
+		if (offset >= 0) {
+			best = offset;
+			best_space = space;
 		}
 	}
-	return -1;
+	free(extents);
+	return best;
 }
@@ -80,6 +80,18 @@ int cbfs_copy_instance(struct cbfs_image *image, struct buffer *dst);
  * beginning of the image. Returns 0 on success, otherwise non-zero.  */
 int cbfs_compact_instance(struct cbfs_image *image);
 
+/* Returns whether a file can't be moved: it has a position or alignment
+ * attribute, or it is the master header. */
+bool cbfs_file_is_pinned(struct cbfs_file *entry);
+
+/* Compact a CBFS image like cbfs_compact_instance() and then place the named
+ * files right after the remaining ones, back to back in the given order, so
+ * that loading them in that order reads the boot media sequentially. Pinned
+ * files (see cbfs_file_is_pinned()) are rejected.
+ * Returns 0 on success, otherwise non-zero.  */
+int cbfs_order_instance(struct cbfs_image *image, const char *const names[],
+			size_t count);
+
 /* Expand a CBFS image inside an fmap region to the entire region's space.
    Returns 0 on success, otherwise non-zero. */
 int cbfs_expand_to_region(struct buffer *region);
@@ -81,11 +81,16 @@ static struct param {
 	bool fill_partial_downward;
 	bool show_immutable;
 	bool stage_xip;
+	bool boot_stage;
 	bool autogen_attr;
 	bool machine_parseable;
 	int fit_empty_entries;
 	enum comp_algo compression;
 	int precompression;
+	/* for -c auto, in KiB/s */
+	bool autocompression;
+	uint32_t media_speed;
+	uint32_t decompress_speed[CBFS_COMPRESS_LZ4 + 1];
 	enum vb2_hash_algorithm hash;
 	/* for linux payloads */
 	char *initrd;
@@ -95,6 +100,13 @@ static struct param {
 	/* All variables not listed are initialized as zero. */
 	.arch = CBFS_ARCHITECTURE_UNKNOWN,
 	.compression = CBFS_COMPRESS_NONE,
+	/* Rough numbers for a 50MHz dual I/O SPI flash and a boot CPU
+	 * decompressing into DRAM. */
+	.media_speed = 10 * KiB,
+	.decompress_speed = {
+		[CBFS_COMPRESS_LZMA] = 32 * KiB,
+		[CBFS_COMPRESS_LZ4] = 256 * KiB,
+	},
 	.hash = VB2_HASH_INVALID,
 	.headeroffset = ~0,
 	.region_name = SECTION_NAME_PRIMARY_CBFS,
@@ -362,6 +374,7 @@ static int cbfs_add_master_header(void)
 	h->romsize = htonl(size + offset);
 	h->offset = htonl(offset);
 	h->architecture = htonl(CBFS_ARCHITECTURE_UNKNOWN);
+	h->stage_offset = 0;
 
 	header = cbfs_create_file_header(CBFS_COMPONENT_CBFSHEADER,
 		buffer_size(&buffer), name);
@@ -442,6 +455,111 @@ static int add_topswap_bootblock(struct buffer *buffer, uint32_t *offset)
 	return 0;
 }
 
+/*
+ * Estimated time in microseconds to read size bytes from the boot media and,
+ * for compressed data, to decompress it into raw_size bytes.
+ */
+static uint64_t estimate_load_time(enum comp_algo algo, size_t size,
+				   size_t raw_size)
+{
+	uint64_t us = (uint64_t)size * 1000000 /
+			((uint64_t)param.media_speed * KiB);
+
+	if (algo != CBFS_COMPRESS_NONE)
+		us += (uint64_t)raw_size * 1000000 /
+			((uint64_t)param.decompress_speed[algo] * KiB);
+	return us;
+}
+
+/*
+ * Run convert once for every compression algorithm and keep the result that
+ * is expected to load fastest, given the boot media and decompression speeds.
+ * On success, buffer, offset and header are replaced by the winning result.
+ */
+static int cbfstool_convert_fastest(convert_buffer_t convert,
+		struct buffer *buffer, uint32_t *offset,
+		struct cbfs_file **header)
+{
+	const struct typedesc_t *algo;
+	struct buffer best_buffer = { 0 };
+	struct cbfs_file *best_header = NULL;
+	uint32_t best_offset = *offset;
+	enum comp_algo best_algo = CBFS_COMPRESS_NONE;
+	const char *best_name = NULL;
+	uint64_t best_us = UINT64_MAX, none_us = 0, worst_us = 0;
+	size_t raw_size = 0;
+
+	for (algo = &types_cbfs_compression[0]; algo->name != NULL; algo++) {
+		struct buffer trial;
+		struct cbfs_file *trial_header;
+		uint32_t trial_offset = *offset;
+		uint64_t us;
+
+		if (buffer_create(&trial, buffer_size(buffer), buffer->name))
+			goto error;
+		memcpy(buffer_get(&trial), buffer_get(buffer),
+		       buffer_size(buffer));
+		trial_header = cbfs_create_file_header(ntohl((*header)->type),
+				buffer_size(buffer), (*header)->filename);
+
+		param.compression = algo->type;
+		if (convert(&trial, &trial_offset, trial_header) != 0) {
+			free(trial_header);
+			buffer_delete(&trial);
+			goto error;
+		}
+
+		/* Algorithms are listed with "none" first. */
+		if (algo->type == CBFS_COMPRESS_NONE)
+			raw_size = buffer_size(&trial);
+
+		us = estimate_load_time(algo->type, buffer_size(&trial),
+					raw_size);
+		INFO("%s: %s, %zu bytes, ~%llu us to load\n",
+		     (*header)->filename, algo->name, buffer_size(&trial),
+		     (unsigned long long)us);
+
+		if (algo->type == CBFS_COMPRESS_NONE)
+			none_us = us;
+		worst_us = MAX(worst_us, us);
+
+		if (us >= best_us) {
+			free(trial_header);
+			buffer_delete(&trial);
+			continue;
+		}
+
+		free(best_header);
+		buffer_delete(&best_buffer);
+		best_buffer = trial;
+		best_header = trial_header;
+		best_offset = trial_offset;
+		best_algo = algo->type;
+		best_name = algo->name;
+		best_us = us;
+	}
+
+	LOG("%s: using %s compression, ~%llu us to load, saving %llu us over "
+	    "no compression and %llu us over the slowest option\n",
+	    (*header)->filename, best_name,
+	    (unsigned long long)best_us,
+	    (unsigned long long)(none_us - best_us),
+	    (unsigned long long)(worst_us - best_us));
+
+	param.compression = best_algo;
+	free(*header);
+	buffer_delete(buffer);
+	*buffer = best_buffer;
+	*header = best_header;
+	*offset = best_offset;
+	return 0;
+
+error:
+	free(best_header);
+	buffer_delete(&best_buffer);
+	return -1;
+}
+
 static int cbfs_add_component(const char *filename,
 			      const char *name,
 			      uint32_t type,
@@ -490,7 +608,15 @@ static int cbfs_add_component(const char *filename,
 	struct cbfs_file *header =
 		cbfs_create_file_header(type, buffer.size, name);
 
-	if (convert && convert(&buffer, &offset, header) != 0) {
+	if (convert && param.autocompression) {
+		if (cbfstool_convert_fastest(convert, &buffer, &offset,
+					     &header) != 0) {
+			ERROR("Failed to parse file '%s'.\n", filename);
+			free(header);
+			buffer_delete(&buffer);
+			return 1;
+		}
+	} else if (convert && convert(&buffer, &offset, header) != 0) {
 		ERROR("Failed to parse file '%s'.\n", filename);
 		buffer_delete(&buffer);
 		return 1;
@@ -807,6 +933,8 @@ static int cbfs_add(void)
 		if (!param.baseaddress_assigned)
 			param.alignment = 4*1024;
 		convert = cbfstool_convert_fsp;
+		/* FSP blobs are never compressed. */
+		param.autocompression = false;
 	} else if (param.stage_xip) {
 		ERROR("cbfs add supports xip only for FSP component type\n");
 		return 1;
@@ -828,26 +956,97 @@ static int cbfs_add(void)
 				  convert);
 }
 
+static bool has_master_header(struct cbfs_image *image)
+{
+	return image->has_header ||
+		cbfs_get_entry(image, "cbfs master header") != NULL;
+}
+
+/* @return The master header of param.image_region, or NULL. */
+static struct cbfs_header *find_master_header(struct cbfs_image *image)
+{
+	struct cbfs_file *master = cbfs_get_entry(image, "cbfs master header");
+
+	if (master != NULL)
+		return (struct cbfs_header *)CBFS_SUBHEADER(master);
+	if (image->has_header)
+		return cbfs_find_header(buffer_get(param.image_region),
+					buffer_size(param.image_region),
+					param.headeroffset);
+	return NULL;
+}
+
+/* Record where the stage 'name' lives in the master header of the region so
+ * the bootblock can load it without walking the CBFS. */
+static int cbfs_record_boot_stage(const char *name)
+{
+	struct cbfs_image image;
+	struct cbfs_file *entry;
+	struct cbfs_header *h;
+	uint32_t offset;
+
+	if (cbfs_image_from_buffer(&image, param.image_region,
+		param.headeroffset))
+		return 1;
+
+	entry = cbfs_get_entry(&image, name);
+	if (entry == NULL) {
+		ERROR("'%s' not in ROM image?!?\n", name);
+		return 1;
+	}
+
+	if (!has_master_header(&image)) {
+		/* Only the CBFS holding the master header is searched by the
+		 * bootblock, there is nothing to record elsewhere. */
+		INFO("No master header in '%s', not recording '%s'.\n",
+		     param.region_name, name);
+		return 0;
+	}
+
+	h = find_master_header(&image);
+	if (h == NULL) {
+		ERROR("Master header not found.\n");
+		return 1;
+	}
+
+	/* Like the offset field this is absolute within the boot media. */
+	offset = (char *)entry -
+		(char *)buffer_get_original_backing(param.image_region);
+	h->stage_offset = htonl(offset);
+
+	INFO("Recorded '%s' @ 0x%x in the master header.\n", name, offset);
+
+	return 0;
+}
+
 static int cbfs_add_stage(void)
 {
+	int ret;
+
 	if (param.stage_xip) {
 		if (param.baseaddress_assigned) {
 			ERROR("Cannot specify base address for XIP.\n");
 			return 1;
 		}
 
-		if (param.compression != CBFS_COMPRESS_NONE) {
+		if (param.compression != CBFS_COMPRESS_NONE ||
+		    param.autocompression) {
 			ERROR("Cannot specify compression for XIP.\n");
 			return 1;
 		}
 	}
 
-	return cbfs_add_component(param.filename,
-				  param.name,
-				  CBFS_COMPONENT_STAGE,
-				  param.baseaddress,
-				  param.headeroffset,
-				  cbfstool_convert_mkstage);
+	ret = cbfs_add_component(param.filename,
+				 param.name,
+				 CBFS_COMPONENT_STAGE,
+				 param.baseaddress,
+				 param.headeroffset,
+				 cbfstool_convert_mkstage);
+
+	if (ret == 0 && param.boot_stage)
+		ret = cbfs_record_boot_stage(param.name);
+
+	return ret;
 }
 
 static int cbfs_add_payload(void)
@@ -1261,6 +1460,125 @@ static int cbfs_copy(void)
 	return cbfs_copy_instance(&src_image, param.image_region);
 }
 
+/* @return The name of the stage recorded in the master header, or NULL. */
+static const char *recorded_boot_stage(struct cbfs_image *image)
+{
+	struct cbfs_header *h = find_master_header(image);
+	char *base = buffer_get_original_backing(param.image_region);
+	char *region = buffer_get(param.image_region);
+	uint32_t offset;
+
+	if (h == NULL || h->stage_offset == 0)
+		return NULL;
+
+	offset = ntohl(h->stage_offset);
+	if (offset < (size_t)(region - base) ||
+	    offset >= (size_t)(region - base) + buffer_size(param.image_region))
+		return NULL;
+
+	struct cbfs_file *entry = (struct cbfs_file *)(base + offset);
+	if (!cbfs_is_valid_entry(image, entry))
+		return NULL;
+	return entry->filename;
+}
+
+struct traced_file {
+	const char *name;
+	uint32_t start;	/* data, absolute within the boot media */
+	uint32_t end;
+	bool seen;
+};
+
+/*
+ * Turns a boot media trace ('cbmem -m': one "offset size" pair per line, '#'
+ * starts a comment) into the list of movable files in the order their data
+ * was first read. Reads that only touch headers, like those of a CBFS walk,
+ * don't count. The names are copies, since the entries are about to move;
+ * the caller frees them and *names.
+ */
+static int order_from_trace(struct cbfs_image *image, const char *filename,
+			    char ***names, size_t *count)
+{
+	const size_t region_start = buffer_get(param.image_region) -
+			buffer_get_original_backing(param.image_region);
+	struct traced_file *files = NULL;
+	size_t num_files = 0, i;
+	struct cbfs_file *entry;
+	char line[128];
+	FILE *fp;
+
+	*names = NULL;
+	*count = 0;
+
+	for (entry = cbfs_find_first_entry(image);
+	     entry && cbfs_is_valid_entry(image, entry);
+	     entry = cbfs_find_next_entry(image, entry)) {
+		uint32_t type = ntohl(entry->type);
+
+		if (type == CBFS_COMPONENT_NULL ||
+		    type == CBFS_COMPONENT_DELETED ||
+		    cbfs_file_is_pinned(entry))
+			continue;
+
+		struct traced_file *grown = realloc(files,
+				(num_files + 1) * sizeof(*files));
+		if (!grown) {
+			free(files);
+			ERROR("Out of memory.\n");
+			return 1;
+		}
+		files = grown;
+		files[num_files].name = entry->filename;
+		files[num_files].start = region_start +
+			cbfs_get_entry_addr(image, entry) + ntohl(entry->offset);
+		files[num_files].end = files[num_files].start +
+							ntohl(entry->len);
+		files[num_files].seen = false;
+		num_files++;
+	}
+
+	fp = fopen(filename, "r");
+	if (!fp) {
+		perror(filename);
+		free(files);
+		return 1;
+	}
+
+	*names = calloc(num_files + 1, sizeof(**names));
+	if (!*names) {
+		ERROR("Out of memory.\n");
+		fclose(fp);
+		free(files);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), fp)) {
+		char *end;
+		unsigned long offset, size;
+
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+		offset = strtoul(line, &end, 0);
+		size = strtoul(end, &end, 0);
+		if (end == line || !size)
+			continue;
+
+		for (i = 0; i < num_files; i++) {
+			if (files[i].seen || offset >= files[i].end ||
+			    offset + size <= files[i].start)
+				continue;
+			files[i].seen = true;
+			(*names)[(*count)++] = strdup(files[i].name);
+		}
+	}
+	fclose(fp);
+	free(files);
+
+	INFO("%zu of %zu movable files were read during the traced boot.\n",
+	     *count, num_files);
+	return 0;
+}
+
 static int cbfs_compact(void)
 {
 	struct cbfs_image image;
@@ -1268,7 +1586,50 @@ static int cbfs_compact(void)
 							param.headeroffset))
 		return 1;
 	WARN("Compacting a CBFS doesn't honor alignment or fixed addresses!\n");
-	return cbfs_compact_instance(&image);
+
+	/* Keep a copy of the recorded boot stage's name: its entry is about
+	 * to move and the master header has to follow it. */
+	const char *stage = recorded_boot_stage(&image);
+	char stage_name[stage ? strlen(stage) + 1 : 1];
+	strcpy(stage_name, stage ? stage : "");
+
+	if (param.filename) {
+		char **names;
+		size_t count;
+		int ret;
+
+		if (param.name) {
+			ERROR("-n and -f can't be used together.\n");
+			return 1;
+		}
+		if (order_from_trace(&image, param.filename, &names, &count))
+			return 1;
+		ret = cbfs_order_instance(&image, (const char *const *)names,
+					  count);
+		for (size_t i = 0; i < count; i++)
+			free(names[i]);
+		free(names);
+		if (ret)
+			return 1;
+	} else if (!param.name) {
+		if (cbfs_compact_instance(&image))
+			return 1;
+	} else {
+		/* -n gives the boot order as a comma separated list. */
+		char list[strlen(param.name) + 1];
+		const char *names[strlen(param.name) / 2 + 1];
+		size_t count = 0;
+
+		strcpy(list, param.name);
+		for (char *name = strtok(list, ","); name;
+		     name = strtok(NULL, ","))
+			names[count++] = name;
+
+		if (cbfs_order_instance(&image, names, count))
+			return 1;
+	}
+
+	return stage ? cbfs_record_boot_stage(stage_name) : 0;
 }
 
 static int cbfs_expand(void)
@@ -1303,16 +1664,17 @@ static int cbfs_truncate(void)
 }
 
 static const struct command commands[] = {
-	{"add", "H:r:f:n:t:c:b:a:p:yvA:j:gh?", cbfs_add, true, true},
-	{"add-flat-binary", "H:r:f:n:l:e:c:b:p:vA:gh?", cbfs_add_flat_binary,
+	{"add", "H:r:f:n:t:c:b:a:p:yvA:j:gW:Z:h?", cbfs_add, true, true},
+	{"add-flat-binary", "H:r:f:n:l:e:c:b:p:vA:gW:Z:h?",
+				cbfs_add_flat_binary,
 				true, true},
-	{"add-payload", "H:r:f:n:c:b:C:I:p:vA:gh?", cbfs_add_payload,
+	{"add-payload", "H:r:f:n:c:b:C:I:p:vA:gW:Z:h?", cbfs_add_payload,
 				true, true},
-	{"add-stage", "a:H:r:f:n:t:c:b:P:S:p:yvA:gh?", cbfs_add_stage,
+	{"add-stage", "a:H:r:f:n:t:c:b:P:S:p:yLvA:gW:Z:h?", cbfs_add_stage,
 				true, true},
 	{"add-int", "H:r:i:n:b:vgh?", cbfs_add_integer, true, true},
 	{"add-master-header", "H:r:vh?j:", cbfs_add_master_header, true, true},
-	{"compact", "r:h?", cbfs_compact, true, true},
+	{"compact", "r:n:f:h?", cbfs_compact, true, true},
 	{"copy", "r:R:h?", cbfs_copy, true, true},
 	{"create", "M:r:s:B:b:H:o:m:vh?", cbfs_create, true, true},
 	{"extract", "H:r:m:n:f:vh?", cbfs_extract, true, false},
@@ -1361,8 +1723,11 @@ static struct option long_options[] = {
 	{"verbose",       no_argument,       0, 'v' },
 	{"with-readonly", no_argument,       0, 'w' },
 	{"xip",           no_argument,       0, 'y' },
+	{"boot-stage",    no_argument,       0, 'L' },
 	{"gen-attribute", no_argument,       0, 'g' },
 	{"mach-parseable",no_argument,       0, 'k' },
+	{"media-speed",   required_argument, 0, 'W' },
+	{"decompress-speed", required_argument, 0, 'Z' },
 	{NULL,            0,                 0,  0  }
 };
 
@@ -1445,7 +1810,8 @@ static void usage(char *name)
 			"Add a payload to the ROM\n"
 	     " add-stage [-r image,regions] -f FILE -n NAME [-A hash] \\\n"
 	     "        [-c compression] [-b base] [-S section-to-ignore] \\\n"
-	     "        [-a alignment] [-y|--xip] [-P page-size]             "
+	     "        [-a alignment] [-y|--xip] [-P page-size] \\\n"
+	     "        [-L|--boot-stage]                                    "
 			"Add a stage to the ROM\n"
 	     " add-flat-binary [-r image,regions] -f FILE -n NAME \\\n"
 	     "        [-A hash] -l load-address -e entry-point \\\n"
@@ -1458,8 +1824,12 @@ static void usage(char *name)
 			"Add a legacy CBFS master header\n"
 	     " remove [-r image,regions] -n NAME                           "
 			"Remove a component\n"
-	     " compact -r image,regions                                    "
+	     " compact -r image,regions [-n name,name,... | -f trace]      "
 			"Defragment CBFS image.\n"
+	     "                                                         "
+	     "    -n: then place these files last, in boot order\n"
+	     "                                                         "
+	     "    -f: the same, in the order of a 'cbmem -m' trace\n"
 	     " copy -r image,regions -R source-region                      "
 			"Create a copy (duplicate) cbfs instance in fmap\n"
 	     " create -m ARCH -s size [-b bootblock offset] \\\n"
@@ -1492,6 +1862,25 @@ static void usage(char *name)
 	     "    ucode-region is a region in the FMAP, its address is \n"
 	     "                                                         "
 	     "    inserted as the first entry in the topswap FIT.  \n"
+	     " batch [SCRIPT]                                              "
+			"Run the commands in SCRIPT (default: stdin)\n"
+	     "                                                         "
+	     "    on one in-memory copy of the image\n"
+	     "\n"
+	     "BATCH SCRIPTs:\n"
+	     "  One COMMAND [PARAMETERS]... per line, without the FILE. Words\n"
+	     "  are separated by whitespace, \"double quotes\" group words and\n"
+	     "  '#' starts a comment. The image is read once and written once\n"
+	     "  after the last command; if any command fails, it is left\n"
+	     "  unmodified. 'create' can't be used in a batch.\n"
+	     "\n"
+	     "COMPRESSION:\n"
+	     "  -c auto tries every algorithm on the file and keeps the one\n"
+	     "  with the lowest estimated read plus decompression time. The\n"
+	     "  estimate is based on -W/--media-speed KiB/s (boot media read\n"
+	     "  rate) and -Z/--decompress-speed ALGO=KiB/s (decompressed\n"
+	     "  bytes per second). Both can be derived from the ULZMA/ULZ4F\n"
+	     "  and load timestamps reported by 'cbmem -t'.\n"
 	     "\n"
 	     "OFFSETs:\n"
 	     "  Numbers accompanying -b, -H, and -o switches* may be provided\n"
@@ -1525,355 +1914,547 @@ static void usage(char *name)
 	     );
 }
 
-int main(int argc, char **argv)
+/*
+ * Parses the PARAMETERS of a single command into param. argv and optind must
+ * be set up for getopt_long() to start at the first parameter.
+ */
+static int parse_options(char *name, const struct command *command,
+						int argc, char **argv)
 {
-	size_t i;
 	int c;
 
-	if (argc < 3) {
-		usage(argv[0]);
-		return 1;
-	}
-
-	char *image_name = argv[1];
-	char *cmd = argv[2];
-	optind += 2;
-
-	for (i = 0; i < ARRAY_SIZE(commands); i++) {
-		if (strcmp(cmd, commands[i].name) != 0)
-			continue;
+	while (1) {
+		char *suffix = NULL;
+		int option_index = 0;
 
-		while (1) {
-			char *suffix = NULL;
-			int option_index = 0;
-
-			c = getopt_long(argc, argv, commands[i].optstring,
-						long_options, &option_index);
-			if (c == -1) {
-				if (optind < argc) {
-					ERROR("%s: excessive argument -- '%s'"
-						"\n", argv[0], argv[optind]);
-					return 1;
-				}
-				break;
+		c = getopt_long(argc, argv, command->optstring,
+					long_options, &option_index);
+		if (c == -1) {
+			if (optind < argc) {
+				ERROR("%s: excessive argument -- '%s'"
+					"\n", name, argv[optind]);
+				return 1;
 			}
+			break;
+		}
 
-			/* filter out illegal long options */
-			if (strchr(commands[i].optstring, c) == NULL) {
-				/* TODO maybe print actual long option instead */
-				ERROR("%s: invalid option -- '%c'\n",
-				      argv[0], c);
-				c = '?';
-			}
+		/* filter out illegal long options */
+		if (strchr(command->optstring, c) == NULL) {
+			/* TODO maybe print actual long option instead */
+			ERROR("%s: invalid option -- '%c'\n",
+			      name, c);
+			c = '?';
+		}
 
-			switch(c) {
-			case 'n':
-				param.name = optarg;
-				break;
-			case 't':
-				if (intfiletype(optarg) != ((uint64_t) - 1))
-					param.type = intfiletype(optarg);
-				else
-					param.type = strtoul(optarg, NULL, 0);
-				if (param.type == 0)
-					WARN("Unknown type '%s' ignored\n",
-							optarg);
-				break;
-			case 'c': {
-				if (strcmp(optarg, "precompression") == 0) {
-					param.precompression = 1;
-					break;
-				}
-				int algo = cbfs_parse_comp_algo(optarg);
-				if (algo >= 0)
-					param.compression = algo;
-				else
-					WARN("Unknown compression '%s' ignored.\n",
-									optarg);
-				break;
-			}
-			case 'A': {
-				int algo = cbfs_parse_hash_algo(optarg);
-				if (algo >= 0)
-					param.hash = algo;
-				else {
-					ERROR("Unknown hash algorithm '%s'.\n",
+		switch(c) {
+		case 'n':
+			param.name = optarg;
+			break;
+		case 't':
+			if (intfiletype(optarg) != ((uint64_t) - 1))
+				param.type = intfiletype(optarg);
+			else
+				param.type = strtoul(optarg, NULL, 0);
+			if (param.type == 0)
+				WARN("Unknown type '%s' ignored\n",
 						optarg);
-					return 1;
-				}
+			break;
+		case 'c': {
+			if (strcmp(optarg, "precompression") == 0) {
+				param.precompression = 1;
 				break;
 			}
-			case 'M':
-				param.fmap = optarg;
-				break;
-			case 'r':
-				param.region_name = optarg;
-				break;
-			case 'R':
-				param.source_region = optarg;
-				break;
-			case 'b':
-				param.baseaddress = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid base address '%s'.\n",
-						optarg);
-					return 1;
-				}
-				// baseaddress may be zero on non-x86, so we
-				// need an explicit "baseaddress_assigned".
-				param.baseaddress_assigned = 1;
+			if (strcmp(optarg, "auto") == 0) {
+				param.autocompression = true;
 				break;
-			case 'l':
-				param.loadaddress = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid load address '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'e':
-				param.entrypoint = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid entry point '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 's':
-				param.size = strtoul(optarg, &suffix, 0);
-				if (!*optarg) {
-					ERROR("Empty size specified.\n");
-					return 1;
-				}
-				switch (tolower((int)suffix[0])) {
-				case 'k':
-					param.size *= 1024;
-					break;
-				case 'm':
-					param.size *= 1024 * 1024;
-					break;
-				case '\0':
-					break;
-				default:
-					ERROR("Invalid suffix for size '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'B':
-				param.bootblock = optarg;
-				break;
-			case 'H':
-				param.headeroffset = strtoul(
-						optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid header offset '%s'.\n",
-						optarg);
-					return 1;
-				}
-				param.headeroffset_assigned = 1;
-				break;
-			case 'a':
-				param.alignment = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid alignment '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'p':
-				param.padding = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid pad size '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'P':
-				param.pagesize = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid page size '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'o':
-				param.cbfsoffset = strtoul(optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid cbfs offset '%s'.\n",
-						optarg);
-					return 1;
-				}
-				param.cbfsoffset_assigned = 1;
-				break;
-			case 'f':
-				param.filename = optarg;
-				break;
-			case 'F':
-				param.force = 1;
-				break;
-			case 'i':
-				param.u64val = strtoull(optarg, &suffix, 0);
-				param.u64val_assigned = 1;
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid int parameter '%s'.\n",
-						optarg);
-					return 1;
-				}
-				break;
-			case 'u':
-				param.fill_partial_upward = true;
-				break;
-			case 'd':
-				param.fill_partial_downward = true;
-				break;
-			case 'w':
-				param.show_immutable = true;
-				break;
-			case 'x':
-				param.fit_empty_entries = strtol(
-						optarg, &suffix, 0);
-				if (!*optarg || (suffix && *suffix)) {
-					ERROR("Invalid number of fit entries "
-						"'%s'.\n", optarg);
-					return 1;
-				}
-				break;
-			case 'j':
-				param.topswap_size = strtol(optarg, NULL, 0);
-				if (!is_valid_topswap())
-					return 1;
-				break;
-			case 'q':
-				param.ucode_region = optarg;
-				break;
-			case 'v':
-				verbose++;
+			}
+			int algo = cbfs_parse_comp_algo(optarg);
+			if (algo >= 0)
+				param.compression = algo;
+			else
+				WARN("Unknown compression '%s' ignored.\n",
+								optarg);
+			break;
+		}
+		case 'A': {
+			int algo = cbfs_parse_hash_algo(optarg);
+			if (algo >= 0)
+				param.hash = algo;
+			else {
+				ERROR("Unknown hash algorithm '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		}
+		case 'M':
+			param.fmap = optarg;
+			break;
+		case 'r':
+			param.region_name = optarg;
+			break;
+		case 'R':
+			param.source_region = optarg;
+			break;
+		case 'b':
+			param.baseaddress = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid base address '%s'.\n",
+					optarg);
+				return 1;
+			}
+			// baseaddress may be zero on non-x86, so we
+			// need an explicit "baseaddress_assigned".
+			param.baseaddress_assigned = 1;
+			break;
+		case 'l':
+			param.loadaddress = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid load address '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'e':
+			param.entrypoint = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid entry point '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 's':
+			param.size = strtoul(optarg, &suffix, 0);
+			if (!*optarg) {
+				ERROR("Empty size specified.\n");
+				return 1;
+			}
+			switch (tolower((int)suffix[0])) {
+			case 'k':
+				param.size *= 1024;
 				break;
 			case 'm':
-				param.arch = string_to_arch(optarg);
-				break;
-			case 'I':
-				param.initrd = optarg;
-				break;
-			case 'C':
-				param.cmdline = optarg;
+				param.size *= 1024 * 1024;
 				break;
-			case 'S':
-				param.ignore_section = optarg;
+			case '\0':
 				break;
-			case 'y':
-				param.stage_xip = true;
-				break;
-			case 'g':
-				param.autogen_attr = true;
-				break;
-			case 'k':
-				param.machine_parseable = true;
-				break;
-			case 'h':
-			case '?':
-				usage(argv[0]);
-				return 1;
 			default:
-				break;
+				ERROR("Invalid suffix for size '%s'.\n",
+					optarg);
+				return 1;
 			}
-		}
-
-		if (commands[i].function == cbfs_create) {
-			if (param.fmap) {
-				struct buffer flashmap;
-				if (buffer_from_file(&flashmap, param.fmap))
-					return 1;
-				param.image_file = partitioned_file_create(
-							image_name, &flashmap);
-				buffer_delete(&flashmap);
-			} else if (param.size) {
-				param.image_file = partitioned_file_create_flat(
-							image_name, param.size);
-			} else {
-				ERROR("You need to specify a valid -M/--flashmap or -s/--size.\n");
+			break;
+		case 'B':
+			param.bootblock = optarg;
+			break;
+		case 'H':
+			param.headeroffset = strtoul(
+					optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid header offset '%s'.\n",
+					optarg);
 				return 1;
 			}
-		} else {
-			bool write_access = commands[i].modifies_region;
+			param.headeroffset_assigned = 1;
+			break;
+		case 'a':
+			param.alignment = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid alignment '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'p':
+			param.padding = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid pad size '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'P':
+			param.pagesize = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid page size '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'o':
+			param.cbfsoffset = strtoul(optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid cbfs offset '%s'.\n",
+					optarg);
+				return 1;
+			}
+			param.cbfsoffset_assigned = 1;
+			break;
+		case 'f':
+			param.filename = optarg;
+			break;
+		case 'F':
+			param.force = 1;
+			break;
+		case 'i':
+			param.u64val = strtoull(optarg, &suffix, 0);
+			param.u64val_assigned = 1;
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid int parameter '%s'.\n",
+					optarg);
+				return 1;
+			}
+			break;
+		case 'u':
+			param.fill_partial_upward = true;
+			break;
+		case 'd':
+			param.fill_partial_downward = true;
+			break;
+		case 'w':
+			param.show_immutable = true;
+			break;
+		case 'x':
+			param.fit_empty_entries = strtol(
+					optarg, &suffix, 0);
+			if (!*optarg || (suffix && *suffix)) {
+				ERROR("Invalid number of fit entries "
+					"'%s'.\n", optarg);
+				return 1;
+			}
+			break;
+		case 'j':
+			param.topswap_size = strtol(optarg, NULL, 0);
+			if (!is_valid_topswap())
+				return 1;
+			break;
+		case 'q':
+			param.ucode_region = optarg;
+			break;
+		case 'v':
+			verbose++;
+			break;
+		case 'm':
+			param.arch = string_to_arch(optarg);
+			break;
+		case 'I':
+			param.initrd = optarg;
+			break;
+		case 'C':
+			param.cmdline = optarg;
+			break;
+		case 'S':
+			param.ignore_section = optarg;
+			break;
+		case 'y':
+			param.stage_xip = true;
+			break;
+		case 'L':
+			param.boot_stage = true;
+			break;
+		case 'g':
+			param.autogen_attr = true;
+			break;
+		case 'k':
+			param.machine_parseable = true;
+			break;
+		case 'W':
+			param.media_speed = strtoul(optarg, &suffix, 0);
+			if (!param.media_speed || *suffix) {
+				ERROR("Invalid media speed '%s'.\n",
+				      optarg);
+				return 1;
+			}
+			break;
+		case 'Z': {
+			char *speed = strchr(optarg, '=');
+			int algo;
+
+			if (speed)
+				*speed++ = '\0';
+			algo = cbfs_parse_comp_algo(optarg);
+			if (!speed || algo <= CBFS_COMPRESS_NONE) {
+				ERROR("Invalid decompression speed, "
+				      "expected ALGO=KiB/s.\n");
+				return 1;
+			}
+			param.decompress_speed[algo] =
+				strtoul(speed, &suffix, 0);
+			if (!param.decompress_speed[algo] || *suffix) {
+				ERROR("Invalid decompression speed "
+				      "'%s'.\n", speed);
+				return 1;
+			}
+			break;
+		}
+		case 'h':
+		case '?':
+			usage(name);
+			return 1;
+		default:
+			break;
+		}
+	}
+
+	return 0;
+}
 
-			param.image_file =
-				partitioned_file_reopen(image_name,
-							write_access);
+/*
+ * Runs a command against every region in the -r list of the already opened
+ * param.image_file. Modified regions are written back to the backing file
+ * only if write_back is set; otherwise the changes stay in the in-memory copy
+ * of the image until the caller writes it out.
+ */
+static int run_command(const struct command *command, bool write_back)
+{
+	unsigned num_regions = 1;
+	for (const char *list = strchr(param.region_name, ','); list;
+					list = strchr(list + 1, ','))
+		++num_regions;
+
+	// If the action needs to read an image region, as indicated by
+	// having accesses_region set in its command struct, that
+	// region's buffer struct will be stored here and the client
+	// will receive a pointer to it via param.image_region. It
+	// need not write the buffer back to the image file itself,
+	// since this behavior can be requested via its modifies_region
+	// field. Additionally, it should never free the region buffer,
+	// as that is performed automatically once it completes.
+	struct buffer image_regions[num_regions];
+	memset(image_regions, 0, sizeof(image_regions));
+
+	bool seen_primary_cbfs = false;
+	char region_name_scratch[strlen(param.region_name) + 1];
+	strcpy(region_name_scratch, param.region_name);
+	param.region_name = strtok(region_name_scratch, ",");
+	for (unsigned region = 0; region < num_regions; ++region) {
+		if (!param.region_name) {
+			ERROR("Encountered illegal degenerate region name in -r list\n");
+			ERROR("The image will be left unmodified.\n");
+			return 1;
 		}
-		if (!param.image_file)
+
+		if (strcmp(param.region_name, SECTION_NAME_PRIMARY_CBFS) == 0)
+			seen_primary_cbfs = true;
+
+		param.image_region = image_regions + region;
+		if (dispatch_command(*command))
 			return 1;
 
-		unsigned num_regions = 1;
-		for (const char *list = strchr(param.region_name, ','); list;
-						list = strchr(list + 1, ','))
-			++num_regions;
-
-		// If the action needs to read an image region, as indicated by
-		// having accesses_region set in its command struct, that
-		// region's buffer struct will be stored here and the client
-		// will receive a pointer to it via param.image_region. It
-		// need not write the buffer back to the image file itself,
-		// since this behavior can be requested via its modifies_region
-		// field. Additionally, it should never free the region buffer,
-		// as that is performed automatically once it completes.
-		struct buffer image_regions[num_regions];
-		memset(image_regions, 0, sizeof(image_regions));
-
-		bool seen_primary_cbfs = false;
-		char region_name_scratch[strlen(param.region_name) + 1];
-		strcpy(region_name_scratch, param.region_name);
-		param.region_name = strtok(region_name_scratch, ",");
+		param.region_name = strtok(NULL, ",");
+	}
+
+	if (command->function == cbfs_create && !seen_primary_cbfs) {
+		ERROR("The creation -r list must include the mandatory '%s' section.\n",
+					SECTION_NAME_PRIMARY_CBFS);
+		ERROR("The image will be left unmodified.\n");
+		return 1;
+	}
+
+	if (command->modifies_region && write_back) {
+		assert(param.image_file);
 		for (unsigned region = 0; region < num_regions; ++region) {
-			if (!param.region_name) {
-				ERROR("Encountered illegal degenerate region name in -r list\n");
-				ERROR("The image will be left unmodified.\n");
-				partitioned_file_close(param.image_file);
+			if (!partitioned_file_write_region(param.image_file,
+						image_regions + region))
 				return 1;
-			}
+		}
+	}
 
-			if (strcmp(param.region_name, SECTION_NAME_PRIMARY_CBFS)
-									== 0)
-				seen_primary_cbfs = true;
+	return 0;
+}
 
-			param.image_region = image_regions + region;
-			if (dispatch_command(commands[i])) {
-				partitioned_file_close(param.image_file);
-				return 1;
-			}
+static const struct command *find_command(const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(commands); i++) {
+		if (strcmp(name, commands[i].name) == 0)
+			return &commands[i];
+	}
+	return NULL;
+}
+
+/*
+ * Splits a batch script line into whitespace separated words in place.
+ * Double quotes group words containing whitespace (e.g. a -C cmdline) and
+ * a '#' outside of quotes starts a comment.
+ *
+ * @return Number of words, or -1 if there are too many or a quote is open
+ */
+static int split_batch_line(char *line, char **words, int max_words)
+{
+	int count = 0;
+	char *in = line;
+
+	while (1) {
+		while (isspace((unsigned char)*in))
+			in++;
+		if (!*in || *in == '#')
+			return count;
+		if (count == max_words)
+			return -1;
 
-			param.region_name = strtok(NULL, ",");
+		char *out = in;
+		bool quoted = false;
+		words[count++] = out;
+		while (*in && (quoted || !isspace((unsigned char)*in))) {
+			if (*in == '"')
+				quoted = !quoted;
+			else
+				*out++ = *in;
+			in++;
 		}
+		if (quoted)
+			return -1;
+		if (*in)
+			in++;
+		*out = '\0';
+	}
+}
 
-		if (commands[i].function == cbfs_create && !seen_primary_cbfs) {
-			ERROR("The creation -r list must include the mandatory '%s' section.\n",
-						SECTION_NAME_PRIMARY_CBFS);
-			ERROR("The image will be left unmodified.\n");
-			partitioned_file_close(param.image_file);
+#define BATCH_MAX_LINE	4096
+#define BATCH_MAX_WORDS	64
+
+/*
+ * Applies every command in a script to one in-memory copy of the image and
+ * writes the result out once at the end, instead of reading and rewriting
+ * the whole file for each command. Nothing is written unless all commands
+ * succeed.
+ */
+static int cbfs_batch(char *name, const char *image_name, const char *script)
+{
+	const struct param defaults = param;
+	const int default_verbose = verbose;
+	char line[BATCH_MAX_LINE];
+	char *words[BATCH_MAX_WORDS + 1];
+	unsigned lineno = 0;
+	bool modified = false;
+	FILE *in = stdin;
+	int ret = 1;
+
+	if (script && strcmp(script, "-") != 0) {
+		in = fopen(script, "r");
+		if (!in) {
+			ERROR("Could not open batch script '%s'.\n", script);
 			return 1;
 		}
+	} else {
+		script = "<stdin>";
+	}
 
-		if (commands[i].modifies_region) {
-			assert(param.image_file);
-			for (unsigned region = 0; region < num_regions;
-								++region) {
-
-				if (!partitioned_file_write_region(
-							param.image_file,
-						image_regions + region)) {
-					partitioned_file_close(
-							param.image_file);
-					return 1;
-				}
-			}
+	partitioned_file_t *image_file = partitioned_file_reopen(image_name,
+									true);
+	if (!image_file)
+		goto out;
+
+	while (fgets(line, sizeof(line), in)) {
+		lineno++;
+		if (!strchr(line, '\n') && !feof(in)) {
+			ERROR("%s:%u: line too long.\n", script, lineno);
+			goto out;
 		}
 
-		partitioned_file_close(param.image_file);
-		return 0;
+		int count = split_batch_line(line, words, BATCH_MAX_WORDS);
+		if (count < 0) {
+			ERROR("%s:%u: unterminated quote or too many "
+			      "arguments.\n", script, lineno);
+			goto out;
+		}
+		if (count == 0)
+			continue;
+		words[count] = NULL;
+
+		const struct command *command = find_command(words[0]);
+		if (!command || command->function == cbfs_create) {
+			ERROR("%s:%u: command '%s' can't be used in a batch.\n",
+			      script, lineno, words[0]);
+			goto out;
+		}
+
+		param = defaults;
+		param.image_file = image_file;
+		verbose = default_verbose;
+		/* Zero makes getopt_long() forget the state of the last line
+		   and start over at words[1]. */
+		optind = 0;
+		if (parse_options(name, command, count, words) ||
+		    run_command(command, false)) {
+			ERROR("%s:%u: '%s' failed.\n", script, lineno,
+			      words[0]);
+			goto out;
+		}
+		modified |= command->modifies_region;
+	}
+	if (ferror(in)) {
+		ERROR("Failed to read batch script '%s'.\n", script);
+		goto out;
 	}
 
-	ERROR("Unknown command '%s'.\n", cmd);
-	usage(argv[0]);
-	return 1;
+	if (modified && !partitioned_file_write_all(image_file))
+		goto out;
+	ret = 0;
+
+out:
+	partitioned_file_close(image_file);
+	param.image_file = NULL;
+	if (in != stdin)
+		fclose(in);
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	char *image_name = argv[1];
+	char *cmd = argv[2];
+	optind += 2;
+
+	if (strcmp(cmd, "batch") == 0) {
+		if (argc > 4) {
+			usage(argv[0]);
+			return 1;
+		}
+		return cbfs_batch(argv[0], image_name,
+				  argc == 4 ? argv[3] : NULL);
+	}
+
+	const struct command *command = find_command(cmd);
+	if (!command) {
+		ERROR("Unknown command '%s'.\n", cmd);
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (parse_options(argv[0], command, argc, argv))
+		return 1;
+
+	if (command->function == cbfs_create) {
+		if (param.fmap) {
+			struct buffer flashmap;
+			if (buffer_from_file(&flashmap, param.fmap))
+				return 1;
+			param.image_file = partitioned_file_create(
+						image_name, &flashmap);
+			buffer_delete(&flashmap);
+		} else if (param.size) {
+			param.image_file = partitioned_file_create_flat(
+						image_name, param.size);
+		} else {
+			ERROR("You need to specify a valid -M/--flashmap or -s/--size.\n");
+			return 1;
+		}
+	} else {
+		bool write_access = command->modifies_region;
+
+		param.image_file =
+			partitioned_file_reopen(image_name, write_access);
+	}
+	if (!param.image_file)
+		return 1;
+
+	int ret = run_command(command, true);
+	partitioned_file_close(param.image_file);
+	return ret;
 }
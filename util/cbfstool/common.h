@@ -181,6 +181,20 @@ static const struct typedesc_t types_cbfs_compression[] = {
 comp_func_ptr compression_function(enum comp_algo algo);
 decomp_func_ptr decompression_function(enum comp_algo algo);
 
+struct compress_job {
+	char *in;
+	int in_len;
+	char *out;	/* at least in_len bytes */
+	int out_len;
+	int result;	/* return value of the compression function */
+};
+
+/* Run the compression function on each job, spread over as many threads as
+ * there are CPUs. Every job is compressed on its own, so the results don't
+ * depend on the number of threads or the order in which jobs complete. */
+int compress_parallel(comp_func_ptr compress, struct compress_job *jobs,
+		      size_t count);
+
 uint64_t intfiletype(const char *name);
 
 /* cbfs-mkpayload.c */
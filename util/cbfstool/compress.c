@@ -21,6 +21,10 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef __MINGW32__
+#include <unistd.h>
+#include <pthread.h>
+#endif
 #include "common.h"
 #include "lz4/lib/lz4frame.h"
 #include <commonlib/compression.h>
@@ -122,3 +126,81 @@ decomp_func_ptr decompression_function(enum comp_algo algo)
 	}
 	return decompress;
 }
+
+/* Upper bound on compression threads, each of which may need several times
+ * the input size for the LZMA match finder. */
+#define MAX_COMPRESS_THREADS 16
+
+struct compress_pool {
+	comp_func_ptr compress;
+	struct compress_job *jobs;
+	size_t count;
+	size_t next;
+#ifndef __MINGW32__
+	pthread_mutex_t lock;
+#endif
+};
+
+static struct compress_job *compress_pool_next(struct compress_pool *pool)
+{
+	struct compress_job *job = NULL;
+
+#ifndef __MINGW32__
+	pthread_mutex_lock(&pool->lock);
+#endif
+	if (pool->next < pool->count)
+		job = &pool->jobs[pool->next++];
+#ifndef __MINGW32__
+	pthread_mutex_unlock(&pool->lock);
+#endif
+	return job;
+}
+
+static void *compress_worker(void *arg)
+{
+	struct compress_pool *pool = arg;
+	struct compress_job *job;
+
+	while ((job = compress_pool_next(pool)) != NULL)
+		job->result = pool->compress(job->in, job->in_len, job->out,
+					     &job->out_len);
+	return NULL;
+}
+
+int compress_parallel(comp_func_ptr compress, struct compress_job *jobs,
+		      size_t count)
+{
+	struct compress_pool pool = {
+		.compress = compress,
+		.jobs = jobs,
+		.count = count,
+		.next = 0,
+	};
+
+#ifndef __MINGW32__
+	pthread_t threads[MAX_COMPRESS_THREADS - 1];
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t nthreads = MIN(count, MAX_COMPRESS_THREADS);
+	size_t i;
+
+	if (online > 0)
+		nthreads = MIN(nthreads, (size_t)online);
+
+	if (pthread_mutex_init(&pool.lock, NULL))
+		return -1;
+
+	/* The calling thread takes jobs from the pool as well. */
+	for (i = 0; i + 1 < nthreads; i++) {
+		if (pthread_create(&threads[i], NULL, compress_worker, &pool))
+			break;
+	}
+	compress_worker(&pool);
+
+	while (i--)
+		pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&pool.lock);
+#else
+	compress_worker(&pool);
+#endif
+	return 0;
+}
@@ -20,11 +20,18 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(__WIN32) && !defined(__WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define HAVE_MMAP 1
+#endif
 
 struct partitioned_file {
 	struct fmap *fmap;
 	struct buffer buffer;
 	FILE *stream;
+	/* buffer.data is a private mapping of stream rather than malloc()ed */
+	bool mapped;
 };
 
 static bool fill_ones_through(struct partitioned_file *file)
@@ -32,7 +39,7 @@ static bool fill_ones_through(struct partitioned_file *file)
 	assert(file);
 
 	memset(file->buffer.data, 0xff, file->buffer.size);
-	return partitioned_file_write_region(file, &file->buffer);
+	return partitioned_file_write_all(file);
 }
 
 static unsigned count_selected_fmap_entries(const struct fmap *fmap,
@@ -49,6 +56,34 @@ static unsigned count_selected_fmap_entries(const struct fmap *fmap,
 	return count;
 }
 
+static bool map_flat_file(struct partitioned_file *file, const char *filename)
+{
+#ifdef HAVE_MMAP
+	struct stat st;
+	void *data;
+
+	if (fstat(fileno(file->stream), &st) || !S_ISREG(st.st_mode) ||
+							st.st_size <= 0)
+		return false;
+
+	data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+						fileno(file->stream), 0);
+	if (data == MAP_FAILED)
+		return false;
+
+	file->buffer.name = strdup(filename);
+	file->buffer.data = data;
+	file->buffer.offset = 0;
+	file->buffer.size = st.st_size;
+	file->mapped = true;
+	return true;
+#else
+	(void)file;
+	(void)filename;
+	return false;
+#endif
+}
+
 static partitioned_file_t *reopen_flat_file(const char *filename,
 					    bool write_access)
 {
@@ -61,16 +96,25 @@ static partitioned_file_t *reopen_flat_file(const char *filename,
 		return NULL;
 	}
 
-	if (buffer_from_file(&file->buffer, filename)) {
-		free(file);
-		return NULL;
-	}
-
 	access_mode = write_access ?  "rb+" : "rb";
 	file->stream = fopen(filename, access_mode);
 
 	if (!file->stream) {
 		perror(filename);
+		free(file);
+		return NULL;
+	}
+
+	/*
+	 * Read-only users (print, extract, ...) get a copy-on-write mapping
+	 * so that the image is neither read in full nor copied. Writers keep
+	 * working on a heap copy, which only reaches the file once the
+	 * command has succeeded.
+	 */
+	if (!write_access && map_flat_file(file, filename))
+		return file;
+
+	if (buffer_from_file(&file->buffer, filename)) {
 		partitioned_file_close(file);
 		return NULL;
 	}
@@ -238,6 +282,13 @@ bool partitioned_file_write_region(partitioned_file_t *file,
 	return true;
 }
 
+bool partitioned_file_write_all(partitioned_file_t *file)
+{
+	assert(file);
+
+	return partitioned_file_write_region(file, &file->buffer);
+}
+
 bool partitioned_file_read_region(struct buffer *dest,
 			const partitioned_file_t *file, const char *region)
 {
@@ -276,6 +327,12 @@ void partitioned_file_close(partitioned_file_t *file)
 		return;
 
 	file->fmap = NULL;
+#ifdef HAVE_MMAP
+	if (file->mapped) {
+		munmap(file->buffer.data, file->buffer.size);
+		file->buffer.data = NULL;
+	}
+#endif
 	buffer_delete(&file->buffer);
 	if (file->stream) {
 		fclose(file->stream);
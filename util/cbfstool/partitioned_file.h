@@ -91,6 +91,18 @@ partitioned_file_t *partitioned_file_reopen(const char *filename,
 bool partitioned_file_write_region(partitioned_file_t *file,
 						const struct buffer *buffer);
 
+/**
+ * Write the entire in-memory image back to the backing file.
+ * This makes every change made through buffers obtained from
+ * partitioned_file_read_region() persistent with a single write, which is
+ * cheaper than writing back each region separately when many changes are
+ * applied to the same file.
+ *
+ * @param file Partitioned file to write out
+ * @return     Whether the operation was successful
+ */
+bool partitioned_file_write_all(partitioned_file_t *file);
+
 /**
  * Obtain one particular region of a segmented file.
  * The result is owned by the partitioned_file_t and shared among every caller
@@ -424,6 +424,46 @@ add_section(struct elf_writer *ew, struct buffer *data, const char *name,
 	return ret;
 }
 
+static void put_varint(const struct rmod_context *ctx, struct buffer *b,
+			uint64_t val)
+{
+	do {
+		uint8_t byte = val & ((1 << RMODULE_VARINT_BITS) - 1);
+
+		val >>= RMODULE_VARINT_BITS;
+		if (val)
+			byte |= RMODULE_VARINT_MORE;
+		ctx->xdr->put8(b, byte);
+	} while (val);
+}
+
+/* Emit the sorted relocations in the RMODULE_VERSION_2 format, folding
+ * tables of pointers into runs. */
+static void write_packed_relocs(const struct rmod_context *ctx,
+				struct buffer *b, int bit64)
+{
+	const size_t ptr_size = bit64 ? sizeof(Elf64_Addr) : sizeof(Elf32_Addr);
+	Elf64_Addr prev = ctx->phdr->p_vaddr;
+	size_t i = 0;
+
+	while (i < ctx->nrelocs) {
+		Elf64_Addr reloc = ctx->emitted_relocs[i];
+		size_t run = 0;
+
+		while (i + run + 1 < ctx->nrelocs &&
+		       ctx->emitted_relocs[i + run + 1] ==
+		       ctx->emitted_relocs[i + run] + ptr_size)
+			run++;
+
+		put_varint(ctx, b, (reloc - prev) << 1 | !!run);
+		if (run)
+			put_varint(ctx, b, run);
+
+		prev = ctx->emitted_relocs[i + run];
+		i += run + 1;
+	}
+}
+
 static int
 write_elf(const struct rmod_context *ctx, const struct buffer *in,
           struct buffer *out)
@@ -454,12 +494,13 @@ write_elf(const struct rmod_context *ctx, const struct buffer *in,
 	 * +------------------+
 	 */
 
-	/* Create buffer for header and relocations. */
+	/* Create buffer for header and relocations. A packed relocation takes
+	 * at most one varint byte per 7 bits of the address. */
 	rmod_data_size = sizeof(struct rmodule_header);
 	if (bit64)
-		rmod_data_size += ctx->nrelocs * sizeof(Elf64_Addr);
+		rmod_data_size += ctx->nrelocs * 10;
 	else
-		rmod_data_size += ctx->nrelocs * sizeof(Elf32_Addr);
+		rmod_data_size += ctx->nrelocs * 5;
 
 	if (buffer_create(&rmod_data, rmod_data_size, "rmod"))
 		return -1;
@@ -486,9 +527,12 @@ write_elf(const struct rmod_context *ctx, const struct buffer *in,
 		return -1;
 	}
 
+	/* Write the relocations. */
+	write_packed_relocs(ctx, &relocs, bit64);
+
 	/* Write out rmodule_header. */
 	ctx->xdr->put16(&rmod_header, RMODULE_MAGIC);
-	ctx->xdr->put8(&rmod_header, RMODULE_VERSION_1);
+	ctx->xdr->put8(&rmod_header, RMODULE_VERSION_2);
 	ctx->xdr->put8(&rmod_header, 0);
 	/* payload_begin_offset */
 	loc = sizeof(struct rmodule_header);
@@ -499,10 +543,7 @@ write_elf(const struct rmod_context *ctx, const struct buffer *in,
 	/* relocations_begin_offset */
 	ctx->xdr->put32(&rmod_header, loc);
 	/* relocations_end_offset */
-	if (bit64)
-		loc += ctx->nrelocs * sizeof(Elf64_Addr);
-	else
-		loc += ctx->nrelocs * sizeof(Elf32_Addr);
+	loc += buffer_size(&relocs);
 	ctx->xdr->put32(&rmod_header, loc);
 	/* module_link_start_address */
 	ctx->xdr->put32(&rmod_header, ctx->phdr->p_vaddr);
@@ -524,14 +565,6 @@ write_elf(const struct rmod_context *ctx, const struct buffer *in,
 	ctx->xdr->put32(&rmod_header, 0);
 	ctx->xdr->put32(&rmod_header, 0);
 
-	/* Write the relocations. */
-	for (unsigned i = 0; i < ctx->nrelocs; i++) {
-		if (bit64)
-			ctx->xdr->put64(&relocs, ctx->emitted_relocs[i]);
-		else
-			ctx->xdr->put32(&relocs, ctx->emitted_relocs[i]);
-	}
-
 	total_size = 0;
 	addr = 0;
 
@@ -674,6 +707,67 @@ out:
 	return ret;
 }
 
+static uint64_t get_varint(struct xdr *xdr, struct buffer *b)
+{
+	uint64_t val = 0;
+	unsigned int shift = 0;
+	uint8_t byte;
+
+	do {
+		byte = xdr->get8(b);
+		val |= (uint64_t)(byte & ~RMODULE_VARINT_MORE) << shift;
+		shift += RMODULE_VARINT_BITS;
+	} while ((byte & RMODULE_VARINT_MORE) && buffer_size(b));
+
+	return val;
+}
+
+static int add_stage_rel(struct elf_writer *ew, const char *section_name,
+			 const struct rmodule_header *rmod, Elf64_Addr addr)
+{
+	/* Skip any relocations that are below the link address. */
+	if (addr < rmod->module_link_start_address)
+		return 0;
+
+	if (elf_writer_add_rel(ew, section_name, addr)) {
+		ERROR("Relocation addition failure.\n");
+		elf_writer_destroy(ew);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int add_packed_stage_rels(struct elf_writer *ew,
+				 const char *section_name,
+				 const struct rmodule_header *rmod,
+				 struct buffer *reader, struct xdr *xdr,
+				 int bit64)
+{
+	const size_t ptr_size = bit64 ? sizeof(Elf64_Addr) : sizeof(Elf32_Addr);
+	Elf64_Addr addr = rmod->module_link_start_address;
+
+	while (buffer_size(reader)) {
+		uint64_t record = get_varint(xdr, reader);
+		uint64_t run = 0;
+
+		if ((record & 1) && buffer_size(reader))
+			run = get_varint(xdr, reader);
+
+		addr += record >> 1;
+		if (add_stage_rel(ew, section_name, rmod, addr))
+			return -1;
+
+		while (run--) {
+			addr += ptr_size;
+			if (add_stage_rel(ew, section_name, rmod, addr))
+				return -1;
+		}
+	}
+
+	return 0;
+}
+
 static void rmod_deserialize(struct rmodule_header *rmod, struct buffer *buff,
 				struct xdr *xdr)
 {
@@ -720,7 +814,8 @@ int rmodule_stage_to_elf(Elf64_Ehdr *ehdr, struct buffer *buff)
 	/* Indicate that file is not an rmodule if initial checks fail. */
 	if (rmod.magic != RMODULE_MAGIC)
 		return 1;
-	if (rmod.version != RMODULE_VERSION_1)
+	if (rmod.version != RMODULE_VERSION_1 &&
+	    rmod.version != RMODULE_VERSION_2)
 		return 1;
 
 	if (rmod.payload_begin_offset > input_sz ||
@@ -807,7 +902,11 @@ int rmodule_stage_to_elf(Elf64_Ehdr *ehdr, struct buffer *buff)
 	ssize_t relocs_sz = rmod.relocations_end_offset;
 	relocs_sz -= rmod.relocations_begin_offset;
 	buffer_splice(&reader, buff, rmod.relocations_begin_offset, relocs_sz);
-	while (relocs_sz > 0) {
+	if (rmod.version == RMODULE_VERSION_2 &&
+	    add_packed_stage_rels(ew, section_name, &rmod, &reader, xdr, bit64))
+		return -1;
+
+	while (rmod.version == RMODULE_VERSION_1 && relocs_sz > 0) {
 		Elf64_Addr addr;
 
 		if (bit64) {
@@ -818,15 +917,8 @@ int rmodule_stage_to_elf(Elf64_Ehdr *ehdr, struct buffer *buff)
 			addr = xdr->get32(&reader);
 		}
 
-		/* Skip any relocations that are below the link address. */
-		if (addr < rmod.module_link_start_address)
-			continue;
-
-		if (elf_writer_add_rel(ew, section_name, addr)) {
-			ERROR("Relocation addition failure.\n");
-			elf_writer_destroy(ew);
+		if (add_stage_rel(ew, section_name, &rmod, addr))
 			return -1;
-		}
 	}
 
 	if (elf_writer_serialize(ew, &elf_out)) {
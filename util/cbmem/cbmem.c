@@ -32,9 +32,16 @@
 #include <libgen.h>
 #include <assert.h>
 #include <regex.h>
+#include <elf.h>
 #include <commonlib/cbmem_id.h>
 #include <commonlib/timestamp_serialized.h>
 #include <commonlib/tcpa_log_serialized.h>
+#include <commonlib/bs_times_serialized.h>
+#include <commonlib/mem_usage_serialized.h>
+#include <commonlib/boot_media_trace_serialized.h>
+#include <commonlib/cbmem_arena_serialized.h>
+#include <commonlib/console_binlog_serialized.h>
+#include <commonlib/coverage_serialized.h>
 #include <commonlib/coreboot_tables.h>
 
 #ifdef __OpenBSD__
@@ -70,6 +77,13 @@ static int verbose = 0;
 static int mem_fd;
 static struct mapping lbtable_mapping;
 
+/*
+ * The whole CBMEM area, mapped once after the coreboot table was parsed.
+ * Requests that fall inside it are served from this mapping instead of
+ * mapping /dev/mem again for every entry.
+ */
+static struct mapping cbmem_area;
+
 static void die(const char *msg)
 {
 	if (msg)
@@ -110,6 +124,18 @@ static const void *map_memory(struct mapping *mapping, unsigned long long phys,
 	void *v;
 	unsigned long long page_size;
 
+	/* Windows into the CBMEM area have a virt_size of 0: nothing to unmap. */
+	if (mapping_virt(&cbmem_area) && phys >= cbmem_area.phys &&
+	    phys - cbmem_area.phys <= cbmem_area.size &&
+	    sz <= cbmem_area.size - (phys - cbmem_area.phys)) {
+		mapping->virt = cbmem_area.virt;
+		mapping->offset = cbmem_area.offset + (phys - cbmem_area.phys);
+		mapping->virt_size = 0;
+		mapping->size = sz;
+		mapping->phys = phys;
+		return mapping_virt(mapping);
+	}
+
 	page_size = system_page_size();
 
 	mapping->virt = NULL;
@@ -151,7 +177,8 @@ static int unmap_memory(struct mapping *mapping)
 	if (mapping->virt == NULL)
 		return -1;
 
-	munmap(mapping->virt, mapping->virt_size);
+	if (mapping->virt_size)
+		munmap(mapping->virt, mapping->virt_size);
 	mapping->virt = NULL;
 	mapping->offset = 0;
 	mapping->virt_size = 0;
@@ -505,11 +532,16 @@ static unsigned long arch_tick_frequency(void)
 #endif
 
 static unsigned long tick_freq_mhz;
+/* Set with -F, for memory dumps of machines other than this one. */
+static unsigned long forced_tick_freq_mhz;
 
 static void timestamp_set_tick_freq(unsigned long table_tick_freq_mhz)
 {
 	tick_freq_mhz = table_tick_freq_mhz;
 
+	if (forced_tick_freq_mhz)
+		tick_freq_mhz = forced_tick_freq_mhz;
+
 	/* Honor table frequency if present. */
 	if (!tick_freq_mhz)
 		tick_freq_mhz = arch_tick_frequency();
@@ -544,13 +576,32 @@ static void print_norm(u64 v)
 
 static const char *timestamp_name(uint32_t id)
 {
+	static char name[96];
+	const char *base = "<unknown>";
+	uint32_t num = id & ~TIMESTAMP_SPAN_MASK;
 	int i;
 
-	for (i = 0; i < ARRAY_SIZE(timestamp_ids); i++) {
-		if (timestamp_ids[i].id == id)
-			return timestamp_ids[i].name;
+	if (num & TIMESTAMP_CUSTOM) {
+		snprintf(name, sizeof(name), "custom %u",
+			 num & ~TIMESTAMP_CUSTOM);
+		base = name;
+	} else {
+		for (i = 0; i < ARRAY_SIZE(timestamp_ids); i++) {
+			if (timestamp_ids[i].id == num) {
+				base = timestamp_ids[i].name;
+				break;
+			}
+		}
 	}
-	return "<unknown>";
+
+	if (!(id & TIMESTAMP_SPAN_MASK))
+		return base;
+
+	if (base != name)
+		snprintf(name, sizeof(name), "%s", base);
+	strncat(name, id & TIMESTAMP_SPAN_BEGIN ? " (begin)" : " (end)",
+		sizeof(name) - strlen(name) - 1);
+	return name;
 }
 
 static uint64_t timestamp_print_parseable_entry(uint32_t id, uint64_t stamp,
@@ -564,7 +615,7 @@ static uint64_t timestamp_print_parseable_entry(uint32_t id, uint64_t stamp,
 	step_time = arch_convert_raw_ts_entry(stamp - prev_stamp);
 
 	/* ID<tab>absolute time<tab>relative time<tab>description */
-	printf("%d\t", id);
+	printf("%d\t", id & ~TIMESTAMP_SPAN_MASK);
 	printf("%llu\t", (long long)arch_convert_raw_ts_entry(stamp));
 	printf("%llu\t", (long long)step_time);
 	printf("%s\n", name);
@@ -579,7 +630,7 @@ uint64_t timestamp_print_entry(uint32_t id, uint64_t stamp, uint64_t prev_stamp)
 
 	name = timestamp_name(id);
 
-	printf("%4d:", id);
+	printf("%4d:", id & ~TIMESTAMP_SPAN_MASK);
 	printf("%-50s", name);
 	print_norm(arch_convert_raw_ts_entry(stamp));
 	step_time = arch_convert_raw_ts_entry(stamp - prev_stamp);
@@ -606,20 +657,17 @@ static int compare_timestamp_entries(const void *a, const void *b)
 	return 0;
 }
 
-/* dump the timestamp table */
-static void dump_timestamps(int mach_readable)
+/* Return a copy of the timestamp table with the entries sorted by time. */
+static struct timestamp_table *read_sorted_timestamps(void)
 {
-	int i;
 	const struct timestamp_table *tst_p;
 	struct timestamp_table *sorted_tst_p;
 	size_t size;
-	uint64_t prev_stamp;
-	uint64_t total_time;
 	struct mapping timestamp_mapping;
 
 	if (timestamps.tag != LB_TAG_TIMESTAMPS) {
 		fprintf(stderr, "No timestamps found in coreboot table.\n");
-		return;
+		return NULL;
 	}
 
 	size = sizeof(*tst_p);
@@ -629,8 +677,6 @@ static void dump_timestamps(int mach_readable)
 
 	timestamp_set_tick_freq(tst_p->tick_freq_mhz);
 
-	if (!mach_readable)
-		printf("%d entries total:\n\n", tst_p->num_entries);
 	size += tst_p->num_entries * sizeof(tst_p->entries[0]);
 
 	unmap_memory(&timestamp_mapping);
@@ -639,23 +685,43 @@ static void dump_timestamps(int mach_readable)
 	if (!tst_p)
 		die("Unable to map full timestamp table\n");
 
-	/* Report the base time within the table. */
-	prev_stamp = 0;
-	if (mach_readable)
-		timestamp_print_parseable_entry(0,  tst_p->base_time,
-						prev_stamp);
-	else
-		timestamp_print_entry(0,  tst_p->base_time, prev_stamp);
-	prev_stamp = tst_p->base_time;
-
 	sorted_tst_p = malloc(size);
 	if (!sorted_tst_p)
 		die("Failed to allocate memory");
 	memcpy(sorted_tst_p, tst_p, size);
 
+	unmap_memory(&timestamp_mapping);
+
 	qsort(&sorted_tst_p->entries[0], sorted_tst_p->num_entries,
 	      sizeof(struct timestamp_entry), compare_timestamp_entries);
 
+	return sorted_tst_p;
+}
+
+/* dump the timestamp table */
+static void dump_timestamps(int mach_readable)
+{
+	int i;
+	struct timestamp_table *sorted_tst_p;
+	uint64_t prev_stamp;
+	uint64_t total_time;
+
+	sorted_tst_p = read_sorted_timestamps();
+	if (!sorted_tst_p)
+		return;
+
+	if (!mach_readable)
+		printf("%d entries total:\n\n", sorted_tst_p->num_entries);
+
+	/* Report the base time within the table. */
+	prev_stamp = 0;
+	if (mach_readable)
+		timestamp_print_parseable_entry(0,  sorted_tst_p->base_time,
+						prev_stamp);
+	else
+		timestamp_print_entry(0,  sorted_tst_p->base_time, prev_stamp);
+	prev_stamp = sorted_tst_p->base_time;
+
 	total_time = 0;
 	for (i = 0; i < sorted_tst_p->num_entries; i++) {
 		uint64_t stamp;
@@ -679,10 +745,294 @@ static void dump_timestamps(int mach_readable)
 		printf("\n");
 	}
 
-	unmap_memory(&timestamp_mapping);
 	free(sorted_tst_p);
 }
 
+static void print_json_string(const char *s)
+{
+	putchar('"');
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			printf("\\%c", *s);
+		else if (*s == '\n')
+			printf("\\n");
+		else if (*s == '\t')
+			printf("\\t");
+		else if ((unsigned char)*s < ' ')
+			printf("\\u%04x", (unsigned char)*s);
+		else
+			putchar(*s);
+	}
+	putchar('"');
+}
+
+/*
+ * Dump the timestamps in the Chrome trace event format, which Perfetto and
+ * chrome://tracing show as a flame chart. Spans turn into nested begin and
+ * end events, everything else into instant events.
+ */
+static void dump_timestamps_trace_json(void)
+{
+	struct timestamp_table *sorted_tst_p;
+	uint32_t i;
+
+	sorted_tst_p = read_sorted_timestamps();
+	if (!sorted_tst_p)
+		return;
+
+	printf("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	for (i = 0; i < sorted_tst_p->num_entries; i++) {
+		const struct timestamp_entry *tse = &sorted_tst_p->entries[i];
+		uint32_t id = tse->entry_id;
+		const char *phase = "i";
+
+		if (id & TIMESTAMP_SPAN_BEGIN)
+			phase = "B";
+		else if (id & TIMESTAMP_SPAN_END)
+			phase = "E";
+
+		/* The begin and end events of a span share its name. */
+		printf("  {\"name\": ");
+		print_json_string(timestamp_name(id & ~TIMESTAMP_SPAN_MASK));
+		printf(", \"ph\": \"%s\", \"ts\": %" PRIu64
+		       ", \"pid\": 1, \"tid\": 1%s}%s\n", phase,
+		       arch_convert_raw_ts_entry(tse->entry_stamp +
+						 sorted_tst_p->base_time),
+		       phase[0] == 'i' ? ", \"s\": \"g\"" : "",
+		       i + 1 < sorted_tst_p->num_entries ? "," : "");
+	}
+	printf("]}\n");
+
+	free(sorted_tst_p);
+}
+
+/*
+ * The timestamp history is a text file with one block per boot: a line
+ * "# boot" followed by "<id>\t<microseconds since the start>" lines.
+ */
+static void append_timestamp_history(const char *path)
+{
+	struct timestamp_table *sorted_tst_p;
+	uint32_t i;
+	FILE *f;
+
+	sorted_tst_p = read_sorted_timestamps();
+	if (!sorted_tst_p)
+		exit(1);
+
+	f = fopen(path, "a");
+	if (!f) {
+		fprintf(stderr, "Unable to open %s: %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	fprintf(f, "# boot\n");
+	for (i = 0; i < sorted_tst_p->num_entries; i++) {
+		const struct timestamp_entry *tse = &sorted_tst_p->entries[i];
+
+		fprintf(f, "%u\t%" PRIu64 "\n", tse->entry_id,
+			arch_convert_raw_ts_entry(tse->entry_stamp +
+						  sorted_tst_p->base_time));
+	}
+	fclose(f);
+
+	free(sorted_tst_p);
+}
+
+struct ts_sample {
+	uint32_t id;
+	uint64_t usecs;
+};
+
+struct ts_stats {
+	uint32_t id;
+	size_t count;
+	uint64_t min, median, p95, max;
+};
+
+static int compare_ts_samples(const void *a, const void *b)
+{
+	const struct ts_sample *sa = a;
+	const struct ts_sample *sb = b;
+
+	if (sa->id != sb->id)
+		return sa->id > sb->id ? 1 : -1;
+	if (sa->usecs != sb->usecs)
+		return sa->usecs > sb->usecs ? 1 : -1;
+	return 0;
+}
+
+/* Read a history file, keeping the first time each ID shows up per boot. */
+static struct ts_sample *read_timestamp_history(const char *path,
+						size_t *num_samples,
+						size_t *num_boots)
+{
+	struct ts_sample *samples = NULL;
+	size_t num = 0, room = 0, boot_start = 0;
+	char line[128];
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f) {
+		fprintf(stderr, "Unable to open %s: %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	*num_boots = 0;
+	while (fgets(line, sizeof(line), f)) {
+		struct ts_sample sample;
+		unsigned long long usecs;
+		unsigned int id;
+		size_t i;
+
+		if (!strncmp(line, "# boot", 6)) {
+			(*num_boots)++;
+			boot_start = num;
+			continue;
+		}
+		if (sscanf(line, "%u\t%llu", &id, &usecs) != 2)
+			continue;
+
+		sample.id = id;
+		sample.usecs = usecs;
+		for (i = boot_start; i < num; i++) {
+			if (samples[i].id == sample.id)
+				break;
+		}
+		if (i < num)
+			continue;
+
+		if (num == room) {
+			room = room ? room * 2 : 256;
+			samples = realloc(samples, room * sizeof(*samples));
+			if (!samples)
+				die("Out of memory.\n");
+		}
+		samples[num++] = sample;
+	}
+	fclose(f);
+
+	qsort(samples, num, sizeof(*samples), compare_ts_samples);
+	*num_samples = num;
+
+	return samples;
+}
+
+/* Turn the sorted samples into one set of statistics per ID. */
+static struct ts_stats *timestamp_history_stats(const char *path,
+						size_t *num_stats,
+						size_t *num_boots)
+{
+	struct ts_sample *samples;
+	struct ts_stats *stats;
+	size_t num_samples, i, j, num = 0;
+
+	samples = read_timestamp_history(path, &num_samples, num_boots);
+
+	stats = calloc(num_samples ? num_samples : 1, sizeof(*stats));
+	if (!stats)
+		die("Out of memory.\n");
+
+	for (i = 0; i < num_samples; i = j) {
+		struct ts_stats *st = &stats[num++];
+		size_t n;
+
+		for (j = i; j < num_samples && samples[j].id == samples[i].id;
+		     j++)
+			;
+		n = j - i;
+
+		st->id = samples[i].id;
+		st->count = n;
+		st->min = samples[i].usecs;
+		st->max = samples[j - 1].usecs;
+		st->median = samples[i + n / 2].usecs;
+		if (n % 2 == 0)
+			st->median = (samples[i + n / 2 - 1].usecs +
+				      samples[i + n / 2].usecs) / 2;
+		/* Nearest rank: the smallest sample not below 95% of them. */
+		st->p95 = samples[i + (n * 95 + 99) / 100 - 1].usecs;
+	}
+
+	free(samples);
+	*num_stats = num;
+
+	return stats;
+}
+
+/*
+ * Print min/median/p95/max per timestamp ID over all boots in the history.
+ * With a baseline history the medians are compared, and a median later than
+ * the baseline's by more than threshold percent counts as a regression.
+ * Returns the number of regressions.
+ */
+static int dump_timestamp_stats(const char *path, const char *baseline_path,
+				unsigned int threshold)
+{
+	struct ts_stats *stats, *base = NULL;
+	size_t num, num_base = 0, boots, base_boots = 0, i, j;
+	int regressions = 0;
+
+	stats = timestamp_history_stats(path, &num, &boots);
+	if (baseline_path)
+		base = timestamp_history_stats(baseline_path, &num_base,
+					       &base_boots);
+
+	printf("%zu boots", boots);
+	if (base)
+		printf(", baseline %zu boots, threshold %u%%", base_boots,
+		       threshold);
+	printf("\n\n%4s %-44s %10s %10s %10s %10s", "id", "name", "min",
+	       "median", "p95", "max");
+	if (base)
+		printf(" %10s %7s", "delta", "%");
+	printf("\n");
+
+	for (i = 0; i < num; i++) {
+		const struct ts_stats *st = &stats[i];
+		const struct ts_stats *bst = NULL;
+
+		printf("%4u %-44.44s %10" PRIu64 " %10" PRIu64 " %10" PRIu64
+		       " %10" PRIu64, st->id & ~TIMESTAMP_SPAN_MASK,
+		       timestamp_name(st->id), st->min, st->median, st->p95,
+		       st->max);
+
+		for (j = 0; j < num_base; j++) {
+			if (base[j].id == st->id) {
+				bst = &base[j];
+				break;
+			}
+		}
+
+		if (bst) {
+			int64_t delta = st->median - bst->median;
+			int64_t pct = bst->median ?
+				delta * 100 / (int64_t)bst->median : 0;
+
+			printf(" %+10" PRId64 " %+6" PRId64 "%%", delta, pct);
+			if (delta > 0 &&
+			    (uint64_t)delta * 100 > bst->median * threshold) {
+				printf("  REGRESSION");
+				regressions++;
+			}
+		} else if (base) {
+			printf(" %10s", "new");
+		}
+		printf("\n");
+	}
+
+	if (base)
+		printf("\n%d regression%s above %u%%\n", regressions,
+		       regressions == 1 ? "" : "s", threshold);
+
+	free(stats);
+	free(base);
+
+	return regressions;
+}
+
 /* dump the tcpa log table */
 static void dump_tcpa_log(void)
 {
@@ -728,6 +1078,285 @@ static void dump_tcpa_log(void)
 	unmap_memory(&tcpa_mapping);
 }
 
+#define BS_TIMES_TOP 20
+
+static const char *bs_times_kind_name(uint8_t kind)
+{
+	switch (kind) {
+	case BS_TIMES_ON_ENTRY:
+		return "entry";
+	case BS_TIMES_ON_EXIT:
+		return "exit";
+	case BS_TIMES_READ_RESOURCES:
+		return "read_resources";
+	case BS_TIMES_ENABLE_RESOURCES:
+		return "enable_resources";
+	case BS_TIMES_INIT:
+		return "init";
+	case BS_TIMES_FSP_NOTIFY:
+		return "fsp_notify";
+	default:
+		return "unknown";
+	}
+}
+
+static const char *bs_times_state_name(uint8_t state)
+{
+	static const char *const names[] = {
+		"PRE_DEVICE", "DEV_INIT_CHIPS", "DEV_ENUMERATE",
+		"DEV_RESOURCES", "DEV_ENABLE", "DEV_INIT", "POST_DEVICE",
+		"OS_RESUME_CHECK", "OS_RESUME", "WRITE_TABLES",
+		"PAYLOAD_LOAD", "PAYLOAD_BOOT",
+	};
+
+	if (state < ARRAY_SIZE(names))
+		return names[state];
+	return "unknown";
+}
+
+static int compare_bs_times_entries(const void *a, const void *b)
+{
+	const struct bs_times_entry *ea = a;
+	const struct bs_times_entry *eb = b;
+
+	if (ea->usecs > eb->usecs)
+		return -1;
+	if (ea->usecs < eb->usecs)
+		return 1;
+	return 0;
+}
+
+/* Print the slowest boot state callbacks and device operations. */
+static void dump_bs_times(void)
+{
+	const struct bs_times_table *table;
+	struct bs_times_entry *entries;
+	struct mapping bs_times_mapping;
+	uint64_t start;
+	size_t size;
+	uint32_t i, num;
+	uint64_t total = 0;
+
+	if (find_cbmem_entry(CBMEM_ID_BS_TIMES, &start, &size)) {
+		fprintf(stderr, "No boot state times found\n");
+		return;
+	}
+
+	table = map_memory(&bs_times_mapping, start, size);
+	if (!table)
+		die("Unable to map boot state times\n");
+
+	num = table->num_entries;
+	if (num > (size - sizeof(*table)) / sizeof(table->entries[0]))
+		die("Boot state times table is corrupted.\n");
+
+	entries = malloc(num * sizeof(entries[0]));
+	if (!entries)
+		die("Out of memory.\n");
+	aligned_memcpy(entries, table->entries, num * sizeof(entries[0]));
+	unmap_memory(&bs_times_mapping);
+
+	qsort(entries, num, sizeof(entries[0]), compare_bs_times_entries);
+
+	for (i = 0; i < num; i++)
+		total += entries[i].usecs;
+
+	printf("%u boot state callbacks and device operations took "
+	       "%" PRIu64 " us, the slowest:\n\n", num, total);
+	printf("%10s  %-16s %-16s %-18s %s\n", "usecs", "state", "what",
+	       "function", "name");
+
+	/* Print them all when asked to be verbose. */
+	if (!verbose && num > BS_TIMES_TOP)
+		num = BS_TIMES_TOP;
+
+	for (i = 0; i < num; i++) {
+		const struct bs_times_entry *e = &entries[i];
+
+		printf("%10u  %-16s %-16s 0x%016" PRIx64 " %.*s\n", e->usecs,
+		       bs_times_state_name(e->state),
+		       bs_times_kind_name(e->kind), e->func,
+		       (int)sizeof(e->name), e->name);
+	}
+
+	free(entries);
+}
+
+static const char *mem_usage_kind_name(uint8_t kind)
+{
+	switch (kind) {
+	case MEM_USAGE_STACK:
+		return "stack";
+	case MEM_USAGE_HEAP:
+		return "heap";
+	case MEM_USAGE_CAR_STACK:
+		return "CAR stack";
+	case MEM_USAGE_CAR_DATA:
+		return "CAR data";
+	case MEM_USAGE_CBMEM:
+		return "CBMEM";
+	default:
+		return "unknown";
+	}
+}
+
+static void dump_mem_usage(void)
+{
+	const struct mem_usage_table *table;
+	struct mem_usage_entry *entries;
+	struct mapping mem_usage_mapping;
+	uint64_t start;
+	size_t size;
+	uint32_t i, num;
+
+	if (find_cbmem_entry(CBMEM_ID_MEM_USAGE, &start, &size)) {
+		fprintf(stderr, "No memory usage found\n");
+		return;
+	}
+
+	table = map_memory(&mem_usage_mapping, start, size);
+	if (!table)
+		die("Unable to map memory usage\n");
+
+	num = table->num_entries;
+	if (num > (size - sizeof(*table)) / sizeof(table->entries[0]))
+		die("Memory usage table is corrupted.\n");
+
+	entries = malloc(num * sizeof(entries[0]));
+	if (!entries)
+		die("Out of memory.\n");
+	aligned_memcpy(entries, table->entries, num * sizeof(entries[0]));
+	unmap_memory(&mem_usage_mapping);
+
+	printf("%-10s %-10s %4s %10s %10s %5s\n", "stage", "region", "cpu",
+	       "used", "size", "%");
+
+	for (i = 0; i < num; i++) {
+		const struct mem_usage_entry *e = &entries[i];
+
+		printf("%-10s %-10s %4u %10u ",
+		       e->stage == MEM_USAGE_ROMSTAGE ? "romstage" : "ramstage",
+		       mem_usage_kind_name(e->kind), e->cpu, e->used);
+		/* CBMEM has no fixed size. */
+		if (e->size)
+			printf("%10u %5.1f\n", e->size,
+			       100.0 * e->used / e->size);
+		else
+			printf("%10s %5s\n", "-", "-");
+	}
+
+	free(entries);
+}
+
+/* One "offset size" line per read, the format 'cbfstool compact -f' takes. */
+static void dump_boot_media_trace(void)
+{
+	const struct boot_media_trace *trace;
+	struct boot_media_trace_entry *entries;
+	struct mapping trace_mapping;
+	uint64_t start;
+	size_t size;
+	uint32_t i, num, dropped;
+
+	if (find_cbmem_entry(CBMEM_ID_BOOT_MEDIA_TRACE, &start, &size)) {
+		fprintf(stderr, "No boot media trace found\n");
+		return;
+	}
+
+	trace = map_memory(&trace_mapping, start, size);
+	if (!trace)
+		die("Unable to map boot media trace\n");
+
+	num = trace->num_entries;
+	dropped = trace->dropped;
+	if (num > (size - sizeof(*trace)) / sizeof(trace->entries[0]))
+		die("Boot media trace is corrupted.\n");
+
+	entries = malloc(num * sizeof(entries[0]));
+	if (!entries)
+		die("Out of memory.\n");
+	aligned_memcpy(entries, trace->entries, num * sizeof(entries[0]));
+	unmap_memory(&trace_mapping);
+
+	printf("# %u boot media reads", num);
+	if (dropped)
+		printf(", %u more were not recorded", dropped);
+	printf("\n# offset size\n");
+	for (i = 0; i < num; i++)
+		printf("0x%08x 0x%x\n", entries[i].offset, entries[i].size);
+
+	free(entries);
+}
+
+/* Tags are usually four characters, like the CBMEM ids. */
+static void print_arena_tag(uint32_t tag)
+{
+	int i;
+
+	for (i = 3; i >= 0; i--) {
+		if (!isprint((tag >> (8 * i)) & 0xff)) {
+			printf("0x%08x  ", tag);
+			return;
+		}
+	}
+
+	for (i = 3; i >= 0; i--)
+		printf("%c", (tag >> (8 * i)) & 0xff);
+	printf("%8s", "");
+}
+
+static void dump_arena(void)
+{
+	const struct cbmem_arena *arena;
+	const struct cbmem_arena_record *rec;
+	struct mapping arena_mapping;
+	uint64_t start;
+	size_t size, offset, i;
+
+	if (find_cbmem_entry(CBMEM_ID_ARENA, &start, &size)) {
+		fprintf(stderr, "No CBMEM arena found\n");
+		return;
+	}
+
+	arena = map_memory(&arena_mapping, start, size);
+	if (!arena)
+		die("Unable to map the CBMEM arena\n");
+
+	if (arena->used > arena->size ||
+	    arena->size > size - sizeof(*arena))
+		die("CBMEM arena is corrupted.\n");
+
+	printf("CBMEM arena: %u records in %u of %u bytes\n\n",
+	       arena->num_records, arena->used, arena->size);
+	printf("%10s  %-10s  %s\n", "offset", "tag", "size");
+
+	offset = 0;
+	while (offset + sizeof(*rec) <= arena->used) {
+		rec = (const void *)&arena->data[offset];
+		if (rec->size > arena->used - offset - sizeof(*rec)) {
+			fprintf(stderr, "CBMEM arena record at 0x%zx is "
+				"truncated\n", offset);
+			break;
+		}
+
+		printf("0x%08zx  ", offset);
+		print_arena_tag(rec->tag);
+		printf("%u\n", rec->size);
+
+		/* The payloads with -V. */
+		for (i = 0; verbose && i < rec->size; i++)
+			printf("%s%02x%s", i % 16 ? " " : "            ",
+			       rec->data[i],
+			       i % 16 == 15 || i == rec->size - 1 ? "\n" : "");
+
+		offset += sizeof(*rec) + rec->size;
+		offset = (offset + CBMEM_ARENA_ALIGN - 1) &
+			 ~(size_t)(CBMEM_ARENA_ALIGN - 1);
+	}
+
+	unmap_memory(&arena_mapping);
+}
+
 struct cbmem_console {
 	u32 size;
 	u32 cursor;
@@ -737,8 +1366,26 @@ struct cbmem_console {
 #define CBMC_CURSOR_MASK ((1 << 28) - 1)
 #define CBMC_OVERFLOW (1 << 31)
 
-/* dump the cbmem console */
-static void dump_console(int one_boot_only)
+/* How often --follow looks for new console output. */
+#define CONSOLE_FOLLOW_INTERVAL_US	100000
+
+/* Slight memory corruption may occur between reboots and give us a few
+   unprintable characters like '\0'. Replace them with '?' on output. */
+static void sanitize_console(char *console_c, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		if (!isprint(console_c[i]) && !isspace(console_c[i]))
+			console_c[i] = '?';
+}
+
+/*
+ * Read the cbmem console into a NUL-terminated buffer that the caller has to
+ * free. *start is set to where the last boot begins if one_boot_only is set,
+ * to 0 otherwise. Returns NULL if there is no console.
+ */
+static char *read_console(int one_boot_only, size_t *start)
 {
 	const struct cbmem_console *console_p;
 	char *console_c;
@@ -747,7 +1394,7 @@ static void dump_console(int one_boot_only)
 
 	if (console.tag != LB_TAG_CBMEM_CONSOLE) {
 		fprintf(stderr, "No console found in coreboot table.\n");
-		return;
+		return NULL;
 	}
 
 	size = sizeof(*console_p);
@@ -788,12 +1435,9 @@ static void dump_console(int one_boot_only)
 	} else {
 		aligned_memcpy(console_c, console_p->body, size);
 	}
+	unmap_memory(&console_mapping);
 
-	/* Slight memory corruption may occur between reboots and give us a few
-	   unprintable characters like '\0'. Replace them with '?' on output. */
-	for (cursor = 0; cursor < size; cursor++)
-		if (!isprint(console_c[cursor]) && !isspace(console_c[cursor]))
-			console_c[cursor] = '?';
+	sanitize_console(console_c, size);
 
 	/* We detect the last boot by looking for a bootblock, romstage or
 	   ramstage banner, in that order (to account for platforms without
@@ -822,15 +1466,457 @@ static void dump_console(int one_boot_only)
 		}
 	}
 
-	puts(console_c + cursor);
-	free(console_c);
-	unmap_memory(&console_mapping);
+	*start = cursor;
+	return console_c;
 }
 
-static void hexdump(unsigned long memory, int length)
+/* dump the cbmem console */
+static void dump_console(int one_boot_only)
 {
-	int i;
-	const uint8_t *m;
+	char *console_c;
+	size_t start;
+
+	console_c = read_console(one_boot_only, &start);
+	if (!console_c)
+		return;
+
+	puts(console_c + start);
+	free(console_c);
+}
+
+/*
+ * Keep printing what gets appended to the cbmem console, e.g. by SMM or
+ * other runtime firmware that logs into it, until cbmem is killed.
+ */
+static void follow_console(void)
+{
+	const struct cbmem_console *console_p;
+	const volatile struct cbmem_console *live;
+	struct mapping console_mapping;
+	size_t size, last, cursor;
+	char *buf;
+
+	if (console.tag != LB_TAG_CBMEM_CONSOLE) {
+		fprintf(stderr, "No console found in coreboot table.\n");
+		return;
+	}
+
+	console_p = map_memory(&console_mapping, console.cbmem_addr,
+			       sizeof(*console_p));
+	if (!console_p)
+		die("Unable to map console object.\n");
+	size = console_p->size;
+	unmap_memory(&console_mapping);
+
+	console_p = map_memory(&console_mapping, console.cbmem_addr,
+			       size + sizeof(*console_p));
+	if (!console_p)
+		die("Unable to map full console object.\n");
+
+	buf = malloc(size);
+	if (!buf)
+		die("Not enough memory for console.\n");
+
+	/* The firmware keeps writing, so the cursor must be read each time. */
+	live = console_p;
+	last = live->cursor & CBMC_CURSOR_MASK;
+	if (last > size)
+		last = size;
+
+	for (;;) {
+		cursor = live->cursor & CBMC_CURSOR_MASK;
+		if (cursor > size)
+			cursor = size;
+
+		if (cursor < last) {
+			/* The console wrapped around. */
+			aligned_memcpy(buf, console_p->body + last,
+				       size - last);
+			sanitize_console(buf, size - last);
+			fwrite(buf, 1, size - last, stdout);
+			last = 0;
+		}
+
+		if (cursor > last) {
+			aligned_memcpy(buf, console_p->body + last,
+				       cursor - last);
+			sanitize_console(buf, cursor - last);
+			fwrite(buf, 1, cursor - last, stdout);
+			fflush(stdout);
+			last = cursor;
+		}
+
+		usleep(CONSOLE_FOLLOW_INTERVAL_US);
+	}
+}
+
+/* The stage ELF the binary console log refers to. */
+struct binlog_elf {
+	uint8_t *data;
+	size_t size;
+	uint64_t program;	/* link address of _program */
+	int is_64;
+};
+
+static int binlog_elf_section(const struct binlog_elf *elf, unsigned int i,
+			      uint32_t *type, uint64_t *addr, uint64_t *offset,
+			      uint64_t *size, uint32_t *link, uint64_t *entsize)
+{
+	if (elf->is_64) {
+		const Elf64_Ehdr *ehdr = (const void *)elf->data;
+		const Elf64_Shdr *shdr;
+
+		if (i >= ehdr->e_shnum || ehdr->e_shoff +
+		    (i + 1) * sizeof(*shdr) > elf->size)
+			return -1;
+		shdr = (const void *)(elf->data + ehdr->e_shoff) + i;
+		*type = shdr->sh_type;
+		*addr = shdr->sh_addr;
+		*offset = shdr->sh_offset;
+		*size = shdr->sh_size;
+		*link = shdr->sh_link;
+		*entsize = shdr->sh_entsize;
+	} else {
+		const Elf32_Ehdr *ehdr = (const void *)elf->data;
+		const Elf32_Shdr *shdr;
+
+		if (i >= ehdr->e_shnum || ehdr->e_shoff +
+		    (i + 1) * sizeof(*shdr) > elf->size)
+			return -1;
+		shdr = (const void *)(elf->data + ehdr->e_shoff) + i;
+		*type = shdr->sh_type;
+		*addr = shdr->sh_addr;
+		*offset = shdr->sh_offset;
+		*size = shdr->sh_size;
+		*link = shdr->sh_link;
+		*entsize = shdr->sh_entsize;
+	}
+
+	if (*type != SHT_NOBITS && *offset + *size > elf->size)
+		return -1;
+	return 0;
+}
+
+/* Find the link address of _program in the symbol table. */
+static int binlog_elf_find_program(struct binlog_elf *elf)
+{
+	uint32_t type, link, strtype, strlink;
+	uint64_t addr, offset, size, entsize;
+	uint64_t stroff, strsize, dummy;
+	unsigned int i;
+	uint64_t j;
+
+	for (i = 0; !binlog_elf_section(elf, i, &type, &addr, &offset,
+					&size, &link, &entsize); i++) {
+		if (type != SHT_SYMTAB || !entsize)
+			continue;
+		if (binlog_elf_section(elf, link, &strtype, &dummy, &stroff,
+				       &strsize, &strlink, &dummy))
+			continue;
+
+		for (j = 0; j < size / entsize; j++) {
+			const void *sym = elf->data + offset + j * entsize;
+			uint64_t name, value;
+
+			if (elf->is_64) {
+				name = ((const Elf64_Sym *)sym)->st_name;
+				value = ((const Elf64_Sym *)sym)->st_value;
+			} else {
+				name = ((const Elf32_Sym *)sym)->st_name;
+				value = ((const Elf32_Sym *)sym)->st_value;
+			}
+			if (name >= strsize)
+				continue;
+			if (strncmp((const char *)elf->data + stroff + name,
+				    "_program", strsize - name))
+				continue;
+			elf->program = value;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+static void binlog_elf_load(struct binlog_elf *elf, const char *path)
+{
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st)) {
+		fprintf(stderr, "Unable to open %s: %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	elf->size = st.st_size;
+	elf->data = malloc(elf->size);
+	if (!elf->data)
+		die("Out of memory.\n");
+	if (read(fd, elf->data, elf->size) != (ssize_t)elf->size)
+		die("Unable to read the stage ELF.\n");
+	close(fd);
+
+	if (elf->size < sizeof(Elf64_Ehdr) ||
+	    memcmp(elf->data, ELFMAG, SELFMAG))
+		die("Not an ELF file.\n");
+	elf->is_64 = elf->data[EI_CLASS] == ELFCLASS64;
+
+	if (binlog_elf_find_program(elf))
+		die("No _program symbol in the stage ELF.\n");
+}
+
+/* Return the string at link address 'addr' or NULL if the ELF has none. */
+static const char *binlog_elf_string(const struct binlog_elf *elf,
+				     uint64_t addr)
+{
+	uint32_t type, link;
+	uint64_t saddr, offset, size, entsize;
+	unsigned int i;
+
+	for (i = 0; !binlog_elf_section(elf, i, &type, &saddr, &offset,
+					&size, &link, &entsize); i++) {
+		const char *s;
+
+		if (type != SHT_PROGBITS || addr < saddr ||
+		    addr >= saddr + size)
+			continue;
+		s = (const char *)elf->data + offset + (addr - saddr);
+		/* The string has to end within the section. */
+		if (!memchr(s, '\0', saddr + size - addr))
+			return NULL;
+		return s;
+	}
+
+	return NULL;
+}
+
+struct binlog_reader {
+	const uint8_t *pos;
+	const uint8_t *end;
+};
+
+static int binlog_get_u64(struct binlog_reader *r, uint64_t *val)
+{
+	int i;
+
+	if (r->end - r->pos < 8)
+		return -1;
+	*val = 0;
+	for (i = 0; i < 8; i++)
+		*val |= (uint64_t)r->pos[i] << (i * 8);
+	r->pos += 8;
+	return 0;
+}
+
+static const char *binlog_get_string(struct binlog_reader *r)
+{
+	const char *s = (const char *)r->pos;
+	const uint8_t *nul = memchr(r->pos, '\0', r->end - r->pos);
+
+	if (!nul)
+		return NULL;
+	r->pos = nul + 1;
+	return s;
+}
+
+/*
+ * Print one message the way printk() would have. Every conversion spec is
+ * rebuilt with an 'll' qualifier since all numbers were logged as 64 bits.
+ */
+static int binlog_print(const char *fmt, struct binlog_reader *r,
+			int ptr_size)
+{
+	char spec[64];
+	uint64_t val;
+	int width, precision, has_width;
+	size_t len;
+
+	for (; *fmt; fmt++) {
+		if (*fmt != '%') {
+			putchar(*fmt);
+			continue;
+		}
+
+		len = 0;
+		spec[len++] = '%';
+		while (*++fmt == '-' || *fmt == '+' || *fmt == ' ' ||
+		       *fmt == '#' || *fmt == '0') {
+			if (len < 8)
+				spec[len++] = *fmt;
+		}
+
+		width = 0;
+		has_width = 0;
+		if (*fmt == '*') {
+			fmt++;
+			if (binlog_get_u64(r, &val))
+				return -1;
+			width = (int)val;
+			has_width = 1;
+		} else if (*fmt >= '0' && *fmt <= '9') {
+			width = strtol(fmt, (char **)&fmt, 10);
+			has_width = 1;
+		}
+
+		precision = -1;
+		if (*fmt == '.') {
+			fmt++;
+			if (*fmt == '*') {
+				fmt++;
+				if (binlog_get_u64(r, &val))
+					return -1;
+				precision = (int)val;
+			} else {
+				precision = strtol(fmt, (char **)&fmt, 10);
+			}
+			if (precision < 0)
+				precision = 0;
+		}
+
+		/* The qualifiers are covered by the 64 bit values. */
+		while (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'z')
+			fmt++;
+
+		if (has_width)
+			len += snprintf(spec + len, sizeof(spec) - len, "%d",
+					width);
+		if (precision >= 0)
+			len += snprintf(spec + len, sizeof(spec) - len, ".%d",
+					precision);
+
+		switch (*fmt) {
+		case 'c':
+			if (binlog_get_u64(r, &val))
+				return -1;
+			strcpy(spec + len, "c");
+			printf(spec, (int)val);
+			break;
+		case 's': {
+			const char *s = binlog_get_string(r);
+
+			if (!s)
+				return -1;
+			strcpy(spec + len, "s");
+			printf(spec, s);
+			break;
+		}
+		case 'p':
+			if (binlog_get_u64(r, &val))
+				return -1;
+			/* printk() zero pads pointers to their full width. */
+			if (!has_width)
+				len = snprintf(spec, sizeof(spec), "%%0%d",
+					       ptr_size * 2);
+			strcpy(spec + len, "llx");
+			printf(spec, (unsigned long long)val);
+			break;
+		case 'd':
+		case 'i':
+		case 'o':
+		case 'u':
+		case 'x':
+		case 'X':
+			if (binlog_get_u64(r, &val))
+				return -1;
+			snprintf(spec + len, sizeof(spec) - len, "ll%c", *fmt);
+			printf(spec, (unsigned long long)val);
+			break;
+		case 'n':
+			break;
+		case '%':
+			putchar('%');
+			break;
+		case '\0':
+			putchar('%');
+			return 0;
+		default:
+			/* Like printk(), keep only the conversion char. */
+			putchar('%');
+			putchar(*fmt);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/* format the binary console log again using the stage ELF */
+static void dump_console_binlog(const char *elf_path)
+{
+	const struct console_binlog *binlog;
+	struct mapping binlog_mapping;
+	struct binlog_elf elf;
+	uint8_t *data;
+	uint64_t start;
+	size_t size, cursor, offset;
+	uint32_t dropped;
+	int ptr_size;
+
+	binlog_elf_load(&elf, elf_path);
+
+	if (find_cbmem_entry(CBMEM_ID_CONSOLE_BINLOG, &start, &size)) {
+		fprintf(stderr, "No binary console log found\n");
+		free(elf.data);
+		return;
+	}
+
+	binlog = map_memory(&binlog_mapping, start, size);
+	if (!binlog)
+		die("Unable to map the binary console log\n");
+
+	cursor = binlog->cursor;
+	if (cursor > binlog->size || cursor > size - sizeof(*binlog))
+		die("Binary console log is corrupted.\n");
+	dropped = binlog->dropped;
+	ptr_size = binlog->ptr_size;
+	debug("Binary console log of the stage at 0x%" PRIx64 ", linked at "
+	      "0x%" PRIx64 "\n", binlog->program, elf.program);
+
+	data = malloc(cursor);
+	if (!data)
+		die("Out of memory.\n");
+	aligned_memcpy(data, binlog->data, cursor);
+	unmap_memory(&binlog_mapping);
+
+	offset = 0;
+	while (offset + sizeof(struct console_binlog_entry) <= cursor) {
+		const struct console_binlog_entry *entry =
+			(const void *)(data + offset);
+		struct binlog_reader r;
+		const char *fmt;
+
+		if (entry->size < sizeof(*entry) ||
+		    entry->size > cursor - offset)
+			die("Binary console log is corrupted.\n");
+
+		r.pos = entry->args;
+		r.end = data + offset + entry->size;
+		offset += entry->size;
+
+		fmt = binlog_elf_string(&elf, elf.program + entry->fmt);
+		if (!fmt) {
+			printf("<unknown message at offset 0x%x, wrong ELF?>\n",
+			       entry->fmt);
+			continue;
+		}
+		if (binlog_print(fmt, &r, ptr_size))
+			printf("<truncated>\n");
+	}
+
+	if (dropped)
+		printf("\n*** %u messages did not fit into the binary console "
+		       "log ***\n", dropped);
+
+	free(data);
+	free(elf.data);
+}
+
+static void hexdump(unsigned long memory, int length)
+{
+	int i;
+	const uint8_t *m;
 	int all_zero = 0;
 	struct mapping hexdump_mapping;
 
@@ -937,11 +2023,12 @@ struct cbmem_id_to_name {
 static const struct cbmem_id_to_name cbmem_ids[] = { CBMEM_ID_TO_NAME_TABLE };
 
 #define MAX_STAGEx 10
-void cbmem_print_entry(int n, uint32_t id, uint64_t base, uint64_t size)
+/* Return the name of a CBMEM entry, NULL if the id is unknown. */
+static const char *cbmem_entry_name(uint32_t id)
 {
-	int i;
+	static char stage_x[20];
 	const char *name;
-	char stage_x[20];
+	int i;
 
 	name = NULL;
 	for (i = 0; i < ARRAY_SIZE(cbmem_ids); i++) {
@@ -963,6 +2050,13 @@ void cbmem_print_entry(int n, uint32_t id, uint64_t base, uint64_t size)
 		}
 	}
 
+	return name;
+}
+
+void cbmem_print_entry(int n, uint32_t id, uint64_t base, uint64_t size)
+{
+	const char *name = cbmem_entry_name(id);
+
 	printf("%2d. ", n);
 	if (name == NULL)
 		printf("\t\t%08x", id);
@@ -1005,6 +2099,82 @@ static void dump_cbmem_toc(void)
 	}
 }
 
+/*
+ * Print the CBMEM area, its table of contents, the timestamps and the
+ * console as one JSON object, so that a tool can collect all of them with
+ * a single cbmem run.
+ */
+static void dump_json(void)
+{
+	const uint8_t *table = mapping_virt(&lbtable_mapping);
+	struct timestamp_table *sorted_tst_p;
+	size_t offset, start;
+	char *console_c;
+	uint32_t i;
+	int first;
+
+	printf("{\n  \"cbmem\": ");
+	if (cbmem.type == LB_MEM_TABLE)
+		printf("{\"start\": %" PRIu64 ", \"size\": %" PRIu64 "}",
+		       unpack_lb64(cbmem.start), unpack_lb64(cbmem.size));
+	else
+		printf("null");
+
+	printf(",\n  \"entries\": [");
+	first = 1;
+	for (offset = 0; offset < mapping_size(&lbtable_mapping);) {
+		const struct lb_record *lbr = (const void *)(table + offset);
+		const struct lb_cbmem_entry *lbe = (const void *)lbr;
+		const char *name;
+
+		offset += lbr->size;
+		if (lbr->tag != LB_TAG_CBMEM_ENTRY)
+			continue;
+
+		printf("%s\n    {\"id\": %u, \"name\": ", first ? "" : ",",
+		       lbe->id);
+		name = cbmem_entry_name(lbe->id);
+		if (name)
+			print_json_string(name);
+		else
+			printf("null");
+		printf(", \"start\": %" PRIu64 ", \"size\": %u}",
+		       lbe->address, lbe->entry_size);
+		first = 0;
+	}
+	printf("\n  ],\n  \"timestamps\": ");
+
+	sorted_tst_p = read_sorted_timestamps();
+	if (sorted_tst_p) {
+		printf("[");
+		for (i = 0; i < sorted_tst_p->num_entries; i++) {
+			const struct timestamp_entry *tse =
+				&sorted_tst_p->entries[i];
+
+			printf("%s\n    {\"id\": %u, \"name\": ",
+			       i ? "," : "", tse->entry_id);
+			print_json_string(timestamp_name(tse->entry_id));
+			printf(", \"us\": %" PRIu64 "}",
+			       arch_convert_raw_ts_entry(tse->entry_stamp +
+						sorted_tst_p->base_time));
+		}
+		printf("\n  ]");
+		free(sorted_tst_p);
+	} else {
+		printf("null");
+	}
+
+	printf(",\n  \"console\": ");
+	console_c = read_console(0, &start);
+	if (console_c) {
+		print_json_string(console_c);
+		free(console_c);
+	} else {
+		printf("null");
+	}
+	printf("\n}\n");
+}
+
 #define COVERAGE_MAGIC 0x584d4153
 struct file {
 	uint32_t magic;
@@ -1032,6 +2202,202 @@ static int mkpath(char *path, mode_t mode)
 	return 0;
 }
 
+/* .gcda file format bits, as in src/lib/gcov-io.h */
+#define GCOV_DATA_MAGIC		0x67636461
+#define GCOV_TAG_FUNCTION	0x01000000
+#define GCOV_TAG_ARC_COUNTS	0x01a10000
+#define GCOV_TAG_PROGRAM_SUMMARY 0xa3000000
+
+static uint32_t gcov_crc32(uint32_t crc32, uint32_t value)
+{
+	unsigned int ix;
+
+	for (ix = 32; ix--; value <<= 1) {
+		uint32_t feedback = (value ^ crc32) & 0x80000000 ?
+				    0x04c11db7 : 0;
+
+		crc32 <<= 1;
+		crc32 ^= feedback;
+	}
+
+	return crc32;
+}
+
+static void gcda_write(FILE *f, uint32_t value)
+{
+	if (fwrite(&value, sizeof(value), 1, f) != 1) {
+		perror("Could not write coverage data");
+		exit(1);
+	}
+}
+
+static void gcda_write_counter(FILE *f, uint64_t value)
+{
+	gcda_write(f, value);
+	gcda_write(f, value >> 32);
+}
+
+static FILE *gcda_create(const char *name)
+{
+	char *filename = strdup(name);
+	FILE *f;
+
+	debug(" -> %s\n", name);
+	if (!filename || mkpath(filename, 0755) == -1) {
+		perror("Directory for coverage data could not be created");
+		exit(1);
+	}
+	f = fopen(filename, "wb");
+	if (!f) {
+		printf("Could not open %s: %s\n", filename, strerror(errno));
+		exit(1);
+	}
+	free(filename);
+
+	return f;
+}
+
+/* The whole program summary that libgcov writes into every .gcda file. */
+struct gcov_program_summary {
+	uint32_t checksum;
+	uint32_t num;
+	uint64_t sum_all;
+	uint64_t run_max;
+};
+
+static void gcda_add_function(struct gcov_program_summary *prg,
+			      const struct coverage_function *fn)
+{
+	const uint32_t *counters = (const void *)&fn[1];
+	uint32_t c_ix;
+
+	prg->checksum = gcov_crc32(prg->checksum, fn->cfg_checksum);
+	prg->checksum = gcov_crc32(prg->checksum, fn->lineno_checksum);
+	if (fn->flags & COVERAGE_FN_NO_DATA)
+		return;
+
+	prg->num += fn->num_counters;
+	prg->checksum = gcov_crc32(prg->checksum, fn->num_counters);
+	if (fn->flags & COVERAGE_FN_NOT_RUN)
+		return;
+
+	for (c_ix = 0; c_ix < fn->num_counters; c_ix++) {
+		prg->sum_all += counters[c_ix];
+		if (prg->run_max < counters[c_ix])
+			prg->run_max = counters[c_ix];
+	}
+}
+
+static void gcda_write_function(FILE *f, const struct coverage_function *fn)
+{
+	const uint32_t *counters = (const void *)&fn[1];
+	uint32_t c_ix;
+
+	gcda_write(f, GCOV_TAG_FUNCTION);
+	if (fn->flags & COVERAGE_FN_NO_DATA) {
+		gcda_write(f, 0);
+		return;
+	}
+
+	gcda_write(f, 3);
+	gcda_write(f, fn->ident);
+	gcda_write(f, fn->lineno_checksum);
+	gcda_write(f, fn->cfg_checksum);
+	gcda_write(f, GCOV_TAG_ARC_COUNTS);
+	gcda_write(f, fn->num_counters * 2);
+	for (c_ix = 0; c_ix < fn->num_counters; c_ix++)
+		gcda_write_counter(f, fn->flags & COVERAGE_FN_NOT_RUN ?
+				   0 : counters[c_ix]);
+}
+
+/*
+ * Either add one object to the program summary or, with a FILE, write its
+ * .gcda file. Returns where the next object starts.
+ */
+static const uint8_t *gcda_object(const uint8_t *p, const uint8_t *end,
+				  struct gcov_program_summary *prg,
+				  uint32_t version, int write)
+{
+	const struct coverage_object *obj = (const void *)p;
+	const char *name = (const char *)&obj[1];
+	FILE *f = NULL;
+	uint32_t f_ix;
+
+	if (end - p < sizeof(*obj) || end - p - sizeof(*obj) < obj->name_size ||
+	    !obj->name_size || name[obj->name_size - 1])
+		die("Compact coverage data is corrupt.\n");
+	p += sizeof(*obj) + obj->name_size;
+
+	if (!write) {
+		prg->checksum = gcov_crc32(prg->checksum, obj->stamp);
+		prg->checksum = gcov_crc32(prg->checksum, obj->num_functions);
+	} else {
+		f = gcda_create(name);
+		gcda_write(f, GCOV_DATA_MAGIC);
+		gcda_write(f, version);
+		gcda_write(f, obj->stamp);
+		gcda_write(f, GCOV_TAG_PROGRAM_SUMMARY);
+		gcda_write(f, 9);
+		gcda_write(f, prg->checksum);
+		gcda_write(f, prg->num);
+		gcda_write(f, 1);	/* runs */
+		gcda_write_counter(f, prg->sum_all);
+		gcda_write_counter(f, prg->run_max);
+		gcda_write_counter(f, prg->run_max);	/* sum_max */
+	}
+
+	for (f_ix = 0; f_ix < obj->num_functions; f_ix++) {
+		const struct coverage_function *fn = (const void *)p;
+		size_t size = sizeof(*fn);
+
+		if (end - p < size)
+			die("Compact coverage data is corrupt.\n");
+		if (!fn->flags)
+			size += fn->num_counters * sizeof(uint32_t);
+		if (end - p < size)
+			die("Compact coverage data is corrupt.\n");
+		p += size;
+
+		if (f)
+			gcda_write_function(f, fn);
+		else
+			gcda_add_function(prg, fn);
+	}
+
+	if (f) {
+		gcda_write(f, 0);
+		fclose(f);
+	}
+
+	return p;
+}
+
+/*
+ * Write the .gcda files from the compact arc counters. The first pass only
+ * adds up the program summary.
+ */
+static void dump_coverage_compact(const void *coverage, size_t size)
+{
+	const struct coverage_compact *hdr = coverage;
+	struct gcov_program_summary prg = { 0 };
+	int pass;
+
+	if (size < sizeof(*hdr) || hdr->size > size)
+		die("Compact coverage data is corrupt.\n");
+
+	for (pass = 0; pass < 2; pass++) {
+		const uint8_t *p = (const uint8_t *)&hdr[1];
+		const uint8_t *end = (const uint8_t *)coverage + hdr->size;
+		uint32_t o_ix;
+
+		for (o_ix = 0; o_ix < hdr->num_objects; o_ix++)
+			p = gcda_object(p, end, &prg, hdr->version, pass);
+	}
+
+	printf("%u objects, %u arcs, %" PRIu64 " arcs taken\n",
+	       hdr->num_objects, prg.num, prg.sum_all);
+}
+
 static void dump_coverage(void)
 {
 	uint64_t start;
@@ -1054,6 +2420,13 @@ static void dump_coverage(void)
 
 	printf("Dumping coverage data...\n");
 
+	if (size >= sizeof(uint32_t) &&
+	    *(const uint32_t *)coverage == COVERAGE_COMPACT_MAGIC) {
+		dump_coverage_compact(coverage, size);
+		unmap_memory(&coverage_mapping);
+		return;
+	}
+
 	struct file *file = (struct file *)coverage;
 	while (file && file->magic == COVERAGE_MAGIC) {
 		FILE *f;
@@ -1105,17 +2478,43 @@ static void print_version(void)
 
 static void print_usage(const char *name, int exit_code)
 {
-	printf("usage: %s [-cCltTLxVvh?]\n", name);
+	printf("usage: %s [-cfCltTJLbumajxVvh?] [-B ELF] [-H FILE]\n"
+	       "       [-S FILE [-R FILE] [-P PERCENT]] [-M FILE] [-F MHZ]\n",
+	       name);
 	printf("\n"
 	     "   -c | --console:                   print cbmem console\n"
 	     "   -1 | --oneboot:                   print cbmem console for last boot only\n"
+	     "   -f | --follow:                    print the cbmem console and keep printing\n"
+	     "                                     what gets appended to it\n"
+	     "   -B | --binary-console ELF:        print the binary console log using\n"
+	     "                                     the stage ELF of the same build\n"
 	     "   -C | --coverage:                  dump coverage information\n"
 	     "   -l | --list:                      print cbmem table of contents\n"
 	     "   -x | --hexdump:                   print hexdump of cbmem area\n"
 	     "   -r | --rawdump ID:                print rawdump of specific ID (in hex) of cbtable\n"
 	     "   -t | --timestamps:                print timestamp information\n"
 	     "   -T | --parseable-timestamps:      print parseable timestamps\n"
+	     "   -J | --trace-json:                print timestamps as Chrome trace JSON\n"
+	     "   -H | --history FILE:              append the timestamps to a history file\n"
+	     "   -S | --stats FILE:                print per timestamp statistics over the\n"
+	     "                                     boots in a history file\n"
+	     "   -R | --baseline FILE:             with -S compare against a baseline history,\n"
+	     "                                     exit with 3 if there are regressions\n"
+	     "   -P | --threshold PERCENT:         regression threshold for -R (default 10)\n"
+	     "   -M | --memory-file FILE:          read physical memory from a raw dump\n"
+	     "                                     (e.g. QEMU's pmemsave) instead of /dev/mem\n"
+	     "   -F | --tick-freq MHZ:             timestamp ticks per microsecond, overrides\n"
+	     "                                     the table and the CPU\n"
 	     "   -L | --tcpa-log                   print TCPA log\n"
+	     "   -b | --bs-times:                  print the slowest boot state callbacks\n"
+	     "                                     and device operations (all with -V)\n"
+	     "   -u | --mem-usage:                 print the stack, heap and CBMEM high-water\n"
+	     "                                     marks\n"
+	     "   -m | --media-trace:               print the recorded boot media reads\n"
+	     "   -a | --arena:                     list the CBMEM arena records\n"
+	     "                                     (with their payloads with -V)\n"
+	     "   -j | --json:                      print the table of contents, timestamps\n"
+	     "                                     and console as one JSON object\n"
 	     "   -V | --verbose:                   verbose (debugging) output\n"
 	     "   -v | --version:                   print the version\n"
 	     "   -h | --help:                      print this help\n"
@@ -1248,19 +2647,46 @@ int main(int argc, char** argv)
 	int print_rawdump = 0;
 	int print_timestamps = 0;
 	int print_tcpa_log = 0;
+	int print_bs_times = 0;
+	int print_mem_usage = 0;
+	int print_media_trace = 0;
+	int print_arena = 0;
+	int print_json = 0;
+	int follow = 0;
 	int machine_readable_timestamps = 0;
+	int trace_json_timestamps = 0;
+	const char *history_file = NULL;
+	const char *stats_file = NULL;
+	const char *baseline_file = NULL;
+	unsigned int threshold = 10;
 	int one_boot_only = 0;
 	unsigned int rawdump_id = 0;
+	const char *binlog_elf = NULL;
+	const char *memory_file = "/dev/mem";
 
 	int opt, option_index = 0;
 	static struct option long_options[] = {
 		{"console", 0, 0, 'c'},
 		{"oneboot", 0, 0, '1'},
+		{"follow", 0, 0, 'f'},
+		{"binary-console", required_argument, 0, 'B'},
 		{"coverage", 0, 0, 'C'},
 		{"list", 0, 0, 'l'},
 		{"tcpa-log", 0, 0, 'L'},
+		{"bs-times", 0, 0, 'b'},
+		{"mem-usage", 0, 0, 'u'},
+		{"media-trace", 0, 0, 'm'},
+		{"arena", 0, 0, 'a'},
+		{"json", 0, 0, 'j'},
 		{"timestamps", 0, 0, 't'},
 		{"parseable-timestamps", 0, 0, 'T'},
+		{"trace-json", 0, 0, 'J'},
+		{"history", required_argument, 0, 'H'},
+		{"stats", required_argument, 0, 'S'},
+		{"baseline", required_argument, 0, 'R'},
+		{"threshold", required_argument, 0, 'P'},
+		{"memory-file", required_argument, 0, 'M'},
+		{"tick-freq", required_argument, 0, 'F'},
 		{"hexdump", 0, 0, 'x'},
 		{"rawdump", required_argument, 0, 'r'},
 		{"verbose", 0, 0, 'V'},
@@ -1268,7 +2694,7 @@ int main(int argc, char** argv)
 		{"help", 0, 0, 'h'},
 		{0, 0, 0, 0}
 	};
-	while ((opt = getopt_long(argc, argv, "c1CltTLxVvh?r:",
+	while ((opt = getopt_long(argc, argv, "c1fCltTJLbumajxVvh?r:B:H:S:R:P:M:F:",
 				  long_options, &option_index)) != EOF) {
 		switch (opt) {
 		case 'c':
@@ -1280,6 +2706,15 @@ int main(int argc, char** argv)
 			one_boot_only = 1;
 			print_defaults = 0;
 			break;
+		case 'f':
+			print_console = 1;
+			follow = 1;
+			print_defaults = 0;
+			break;
+		case 'B':
+			binlog_elf = optarg;
+			print_defaults = 0;
+			break;
 		case 'C':
 			print_coverage = 1;
 			print_defaults = 0;
@@ -1292,6 +2727,26 @@ int main(int argc, char** argv)
 			print_tcpa_log = 1;
 			print_defaults = 0;
 			break;
+		case 'b':
+			print_bs_times = 1;
+			print_defaults = 0;
+			break;
+		case 'u':
+			print_mem_usage = 1;
+			print_defaults = 0;
+			break;
+		case 'm':
+			print_media_trace = 1;
+			print_defaults = 0;
+			break;
+		case 'a':
+			print_arena = 1;
+			print_defaults = 0;
+			break;
+		case 'j':
+			print_json = 1;
+			print_defaults = 0;
+			break;
 		case 'x':
 			print_hexdump = 1;
 			print_defaults = 0;
@@ -1310,6 +2765,30 @@ int main(int argc, char** argv)
 			machine_readable_timestamps = 1;
 			print_defaults = 0;
 			break;
+		case 'J':
+			trace_json_timestamps = 1;
+			print_defaults = 0;
+			break;
+		case 'H':
+			history_file = optarg;
+			print_defaults = 0;
+			break;
+		case 'S':
+			stats_file = optarg;
+			print_defaults = 0;
+			break;
+		case 'R':
+			baseline_file = optarg;
+			break;
+		case 'P':
+			threshold = strtoul(optarg, NULL, 10);
+			break;
+		case 'M':
+			memory_file = optarg;
+			break;
+		case 'F':
+			forced_tick_freq_mhz = strtoul(optarg, NULL, 10);
+			break;
 		case 'V':
 			verbose = 1;
 			break;
@@ -1327,10 +2806,18 @@ int main(int argc, char** argv)
 		}
 	}
 
-	mem_fd = open("/dev/mem", O_RDONLY, 0);
+	/* The statistics only need the history files. */
+	if (stats_file) {
+		if (dump_timestamp_stats(stats_file, baseline_file, threshold))
+			return 3;
+		if (!history_file)
+			return 0;
+	}
+
+	mem_fd = open(memory_file, O_RDONLY, 0);
 	if (mem_fd < 0) {
-		fprintf(stderr, "Failed to gain memory access: %s\n",
-			strerror(errno));
+		fprintf(stderr, "Failed to gain memory access: %s: %s\n",
+			memory_file, strerror(errno));
 		return 1;
 	}
 
@@ -1400,9 +2887,18 @@ int main(int argc, char** argv)
 	if (mapping_virt(&lbtable_mapping) == NULL)
 		die("Table not found.\n");
 
+	/* Map CBMEM once; the dumps below then don't need their own maps. */
+	if (cbmem.type == LB_MEM_TABLE &&
+	    !map_memory(&cbmem_area, unpack_lb64(cbmem.start),
+			unpack_lb64(cbmem.size)))
+		debug("Could not map the CBMEM area, mapping entries one by one.\n");
+
 	if (print_console)
 		dump_console(one_boot_only);
 
+	if (binlog_elf)
+		dump_console_binlog(binlog_elf);
+
 	if (print_coverage)
 		dump_coverage();
 
@@ -1418,9 +2914,35 @@ int main(int argc, char** argv)
 	if (print_defaults || print_timestamps)
 		dump_timestamps(machine_readable_timestamps);
 
+	if (trace_json_timestamps)
+		dump_timestamps_trace_json();
+
+	if (history_file)
+		append_timestamp_history(history_file);
+
 	if (print_tcpa_log)
 		dump_tcpa_log();
 
+	if (print_bs_times)
+		dump_bs_times();
+
+	if (print_mem_usage)
+		dump_mem_usage();
+
+	if (print_media_trace)
+		dump_boot_media_trace();
+
+	if (print_arena)
+		dump_arena();
+
+	if (print_json)
+		dump_json();
+
+	/* Last, since it only returns if there is no console. */
+	if (follow)
+		follow_console();
+
+	unmap_memory(&cbmem_area);
 	unmap_memory(&lbtable_mapping);
 
 	close(mem_fd);
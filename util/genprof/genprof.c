@@ -1,7 +1,9 @@
 #include <stdio.h>
+#include <string.h>
 #include <uthash.h>
 #include <sys/gmon_out.h>
 #include <stdlib.h>
+#include <commonlib/profile_serialized.h>
 
 #define GMON_SEC "seconds        s"
 uint32_t mineip = 0xffffffff;
@@ -38,16 +40,95 @@ void note_arc(uint32_t eip, uint32_t from)
 	}
 }
 
+void write_hist_header(FILE *fo, uint32_t lowpc, uint32_t highpc,
+		       uint32_t size, uint32_t rate)
+{
+	uint32_t tmp;
+	uint8_t tag;
+
+	/* write gprof header */
+	fwrite(GMON_MAGIC, 1, sizeof(GMON_MAGIC) - 1, fo);
+	tmp = GMON_VERSION;
+	fwrite(&tmp, 1, sizeof(tmp), fo);
+	tmp = 0;
+	fwrite(&tmp, 1, sizeof(tmp), fo);
+	fwrite(&tmp, 1, sizeof(tmp), fo);
+	fwrite(&tmp, 1, sizeof(tmp), fo);
+	/* write histogram header */
+	tag = GMON_TAG_TIME_HIST;
+	fwrite(&tag, 1, sizeof(tag), fo);
+	fwrite(&lowpc, 1, sizeof(lowpc), fo);
+	fwrite(&highpc, 1, sizeof(highpc), fo);
+	/* size of histogram */
+	fwrite(&size, 1, sizeof(size), fo);
+	/* prof rate */
+	fwrite(&rate, 1, sizeof(rate), fo);
+	fwrite(GMON_SEC, 1, sizeof(GMON_SEC) - 1, fo);
+}
+
+/*
+ * Turn the sampling profiler histogram, as dumped with cbmem -r 50524f46,
+ * into a gmon.out with just the flat profile. A relocated ramstage did not
+ * run where it was linked, so text_start, the address of _program at the
+ * time, can be replaced with the one in the ELF.
+ */
+int convert_histogram(FILE *f, FILE *fo, const char *text_start)
+{
+	struct profile_histogram hist;
+	uint32_t i, count, highpc;
+	uint16_t hit;
+
+	if (fread(&hist, sizeof(hist), 1, f) != 1) {
+		fprintf(stderr, "Profile histogram is truncated\n");
+		return 1;
+	}
+
+	printf("%u samples at %u Hz, %u outside the histogram\n",
+	       hist.samples, hist.hz, hist.outside);
+
+	if (text_start)
+		hist.text_start = strtoul(text_start, NULL, 0);
+
+	highpc = hist.text_start + (hist.num_buckets << hist.shift);
+	write_hist_header(fo, hist.text_start, highpc, hist.num_buckets,
+			  hist.hz);
+
+	/* gprof counts in 16 bits */
+	for (i = 0; i < hist.num_buckets; i++) {
+		if (fread(&count, sizeof(count), 1, f) != 1) {
+			fprintf(stderr, "Profile histogram is truncated\n");
+			return 1;
+		}
+		hit = count > 0xffff ? 0xffff : count;
+		fwrite(&hit, 1, sizeof(hit), fo);
+	}
+
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
 	FILE *f, *fo;
 	struct arec *s;
-	uint32_t eip, from, tmp;
+	uint32_t eip, from;
 	uint8_t tag;
 	uint16_t hit;
+	const char *text_start = NULL;
+	int histogram = 0;
+	int ret;
+
+	if (argc >= 3 && !strcmp(argv[1], "-p")) {
+		histogram = 1;
+		if (argc == 4)
+			text_start = argv[--argc];
+		argv++;
+		argc--;
+	}
 
 	if (argc != 2) {
-		fprintf(stderr, "Please specify the coreboot trace log as parameter\n");
+		fprintf(stderr, "Please specify the coreboot trace log, or -p, "
+			"the profile histogram and optionally the link address "
+			"of _program as parameters\n");
 		return 1;
 	}
 
@@ -64,6 +145,13 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
+	if (histogram) {
+		ret = convert_histogram(f, fo, text_start);
+		fclose(fo);
+		fclose(f);
+		return ret;
+	}
+
 	while (!feof(f)) {
 		if (fscanf(f, "~%x(%x)%*[^\n]\n", &eip, &from) == 2) {
 			note_arc(eip, from);
@@ -71,30 +159,13 @@ int main(int argc, char* argv[])
 			note_arc(eip, from);
 		} else {
 			/* just drop a line */
-			tmp = fscanf(f, "%*[^\n]\n");
+			if (fscanf(f, "%*[^\n]\n") == EOF)
+				break;
 		}
 	}
 
-	/* write gprof header */
-	fwrite(GMON_MAGIC, 1, sizeof(GMON_MAGIC) - 1, fo);
-	tmp = GMON_VERSION;
-	fwrite(&tmp, 1, sizeof(tmp), fo);
-	tmp = 0;
-	fwrite(&tmp, 1, sizeof(tmp), fo);
-	fwrite(&tmp, 1, sizeof(tmp), fo);
-	fwrite(&tmp, 1, sizeof(tmp), fo);
 	/* write fake histogram */
-	tag = GMON_TAG_TIME_HIST;
-	fwrite(&tag, 1, sizeof(tag), fo);
-	fwrite(&mineip, 1, sizeof(mineip), fo);
-	fwrite(&maxeip, 1, sizeof(maxeip), fo);
-	/* size of histogram */
-	tmp = 1;
-	fwrite(&tmp, 1, sizeof(tmp), fo);
-	/* prof rate */
-	tmp = 1000;
-	fwrite(&tmp, 1, sizeof(tmp), fo);
-	fwrite(GMON_SEC, 1, sizeof(GMON_SEC) - 1, fo);
+	write_hist_header(fo, mineip, maxeip, 1, 1000);
 	hit = 1;
 	fwrite(&hit, 1, sizeof(hit), fo);
 
@@ -720,8 +720,7 @@ static void write_image(const char *filename, char *image, int size)
 	close(new_fd);
 }
 
-static void set_spi_frequency(const char *filename, char *image, int size,
-			      enum spi_frequency freq)
+static void set_spi_frequency(char *image, int size, enum spi_frequency freq)
 {
 	fcba_t *fcba = find_fcba(image, size);
 	if (!fcba)
@@ -735,11 +734,9 @@ static void set_spi_frequency(const char *filename, char *image, int size,
 	fcba->flcomp |= freq << 24;
 	/* Fast Read Clock Frequency */
 	fcba->flcomp |= freq << 21;
-
-	write_image(filename, image, size);
 }
 
-static void set_em100_mode(const char *filename, char *image, int size)
+static void set_em100_mode(char *image, int size)
 {
 	fcba_t *fcba = find_fcba(image, size);
 	if (!fcba)
@@ -760,11 +757,10 @@ static void set_em100_mode(const char *filename, char *image, int size)
 	}
 
 	fcba->flcomp &= ~(1 << 30);
-	set_spi_frequency(filename, image, size, freq);
+	set_spi_frequency(image, size, freq);
 }
 
-static void set_chipdensity(const char *filename, char *image, int size,
-                            unsigned int density)
+static void set_chipdensity(char *image, int size, unsigned int density)
 {
 	fcba_t *fcba = find_fcba(image, size);
 	if (!fcba)
@@ -813,11 +809,9 @@ static void set_chipdensity(const char *filename, char *image, int size,
 		fcba->flcomp |= (density); /* first chip */
 	if (selected_chip == 2 || selected_chip == 0)
 		fcba->flcomp |= (density << 3); /* second chip */
-
-	write_image(filename, image, size);
 }
 
-static void lock_descriptor(const char *filename, char *image, int size)
+static void lock_descriptor(char *image, int size)
 {
 	int wr_shift, rd_shift;
 	fmba_t *fmba = find_fmba(image, size);
@@ -890,11 +884,9 @@ static void lock_descriptor(const char *filename, char *image, int size)
 		fmba->flmstr3 |= 0x8 << wr_shift;
 		break;
 	}
-
-	write_image(filename, image, size);
 }
 
-static void unlock_descriptor(const char *filename, char *image, int size)
+static void unlock_descriptor(char *image, int size)
 {
 	fmba_t *fmba = find_fmba(image, size);
 	if (!fmba)
@@ -911,8 +903,6 @@ static void unlock_descriptor(const char *filename, char *image, int size)
 		/* Keep chipset specific Requester ID */
 		fmba->flmstr3 = 0x08080000 | (fmba->flmstr3 & 0xffff);
 	}
-
-	write_image(filename, image, size);
 }
 
 void inject_region(const char *filename, char *image, int size,
@@ -978,7 +968,6 @@ void inject_region(const char *filename, char *image, int size,
 
 	printf("Adding %s as the %s section of %s\n",
 	       region_fname, region_name(region_type), filename);
-	write_image(filename, image, size);
 }
 
 unsigned int next_pow2(unsigned int x)
@@ -1190,6 +1179,10 @@ static void print_usage(const char *name)
 	       "   -v | --version:                    print the version\n"
 	       "   -h | --help:                       print this help\n\n"
 	       "<region> is one of Descriptor, BIOS, ME, GbE, Platform\n"
+	       "\n"
+	       "-i, -s, -D, -e, -l and -u can be combined and -i can be given\n"
+	       "once per region. The changes are applied in that order and\n"
+	       "the new image is written once.\n"
 	       "\n");
 }
 
@@ -1201,7 +1194,13 @@ int main(int argc, char *argv[])
 	int mode_layout = 0, mode_newlayout = 0, mode_density = 0;
 	char *region_type_string = NULL, *region_fname = NULL;
 	const char *layout_fname = NULL;
-	int region_type = -1, inputfreq = 0;
+	int region_type, inputfreq = 0;
+	struct {
+		int region_type;
+		const char *region_fname;
+	} injections[MAX_REGIONS];
+	size_t num_injections = 0, i;
+	int mode_modify;
 	unsigned int new_density = 0;
 	enum spi_frequency spifreq = SPI_FREQUENCY_20MHZ;
 
@@ -1251,6 +1250,7 @@ int main(int argc, char *argv[])
 			}
 			region_fname[0] = '\0';
 			region_fname++;
+			region_type = -1;
 			// Descriptor, BIOS, ME, GbE, Platform
 			// valid type?
 			if (!strcasecmp("Descriptor", region_type_string))
@@ -1271,6 +1271,13 @@ int main(int argc, char *argv[])
 				print_usage(argv[0]);
 				exit(EXIT_FAILURE);
 			}
+			if (num_injections == ARRAY_SIZE(injections)) {
+				fprintf(stderr, "Too many regions to inject\n");
+				exit(EXIT_FAILURE);
+			}
+			injections[num_injections].region_type = region_type;
+			injections[num_injections].region_fname = region_fname;
+			num_injections++;
 			mode_inject = 1;
 			break;
 		case 'n':
@@ -1402,14 +1409,27 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if ((mode_dump + mode_layout + mode_extract + mode_inject +
-		mode_newlayout + (mode_spifreq | mode_em100 | mode_unlocked |
-		 mode_locked)) > 1) {
+	/*
+	 * Operations that modify the descriptor or inject regions can be
+	 * combined. They are applied to the image in memory in the order
+	 * below and the result is written out once.
+	 */
+	mode_modify = mode_inject | mode_spifreq | mode_em100 | mode_density |
+		      mode_locked | mode_unlocked;
+
+	if ((mode_dump + mode_layout + mode_extract + mode_newlayout +
+	     mode_modify) > 1) {
 		fprintf(stderr, "You may not specify more than one mode.\n\n");
 		print_usage(argv[0]);
 		exit(EXIT_FAILURE);
 	}
 
+	if (mode_spifreq && mode_em100) {
+		fprintf(stderr, "--spifreq and --em100 both set the SPI frequency\n\n");
+		print_usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
 	if ((mode_dump + mode_layout + mode_extract + mode_inject +
 	     mode_newlayout + mode_spifreq + mode_em100 + mode_locked +
 	     mode_unlocked + mode_density) == 0) {
@@ -1463,27 +1483,31 @@ int main(int argc, char *argv[])
 	if (mode_extract)
 		write_regions(image, size);
 
-	if (mode_inject)
-		inject_region(filename, image, size, region_type,
-				region_fname);
-
 	if (mode_newlayout)
 		new_layout(filename, image, size, layout_fname);
 
+	for (i = 0; i < num_injections; i++)
+		inject_region(filename, image, size,
+			      injections[i].region_type,
+			      injections[i].region_fname);
+
 	if (mode_spifreq)
-		set_spi_frequency(filename, image, size, spifreq);
+		set_spi_frequency(image, size, spifreq);
 
 	if (mode_density)
-		set_chipdensity(filename, image, size, new_density);
+		set_chipdensity(image, size, new_density);
 
 	if (mode_em100)
-		set_em100_mode(filename, image, size);
+		set_em100_mode(image, size);
 
 	if (mode_locked)
-		lock_descriptor(filename, image, size);
+		lock_descriptor(image, size);
 
 	if (mode_unlocked)
-		unlock_descriptor(filename, image, size);
+		unlock_descriptor(image, size);
+
+	if (mode_modify)
+		write_image(filename, image, size);
 
 	free(image);
 
@@ -68,7 +68,8 @@ static void op_write_cmos_layout_header(void);
 static int list_one_param(const char name[], int show_name);
 static int list_all_params(void);
 static void list_param_enums(const char name[]);
-static void set_one_param(const char name[], const char value[]);
+static cmos_write_t *prepare_one_param(const char name[],
+					const char value[]);
 static void set_params(FILE * f);
 static void parse_assignment(char arg[], const char **name, const char **value);
 static int list_cmos_entry(const cmos_entry_t * e, int show_name);
@@ -302,22 +303,33 @@ static void op_cmos_show_all_params(void)
 /****************************************************************************
  * op_cmos_set_one_param
  *
- * -w NAME=VALUE
+ * -w NAME=VALUE [-w NAME=VALUE ...]
  *
- * Set parameter NAME to VALUE.
+ * Set parameter NAME to VALUE.  Like with -p, all assignments are checked
+ * before any of them is performed, and the checksum is updated once.
  ****************************************************************************/
 static void op_cmos_set_one_param(void)
 {
 	const char *name, *value;
+	cmos_write_t *list, **p;
+	int i;
 
 	get_cmos_layout();
 
-	/* Separate 'NAME=VALUE' syntax into two strings representing NAME and
-	 * VALUE.
-	 */
-	parse_assignment(nvramtool_op.param, &name, &value);
+	list = NULL;
+	p = &list;
+
+	for (i = 0; i < nvramtool_num_assignments; i++) {
+		/* Separate 'NAME=VALUE' syntax into two strings representing
+		 * NAME and VALUE.
+		 */
+		parse_assignment(nvramtool_assignments[i], &name, &value);
+
+		*p = prepare_one_param(name, value);
+		p = &(*p)->next;
+	}
 
-	set_one_param(name, value);
+	do_cmos_writes(list);
 }
 
 /****************************************************************************
@@ -596,19 +608,21 @@ static void list_param_enums(const char name[])
 }
 
 /****************************************************************************
- * set_one_param
- *
- * Set the CMOS parameter given by 'name' to 'value'.  The 'name' parameter
- * is case-sensitive.  If we are setting an enum parameter, then 'value' is
- * interpreted as a case-sensitive string that must match the option name
- * exactly.  If we are setting a 'hex' parameter, then 'value' is treated as
- * a string representation of an unsigned integer that may be specified in
- * decimal, hex, or octal.
+ * prepare_one_param
+ *
+ * Check setting the CMOS parameter given by 'name' to 'value' and return the
+ * pending write operation.  The 'name' parameter is case-sensitive.  If we
+ * are setting an enum parameter, then 'value' is interpreted as a
+ * case-sensitive string that must match the option name exactly.  If we are
+ * setting a 'hex' parameter, then 'value' is treated as a string
+ * representation of an unsigned integer that may be specified in decimal,
+ * hex, or octal.  On error, exit with an error message.
  ****************************************************************************/
-static void set_one_param(const char name[], const char value[])
+static cmos_write_t *prepare_one_param(const char name[], const char value[])
 {
 	const cmos_entry_t *e;
 	unsigned long long n;
+	cmos_write_t *item;
 
 	if (is_checksum_name(name) || (e = find_cmos_entry(name)) == NULL) {
 		fprintf(stderr, "%s: CMOS parameter %s not found.\n", prog_name,
@@ -682,12 +696,15 @@ static void set_one_param(const char name[], const char value[])
 		goto fail;
 	}
 
-	/* write the value to nonvolatile RAM */
-	set_iopl(3);
-	cmos_write(e, n);
-	cmos_checksum_write(cmos_checksum_compute());
-	set_iopl(0);
-	return;
+	if ((item = (cmos_write_t *) malloc(sizeof(*item))) == NULL)
+		out_of_memory();
+
+	item->bit = e->bit;
+	item->length = e->length;
+	item->config = e->config;
+	item->value = n;
+	item->next = NULL;
+	return item;
 
       fail:
 	fprintf(stderr, "  CMOS write not performed.\n");
@@ -29,6 +29,9 @@
 
 nvramtool_op_info_t nvramtool_op;
 
+char **nvramtool_assignments;
+int nvramtool_num_assignments;
+
 nvramtool_op_modifier_info_t nvramtool_op_modifiers[NVRAMTOOL_NUM_OP_MODIFIERS];
 
 static char *handle_optional_arg(int argc, char *argv[]);
@@ -132,6 +135,13 @@ void parse_nvramtool_args(int argc, char *argv[])
 		case 'w':
 			register_op(&op_found, NVRAMTOOL_OP_CMOS_SET_ONE_PARAM,
 				    optarg);
+			nvramtool_assignments = realloc(nvramtool_assignments,
+				(nvramtool_num_assignments + 1) *
+				sizeof(*nvramtool_assignments));
+			if (nvramtool_assignments == NULL)
+				out_of_memory();
+			nvramtool_assignments[nvramtool_num_assignments++] =
+				optarg;
 			break;
 		case 'x':
 			register_op(&op_found, NVRAMTOOL_OP_SHOW_CMOS_HEX_DUMP,
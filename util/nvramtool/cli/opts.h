@@ -70,6 +70,10 @@ typedef struct {
 
 extern nvramtool_op_info_t nvramtool_op;
 
+/* The NAME=VALUE arguments of all -w options, in command line order. */
+extern char **nvramtool_assignments;
+extern int nvramtool_num_assignments;
+
 extern nvramtool_op_modifier_info_t nvramtool_op_modifiers[];
 
 void parse_nvramtool_args(int argc, char *argv[]);
@@ -42,6 +42,11 @@ static cmos_access_t *current_access =
 	&memory_hal;
 #endif
 
+/* While a shadow is active, byte accesses go to this copy of CMOS. */
+static unsigned char cmos_shadow[CMOS_SIZE];
+static unsigned char cmos_shadow_orig[CMOS_SIZE];
+static int cmos_shadow_active;
+
 void select_hal(hal_t hal, void *data)
 {
 	switch(hal) {
@@ -210,6 +215,9 @@ void cmos_write(const cmos_entry_t * e, unsigned long long value)
  ****************************************************************************/
 unsigned char cmos_read_byte(unsigned index)
 {
+	if (cmos_shadow_active)
+		return cmos_shadow[index];
+
 	return current_access->read(index);
 }
 
@@ -225,6 +233,11 @@ unsigned char cmos_read_byte(unsigned index)
  ****************************************************************************/
 void cmos_write_byte(unsigned index, unsigned char value)
 {
+	if (cmos_shadow_active) {
+		cmos_shadow[index] = value;
+		return;
+	}
+
 	current_access->write(index, value);
 }
 
@@ -260,6 +273,40 @@ void cmos_write_all(unsigned char data[])
 		cmos_write_byte(i, data[i]);
 }
 
+/****************************************************************************
+ * cmos_shadow_begin
+ *
+ * Read all of CMOS memory once into a shadow copy.  Until
+ * cmos_shadow_commit() is called, all reads and writes operate on that copy
+ * instead of on the hardware.  The I/O privilege level of the currently
+ * executing process must be set appropriately.
+ ****************************************************************************/
+void cmos_shadow_begin(void)
+{
+	assert(!cmos_shadow_active);
+	cmos_read_all(cmos_shadow);
+	memcpy(cmos_shadow_orig, cmos_shadow, sizeof(cmos_shadow));
+	cmos_shadow_active = 1;
+}
+
+/****************************************************************************
+ * cmos_shadow_commit
+ *
+ * Write the bytes of the shadow copy that were changed since
+ * cmos_shadow_begin() back to CMOS memory and stop using the shadow copy.
+ ****************************************************************************/
+void cmos_shadow_commit(void)
+{
+	unsigned i;
+
+	assert(cmos_shadow_active);
+	cmos_shadow_active = 0;
+
+	for (i = CMOS_RTC_AREA_SIZE; i < CMOS_SIZE; i++)
+		if (cmos_shadow[i] != cmos_shadow_orig[i])
+			cmos_write_byte(i, cmos_shadow[i]);
+}
+
 /****************************************************************************
  * set_iopl
  *
@@ -50,6 +50,8 @@ unsigned char cmos_read_byte(unsigned index);
 void cmos_write_byte(unsigned index, unsigned char value);
 void cmos_read_all(unsigned char data[]);
 void cmos_write_all(unsigned char data[]);
+void cmos_shadow_begin(void);
+void cmos_shadow_commit(void);
 void set_iopl(int level);
 int verify_cmos_op(unsigned bit, unsigned length, cmos_entry_config_t config);
 
@@ -86,7 +86,8 @@ void usage(FILE * outfile)
 		"NAME.\n"
 		"       -a:             Show names and values for all "
 		"parameters.\n"
-		"       -w NAME=VALUE:  Set parameter NAME to VALUE.\n"
+		"       -w NAME=VALUE:  Set parameter NAME to VALUE.  May be given\n"
+		"                       more than once.\n"
 		"       -p INPUT_FILE:  Set parameters according to INPUT_FILE.\n"
 		"       -i:             Same as -p but file contents taken from "
 		"standard input.\n"
@@ -148,13 +148,16 @@ cmos_write_t *process_input_file(FILE * f)
  *
  * 'list' is a linked list of pending CMOS write operations that have passed
  * all sanity checks.  Perform all write operations, destroying the list as
- * we go.
+ * we go.  CMOS memory is read once, the writes and the new checksum are
+ * applied to a shadow copy, and only the bytes that changed are written
+ * back.
  ****************************************************************************/
 void do_cmos_writes(cmos_write_t * list)
 {
 	cmos_write_t *item;
 
 	set_iopl(3);
+	cmos_shadow_begin();
 
 	while (list != NULL) {
 		cmos_entry_t e;
@@ -168,6 +171,7 @@ void do_cmos_writes(cmos_write_t * list)
 	}
 
 	cmos_checksum_write(cmos_checksum_compute());
+	cmos_shadow_commit();
 	set_iopl(0);
 }
 
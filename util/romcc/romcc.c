@@ -1116,6 +1116,7 @@ struct compile_state {
 	struct triple *global_pool;
 	struct basic_blocks bb;
 	int functions_joined;
+	clock_t pass_start;
 };
 
 /* visibility global/local */
@@ -1353,6 +1354,7 @@ static void print_dominance_frontiers(struct compile_state *state,
 #define DEBUG_VERIFICATION	0x00010000
 #define DEBUG_CALLS		0x00020000
 #define DEBUG_CALLS2		0x00040000
+#define DEBUG_PASS_TIMES	0x00080000
 #define DEBUG_TOKENS            0x80000000
 
 #define DEBUG_DEFAULT ( \
@@ -1648,6 +1650,7 @@ static const struct compiler_flag romcc_debug_flags[] = {
 	{ "verification",          DEBUG_VERIFICATION },
 	{ "calls",                 DEBUG_CALLS },
 	{ "calls2",                DEBUG_CALLS2 },
+	{ "pass-times",            DEBUG_PASS_TIMES },
 	{ "tokens",                DEBUG_TOKENS },
 	{ 0, 0 },
 };
@@ -17514,16 +17517,19 @@ static int phi_in(struct compile_state *state, struct reg_block *blocks,
 }
 
 static int reg_in(struct compile_state *state, struct reg_block *blocks,
-	struct reg_block *rb, struct block *suc)
+	struct reg_block *rb, struct block *suc,
+	struct triple_reg_set *seen, int first_visit)
 {
 	struct triple_reg_set *in_set;
 	int change;
 	change = 0;
 	/* Read the input set of a successor block
 	 * and place it in the current blocks output set.
+	 * Sets only grow at their head, so everything from seen
+	 * on was already propagated along this edge.
 	 */
 	in_set = blocks[suc->vertex].in;
-	for(; in_set; in_set = in_set->next) {
+	for(; in_set != seen; in_set = in_set->next) {
 		int out_change, done;
 		struct triple *first, *last, *ptr;
 		out_change = out_triple(rb, in_set->member);
@@ -17547,7 +17553,10 @@ static int reg_in(struct compile_state *state, struct reg_block *blocks,
 		}
 		change |= in_triple(rb, in_set->member);
 	}
-	change |= phi_in(state, blocks, rb, suc);
+	/* The phi inputs of an edge are the same every time. */
+	if (first_visit) {
+		change |= phi_in(state, blocks, rb, suc);
+	}
 	return change;
 }
 
@@ -17605,25 +17614,57 @@ static struct reg_block *compute_variable_lifetimes(
 	struct compile_state *state, struct basic_blocks *bb)
 {
 	struct reg_block *blocks;
-	int change;
+	struct triple_reg_set **seen;
+	int *first_edge;
+	int change, pass, edges, i;
 	blocks = xcmalloc(
 		sizeof(*blocks)*(bb->last_vertex + 1), "reg_block");
 	initialize_regblock(blocks, bb->last_block, 0);
+
+	/* For every control flow edge remember the head of the
+	 * successor's input set when it was last propagated.
+	 */
+	first_edge = xcmalloc(
+		sizeof(*first_edge)*(bb->last_vertex + 1), "first_edge");
+	edges = 0;
+	for(i = 1; i <= bb->last_vertex; i++) {
+		struct block_set *edge;
+		first_edge[i] = edges;
+		for(edge = blocks[i].block->edges; edge; edge = edge->next) {
+			edges++;
+		}
+	}
+	seen = xcmalloc(sizeof(*seen)*(edges + 1), "seen");
+
+	pass = 0;
 	do {
-		int i;
 		change = 0;
 		for(i = 1; i <= bb->last_vertex; i++) {
 			struct block_set *edge;
 			struct reg_block *rb;
+			int e;
 			rb = &blocks[i];
 			/* Add the all successor's input set to in */
-			for(edge = rb->block->edges; edge; edge = edge->next) {
-				change |= reg_in(state, blocks, rb, edge->member);
+			for(e = first_edge[i], edge = rb->block->edges; edge;
+			    e++, edge = edge->next) {
+				struct triple_reg_set *head;
+				head = blocks[edge->member->vertex].in;
+				change |= reg_in(state, blocks, rb,
+					edge->member, seen[e], pass == 0);
+				seen[e] = head;
+			}
+			/* Add use to in... The uses of a block don't
+			 * change, so only the first pass can add any.
+			 */
+			if (pass == 0) {
+				change |= use_in(state, rb);
 			}
-			/* Add use to in... */
-			change |= use_in(state, rb);
 		}
+		pass++;
 	} while(change);
+
+	xfree(seen);
+	xfree(first_edge);
 	return blocks;
 }
 
@@ -17672,11 +17713,16 @@ static void walk_variable_lifetimes(struct compile_state *state,
 		rb = &blocks[i];
 		block = rb->block;
 
-		/* Copy out into live */
+		/* Copy out into live.  out has no duplicates, so
+		 * the membership check of do_triple_set() can be skipped.
+		 */
 		live = 0;
-		for(entry = rb->out; entry; entry = next) {
-			next = entry->next;
-			do_triple_set(&live, entry->member, entry->new);
+		for(entry = rb->out; entry; entry = entry->next) {
+			next = xcmalloc(sizeof(*next), "triple_set");
+			next->member = entry->member;
+			next->new    = entry->new;
+			next->next   = live;
+			live         = next;
 		}
 		/* Walk through the basic block calculating live */
 		for(done = 0, ptr = block->last; !done; ptr = prev) {
@@ -18194,6 +18240,9 @@ struct live_range_def {
 	unsigned orig_id;
 };
 
+/* Minimum size of the interference edge hash; it grows with the
+ * number of live ranges so the chains stay short.
+ */
 #define LRE_HASH_SIZE 2048
 struct lre_hash {
 	struct lre_hash *next;
@@ -18203,7 +18252,8 @@ struct lre_hash {
 
 
 struct reg_state {
-	struct lre_hash *hash[LRE_HASH_SIZE];
+	struct lre_hash **hash;
+	unsigned hash_size;
 	struct reg_block *blocks;
 	struct live_range_def *lrd;
 	struct live_range *lr;
@@ -18430,7 +18480,6 @@ static unsigned int hash_live_edge(
 		rval >>= 8;
 		hash = (hash *263) + val;
 	}
-	hash = hash & (LRE_HASH_SIZE - 1);
 	return hash;
 }
 
@@ -18446,7 +18495,7 @@ static struct lre_hash **lre_probe(struct reg_state *rstate,
 		left = right;
 		right = tmp;
 	}
-	index = hash_live_edge(left, right);
+	index = hash_live_edge(left, right) & (rstate->hash_size - 1);
 
 	ptr = &rstate->hash[index];
 	while(*ptr) {
@@ -18548,15 +18597,6 @@ static void remove_live_edge(struct reg_state *rstate,
 	}
 }
 
-static void remove_live_edges(struct reg_state *rstate, struct live_range *range)
-{
-	struct live_range_edge *edge, *next;
-	for(edge = range->edges; edge; edge = next) {
-		next = edge->next;
-		remove_live_edge(rstate, range, edge->node);
-	}
-}
-
 static void transfer_live_edges(struct reg_state *rstate,
 	struct live_range *dest, struct live_range *src)
 {
@@ -20034,10 +20074,40 @@ static void ids_from_rstate(struct compile_state *state,
 
 static void cleanup_live_edges(struct reg_state *rstate)
 {
-	int i;
-	/* Free the edges on each node */
+	unsigned i;
+	/* Free the edges on each node.  Everything goes, so there
+	 * is no need to unlink the edges one by one.
+	 */
 	for(i = 1; i <= rstate->ranges; i++) {
-		remove_live_edges(rstate, &rstate->lr[i]);
+		struct live_range_edge *edge, *next;
+		for(edge = rstate->lr[i].edges; edge; edge = next) {
+			next = edge->next;
+			xfree(edge);
+		}
+		rstate->lr[i].edges = 0;
+		rstate->lr[i].degree = 0;
+	}
+	for(i = 0; i < rstate->hash_size; i++) {
+		struct lre_hash *entry, *next;
+		for(entry = rstate->hash[i]; entry; entry = next) {
+			next = entry->next;
+			xfree(entry);
+		}
+		rstate->hash[i] = 0;
+	}
+}
+
+static void size_live_edge_hash(struct reg_state *rstate)
+{
+	unsigned size;
+	size = LRE_HASH_SIZE;
+	while(size < rstate->ranges * 4) {
+		size <<= 1;
+	}
+	if (size != rstate->hash_size) {
+		xfree(rstate->hash);
+		rstate->hash = xcmalloc(sizeof(*rstate->hash) * size, "lre_hash");
+		rstate->hash_size = size;
 	}
 }
 
@@ -20107,6 +20177,7 @@ static void allocate_registers(struct compile_state *state)
 
 		/* Allocate and initialize the live ranges */
 		initialize_live_ranges(state, &rstate);
+		size_live_edge_hash(&rstate);
 
 		/* Note currently doing coalescing in a loop appears to
 		 * buys me nothing.  The code is left this way in case
@@ -20215,6 +20286,7 @@ static void allocate_registers(struct compile_state *state)
 
 	/* Cleanup the temporary data structures */
 	cleanup_rstate(state, &rstate);
+	xfree(rstate.hash);
 
 	/* Display the new graph */
 	print_blocks(state, __func__, state->dbgout);
@@ -21568,10 +21640,23 @@ static void verify_consistency(struct compile_state *state)
 static void verify_consistency(struct compile_state *state) {}
 #endif /* DEBUG_CONSISTENCY */
 
+static void pass_time(struct compile_state *state, const char *pass)
+{
+	clock_t now;
+	if (!(state->compiler->debug & DEBUG_PASS_TIMES)) {
+		return;
+	}
+	now = clock();
+	fprintf(state->errout, "pass %-32s %8.3fs\n", pass,
+		(double)(now - state->pass_start) / CLOCKS_PER_SEC);
+	state->pass_start = now;
+}
+
 static void optimize(struct compile_state *state)
 {
 	/* Join all of the functions into one giant function */
 	join_functions(state);
+	pass_time(state, "join_functions");
 
 	/* Dump what the instruction graph intially looks like */
 	print_triples(state);
@@ -21579,11 +21664,13 @@ static void optimize(struct compile_state *state)
 	/* Replace structures with simpler data types */
 	decompose_compound_types(state);
 	print_triples(state);
+	pass_time(state, "decompose_compound_types");
 
 	verify_consistency(state);
 	/* Analyze the intermediate code */
 	state->bb.first = state->first;
 	analyze_basic_blocks(state, &state->bb);
+	pass_time(state, "analyze_basic_blocks");
 
 	/* Transform the code to ssa form. */
 	/*
@@ -21596,17 +21683,21 @@ static void optimize(struct compile_state *state)
 	 */
 	transform_to_ssa_form(state);
 	verify_consistency(state);
+	pass_time(state, "transform_to_ssa_form");
 
 	/* Remove dead code */
 	eliminate_inefectual_code(state);
 	verify_consistency(state);
+	pass_time(state, "eliminate_inefectual_code");
 
 	/* Do strength reduction and simple constant optimizations */
 	simplify_all(state);
 	verify_consistency(state);
+	pass_time(state, "simplify_all");
 	/* Propogate constants throughout the code */
 	scc_transform(state);
 	verify_consistency(state);
+	pass_time(state, "scc_transform");
 #if DEBUG_ROMCC_WARNINGS
 #warning "WISHLIST implement single use constants (least possible register pressure)"
 #warning "WISHLIST implement induction variable elimination"
@@ -21616,20 +21707,25 @@ static void optimize(struct compile_state *state)
 	 */
 	transform_to_arch_instructions(state);
 	verify_consistency(state);
+	pass_time(state, "transform_to_arch_instructions");
 
 	/* Remove dead code */
 	eliminate_inefectual_code(state);
 	verify_consistency(state);
+	pass_time(state, "eliminate_inefectual_code");
 
 	/* Color all of the variables to see if they will fit in registers */
 	insert_copies_to_phi(state);
 	verify_consistency(state);
+	pass_time(state, "insert_copies_to_phi");
 
 	insert_mandatory_copies(state);
 	verify_consistency(state);
+	pass_time(state, "insert_mandatory_copies");
 
 	allocate_registers(state);
 	verify_consistency(state);
+	pass_time(state, "allocate_registers");
 
 	/* Remove the optimization information.
 	 * This is more to check for memory consistency than to free memory.
@@ -24955,6 +25051,7 @@ static void compile(const char *filename,
 	/* Make certain a good cleanup happens */
 	exit_state = &state;
 	atexit(exit_cleanup);
+	state.pass_start = clock();
 
 	/* Prep the preprocessor */
 	state.if_depth = 0;
@@ -25023,6 +25120,7 @@ static void compile(const char *filename,
 
 	/* Exit the global definition scope */
 	end_scope(&state);
+	pass_time(&state, "parse");
 
 	/* Now that basic compilation has happened
 	 * optimize the intermediate code
@@ -25030,6 +25128,7 @@ static void compile(const char *filename,
 	optimize(&state);
 
 	generate_code(&state);
+	pass_time(&state, "generate_code");
 	if (state.compiler->debug) {
 		fprintf(state.errout, "done\n");
 	}
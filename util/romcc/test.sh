@@ -48,6 +48,8 @@ usage () {
 	echo "  all     - all tests"
 	echo "  simple  - simple tests"
 	echo "  linux   - linux programs whose output is checked against a reference"
+	echo "  compare - check that the generated assembly is identical to the"
+	echo "            output of the romcc binary named by \$ROMCC_REF"
 	echo ""
 	echo "--nocolor disables colors."
 	exit 1
@@ -195,6 +197,60 @@ run_linux_tests() {
 
 	echo
 }
+run_compare_test() {
+	rm -f "$BUILDDIR/ref.S" "$BUILDDIR/new.S"
+	# TODO: "timeout" is not POSIX compliant. Use something that is.
+	timeout 60 "$ROMCC_REF" $1 "$2" -o "$BUILDDIR/ref.S"
+	local ref=$?
+	timeout 60 "$ROMCC" $1 "$2" -o "$BUILDDIR/new.S"
+	local new=$?
+
+	[ $ref -eq $new ] || return 1
+	if [ -f "$BUILDDIR/ref.S" -o -f "$BUILDDIR/new.S" ]; then
+		cmp "$BUILDDIR/ref.S" "$BUILDDIR/new.S" || return 1
+	fi
+}
+
+run_compare_tests() {
+	echo "Comparing output against $ROMCC_REF..."
+
+	if [ ! -x "$ROMCC_REF" ]; then
+		echo "Please set ROMCC_REF to a reference romcc binary."
+		exit 1
+	fi
+
+	local t
+	for t in $(find "$BASEDIR/tests" -name '*_test*.c'); do
+		printf "%s" "$(basename "$t")"
+
+		local result=pass
+		local logfile="$LOGDIR/$(basename "$t").compare.log"
+		rm "$logfile" >/dev/null 2>&1
+		for opt in "" "-O" "-O2" "-O2 -mmmx -msse"; do
+			if run_compare_test "$opt" "$t" \
+					>> "$logfile" 2>&1; then
+				printf .
+			else
+				echo "options: $opt" >> "$logfile"
+				result=fail
+				break
+			fi
+		done
+		printf " "
+		# A difference is never expected, known broken or not.
+		NUM_TOTAL=$((NUM_TOTAL + 1))
+		if [ $result = pass ]; then
+			NUM_PASS=$((NUM_PASS + 1))
+			green "identical"
+		else
+			NUM_FAIL=$((NUM_FAIL + 1))
+			red "differs"
+		fi
+		echo
+	done
+
+	echo
+}
 
 
 if [ $# -ne 1 ]; then
@@ -220,6 +276,11 @@ case "$CLASS" in
 		run_linux_tests
 		show_stats
 		;;
+	compare)
+		init_testing
+		run_compare_tests
+		show_stats
+		;;
 	*)
 		echo "Invalid test class $CLASS"
 		echo
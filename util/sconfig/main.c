@@ -33,6 +33,9 @@ static struct chip chip_header;
  */
 static int count = 0;
 
+/* Number of device slots on a PCI bus. */
+#define PCI_SLOTS 32
+
 typedef enum {
 	UNSLASH,
 	SPLIT_1ST,
@@ -873,6 +876,56 @@ static void walk_device_tree(FILE *fil, struct device *ptr,
 	}
 }
 
+/* PCI devices in the order they appear on the all_devices list. */
+static struct queue_entry *pci_q_head;
+
+static void collect_pci_devs(FILE *fil, struct device *ptr,
+			     struct device *next)
+{
+	if (ptr->bustype == PCI)
+		enqueue_tail(&pci_q_head, ptr);
+}
+
+static void emit_pci_lookup(FILE *fil, struct device *root)
+{
+	struct queue_entry *q;
+	int index[PCI_SLOTS + 1];
+	int slot, num = 0;
+
+	walk_device_tree(fil, root, collect_pci_devs);
+
+	/*
+	 * Static PCI devices bucketed by slot, keeping the list order within
+	 * a bucket. The devices of slot s are static_pci_devs[index[s]] up to
+	 * static_pci_devs[index[s + 1]].
+	 */
+	fprintf(fil,
+		"DEVTREE_CONST struct device * const static_pci_devs[] = {\n");
+	for (slot = 0; slot < PCI_SLOTS; slot++) {
+		index[slot] = num;
+		q = pci_q_head;
+		while (q) {
+			struct device *dev = q->data;
+
+			if ((dev->path_a & (PCI_SLOTS - 1)) == slot) {
+				fprintf(fil, "\t&%s,\n", dev->name);
+				num++;
+			}
+			q = q->next == pci_q_head ? NULL : q->next;
+		}
+	}
+	index[PCI_SLOTS] = num;
+	fprintf(fil, "\tNULL\n};\n");
+
+	fprintf(fil, "const uint16_t static_pci_slot_index[] = {");
+	for (slot = 0; slot <= PCI_SLOTS; slot++)
+		fprintf(fil, "%s%d", slot ? ", " : "", index[slot]);
+	fprintf(fil, "};\n");
+
+	while (dequeue_head(&pci_q_head))
+		;
+}
+
 static void emit_chip_headers(FILE *fil, struct chip *chip)
 {
 	struct chip *tmp = chip;
@@ -993,6 +1046,61 @@ static void parse_devicetree(const char *file, struct bus *parent)
 	fclose(filec);
 }
 
+/*
+ * Copy the output collected in tmp to file, unless file already has exactly
+ * that content. Leaving an unchanged file alone keeps its timestamp, so make
+ * doesn't rebuild everything that depends on it.
+ */
+static void write_if_changed(FILE *tmp, const char *file)
+{
+	char new_buf[4096], old_buf[4096];
+	size_t new_len, old_len;
+	int changed = 0;
+	FILE *old;
+
+	rewind(tmp);
+	old = fopen(file, "rb");
+	if (!old) {
+		changed = 1;
+	} else {
+		do {
+			new_len = fread(new_buf, 1, sizeof(new_buf), tmp);
+			old_len = fread(old_buf, 1, sizeof(old_buf), old);
+			if (new_len != old_len ||
+			    memcmp(new_buf, old_buf, new_len)) {
+				changed = 1;
+				break;
+			}
+		} while (new_len);
+		fclose(old);
+	}
+
+	if (!changed)
+		return;
+
+	FILE *out = fopen(file, "wb");
+	if (!out) {
+		fprintf(stderr, "Could not open file '%s' for writing: ",
+			file);
+		perror(NULL);
+		exit(1);
+	}
+
+	rewind(tmp);
+	while ((new_len = fread(new_buf, 1, sizeof(new_buf), tmp)))
+		if (fwrite(new_buf, 1, new_len, out) != new_len) {
+			fprintf(stderr, "Could not write file '%s': ", file);
+			perror(NULL);
+			exit(1);
+		}
+
+	if (fclose(out)) {
+		fprintf(stderr, "Could not write file '%s': ", file);
+		perror(NULL);
+		exit(1);
+	}
+}
+
 /*
  * Match device nodes from base and override tree to see if they are the same
  * node.
@@ -1317,10 +1425,9 @@ int main(int argc, char **argv)
 		override_devicetree(&base_root_bus, &override_root_bus);
 	}
 
-	FILE *autogen = fopen(outputc, "w");
+	FILE *autogen = tmpfile();
 	if (!autogen) {
-		fprintf(stderr, "Could not open file '%s' for writing: ",
-			outputc);
+		fprintf(stderr, "Could not create temporary file: ");
 		perror(NULL);
 		exit(1);
 	}
@@ -1332,7 +1439,10 @@ int main(int argc, char **argv)
 	walk_device_tree(autogen, &base_root_dev, pass0);
 	fprintf(autogen, "\n/* pass 1 */\n");
 	walk_device_tree(autogen, &base_root_dev, pass1);
+	fprintf(autogen, "\n/* lookup tables */\n");
+	emit_pci_lookup(autogen, &base_root_dev);
 
+	write_if_changed(autogen, outputc);
 	fclose(autogen);
 
 	return 0;
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# This file is part of the coreboot project.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# Lists the functions a console log of a TRACE build enters, most calls
+# first, in the format of ROMSTAGE_HOT_FUNCTIONS_FILE.
+#
+# $1 stage ELF with symbols, e.g. build/cbfs/fallback/romstage.debug
+# $2 console log
+# $3 optional number of functions to list
+# result on stdout
+set -e
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 stage.debug console-log [count]"
+	exit 1
+fi
+
+NM=${NM:-nm}
+COUNT=${3:-0}
+
+# Both sides zero pad their addresses, to different widths.
+{
+	"$NM" "$1" | awk '$2 ~ /^[tTwW]$/ {
+		sub(/^0+/, "", $1)
+		print "sym", ($1 == "" ? "0" : $1), $3
+	}'
+	sed -n 's/.*~0x\([0-9a-fA-F]*\)(.*/\1/p' "$2" | tr 'A-F' 'a-f' |
+		sed 's/^0*\(.\)/\1/' | sort | uniq -c |
+		awk '{ print "call", $2, $1 }'
+} | awk '
+	$1 == "sym" { name[$2] = $3; next }
+	$1 == "call" && ($2 in name) { print $3, name[$2] }
+' | sort -k1,1nr -k2 | awk -v count="$COUNT" '
+	count && NR > count { exit }
+	{ print $2 "\t# " $1 " calls" }
+'
@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# This file is part of the coreboot project.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# Lists the size of every section of a stage that takes up memory, and of
+# the heap, stack and program regions the linker script reserves.
+#
+# $1 readelf
+# $2 nm
+# $3 stage ELF
+# result on stdout
+
+READELF="$1"
+NM="$2"
+ELF="$3"
+
+if [ -z "$ELF" ]; then
+	echo "usage: $0 READELF NM ELF" >&2
+	exit 1
+fi
+
+# Plain awk has no strtonum().
+HEX='function hex(s,  i, n) {
+	n = 0
+	s = tolower(s)
+	for (i = 1; i <= length(s); i++)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}'
+
+echo "# section size"
+# "[Nr] Name Type Address Off Size ES Flg ...", only the allocated ones.
+LC_ALL=C "$READELF" -S -W "$ELF" | sed -e 's/^ *\[ *[0-9]*\] *//' | \
+	awk "$HEX"'$1 ~ /^\./ && $7 ~ /A/ { printf "%-24s %d\n", $1, hex($5) }'
+
+echo "# region size"
+"$NM" "$ELF" | awk "$HEX"'
+	{ addr[$3] = $1 }
+	END {
+		split("heap stack program", regions, " ")
+		for (i = 1; i <= 3; i++) {
+			start = "_" regions[i]
+			end = "_e" regions[i]
+			if (start in addr && end in addr)
+				printf "%-24s %d\n", regions[i],
+					hex(addr[end]) - hex(addr[start])
+		}
+	}'
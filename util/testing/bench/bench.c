@@ -0,0 +1,411 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Times the firmware's CBFS, decompression, region device, mem_pool, IMD and
+ * memrange code on the host, against the CBFS of a real image. Every result
+ * is one CSV line: benchmark,ops,ns_per_op,mb_per_s (the latter empty where
+ * no data moves), so runs before and after a change can be compared with
+ * any spreadsheet or a bit of awk.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cbmem.h>
+#include <commonlib/cbfs.h>
+#include <commonlib/cbfs_serialized.h>
+#include <commonlib/compression.h>
+#include <commonlib/endian.h>
+#include <commonlib/fmap_serialized.h>
+#include <commonlib/mem_pool.h>
+#include <commonlib/region.h>
+#include <imd.h>
+#include <lib.h>
+#include <memrange.h>
+
+#include "bench.h"
+
+#define MAX_FILES	1024
+
+#define READ_CHUNK	(4 * KiB)
+
+#define IMD_SIZE	(4 * MiB)
+#define IMD_ENTRIES	32
+
+#define MEMRANGES	64
+
+static struct mem_region_device image;
+static struct region_device cbfs;
+
+static char *names[MAX_FILES];
+static size_t num_names;
+
+/* memrange.c wants this for memranges_init(), which isn't benchmarked. */
+void search_global_resources(unsigned long type_mask, unsigned long type,
+			     resource_search_t search, void *gp)
+{
+}
+
+static void *read_file(const char *name, size_t *size)
+{
+	FILE *f = fopen(name, "rb");
+	void *data;
+	long len;
+
+	if (!f)
+		return NULL;
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(len);
+	if (data && fread(data, len, 1, f) != 1) {
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	*size = len;
+	return data;
+}
+
+/* Point cbfs at the COREBOOT area of the FMAP, or the whole image. */
+static int find_cbfs(const uint8_t *data, size_t size)
+{
+	const struct region_device *rdev = &image.rdev;
+	size_t offset;
+
+	for (offset = 0; offset + sizeof(struct fmap) <= size; offset += 16) {
+		const struct fmap *fmap = (const void *)(data + offset);
+		size_t i;
+
+		if (memcmp(fmap->signature, FMAP_SIGNATURE,
+			   sizeof(fmap->signature)))
+			continue;
+		if (offset + sizeof(*fmap) +
+		    fmap->nareas * sizeof(fmap->areas[0]) > size)
+			continue;
+
+		for (i = 0; i < fmap->nareas; i++) {
+			const struct fmap_area *area = &fmap->areas[i];
+
+			if (strncmp((const char *)area->name, "COREBOOT",
+				    FMAP_STRLEN))
+				continue;
+			return rdev_chain(&cbfs, rdev, area->offset,
+					  area->size);
+		}
+	}
+
+	return rdev_chain(&cbfs, rdev, 0, size);
+}
+
+static int collect_names(void)
+{
+	struct cbfsf fh;
+	struct cbfsf *prev = NULL;
+	int ret;
+
+	while ((ret = cbfs_for_each_file(&cbfs, prev, &fh)) == 0) {
+		size_t len = region_device_sz(&fh.metadata);
+		char *metadata = rdev_mmap_full(&fh.metadata);
+
+		prev = &fh;
+		if (!metadata)
+			return -1;
+		if (num_names < MAX_FILES &&
+		    len > sizeof(struct cbfs_file))
+			names[num_names++] = strndup(
+				metadata + sizeof(struct cbfs_file),
+				len - sizeof(struct cbfs_file));
+		rdev_munmap(&fh.metadata, metadata);
+	}
+
+	return ret < 0 ? -1 : 0;
+}
+
+static size_t next_name;
+
+static int op_cbfs_locate(void *arg)
+{
+	struct cbfsf fh;
+
+	next_name = (next_name + 1) % num_names;
+	return cbfs_locate(&fh, &cbfs, names[next_name], NULL);
+}
+
+static int op_cbfs_index_locate(void *arg)
+{
+	struct cbfsf fh;
+
+	next_name = (next_name + 1) % num_names;
+	return cbfs_index_locate(arg, &fh, &cbfs, names[next_name], NULL);
+}
+
+static int op_cbfs_index_build(void *arg)
+{
+	return cbfs_index_build(arg, &cbfs);
+}
+
+static int op_rdev_chain(void *arg)
+{
+	struct region_device child;
+
+	next_name = (next_name + 1) % 64;
+	return rdev_chain(&child, &cbfs, next_name * 8, 4 * KiB);
+}
+
+static int op_rdev_readat(void *arg)
+{
+	size_t size = region_device_sz(&cbfs) & ~(READ_CHUNK - 1);
+	size_t offset;
+
+	for (offset = 0; offset < size; offset += READ_CHUNK) {
+		if (rdev_readat(&cbfs, arg, offset, READ_CHUNK) != READ_CHUNK)
+			return -1;
+	}
+	return 0;
+}
+
+struct decompress {
+	const struct region_device *rdev;
+	const void *src;
+	size_t srcn;
+	void *dst;
+	size_t dstn;
+};
+
+static int op_ulz4fn(void *arg)
+{
+	struct decompress *d = arg;
+
+	return ulz4fn(d->src, d->srcn, d->dst, d->dstn) != d->dstn;
+}
+
+static int op_ulzman(void *arg)
+{
+	struct decompress *d = arg;
+
+	return ulzman(d->src, d->srcn, d->dst, d->dstn) != d->dstn;
+}
+
+static int op_ulzman_rdev(void *arg)
+{
+	struct decompress *d = arg;
+
+	return ulzman_rdev(d->rdev, 0, region_device_sz(d->rdev), d->dst,
+			   d->dstn) != d->dstn;
+}
+
+/* Find out how a file is compressed and where its compressed data is. */
+static int file_compression(struct cbfsf *fh, struct region_device *data,
+			    uint32_t *algo, size_t *size)
+{
+	struct cbfs_stage stage;
+	uint32_t type;
+
+	if (cbfsf_file_type(fh, &type))
+		return -1;
+
+	if (type != CBFS_TYPE_STAGE) {
+		cbfs_file_data(data, fh);
+		return cbfsf_decompression_info(fh, algo, size);
+	}
+
+	if (rdev_readat(&fh->data, &stage, 0, sizeof(stage)) != sizeof(stage))
+		return -1;
+	*algo = read_le32(&stage.compression);
+	*size = read_le32(&stage.memlen);
+	return rdev_chain(data, &fh->data, sizeof(stage),
+			  read_le32(&stage.len));
+}
+
+static int bench_decompression(void)
+{
+	size_t i;
+
+	for (i = 0; i < num_names; i++) {
+		struct decompress d;
+		struct region_device data;
+		struct cbfsf fh;
+		uint32_t algo;
+		char name[64];
+		void *src;
+		int ret = 0;
+
+		if (cbfs_locate(&fh, &cbfs, names[i], NULL) ||
+		    file_compression(&fh, &data, &algo, &d.dstn))
+			continue;
+		if (algo != CBFS_COMPRESS_LZ4 && algo != CBFS_COMPRESS_LZMA)
+			continue;
+
+		src = rdev_mmap_full(&data);
+		d.rdev = &data;
+		d.src = src;
+		d.srcn = region_device_sz(&data);
+		d.dst = malloc(d.dstn);
+		if (!src || !d.dst)
+			return -1;
+
+		if (algo == CBFS_COMPRESS_LZ4) {
+			snprintf(name, sizeof(name), "ulz4fn:%s", names[i]);
+			ret = bench(name, op_ulz4fn, &d, d.dstn);
+		} else {
+			snprintf(name, sizeof(name), "ulzman:%s", names[i]);
+			ret = bench(name, op_ulzman, &d, d.dstn);
+			snprintf(name, sizeof(name), "ulzman_rdev:%s",
+				 names[i]);
+			ret = ret ? ret : bench(name, op_ulzman_rdev, &d,
+						d.dstn);
+		}
+
+		free(d.dst);
+		rdev_munmap(&data, src);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int op_mem_pool(void *arg)
+{
+	struct mem_pool *mp = arg;
+	size_t mark = mem_pool_mark(mp);
+	void *a, *b;
+
+	/* Only the last allocation can be freed, the mark takes the rest. */
+	a = mem_pool_alloc(mp, 64);
+	b = mem_pool_alloc(mp, 4 * KiB);
+	if (!a || !b)
+		return -1;
+	mem_pool_free(mp, b);
+	mem_pool_release(mp, mark);
+	return 0;
+}
+
+/* Set up an IMD the way CBMEM does and add IMD_ENTRIES to it. */
+static int op_imd_add(void *arg)
+{
+	struct imd imd;
+	uint32_t id;
+
+	imd_handle_init(&imd, (uint8_t *)arg + IMD_SIZE);
+	if (imd_create_tiered_empty(&imd, CBMEM_ROOT_MIN_SIZE, CBMEM_LG_ALIGN,
+				    CBMEM_SM_ROOT_SIZE, CBMEM_SM_ALIGN))
+		return -1;
+
+	for (id = 1; id <= IMD_ENTRIES; id++) {
+		/* Alternate between the small and the large region. */
+		if (!imd_entry_add(&imd, id, id & 1 ? 64 : 8 * KiB))
+			return -1;
+	}
+	return 0;
+}
+
+static int op_imd_find(void *arg)
+{
+	static uint32_t id;
+
+	id = id % IMD_ENTRIES + 1;
+	return imd_entry_find(arg, id) == NULL;
+}
+
+static int op_memranges(void *arg)
+{
+	struct range_entry *free = arg;
+	struct memranges ranges;
+	resource_t base;
+	int i;
+
+	memranges_init_empty(&ranges, free, MEMRANGES);
+
+	/* Overlapping inserts, as the resource allocator produces them. */
+	for (i = 0; i < MEMRANGES / 2; i++) {
+		base = (resource_t)((i * 7) % (MEMRANGES / 2)) * MiB;
+		memranges_insert(&ranges, base, 3 * MiB / 2, i & 3);
+	}
+
+	memranges_teardown(&ranges);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct cbfs_index *idx;
+	struct mem_pool mp;
+	struct imd imd;
+	void *buf;
+	size_t size;
+	uint8_t *data;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s coreboot.rom\n", argv[0]);
+		return 1;
+	}
+
+	data = read_file(argv[1], &size);
+	if (!data) {
+		fprintf(stderr, "%s: could not read\n", argv[1]);
+		return 1;
+	}
+	mem_region_device_ro_init(&image, data, size);
+	if (find_cbfs(data, size) || collect_names() || !num_names) {
+		fprintf(stderr, "%s: no CBFS found\n", argv[1]);
+		return 1;
+	}
+
+	bench_header();
+
+	if (bench("cbfs_locate", op_cbfs_locate, NULL, 0))
+		return 1;
+
+	idx = malloc(cbfs_index_size(MAX_FILES));
+	idx->max_entries = MAX_FILES;
+	if (bench("cbfs_index_build", op_cbfs_index_build, idx, 0) ||
+	    bench("cbfs_index_locate", op_cbfs_index_locate, idx, 0))
+		return 1;
+	free(idx);
+
+	buf = malloc(READ_CHUNK);
+	if (bench("rdev_chain", op_rdev_chain, NULL, 0) ||
+	    bench("rdev_readat_4k", op_rdev_readat, buf,
+		  region_device_sz(&cbfs) & ~(READ_CHUNK - 1)))
+		return 1;
+	free(buf);
+
+	if (bench_decompression())
+		return 1;
+
+	buf = malloc(64 * KiB);
+	mem_pool_init(&mp, buf, 64 * KiB);
+	if (bench("mem_pool_alloc_free", op_mem_pool, &mp, 0))
+		return 1;
+	free(buf);
+
+	buf = aligned_alloc(CBMEM_LG_ALIGN, IMD_SIZE);
+	if (bench("imd_create_add", op_imd_add, buf, 0))
+		return 1;
+	imd_handle_init(&imd, (uint8_t *)buf + IMD_SIZE);
+	if (imd_recover(&imd) ||
+	    bench("imd_entry_find", op_imd_find, &imd, 0))
+		return 1;
+	free(buf);
+
+	buf = calloc(MEMRANGES, sizeof(struct range_entry));
+	if (bench("memranges_insert", op_memranges, buf, 0))
+		return 1;
+	free(buf);
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+/*
+ * Call op until a second passed and print the result as one CSV line,
+ * benchmark,ops,ns_per_op,mb_per_s. bytes is the amount of data one call
+ * moves, 0 if there's no sensible throughput. op returns non-zero on
+ * failure, which aborts the benchmark and makes bench() return -1.
+ */
+int bench(const char *name, int (*op)(void *arg), void *arg, size_t bytes);
+
+/* The CSV header line. */
+void bench_header(void);
+
+#endif
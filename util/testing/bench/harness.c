@@ -0,0 +1,62 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "bench.h"
+
+/* Every benchmark runs for at least this long. */
+#define MIN_NSECS	(1000 * 1000 * 1000ULL)
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int bench(const char *name, int (*op)(void *arg), void *arg, size_t bytes)
+{
+	uint64_t start, ns;
+	unsigned long long ops = 0;
+
+	start = now_ns();
+	do {
+		/* Amortize the clock over a few calls. */
+		int i;
+
+		for (i = 0; i < 16; i++) {
+			if (op(arg)) {
+				fprintf(stderr, "%s: failed\n", name);
+				return -1;
+			}
+		}
+		ops += 16;
+		ns = now_ns() - start;
+	} while (ns < MIN_NSECS);
+
+	printf("%s,%llu,%.1f,", name, ops, (double)ns / ops);
+	if (bytes)
+		printf("%.1f", (double)bytes * ops * 1000 / ns);
+	printf("\n");
+
+	return 0;
+}
+
+void bench_header(void)
+{
+	printf("benchmark,ops,ns_per_op,mb_per_s\n");
+}
@@ -0,0 +1,25 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_CONSOLE_H
+#define BENCH_CONSOLE_H
+
+#include <commonlib/loglevel.h>
+
+/* The code under test shouldn't talk while it is being timed. */
+static inline __attribute__((format(printf, 2, 3)))
+void printk(int level, const char *fmt, ...)
+{
+}
+
+#endif
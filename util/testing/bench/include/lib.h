@@ -0,0 +1,31 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_LIB_H
+#define BENCH_LIB_H
+
+/* The lzma.c part of the firmware's lib.h. */
+
+#include <stddef.h>
+
+struct region_device;
+
+size_t ulzman(const void *src, size_t srcn, void *dst, size_t dstn);
+size_t ulzman_rdev(const struct region_device *rdev, size_t offset,
+		   size_t srcn, void *dst, size_t dstn);
+
+#define ULZMAN_SCRATCH_SIZE 15980
+size_t ulzman_scratch(const void *src, size_t srcn, void *dst, size_t dstn,
+		      void *scratch);
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_RULES_H
+#define BENCH_RULES_H
+
+/* Like a ramstage, unless the Makefile builds a bootblock variant. */
+#ifndef ENV_BOOTBLOCK
+#define ENV_BOOTBLOCK 0
+#endif
+#define ENV_VERSTAGE 0
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef BENCH_VB2_API_H
+#define BENCH_VB2_API_H
+
+/*
+ * Just enough of vboot's API for commonlib/cbfs.c to build. Hashing isn't
+ * benchmarked here, every digest call fails.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VB2_SUCCESS		0
+#define VB2_ERROR_UNKNOWN	0x10000
+
+#define VB2_SHA512_DIGEST_SIZE	64
+
+enum vb2_hash_algorithm {
+	VB2_HASH_INVALID = 0,
+};
+
+struct vb2_digest_context {
+	enum vb2_hash_algorithm hash_alg;
+};
+
+static inline int vb2_digest_size(enum vb2_hash_algorithm hash_alg)
+{
+	return 0;
+}
+
+static inline int vb2_digest_init(struct vb2_digest_context *dc,
+				  enum vb2_hash_algorithm hash_alg)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+static inline int vb2_digest_extend(struct vb2_digest_context *dc,
+				    const uint8_t *buf, uint32_t size)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+static inline int vb2_digest_finalize(struct vb2_digest_context *dc,
+				      uint8_t *digest, uint32_t digest_size)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+static inline int vb2ex_hwcrypto_digest_init(enum vb2_hash_algorithm hash_alg,
+					     uint32_t data_size)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+static inline int vb2ex_hwcrypto_digest_extend(const uint8_t *buf,
+					       uint32_t size)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+static inline int vb2ex_hwcrypto_digest_finalize(uint8_t *digest,
+						 uint32_t digest_size)
+{
+	return VB2_ERROR_UNKNOWN;
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Times the firmware's memcpy(), memmove() and memset() against the host C
+ * library, for a range of sizes with aligned and misaligned buffers. The
+ * generic C versions from src/lib are always built, the x86 ones from
+ * src/arch/x86 when the host is x86. Build with the cross compiler of
+ * another architecture, e.g. under qemu-user, to compare there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* The firmware's functions, renamed when they were compiled. */
+void *generic_memcpy(void *dest, const void *src, size_t n);
+void *generic_memmove(void *dest, const void *src, size_t n);
+void *generic_memset(void *s, int c, size_t n);
+#if defined(__i386__) || defined(__x86_64__)
+void *x86_memcpy(void *dest, const void *src, size_t n);
+void *x86_memset(void *s, int c, size_t n);
+#endif
+/* Its register usage only works in 32 bit mode. */
+#if defined(__i386__)
+void *x86_memmove(void *dest, const void *src, size_t n);
+#endif
+
+#define BUF_SIZE	(2 * MiB)
+
+typedef void *(*copy_fn)(void *dest, const void *src, size_t n);
+typedef void *(*set_fn)(void *s, int c, size_t n);
+
+struct impl {
+	const char *name;
+	copy_fn memcpy;
+	copy_fn memmove;
+	set_fn memset;
+};
+
+static const struct impl impls[] = {
+	{ "libc", memcpy, memmove, memset },
+	{ "generic", generic_memcpy, generic_memmove, generic_memset },
+#if defined(__i386__)
+	{ "x86", x86_memcpy, x86_memmove, x86_memset },
+#elif defined(__x86_64__)
+	{ "x86", x86_memcpy, NULL, x86_memset },
+#endif
+};
+
+static const size_t sizes[] = { 8, 64, 256, 4 * KiB, 64 * KiB, 1 * MiB };
+
+struct job {
+	const struct impl *impl;
+	char *dest;
+	char *src;
+	size_t size;
+};
+
+static int op_memcpy(void *arg)
+{
+	struct job *j = arg;
+
+	j->impl->memcpy(j->dest, j->src, j->size);
+	return 0;
+}
+
+static int op_memmove(void *arg)
+{
+	struct job *j = arg;
+
+	j->impl->memmove(j->dest, j->src, j->size);
+	return 0;
+}
+
+static int op_memset(void *arg)
+{
+	struct job *j = arg;
+
+	j->impl->memset(j->dest, 0x5a, j->size);
+	return 0;
+}
+
+/* Check the results against the C library before timing anything. */
+static int check(const struct impl *impl, char *a, char *b)
+{
+	size_t n, offs;
+
+	for (n = 0; n < 300; n++) {
+		for (offs = 0; offs < 16; offs++) {
+			size_t i;
+
+			for (i = 0; i < 2048; i++)
+				a[i] = b[i] = i * 7;
+
+			impl->memcpy(a + offs, a + 400 + 3, n);
+			memcpy(b + offs, b + 400 + 3, n);
+			impl->memset(a + 800 + offs, offs, n);
+			memset(b + 800 + offs, offs, n);
+			if (impl->memmove) {
+				impl->memmove(a + 1200 + offs, a + 1200, n);
+				memmove(b + 1200 + offs, b + 1200, n);
+				impl->memmove(a + 1600, a + 1600 + offs, n);
+				memmove(b + 1600, b + 1600 + offs, n);
+			}
+			if (memcmp(a, b, 2048)) {
+				fprintf(stderr, "%s: wrong result for %zu bytes"
+					" at offset %zu\n", impl->name, n, offs);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	char *a = malloc(BUF_SIZE);
+	char *b = malloc(BUF_SIZE);
+	size_t i, s;
+	int misaligned;
+
+	if (!a || !b)
+		return 1;
+	memset(a, 1, BUF_SIZE);
+	memset(b, 2, BUF_SIZE);
+
+	bench_header();
+
+	for (i = 0; i < ARRAY_SIZE(impls); i++) {
+		const struct impl *impl = &impls[i];
+
+		if (check(impl, a, b))
+			return 1;
+
+		for (s = 0; s < ARRAY_SIZE(sizes); s++) {
+			for (misaligned = 0; misaligned < 2; misaligned++) {
+				struct job j = {
+					.impl = impl,
+					.dest = a,
+					.src = b + misaligned,
+					.size = sizes[s],
+				};
+				const char *align = misaligned ? "unaligned" :
+								 "aligned";
+				char name[64];
+
+				snprintf(name, sizeof(name), "memcpy_%s:%zu_%s",
+					 impl->name, sizes[s], align);
+				if (bench(name, op_memcpy, &j, j.size))
+					return 1;
+
+				/* Overlapping, backwards. */
+				j.src = a;
+				j.dest = a + 64 + misaligned;
+				snprintf(name, sizeof(name),
+					 "memmove_%s:%zu_%s", impl->name,
+					 sizes[s], align);
+				if (impl->memmove &&
+				    bench(name, op_memmove, &j, j.size))
+					return 1;
+
+				snprintf(name, sizeof(name), "memset_%s:%zu_%s",
+					 impl->name, sizes[s], align);
+				if (bench(name, op_memset, &j, j.size))
+					return 1;
+			}
+		}
+	}
+
+	free(a);
+	free(b);
+	return 0;
+}
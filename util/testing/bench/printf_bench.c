@@ -0,0 +1,197 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Times the firmware's vtxprintf() on the kind of lines that make up most
+ * of a boot log: resource dumps, hex addresses and decimal timestamps.
+ * The ramstage build and the CONSOLE_VTXPRINTF_SMALL_EARLY bootblock build
+ * are both timed, next to the host's vsnprintf(). Before that, the output
+ * of both is checked against the host's for random values.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+/* src/console/vtxprintf.c, built twice. */
+int vtxprintf(void (*tx_byte)(unsigned char byte, void *data),
+	      const char *fmt, va_list args, void *data);
+int vtxprintf_small(void (*tx_byte)(unsigned char byte, void *data),
+		    const char *fmt, va_list args, void *data);
+
+#define CHECK_ROUNDS	100000
+
+struct buf {
+	char data[256];
+	size_t len;
+};
+
+static void tx_byte(unsigned char byte, void *data)
+{
+	struct buf *b = data;
+
+	if (b->len < sizeof(b->data) - 1)
+		b->data[b->len++] = byte;
+}
+
+static int (*fw_vtxprintf)(void (*tx_byte)(unsigned char byte, void *data),
+			   const char *fmt, va_list args, void *data);
+
+static __attribute__((format(printf, 2, 3)))
+int fw_format(struct buf *b, const char *fmt, ...)
+{
+	va_list args;
+	int ret;
+
+	b->len = 0;
+	va_start(args, fmt);
+	ret = fw_vtxprintf(tx_byte, fmt, args, b);
+	va_end(args);
+	b->data[b->len] = '\0';
+
+	return ret;
+}
+
+static int use_host;
+
+/* All benchmarks and checks format through here. */
+#define FORMAT(b, fmt, ...)						\
+	(use_host ? snprintf((b)->data, sizeof((b)->data), fmt, __VA_ARGS__) \
+		  : fw_format(b, fmt, __VA_ARGS__))
+
+static uint64_t seed = 0x2545f4914f6cdd1dULL;
+
+static uint64_t rnd(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	/* Favor short numbers, they are the common case. */
+	return seed >> (seed & 63);
+}
+
+#define RESOURCE_FMT \
+	"%s %02lx <- [0x%010llx - 0x%010llx] size 0x%08llx gran 0x%02x %s\n"
+#define HEX_FMT		"0x%08x 0x%08x 0x%x 0x%llx\n"
+#define DECIMAL_FMT	"%d %u %5d %-6u %llu %lld\n"
+
+static int op_resource(void *arg)
+{
+	uint64_t base = 0xfe000000ULL;
+
+	return FORMAT((struct buf *)arg, RESOURCE_FMT, "PCI: 00:1f.0", 0x10UL,
+		      (unsigned long long)base,
+		      (unsigned long long)base + 0xfff, 0x1000ULL, 12,
+		      "mem") <= 0;
+}
+
+static int op_hex(void *arg)
+{
+	return FORMAT((struct buf *)arg, HEX_FMT, 0xfed40000u, 0x1234u, 0xcfu,
+		      0x100000000ULL) <= 0;
+}
+
+static int op_decimal(void *arg)
+{
+	return FORMAT((struct buf *)arg, DECIMAL_FMT, -1234, 1000000u, 42,
+		      7u, 1234567890123ULL, -98765432101LL) <= 0;
+}
+
+static int check(const char *name)
+{
+	struct buf fw, host;
+	int i;
+
+	for (i = 0; i < CHECK_ROUNDS; i++) {
+		uint64_t a = rnd(), b = rnd(), c = rnd();
+
+		use_host = 0;
+		fw_format(&fw, RESOURCE_FMT, "dev", (unsigned long)a & 0xff,
+			  (unsigned long long)a, (unsigned long long)b,
+			  (unsigned long long)c, (int)(c & 63), "io");
+		use_host = 1;
+		snprintf(host.data, sizeof(host.data), RESOURCE_FMT, "dev",
+			 (unsigned long)a & 0xff, (unsigned long long)a,
+			 (unsigned long long)b, (unsigned long long)c,
+			 (int)(c & 63), "io");
+		if (strcmp(fw.data, host.data))
+			goto mismatch;
+
+		use_host = 0;
+		fw_format(&fw, DECIMAL_FMT, (int)a, (unsigned int)b,
+			  (int)(c >> 40), (unsigned int)(a >> 7),
+			  (unsigned long long)b, (long long)c);
+		snprintf(host.data, sizeof(host.data), DECIMAL_FMT, (int)a,
+			 (unsigned int)b, (int)(c >> 40),
+			 (unsigned int)(a >> 7), (unsigned long long)b,
+			 (long long)c);
+		if (strcmp(fw.data, host.data))
+			goto mismatch;
+	}
+
+	return 0;
+
+mismatch:
+	fprintf(stderr, "%s: '%s' should be '%s'", name, fw.data, host.data);
+	return -1;
+}
+
+static int run(const char *impl)
+{
+	static const struct {
+		const char *name;
+		int (*op)(void *arg);
+	} benches[] = {
+		{ "resource", op_resource },
+		{ "hex", op_hex },
+		{ "decimal", op_decimal },
+	};
+	struct buf b;
+	char name[64];
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(benches); i++) {
+		snprintf(name, sizeof(name), "%s_%s", benches[i].name, impl);
+		if (bench(name, benches[i].op, &b, 0))
+			return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	fw_vtxprintf = vtxprintf;
+	if (check("vtxprintf"))
+		return 1;
+	fw_vtxprintf = vtxprintf_small;
+	if (check("vtxprintf_small"))
+		return 1;
+
+	bench_header();
+
+	use_host = 1;
+	if (run("libc"))
+		return 1;
+	use_host = 0;
+	fw_vtxprintf = vtxprintf;
+	if (run("vtxprintf"))
+		return 1;
+	fw_vtxprintf = vtxprintf_small;
+	if (run("vtxprintf_small"))
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Times x86emu from src/device/oprom running the init of an option ROM,
+ * the way YABEL calls it: loaded at C000:0000 and entered at offset 3 with
+ * a far return to a HLT. Without an argument a small built-in ROM is run,
+ * which clears the legacy frame buffer, programs VGA registers and
+ * checksums itself. A real VGA BIOS can be given instead. Each ROM is run
+ * with and without X86EMU_setCodeWindow().
+ *
+ * Port reads return all ones and interrupt vectors point to an IRET, so a
+ * real ROM may well take other paths than on hardware. A ROM that doesn't
+ * return within a second counts as failed.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <x86emu/x86emu.h>
+
+#include "bench.h"
+
+#define MEM_SIZE	(1 * MiB)
+#define ROM_SEG		0xc000
+#define ROM_MAX		(128 * KiB)
+#define STUB_SEG	0xf000
+#define IRET_OFFS	0xff53
+#define HLT_OFFS	0x0100
+#define STACK_TOP	0x7000
+
+/*
+ *	.byte 0x55, 0xaa, 4
+ *	jmp init
+ * init:
+ *	push %ds
+ *	push %es
+ *	mov $0xa000, %ax	// Clear the legacy frame buffer a few times.
+ *	mov %ax, %es
+ *	mov $8, %dx
+ * fill:
+ *	xor %di, %di
+ *	mov $0x2000, %cx
+ *	mov %dx, %ax
+ *	cld
+ *	rep stosw
+ *	dec %dx
+ *	jnz fill
+ *	push %cs		// Program and read back sequencer registers.
+ *	pop %ds
+ *	mov $64, %bx
+ * regs:
+ *	mov $table, %si
+ *	mov $16, %cx
+ * next:
+ *	lodsw
+ *	mov $0x3c4, %dx
+ *	out %ax, %dx
+ *	in %dx, %al
+ *	loop next
+ *	dec %bx
+ *	jnz regs
+ *	mov $16, %bp		// Checksum the ROM, a call per byte.
+ * sum:
+ *	xor %si, %si
+ *	mov $0x800, %cx
+ *	xor %ax, %ax
+ *	xor %bx, %bx
+ * byte:
+ *	call add_byte
+ *	loop byte
+ *	dec %bp
+ *	jnz sum
+ *	mov $0x2000, %ax	// Copy the ROM to RAM, as shadowing code does.
+ *	mov %ax, %es
+ *	xor %si, %si
+ *	xor %di, %di
+ *	mov $0x400, %cx
+ *	rep movsw
+ *	pop %es
+ *	pop %ds
+ *	lret
+ * add_byte:
+ *	movb (%si), %bl
+ *	add %bx, %ax
+ *	rol $1, %ax
+ *	inc %si
+ *	ret
+ * table:
+ *	.word 0x0100, 0x0101, 0x0f02, 0x0003, 0x0604, 0x0300, 0x2101, 0x0f02
+ *	.word 0x0003, 0x0e04, 0x0100, 0x0101, 0x0302, 0x0003, 0x0204, 0x0300
+ */
+static const u8 builtin_rom[] = {
+	0x55, 0xaa, 0x04, 0xeb, 0x00, 0x1e, 0x06, 0xb8, 0x00, 0xa0, 0x8e, 0xc0,
+	0xba, 0x08, 0x00, 0x31, 0xff, 0xb9, 0x00, 0x20, 0x89, 0xd0, 0xfc, 0xf3,
+	0xab, 0x4a, 0x75, 0xf3, 0x0e, 0x1f, 0xbb, 0x40, 0x00, 0xbe, 0x5f, 0x00,
+	0xb9, 0x10, 0x00, 0xad, 0xba, 0xc4, 0x03, 0xef, 0xec, 0xe2, 0xf8, 0x4b,
+	0x75, 0xef, 0xbd, 0x10, 0x00, 0x31, 0xf6, 0xb9, 0x00, 0x08, 0x31, 0xc0,
+	0x31, 0xdb, 0xe8, 0x16, 0x00, 0xe2, 0xfb, 0x4d, 0x75, 0xef, 0xb8, 0x00,
+	0x20, 0x8e, 0xc0, 0x31, 0xf6, 0x31, 0xff, 0xb9, 0x00, 0x04, 0xf3, 0xa5,
+	0x07, 0x1f, 0xcb, 0x8a, 0x1c, 0x01, 0xd8, 0xd1, 0xc0, 0x46, 0xc3, 0x00,
+	0x01, 0x01, 0x01, 0x02, 0x0f, 0x03, 0x00, 0x04, 0x06, 0x00, 0x03, 0x01,
+	0x21, 0x02, 0x0f, 0x03, 0x00, 0x04, 0x0e, 0x00, 0x01, 0x01, 0x01, 0x02,
+	0x03, 0x03, 0x00, 0x04, 0x02, 0x00, 0x03,
+};
+
+static u8 *mem;
+static u8 *initial_mem;
+
+/* sys.c falls back to these when no port functions are set up. */
+u8 inb(u16 port) { return 0xff; }
+u16 inw(u16 port) { return 0xffff; }
+u32 inl(u16 port) { return 0xffffffff; }
+void outb(u8 val, u16 port) { }
+void outw(u16 val, u16 port) { }
+void outl(u32 val, u16 port) { }
+
+static void timeout(int sig)
+{
+	X86EMU_halt_sys();
+}
+
+static void push_word(u16 val)
+{
+	M.x86.R_SP -= 2;
+	mem[M.x86.R_SS * 16 + M.x86.R_SP] = val;
+	mem[M.x86.R_SS * 16 + M.x86.R_SP + 1] = val >> 8;
+}
+
+static int op_run_rom(void *arg)
+{
+	memcpy(mem, initial_mem, MEM_SIZE);
+
+	memset(&M.x86, 0, sizeof(M.x86));
+	M.x86.R_SS = 0;
+	M.x86.R_SP = STACK_TOP;
+	push_word(STUB_SEG);
+	push_word(HLT_OFFS);
+	M.x86.R_CS = ROM_SEG;
+	M.x86.R_IP = 3;
+	/* Bus 0, device 2, function 0, as for an onboard VGA. */
+	M.x86.R_AX = 0x0010;
+
+	alarm(1);
+	X86EMU_exec();
+	alarm(0);
+
+	/* Back at the HLT after the far return, and past it. */
+	return M.x86.R_CS != STUB_SEG || M.x86.R_IP != HLT_OFFS + 1;
+}
+
+static int load_rom(const char *name)
+{
+	FILE *f = fopen(name, "rb");
+	size_t size;
+
+	if (!f)
+		return -1;
+	size = fread(initial_mem + ROM_SEG * 16, 1, ROM_MAX, f);
+	fclose(f);
+
+	if (size < 3 || initial_mem[ROM_SEG * 16] != 0x55 ||
+	    initial_mem[ROM_SEG * 16 + 1] != 0xaa)
+		return -1;
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *rom = "builtin";
+	char name[128];
+	int i;
+
+	if (argc > 2) {
+		fprintf(stderr, "usage: %s [vgabios.bin]\n", argv[0]);
+		return 1;
+	}
+
+	mem = calloc(1, MEM_SIZE);
+	initial_mem = calloc(1, MEM_SIZE);
+	if (!mem || !initial_mem)
+		return 1;
+
+	if (argc > 1) {
+		if (load_rom(argv[1])) {
+			fprintf(stderr, "%s: not an option ROM\n", argv[1]);
+			return 1;
+		}
+		rom = strrchr(argv[1], '/') ? strrchr(argv[1], '/') + 1 :
+					      argv[1];
+	} else {
+		memcpy(initial_mem + ROM_SEG * 16, builtin_rom,
+		       sizeof(builtin_rom));
+	}
+
+	/* Every interrupt vector points to an IRET. */
+	for (i = 0; i < 256; i++) {
+		initial_mem[i * 4] = IRET_OFFS & 0xff;
+		initial_mem[i * 4 + 1] = IRET_OFFS >> 8;
+		initial_mem[i * 4 + 2] = STUB_SEG & 0xff;
+		initial_mem[i * 4 + 3] = STUB_SEG >> 8;
+	}
+	initial_mem[STUB_SEG * 16 + IRET_OFFS] = 0xcf;
+	initial_mem[STUB_SEG * 16 + HLT_OFFS] = 0xf4;
+
+	X86EMU_setMemBase(mem, MEM_SIZE);
+	signal(SIGALRM, timeout);
+
+	bench_header();
+
+	X86EMU_setCodeWindow(0, 0, NULL);
+	snprintf(name, sizeof(name), "x86emu:%s", rom);
+	if (bench(name, op_run_rom, NULL, 0))
+		return 1;
+
+	X86EMU_setCodeWindow(ROM_SEG * 16, 0x10000, mem + ROM_SEG * 16);
+	snprintf(name, sizeof(name), "x86emu_code_window:%s", rom);
+	if (bench(name, op_run_rom, NULL, 0))
+		return 1;
+
+	free(mem);
+	free(initial_mem);
+	return 0;
+}
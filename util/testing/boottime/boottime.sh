@@ -0,0 +1,167 @@
+#!/bin/bash
+#
+# This file is part of the coreboot project.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; version 2 of the License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# Builds the emulation configs in configs/, boots each a few times in QEMU
+# and compares the timestamps against the history in baselines/. After a
+# boot the guest memory is dumped and read with cbmem -M, so nothing has to
+# run in the guest. Exits with 3 if any timestamp regressed.
+#
+# In kvm mode the timestamps are real time and a few boots are needed to
+# get a stable median. In icount mode QEMU runs one instruction per virtual
+# nanosecond, so the timestamps count instructions and one boot is enough.
+
+set -e
+
+TOP=$(cd "$(dirname "$0")/../../.." && pwd)
+HERE="$TOP/util/testing/boottime"
+CBMEM="$TOP/util/cbmem/cbmem"
+QEMU=${QEMU:-qemu-system-x86_64}
+MAKE=${MAKE:-make}
+
+MODE=kvm
+BOOTS=
+THRESHOLD=
+UPDATE=0
+OUT="$TOP/boottime"
+RAM_MB=1024
+TIMEOUT=60
+
+usage()
+{
+	echo "usage: $0 [-u] [-m kvm|icount] [-n boots] [-P percent] [-o dir] [config...]"
+	echo "  -u  record the results as the new baselines"
+	echo "  -m  kvm (default): real time, icount: instruction counts"
+	echo "  -n  boots per config (default 5 with kvm, 1 with icount)"
+	echo "  -P  regression threshold in percent (default 10 with kvm,"
+	echo "      1 with icount)"
+	echo "  -o  output directory (default boottime/)"
+	echo "configs default to all files in $HERE/configs"
+	exit 1
+}
+
+while getopts "um:n:P:o:h" opt; do
+	case $opt in
+	u) UPDATE=1 ;;
+	m) MODE=$OPTARG ;;
+	n) BOOTS=$OPTARG ;;
+	P) THRESHOLD=$OPTARG ;;
+	o) OUT=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+case $MODE in
+kvm)
+	ACCEL="-enable-kvm -cpu host"
+	TICK_FREQ=
+	BOOTS=${BOOTS:-5}
+	THRESHOLD=${THRESHOLD:-10}
+	;;
+icount)
+	ACCEL="-accel tcg -icount shift=0,sleep=off"
+	# One TSC tick per instruction, report the ticks as they are.
+	TICK_FREQ="-F 1"
+	BOOTS=${BOOTS:-1}
+	THRESHOLD=${THRESHOLD:-1}
+	;;
+*)
+	usage
+	;;
+esac
+
+if [ $# -eq 0 ]; then
+	set -- $(cd "$HERE/configs" && ls)
+fi
+
+$MAKE -C "$TOP/util/cbmem" >/dev/null
+
+# Boot rom once, leave the serial log in $1.log and the memory in $1.mem.
+boot()
+{
+	local base=$1 rom=$2 machine=$3 pid i
+
+	rm -f "$base.log" "$base.mem" "$base.mon.in" "$base.mon.out"
+	mkfifo "$base.mon.in" "$base.mon.out"
+
+	$QEMU $machine $ACCEL -m $RAM_MB -bios "$rom" -display none \
+		-serial "file:$base.log" \
+		-chardev "pipe,id=mon,path=$base.mon" -mon mon &
+	pid=$!
+
+	exec 3>"$base.mon.in"
+	cat "$base.mon.out" >/dev/null &
+
+	# Without a payload ramstage stops right after loading it.
+	for i in $(seq $((TIMEOUT * 10))); do
+		if grep -q "Payload not loaded" "$base.log" 2>/dev/null; then
+			break
+		fi
+		sleep 0.1
+	done
+
+	echo "pmemsave 0 $((RAM_MB << 20)) $base.mem" >&3
+	echo "quit" >&3
+	exec 3>&-
+	wait $pid || true
+	rm -f "$base.mon.in" "$base.mon.out"
+
+	if ! grep -q "Payload not loaded" "$base.log"; then
+		echo "$base: boot did not finish within ${TIMEOUT}s"
+		return 1
+	fi
+}
+
+status=0
+for config in "$@"; do
+	dir="$OUT/$config-$MODE"
+	baseline="$HERE/baselines/$config-$MODE.history"
+	machine=$(sed -n 's/^# QEMU: //p' "$HERE/configs/$config")
+
+	echo "*** $config ($MODE) ***"
+	rm -rf "$dir"
+	mkdir -p "$dir"
+	cp "$HERE/configs/$config" "$dir/config"
+	$MAKE -C "$TOP" DOTCONFIG="$dir/config" obj="$dir/build" \
+		olddefconfig >"$dir/make.log" 2>&1
+	if ! $MAKE -C "$TOP" DOTCONFIG="$dir/config" obj="$dir/build" \
+		>>"$dir/make.log" 2>&1; then
+		echo "$config: build failed, see $dir/make.log"
+		status=1
+		continue
+	fi
+
+	for i in $(seq $BOOTS); do
+		boot "$dir/boot$i" "$dir/build/coreboot.rom" "$machine" ||
+			{ status=1; continue 2; }
+		"$CBMEM" -M "$dir/boot$i.mem" $TICK_FREQ -H "$dir/history"
+		if [ $i -eq 1 ]; then
+			"$CBMEM" -M "$dir/boot1.mem" -c >"$dir/console.log"
+		fi
+		rm -f "$dir/boot$i.mem"
+	done
+
+	if [ $UPDATE -eq 1 ]; then
+		mkdir -p "$HERE/baselines"
+		cp "$dir/history" "$baseline"
+		"$CBMEM" -S "$dir/history"
+	elif [ -f "$baseline" ]; then
+		"$CBMEM" -S "$dir/history" -R "$baseline" -P $THRESHOLD ||
+			status=3
+	else
+		"$CBMEM" -S "$dir/history"
+		echo "$config: no baseline yet, record one with -u"
+	fi
+done
+
+exit $status